@@ -225,6 +225,7 @@ function (swift_benchmark_compile_archopts)
           ${bench_flags}
           "-parse-as-library"
           "-emit-module" "-module-name" "${module_name}"
+          "-emit-module-path" "${objdir}/${module_name}.swiftmodule"
           "-I" "${objdir}"
           "-o" "${objfile}"
           ${sources})
@@ -259,7 +260,8 @@ function (swift_benchmark_compile_archopts)
           ${common_options}
           ${bench_flags}
           "-parse-as-library"
-          "-module-name" "${module_name}"
+          "-emit-module" "-module-name" "${module_name}"
+          "-emit-module-path" "${objdir}/${module_name}.swiftmodule"
           "-I" "${objdir}"
           "-output-file-map" "${objdir}/${module_name}/outputmap.json"
           ${sources})
@@ -312,6 +314,24 @@ function (swift_benchmark_compile_archopts)
         "-c"
         "-o" "${objcfile}")
 
+  set(common_link_options
+      "-fno-stack-protector"
+      "-fPIC"
+      "-Werror=date-time"
+      "-fcolor-diagnostics"
+      "-O3"
+      "-Wl,-search_paths_first"
+      "-Wl,-headerpad_max_install_names"
+      "-target" "${target}"
+      "-isysroot" "${sdk}"
+      "-arch" "${BENCH_COMPILE_ARCHOPTS_ARCH}"
+      "-F" "${sdk}/../../../Developer/Library/Frameworks"
+      "-m${triple_platform}-version-min=${ver}"
+      "-lobjc"
+      "-L${SWIFT_LIBRARY_PATH}/${BENCH_COMPILE_ARCHOPTS_PLATFORM}"
+      "-Xlinker" "-rpath"
+      "-Xlinker" "@executable_path/../lib/swift/${BENCH_COMPILE_ARCHOPTS_PLATFORM}")
+
   add_custom_command(
       OUTPUT "${OUTPUT_EXEC}"
       DEPENDS
@@ -320,22 +340,7 @@ function (swift_benchmark_compile_archopts)
         "adhoc-sign-swift-stdlib-${BENCH_COMPILE_ARCHOPTS_PLATFORM}"
       COMMAND
         "${CLANG_EXEC}"
-        "-fno-stack-protector"
-        "-fPIC"
-        "-Werror=date-time"
-        "-fcolor-diagnostics"
-        "-O3"
-        "-Wl,-search_paths_first"
-        "-Wl,-headerpad_max_install_names"
-        "-target" "${target}"
-        "-isysroot" "${sdk}"
-        "-arch" "${BENCH_COMPILE_ARCHOPTS_ARCH}"
-        "-F" "${sdk}/../../../Developer/Library/Frameworks"
-        "-m${triple_platform}-version-min=${ver}"
-        "-lobjc"
-        "-L${SWIFT_LIBRARY_PATH}/${BENCH_COMPILE_ARCHOPTS_PLATFORM}"
-        "-Xlinker" "-rpath"
-        "-Xlinker" "@executable_path/../lib/swift/${BENCH_COMPILE_ARCHOPTS_PLATFORM}"
+        ${common_link_options}
         ${bench_library_objects}
         ${SWIFT_BENCH_OBJFILES}
         ${objcfile}
@@ -343,6 +348,51 @@ function (swift_benchmark_compile_archopts)
       COMMAND
         "codesign" "-f" "-s" "-" "${OUTPUT_EXEC}")
   set(new_output_exec "${OUTPUT_EXEC}" PARENT_SCOPE)
+
+  # Record the text and data size and the number of symbols, metadata
+  # records and relocations of each benchmark module.
+  set(code_size_file "${objdir}/code-size.csv")
+  add_custom_command(
+      OUTPUT "${code_size_file}"
+      DEPENDS
+        ${bench_library_objects} ${SWIFT_BENCH_OBJFILES}
+        "${srcdir}/scripts/Benchmark_CodeSize"
+      COMMAND
+        "${srcdir}/scripts/Benchmark_CodeSize"
+        "--output" "${code_size_file}"
+        ${bench_library_objects}
+        ${SWIFT_BENCH_OBJFILES})
+  set(new_code_size_file "${code_size_file}" PARENT_SCOPE)
+
+  # A minimal program for measuring the time to main and the first use of
+  # generic types and protocol conformances. It is linked without the
+  # benchmark driver, so only the runtime and the standard library are
+  # loaded.
+  set(coldstart_source "${srcdir}/startup/ColdStart.swift")
+  set(coldstart_objfile "${objdir}/ColdStart.o")
+  string(REPLACE "Benchmark_" "ColdStart_" COLDSTART_EXEC "${OUTPUT_EXEC}")
+  add_custom_command(
+      OUTPUT "${coldstart_objfile}"
+      DEPENDS ${stdlib_dependencies} "${coldstart_source}"
+      COMMAND "${SWIFT_EXEC}"
+      ${common_options}
+      "-force-single-frontend-invocation"
+      "-module-name" "main"
+      "-o" "${coldstart_objfile}"
+      "${coldstart_source}")
+  add_custom_command(
+      OUTPUT "${COLDSTART_EXEC}"
+      DEPENDS
+        "${coldstart_objfile}"
+        "adhoc-sign-swift-stdlib-${BENCH_COMPILE_ARCHOPTS_PLATFORM}"
+      COMMAND
+        "${CLANG_EXEC}"
+        ${common_link_options}
+        "${coldstart_objfile}"
+        "-o" "${COLDSTART_EXEC}"
+      COMMAND
+        "codesign" "-f" "-s" "-" "${COLDSTART_EXEC}")
+  set(new_coldstart_exec "${COLDSTART_EXEC}" PARENT_SCOPE)
 endfunction()
 
 function(swift_benchmark_compile)
@@ -374,12 +424,16 @@ function(swift_benchmark_compile)
   set(platform_executables)
   foreach(arch ${${SWIFT_BENCHMARK_COMPILE_PLATFORM}_arch})
     set(platform_executables)
+    set(platform_code_size_files)
+    set(platform_coldstart_executables)
     foreach(optset ${SWIFT_OPTIMIZATION_LEVELS})
       swift_benchmark_compile_archopts(
         PLATFORM "${platform}"
         ARCH "${arch}"
         OPT "${optset}")
       list(APPEND platform_executables ${new_output_exec})
+      list(APPEND platform_code_size_files ${new_code_size_file})
+      list(APPEND platform_coldstart_executables ${new_coldstart_exec})
     endforeach()
 
     set(executable_target "swift-benchmark-${SWIFT_BENCHMARK_COMPILE_PLATFORM}-${arch}")
@@ -387,6 +441,21 @@ function(swift_benchmark_compile)
     add_custom_target("${executable_target}"
         DEPENDS ${platform_executables})
 
+    add_custom_target("${executable_target}-code-size"
+        DEPENDS ${platform_code_size_files})
+
+    # The cold start measurement has to run on the host.
+    if("${SWIFT_BENCHMARK_COMPILE_PLATFORM}" STREQUAL "macosx")
+      set(coldstart_commands)
+      foreach(coldstart_exec ${platform_coldstart_executables})
+        list(APPEND coldstart_commands
+            COMMAND "${srcdir}/scripts/Benchmark_ColdStart" "${coldstart_exec}")
+      endforeach()
+      add_custom_target("${executable_target}-coldstart"
+          DEPENDS ${platform_coldstart_executables}
+          ${coldstart_commands})
+    endif()
+
     if(IS_SWIFT_BUILD AND "${SWIFT_BENCHMARK_COMPILE_PLATFORM}" STREQUAL "macosx")
       add_custom_command(
           TARGET "${executable_target}"
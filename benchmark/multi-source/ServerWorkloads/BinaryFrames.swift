@@ -0,0 +1,189 @@
+//===--- BinaryFrames.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Encode messages into length-prefixed binary frames, as in RPC and
+// streaming protocols, and decode them again. A frame is a big-endian
+// 32-bit length, a type byte, a big-endian 32-bit stream ID, varint-encoded
+// tagged fields and a length-prefixed UTF-8 string.
+import TestsUtils
+
+enum FrameType : UInt8 {
+  case data = 0
+  case headers = 1
+  case ping = 2
+}
+
+struct Message {
+  var type: FrameType
+  var streamID: UInt32
+  var fields: [(tag: Int, value: UInt64)]
+  var text: String
+}
+
+struct FrameEncoder {
+  var buffer = [UInt8]()
+
+  mutating func writeUInt32(_ value: UInt32) {
+    buffer.append(UInt8(truncatingBitPattern: value >> 24))
+    buffer.append(UInt8(truncatingBitPattern: value >> 16))
+    buffer.append(UInt8(truncatingBitPattern: value >> 8))
+    buffer.append(UInt8(truncatingBitPattern: value))
+  }
+
+  mutating func writeVarint(_ value: UInt64) {
+    var value = value
+    while value >= 0x80 {
+      buffer.append(UInt8(truncatingBitPattern: value) | 0x80)
+      value >>= 7
+    }
+    buffer.append(UInt8(value))
+  }
+
+  mutating func encode(_ message: Message) {
+    // Reserve the length, and fill it in when the frame is complete.
+    let lengthOffset = buffer.count
+    writeUInt32(0)
+    buffer.append(message.type.rawValue)
+    writeUInt32(message.streamID)
+    writeVarint(UInt64(message.fields.count))
+    for field in message.fields {
+      writeVarint(UInt64(field.tag))
+      writeVarint(field.value)
+    }
+    writeVarint(UInt64(message.text.utf8.count))
+    buffer.append(contentsOf: message.text.utf8)
+
+    let length = UInt32(buffer.count - lengthOffset - 4)
+    buffer[lengthOffset] = UInt8(truncatingBitPattern: length >> 24)
+    buffer[lengthOffset + 1] = UInt8(truncatingBitPattern: length >> 16)
+    buffer[lengthOffset + 2] = UInt8(truncatingBitPattern: length >> 8)
+    buffer[lengthOffset + 3] = UInt8(truncatingBitPattern: length)
+  }
+}
+
+struct FrameDecoder {
+  let bytes: [UInt8]
+  var position = 0
+
+  init(_ bytes: [UInt8]) {
+    self.bytes = bytes
+  }
+
+  mutating func readUInt32() -> UInt32? {
+    guard position + 4 <= bytes.count else {
+      return nil
+    }
+    var value: UInt32 = 0
+    for i in 0..<4 {
+      value = value << 8 | UInt32(bytes[position + i])
+    }
+    position += 4
+    return value
+  }
+
+  mutating func readVarint() -> UInt64? {
+    var value: UInt64 = 0
+    var shift: UInt64 = 0
+    while position < bytes.count && shift < 64 {
+      let byte = bytes[position]
+      position += 1
+      value |= UInt64(byte & 0x7F) << shift
+      if byte < 0x80 {
+        return value
+      }
+      shift += 7
+    }
+    return nil
+  }
+
+  /// Decode the next frame, or return nil at the end of the input or if the
+  /// frame is malformed.
+  mutating func next() -> Message? {
+    guard let length = readUInt32() else {
+      return nil
+    }
+    let end = position + Int(length)
+    guard end <= bytes.count && position < end,
+          let type = FrameType(rawValue: bytes[position]) else {
+      return nil
+    }
+    position += 1
+    guard let streamID = readUInt32(), fieldCount = readVarint() else {
+      return nil
+    }
+    var fields = [(tag: Int, value: UInt64)]()
+    for _ in 0..<fieldCount {
+      guard let tag = readVarint(), value = readVarint() else {
+        return nil
+      }
+      fields.append((tag: Int(tag), value: value))
+    }
+    guard let textLength = readVarint()
+          where position + Int(textLength) == end else {
+      return nil
+    }
+    let text = String._fromCodeUnitSequence(UTF8.self,
+                                            input: bytes[position..<end])
+    position = end
+    guard let decodedText = text else {
+      return nil
+    }
+    return Message(type: type, streamID: streamID, fields: fields,
+                   text: decodedText)
+  }
+}
+
+func makeMessages() -> [Message] {
+  var messages = [Message]()
+  for i in 0..<100 {
+    let type: FrameType = i % 10 == 0 ? .ping : (i % 3 == 0 ? .headers : .data)
+    var fields = [(tag: Int, value: UInt64)]()
+    for tag in 0..<(i % 8) {
+      fields.append((tag: tag + 1, value: UInt64(i) << UInt64(tag * 7)))
+    }
+    messages.append(Message(type: type, streamID: UInt32(i * 2 + 1),
+                            fields: fields,
+                            text: "payload \(i) for stream \(i * 2 + 1)"))
+  }
+  return messages
+}
+
+let frameMessages = makeMessages()
+
+@inline(never)
+public func run_ServerFrameCoding(_ N: Int) {
+  let messages = frameMessages
+  var encoder = FrameEncoder()
+  for _ in 1...N {
+    encoder.buffer.removeAll(keepingCapacity: true)
+    for message in messages {
+      encoder.encode(message)
+    }
+
+    var decoder = FrameDecoder(encoder.buffer)
+    var count = 0
+    var streamIDSum: UInt32 = 0
+    var fieldCount = 0
+    var textBytes = 0
+    while let message = decoder.next() {
+      count += 1
+      streamIDSum = streamIDSum &+ message.streamID
+      fieldCount += message.fields.count
+      textBytes += message.text.utf8.count
+    }
+    CheckResults(count == messages.count &&
+                 decoder.position == encoder.buffer.count &&
+                 streamIDSum == 10000 && fieldCount == 342 &&
+                 textBytes > 0,
+                 "Incorrect results in ServerFrameCoding")
+  }
+}
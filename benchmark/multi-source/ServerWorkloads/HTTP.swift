@@ -0,0 +1,156 @@
+//===--- HTTP.swift -------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Tokenize HTTP/1.1 requests from the bytes read from a socket into a
+// method, a path, headers with lowercased names and a body.
+import TestsUtils
+
+struct HTTPRequest {
+  var method: String
+  var path: String
+  var headers: [(name: String, value: String)]
+  var body: ArraySlice<UInt8>
+
+  /// Returns the value of the header `name`, which must be lowercase.
+  func header(_ name: String) -> String? {
+    for header in headers {
+      if header.name == name {
+        return header.value
+      }
+    }
+    return nil
+  }
+}
+
+func decodeASCII(_ bytes: ArraySlice<UInt8>) -> String {
+  return String._fromWellFormedCodeUnitSequence(UTF8.self, input: bytes)
+}
+
+/// Returns the index of the next CR LF at or after `start`, or nil.
+func findLineEnd(_ bytes: [UInt8], _ start: Int) -> Int? {
+  var i = start
+  while i + 1 < bytes.count {
+    if bytes[i] == 0x0D && bytes[i + 1] == 0x0A {
+      return i
+    }
+    i += 1
+  }
+  return nil
+}
+
+func parseHTTPRequest(_ bytes: [UInt8]) -> HTTPRequest? {
+  // The request line: METHOD SP PATH SP VERSION CRLF.
+  guard let requestLineEnd = findLineEnd(bytes, 0) else {
+    return nil
+  }
+  let requestLine = bytes[0..<requestLineEnd]
+  let parts = requestLine.split(separator: 0x20,
+                                omittingEmptySubsequences: true)
+  guard parts.count == 3 else {
+    return nil
+  }
+  var request = HTTPRequest(method: decodeASCII(parts[0]),
+                            path: decodeASCII(parts[1]),
+                            headers: [], body: [])
+
+  // Header lines up to an empty line.
+  var lineStart = requestLineEnd + 2
+  while true {
+    guard let lineEnd = findLineEnd(bytes, lineStart) else {
+      return nil
+    }
+    if lineEnd == lineStart {
+      lineStart += 2
+      break
+    }
+    var colon = lineStart
+    while colon < lineEnd && bytes[colon] != 0x3A {
+      colon += 1
+    }
+    guard colon < lineEnd else {
+      return nil
+    }
+    // Header names are case-insensitive, so lowercase them once here.
+    var name = [UInt8](bytes[lineStart..<colon])
+    for i in 0..<name.count {
+      if name[i] >= 0x41 && name[i] <= 0x5A {
+        name[i] += 0x20
+      }
+    }
+    var valueStart = colon + 1
+    while valueStart < lineEnd && bytes[valueStart] == 0x20 {
+      valueStart += 1
+    }
+    var valueEnd = lineEnd
+    while valueEnd > valueStart && bytes[valueEnd - 1] == 0x20 {
+      valueEnd -= 1
+    }
+    request.headers.append((name: decodeASCII(name[0..<name.count]),
+                            value: decodeASCII(bytes[valueStart..<valueEnd])))
+    lineStart = lineEnd + 2
+  }
+
+  if let contentLength = request.header("content-length") {
+    guard let length = Int(contentLength)
+          where lineStart + length <= bytes.count else {
+      return nil
+    }
+    request.body = bytes[lineStart..<lineStart + length]
+  }
+  return request
+}
+
+func makeSampleRequests() -> [[UInt8]] {
+  let commonHeaders =
+    "Host: api.example.com\r\n" +
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_11_5)\r\n" +
+    "Accept: application/json, text/plain, */*\r\n" +
+    "Accept-Encoding: gzip, deflate\r\n" +
+    "Accept-Language: en-US,en;q=0.8\r\n" +
+    "Cookie: session=4f2a9c1e8b7d6a5f; theme=dark; tracking=off\r\n" +
+    "Connection: keep-alive\r\n"
+  let body = "{\"name\": \"widget\", \"count\": 3, \"tags\": [\"x\", \"y\"]}"
+  let requests = [
+    "GET /index.html HTTP/1.1\r\n" + commonHeaders + "\r\n",
+    "GET /api/v1/users/1234?fields=name,email HTTP/1.1\r\n" +
+      commonHeaders + "Authorization: Bearer abcdef0123456789\r\n\r\n",
+    "POST /api/v1/widgets HTTP/1.1\r\n" + commonHeaders +
+      "Authorization: Bearer abcdef0123456789\r\n" +
+      "Content-Type: application/json\r\n" +
+      "Content-Length: \(body.utf8.count)\r\n\r\n" + body,
+    "GET /missing HTTP/1.1\r\n" + commonHeaders + "\r\n",
+  ]
+  return requests.map { Array($0.utf8) }
+}
+
+let sampleRequests = makeSampleRequests()
+
+@inline(never)
+public func run_ServerHTTPParse(_ N: Int) {
+  let requests = sampleRequests
+  for _ in 1...N {
+    var headerCount = 0
+    var bodyBytes = 0
+    for _ in 0..<25 {
+      for bytes in requests {
+        guard let request = parseHTTPRequest(bytes) else {
+          CheckResults(false, "Failed to parse HTTP request")
+          return
+        }
+        headerCount += request.headers.count
+        bodyBytes += request.body.count
+      }
+    }
+    CheckResults(headerCount == 25 * 32 && bodyBytes == 25 * 50,
+                 "Incorrect results in ServerHTTPParse")
+  }
+}
@@ -0,0 +1,178 @@
+//===--- Handlers.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Route parsed HTTP requests through a chain of middleware and to handlers,
+// all called through protocol types as in a web framework, and serialize
+// the responses. The handlers and middleware are a mix of structs and
+// classes, so calls through the existentials aren't monomorphic.
+import TestsUtils
+
+struct HTTPResponse {
+  var status = 200
+  var headers: [(name: String, value: String)] = []
+  var body: [UInt8] = []
+
+  func serialize(into buffer: inout [UInt8]) {
+    buffer.append(contentsOf: "HTTP/1.1 \(status)\r\n".utf8)
+    for header in headers {
+      buffer.append(contentsOf: header.name.utf8)
+      buffer.append(contentsOf: ": ".utf8)
+      buffer.append(contentsOf: header.value.utf8)
+      buffer.append(contentsOf: "\r\n".utf8)
+    }
+    buffer.append(contentsOf: "Content-Length: \(body.count)\r\n\r\n".utf8)
+    buffer.append(contentsOf: body)
+  }
+}
+
+protocol RequestHandler {
+  func handle(_ request: HTTPRequest, _ response: inout HTTPResponse)
+}
+
+protocol Middleware {
+  /// Returns false if the request should not be passed on to its handler.
+  func process(_ request: HTTPRequest, _ response: inout HTTPResponse) -> Bool
+}
+
+struct StaticTextHandler : RequestHandler {
+  let text: [UInt8]
+
+  func handle(_ request: HTTPRequest, _ response: inout HTTPResponse) {
+    response.headers.append((name: "Content-Type", value: "text/html"))
+    response.body = text
+  }
+}
+
+final class UserHandler : RequestHandler {
+  func handle(_ request: HTTPRequest, _ response: inout HTTPResponse) {
+    response.headers.append((name: "Content-Type",
+                             value: "application/json"))
+    response.body = Array("{\"path\": \"\(request.path)\"}".utf8)
+  }
+}
+
+final class CreateWidgetHandler : RequestHandler {
+  var created = 0
+
+  func handle(_ request: HTTPRequest, _ response: inout HTTPResponse) {
+    guard let widget = JSONParser.parse(Array(request.body))
+                         as? [String: Any],
+          let count = widget["count"] as? Int else {
+      response.status = 400
+      return
+    }
+    created += count
+    response.status = 201
+    response.body = Array("{\"created\": \(count)}".utf8)
+  }
+}
+
+struct NotFoundHandler : RequestHandler {
+  func handle(_ request: HTTPRequest, _ response: inout HTTPResponse) {
+    response.status = 404
+  }
+}
+
+final class RequestCounter : Middleware {
+  var count = 0
+
+  func process(_ request: HTTPRequest, _ response: inout HTTPResponse)
+    -> Bool {
+    count += 1
+    return true
+  }
+}
+
+struct AuthorizationMiddleware : Middleware {
+  let protectedPrefix: String
+
+  func process(_ request: HTTPRequest, _ response: inout HTTPResponse)
+    -> Bool {
+    if request.path.hasPrefix(protectedPrefix) &&
+       request.header("authorization") == nil {
+      response.status = 401
+      return false
+    }
+    return true
+  }
+}
+
+struct ServerHeaderMiddleware : Middleware {
+  func process(_ request: HTTPRequest, _ response: inout HTTPResponse)
+    -> Bool {
+    response.headers.append((name: "Server", value: "benchmark"))
+    if request.header("connection") == "keep-alive" {
+      response.headers.append((name: "Connection", value: "keep-alive"))
+    }
+    return true
+  }
+}
+
+final class Router {
+  var routes = [String: RequestHandler]()
+  var middleware = [Middleware]()
+  var notFound: RequestHandler = NotFoundHandler()
+
+  func dispatch(_ request: HTTPRequest) -> HTTPResponse {
+    var response = HTTPResponse()
+    for m in middleware {
+      if !m.process(request, &response) {
+        return response
+      }
+    }
+    // Route on the path without the query.
+    var path = request.path
+    if let query = path.characters.index(of: "?") {
+      path = String(path.characters[path.startIndex..<query])
+    }
+    let handler = routes[request.method + " " + path] ?? notFound
+    handler.handle(request, &response)
+    return response
+  }
+}
+
+func makeRouter() -> Router {
+  let router = Router()
+  router.middleware = [RequestCounter(),
+                       AuthorizationMiddleware(protectedPrefix: "/api/"),
+                       ServerHeaderMiddleware()]
+  router.routes["GET /index.html"] =
+    StaticTextHandler(text: Array("<html><body>Hello</body></html>".utf8))
+  router.routes["GET /api/v1/users/1234"] = UserHandler()
+  router.routes["POST /api/v1/widgets"] = CreateWidgetHandler()
+  return router
+}
+
+@inline(never)
+public func run_ServerHandlerDispatch(_ N: Int) {
+  let requests = sampleRequests
+  let router = makeRouter()
+  var output = [UInt8]()
+  for _ in 1...N {
+    var statusSum = 0
+    output.removeAll(keepingCapacity: true)
+    for _ in 0..<25 {
+      for bytes in requests {
+        guard let request = parseHTTPRequest(bytes) else {
+          CheckResults(false, "Failed to parse HTTP request")
+          return
+        }
+        let response = router.dispatch(request)
+        statusSum += response.status
+        response.serialize(into: &output)
+      }
+    }
+    CheckResults(statusSum == 25 * (200 + 200 + 201 + 404) &&
+                 output.count > 0,
+                 "Incorrect results in ServerHandlerDispatch")
+  }
+}
@@ -0,0 +1,299 @@
+//===--- JSON.swift -------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Parse JSON from UTF-8 bytes into the untyped values that server code
+// usually gets from a JSON library: [String: Any], [Any], String, Int,
+// Double, Bool and JSONNull.
+import TestsUtils
+
+/// The value of a JSON null.
+struct JSONNull {}
+
+struct JSONParser {
+  let bytes: [UInt8]
+  var position = 0
+
+  init(_ bytes: [UInt8]) {
+    self.bytes = bytes
+  }
+
+  static func parse(_ bytes: [UInt8]) -> Any? {
+    var parser = JSONParser(bytes)
+    guard let value = parser.parseValue() else {
+      return nil
+    }
+    parser.skipWhitespace()
+    return parser.position == bytes.count ? value : nil
+  }
+
+  mutating func skipWhitespace() {
+    while position < bytes.count {
+      switch bytes[position] {
+      case 0x20, 0x09, 0x0A, 0x0D:
+        position += 1
+      default:
+        return
+      }
+    }
+  }
+
+  /// Skip whitespace, and then `byte` if it is next.
+  mutating func consume(_ byte: UInt8) -> Bool {
+    skipWhitespace()
+    if position < bytes.count && bytes[position] == byte {
+      position += 1
+      return true
+    }
+    return false
+  }
+
+  mutating func parseValue() -> Any? {
+    skipWhitespace()
+    guard position < bytes.count else {
+      return nil
+    }
+    switch bytes[position] {
+    case 0x7B: // {
+      return parseObject()
+    case 0x5B: // [
+      return parseArray()
+    case 0x22: // "
+      return parseString()
+    case 0x74: // t
+      return parseLiteral("true", true)
+    case 0x66: // f
+      return parseLiteral("false", false)
+    case 0x6E: // n
+      return parseLiteral("null", JSONNull())
+    default:
+      return parseNumber()
+    }
+  }
+
+  mutating func parseObject() -> Any? {
+    position += 1
+    var object = [String: Any]()
+    if consume(0x7D) {
+      return object
+    }
+    repeat {
+      skipWhitespace()
+      guard position < bytes.count && bytes[position] == 0x22 else {
+        return nil
+      }
+      guard let key = parseString() where consume(0x3A) else {
+        return nil
+      }
+      guard let value = parseValue() else {
+        return nil
+      }
+      object[key] = value
+    } while consume(0x2C)
+    return consume(0x7D) ? object : nil
+  }
+
+  mutating func parseArray() -> Any? {
+    position += 1
+    var array = [Any]()
+    if consume(0x5D) {
+      return array
+    }
+    repeat {
+      guard let value = parseValue() else {
+        return nil
+      }
+      array.append(value)
+    } while consume(0x2C)
+    return consume(0x5D) ? array : nil
+  }
+
+  mutating func parseLiteral(_ text: StaticString, _ value: Any) -> Any? {
+    let count = text.utf8CodeUnitCount
+    guard position + count <= bytes.count else {
+      return nil
+    }
+    for i in 0..<count {
+      if bytes[position + i] != text.utf8Start[i] {
+        return nil
+      }
+    }
+    position += count
+    return value
+  }
+
+  mutating func parseString() -> String? {
+    position += 1
+    let start = position
+    // Strings without escapes are decoded directly from the input.
+    while position < bytes.count {
+      switch bytes[position] {
+      case 0x22:
+        let string = String._fromWellFormedCodeUnitSequence(
+          UTF8.self, input: bytes[start..<position])
+        position += 1
+        return string
+      case 0x5C:
+        return parseEscapedString(start)
+      default:
+        position += 1
+      }
+    }
+    return nil
+  }
+
+  mutating func parseEscapedString(_ start: Int) -> String? {
+    var utf8 = [UInt8](bytes[start..<position])
+    while position < bytes.count {
+      let byte = bytes[position]
+      position += 1
+      switch byte {
+      case 0x22:
+        return String._fromCodeUnitSequence(UTF8.self, input: utf8)
+      case 0x5C:
+        guard position < bytes.count else {
+          return nil
+        }
+        let escape = bytes[position]
+        position += 1
+        switch escape {
+        case 0x22, 0x5C, 0x2F: utf8.append(escape)
+        case 0x62: utf8.append(0x08) // b
+        case 0x66: utf8.append(0x0C) // f
+        case 0x6E: utf8.append(0x0A) // n
+        case 0x72: utf8.append(0x0D) // r
+        case 0x74: utf8.append(0x09) // t
+        case 0x75: // u
+          guard let scalar = parseHexScalar() else {
+            return nil
+          }
+          appendUTF8(scalar, to: &utf8)
+        default:
+          return nil
+        }
+      default:
+        utf8.append(byte)
+      }
+    }
+    return nil
+  }
+
+  /// Parse the four hex digits of a \u escape.
+  mutating func parseHexScalar() -> UInt32? {
+    guard position + 4 <= bytes.count else {
+      return nil
+    }
+    var value: UInt32 = 0
+    for _ in 0..<4 {
+      let byte = bytes[position]
+      position += 1
+      switch byte {
+      case 0x30...0x39: value = value * 16 + UInt32(byte - 0x30)
+      case 0x41...0x46: value = value * 16 + UInt32(byte - 0x41 + 10)
+      case 0x61...0x66: value = value * 16 + UInt32(byte - 0x61 + 10)
+      default: return nil
+      }
+    }
+    return value
+  }
+
+  func appendUTF8(_ scalar: UInt32, to utf8: inout [UInt8]) {
+    if scalar < 0x80 {
+      utf8.append(UInt8(scalar))
+    } else if scalar < 0x800 {
+      utf8.append(UInt8(0xC0 | scalar >> 6))
+      utf8.append(UInt8(0x80 | scalar & 0x3F))
+    } else {
+      utf8.append(UInt8(0xE0 | scalar >> 12))
+      utf8.append(UInt8(0x80 | (scalar >> 6) & 0x3F))
+      utf8.append(UInt8(0x80 | scalar & 0x3F))
+    }
+  }
+
+  mutating func parseNumber() -> Any? {
+    let start = position
+    var negative = false
+    if position < bytes.count && bytes[position] == 0x2D {
+      negative = true
+      position += 1
+    }
+    var integer = 0
+    var isInteger = true
+    let digitsStart = position
+    while position < bytes.count {
+      let byte = bytes[position]
+      if byte >= 0x30 && byte <= 0x39 {
+        integer = integer &* 10 &+ Int(byte - 0x30)
+      } else if byte == 0x2E || byte == 0x65 || byte == 0x45 ||
+                byte == 0x2B || byte == 0x2D {
+        isInteger = false
+      } else {
+        break
+      }
+      position += 1
+    }
+    if position == digitsStart {
+      return nil
+    }
+    if isInteger {
+      return negative ? -integer : integer
+    }
+    let text = String._fromWellFormedCodeUnitSequence(
+      UTF8.self, input: bytes[start..<position])
+    return Double(text)
+  }
+}
+
+func makeJSONDocument(_ count: Int) -> [UInt8] {
+  var json = "["
+  for i in 0..<count {
+    if i > 0 {
+      json += ","
+    }
+    json += "{\"id\": \(i), \"name\": \"user\(i)\", " +
+            "\"email\": \"user\(i)@example.com\", " +
+            "\"bio\": \"Caf\\u00e9 owner \\\"since\\\" \(2000 + i % 16)\\n\", " +
+            "\"active\": \(i % 3 != 0), \"score\": \(i).25, " +
+            "\"manager\": null, \"tags\": [\"a\", \"b\", \"c\(i % 7)\"], " +
+            "\"address\": {\"street\": \"\(i) Main St\", \"zip\": \"9\(i)\"}}"
+  }
+  json += "]"
+  return Array(json.utf8)
+}
+
+let jsonDocument = makeJSONDocument(100)
+
+@inline(never)
+public func run_ServerJSONParse(_ N: Int) {
+  let document = jsonDocument
+  for _ in 1...N {
+    guard let records = JSONParser.parse(document) as? [Any] else {
+      CheckResults(false, "Failed to parse JSON")
+      return
+    }
+    var idSum = 0
+    var activeCount = 0
+    var tagCount = 0
+    for case let record as [String: Any] in records {
+      if let id = record["id"] as? Int {
+        idSum += id
+      }
+      if let active = record["active"] as? Bool where active {
+        activeCount += 1
+      }
+      if let tags = record["tags"] as? [Any] {
+        tagCount += tags.count
+      }
+    }
+    CheckResults(idSum == 4950 && activeCount == 66 && tagCount == 300,
+                 "Incorrect results in ServerJSONParse")
+  }
+}
@@ -15,6 +15,9 @@
 
 import argparse
 import csv
+import math
+import random
+import re
 import sys
 
 TESTNAME = 1
@@ -24,6 +27,22 @@ MAX = 4
 MEAN = 5
 SD = 6
 MEDIAN = 7
+# The per-iteration counters the driver can report after MEDIAN, with the
+# titles of their sections in the report. ALLOCS is only present when the
+# driver was run with --allocations, RETAINS and RELEASES with
+# --retains-releases, so they are located by the header row.
+COUNTERS = [('ALLOCS', 'Allocation Changes'),
+            ('RETAINS', 'Retain Changes'),
+            ('RELEASES', 'Release Changes')]
+
+# The raw samples of a test in the driver's --verbose output.
+RUNNING_RE = re.compile(r'^Running (\S+) for \d+ samples\.$')
+SAMPLE_RE = re.compile(r'^\s+Sample \d+,(\d+)$')
+
+# Tests with fewer raw samples than this in either log are compared with
+# --delta-threshold instead of a significance test.
+MIN_SAMPLES = 5
+BOOTSTRAP_RESAMPLES = 1000
 
 HTML = """
 <!DOCTYPE html>
@@ -80,6 +99,8 @@ def main():
     new_results = {}
     old_max_results = {}
     new_max_results = {}
+    old_counters = dict((name, {}) for (name, _) in COUNTERS)
+    new_counters = dict((name, {}) for (name, _) in COUNTERS)
     ratio_list = {}
     delta_list = {}
     unknown_list = {}
@@ -107,6 +128,13 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--significance',
+                        help='significance level of the test used for logs '
+                             'with raw samples', default="0.05")
+    parser.add_argument('--fail-on-counter-increase',
+                        help='exit with status 1 if the allocations, retains '
+                             'or releases per iteration of any test increase',
+                        action='store_true')
 
     args = parser.parse_args()
 
@@ -122,7 +150,10 @@ def main():
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
 
+    old_columns = {}
     for row in old_data:
+        if row and row[0] == '#':
+            old_columns = counter_columns(row)
         if (len(row) > 7 and row[MIN].isdigit()):
             if row[TESTNAME] in old_results:
                 if old_results[row[TESTNAME]] > int(row[MIN]):
@@ -132,8 +163,12 @@ def main():
             else:
                 old_results[row[TESTNAME]] = int(row[MIN])
                 old_max_results[row[TESTNAME]] = int(row[MAX])
+            read_counters(row, old_columns, old_counters)
 
+    new_columns = {}
     for row in new_data:
+        if row and row[0] == '#':
+            new_columns = counter_columns(row)
         if (len(row) > 7 and row[MIN].isdigit()):
             if row[TESTNAME] in new_results:
                 if int(new_results[row[TESTNAME]]) > int(row[MIN]):
@@ -143,6 +178,7 @@ def main():
             else:
                 new_results[row[TESTNAME]] = int(row[MIN])
                 new_max_results[row[TESTNAME]] = int(row[MAX])
+            read_counters(row, new_columns, new_counters)
 
     ratio_total = 0
     for key in new_results.keys():
@@ -160,10 +196,50 @@ def main():
             else:
                     unknown_list[key] = ""
 
+    """
+    If both logs have enough raw samples of a test, it is only reported as
+    changed if the Mann-Whitney U test finds a significant difference and the
+    bootstrap confidence interval of the change in the median excludes zero.
+    The delta is then the change in the median, with its confidence interval.
+    """
+    significance = float(args.significance)
+    old_samples = read_samples(old_file)
+    new_samples = read_samples(new_file)
+    change_list = {}
+    delta_text = {}
+    for key in new_results.keys():
+        if (len(old_samples.get(key, [])) >= MIN_SAMPLES and
+                len(new_samples.get(key, [])) >= MIN_SAMPLES):
+            p_value = mann_whitney_p_value(old_samples[key],
+                                           new_samples[key])
+            (low, high) = bootstrap_delta_interval(
+                old_samples[key], new_samples[key], 1 - significance)
+            delta_list[key] = round(
+                relative_delta(median(old_samples[key]),
+                               median(new_samples[key])), 2)
+            delta_text[key] = "{0:+.1f}% [{1:+.1f}, {2:+.1f}]".format(
+                delta_list[key], low, high)
+            unknown_list[key] = ""
+            if p_value < significance and low > 0:
+                change_list[key] = -1
+            elif p_value < significance and high < 0:
+                change_list[key] = 1
+            else:
+                change_list[key] = 0
+        else:
+            delta_text[key] = "{0:+.1f}%".format(delta_list[key])
+            if ratio_list[key] < RATIO_MIN:
+                change_list[key] = -1
+            elif ratio_list[key] > RATIO_MAX:
+                change_list[key] = 1
+            else:
+                change_list[key] = 0
+
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, change_list,
+                                         args.changes_only)
 
     """
     Create markdown formatted table
@@ -171,7 +247,7 @@ def main():
     test_name_width = max_width(ratio_list, title='TEST', key_len=True)
     new_time_width = max_width(new_results, title=new_branch)
     old_time_width = max_width(old_results, title=old_branch)
-    delta_width = max_width(delta_list, title='DELTA (%)')
+    delta_width = max_width(delta_text, title='DELTA (%)')
 
     markdown_table_header = "\n" + MARKDOWN_ROW.format(
                                         "TEST".ljust(test_name_width),
@@ -194,7 +270,7 @@ def main():
             key.ljust(test_name_width),
             str(old_results[key]).ljust(old_time_width),
             str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
+            delta_text[key].ljust(delta_width),
             "**{0}{1}**".format(str(ratio).ljust(2), unknown_list[key]))
 
     markdown_improvement = ""
@@ -206,7 +282,7 @@ def main():
             key.ljust(test_name_width),
             str(old_results[key]).ljust(old_time_width),
             str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
+            delta_text[key].ljust(delta_width),
             "**{0}{1}**".format(str(ratio).ljust(2), unknown_list[key]))
 
     markdown_normal = ""
@@ -218,7 +294,7 @@ def main():
             key.ljust(test_name_width),
             str(old_results[key]).ljust(old_time_width),
             str(new_results[key]).ljust(new_time_width),
-            ("{0:+.1f}%".format(delta_list[key])).ljust(delta_width),
+            delta_text[key].ljust(delta_width),
             "{0}{1}".format(str(ratio).ljust(2), unknown_list[key]))
 
     markdown_data = MARKDOWN_DETAIL.format("Regression",
@@ -232,6 +308,27 @@ def main():
                                                 len(normal_perf_list),
                                                 markdown_normal, "")
 
+    """
+    The counters are deterministic, so any change is reported.
+    """
+    counter_tables = []
+    counter_increased = False
+    for (name, title) in COUNTERS:
+        old_counts = old_counters[name]
+        new_counts = new_counters[name]
+        changes = sorted(key for key in new_counts.keys()
+                         if key in old_counts and
+                         old_counts[key] != new_counts[key])
+        if not changes:
+            continue
+        if any(new_counts[key] > old_counts[key] for key in changes):
+            counter_increased = True
+        table = counter_table(changes, old_counts, new_counts,
+                              test_name_width, old_branch, new_branch)
+        counter_tables.append((title, table))
+        markdown_data += MARKDOWN_DETAIL.format(title, len(changes), table,
+                                                "open")
+
     if args.format:
         if args.format.lower() != "markdown":
             pain_data = PAIN_DETAIL.format("Regression", markdown_regression)
@@ -239,6 +336,8 @@ def main():
                                             markdown_improvement)
             if not args.changes_only:
                 pain_data += PAIN_DETAIL.format("No Changes", markdown_normal)
+            for (title, table) in counter_tables:
+                pain_data += PAIN_DETAIL.format(title, table)
 
             print(pain_data.replace("|", " ").replace("-", " "))
         else:
@@ -249,9 +348,10 @@ def main():
             """
             Create HTML formatted table
             """
-            html_data = convert_to_html(ratio_list, old_results, new_results,
-                                        delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+            html_data = convert_to_html(ratio_list, change_list, old_results,
+                                        new_results, delta_text, unknown_list,
+                                        old_branch, new_branch,
+                                        args.changes_only)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -265,19 +365,62 @@ def main():
             print("{0} is unknown format.".format(args.format))
             sys.exit(1)
 
+    if args.fail_on_counter_increase and counter_increased:
+        sys.exit(1)
+
+
+def counter_columns(header):
+    """
+    Return the columns of the counters in the driver's header row.
+    """
+    return dict((name, header.index(name)) for (name, _) in COUNTERS
+                if name in header)
+
+
+def read_counters(row, columns, counters):
+    for (name, column) in columns.items():
+        if len(row) > column and row[column].isdigit():
+            counters[name][row[TESTNAME]] = int(row[column])
+
+
+def counter_table(changes, old_counts, new_counts, test_name_width,
+                  old_branch, new_branch):
+    width = max([len(old_branch), len(new_branch)] +
+                [len(str(counts[key])) for key in changes
+                 for counts in (old_counts, new_counts)])
+    table = "\n" + MARKDOWN_ROW.format(
+        "TEST".ljust(test_name_width),
+        old_branch.ljust(width),
+        new_branch.ljust(width),
+        "DELTA".ljust(width), "")
+    table += MARKDOWN_ROW.format(
+        HEADER_SPLIT.ljust(test_name_width),
+        HEADER_SPLIT.ljust(width),
+        HEADER_SPLIT.ljust(width),
+        HEADER_SPLIT.ljust(width), "")
+    for key in changes:
+        table += MARKDOWN_ROW.format(
+            key.ljust(test_name_width),
+            str(old_counts[key]).ljust(width),
+            str(new_counts[key]).ljust(width),
+            "{0:+d}".format(new_counts[key] - old_counts[key]).ljust(width),
+            "")
+    return table
+
 
-def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+def convert_to_html(ratio_list, change_list, old_results, new_results,
+                    delta_text, unknown_list, old_branch, new_branch,
+                    changes_only):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, change_list, changes_only)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if change_list[key] < 0:
             color = "red"
-        elif ratio_list[key] > RATIO_MAX:
+        elif change_list[key] > 0:
             color = "green"
         else:
             color = "black"
@@ -296,7 +439,7 @@ def convert_to_html(ratio_list, old_results, new_results, delta_list,
 
         html_rows += HTML_ROW.format(key, old_results[key],
                                      new_results[key],
-                                     "{0:+.1f}%".format(delta_list[key]),
+                                     delta_text[key],
                                      color,
                                      "{0:.2f}x {1}".format(ratio_list[key],
                                                            unknown_list[key]))
@@ -316,9 +459,90 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def read_samples(file_name):
+    """
+    Return the raw samples of each test in a log of the driver's --verbose
+    output. The samples of all runs of a test are combined.
+    """
+    samples = {}
+    test = None
+    for line in open(file_name):
+        m = RUNNING_RE.match(line)
+        if m:
+            test = m.group(1)
+            continue
+        m = SAMPLE_RE.match(line)
+        if m and test:
+            samples.setdefault(test, []).append(int(m.group(1)))
+    return samples
+
+
+def median(samples):
+    samples = sorted(samples)
+    n = len(samples)
+    if n % 2:
+        return samples[n // 2]
+    return (samples[n // 2 - 1] + samples[n // 2]) / 2.0
+
+
+def relative_delta(old, new):
+    """
+    Return the change from old to new in percent.
+    """
+    return ((float(new) + 0.001) / (old + 0.001) - 1) * 100
+
+
+def mann_whitney_p_value(a, b):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test of the samples a
+    and b, using the normal approximation with a correction for ties.
+    """
+    n1 = len(a)
+    n2 = len(b)
+    n = n1 + n2
+    combined = sorted([(value, 0) for value in a] + [(value, 1) for value in b])
+    rank_sum = 0.0
+    ties = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j < n and combined[j][0] == combined[i][0]:
+            j += 1
+        # Tied values get the average of their ranks, i + 1 through j.
+        rank = (i + 1 + j) / 2.0
+        rank_sum += rank * len([x for x in combined[i:j] if x[1] == 0])
+        ties += (j - i) ** 3 - (j - i)
+        i = j
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1)))
+    if variance == 0:
+        return 1.0
+    z = max(abs(u - n1 * n2 / 2.0) - 0.5, 0) / math.sqrt(variance)
+    return math.erfc(z / math.sqrt(2))
+
+
+def bootstrap_delta_interval(old, new, confidence):
+    """
+    Return a bootstrap confidence interval of the change in percent of the
+    median from the samples old to the samples new.
+    """
+    # Use a fixed seed so that comparing the same logs twice gives the same
+    # interval.
+    rng = random.Random(0)
+    deltas = []
+    for _ in range(BOOTSTRAP_RESAMPLES):
+        old_median = median([rng.choice(old) for _ in old])
+        new_median = median([rng.choice(new) for _ in new])
+        deltas.append(relative_delta(old_median, new_median))
+    deltas.sort()
+    tail = int((1 - confidence) / 2 * BOOTSTRAP_RESAMPLES)
+    return (deltas[tail], deltas[BOOTSTRAP_RESAMPLES - 1 - tail])
+
+
+def sort_ratio_list(ratio_list, change_list, changes_only=False):
     """
-    Return 3 sorted list improvement, regression and normal.
+    Return 3 sorted list improvement, regression and normal. change_list is
+    negative for regressions and positive for improvements.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -326,9 +550,9 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        if change_list[key] < 0:
             decreased_perf_list.append(key)
-        elif ratio_list[key] > RATIO_MAX:
+        elif change_list[key] > 0:
             increased_perf_list.append(key)
         else:
             normal_perf_list[key] = v
@@ -45,8 +45,8 @@ if __name__ == '__main__':
 
         def __init__(self, path):
             self.name = os.path.basename(path)
-            self.files = [x for x in os.listdir(path)
-                          if x.endswith('.swift')]
+            self.files = sorted(x for x in os.listdir(path)
+                                if x.endswith('.swift'))
     if os.path.isdir(multi_source_dir):
         multisource_benches = [
             MultiSourceBench(os.path.join(multi_source_dir, x))
@@ -0,0 +1,44 @@
+//===--- LazyPipeline.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Chains of lazy adaptors, which the standard library fuses into a single
+// adaptor over the base collection.
+
+import TestsUtils
+
+@inline(never)
+public func run_LazyMapMapMap(_ N: Int) {
+  let numbers = [Int](0..<1000)
+
+  var c = 0
+  for _ in 1...N*100 {
+    let mapped = numbers.lazy.map { $0 &+ 5 }.map { $0 &* 3 }.map { $0 &- 1 }
+    for x in mapped {
+      c = c &+ x
+    }
+  }
+  CheckResults(c != 0, "IncorrectResults in LazyMapMapMap")
+}
+
+@inline(never)
+public func run_LazyFilterFilter(_ N: Int) {
+  let numbers = [Int](0..<1000)
+
+  var c = 0
+  for _ in 1...N*100 {
+    let filtered = numbers.lazy.filter { $0 % 2 == 0 }.filter { $0 % 3 == 0 }
+    for x in filtered {
+      c = c &+ x
+    }
+  }
+  CheckResults(c != 0, "IncorrectResults in LazyFilterFilter")
+}
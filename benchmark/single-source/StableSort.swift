@@ -0,0 +1,64 @@
+//===--- StableSort.swift -------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Test stableSort() on inputs with different amounts of existing order.
+import TestsUtils
+
+let stableSortCount = 10_000
+
+/// Timestamps that are in order except for a few entries appended late.
+func makeNearlySorted() -> [Int] {
+  SRand()
+  var result = Array(0..<stableSortCount)
+  for _ in 0..<(stableSortCount / 100) {
+    let i = Int(UInt64(bitPattern: Random()) % UInt64(stableSortCount))
+    result[i] = Int(UInt64(bitPattern: Random()) % UInt64(stableSortCount))
+  }
+  return result
+}
+
+func makeRandom() -> [Int] {
+  SRand()
+  return (0..<stableSortCount).map { _ in Int(Random()) }
+}
+
+func isSorted(_ a: [Int]) -> Bool {
+  for i in 1..<a.count where a[i - 1] > a[i] {
+    return false
+  }
+  return true
+}
+
+@inline(never)
+func benchStableSort(_ input: [Int], _ N: Int, _ name: String) {
+  for _ in 1...10*N {
+    var a = input
+    a.stableSort()
+    CheckResults(isSorted(a), "Incorrect results in \(name)")
+  }
+}
+
+@inline(never)
+public func run_StableSortNearlySorted(_ N: Int) {
+  benchStableSort(makeNearlySorted(), N, "StableSortNearlySorted")
+}
+
+@inline(never)
+public func run_StableSortReversed(_ N: Int) {
+  benchStableSort(
+    Array((0..<stableSortCount).reversed()), N, "StableSortReversed")
+}
+
+@inline(never)
+public func run_StableSortRandom(_ N: Int) {
+  benchStableSort(makeRandom(), N, "StableSortRandom")
+}
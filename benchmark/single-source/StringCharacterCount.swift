@@ -0,0 +1,43 @@
+//===--- StringCharacterCount.swift ---------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Test the performance of walking the characters of a string, which needs
+// grapheme cluster boundaries.
+import TestsUtils
+
+let asciiText = "Swift is a multi-paradigm, compiled programming language\r\ncreated for iOS, OS X, watchOS, tvOS and Linux development by Apple Inc.\r\n"
+
+// Latin text with a decomposed accent and a non-ASCII punctuation mark.
+let mixedText = "Ne\u{301}anmoins, l'e\u{301}te\u{301} dernier, nous avons visite\u{301} Montre\u{301}al \u{2014} et Que\u{301}bec.\n"
+
+@inline(never)
+func countCharacters(_ s: String) -> Int {
+  return s.characters.count
+}
+
+@inline(never)
+public func run_StringCharacterCountASCII(_ N: Int) {
+  var count = 0
+  for _ in 1...5000*N {
+    count += countCharacters(asciiText)
+  }
+  CheckResults(count == 5000*N*130, "Incorrect results in StringCharacterCountASCII: \(count) != \(5000*N*130)")
+}
+
+@inline(never)
+public func run_StringCharacterCountMixed(_ N: Int) {
+  var count = 0
+  for _ in 1...5000*N {
+    count += countCharacters(mixedText)
+  }
+  CheckResults(count == 5000*N*66, "Incorrect results in StringCharacterCountMixed: \(count) != \(5000*N*66)")
+}
@@ -0,0 +1,205 @@
+//===--- ThreadScaling.swift ----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Run workloads that hit shared runtime state on 1, 2, 4 and 8 threads.
+// Every thread does the same amount of work, so without contention the
+// times of all thread counts are equal, and time(1) / time(T) is the
+// scaling efficiency on T threads.
+import TestsUtils
+
+protocol ScalingProtocol {
+  func value() -> Int
+}
+
+final class ScalingClass : ScalingProtocol {
+  func value() -> Int { return 1 }
+}
+
+struct ScalingStruct : ScalingProtocol {
+  func value() -> Int { return 1 }
+}
+
+/// Values of different types, only some of which conform to
+/// ScalingProtocol, so that casts fail as well as succeed.
+@inline(never)
+func makeCastSources() -> [Any] {
+  return [ScalingClass(), ScalingStruct(), 1, "", 1.0, [1]]
+}
+
+let castSources = makeCastSources()
+
+@inline(never)
+func castWorkload(_ N: Int) {
+  var count = 0
+  for _ in 0..<1_000*N {
+    for source in castSources {
+      if let p = source as? ScalingProtocol {
+        count += p.value()
+      }
+    }
+  }
+  CheckResults(count == 2_000*N, "Incorrect results in ThreadScalingCast")
+}
+
+struct ScalingGeneric<T> {
+  var value: T
+}
+
+protocol MetadataSource {
+  func instantiate() -> Any.Type
+}
+
+/// The witness of instantiate is only called through existentials, so it
+/// isn't specialized and requests the metadata from the runtime every time.
+struct GenericMetadataSource<T> : MetadataSource {
+  func instantiate() -> Any.Type {
+    return ScalingGeneric<T>.self
+  }
+}
+
+@inline(never)
+func makeMetadataSources() -> [MetadataSource] {
+  return [
+    GenericMetadataSource<Int>(), GenericMetadataSource<String>(),
+    GenericMetadataSource<ScalingClass>(), GenericMetadataSource<[Int]>(),
+    GenericMetadataSource<Double>(), GenericMetadataSource<ScalingStruct>(),
+  ]
+}
+
+let metadataSources = makeMetadataSources()
+
+@inline(never)
+func metadataWorkload(_ N: Int) {
+  var count = 0
+  for _ in 0..<1_000*N {
+    for source in metadataSources {
+      if source.instantiate() != Int.self {
+        count += 1
+      }
+    }
+  }
+  CheckResults(count == 6_000*N, "Incorrect results in ThreadScalingMetadata")
+}
+
+final class SharedObject {
+  var value = 1
+}
+
+final class ObjectHolder {
+  var object: SharedObject
+  init(_ object: SharedObject) { self.object = object }
+}
+
+let sharedObject = SharedObject()
+
+/// Every store retains the object shared by all threads and releases the
+/// previous value, which is the same object.
+@inline(never)
+func retainReleaseWorkload(_ N: Int) {
+  let holder = ObjectHolder(sharedObject)
+  for _ in 0..<100_000*N {
+    holder.object = sharedObject
+  }
+  CheckResults(holder.object.value == 1,
+               "Incorrect results in ThreadScalingRetainRelease")
+}
+
+/// Every store allocates a new object and frees the previous one.
+@inline(never)
+func allocationWorkload(_ N: Int) {
+  let holder = ObjectHolder(SharedObject())
+  for _ in 0..<10_000*N {
+    holder.object = SharedObject()
+  }
+  CheckResults(holder.object.value == 1,
+               "Incorrect results in ThreadScalingAllocation")
+}
+
+@inline(never)
+public func run_ThreadScalingCast1(_ N: Int) {
+  runConcurrently(1) { _ in castWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingCast2(_ N: Int) {
+  runConcurrently(2) { _ in castWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingCast4(_ N: Int) {
+  runConcurrently(4) { _ in castWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingCast8(_ N: Int) {
+  runConcurrently(8) { _ in castWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingMetadata1(_ N: Int) {
+  runConcurrently(1) { _ in metadataWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingMetadata2(_ N: Int) {
+  runConcurrently(2) { _ in metadataWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingMetadata4(_ N: Int) {
+  runConcurrently(4) { _ in metadataWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingMetadata8(_ N: Int) {
+  runConcurrently(8) { _ in metadataWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingRetainRelease1(_ N: Int) {
+  runConcurrently(1) { _ in retainReleaseWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingRetainRelease2(_ N: Int) {
+  runConcurrently(2) { _ in retainReleaseWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingRetainRelease4(_ N: Int) {
+  runConcurrently(4) { _ in retainReleaseWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingRetainRelease8(_ N: Int) {
+  runConcurrently(8) { _ in retainReleaseWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingAllocation1(_ N: Int) {
+  runConcurrently(1) { _ in allocationWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingAllocation2(_ N: Int) {
+  runConcurrently(2) { _ in allocationWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingAllocation4(_ N: Int) {
+  runConcurrently(4) { _ in allocationWorkload(N) }
+}
+
+@inline(never)
+public func run_ThreadScalingAllocation8(_ N: Int) {
+  runConcurrently(8) { _ in allocationWorkload(N) }
+}
@@ -0,0 +1,86 @@
+//===--- ColdStart.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// A minimal program for measuring process launch, run by
+// scripts/Benchmark_ColdStart. It prints the wall-clock time at which main
+// was entered, so that the script can compute the time to main, and then
+// the time taken by the first use of a generic type and the first
+// protocol conformance lookup in the process. The latter includes
+// registering the conformance sections of every loaded image.
+//
+// This is deliberately not linked with the benchmark driver, so that only
+// the runtime and the standard library are loaded.
+
+#if os(Linux)
+import Glibc
+#else
+import Darwin
+#endif
+
+var mainEntered = timeval(tv_sec: 0, tv_usec: 0)
+gettimeofday(&mainEntered, nil)
+
+#if os(Linux)
+func now() -> UInt64 {
+  var ts = timespec(tv_sec: 0, tv_nsec: 0)
+  clock_gettime(CLOCK_MONOTONIC, &ts)
+  return UInt64(ts.tv_sec) * 1_000_000_000 + UInt64(ts.tv_nsec)
+}
+#else
+var timebase = mach_timebase_info_data_t(numer: 0, denom: 0)
+mach_timebase_info(&timebase)
+func now() -> UInt64 {
+  return mach_absolute_time() * UInt64(timebase.numer) / UInt64(timebase.denom)
+}
+#endif
+
+protocol ColdStartProtocol {
+  func value() -> Int
+}
+
+final class ColdStartBox<T> {
+  var boxed: T
+  init(_ boxed: T) {
+    self.boxed = boxed
+  }
+}
+
+struct ColdStartConformer : ColdStartProtocol {
+  func value() -> Int { return 1 }
+}
+
+@inline(never)
+func makeBox<T>(_ value: T) -> AnyObject {
+  return ColdStartBox(value)
+}
+
+@inline(never)
+func lookUpConformance(_ value: Any) -> Bool {
+  return value is ColdStartProtocol
+}
+
+let genericStart = now()
+let box = makeBox(42)
+let genericEnd = now()
+
+let conformanceStart = now()
+let conforms = lookUpConformance(ColdStartConformer())
+let conformanceEnd = now()
+
+if !conforms || !(box is ColdStartBox<Int>) {
+  print("unexpected result")
+  exit(1)
+}
+
+print("MainEntered,\(Int(mainEntered.tv_sec) * 1_000_000 + Int(mainEntered.tv_usec))")
+print("FirstGenericUse,\((genericEnd - genericStart) / 1_000)")
+print("FirstConformanceLookup,\((conformanceEnd - conformanceStart) / 1_000)")
@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if os(Linux)
+import Glibc
+#else
 import Darwin
+#endif
 
 struct BenchResults {
   var delim: String  = ","
@@ -20,8 +24,14 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  /// The number of objects allocated per iteration, if allocations are
+  /// counted.
+  var allocations: UInt64? = nil
+  /// The number of retains and releases per iteration, if they are counted.
+  var retains: UInt64? = nil
+  var releases: UInt64? = nil
   init() {}
-  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
+  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64, allocations: UInt64? = nil, retains: UInt64? = nil, releases: UInt64? = nil) {
     self.delim = delim
     self.sampleCount = sampleCount
     self.min = min
@@ -29,6 +39,9 @@ struct BenchResults {
     self.mean = mean
     self.sd = sd
     self.median = median
+    self.allocations = allocations
+    self.retains = retains
+    self.releases = releases
 
     // Sanity the bounds of our results
     precondition(self.min <= self.max, "min should always be <= max")
@@ -41,7 +54,14 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     var result = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     if let allocations = allocations {
+       result += "\(delim)\(allocations)"
+     }
+     if let retains = retains, releases = releases {
+       result += "\(delim)\(retains)\(delim)\(releases)"
+     }
+     return result
   }
 }
 
@@ -88,12 +108,27 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// The number of iterations to run each test for, untimed, before taking
+  /// its samples.
+  var numWarmupIters: Int = 0
+
+  /// The CPU to pin the harness to, if any. Only supported on Linux.
+  var cpu: Int? = nil
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
   /// Should we only run the "pre-commit" tests?
   var onlyPrecommit: Bool = true
 
+  /// Should we count the objects each test allocates? This requires the
+  /// runtime statistics to be enabled with SWIFT_RUNTIME_STATS=1.
+  var countAllocations: Bool = false
+
+  /// Should we count the retains and releases each test performs? This also
+  /// requires SWIFT_RUNTIME_STATS=1.
+  var countRetainsReleases: Bool = false
+
   /// After we run the tests, should the harness sleep to allow for utilities
   /// like leaks that require a PID to run on the test harness.
   var afterRunSleep: Int? = nil
@@ -103,7 +138,8 @@ struct TestConfig {
 
   mutating func processArguments() -> TestAction {
     let validOptions=["--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"]
+      "--verbose", "--delim", "--run-all", "--list", "--sleep",
+      "--allocations", "--retains-releases", "--num-warmup-iters", "--cpu"]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
       return .Fail("Failed to parse arguments")
@@ -129,6 +165,19 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--num-warmup-iters"] {
+      if x.isEmpty { return .Fail("--num-warmup-iters requires a value") }
+      numWarmupIters = Int(x)!
+    }
+
+    if let x = benchArgs.optionalArgsMap["--cpu"] {
+      let v: Int? = Int(x)
+      if v == nil || v! < 0 {
+        return .Fail("--cpu requires a non-negative integer value")
+      }
+      cpu = v!
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -143,6 +192,20 @@ struct TestConfig {
       onlyPrecommit = false
     }
 
+    if let _ = benchArgs.optionalArgsMap["--allocations"] {
+      if getenv("SWIFT_RUNTIME_STATS") == nil {
+        return .Fail("--allocations requires SWIFT_RUNTIME_STATS=1")
+      }
+      countAllocations = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--retains-releases"] {
+      if getenv("SWIFT_RUNTIME_STATS") == nil {
+        return .Fail("--retains-releases requires SWIFT_RUNTIME_STATS=1")
+      }
+      countRetainsReleases = true
+    }
+
     if let x = benchArgs.optionalArgsMap["--sleep"] {
       if x.isEmpty {
         return .Fail("--sleep requires a non-empty integer value")
@@ -224,28 +287,107 @@ func stopTrackingObjects(_: UnsafeMutablePointer<Void>) -> Int
 
 #endif
 
-class SampleRunner {
+@_silgen_name("swift_runtimeStatsGetCallCount")
+func runtimeStatsGetCallCount(_: UnsafePointer<CChar>) -> UInt64
+
+/// A monotonic clock with nanosecond resolution.
+struct MonotonicClock {
+#if os(Linux)
+  func now() -> UInt64 {
+    var ts = timespec(tv_sec: 0, tv_nsec: 0)
+    clock_gettime(CLOCK_MONOTONIC, &ts)
+    return UInt64(ts.tv_sec) * 1_000_000_000 + UInt64(ts.tv_nsec)
+  }
+#else
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
   init() {
     mach_timebase_info(&info)
   }
+  func now() -> UInt64 {
+    return mach_absolute_time() * UInt64(info.numer) / UInt64(info.denom)
+  }
+#endif
+}
+
+/// Pin the harness to `cpu`, and warn if the CPU's frequency may change
+/// while benchmarks are running. Returns an error message on failure.
+func pinToCPU(_ cpu: Int) -> String? {
+#if os(Linux)
+  var set = cpu_set_t()
+  let bitsPerWord = 8 * sizeof(UInt.self)
+  let maxCPUs = 8 * sizeof(cpu_set_t.self)
+  if cpu >= maxCPUs {
+    return "--cpu must be less than \(maxCPUs)"
+  }
+  withUnsafeMutablePointer(&set) {
+    let words = UnsafeMutablePointer<UInt>($0)
+    words[cpu / bitsPerWord] |= 1 << UInt(cpu % bitsPerWord)
+  }
+  if sched_setaffinity(0, sizeof(cpu_set_t.self), &set) != 0 {
+    return "failed to pin to CPU \(cpu): \(String(cString: strerror(errno)))"
+  }
+
+  // Frequency scaling makes the results depend on the recent load of the
+  // machine.
+  let path = "/sys/devices/system/cpu/cpu\(cpu)/cpufreq/scaling_governor"
+  if let file = fopen(path, "r") {
+    var buffer = [CChar](repeating: 0, count: 64)
+    if fgets(&buffer, Int32(buffer.count), file) != nil {
+      let line = String(cString: buffer)
+      let governor = String(line.characters.dropLast())
+      if governor != "performance" {
+        print("warning: CPU \(cpu) uses the \"\(governor)\" frequency "
+            + "governor; results may be unstable")
+      }
+    }
+    fclose(file)
+  }
+  return nil
+#else
+  return "--cpu is only supported on Linux"
+#endif
+}
+
+class SampleRunner {
+  let clock = MonotonicClock()
+  /// The number of objects allocated by the last run.
+  var allocations: UInt64 = 0
+  /// The number of retains and releases performed by the last run.
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+
+  func retainCount() -> UInt64 {
+    return runtimeStatsGetCallCount("swift_retain") +
+           runtimeStatsGetCallCount("swift_retain_n")
+  }
+
+  func releaseCount() -> UInt64 {
+    return runtimeStatsGetCallCount("swift_release") +
+           runtimeStatsGetCallCount("swift_release_n")
+  }
+
   func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     var str = name
     startTrackingObjects(UnsafeMutablePointer<Void>(str._core.startASCII))
 #endif
-    let start_ticks = mach_absolute_time()
+    let start_allocations = runtimeStatsGetCallCount("swift_allocObject")
+    let start_retains = retainCount()
+    let start_releases = releaseCount()
+    let start_time = clock.now()
     fn(Int(num_iters))
     // Stop the timer.
-    let end_ticks = mach_absolute_time()
+    let end_time = clock.now()
+    allocations =
+      runtimeStatsGetCallCount("swift_allocObject") - start_allocations
+    retains = retainCount() - start_retains
+    releases = releaseCount() - start_releases
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     stopTrackingObjects(UnsafeMutablePointer<Void>(str._core.startASCII))
 #endif
 
-    // Compute the spent time and the scaling factor.
-    let elapsed_ticks = end_ticks - start_ticks
-    return elapsed_ticks * UInt64(info.numer) / UInt64(info.denom)
+    return end_time - start_time
   }
 }
 
@@ -253,12 +395,22 @@ class SampleRunner {
 func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResults {
 
   var samples = [UInt64](repeating: 0, count: c.numSamples)
+  var allocations = [UInt64](repeating: 0, count: c.numSamples)
+  var retains = [UInt64](repeating: 0, count: c.numSamples)
+  var releases = [UInt64](repeating: 0, count: c.numSamples)
 
   if c.verbose {
     print("Running \(name) for \(c.numSamples) samples.")
   }
 
   let sampler = SampleRunner()
+  if c.numWarmupIters > 0 {
+    if c.verbose {
+      print("    Warming up for \(c.numWarmupIters) iterations.")
+    }
+    fn(c.numWarmupIters)
+  }
+
   for s in 0..<c.numSamples {
     let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
 
@@ -283,6 +435,9 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     }
     // save result in microseconds or k-ticks
     samples[s] = elapsed_time / UInt64(scale) / 1000
+    allocations[s] = sampler.allocations / UInt64(scale)
+    retains[s] = sampler.retains / UInt64(scale)
+    releases[s] = sampler.releases / UInt64(scale)
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
@@ -293,7 +448,11 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
   // Return our benchmark results.
   return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
                       min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+                      mean: mean, sd: sd, median: internalMedian(samples),
+                      allocations: c.countAllocations ? allocations.min()!
+                                                      : nil,
+                      retains: c.countRetainsReleases ? retains.min()! : nil,
+                      releases: c.countRetainsReleases ? releases.min()! : nil)
 }
 
 func printRunInfo(_ c: TestConfig) {
@@ -301,6 +460,12 @@ func printRunInfo(_ c: TestConfig) {
     print("--- CONFIG ---")
     print("NumSamples: \(c.numSamples)")
     print("Verbose: \(c.verbose)")
+    print("CountAllocations: \(c.countAllocations)")
+    print("CountRetainsReleases: \(c.countRetainsReleases)")
+    print("WarmupIters: \(c.numWarmupIters)")
+    if let cpu = c.cpu {
+      print("CPU: \(cpu)")
+    }
     print("IterScale: \(c.iterationScale)")
     if c.fixedNumIters != 0 {
       print("FixedIters: \(c.fixedNumIters)")
@@ -320,9 +485,23 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
+  if c.countAllocations {
+    header += "\(c.delim)ALLOCS"
+  }
+  if c.countRetainsReleases {
+    header += "\(c.delim)RETAINS\(c.delim)RELEASES"
+  }
+  print(header)
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
+  if c.countAllocations {
+    SumBenchResults.allocations = 0
+  }
+  if c.countRetainsReleases {
+    SumBenchResults.retains = 0
+    SumBenchResults.releases = 0
+  }
 
   for t in c.tests {
     if !t.run {
@@ -339,6 +518,13 @@ func runBenchmarks(_ c: TestConfig) {
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
     SumBenchResults.sampleCount += 1
+    if let allocations = results.allocations {
+      SumBenchResults.allocations! += allocations
+    }
+    if let retains = results.retains, releases = results.releases {
+      SumBenchResults.retains! += retains
+      SumBenchResults.releases! += releases
+    }
     // Don't accumulate SD and Median, as simple sum isn't valid for them.
     // TODO: Compute SD and Median for total results as well.
     // SumBenchResults.sd += results.sd
@@ -363,6 +549,9 @@ public func main() {
         print("    \(t.name)")
       }
     case .Run:
+      if let cpu = config.cpu, let error = pinToCPU(cpu) {
+        fatalError(error)
+      }
       config.findTestsToRun()
       printRunInfo(config)
       runBenchmarks(config)
@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if os(Linux)
+import Glibc
+#else
 import Darwin
+#endif
 
 // Linear function shift register.
 //
@@ -63,3 +67,47 @@ struct MyStruct : SomeProtocol {
 }
 public func someProtocolFactory() -> SomeProtocol { return MyStruct() }
 
+
+/// The work that `runConcurrently` starts on one thread.
+final class ThreadWork {
+  let body: (Int) -> Void
+  let index: Int
+
+  init(body: (Int) -> Void, index: Int) {
+    self.body = body
+    self.index = index
+  }
+}
+
+func runThreadWork(
+  _ context: UnsafeMutablePointer<Void>?
+) -> UnsafeMutablePointer<Void>! {
+  // The work is passed in +1; we're responsible for releasing it.
+  let work = Unmanaged<ThreadWork>.fromOpaque(context!).takeRetainedValue()
+  work.body(work.index)
+  return nil
+}
+
+/// Run `body` on `threadCount` threads at once, passing each thread its
+/// index, and wait until all of them have finished.
+public func runConcurrently(_ threadCount: Int, _ body: (Int) -> Void) {
+#if os(Linux)
+  var threads = [pthread_t](repeating: pthread_t(), count: threadCount)
+#else
+  var threads = [pthread_t?](repeating: nil, count: threadCount)
+#endif
+  for i in 0..<threadCount {
+    let work = ThreadWork(body: body, index: i)
+    let context = Unmanaged.passRetained(work).toOpaque()
+    let result = pthread_create(&threads[i], nil,
+                                { runThreadWork($0) }, context)
+    CheckResults(result == 0, "pthread_create failed")
+  }
+  for thread in threads {
+#if os(Linux)
+    pthread_join(thread, nil)
+#else
+    pthread_join(thread!, nil)
+#endif
+  }
+}
@@ -53,6 +53,7 @@ import Hash
 import Histogram
 import Integrate
 import Join
+import LazyPipeline
 import LinkedList
 import MapReduce
 import Memset
@@ -78,20 +79,24 @@ import RC4
 import RGBHistogram
 import RangeAssignment
 import RecursiveOwnedParameter
+import ServerWorkloads
 import SetTests
 import SevenBoom
 import Sim2DArray
 import SortLettersInPlace
 import SortStrings
+import StableSort
 import StackPromo
 import StaticArray
 import StrComplexWalk
 import StrToInt
 import StringBuilder
+import StringCharacterCount
 import StringInterpolation
 import StringTests
 import StringWalk
 import SuperChars
+import ThreadScaling
 import TwoSum
 import TypeFlood
 import UTF8Decode
@@ -140,6 +145,8 @@ precommitTests = [
   "Histogram": run_Histogram,
   "Integrate": run_Integrate,
   "Join": run_Join,
+  "LazyFilterFilter": run_LazyFilterFilter,
+  "LazyMapMapMap": run_LazyMapMapMap,
   "LinkedList": run_LinkedList,
   "MapReduce": run_MapReduce,
   "Memset": run_Memset,
@@ -187,6 +194,10 @@ precommitTests = [
   "RGBHistogramOfObjects": run_RGBHistogramOfObjects,
   "RangeAssignment": run_RangeAssignment,
   "RecursiveOwnedParameter": run_RecursiveOwnedParameter,
+  "ServerFrameCoding": run_ServerFrameCoding,
+  "ServerHTTPParse": run_ServerHTTPParse,
+  "ServerHandlerDispatch": run_ServerHandlerDispatch,
+  "ServerJSONParse": run_ServerJSONParse,
   "SetExclusiveOr": run_SetExclusiveOr,
   "SetIntersect": run_SetIntersect,
   "SetIsSubsetOf": run_SetIsSubsetOf,
@@ -200,11 +211,16 @@ precommitTests = [
   "SortLettersInPlace": run_SortLettersInPlace,
   "SortStrings": run_SortStrings,
   "SortStringsUnicode": run_SortStringsUnicode,
+  "StableSortNearlySorted": run_StableSortNearlySorted,
+  "StableSortRandom": run_StableSortRandom,
+  "StableSortReversed": run_StableSortReversed,
   "StackPromo": run_StackPromo,
   "StaticArray": run_StaticArray,
   "StrComplexWalk": run_StrComplexWalk,
   "StrToInt": run_StrToInt,
   "StringBuilder": run_StringBuilder,
+  "StringCharacterCountASCII": run_StringCharacterCountASCII,
+  "StringCharacterCountMixed": run_StringCharacterCountMixed,
   "StringEqualPointerComparison": run_StringEqualPointerComparison,
   "StringInterpolation": run_StringInterpolation,
   "StringHasPrefix": run_StringHasPrefix,
@@ -214,6 +230,22 @@ precommitTests = [
   "StringWalk": run_StringWalk,
   "StringWithCString": run_StringWithCString,
   "SuperChars": run_SuperChars,
+  "ThreadScalingAllocation1": run_ThreadScalingAllocation1,
+  "ThreadScalingAllocation2": run_ThreadScalingAllocation2,
+  "ThreadScalingAllocation4": run_ThreadScalingAllocation4,
+  "ThreadScalingAllocation8": run_ThreadScalingAllocation8,
+  "ThreadScalingCast1": run_ThreadScalingCast1,
+  "ThreadScalingCast2": run_ThreadScalingCast2,
+  "ThreadScalingCast4": run_ThreadScalingCast4,
+  "ThreadScalingCast8": run_ThreadScalingCast8,
+  "ThreadScalingMetadata1": run_ThreadScalingMetadata1,
+  "ThreadScalingMetadata2": run_ThreadScalingMetadata2,
+  "ThreadScalingMetadata4": run_ThreadScalingMetadata4,
+  "ThreadScalingMetadata8": run_ThreadScalingMetadata8,
+  "ThreadScalingRetainRelease1": run_ThreadScalingRetainRelease1,
+  "ThreadScalingRetainRelease2": run_ThreadScalingRetainRelease2,
+  "ThreadScalingRetainRelease4": run_ThreadScalingRetainRelease4,
+  "ThreadScalingRetainRelease8": run_ThreadScalingRetainRelease8,
   "TwoSum": run_TwoSum,
   "TypeFlood": run_TypeFlood,
   "UTF8Decode": run_UTF8Decode,
@@ -82,6 +82,7 @@ namespace swift {
   class DiagnosticEngine;
   class Substitution;
   class TypeCheckerDebugConsumer;
+  class UnifiedStatsReporter;
   class DocComment;
 
   enum class KnownProtocolKind : uint8_t;
@@ -226,6 +227,9 @@ public:
   /// A consumer of type checker debug output.
   std::unique_ptr<TypeCheckerDebugConsumer> TypeCheckerDebug;
 
+  /// If non-null, counters for this compilation are recorded here.
+  UnifiedStatsReporter *Stats = nullptr;
+
   /// Cache for names of canonical GenericTypeParamTypes.
   mutable llvm::DenseMap<unsigned, Identifier>
     CanonicalGenericTypeParamTypeNames;
@@ -237,6 +241,15 @@ public:
   llvm::DenseMap<std::pair<GenericSignature*, ModuleDecl*>,
                  CanGenericSignature> ManglingSignatures;
 
+  /// Cache of USRs successfully computed by \c ide::printDeclUSR.
+  llvm::DenseMap<const ValueDecl *, StringRef> DeclUSRs;
+
+  /// How SIL type lowering classified nominal types that don't depend on a
+  /// generic context, as seen from the given module. This is shared by all
+  /// SIL modules in the context; see \c Lowering::TypeConverter.
+  llvm::DenseMap<std::pair<CanType, const ModuleDecl *>, unsigned>
+    LoweredTypeKinds;
+
 private:
   /// \brief The current generation number, which reflects the number of
   /// times that external modules have been loaded.
@@ -666,6 +679,10 @@ public:
   /// \returns The requested module, or NULL if the module cannot be found.
   ModuleDecl *getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath);
 
+  /// \brief Lets the module loaders start reading the given top-level modules
+  /// before they are imported with #getModule.
+  void prefetchModules(ArrayRef<Identifier> ModuleNames);
+
   ModuleDecl *getModuleByName(StringRef ModuleName);
 
   /// Returns the standard library module, or null if the library isn't present.
@@ -780,6 +797,14 @@ public:
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// \brief Returns the number of bytes handed out from the permanent arena.
+  ///
+  /// Unlike \c getTotalMemory, this does not include slab slack or side
+  /// tables, so the difference between two calls is the memory pinned by the
+  /// AST nodes and types created in between. It is always zero when
+  /// \c LangOptions::UseMalloc is set.
+  size_t getPermanentBytesAllocated() const;
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
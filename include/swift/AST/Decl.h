@@ -2813,6 +2813,9 @@ public:
 
   /// \brief Does this declaration expose a fixed layout to the given
   /// module?
+  ///
+  /// With maximal expansion, this is true for every declaration in the same
+  /// resilience domain as \p M.
   bool hasFixedLayout(ModuleDecl *M, ResilienceExpansion expansion) const;
 
   void setMemberLoader(LazyMemberLoader *resolver, uint64_t contextData);
@@ -4139,6 +4142,9 @@ public:
 
   /// \brief Does this declaration expose a fixed layout to the given
   /// module?
+  ///
+  /// With maximal expansion, this is true for every declaration in the same
+  /// resilience domain as \p M.
   bool hasFixedLayout(ModuleDecl *M, ResilienceExpansion expansion) const;
 
   /// Does the storage use a behavior?
@@ -21,6 +21,7 @@
 #include "swift/AST/TypeLoc.h"
 #include "swift/AST/DeclNameLoc.h"
 #include "swift/Basic/DiagnosticConsumer.h"
+#include "llvm/ADT/StringSet.h"
 
 namespace swift {
   class Decl;
@@ -444,6 +445,10 @@ namespace swift {
       fatalErrorOccurred = false;
     }
 
+    /// \brief Ignore the notes attached to the previous diagnostic, as if it
+    /// had been ignored.
+    void ignoreFollowingNotes() { previousBehavior = Behavior::Ignore; }
+
     /// Set per-diagnostic behavior
     void setDiagnosticBehavior(DiagID id, Behavior behavior) {
       perDiagnosticBehavior[(unsigned)id] = behavior;
@@ -483,6 +488,10 @@ namespace swift {
     /// results that we can point to on the command line.
     llvm::DenseMap<const Decl *, SourceLoc> PrettyPrintedDeclarations;
 
+    /// \brief The keys of the diagnostics which have been emitted, used to drop
+    /// identical diagnostics before formatting them.
+    llvm::StringSet<> EmittedDiagnostics;
+
     /// \brief The number of open diagnostic transactions. Diagnostics are only
     /// emitted once all transactions have closed.
     unsigned TransactionCount = 0;
@@ -702,6 +711,10 @@ namespace swift {
     /// \brief Send \c diag to all diagnostic consumers.
     void emitDiagnostic(const Diagnostic &diag);
 
+    /// \brief Returns true if a diagnostic identical to \c diag, with the same
+    /// location, arguments and fix-its, has already been emitted.
+    bool isDuplicateDiagnostic(const Diagnostic &diag);
+
     /// \brief Send all tentative diagnostics to all diagnostic consumers and
     /// delete them.
     void emitTentativeDiagnostics();
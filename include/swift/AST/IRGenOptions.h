@@ -78,6 +78,11 @@ public:
   /// used to force-load this module.
   std::string ForceLoadSymbolName;
 
+  /// The directory of the LLVM codegen cache, if any. Object files are stored
+  /// in it by the hash of the LLVM module they were compiled from, and are
+  /// reused by later compilations of an identical module.
+  std::string LLVMCodeGenCachePath;
+
   /// The kind of compilation we should do.
   IRGenOutputKind OutputKind : 3;
 
@@ -156,6 +161,33 @@ public:
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Allocate alloc_stacks of non-fixed-size types, such as opened
+  /// existentials, with dynamically-sized allocas, instead of in fixed-size
+  /// buffers that fall back to the heap for large values.
+  unsigned EnableDynamicStackAllocation : 1;
+
+  /// Free the bodies of SIL functions once IR generation is done with them,
+  /// before running LLVM. Only valid if nothing looks at the SIL module's
+  /// function bodies after IRGen.
+  unsigned ReleaseSILAfterIRGen : 1;
+
+  /// Lay out the stored properties of internal and private non-generic
+  /// structs by decreasing alignment instead of in declaration order, to
+  /// reduce padding. All modules that can see such a struct must agree on
+  /// this setting.
+  unsigned EnableStructFieldReordering : 1;
+
+  /// Expand the retains and releases of native objects that are left after
+  /// LLVM ARC optimization into inline atomic operations, calling the
+  /// runtime only to deallocate.
+  unsigned EnableInlineRefCounting : 1;
+
+  /// If non-zero, copies and destroys of fixed-size structs and tuples with
+  /// at least this many non-trivial fields call a helper function shared by
+  /// all uses of the type, instead of handling each field inline. This trades
+  /// a call for code size.
+  unsigned OutlineValueOperationsThreshold;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -170,7 +202,11 @@ public:
                    HasValueNamesSetting(false), ValueNames(false),
                    EnableReflectionMetadata(true), EnableReflectionNames(true),
                    UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
-                   CmdArgs()
+                   EnableDynamicStackAllocation(false),
+                   ReleaseSILAfterIRGen(false),
+                   EnableStructFieldReordering(false),
+                   EnableInlineRefCounting(false),
+                   OutlineValueOperationsThreshold(0), CmdArgs()
                    {}
 
   /// Gets the name of the specified output filename.
@@ -188,6 +224,7 @@ public:
     Hash = (Hash << 1) | Optimize;
     Hash = (Hash << 1) | DisableLLVMOptzns;
     Hash = (Hash << 1) | DisableLLVMARCOpts;
+    Hash = (Hash << 1) | EnableInlineRefCounting;
     return Hash;
   }
 };
@@ -17,8 +17,11 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
 #include "swift/AST/TypeLoc.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
+#include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
 
@@ -189,6 +192,17 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Returns the member decls of \p D whose base name is \p N, if they can
+  /// be found without loading all of the members.
+  ///
+  /// The implementation should \em not add the members to \p D.
+  ///
+  /// \returns None if the caller should fall back to loading all members.
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(const Decl *D, Identifier N, uint64_t contextData) {
+    return None;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -208,6 +208,12 @@ private:
     unsigned ResilienceStrategy : 2;
   } Flags;
 
+  /// The resilience domain this module belongs to, or empty if it is only in
+  /// its own.
+  ///
+  /// \see isInSameResilienceDomain
+  Identifier ResilienceDomain;
+
   /// The magic __dso_handle variable.
   VarDecl *DSOHandle;
 
@@ -272,6 +278,25 @@ public:
     Flags.ResilienceStrategy = unsigned(strategy);
   }
 
+  /// The name of the group of modules that are always distributed together
+  /// with this one (see \c -resilience-domain), or empty if there is none.
+  Identifier getResilienceDomain() const {
+    return ResilienceDomain;
+  }
+  void setResilienceDomain(Identifier domain) {
+    ResilienceDomain = domain;
+  }
+
+  /// Returns true if \p other is always distributed together with this
+  /// module, in which case the layouts of its types never change beneath this
+  /// module and may be assumed when it is compiled.
+  bool isInSameResilienceDomain(const ModuleDecl *other) const {
+    if (this == other)
+      return true;
+    return !ResilienceDomain.empty() &&
+           ResilienceDomain == other->ResilienceDomain;
+  }
+
   /// Look up a (possibly overloaded) value set at top-level scope
   /// (but with the specified access path, which may come from an import decl)
   /// within the current module.
@@ -854,6 +879,18 @@ private:
   /// this source file so far.
   llvm::MD5 InterfaceHash;
 
+  /// A hash of the interface-contributing tokens that are not part of any
+  /// declaration, such as imports.
+  llvm::MD5 InterfaceHashOutsideDecls;
+
+  /// Hashes of the interface-contributing tokens of the declarations that are
+  /// currently being parsed, innermost last.
+  SmallVector<llvm::MD5, 4> PendingDeclInterfaceHashes;
+
+  /// The interface hash of each declaration parsed in this file, used as the
+  /// declaration's fingerprint in the reference dependencies file.
+  llvm::DenseMap<const Decl *, std::string> DeclInterfaceHashes;
+
   /// \brief The ID for the memory buffer containing this file's source.
   ///
   /// May be -1, to indicate no association with a buffer.
@@ -914,6 +951,15 @@ public:
   /// forwarded on to IRGen.
   ASTStage_t ASTStage = Parsing;
 
+  /// The number of bytes allocated in the ASTContext's permanent arena while
+  /// this file was being parsed and type-checked.
+  ///
+  /// The permanent arena is only freed with the ASTContext, so this is the
+  /// memory the file keeps alive for as long as its context does. Types and
+  /// declarations created lazily on behalf of another file are charged to the
+  /// file being processed at the time.
+  size_t ASTBytesAllocated = 0;
+
   SourceFile(ModuleDecl &M, SourceFileKind K, Optional<unsigned> bufferID,
              ImplicitModuleImportKind ModImpKind);
 
@@ -1078,14 +1124,51 @@ public:
     // Add null byte to separate tokens.
     uint8_t a[1] = {0};
     InterfaceHash.update(a);
+
+    if (PendingDeclInterfaceHashes.empty()) {
+      InterfaceHashOutsideDecls.update(token);
+      InterfaceHashOutsideDecls.update(a);
+    }
+    for (auto &declHash : PendingDeclInterfaceHashes) {
+      declHash.update(token);
+      declHash.update(a);
+    }
+  }
+
+  /// Starts hashing the interface tokens of a declaration, in addition to the
+  /// interface hash of the whole file. Declarations may be nested.
+  void beginDeclInterfaceHash() {
+    PendingDeclInterfaceHashes.emplace_back();
+  }
+
+  /// Finishes the innermost declaration hash started by
+  /// beginDeclInterfaceHash, and records it for each of \p decls that does
+  /// not already have a hash of its own.
+  void endDeclInterfaceHash(ArrayRef<const Decl *> decls);
+
+  /// Returns the interface hash recorded for \p D, or an empty string if it
+  /// was not parsed from this file.
+  StringRef getDeclInterfaceHash(const Decl *D) const {
+    auto iter = DeclInterfaceHashes.find(D);
+    if (iter == DeclInterfaceHashes.end())
+      return StringRef();
+    return iter->second;
+  }
+
+  void getInterfaceHashOutsideDecls(llvm::SmallString<32> &str) const {
+    llvm::MD5 state = InterfaceHashOutsideDecls;
+    llvm::MD5::MD5Result result;
+    state.final(result);
+    llvm::MD5::stringifyResult(result, str);
   }
 
   const llvm::MD5 &getInterfaceHashState() { return InterfaceHash; }
   void setInterfaceHashState(const llvm::MD5 &state) { InterfaceHash = state; }
 
-  void getInterfaceHash(llvm::SmallString<32> &str) {
+  void getInterfaceHash(llvm::SmallString<32> &str) const {
+    llvm::MD5 state = InterfaceHash;
     llvm::MD5::MD5Result result;
-    InterfaceHash.final(result);
+    state.final(result);
     llvm::MD5::stringifyResult(result, str);
   }
 
@@ -86,6 +86,14 @@ public:
   ModuleDecl *loadModule(SourceLoc importLoc,
                          ArrayRef<std::pair<Identifier, SourceLoc>> path) = 0;
 
+  /// \brief Notes that the top-level modules named \p names are about to be
+  /// imported.
+  ///
+  /// A loader may use this to start reading the modules (and the modules they
+  /// depend on) ahead of time, so that later calls to #loadModule are cheaper.
+  /// Nothing is added to the AST.
+  virtual void prefetchModules(ArrayRef<Identifier> names) { }
+
   /// \brief Load extensions to the given nominal type.
   ///
   /// \param nominal The nominal type whose extensions should be loaded.
@@ -55,6 +55,11 @@ public:
   /// Controls how to perform SIL linking.
   LinkingMode LinkMode = LinkNormal;
 
+  /// When linking all functions, don't deserialize the body of a
+  /// non-generic function whose serialized body has more than this many
+  /// instructions, unless it has to be inlined or linked. 0 means no limit.
+  unsigned LinkBodySizeLimit = 0;
+
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
@@ -101,6 +106,10 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The indexed profile, from a -profile-generate build, whose execution
+  /// counts are attached to SIL basic blocks. Empty if there is none.
+  std::string UseProfile;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -108,6 +117,21 @@ public:
   /// conventions.
   bool EnableGuaranteedClosureContexts = false;
 
+  /// Pass the parameters of functions other than initializers using +0
+  /// caller-guaranteed ARC conventions. This changes the calling convention
+  /// of every Swift function, so all modules in a program, including the
+  /// standard library, must be compiled with the same setting.
+  bool EnableGuaranteedNormalArguments = false;
+
+  /// Emit local 'var's that are never captured by a closure into an
+  /// alloc_stack instead of an alloc_box, so that the mandatory pipeline
+  /// doesn't have to promote them.
+  bool EnableStackAllocatedLocalVars = false;
+
+  /// Assume that the code is only ever run on one thread, so that all
+  /// reference counting operations can be non-atomic.
+  bool AssumeSingleThreaded = false;
+
   /// The name of the SIL outputfile if compiled with SIL debugging (-gsil).
   std::string SILOutputFileNameForDebugging;
 };
@@ -52,6 +52,13 @@ public:
 
   /// Don't look in for compiler-provided modules.
   bool SkipRuntimeLibraryImportPath = false;
+
+  /// A file listing the contents of some of the search paths, written by the
+  /// driver at the start of the build.
+  ///
+  /// A module is only looked for in a listed directory if the listing has an
+  /// entry for it, which saves looking for every module in every search path.
+  std::string SearchPathListingPath;
 };
 
 }
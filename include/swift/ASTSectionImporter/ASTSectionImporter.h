@@ -24,11 +24,14 @@ namespace swift {
   class SerializedModuleLoader;
 
   /// \brief Provided a memory buffer with an entire Mach-O __apple_ast
-  /// section, this function makes memory buffer copies of all swift
-  /// modules found in it and registers them using
-  /// registerMemoryBuffer() so they can be found by loadModule(). The
-  /// access path of all modules found in the section is appended to
-  /// the vector foundModules.
+  /// section, this function registers memory buffers referring to all swift
+  /// modules found in it using registerMemoryBuffer() so they can be found
+  /// by loadModule(). The access path of all modules found in the section
+  /// is appended to the vector foundModules.
+  ///
+  /// Only the control block of each module is read here; a module is
+  /// deserialized when it is first loaded, so callers should not load the
+  /// modules they find until they need them.
   /// \return true if successful.
   bool parseASTSection(SerializedModuleLoader* SML, StringRef Data,
                        SmallVectorImpl<std::string> &foundModules);
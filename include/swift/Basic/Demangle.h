@@ -18,6 +18,8 @@
 #include <vector>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <new>
 #include "llvm/ADT/StringRef.h"
 #include "swift/Basic/Malloc.h"
 
@@ -69,7 +71,8 @@ struct DemangleOptions {
 };
 
 class Node;
-typedef std::shared_ptr<Node> NodePointer;
+class NodeFactory;
+typedef Node *NodePointer;
 
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
@@ -82,6 +85,8 @@ enum class FunctionSigSpecializationParamKind : unsigned {
   ClosureProp = 5,
   BoxToValue = 6,
   BoxToStack = 7,
+  ExistentialToConcrete = 8,
+  ClosurePropField = 9,
 
   // Option Set Flags use bits 6-31. This gives us 26 bits to use for option
   // flags.
@@ -101,6 +106,7 @@ enum class SpecializationPass : uint8_t {
   CapturePropagation,
   FunctionSignatureOpts,
   GenericSpecializer,
+  ExistentialSpecializer,
 };
 
 static inline char encodeSpecializationPass(SpecializationPass Pass) {
@@ -135,7 +141,12 @@ enum class Directness {
   Direct, Indirect
 };
 
-class Node : public std::enable_shared_from_this<Node> {
+/// A node in a demangle tree.
+///
+/// Nodes are allocated by, and owned by, a NodeFactory.  They are never
+/// freed individually and carry no reference count; a tree stays valid
+/// until the factory that created it is cleared or destroyed.
+class Node {
 public:
   enum class Kind : uint16_t {
 #define NODE(ID) ID,
@@ -152,21 +163,32 @@ private:
   };
   PayloadKind NodePayloadKind;
 
+  enum : uint32_t { NumInlineChildren = 2 };
+
+  uint32_t NumChildren = 0;
+  uint32_t ReservedChildren = NumInlineChildren;
+
   union {
-    std::string TextPayload;
+    struct {
+      const char *Data;
+      size_t Length;
+    } TextPayload;
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
+  /// Points either at InlineChildren or at a larger array allocated in the
+  /// owning factory's arena.  Most nodes have at most two children, so they
+  /// never need the out-of-line array.
+  NodePointer *Children = InlineChildren;
+  NodePointer InlineChildren[NumInlineChildren];
 
   Node(Kind k)
       : NodeKind(k), NodePayloadKind(PayloadKind::None) {
   }
-  Node(Kind k, std::string &&t)
+  Node(Kind k, llvm::StringRef t)
       : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
-    new (&TextPayload) std::string(std::move(t));
+    TextPayload.Data = t.data();
+    TextPayload.Length = t.size();
   }
   Node(Kind k, IndexType index)
       : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
@@ -175,17 +197,15 @@ private:
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
+  friend class NodeFactory;
 
 public:
-  ~Node();
-
   Kind getKind() const { return NodeKind; }
 
   bool hasText() const { return NodePayloadKind == PayloadKind::Text; }
-  const std::string &getText() const {
+  llvm::StringRef getText() const {
     assert(hasText());
-    return TextPayload;
+    return llvm::StringRef(TextPayload.Data, TextPayload.Length);
   }
 
   bool hasIndex() const { return NodePayloadKind == PayloadKind::Index; }
@@ -194,60 +214,164 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(NumChildren != 0);
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren);
+    return Children[index];
+  }
 
   /// Add a new node as a child of this one.
   ///
   /// \param child - should have no parent or siblings
+  /// \param factory - the factory which owns this node; it provides the
+  ///   storage when the child array outgrows its inline capacity
   /// \returns child
-  NodePointer addChild(NodePointer child) {
-    assert(child && "adding null child!");
-    Children.push_back(child);
-    return child;
-  }
+  inline NodePointer addChild(NodePointer child, NodeFactory &factory);
 
   /// A convenience method for adding two children at once.
-  void addChildren(NodePointer child1, NodePointer child2) {
-    addChild(std::move(child1));
-    addChild(std::move(child2));
+  void addChildren(NodePointer child1, NodePointer child2,
+                   NodeFactory &factory) {
+    addChild(child1, factory);
+    addChild(child2, factory);
+  }
+};
+
+/// An arena which allocates and owns demangle tree nodes.
+///
+/// Nodes, their text payloads and their child arrays are bump-allocated out
+/// of slabs which are only released when the factory is destroyed or
+/// cleared.  A factory can be reused across many demanglings; calling
+/// clear() between them recycles the most recent slab instead of returning
+/// it to malloc.
+///
+/// Typical usage:
+/// \code
+///   NodeFactory Factory;
+///   for (auto &Symbol : Symbols) {
+///     NodePointer Root = demangleSymbolAsNode(Symbol, Factory);
+///     ...
+///     Factory.clear();
+///   }
+/// \endcode
+class NodeFactory {
+  /// The header of each slab.  Slabs form a singly-linked list from the
+  /// most recently allocated one.
+  struct Slab {
+    Slab *Previous;
+    size_t Size;
+  };
+
+  /// The first slab is this big; each subsequent one doubles, up to
+  /// MaxSlabSize.
+  enum : size_t {
+    InitialSlabSize = 1024,
+    MaxSlabSize = 64 * 1024
+  };
+
+  Slab *CurrentSlab = nullptr;
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+
+  void *allocateInNewSlab(size_t size, size_t alignment);
+  void freeSlabs(Slab *slab);
+
+public:
+  NodeFactory() = default;
+  NodeFactory(const NodeFactory &) = delete;
+  NodeFactory &operator=(const NodeFactory &) = delete;
+
+  ~NodeFactory() { freeSlabs(CurrentSlab); }
+
+  /// Release every node allocated so far, keeping the most recent slab
+  /// for future allocations.  Any NodePointer from this factory becomes
+  /// dangling.
+  void clear();
+
+  /// Allocate uninitialized memory in the arena.
+  void *allocate(size_t size, size_t alignment) {
+    uintptr_t aligned =
+      (uintptr_t(CurPtr) + alignment - 1) & ~uintptr_t(alignment - 1);
+    if (CurPtr && aligned + size <= uintptr_t(End)) {
+      CurPtr = reinterpret_cast<char *>(aligned + size);
+      return reinterpret_cast<void *>(aligned);
+    }
+    return allocateInNewSlab(size, alignment);
+  }
+
+  template <typename T>
+  T *allocate(size_t numObjects) {
+    return static_cast<T *>(allocate(sizeof(T) * numObjects, alignof(T)));
+  }
+
+  NodePointer createNode(Node::Kind K) {
+    return new (allocate<Node>(1)) Node(K);
+  }
+  NodePointer createNode(Node::Kind K, Node::IndexType Index) {
+    return new (allocate<Node>(1)) Node(K, Index);
+  }
+  /// Create a node with a text payload.  The text is copied into the arena.
+  NodePointer createNode(Node::Kind K, llvm::StringRef Text) {
+    char *copy = allocate<char>(Text.size());
+    if (!Text.empty())
+      memcpy(copy, Text.data(), Text.size());
+    return new (allocate<Node>(1)) Node(K, llvm::StringRef(copy, Text.size()));
   }
 };
 
+inline NodePointer Node::addChild(NodePointer child, NodeFactory &factory) {
+  assert(child && "adding null child!");
+  if (NumChildren == ReservedChildren) {
+    uint32_t newCapacity = ReservedChildren * 2;
+    NodePointer *newChildren = factory.allocate<NodePointer>(newCapacity);
+    memcpy(newChildren, Children, NumChildren * sizeof(NodePointer));
+    Children = newChildren;
+    ReservedChildren = newCapacity;
+  }
+  Children[NumChildren++] = child;
+  return child;
+}
+
 /// \brief Demangle the given string as a Swift symbol.
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleSymbolAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param factory The arena which will own the nodes of the parse tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
 /// \returns A parse tree for the demangled string - or a null pointer
-/// on failure.
+/// on failure.  The tree is valid as long as \p factory is.
 ///
 NodePointer
 demangleSymbolAsNode(const char *mangledName, size_t mangledNameLength,
+                     NodeFactory &factory,
                      const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
-demangleSymbolAsNode(const std::string &mangledName,
+demangleSymbolAsNode(const std::string &mangledName, NodeFactory &factory,
                      const DemangleOptions &options = DemangleOptions()) {
-  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleSymbolAsNode(mangledName.data(), mangledName.size(), factory,
+                              options);
 }
 
 /// \brief Demangle the given string as a Swift symbol.
@@ -279,25 +403,29 @@ demangleSymbolAsString(const std::string &mangledName,
 ///
 /// Typical usage:
 /// \code
+///   NodeFactory Factory;
 ///   NodePointer aDemangledName =
-/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName")
+/// swift::Demangler::demangleTypeAsNode("SomeSwiftMangledName", Factory)
 /// \endcode
 ///
 /// \param mangledName The mangled string.
+/// \param factory The arena which will own the nodes of the parse tree.
 /// \param options An object encapsulating options to use to perform this demangling.
 ///
 ///
 /// \returns A parse tree for the demangled string - or a null pointer
-/// on failure.
+/// on failure.  The tree is valid as long as \p factory is.
 ///
 NodePointer
 demangleTypeAsNode(const char *mangledName, size_t mangledNameLength,
+                   NodeFactory &factory,
                    const DemangleOptions &options = DemangleOptions());
 
 inline NodePointer
-demangleTypeAsNode(const std::string &mangledName,
+demangleTypeAsNode(const std::string &mangledName, NodeFactory &factory,
                    const DemangleOptions &options = DemangleOptions()) {
-  return demangleTypeAsNode(mangledName.data(), mangledName.size(), options);
+  return demangleTypeAsNode(mangledName.data(), mangledName.size(), factory,
+                            options);
 }
 
 /// \brief Demangle the given string as a Swift type mangling.
@@ -350,25 +478,6 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
-struct NodeFactory {
-  static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
-  }
-  static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
-  }
-  static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
-  }
-  static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
-  }
-  template <size_t N>
-  static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
-  }
-};
-
   /// A class for printing to a std::string.
 class DemanglerPrinter {
 public:
@@ -109,6 +109,11 @@ namespace swift {
     /// solver should be debugged.
     unsigned DebugConstraintSolverAttempt = 0;
 
+    /// \brief Whether the constraint solver reuses the partial solutions of a
+    /// connected component when the same component shows up again while
+    /// exploring another disjunction term.
+    bool SolverComponentCache = false;
+
     /// \brief Enable the iterative type checker.
     bool IterativeTypeChecker = false;
 
@@ -130,6 +135,10 @@ namespace swift {
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 15000000;
 
+    /// \brief The maximum number of subexpressions that are independently
+    /// re-type-checked to diagnose an expression that failed to type-check.
+    unsigned DiagnosisRecheckLimit = 500;
+
     /// \brief Perform all dynamic allocations using malloc/free instead of
     /// optimized custom allocator, so that memory debugging tools can be used.
     bool UseMalloc = false;
@@ -140,6 +149,10 @@ namespace swift {
     /// \brief Enable experimental property behavior feature.
     bool EnableExperimentalPropertyBehaviors = false;
 
+    /// When looking up a member of an imported type by name, only load the
+    /// members with that name, if the module provides a table of them.
+    bool NamedLazyMemberLoading = false;
+
     /// Should we check the target OSs of serialized modules to see that they're
     /// new enough?
     bool EnableTargetOSChecking = true;
@@ -0,0 +1,145 @@
+//===--- ReferenceDependencies.h - Swift dependencies files ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the contents of a reference dependencies (.swiftdeps) file,
+/// as written by the frontend and read by the driver.
+///
+/// A dependencies file can be written either as YAML, which is easy to read
+/// and write by hand, or in a compact binary format that the driver can use
+/// in place without any parsing:
+///
+/// \verbatim
+///   header:  "SWDB", version, string count, record count  (4 x 4 bytes)
+///   strings: (offset, length) into the string data        (8 bytes each)
+///   records: section, flags, string count, string indices (16 bytes each)
+///   string data
+/// \endverbatim
+///
+/// All integers are little-endian. Strings are interned, so each distinct
+/// name is only stored once.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_REFERENCEDEPENDENCIES_H
+#define SWIFT_BASIC_REFERENCEDEPENDENCIES_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <memory>
+
+namespace swift {
+namespace reference_dependencies {
+
+/// The sections of a dependencies file.
+///
+/// Entries in "member" sections have two names, a mangled type name and a
+/// member name. Entries in "fingerprints" sections have the names of the
+/// corresponding "provides" entry, followed by the fingerprint. Everything
+/// else has a single name.
+enum class Section : uint8_t {
+  ProvidesTopLevel,
+  ProvidesNominal,
+  ProvidesMember,
+  ProvidesDynamicLookup,
+  DependsTopLevel,
+  DependsMember,
+  DependsNominal,
+  DependsDynamicLookup,
+  DependsExternal,
+  FingerprintsTopLevel,
+  FingerprintsNominal,
+  FingerprintsMember,
+  InterfaceHash,
+};
+
+enum : unsigned { NumSections = unsigned(Section::InterfaceHash) + 1 };
+
+/// Returns the YAML key used for \p section.
+StringRef getSectionName(Section section);
+
+/// Returns the section with the YAML key \p name, if there is one.
+Optional<Section> getSectionForName(StringRef name);
+
+/// Returns the number of names in each entry of \p section.
+unsigned getNumNamesPerEntry(Section section);
+
+namespace binary {
+  /// The first four bytes of every binary dependencies file.
+  const char Magic[] = { 'S', 'W', 'D', 'B' };
+
+  /// Bumped whenever the layout below changes incompatibly.
+  const uint32_t Version = 1;
+
+  /// The size in bytes of the header, of each string table entry, and of
+  /// each record.
+  const size_t HeaderSize = 16;
+  const size_t StringEntrySize = 8;
+  const size_t RecordSize = 16;
+
+  /// The most names a single record can have.
+  const unsigned MaxNamesPerRecord = 3;
+
+  enum RecordFlags : uint8_t {
+    /// The dependency does not cascade ("!private" in YAML).
+    IsPrivate = 1 << 0,
+  };
+} // end namespace binary
+
+/// Returns true if \p contents starts like a binary dependencies file.
+bool isBinaryFile(StringRef contents);
+
+/// Reads every entry of the binary dependencies file \p contents, in order.
+///
+/// The names passed to \p callback point into \p contents. If \p callback
+/// returns true, reading stops early.
+///
+/// \returns true if the file is malformed or \p callback asked to stop.
+bool readBinaryFile(StringRef contents,
+                    llvm::function_ref<bool(Section section,
+                                            ArrayRef<StringRef> names,
+                                            bool isCascading)> callback);
+
+/// Writes the contents of a dependencies file.
+///
+/// Clients must start each section before adding entries to it, and must
+/// call #finish once all entries have been added.
+class Writer {
+public:
+  virtual ~Writer();
+
+  /// Starts a new section. Each section should be started at most once.
+  virtual void beginSection(Section section) = 0;
+
+  /// Adds an entry to the current section.
+  virtual void addEntry(ArrayRef<StringRef> names, bool isCascading = true) = 0;
+
+  /// Records the interface hash of the file.
+  virtual void addInterfaceHash(StringRef hash) = 0;
+
+  /// Flushes any buffered contents.
+  virtual void finish() {}
+
+  /// Creates a writer for the human-readable YAML format.
+  static std::unique_ptr<Writer> createYAML(raw_ostream &out);
+
+  /// Creates a writer for the binary format.
+  static std::unique_ptr<Writer> createBinary(raw_ostream &out);
+};
+
+} // end namespace reference_dependencies
+} // end namespace swift
+
+#endif
@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include <map>
+#include <vector>
 
 namespace swift {
 
@@ -33,6 +34,14 @@ class SourceManager {
   /// Associates buffer identifiers to buffer IDs.
   llvm::StringMap<unsigned> BufIdentIDMap;
 
+  /// The offsets of the starts of the lines of each buffer, indexed by buffer
+  /// ID minus one.
+  ///
+  /// These are computed once when a buffer is added, so that converting
+  /// locations to lines and columns is a binary search which doesn't mutate
+  /// any state, and may be done from several threads at once.
+  std::vector<std::vector<unsigned>> LineStartOffsets;
+
   // #line directive handling.
   struct VirtualFile {
     CharSourceRange Range;
@@ -40,7 +49,6 @@ class SourceManager {
     int LineOffset;
   };
   std::map<const char *, VirtualFile> VirtualFiles;
-  mutable std::pair<const char *, const VirtualFile*> CachedVFile = {};
 
 public:
   llvm::SourceMgr &getLLVMSourceMgr() {
@@ -184,7 +192,7 @@ public:
     assert(Loc.isValid());
     int LineOffset = getLineOffset(Loc);
     int l, c;
-    std::tie(l, c) = LLVMSourceMgr.getLineAndColumn(Loc.Value, BufferID);
+    std::tie(l, c) = getRealLineAndColumn(Loc, BufferID);
     assert(LineOffset+l > 0 && "bogus line offset");
     return { LineOffset + l, c };
   }
@@ -196,7 +204,7 @@ public:
   /// This does not respect #line directives.
   unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const {
     assert(Loc.isValid());
-    return LLVMSourceMgr.FindLineNumber(Loc.Value, BufferID);
+    return getRealLineAndColumn(Loc, BufferID).first;
   }
 
   StringRef extractText(CharSourceRange Range,
@@ -223,6 +231,10 @@ public:
 private:
   const VirtualFile *getVirtualFile(SourceLoc Loc) const;
 
+  /// Returns the line and column of \p Loc, ignoring #line directives.
+  std::pair<unsigned, unsigned> getRealLineAndColumn(SourceLoc Loc,
+                                                     unsigned BufferID) const;
+
   int getLineOffset(SourceLoc Loc) const {
     if (auto VFile = getVirtualFile(Loc))
       return VFile->LineOffset;
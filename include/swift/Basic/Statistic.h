@@ -0,0 +1,82 @@
+//===--- Statistic.h - Per-job compile statistics ---------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Collects the time spent in each compilation phase, along with the
+/// counters in Statistics.def, and writes them to a JSON file when the job
+/// finishes (see \c -stats-output-dir).
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_STATISTIC_H
+#define SWIFT_BASIC_STATISTIC_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Timer.h"
+#include <cstddef>
+#include <mutex>
+
+namespace swift {
+
+/// Gathers the statistics for one frontend job.
+///
+/// Times are recorded by name, and are summed if the same name is recorded
+/// more than once. Everything is written out when the reporter is destroyed.
+class UnifiedStatsReporter {
+public:
+  struct FrontendCounters {
+#define FRONTEND_STATISTIC(GROUP, NAME) size_t NAME = 0;
+#include "swift/Basic/Statistics.def"
+  };
+
+private:
+  SmallString<128> Filename;
+  llvm::TimeRecord StartTime;
+  FrontendCounters Counters;
+
+  /// Guards Times and Counts, which may be recorded from several threads
+  /// during parallel LLVM code generation.
+  std::mutex TimesMutex;
+  llvm::StringMap<llvm::TimeRecord> Times;
+  llvm::StringMap<size_t> Counts;
+
+public:
+  /// Creates a reporter that writes to a new file in \p directory.
+  ///
+  /// The other arguments describe the job, and are used to make the file
+  /// name easy to aggregate on: for example,
+  /// "stats-swift-frontend-Foo-main.swift-x86_64-o-XXXXXX.json".
+  UnifiedStatsReporter(StringRef programName, StringRef moduleName,
+                       StringRef inputName, StringRef targetTriple,
+                       StringRef outputType, StringRef directory);
+  ~UnifiedStatsReporter();
+
+  UnifiedStatsReporter(const UnifiedStatsReporter &) = delete;
+  UnifiedStatsReporter &operator=(const UnifiedStatsReporter &) = delete;
+
+  FrontendCounters &getFrontendCounters() { return Counters; }
+
+  /// Adds \p elapsed to the time recorded for \p name.
+  void recordTime(StringRef name, const llvm::TimeRecord &elapsed);
+
+  /// Adds \p count to the counter \p name.
+  ///
+  /// Unlike the counters in Statistics.def, these are named at run time, for
+  /// statistics such as the number of times each peephole applied.
+  void recordCount(StringRef name, size_t count);
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_STATISTIC_H
@@ -15,12 +15,16 @@
 
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Program.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace swift {
 namespace sys {
@@ -38,21 +42,103 @@ enum class TaskFinishedResponse {
   StopExecution,
 };
 
+/// \brief A list of tasks waiting to begin execution.
+///
+/// Tasks with a higher priority are handed out first; tasks with the same
+/// priority are handed out in the order in which they were added.
+template <typename TaskTy>
+class PendingTaskList {
+  struct Entry {
+    unsigned Priority;
+    unsigned Sequence;
+    std::unique_ptr<TaskTy> T;
+  };
+
+  /// A heap whose front is the task which should begin execution next.
+  std::vector<Entry> Heap;
+  unsigned NextSequence = 0;
+
+  /// Heap comparator: true if \p RHS should begin execution before \p LHS.
+  static bool runsAfter(const Entry &LHS, const Entry &RHS) {
+    if (LHS.Priority != RHS.Priority)
+      return LHS.Priority < RHS.Priority;
+    return LHS.Sequence > RHS.Sequence;
+  }
+
+public:
+  bool empty() const { return Heap.empty(); }
+
+  /// Returns the task which should begin execution next.
+  const TaskTy &top() const {
+    assert(!empty());
+    return *Heap.front().T;
+  }
+
+  void push(std::unique_ptr<TaskTy> T, unsigned Priority) {
+    Heap.push_back({ Priority, NextSequence++, std::move(T) });
+    std::push_heap(Heap.begin(), Heap.end(), runsAfter);
+  }
+
+  /// Removes and returns the task which should begin execution next.
+  std::unique_ptr<TaskTy> pop() {
+    std::pop_heap(Heap.begin(), Heap.end(), runsAfter);
+    std::unique_ptr<TaskTy> T = std::move(Heap.back().T);
+    Heap.pop_back();
+    return T;
+  }
+};
+
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
 class TaskQueue {
   /// Tasks which have not begun execution.
-  std::queue<std::unique_ptr<Task>> QueuedTasks;
+  PendingTaskList<Task> QueuedTasks;
 
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+  /// The number of bytes of memory which the tasks executing in parallel are
+  /// expected to use at most, or 0 if there is no limit.
+  uint64_t MemoryLimit;
+
+  /// The largest peak resident memory, in bytes, of the tasks of each memory
+  /// class, as measured during this execution or provided by
+  /// #setPeakMemoryUsage.
+  llvm::StringMap<uint64_t> PeakMemoryUsage;
+
+  /// The memory classes which have had a task finish during this execution,
+  /// and so no longer rely on the estimates they were given.
+  llvm::StringSet<> MeasuredMemoryClasses;
+
+protected:
+  /// Returns how much memory a task of \p MemoryClass is expected to use, or
+  /// 0 if that isn't known.
+  uint64_t getMemoryEstimate(StringRef MemoryClass) const {
+    return MemoryClass.empty() ? 0 : PeakMemoryUsage.lookup(MemoryClass);
+  }
+
+  /// Returns true if a task expected to use \p Estimate bytes can begin
+  /// execution while the executing tasks are expected to use \p InUse.
+  ///
+  /// A task can always begin when nothing else is executing, since waiting
+  /// won't make any more memory available.
+  bool fitsInMemory(uint64_t InUse, uint64_t Estimate,
+                    bool AnyExecuting) const {
+    return MemoryLimit == 0 || !AnyExecuting || InUse + Estimate <= MemoryLimit;
+  }
+
+  /// Records that a task of \p MemoryClass used at most \p PeakMemory bytes.
+  void notePeakMemory(StringRef MemoryClass, uint64_t PeakMemory);
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
   /// \param NumberOfParallelTasks indicates the number of tasks which should
   /// be run in parallel. If 0, the TaskQueue will choose the most appropriate
   /// number of parallel tasks for the current system.
-  TaskQueue(unsigned NumberOfParallelTasks = 0);
+  /// \param MemoryLimit if non-zero, a task will not begin execution while
+  /// other tasks are executing if all of them together are expected to use
+  /// more than this many bytes of memory
+  TaskQueue(unsigned NumberOfParallelTasks = 0, uint64_t MemoryLimit = 0);
   virtual ~TaskQueue();
 
   // TODO: remove once -Wdocumentation stops warning for \param, \returns on
@@ -120,9 +206,28 @@ public:
   /// \param Env the environment which should be used for the task;
   /// must be null-terminated. If empty, inherits the parent's environment.
   /// \param Context an optional context which will be associated with the task
+  /// \param Priority tasks with a higher priority begin execution before
+  /// tasks with a lower priority; tasks with equal priority begin execution
+  /// in the order in which they were added
+  /// \param MemoryClass tasks in the same class are expected to use about as
+  /// much memory as each other, if a memory limit is set. The string must
+  /// outlive the TaskQueue.
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, unsigned Priority = 0,
+                       StringRef MemoryClass = StringRef());
+
+  /// \brief Provides the peak memory usage of an earlier task of
+  /// \p MemoryClass, to be used until one finishes during this execution.
+  void setPeakMemoryUsage(StringRef MemoryClass, uint64_t PeakMemory) {
+    PeakMemoryUsage[MemoryClass] = PeakMemory;
+  }
+
+  /// \returns the largest peak resident memory, in bytes, of the tasks of
+  /// each memory class. (This may not be measured on all platforms.)
+  const llvm::StringMap<uint64_t> &getPeakMemoryUsage() const {
+    return PeakMemoryUsage;
+  }
 
   /// \brief Synchronously executes the tasks in the TaskQueue.
   ///
@@ -159,7 +264,7 @@ class DummyTaskQueue : public TaskQueue {
       : ExecPath(ExecPath), Args(Args), Env(Env), Context(Context) {}
   };
 
-  std::queue<std::unique_ptr<DummyTask>> QueuedTasks;
+  PendingTaskList<DummyTask> QueuedTasks;
 
 public:
   /// \brief Create a new DummyTaskQueue instance.
@@ -168,7 +273,8 @@ public:
 
   virtual void addTask(const char *ExecPath, ArrayRef<const char *> Args,
                        ArrayRef<const char *> Env = llvm::None,
-                       void *Context = nullptr);
+                       void *Context = nullptr, unsigned Priority = 0,
+                       StringRef MemoryClass = StringRef());
 
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
@@ -18,6 +18,8 @@
 #include "llvm/Support/Timer.h"
 
 namespace swift {
+  class UnifiedStatsReporter;
+
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
   class SharedTimer {
@@ -27,23 +29,38 @@ namespace swift {
       Enabled
     };
     static State CompilationTimersEnabled;
+    static UnifiedStatsReporter *StatsReporter;
 
     Optional<llvm::NamedRegionTimer> Timer;
+    StringRef Name;
+    llvm::TimeRecord StartTime;
 
   public:
-    explicit SharedTimer(StringRef name) {
+    explicit SharedTimer(StringRef name) : Name(name) {
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
         CompilationTimersEnabled = State::Skipped;
+      if (StatsReporter)
+        StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
     }
 
+    ~SharedTimer();
+
     /// Must be called before any SharedTimers have been created.
     static void enableCompilationTimers() {
       assert(CompilationTimersEnabled != State::Skipped &&
              "a timer has already been created");
       CompilationTimersEnabled = State::Enabled;
     }
+
+    /// Also records the time spent in every SharedTimer with \p reporter,
+    /// until this is called again with null.
+    ///
+    /// This is independent of #enableCompilationTimers.
+    static void setStatsReporter(UnifiedStatsReporter *reporter) {
+      StatsReporter = reporter;
+    }
   };
 } // end namespace swift
 
@@ -211,6 +211,17 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Precompiles the bridging header at \p headerPath into \p outputPCHPath,
+  /// along with its Swift name lookup table.
+  ///
+  /// \returns true if there was an error.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
+  /// Returns true if the precompiled header at \p PCHFilename can be loaded
+  /// with the current options, and none of the headers it was built from
+  /// have changed since.
+  bool canReadPCH(StringRef PCHFilename);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
@@ -13,6 +13,7 @@
 #ifndef SWIFT_CLANGIMPORTER_CLANGIMPORTEROPTIONS_H
 #define SWIFT_CLANGIMPORTER_CLANGIMPORTEROPTIONS_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -73,6 +74,18 @@ public:
 
   /// Whether we should honor the swift_newtype attribute.
   bool HonorSwiftNewtypeAttr = false;
+
+  /// When the current build started, in seconds since the epoch, or 0 if it
+  /// isn't known.
+  ///
+  /// Clang modules which were validated after this time are assumed to still
+  /// be valid, so their headers aren't checked again.
+  uint64_t BuildSessionTimestamp = 0;
+
+  /// A precompiled header built from the bridging header (see
+  /// \c ClangImporter::emitBridgingPCH), which is loaded in place of parsing
+  /// the header.
+  std::string PrecompiledBridgingHeader;
 };
 
 } // end namespace swift
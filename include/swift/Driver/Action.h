@@ -17,7 +17,9 @@
 #include "swift/Driver/Types.h"
 #include "swift/Driver/Util.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/TimeValue.h"
+#include <string>
 
 namespace llvm {
 namespace opt {
@@ -46,9 +48,10 @@ public:
     REPLJob,
     LinkJob,
     GenerateDSYMJob,
+    GeneratePCHJob,
 
     JobFirst=CompileJob,
-    JobLast=GenerateDSYMJob
+    JobLast=GeneratePCHJob
   };
 
   static const char *getClassName(ActionClass AC);
@@ -93,6 +96,11 @@ public:
 
 class JobAction : public Action {
   ActionList Inputs;
+
+  /// The inputs which other actions take as well, and which are never owned
+  /// by this one.
+  llvm::SmallPtrSet<Action *, 1> SharedInputs;
+
   virtual void anchor();
 protected:
   JobAction(ActionClass Kind, ArrayRef<Action *> Inputs, types::ID Type)
@@ -106,6 +114,10 @@ public:
 
   ArrayRef<Action *> getInputs() const { return Inputs; }
   void addInput(Action *Input) { Inputs.push_back(Input); }
+  void addSharedInput(Action *Input) {
+    Inputs.push_back(Input);
+    SharedInputs.insert(Input);
+  }
 
   size_type size() const { return Inputs.size(); }
 
@@ -266,6 +278,24 @@ public:
   }
 };
 
+class GeneratePCHJobAction : public JobAction {
+  std::string PersistentPCHDir;
+  virtual void anchor();
+public:
+  /// If \p persistentPCHDir isn't empty, the precompiled header is kept
+  /// there for later builds instead of in a temporary file.
+  GeneratePCHJobAction(Action *Input, StringRef persistentPCHDir)
+    : JobAction(Action::GeneratePCHJob, Input, types::TY_PCH),
+      PersistentPCHDir(persistentPCHDir) {}
+
+  bool isPersistentPCH() const { return !PersistentPCHDir.empty(); }
+  StringRef getPersistentPCHDir() const { return PersistentPCHDir; }
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::GeneratePCHJob;
+  }
+};
+
 class LinkJobAction : public JobAction {
   virtual void anchor();
   LinkKind Kind;
@@ -0,0 +1,113 @@
+//===--- BuildStateCache.h - State kept between driver builds ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Caches the file system state a build reads, so that a long-lived
+/// driver process (see \c -driver-server) doesn't have to re-stat and re-read
+/// every input, output file map and dependencies file on each build.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_BUILDSTATECACHE_H
+#define SWIFT_DRIVER_BUILDSTATECACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <system_error>
+
+namespace swift {
+namespace driver {
+
+class CommandOutput;
+class OutputFileMap;
+
+/// File statuses and file contents shared by every build that uses the cache.
+///
+/// By default, statuses are only reused within a single build, and cached
+/// contents are revalidated against a fresh status at the start of each
+/// build. If the client promises to report every change through
+/// #fileChanged, statuses are kept until they are reported, so an unchanged
+/// tree can be rebuilt without touching the file system at all.
+class BuildStateCache {
+  struct StatusEntry {
+    std::error_code Error;
+    llvm::sys::fs::file_status Status;
+  };
+
+  template <typename T>
+  struct ContentsEntry {
+    llvm::sys::TimeValue ModTime;
+    uint64_t Size;
+    std::unique_ptr<T> Contents;
+  };
+
+  /// Whether the client reports every change to the file system.
+  bool TrustNotifications;
+
+  llvm::StringMap<StatusEntry> Statuses;
+  llvm::StringMap<ContentsEntry<OutputFileMap>> OutputFileMaps;
+  llvm::StringMap<ContentsEntry<llvm::MemoryBuffer>> Buffers;
+
+  /// Looks up \p path in \p cache, dropping the entry if the file has changed
+  /// since it was read.
+  template <typename T>
+  T *lookupContents(llvm::StringMap<ContentsEntry<T>> &cache, StringRef path,
+                    const llvm::sys::fs::file_status *&status);
+
+public:
+  explicit BuildStateCache(bool trustNotifications = false);
+  ~BuildStateCache();
+
+  BuildStateCache(const BuildStateCache &) = delete;
+  BuildStateCache &operator=(const BuildStateCache &) = delete;
+
+  bool trustsNotifications() const { return TrustNotifications; }
+
+  /// Called before each build that uses the cache.
+  void beginBuild();
+
+  /// Records that the file at \p path may have changed, been created, or been
+  /// removed.
+  void fileChanged(StringRef path);
+
+  /// Records that the command that produces \p output has run, and so may
+  /// have rewritten any of its outputs.
+  void outputsChanged(const CommandOutput &output);
+
+  /// Forgets everything.
+  void clear();
+
+  /// Returns the status of the file at \p path, like llvm::sys::fs::status.
+  std::error_code getStatus(StringRef path,
+                            llvm::sys::fs::file_status &result);
+
+  /// Returns the output file map at \p path, or null if it can't be loaded.
+  ///
+  /// The map is owned by the cache, and remains valid until the file is
+  /// reported changed or the cache is cleared.
+  const OutputFileMap *getOutputFileMap(StringRef path);
+
+  /// Returns the contents of the file at \p path, or null if it can't be
+  /// read.
+  ///
+  /// The buffer is owned by the cache, and remains valid until the file is
+  /// reported changed or the cache is cleared.
+  llvm::MemoryBuffer *getBuffer(StringRef path);
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
@@ -22,6 +22,7 @@
 #include "swift/Basic/ArrayRefView.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
@@ -39,7 +40,10 @@ namespace swift {
   class DiagnosticEngine;
 
 namespace driver {
+  class BuildStateCache;
+  class CompilationCache;
   class Driver;
+  class OutputInfo;
   class ToolChain;
 
 /// An enum providing different levels of output which should be produced
@@ -82,6 +86,11 @@ private:
   /// Used for large compilations to avoid overflowing argv.
   const char *AllSourceFilesPath = nullptr;
 
+  /// When non-null, a temporary file listing the contents of the import and
+  /// framework search paths, so that frontend jobs don't each have to look
+  /// for every module in every search path.
+  const char *SearchPathListingPath = nullptr;
+
   /// Temporary files that should be cleaned up after the compilation finishes.
   ///
   /// These apply whether the compilation succeeds or fails.
@@ -106,10 +115,24 @@ private:
   /// If unknown, this will be some time in the past.
   llvm::sys::TimeValue LastBuildTime = llvm::sys::TimeValue::MinTime();
 
+  /// The interface hashes of the external dependencies which were modules,
+  /// as of the last build.
+  ///
+  /// A module which has been rebuilt with the same interface hash doesn't
+  /// affect the files which depend on it.
+  llvm::StringMap<std::string> PreviousExternalInterfaceHashes;
+
   /// The number of commands which this compilation should attempt to run in
   /// parallel.
   unsigned NumberOfParallelCommands;
 
+  /// The number of bytes of memory which the commands running in parallel
+  /// are expected to use at most, or 0 if there is no limit.
+  ///
+  /// Each kind of command is expected to use as much as the largest one of
+  /// that kind did in the last build.
+  uint64_t JobMemoryLimit = 0;
+
   /// Indicates whether this Compilation should use skip execution of
   /// subtasks during performJobs() by using a dummy TaskQueue.
   ///
@@ -132,6 +155,23 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When non-null, compile jobs which are ready to run at the same time are
+  /// grouped into batches, each of which runs in a single frontend process.
+  ///
+  /// \sa enableBatchMode
+  const ToolChain *BatchModeToolChain = nullptr;
+
+  /// The OutputInfo used to construct batch jobs.
+  std::unique_ptr<OutputInfo> BatchModeOutputInfo;
+
+  /// If non-null, file statuses and dependencies files are read through this
+  /// cache, which is told about every output the jobs may have written.
+  BuildStateCache *StateCache = nullptr;
+
+  /// If non-null, the outputs of compile jobs are restored from this cache
+  /// instead of running them when possible, and stored in it otherwise.
+  std::unique_ptr<CompilationCache> Cache;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -171,6 +211,9 @@ public:
     return NumberOfParallelCommands;
   }
 
+  uint64_t getJobMemoryLimit() const { return JobMemoryLimit; }
+  void setJobMemoryLimit(uint64_t Bytes) { JobMemoryLimit = Bytes; }
+
   bool getIncrementalBuildEnabled() const {
     return EnableIncrementalBuild;
   }
@@ -189,6 +232,22 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  BuildStateCache *getBuildStateCache() const { return StateCache; }
+  void setBuildStateCache(BuildStateCache *Cache) { StateCache = Cache; }
+
+  CompilationCache *getCompilationCache() const { return Cache.get(); }
+  void setCompilationCache(std::unique_ptr<CompilationCache> NewCache);
+
+  /// Compile several primary files per frontend process, using \p TC and
+  /// \p OI to construct the combined jobs.
+  ///
+  /// Only compile jobs that produce nothing but per-file outputs are combined;
+  /// everything else still runs on its own.
+  void enableBatchMode(const ToolChain &TC, const OutputInfo &OI);
+  bool getBatchModeEnabled() const {
+    return BatchModeToolChain != nullptr;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
@@ -198,6 +257,10 @@ public:
     LastBuildTime = time;
   }
 
+  void setPreviousExternalInterfaceHashes(llvm::StringMap<std::string> hashes) {
+    PreviousExternalInterfaceHashes = std::move(hashes);
+  }
+
   /// Requests the path to a file containing all input source files. This can
   /// be shared across jobs.
   ///
@@ -207,6 +270,14 @@ public:
   /// \sa types::isPartOfSwiftCompilation
   const char *getAllSourcesPath() const;
 
+  /// Requests the path to a file listing the contents of the directories
+  /// passed with -I and -F, as they are when the jobs start. This can be
+  /// shared across jobs.
+  ///
+  /// If this is never called, the Compilation does not bother generating such
+  /// a file.
+  const char *getSearchPathListingPath() const;
+
   /// Asks the Compilation to perform the Jobs which it knows about.
   /// \returns result code for the Compilation's Jobs; 0 indicates success and
   /// -2 indicates that one of the Compilation's Jobs crashed during execution
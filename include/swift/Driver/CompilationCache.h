@@ -0,0 +1,115 @@
+//===--- CompilationCache.h - Reuse the outputs of compile jobs -*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Stores the outputs of compile jobs under a hash of everything they
+/// read, so that a build of the same sources (on this or another machine)
+/// can restore them instead of running the frontend (see
+/// \c -compilation-cache-path).
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_COMPILATIONCACHE_H
+#define SWIFT_DRIVER_COMPILATIONCACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <string>
+
+namespace swift {
+namespace driver {
+
+class CommandOutput;
+class Job;
+
+/// Where the outputs of cached jobs are kept.
+///
+/// Entries are never modified once they are stored, so implementations may
+/// be shared by concurrent builds.
+class CompilationCacheStore {
+public:
+  virtual ~CompilationCacheStore();
+
+  /// Copies the files stored under \p key to \p outputPaths, in order, and
+  /// sets \p output to the text the job printed.
+  ///
+  /// \returns false if there is no complete entry for \p key.
+  virtual bool restore(StringRef key, ArrayRef<std::string> outputPaths,
+                       std::string &output) = 0;
+
+  /// Stores copies of the files at \p outputPaths, and the text \p output,
+  /// under \p key.
+  virtual void store(StringRef key, ArrayRef<std::string> outputPaths,
+                     StringRef output) = 0;
+};
+
+/// A store in a local (or network-mounted) directory.
+class LocalCompilationCacheStore : public CompilationCacheStore {
+  std::string Directory;
+
+public:
+  explicit LocalCompilationCacheStore(StringRef directory)
+    : Directory(directory) {}
+
+  bool restore(StringRef key, ArrayRef<std::string> outputPaths,
+               std::string &output) override;
+  void store(StringRef key, ArrayRef<std::string> outputPaths,
+             StringRef output) override;
+};
+
+/// Computes the keys of jobs, and moves their outputs in and out of a store.
+///
+/// A key hashes the compiler version, the job's command line, the contents of
+/// every file named on it, and the contents of the modules in every directory
+/// named on it, which covers the modules found through the import search
+/// paths. Output paths are left out, so that the same job in another build
+/// directory has the same key. Anything a job reads which isn't named on its
+/// command line, such as the headers of Clang modules, is not part of the key.
+class CompilationCache {
+  std::unique_ptr<CompilationCacheStore> Store;
+
+  /// Hashes of the files and directories named by the jobs of the build,
+  /// which are assumed not to change while it runs.
+  llvm::StringMap<std::string> ContentHashes;
+
+  /// Returns the hash of the contents of the file or directory at \p path,
+  /// or an empty string if it can't be read.
+  StringRef getContentHash(StringRef path);
+
+public:
+  explicit CompilationCache(std::unique_ptr<CompilationCacheStore> store)
+    : Store(std::move(store)) {}
+
+  /// Returns the key of \p cmd.
+  ///
+  /// \p isTemporary tells whether a file was made up for this build, in which
+  /// case only its contents are hashed.
+  std::string computeKey(const Job &cmd,
+                         llvm::function_ref<bool(StringRef)> isTemporary);
+
+  /// Restores the outputs of \p cmd stored under \p key, and sets \p output
+  /// to the text it printed.
+  ///
+  /// \returns false if they aren't in the store.
+  bool restore(const Job &cmd, StringRef key, std::string &output);
+
+  /// Stores the outputs just written by \p cmd under \p key, unless some of
+  /// them are missing.
+  void store(const Job &cmd, StringRef key, StringRef output);
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
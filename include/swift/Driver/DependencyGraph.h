@@ -129,7 +129,19 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
-  LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
+  /// The fingerprint of each "provides" entry for each node, keyed by the
+  /// entry's kind and name. Fingerprints track the interface of individual
+  /// declarations, so that a change to one of them doesn't affect the nodes
+  /// that depend only on others.
+  ///
+  /// \sa SourceFile::getDeclInterfaceHash
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>> Fingerprints;
+
+  /// The "provides" entries whose fingerprints did not change the last time
+  /// a node was reloaded with a different interface hash, keyed the same way
+  /// as Fingerprints. This only narrows the next #markTransitive starting at
+  /// that node; every other entry is treated as changed.
+  llvm::DenseMap<const void *, llvm::StringSet<>> UnchangedProvides;
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
   // StringMapConstIterator isn't quite an InputIterator (no ->).
@@ -161,6 +173,7 @@ private:
 protected:
   LoadResult loadFromString(const void *node, StringRef data);
   LoadResult loadFromPath(const void *node, StringRef path);
+  LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   void addIndependentNode(const void *node) {
     bool newlyInserted = Provides.insert({node, {}}).second;
@@ -243,11 +256,24 @@ public:
   /// ("depends") are not cleared; new dependencies are considered additive.
   ///
   /// If \p node has already been marked, only its outgoing edges are updated.
+  ///
+  /// If the interface of \p node changed and the file provides fingerprints
+  /// for its outgoing edges, the next call to #markTransitive for \p node
+  /// only follows the edges whose fingerprints changed.
   LoadResult loadFromPath(T node, StringRef path) {
     return DependencyGraphImpl::loadFromPath(Traits::getAsVoidPointer(node),
                                              path);
   }
 
+  /// Load "depends" and "provides" data for \p node from \p buffer, which
+  /// holds the contents of a dependencies file.
+  ///
+  /// \sa loadFromPath
+  LoadResult loadFromBuffer(T node, llvm::MemoryBuffer &buffer) {
+    return DependencyGraphImpl::loadFromBuffer(Traits::getAsVoidPointer(node),
+                                               buffer);
+  }
+
   /// Load "depends" and "provides" data for \p node from a plain string.
   ///
   /// This is only intended for testing purposes.
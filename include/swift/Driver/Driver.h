@@ -43,6 +43,7 @@ namespace opt {
 namespace swift {
   class DiagnosticEngine;
 namespace driver {
+  class BuildStateCache;
   class Compilation;
   class Job;
   class JobAction;
@@ -95,6 +96,10 @@ public:
   /// output.
   bool ShouldTreatModuleAsTopLevelOutput = false;
 
+  /// Whether the module is emitted from the sources by its own job, rather
+  /// than merged from the partial modules of the compile jobs.
+  bool ShouldEmitModuleSeparately = false;
+
   /// Whether the compiler picked the current module name, rather than the user.
   bool ModuleNameIsFallback = false;
 
@@ -106,6 +111,16 @@ public:
 
   /// Returns true if multi-threading is enabled.
   bool isMultiThreading() const { return numThreads > 0; }
+
+  /// Whether a multi-threaded compilation writes a single object file, which
+  /// the frontend merges from the objects of its threads.
+  bool MergeThreadOutputs = false;
+
+  /// Returns true if a multi-threaded compilation produces one output file
+  /// for each input file.
+  bool hasOutputPerThread() const {
+    return isMultiThreading() && !MergeThreadOutputs;
+  }
   
   /// The name of the module which we are building.
   std::string ModuleName;
@@ -154,6 +169,10 @@ private:
   /// Indicates whether the driver should check that the input files exist.
   bool CheckInputFilesExist = true;
 
+  /// If non-null, the file system state shared with other builds run by the
+  /// same process. Not owned by the driver.
+  BuildStateCache *StateCache = nullptr;
+
   /// \brief Cache of all the ToolChains in use by the driver.
   ///
   /// This maps from the string representation of a triple to a ToolChain
@@ -183,6 +202,12 @@ public:
 
   void setCheckInputFilesExist(bool Value) { CheckInputFilesExist = Value; }
 
+  BuildStateCache *getBuildStateCache() const { return StateCache; }
+
+  /// Makes the driver, and any Compilation it builds, read file statuses,
+  /// the output file map and dependencies files through \p Cache.
+  void setBuildStateCache(BuildStateCache *Cache) { StateCache = Cache; }
+
   /// Construct a compilation object for a command line argument vector.
   ///
   /// \return A Compilation, or nullptr if none was built for the given argument
@@ -237,8 +262,12 @@ public:
                     ActionList &Actions) const;
 
   /// Construct the OutputFileMap for the driver from the given arguments.
-  std::unique_ptr<OutputFileMap>
-  buildOutputFileMap(const llvm::opt::DerivedArgList &Args) const;
+  ///
+  /// If the driver has a BuildStateCache, the map is owned by the cache.
+  /// Otherwise it is stored in \p OwnedOFM.
+  const OutputFileMap *
+  buildOutputFileMap(const llvm::opt::DerivedArgList &Args,
+                     std::unique_ptr<OutputFileMap> &OwnedOFM) const;
 
   /// Add top-level Jobs to Compilation \p C for the given \p Actions and
   /// OutputInfo.
@@ -77,6 +77,9 @@ protected:
     /// Forwards to Compilation::getAllSourcesPath.
     const char *getAllSourcesPath() const;
 
+    /// Forwards to Compilation::getSearchPathListingPath.
+    const char *getSearchPathListingPath() const;
+
     /// Creates a new temporary file for use by a job.
     ///
     /// The returned string already has its lifetime extended to match other
@@ -122,12 +125,24 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual InvocationInfo
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
   constructInvocation(const LinkJobAction &job,
                       const JobContext &context) const;
 
+  /// Constructs the invocation for a frontend process that compiles the
+  /// primary files of all of \p jobs at once.
+  ///
+  /// \p jobs are compile jobs in command-line order, and \p context has one
+  /// input action per job, in the same order.
+  virtual InvocationInfo
+  constructBatchInvocation(ArrayRef<const Job *> jobs,
+                           const JobContext &context) const;
+
   /// Searches for the given executable in appropriate paths relative to the
   /// Swift binary.
   ///
@@ -160,6 +175,16 @@ public:
                                     std::unique_ptr<CommandOutput> output,
                                     const OutputInfo &OI) const;
 
+  /// Construct a single Job which does the work of all the compile jobs in
+  /// \p jobs, using one frontend process for all of their primary files.
+  ///
+  /// The jobs must all produce the same kinds of output. The resulting Job
+  /// takes its source action from the first job, and its primary outputs are
+  /// those of every job.
+  std::unique_ptr<Job> constructBatchJob(ArrayRef<const Job *> jobs,
+                                         Compilation &C,
+                                         const OutputInfo &OI) const;
+
   /// Return the default language type to use for the given extension.
   virtual types::ID lookupTypeForExtension(StringRef Ext) const;
 };
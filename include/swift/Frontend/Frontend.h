@@ -330,8 +330,19 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// In batch mode, the buffers, source files, and name trackers of every
+  /// primary input, in the order of FrontendOptions::BatchPrimaryInputs.
+  /// PrimaryBufferID and PrimarySourceFile refer to the first of them.
+  std::vector<unsigned> BatchPrimaryBufferIDs;
+  std::vector<SourceFile *> BatchPrimarySourceFiles;
+  std::vector<ReferencedNameTracker *> BatchNameTrackers;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
+  void recordPrimaryBuffer(unsigned InputIndex, unsigned BufferID);
+  void recordPrimarySourceFile(SourceFile *SF);
+  bool isPrimaryBuffer(unsigned BufferID) const;
+  bool isPrimarySourceFile(const SourceFile *SF) const;
 
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
@@ -366,6 +377,14 @@ public:
     return NameTracker;
   }
 
+  /// In batch mode, sets the name tracker for each primary input, in the
+  /// order of FrontendOptions::BatchPrimaryInputs.
+  void setBatchReferencedNameTrackers(
+      ArrayRef<ReferencedNameTracker *> trackers) {
+    assert(!PrimarySourceFile && "must be called before performSema()");
+    BatchNameTrackers.assign(trackers.begin(), trackers.end());
+  }
+
   /// Set the SIL module for this compilation instance.
   ///
   /// The CompilerInstance takes ownership of the given SILModule object.
@@ -403,6 +422,12 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// In batch mode, gets the SourceFiles of all primary inputs, in the order
+  /// of FrontendOptions::BatchPrimaryInputs. Otherwise, returns an empty list.
+  ArrayRef<SourceFile *> getBatchPrimarySourceFiles() const {
+    return BatchPrimarySourceFiles;
+  }
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
@@ -61,6 +61,30 @@ enum class InputFileKind {
   IFK_LLVM_IR
 };
 
+/// One of several primary files compiled by a single frontend invocation
+/// ("batch mode"), together with the outputs generated for it.
+struct BatchPrimaryInput {
+  /// The primary input, in FrontendOptions::InputFilenames.
+  SelectedInput Input;
+
+  /// The main output file for this primary (-o).
+  std::string OutputFilename;
+
+  /// \see FrontendOptions::ModuleOutputPath
+  std::string ModuleOutputPath;
+
+  /// \see FrontendOptions::ModuleDocOutputPath
+  std::string ModuleDocOutputPath;
+
+  /// \see FrontendOptions::DependenciesFilePath
+  std::string DependenciesFilePath;
+
+  /// \see FrontendOptions::ReferenceDependenciesFilePath
+  std::string ReferenceDependenciesFilePath;
+
+  BatchPrimaryInput(SelectedInput Input) : Input(Input) {}
+};
+
 /// Options for controlling the behavior of the frontend.
 class FrontendOptions {
 public:
@@ -74,6 +98,13 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// If more than one primary file was given, all of them, in command-line
+  /// order, along with their per-file outputs. PrimaryInput is then the first
+  /// of these, and the single-file output paths below are unused.
+  ///
+  /// \see getOptionsForBatchPrimary
+  std::vector<BatchPrimaryInput> BatchPrimaryInputs;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -112,6 +143,12 @@ public:
   /// The path to which we should output a Swift reference dependencies file.
   std::string ReferenceDependenciesFilePath;
 
+  /// Whether the reference dependencies file should use the compact binary
+  /// format instead of YAML.
+  ///
+  /// \sa swift::reference_dependencies
+  bool EmitBinaryReferenceDependencies = false;
+
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
@@ -134,6 +171,12 @@ public:
   /// Intended for debugging purposes only.
   unsigned WarnLongFunctionBodies = 0;
 
+  /// If non-zero, warn when type-checking an expression takes longer than
+  /// this many milliseconds.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressionTypeChecking = 0;
+
   enum ActionType {
     NoneAction, ///< No specific action
     Parse, ///< Parse and type-check only
@@ -160,6 +203,8 @@ public:
     EmitIR, ///< Emit LLVM IR
     EmitBC, ///< Emit LLVM BC
     EmitObject, ///< Emit object file
+
+    EmitPCH, ///< Precompile the bridging header
   };
 
   /// Indicates the action the user requested that the frontend perform.
@@ -175,12 +220,34 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If set, dumps the time taken to type-check each expression to
+  /// llvm::errs(), slowest first, once each file has been type-checked.
+  bool DebugTimeExpressionTypeChecking = false;
+
   /// If set, prints the time taken in each major compilation phase to 
   /// llvm::errs().
   ///
   /// \sa swift::SharedTimer
   bool DebugTimeCompilation = false;
 
+  /// If non-empty, a JSON file of the time taken in each compilation phase and
+  /// the counters in swift/Basic/Statistics.def is written to this directory.
+  ///
+  /// \sa swift::UnifiedStatsReporter
+  std::string StatsOutputDir;
+
+  /// If non-empty, the SIL optimizer writes a YAML record of the
+  /// optimizations it applied and missed to this file.
+  ///
+  /// \sa swift::OptRemark::Emitter
+  std::string OptRecordPath;
+
+  /// If non-empty, immediate mode runs scripts compiled by earlier runs from
+  /// the cache in this directory, and adds newly compiled scripts to it.
+  ///
+  /// \sa swift::getScriptCacheEntryPath
+  std::string ScriptCachePath;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
@@ -199,6 +266,11 @@ public:
   /// \see ResilienceStrategy::Resilient
   bool EnableResilience = false;
 
+  /// The resilience domain of the module being compiled, if any.
+  ///
+  /// \see ModuleDecl::getResilienceDomain
+  std::string ResilienceDomain;
+
   /// Indicates that the frontend should emit "verbose" SIL
   /// (if asked to emit SIL).
   bool EmitVerboseSIL = false;
@@ -258,6 +330,13 @@ public:
   bool actionIsImmediate() const;
 
   void forAllOutputPaths(std::function<void(const std::string &)> fn) const;
+
+  /// Indicates whether several primary files are compiled at once.
+  bool isBatchMode() const { return !BatchPrimaryInputs.empty(); }
+
+  /// Returns a copy of these options which describes a compilation of only
+  /// the \p Index'th batch primary file, with that file's outputs filled in.
+  FrontendOptions getOptionsForBatchPrimary(unsigned Index) const;
   
   /// Gets the name of the specified output filename.
   /// If multiple files are specified, the last one is returned.
@@ -16,6 +16,10 @@
 #include "swift/IDE/CodeCompletion.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace swift {
 namespace ide {
@@ -71,19 +75,36 @@ private:
 /// These results persist between multiple code completion requests and can be
 /// used with different ASTContexts.
 class OnDiskCodeCompletionCache {
-  std::string cacheDirectory;
-
 public:
   using Key = CodeCompletionCache::Key;
   using Value = CodeCompletionCache::Value;
   using ValueRefCntPtr = CodeCompletionCache::ValueRefCntPtr;
 
+private:
+  std::string cacheDirectory;
+
+  /// Results queued by \c setAsync that the writer thread hasn't written yet.
+  std::deque<std::pair<Key, ValueRefCntPtr>> pendingWrites;
+  std::mutex pendingWritesMutex;
+  std::condition_variable pendingWritesChanged;
+  bool stopWriter = false;
+  std::thread writer;
+
+  void runWriter();
+
+public:
   OnDiskCodeCompletionCache(Twine cacheDirectory);
+  /// Waits for any writes queued by \c setAsync to finish.
   ~OnDiskCodeCompletionCache();
 
   Optional<ValueRefCntPtr> get(const Key &K);
   std::error_code set(const Key &K, ValueRefCntPtr V);
 
+  /// Writes \p V to disk on a background thread.
+  ///
+  /// \p V must not be modified after this call.
+  void setAsync(const Key &K, ValueRefCntPtr V);
+
   static Optional<ValueRefCntPtr> getFromFile(StringRef filename);
 };
 
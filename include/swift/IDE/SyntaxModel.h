@@ -186,6 +186,14 @@ public:
   ~SyntaxModelContext();
 
   bool walk(SyntaxModelWalker &Walker);
+
+  /// Walks only the part of the file around the \p Length bytes at
+  /// \p Offset, for clients which update the syntax of an edited range.
+  ///
+  /// The whole top-level declarations overlapping the range are walked, with
+  /// the tokens between them and the neighbouring declarations; the rest of
+  /// the file is neither lexed nor walked.
+  bool walk(SyntaxModelWalker &Walker, unsigned Offset, unsigned Length);
 };
 
 } // namespace ide
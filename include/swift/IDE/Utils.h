@@ -125,6 +125,17 @@ void getLocationInfoForClangNode(ClangNode ClangNode,
 
 Optional<std::pair<unsigned, unsigned>> parseLineCol(StringRef LineCol);
 
+/// Appends the top-level declarations of \p SF which overlap the bytes from
+/// \p Offset to \p EndOffset to \p Decls, in source order.
+///
+/// \returns the offsets of a range of the buffer which starts and ends
+/// between tokens, and so can be lexed on its own. It covers the requested
+/// range and the declarations, and is widened to the end of the preceding
+/// top-level declaration and to the start of the following one.
+std::pair<unsigned, unsigned>
+findTopLevelDeclsInRange(SourceFile &SF, unsigned Offset, unsigned EndOffset,
+                         SmallVectorImpl<Decl *> &Decls);
+
 Decl *getDeclFromUSR(ASTContext &context, StringRef USR, std::string &error);
 Decl *getDeclFromMangledSymbolName(ASTContext &context, StringRef mangledName,
                                    std::string &error);
@@ -18,6 +18,9 @@
 #ifndef SWIFT_IMMEDIATE_IMMEDIATE_H
 #define SWIFT_IMMEDIATE_IMMEDIATE_H
 
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <string>
 #include <vector>
 
@@ -35,9 +38,31 @@ namespace swift {
 
   /// Attempt to run the script identified by the given compiler instance.
   ///
+  /// If \p ScriptCacheEntryPath isn't empty, the compiled script is stored in
+  /// that script cache entry.
+  ///
   /// \return the result returned from main(), if execution succeeded
   int RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts);
+                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                     StringRef ScriptCacheEntryPath = StringRef());
+
+  /// Computes the path of the entry in the script cache \p CacheDir for a
+  /// script compiled from \p InputFilenames with the frontend arguments
+  /// \p Args.
+  ///
+  /// \return an empty string if an input file can't be read
+  std::string getScriptCacheEntryPath(StringRef CacheDir,
+                                      ArrayRef<const char *> Args,
+                                      ArrayRef<std::string> InputFilenames);
+
+  /// Attempt to run a script from the script cache entry \p EntryPath, which
+  /// was stored by an earlier RunImmediately.
+  ///
+  /// \return true if the entry is up to date and the script was run, with
+  /// the result returned from main() in \p ReturnValue
+  bool RunCachedScript(CompilerInstance &CI, StringRef EntryPath,
+                       const ProcessCmdLine &CmdLine, IRGenOptions &IRGenOpts,
+                       int &ReturnValue);
 
   void runREPL(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                bool ParseStdlib);
@@ -95,6 +95,14 @@ namespace swift {
     SwiftStackPromotion() : llvm::FunctionPass(ID) {}
   };
 
+  class SwiftInlineRefCounting : public llvm::FunctionPass {
+    virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+    virtual bool runOnFunction(llvm::Function &F) override;
+  public:
+    static char ID;
+    SwiftInlineRefCounting() : llvm::FunctionPass(ID) {}
+  };
+
   class InlineTreePrinter : public llvm::ModulePass {
     virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
     virtual bool runOnModule(llvm::Module &M) override;
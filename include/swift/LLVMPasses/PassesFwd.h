@@ -26,6 +26,7 @@ namespace llvm {
   void initializeSwiftStackPromotionPass(PassRegistry &);
   void initializeInlineTreePrinterPass(PassRegistry &);
   void initializeSwiftMergeFunctionsPass(PassRegistry &);
+  void initializeSwiftInlineRefCountingPass(PassRegistry &);
 }
 
 namespace swift {
@@ -34,6 +35,7 @@ namespace swift {
   llvm::FunctionPass *createSwiftStackPromotionPass();
   llvm::ModulePass *createInlineTreePrinterPass();
   llvm::ModulePass *createSwiftMergeFunctionsPass();
+  llvm::FunctionPass *createSwiftInlineRefCountingPass();
   llvm::ImmutablePass *createSwiftAAWrapperPass();
   llvm::ImmutablePass *createSwiftRCIdentityPass();
 } // end namespace swift
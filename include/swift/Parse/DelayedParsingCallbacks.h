@@ -13,6 +13,7 @@
 #ifndef SWIFT_PARSE_DELAYED_PARSING_CALLBACKS_H
 #define SWIFT_PARSE_DELAYED_PARSING_CALLBACKS_H
 
+#include "swift/AST/Attr.h"
 #include "swift/Basic/SourceLoc.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/Parser.h"
@@ -44,6 +45,19 @@ class AlwaysDelayedCallbacks : public DelayedParsingCallbacks {
   }
 };
 
+/// \brief Skips every function body except those of transparent functions,
+/// whose parsing is delayed instead.
+///
+/// This is for files whose function bodies will not be type-checked.
+class SkipNonTransparentFunctions : public DelayedParsingCallbacks {
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    return Attrs.hasAttribute<TransparentAttr>();
+  }
+};
+
 /// \brief Implementation of callbacks that guide the parser in delayed
 /// parsing for code completion.
 class CodeCompleteDelayedCallbacks : public DelayedParsingCallbacks {
@@ -122,7 +122,12 @@ enum class FieldDescriptorKind : uint16_t {
   // An Objective-C class, which may be imported or defined in Swift.
   // In the former case, field type metadata is not emitted, and
   // must be obtained from the Objective-C runtime.
-  ObjCClass
+  ObjCClass,
+
+  // A Swift struct whose stored properties are laid out by decreasing
+  // alignment, keeping declaration order among properties of the same
+  // alignment, instead of in declaration order.
+  ReorderedStruct
 };
 
 // Field descriptors contain a collection of field records for a single
@@ -45,6 +45,12 @@ class ReflectionContext
 
   std::unordered_map<typename super::StoredPointer, const TypeInfo *> Cache;
 
+  /// The results of isHeapObjectMetadata, keyed by the address of the
+  /// metadata: the size of the smallest instance for the metadata of a
+  /// Swift heap object, or 0 for anything else.
+  std::unordered_map<typename super::StoredPointer, uint64_t>
+    HeapObjectMetadataCache;
+
 public:
   using super::getBuilder;
   using super::readIsaMask;
@@ -170,6 +176,56 @@ public:
     }
   }
 
+  /// The number of heap objects of a type found by takeHeapCensus, and the
+  /// total size of the blocks they occupy.
+  struct HeapCensusEntry {
+    uint64_t Count = 0;
+    uint64_t Bytes = 0;
+  };
+
+  /// Returns whether \p MetadataAddress is the address of the metadata of a
+  /// Swift heap object that fits in \p BlockSize bytes: a Swift class, or a
+  /// closure context or box whose metadata is known.
+  bool isHeapObjectMetadata(StoredPointer MetadataAddress,
+                            uint64_t BlockSize) {
+    if (MetadataAddress == 0 || MetadataAddress % sizeof(StoredPointer) != 0)
+      return false;
+
+    auto Cached = HeapObjectMetadataCache.find(MetadataAddress);
+    if (Cached != HeapObjectMetadataCache.end())
+      return Cached->second != 0 && Cached->second <= BlockSize;
+
+    auto MinimumSize = readHeapObjectMinimumSize(MetadataAddress);
+    HeapObjectMetadataCache[MetadataAddress] = MinimumSize;
+    return MinimumSize != 0 && MinimumSize <= BlockSize;
+  }
+
+  /// Count the Swift heap objects among the given blocks of the target's
+  /// memory, such as the blocks allocated in its malloc zones, and the bytes
+  /// they occupy, by the address of their metadata.
+  ///
+  /// A block is taken to hold a heap object starting at its first byte if
+  /// the block's first word is the isa pointer of heap object metadata
+  /// according to isHeapObjectMetadata. The metadata reader's caches make
+  /// repeated blocks of the same type cheap to identify.
+  std::unordered_map<StoredPointer, HeapCensusEntry>
+  takeHeapCensus(
+      const std::vector<std::pair<StoredPointer, uint64_t>> &Blocks) {
+    std::unordered_map<StoredPointer, HeapCensusEntry> Census;
+    for (auto &Block : Blocks) {
+      if (Block.second < sizeof(StoredPointer))
+        continue;
+      auto MetadataAddress = readMetadataFromInstance(Block.first);
+      if (!MetadataAddress.first ||
+          !isHeapObjectMetadata(MetadataAddress.second, Block.second))
+        continue;
+      auto &Entry = Census[MetadataAddress.second];
+      ++Entry.Count;
+      Entry.Bytes += Block.second;
+    }
+    return Census;
+  }
+
   bool
   projectExistential(RemoteAddress ExistentialAddress,
                      const TypeRef *ExistentialTR,
@@ -550,6 +606,57 @@ private:
 
     return std::make_pair(false, StoredPointer(0));
   }
+
+  /// Returns the size of the smallest instance of the heap object whose
+  /// metadata is at \p MetadataAddress, or 0 if it isn't the metadata of a
+  /// Swift heap object.
+  uint64_t readHeapObjectMinimumSize(StoredPointer MetadataAddress) {
+    // Check the kind before reading the metadata, since reading arbitrary
+    // memory as, say, tuple metadata could read an arbitrary amount of it.
+    StoredPointer KindValue;
+    if (!getReader().readInteger(RemoteAddress(MetadataAddress), &KindValue))
+      return 0;
+
+    // The header of every heap object: the isa pointer and the refcounts.
+    uint64_t HeaderSize = 2 * sizeof(StoredPointer);
+
+    switch (getEnumeratedMetadataKind(KindValue)) {
+    case MetadataKind::Class: {
+      auto Meta = readMetadata(MetadataAddress);
+      if (!Meta || Meta->getKind() != MetadataKind::Class)
+        return 0;
+      auto ClassMeta = cast<TargetClassMetadata<Runtime>>(Meta);
+      if (!ClassMeta->isTypeMetadata() || ClassMeta->isArtificialSubclass())
+        return 0;
+      if (ClassMeta->getInstanceSize() < HeaderSize ||
+          readTypeFromMetadata(MetadataAddress) == nullptr)
+        return 0;
+      return ClassMeta->getInstanceSize();
+    }
+
+    case MetadataKind::HeapLocalVariable: {
+      auto CDAddr = this->readCaptureDescriptorFromMetadata(MetadataAddress);
+      if (!CDAddr.first || CDAddr.second == 0 ||
+          getBuilder().getCaptureDescriptor(CDAddr.second) == nullptr)
+        return 0;
+      return HeaderSize;
+    }
+
+    case MetadataKind::HeapGenericLocalVariable: {
+      auto Meta = readMetadata(MetadataAddress);
+      if (!Meta)
+        return 0;
+      auto GenericHeapMeta =
+        cast<TargetGenericBoxHeapMetadata<Runtime>>(Meta.getLocalBuffer());
+      if (readTypeFromMetadata(GenericHeapMeta->BoxedType) == nullptr)
+        return 0;
+      return HeaderSize;
+    }
+
+    default:
+      return 0;
+    }
+  }
 };
 
 } // end namespace reflection
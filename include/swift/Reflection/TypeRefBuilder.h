@@ -271,6 +271,36 @@ private:
 
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The number of images in ReflectionInfos whose descriptors have been
+  /// added to the indexes below. Images are indexed on the first lookup
+  /// after they are added, so adding an image is cheap and each section is
+  /// walked only once.
+  size_t NumIndexedReflectionInfos = 0;
+
+  /// The field descriptors of all indexed images, keyed by the mangled name
+  /// of their type. If more than one image describes a type, the first one
+  /// added wins.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldTypeInfoIndex;
+
+  /// The associated type descriptors of all indexed images, keyed by the
+  /// mangled name of the conforming type, in the order they were added.
+  std::unordered_map<std::string, std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeIndex;
+
+  /// The builtin type descriptors of all indexed images, keyed by the
+  /// mangled name of their type.
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeInfoIndex;
+
+  /// The capture descriptors of all indexed images, keyed by their remote
+  /// address.
+  std::unordered_map<uintptr_t, const CaptureDescriptor *>
+    CaptureDescriptorIndex;
+
+  /// Adds the descriptors of the images added since the last lookup to the
+  /// indexes.
+  void indexReflectionInfos();
+
   const AssociatedTypeDescriptor *
   lookupAssociatedTypes(const std::string &MangledTypeName,
                         const DependentMemberTypeRef *DependentMember);
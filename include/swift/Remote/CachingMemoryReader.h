@@ -0,0 +1,123 @@
+//===--- CachingMemoryReader.h - Page cache for remote memory ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an implementation of MemoryReader that caches the
+//  pages read through another MemoryReader.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace swift {
+namespace remote {
+
+/// An implementation of MemoryReader which reads whole pages through another
+/// MemoryReader and serves later reads from the same pages from a cache.
+///
+/// Metadata reading makes many small reads of nearby addresses, such as the
+/// kind of a metadata record and then the record itself, each of which is a
+/// round trip to the target when it is in another process. With the cache,
+/// only the first read of each page is.
+///
+/// The cache assumes that the target's memory doesn't change while it is
+/// being inspected, as is the case when the target is suspended. Call
+/// clear() after the target has run.
+class CachingMemoryReader final : public MemoryReader {
+  std::shared_ptr<MemoryReader> Underlying;
+
+  static constexpr uint64_t PageSize = 4096;
+
+  /// The cache is cleared when it grows to this many pages, to bound its
+  /// memory use when a whole heap is being inspected.
+  static constexpr size_t MaxCachedPages = 16384;
+
+  /// The cached pages, keyed by their address. A null page couldn't be read
+  /// as a whole, and reads from it go to the underlying reader.
+  std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  /// Returns the contents of the page at \p pageAddress, or null if it
+  /// couldn't be read.
+  const uint8_t *getPage(uint64_t pageAddress) {
+    auto found = Pages.find(pageAddress);
+    if (found != Pages.end())
+      return found->second.get();
+
+    if (Pages.size() >= MaxCachedPages)
+      Pages.clear();
+
+    std::unique_ptr<uint8_t[]> page(new uint8_t[PageSize]);
+    if (!Underlying->readBytes(RemoteAddress(pageAddress), page.get(),
+                               PageSize))
+      page.reset();
+    return (Pages[pageAddress] = std::move(page)).get();
+  }
+
+public:
+  explicit CachingMemoryReader(std::shared_ptr<MemoryReader> underlying)
+    : Underlying(std::move(underlying)) {}
+
+  /// Forget all of the cached pages.
+  void clear() {
+    Pages.clear();
+  }
+
+  uint8_t getPointerSize() override {
+    return Underlying->getPointerSize();
+  }
+
+  uint8_t getSizeSize() override {
+    return Underlying->getSizeSize();
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return Underlying->getSymbolAddress(name);
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    return Underlying->readString(address, dest);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest, uint64_t size) override {
+    uint64_t start = address.getAddressData();
+    // Reads larger than a page gain nothing from the cache.
+    if (size > PageSize)
+      return Underlying->readBytes(address, dest, size);
+
+    uint64_t offset = 0;
+    while (offset != size) {
+      uint64_t current = start + offset;
+      uint64_t pageAddress = current & ~(PageSize - 1);
+      uint64_t pageOffset = current - pageAddress;
+      uint64_t count = std::min(size - offset, PageSize - pageOffset);
+
+      auto page = getPage(pageAddress);
+      if (!page)
+        return Underlying->readBytes(address, dest, size);
+      std::memcpy(dest + offset, page + pageOffset, (size_t) count);
+      offset += count;
+    }
+    return true;
+  }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
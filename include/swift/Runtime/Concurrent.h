@@ -14,6 +14,7 @@
 #include <iterator>
 #include <atomic>
 #include <stdint.h>
+#include "swift/Runtime/Mutex.h"
 
 #if defined(__FreeBSD__)
 #include <stdio.h>
@@ -313,4 +314,199 @@ public:
   }
 };
 
+/// A concurrent map that is implemented using a resizable open-addressing
+/// hash table. Lookups are wait-free: they never take a lock and never write
+/// to shared memory, so concurrent readers do not contend on any cache line.
+/// Insertions are serialized by a writer lock, which is only taken when a
+/// lookup misses.
+///
+/// Entries are allocated individually and never move, so pointers returned
+/// by find and getOrInsert remain valid for the lifetime of the map. When
+/// the table grows, the old table is kept alive because a concurrent reader
+/// may still be probing it; retired tables are released when the map is
+/// destroyed, and together they are never larger than the current table.
+///
+/// The entry type must provide the following operations:
+///
+///   /// A ternary comparison.  KeyTy is the type of the key provided
+///   /// to find or getOrInsert.  Only equality is significant.
+///   int compareWithKey(KeyTy key) const;
+///
+///   /// Return the hash value of a key.  Keys that compare equal must
+///   /// have equal hash values.
+///   static size_t getKeyHash(KeyTy key);
+///
+///   /// Return the amount of extra trailing space required by an entry,
+///   /// where KeyTy is the type of the first argument to getOrInsert and
+///   /// ArgTys is the type of the remaining arguments.
+///   static size_t getExtraAllocationSize(KeyTy key, ArgTys...)
+template <class EntryTy> class ConcurrentHashMap {
+  struct Node {
+    EntryTy Payload;
+
+    template <class... Args>
+    Node(Args &&... args) : Payload(std::forward<Args>(args)...) {}
+
+    Node(const Node &) = delete;
+    Node &operator=(const Node &) = delete;
+  };
+
+  /// A slot in the table. The hash is written before the node pointer is
+  /// published and never changes afterwards, so a reader that observes a
+  /// non-null node may read the hash without synchronization. Keeping the
+  /// hash in the slot lets probes skip mismatches without touching nodes.
+  struct Slot {
+    size_t Hash;
+    std::atomic<Node*> Ptr;
+  };
+
+  struct Table {
+    /// The number of slots. Always a power of two.
+    size_t Capacity;
+
+    /// The number of occupied slots. Only accessed under the writer lock.
+    size_t Count;
+
+    /// The table this one replaced.
+    Table *Previous;
+
+    Slot *getSlots() { return reinterpret_cast<Slot*>(this + 1); }
+
+    static Table *allocate(size_t capacity, Table *previous) {
+      void *memory = ::operator new(sizeof(Table) + capacity * sizeof(Slot));
+      auto table = ::new (memory) Table{capacity, 0, previous};
+      auto slots = table->getSlots();
+      for (size_t i = 0; i != capacity; ++i) {
+        slots[i].Hash = 0;
+        ::new (&slots[i].Ptr) std::atomic<Node*>(nullptr);
+      }
+      return table;
+    }
+  };
+
+  enum : size_t { InitialCapacity = 16 };
+
+  /// The current table, or null if nothing has been inserted yet.
+  std::atomic<Table*> Current;
+
+  /// Serializes insertions and resizing.
+  swift::Mutex WriterLock;
+
+  /// Probe for a key in the given table. Tables are never more than
+  /// three-quarters full, so the probe sequence always reaches an empty slot.
+  template <class KeyTy>
+  static Node *lookup(Table *table, size_t hash, const KeyTy &key) {
+    size_t mask = table->Capacity - 1;
+    Slot *slots = table->getSlots();
+    for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+      Node *node = slots[i].Ptr.load(std::memory_order_acquire);
+      if (!node)
+        return nullptr;
+      if (slots[i].Hash == hash && node->Payload.compareWithKey(key) == 0)
+        return node;
+    }
+  }
+
+  /// Store a node into the first free slot of its probe sequence. Must be
+  /// called with the writer lock held.
+  static void insertInto(Table *table, size_t hash, Node *node) {
+    size_t mask = table->Capacity - 1;
+    Slot *slots = table->getSlots();
+    size_t i = hash & mask;
+    while (slots[i].Ptr.load(std::memory_order_relaxed))
+      i = (i + 1) & mask;
+    slots[i].Hash = hash;
+    slots[i].Ptr.store(node, std::memory_order_release);
+    table->Count++;
+  }
+
+  /// Replace the current table with one twice as large. Must be called with
+  /// the writer lock held.
+  Table *grow(Table *old) {
+    size_t capacity = old ? old->Capacity * 2 : size_t(InitialCapacity);
+    Table *table = Table::allocate(capacity, old);
+    if (old) {
+      Slot *slots = old->getSlots();
+      for (size_t i = 0; i != old->Capacity; ++i) {
+        if (Node *node = slots[i].Ptr.load(std::memory_order_relaxed))
+          insertInto(table, slots[i].Hash, node);
+      }
+    }
+    Current.store(table, std::memory_order_release);
+    return table;
+  }
+
+public:
+  ConcurrentHashMap() : Current(nullptr) {}
+
+  ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+  ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+  ~ConcurrentHashMap() {
+    // These can be relaxed accesses because there is no safe way for
+    // another thread to race an access to the map with its destruction.
+    Table *table = Current.load(std::memory_order_relaxed);
+    if (!table)
+      return;
+
+    // Every node is present in the current table.
+    Slot *slots = table->getSlots();
+    for (size_t i = 0; i != table->Capacity; ++i)
+      ::delete slots[i].Ptr.load(std::memory_order_relaxed);
+
+    while (table) {
+      Table *previous = table->Previous;
+      ::operator delete(table);
+      table = previous;
+    }
+  }
+
+  /// Search for a value by key \p Key.
+  /// \returns a pointer to the value or null if the value is not in the map.
+  template <class KeyTy>
+  EntryTy *find(const KeyTy &key) {
+    Table *table = Current.load(std::memory_order_acquire);
+    if (!table)
+      return nullptr;
+    Node *node = lookup(table, EntryTy::getKeyHash(key), key);
+    return node ? &node->Payload : nullptr;
+  }
+
+  /// Get or create an entry in the map.
+  ///
+  /// \returns the entry in the map and whether a new node was added (true)
+  ///   or already existed (false)
+  template <class KeyTy, class... ArgTys>
+  std::pair<EntryTy*, bool> getOrInsert(KeyTy key, ArgTys &&... args) {
+    size_t hash = EntryTy::getKeyHash(key);
+
+    // Try the lock-free path first.
+    if (Table *table = Current.load(std::memory_order_acquire)) {
+      if (Node *node = lookup(table, hash, key))
+        return { &node->Payload, false };
+    }
+
+    swift::ScopedLock guard(WriterLock);
+
+    // Check again now that no other thread can insert. We are the only
+    // writer, so a relaxed load observes the latest table.
+    Table *table = Current.load(std::memory_order_relaxed);
+    if (table) {
+      if (Node *node = lookup(table, hash, key))
+        return { &node->Payload, false };
+    }
+
+    // Keep the load factor at or below three-quarters.
+    if (!table || (table->Count + 1) * 4 > table->Capacity * 3)
+      table = grow(table);
+
+    size_t allocSize =
+      sizeof(Node) + EntryTy::getExtraAllocationSize(key, args...);
+    void *memory = ::operator new(allocSize);
+    Node *newNode = ::new (memory) Node(key, std::forward<ArgTys>(args)...);
+    insertInto(table, hash, newNode);
+    return { &newNode->Payload, true };
+  }
+};
+
 #endif // SWIFT_RUNTIME_CONCURRENTUTILS_H
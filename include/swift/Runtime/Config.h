@@ -72,6 +72,21 @@
 #error Masking ISAs are incompatible with opaque ISAs
 #endif
 
+/// Does the current Swift platform support thread-local storage for the
+/// runtime's per-thread lookaside caches?  The caches only hold trivially
+/// constructible data, so native TLS with static initialization suffices.
+#ifndef SWIFT_RUNTIME_HAS_THREAD_LOCAL
+#if defined(__CYGWIN__)
+#define SWIFT_RUNTIME_HAS_THREAD_LOCAL 0
+#else
+#define SWIFT_RUNTIME_HAS_THREAD_LOCAL 1
+#endif
+#endif
+
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+#define SWIFT_THREAD_LOCAL __thread
+#endif
+
 // We try to avoid global constructors in the runtime as much as possible.
 // These macros delimit allowed global ctors.
 #if __clang__
@@ -109,6 +109,30 @@ SWIFT_RUNTIME_EXPORT
 extern "C"
 void swift_reportError(uint32_t flags, const char *message);
 
+/// Print the runtime's call counts, latencies and cache statistics to
+/// stderr. They are only collected when SWIFT_RUNTIME_STATS=1 is set in the
+/// environment, in which case they are also printed when the process exits.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_runtimeStatsDump();
+
+/// Returns the number of calls to the runtime entry point \p entryPoint,
+/// such as "swift_allocObject" or "swift_retain", that the runtime statistics
+/// have counted so far. Returns 0 if the statistics are disabled or
+/// \p entryPoint isn't counted.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+uint64_t swift_runtimeStatsGetCallCount(const char *entryPoint);
+
+/// Write the samples taken by the heap profiler to \p path, or to the path
+/// in SWIFT_HEAP_PROFILE if \p path is null, in the legacy pprof heap
+/// profile format. Type names are written to "<path>.types". Samples are
+/// only taken when SWIFT_HEAP_PROFILE=<path> is set in the environment, in
+/// which case the profile is also written when the process exits.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+bool swift_heapProfileWrite(const char *path);
+
 // namespace swift
 }
 
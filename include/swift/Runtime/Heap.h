@@ -18,5 +18,23 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <stddef.h>
+#include "swift/Runtime/Config.h"
+
+namespace swift {
+
+/// If \p ptr was allocated by swift_slowAlloc from the runtime's
+/// thread-caching allocator, return the usable size of its block.
+/// Otherwise return 0; the block then came from malloc.
+LLVM_LIBRARY_VISIBILITY
+size_t _swift_slowAllocUsableSize(const void *ptr);
+
+/// Print per-size-class statistics of the runtime's thread-caching
+/// allocator to stderr. The allocator is enabled by setting
+/// SWIFT_THREAD_CACHING_ALLOCATOR=1 in the environment.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_dumpAllocatorStatistics();
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
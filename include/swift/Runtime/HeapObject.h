@@ -298,6 +298,12 @@ extern "C" void swift_nonatomic_unpin(HeapObject *object)
 ///   size_t allocSize = object->metadata->destroy(object);
 ///   if (allocSize) swift_deallocObject(object, allocSize);
 ///
+/// If SWIFT_DEFERRED_DEALLOC=1 is set in the environment, objects whose
+/// count reaches zero while another object is being destroyed on the same
+/// thread are queued, and destroyed one after another once it is done,
+/// rather than recursively. This bounds the stack depth of tearing down long
+/// chains of objects.
+///
 /// \param object - may be null, in which case this is a no-op
 ///
 /// POSSIBILITIES: We may end up wanting a bunch of different variants:
@@ -336,6 +342,12 @@ SWIFT_RUNTIME_EXPORT
 extern "C" void (*SWIFT_CC(RegisterPreservingCC)
                      _swift_release_n)(HeapObject *object, uint32_t n);
 
+/// Finishes a release whose decrement was done inline, by a client compiled
+/// with -enable-inline-refcounting, and dropped the strong reference count
+/// of \p object to zero: marks the object as deallocating and destroys it.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_releaseToZero(HeapObject *object);
+
 /// Sets the RC_DEALLOCATING_FLAG flag. This is done non-atomically.
 /// The strong reference count of \p object must be 1 and no other thread may
 /// retain the object during executing this function.
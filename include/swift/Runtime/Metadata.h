@@ -2467,8 +2467,12 @@ template <typename Runtime>
 struct TargetGenericMetadata {
   /// The fill function. Receives a pointer to the instantiated metadata and
   /// the argument pointer passed to swift_getGenericMetadata.
-  TargetMetadata<Runtime> *(*CreateFunction)
-  (TargetGenericMetadata<Runtime> *pattern, const void *arguments);
+  ///
+  /// This is a relative reference, so that the pattern doesn't need to be
+  /// rebased when the image is loaded.
+  TargetRelativeDirectPointer<Runtime,
+    TargetMetadata<Runtime> *(TargetGenericMetadata<Runtime> *pattern,
+                              const void *arguments)> CreateFunction;
   
   /// The size of the template in bytes.
   uint32_t MetadataSize;
@@ -2876,6 +2880,24 @@ swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments)
     SWIFT_CC(RegisterPreservingCC);
 
+/// \brief Register a statically-emitted instantiation of a generic type.
+///
+/// Subsequent calls to swift_getGenericMetadata with the same pattern and
+/// arguments return \p metadata instead of instantiating it from the
+/// template.  If the instantiation already exists, the existing metadata
+/// is kept and \p metadata is ignored.
+///
+/// \param pattern - The generic metadata pattern of the type.
+/// \param arguments - The key generic arguments, as would be passed to
+///   swift_getGenericMetadata.
+/// \param metadata - The fully-initialized metadata for the instantiation.
+///   It must remain valid for the lifetime of the process.
+SWIFT_RUNTIME_EXPORT
+extern "C" void
+swift_registerGenericMetadataPrespecialization(GenericMetadata *pattern,
+                                               const void *arguments,
+                                               const Metadata *metadata);
+
 // Callback to allocate a generic class metadata object.
 SWIFT_RUNTIME_EXPORT
 extern "C" ClassMetadata *
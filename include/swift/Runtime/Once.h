@@ -18,7 +18,7 @@
 #define SWIFT_RUNTIME_ONCE_H
 
 #include "swift/Runtime/HeapObject.h"
-#include <mutex>
+#include <cstdint>
 
 namespace swift {
 
@@ -34,8 +34,10 @@ typedef long swift_once_t;
 typedef uintptr_t swift_once_t;
 #else
 
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
+// On other platforms swift_once_t is a word that is 0 before initialization
+// and ~0 after it, like dispatch_once_t, so that the compiler can check for
+// completed initialization inline.
+typedef uintptr_t swift_once_t;
 
 #endif
 
@@ -185,6 +185,8 @@ class FunctionSignatureSpecializationMangler
     ClosureProp=2,
     BoxToValue=3,
     BoxToStack=4,
+    ExistentialToConcrete=5,
+    ClosurePropField=6,
     First_Option=0, Last_Option=31,
 
     // Option Set Space. 12 bits (i.e. 12 option).
@@ -198,6 +200,10 @@ class FunctionSignatureSpecializationMangler
                             NullablePtr<SILInstruction>>;
   llvm::SmallVector<ArgInfo, 8> Args;
 
+  /// The field of a struct argument a closure is propagated into, for the
+  /// arguments set with setArgumentClosurePropField.
+  llvm::SmallDenseMap<unsigned, unsigned, 2> ClosureFields;
+
   ReturnValueModifierIntBase ReturnValue;
 
 public:
@@ -208,11 +214,15 @@ public:
   void setArgumentConstantProp(unsigned ArgNo, LiteralInst *LI);
   void setArgumentClosureProp(unsigned ArgNo, PartialApplyInst *PAI);
   void setArgumentClosureProp(unsigned ArgNo, ThinToThickFunctionInst *TTTFI);
+  void setArgumentClosurePropField(unsigned ArgNo, unsigned FieldNo,
+                                   SILInstruction *Closure);
   void setArgumentDead(unsigned ArgNo);
   void setArgumentOwnedToGuaranteed(unsigned ArgNo);
   void setArgumentSROA(unsigned ArgNo);
   void setArgumentBoxToValue(unsigned ArgNo);
   void setArgumentBoxToStack(unsigned ArgNo);
+  void setArgumentExistentialToConcrete(unsigned ArgNo,
+                                        SILInstruction *InitExistential);
   void setReturnValueOwnedToUnowned();
 
 private:
@@ -220,6 +230,8 @@ private:
   void mangleConstantProp(LiteralInst *LI);
   void mangleClosureProp(PartialApplyInst *PAI);
   void mangleClosureProp(ThinToThickFunctionInst *TTTFI);
+  void mangleExistentialToConcrete(SILInstruction *InitExistential);
+  void mangleClosurePropField(unsigned FieldNo, SILInstruction *Closure);
   void mangleArgument(ArgumentModifierIntBase ArgMod,
                       NullablePtr<SILInstruction> Inst);
   void mangleReturnValue(ReturnValueModifierIntBase RetMod);
@@ -0,0 +1,75 @@
+//===--- OptimizationRemark.h - Records of SIL optimizations ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the interface that SIL optimizations use to record what
+// they did, and what they could not do, at a given source location. Remarks
+// are written to the file given with -save-optimization-record-path as YAML
+// documents, in the same format as LLVM's optimization records.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SIL_OPTIMIZATIONREMARK_H
+#define SWIFT_SIL_OPTIMIZATIONREMARK_H
+
+#include "swift/Basic/LLVM.h"
+#include "swift/SIL/SILLocation.h"
+#include "llvm/ADT/Twine.h"
+
+namespace swift {
+
+class SILFunction;
+class SILInstruction;
+class SILModule;
+
+namespace OptRemark {
+
+/// Records remarks on behalf of one optimization pass.
+class Emitter {
+  SILModule &Module;
+  StringRef PassName;
+
+  void emit(StringRef Kind, StringRef RemarkName, SILLocation Loc,
+            SILFunction &F, const Twine &Message);
+
+public:
+  /// \p PassName identifies the pass in each remark, and should be the same
+  /// as the pass's DEBUG_TYPE.
+  Emitter(StringRef PassName, SILModule &M) : Module(M), PassName(PassName) {}
+
+  /// Returns true if remarks are being recorded at all.
+  ///
+  /// Callers can check this before doing extra work to describe a remark.
+  bool isEnabled() const;
+
+  /// Records that the optimization was applied at \p Loc in \p F.
+  void emitPassed(StringRef RemarkName, SILLocation Loc, SILFunction &F,
+                  const Twine &Message) {
+    if (isEnabled())
+      emit("Passed", RemarkName, Loc, F, Message);
+  }
+  void emitPassed(StringRef RemarkName, SILInstruction *I,
+                  const Twine &Message);
+
+  /// Records that the optimization could not be applied at \p Loc in \p F.
+  void emitMissed(StringRef RemarkName, SILLocation Loc, SILFunction &F,
+                  const Twine &Message) {
+    if (isEnabled())
+      emit("Missed", RemarkName, Loc, F, Message);
+  }
+  void emitMissed(StringRef RemarkName, SILInstruction *I,
+                  const Twine &Message);
+};
+
+} // end namespace OptRemark
+} // end namespace swift
+
+#endif
@@ -49,6 +49,10 @@ private:
   /// The ordered set of instructions in the SILBasicBlock.
   InstListType InstList;
 
+  /// The number of times this block was executed according to the profile
+  /// given with -profile-use, if known.
+  Optional<uint64_t> ExecutionCount;
+
   friend struct llvm::ilist_sentinel_traits<SILBasicBlock>;
   friend struct llvm::ilist_traits<SILBasicBlock>;
   SILBasicBlock() : Parent(0) {}
@@ -77,6 +81,11 @@ public:
   /// Returns true if this BB is the entry BB of its parent.
   bool isEntry() const;
 
+  /// Returns the profiled execution count of this block, if known.
+  Optional<uint64_t> getExecutionCount() const { return ExecutionCount; }
+
+  void setExecutionCount(uint64_t Count) { ExecutionCount = Count; }
+
   //===--------------------------------------------------------------------===//
   // SILInstruction List Inspection and Manipulation
   //===--------------------------------------------------------------------===//
@@ -165,6 +165,15 @@ private:
   /// The function's effects attribute.
   EffectsKind EffectsKindAttr;
 
+  /// The side effects of the function's body as computed by the module that
+  /// defines it. Unlike EffectsKindAttr, this is not a promise made by the
+  /// user, and only side-effect analysis of declarations consults it.
+  EffectsKind InferredEffectsKind = EffectsKind::Unspecified;
+
+  /// For a declaration read from a serialized module, the number of
+  /// instructions in the body the module provides, or 0 if unknown.
+  unsigned SerializedBodySize = 0;
+
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
   bool Inlined = false;
@@ -497,6 +506,17 @@ public:
     EffectsKindAttr = E;
   }
 
+  /// \return the side effects inferred for this function's body, or
+  /// EffectsKind::Unspecified if nothing is known.
+  EffectsKind getInferredEffectsKind() const { return InferredEffectsKind; }
+  void setInferredEffectsKind(EffectsKind E) { InferredEffectsKind = E; }
+
+  /// \return the number of instructions in the serialized body of this
+  /// function, as recorded by the module it was deserialized from, or 0 if
+  /// this is not known. This is available without reading the body itself.
+  unsigned getSerializedBodySize() const { return SerializedBodySize; }
+  void setSerializedBodySize(unsigned Size) { SerializedBodySize = Size; }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
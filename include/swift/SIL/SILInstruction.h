@@ -923,20 +923,26 @@ public:
 
 /// PartialApplyInst - Represents the creation of a closure object by partial
 /// application of a function value.
+///
+/// If the closure does not outlive the function, its context can be allocated
+/// on the stack, like an alloc_ref [stack]. The end of its lifetime is then
+/// marked with a dealloc_ref [stack].
 class PartialApplyInst
-    : public ApplyInstBase<PartialApplyInst, SILInstruction> {
+    : public ApplyInstBase<PartialApplyInst, SILInstruction>,
+      public StackPromotable {
   friend class SILBuilder;
 
   PartialApplyInst(SILDebugLocation DebugLoc, SILValue Callee,
                    SILType SubstCalleeType,
                    ArrayRef<Substitution> Substitutions,
-                   ArrayRef<SILValue> Args, SILType ClosureType);
+                   ArrayRef<SILValue> Args, SILType ClosureType,
+                   bool canBeOnStack);
 
   static PartialApplyInst *create(SILDebugLocation DebugLoc, SILValue Callee,
                                   SILType SubstCalleeType,
                                   ArrayRef<Substitution> Substitutions,
                                   ArrayRef<SILValue> Args, SILType ClosureType,
-                                  SILFunction &F);
+                                  bool canBeOnStack, SILFunction &F);
 
 public:
   /// Return the ast level function type of this partial apply.
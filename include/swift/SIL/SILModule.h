@@ -102,6 +102,15 @@ private:
   /// Allocator that manages the memory of all the pieces of the SILModule.
   mutable llvm::BumpPtrAllocator BPA;
 
+  /// The number of bytes requested for instructions, which are allocated
+  /// individually rather than in BPA.
+  mutable size_t InstBytesAllocated = 0;
+
+  /// The number of instructions currently allocated, and the most there have
+  /// been at any one time.
+  mutable size_t NumLiveInsts = 0;
+  mutable size_t MaxLiveInsts = 0;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -116,6 +125,11 @@ private:
   llvm::StringMap<SILFunction *> FunctionTable;
   llvm::StringMap<SILFunction *> ZombieFunctionTable;
 
+  /// The mangled names of the declarations this module has looked up or
+  /// created functions for. SILGen refers to the same callee from every call
+  /// site, and mangling it each time is not cheap.
+  llvm::DenseMap<SILDeclRef, StringRef> DeclRefNames;
+
   /// The list of SILFunctions in the module.
   FunctionListType functions;
 
@@ -182,6 +196,14 @@ private:
   /// optimizations can assume that they see the whole module.
   bool wholeModule;
 
+  /// The largest function entry count in the profile given with
+  /// -profile-use, or zero if there is no profile.
+  uint64_t MaxProfileEntryCount = 0;
+
+  /// The stream that optimization remarks are written to, or null if they
+  /// aren't being recorded.
+  std::unique_ptr<llvm::raw_ostream> OptRecordStream;
+
   /// The options passed into this SILModule.
   SILOptions &Options;
 
@@ -410,6 +432,10 @@ public:
   /// \return null if this module has no such function
   SILFunction *lookUpFunction(SILDeclRef fnRef);
 
+  /// Return the mangled name of the given declaration, computing it only the
+  /// first time it is asked for.
+  StringRef getMangledName(SILDeclRef fnRef);
+
   /// Attempt to link the SILFunction. Returns true if linking succeeded, false
   /// otherwise.
   ///
@@ -545,6 +571,24 @@ public:
     Stage = s;
   }
 
+  /// Returns the largest function entry count in the profile that SIL basic
+  /// block execution counts come from, or zero if there is no profile.
+  uint64_t getMaxProfileEntryCount() const { return MaxProfileEntryCount; }
+
+  void setMaxProfileEntryCount(uint64_t Count) { MaxProfileEntryCount = Count; }
+
+  /// Returns the stream that optimization remarks are written to, or null if
+  /// they aren't being recorded.
+  ///
+  /// \sa OptRemark::Emitter
+  llvm::raw_ostream *getOptRecordStream() const {
+    return OptRecordStream.get();
+  }
+
+  void setOptRecordStream(std::unique_ptr<llvm::raw_ostream> Stream) {
+    OptRecordStream = std::move(Stream);
+  }
+
   /// \brief Run the SIL verifier to make sure that all Functions follow
   /// invariants.
   void verify() const;
@@ -593,6 +637,18 @@ public:
   /// Deallocate memory of an instruction.
   void deallocateInst(SILInstruction *I);
 
+  /// Returns the number of bytes allocated by the module's internal
+  /// allocator, not counting instructions.
+  size_t getArenaBytesAllocated() const { return BPA.getBytesAllocated(); }
+
+  /// Returns the number of bytes requested for instructions over the
+  /// lifetime of the module, including instructions since deleted.
+  size_t getInstBytesAllocated() const { return InstBytesAllocated; }
+
+  /// Returns the largest number of instructions that were alive at the same
+  /// time.
+  size_t getMaxLiveInstructions() const { return MaxLiveInsts; }
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
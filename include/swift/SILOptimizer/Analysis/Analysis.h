@@ -87,11 +87,32 @@ namespace swift {
     /// this analysis.
     bool invalidationLock;
 
+    /// The number of times the analysis computed its information for a
+    /// function, and the number of times it threw such information away.
+    /// Reported by the pass manager (see -sil-print-analysis-stats).
+    unsigned NumComputed = 0;
+    unsigned NumInvalidated = 0;
+
+  protected:
+    /// Called by the analysis when it (re)computes its information for a
+    /// function.
+    void recordComputed() { ++NumComputed; }
+
+    /// Called by the analysis when it throws away the information for
+    /// \p Count functions.
+    void recordInvalidated(unsigned Count = 1) { NumInvalidated += Count; }
+
   public:
 
     /// Returns the kind of derived class.
     AnalysisKind getKind() const { return Kind; }
 
+    /// Returns the name of the analysis kind, as spelled in Analysis.def.
+    static const char *getKindName(AnalysisKind Kind);
+
+    unsigned getNumComputed() const { return NumComputed; }
+    unsigned getNumInvalidated() const { return NumInvalidated; }
+
     /// C'tor.
     SILAnalysis(AnalysisKind K) : Kind(K), invalidationLock(false) {}
 
@@ -173,16 +194,21 @@ namespace swift {
       verifyFunction(F);
 
       auto &it = Storage.FindAndConstruct(F);
-      if (!it.second)
+      if (!it.second) {
         it.second = newFunctionAnalysis(F);
+        recordComputed();
+      }
       return it.second;
     }
 
     virtual void invalidate(SILAnalysis::InvalidationKind K) override {
       if (!shouldInvalidate(K)) return;
 
-      for (auto D : Storage)
+      for (auto D : Storage) {
+        if (D.second)
+          recordInvalidated();
         delete D.second;
+      }
 
       Storage.clear();
     }
@@ -193,6 +219,7 @@ namespace swift {
 
       auto &it = Storage.FindAndConstruct(F);
       if (it.second) {
+        recordInvalidated();
         delete it.second;
         it.second = nullptr;
       }
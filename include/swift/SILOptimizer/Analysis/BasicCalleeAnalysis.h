@@ -130,6 +130,8 @@ public:
 
   virtual void invalidate(SILAnalysis::InvalidationKind K) {
     if (K & InvalidationKind::Functions) {
+      if (Cache)
+        recordInvalidated();
       delete Cache;
       Cache = nullptr;
     }
@@ -138,8 +140,10 @@ public:
   virtual void invalidate(SILFunction *F, InvalidationKind K) { invalidate(K); }
 
   CalleeList getCalleeList(FullApplySite FAS) {
-    if (!Cache)
+    if (!Cache) {
       Cache = new CalleeCache(M);
+      recordComputed();
+    }
 
     return Cache->getCalleeList(FAS);
   }
@@ -297,6 +297,8 @@ protected:
 
     while (!WorkList.empty()) {
       FunctionInfo *FInfo = WorkList.pop_back_val();
+      if (FInfo->isValid())
+        recordInvalidated();
       for (const auto &E : FInfo->Callers) {
         if (E.isValid() && E.Caller->isValid())
           WorkList.push_back(E.Caller);
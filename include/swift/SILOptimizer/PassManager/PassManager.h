@@ -16,6 +16,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <vector>
 
@@ -69,6 +70,21 @@ class SILPassManager {
   /// same function.
   bool RestartPipeline = false;
 
+  /// The time in nanoseconds spent in function passes on each function, for
+  /// -sil-function-time-budget.
+  llvm::DenseMap<SILFunction *, uint64_t> FunctionTimeMap;
+
+  /// The time in nanoseconds spent in each pass, summed over all functions.
+  /// It is reported when a compile-time budget is exceeded.
+  llvm::StringMap<uint64_t> PassTimeMap;
+
+  /// The time in nanoseconds spent in all passes, for
+  /// -sil-module-time-budget.
+  uint64_t TotalPassTime = 0;
+
+  /// Set when a function or the module exceeded its compile-time budget.
+  bool BudgetExceeded = false;
+
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
   /// in Analysis.def.
@@ -227,6 +243,16 @@ private:
   /// Return true if all analyses are unlocked.
   bool analysesUnlocked();
 
+  /// Adds \p Delta nanoseconds spent in \p T on \p F (null for a module
+  /// pass) to the compile-time budgets.
+  void chargeTime(SILTransform *T, SILFunction *F, uint64_t Delta);
+
+  /// Return true if \p F used up its -sil-function-time-budget.
+  bool isOverTimeBudget(SILFunction *F);
+
+  /// Prints the time spent in each pass, most expensive first.
+  void printPassTimes(llvm::raw_ostream &OS);
+
   /// Displays the call graph in an external dot-viewer.
   /// This function is meant for use from the debugger.
   /// When asserts are disabled, this is a NoOp.
@@ -0,0 +1,128 @@
+//===--- BlockDataflow.h - Iterative dataflow over basic blocks -*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// This header file declares the worklist used by the iterative, per-block
+/// dataflow problems of the SIL optimizer (e.g. RLE and DSE), so that they
+/// all visit blocks in the order which makes them converge fastest.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_UTILS_BLOCKDATAFLOW_H
+#define SWIFT_SILOPTIMIZER_UTILS_BLOCKDATAFLOW_H
+
+#include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
+#include "llvm/ADT/BitVector.h"
+
+namespace swift {
+
+class SILBasicBlock;
+
+/// The direction in which a dataflow problem propagates its facts.
+enum class DataflowDirection {
+  /// Block entry states are computed from the exit states of predecessors.
+  Forward,
+  /// Block exit states are computed from the entry states of successors.
+  Backward
+};
+
+/// A worklist of the reachable blocks of a function.
+///
+/// Blocks are always removed in reverse post-order for forward problems and
+/// in post-order for backward ones, whatever order they were added in, so
+/// that a block's inputs are up to date before it is processed whenever the
+/// CFG allows it. A LIFO worklist instead follows one path to its end before
+/// coming back, and revisits join points once per incoming path.
+///
+/// Pending blocks are kept in a bit vector indexed by their position in that
+/// order. Adding a pending block again is free, and the next block is found
+/// a word at a time.
+class DataflowBlockWorklist {
+  PostOrderFunctionInfo *PO;
+  DataflowDirection Direction;
+  llvm::BitVector Pending;
+
+  /// No pending block has an index lower than this.
+  unsigned Lowest = 0;
+
+  Optional<unsigned> getIndex(SILBasicBlock *BB) const {
+    if (Direction == DataflowDirection::Forward)
+      return PO->getRPONumber(BB);
+    return PO->getPONumber(BB);
+  }
+
+  SILBasicBlock *getBlock(unsigned Index) const {
+    if (Direction == DataflowDirection::Forward)
+      return *std::next(PO->getReversePostOrder().begin(), Index);
+    return *std::next(PO->getPostOrder().begin(), Index);
+  }
+
+public:
+  /// Creates a worklist which initially contains every reachable block.
+  DataflowBlockWorklist(PostOrderFunctionInfo *PO, DataflowDirection Direction)
+    : PO(PO), Direction(Direction), Pending(PO->size(), /*t*/ true) {}
+
+  bool empty() const { return Pending.none(); }
+
+  /// Removes and returns the first pending block in dataflow order.
+  SILBasicBlock *pop() {
+    assert(!empty() && "Popping an empty worklist");
+    int Index = Lowest == 0 ? Pending.find_first()
+                            : Pending.find_next(Lowest - 1);
+    assert(Index >= 0 && "Lowest is past a pending block");
+    Pending.reset(Index);
+    Lowest = Index + 1;
+    return getBlock(Index);
+  }
+
+  /// Adds \p BB to the worklist if it isn't pending already. Unreachable
+  /// blocks are ignored.
+  void push(SILBasicBlock *BB) {
+    auto Index = getIndex(BB);
+    if (!Index)
+      return;
+    Pending.set(*Index);
+    if (*Index < Lowest)
+      Lowest = *Index;
+  }
+
+  /// Adds the blocks whose state is computed from the state of \p BB: its
+  /// successors for a forward problem, its predecessors for a backward one.
+  void pushDependents(SILBasicBlock *BB) {
+    if (Direction == DataflowDirection::Forward) {
+      for (SILBasicBlock *Succ : BB->getSuccessors())
+        push(Succ);
+    } else {
+      for (SILBasicBlock *Pred : BB->getPreds())
+        push(Pred);
+    }
+  }
+};
+
+/// Solves a dataflow problem over the reachable blocks of a function.
+///
+/// \p Transfer is called on each block until it returns false for every one
+/// of them. It recomputes the block's state from the states it depends on,
+/// and returns true if the state the other blocks depend on changed.
+template <typename TransferFn>
+void solveBlockDataflow(PostOrderFunctionInfo *PO, DataflowDirection Direction,
+                        TransferFn Transfer) {
+  DataflowBlockWorklist Worklist(PO, Direction);
+  while (!Worklist.empty()) {
+    SILBasicBlock *BB = Worklist.pop();
+    if (Transfer(BB))
+      Worklist.pushDependents(BB);
+  }
+}
+
+} // end namespace swift
+
+#endif
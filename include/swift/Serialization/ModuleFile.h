@@ -73,6 +73,10 @@ class ModuleFile : public LazyMemberLoader {
   /// The target the module was built for.
   StringRef TargetTriple;
 
+  /// The hash of everything in the module which its clients depend on, if
+  /// it was recorded.
+  StringRef InterfaceHash;
+
   /// The data blob containing all of the module's identifiers.
   StringRef IdentifierData;
 
@@ -287,6 +291,16 @@ private:
 
   std::unique_ptr<SerializedObjCMethodTable> ObjCMethods;
 
+  class DeclMemberTableInfo;
+  using SerializedDeclMemberTable =
+    llvm::OnDiskIterableChainedHashTable<DeclMemberTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberTable> DeclMembersByName;
+
+  /// The IDs of the nominal types and extensions whose members can be looked
+  /// up in DeclMembersByName.
+  llvm::DenseMap<const Decl *, serialization::DeclID> LazyMemberContextIDs;
+
   llvm::DenseMap<const ValueDecl *, Identifier> PrivateDiscriminatorsByValue;
 
   TinyPtrVector<Decl *> ImportDecls;
@@ -395,6 +409,11 @@ private:
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
   readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk table of members by name stored in
+  /// index_block::DeclListLayout format.
+  std::unique_ptr<SerializedDeclMemberTable>
+  readDeclMemberTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Reads the index block, which contains global tables.
   ///
   /// Returns false if there was an error.
@@ -594,6 +613,10 @@ public:
   /// shadowed clang module.
   void getDisplayDecls(SmallVectorImpl<Decl*> &results);
 
+  /// Returns the hash of everything in the module which its clients depend
+  /// on, or an empty string if the module doesn't have one.
+  StringRef getInterfaceHash() const { return InterfaceHash; }
+
   StringRef getModuleFilename() const {
     // FIXME: This seems fragile, maybe store the filename separately ?
     return ModuleInputBuffer->getBufferIdentifier();
@@ -607,6 +630,10 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(const Decl *D, Identifier N,
+                   uint64_t contextData) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -53,7 +53,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 250; // Last change: Add Throws bit
+const uint16_t VERSION_MINOR = 257; // Last change: interface hash
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -408,7 +408,8 @@ namespace control_block {
   enum {
     METADATA = 1,
     MODULE_NAME,
-    TARGET
+    TARGET,
+    INTERFACE_HASH
   };
 
   using MetadataLayout = BCRecordLayout<
@@ -428,6 +429,15 @@ namespace control_block {
     TARGET,
     BCBlob // LLVM triple
   >;
+
+  /// A hash of everything in the module which its clients depend on, so
+  /// that they don't have to be rebuilt when only the rest changes.
+  ///
+  /// Absent if some part of the module couldn't be hashed.
+  using InterfaceHashLayout = BCRecordLayout<
+    INTERFACE_HASH,
+    BCBlob // hexadecimal MD5
+  >;
 }
 
 /// The record types within the options block (a sub-block of the control
@@ -442,7 +452,8 @@ namespace options_block {
     XCC,
     IS_SIB,
     IS_TESTABLE,
-    RESILIENCE_STRATEGY
+    RESILIENCE_STRATEGY,
+    RESILIENCE_DOMAIN
   };
 
   using SDKPathLayout = BCRecordLayout<
@@ -468,6 +479,11 @@ namespace options_block {
     RESILIENCE_STRATEGY,
     BCFixed<2>
   >;
+
+  using ResilienceDomainLayout = BCRecordLayout<
+    RESILIENCE_DOMAIN,
+    BCBlob // domain name
+  >;
 }
 
 /// The record types within the input block.
@@ -1472,6 +1488,13 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// A map from (nominal or extension decl ID, member base name) to the
+    /// members with that name, so that a lookup into an imported type only
+    /// needs to deserialize the members it finds.
+    ///
+    /// This uses index_block::DeclListLayout.
+    DECL_MEMBER_NAMES,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -15,6 +15,8 @@
 
 #include "swift/AST/Module.h"
 #include "swift/AST/ModuleLoader.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace swift {
@@ -29,8 +31,34 @@ private:
   using LoadedModulePair = std::pair<std::unique_ptr<ModuleFile>, unsigned>;
   std::vector<LoadedModulePair> LoadedModuleFiles;
 
+  /// A module file that has been read and validated on its own, but not yet
+  /// associated with an AST module.
+  struct PrefetchedModule;
+
+  /// Module files read ahead of time by #prefetchModules, keyed by module
+  /// name. Entries are removed when the module is actually loaded.
+  llvm::StringMap<std::unique_ptr<PrefetchedModule>> PrefetchedModules;
+
+  /// The entries of the search paths named in the search path listing, if
+  /// there is one.
+  ///
+  /// This is only filled in on construction, so it can be read from any
+  /// thread.
+  llvm::StringMap<llvm::StringSet<>> SearchPathListing;
+
   explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker);
 
+  /// Finds and reads the module file for \p moduleName without touching the
+  /// AST, so that it's safe to call from any thread.
+  ///
+  /// Returns null if the module can't be found or read; loading it again
+  /// through #loadModule will produce the right diagnostics.
+  std::unique_ptr<PrefetchedModule> prefetchModule(StringRef moduleName) const;
+
+  /// Brings a module file that has already been read into the AST.
+  FileUnit *loadAST(Module &M, Optional<SourceLoc> diagLoc,
+                    PrefetchedModule &moduleFile);
+
 public:
   /// \brief Create a new importer that can load serialized Swift modules
   /// into the given ASTContext.
@@ -61,6 +89,13 @@ public:
   loadModule(SourceLoc importLoc,
              ArrayRef<std::pair<Identifier, SourceLoc>> path) override;
 
+  /// \brief Reads and validates the module files for \p names, and for all of
+  /// the modules they depend on, in parallel.
+  ///
+  /// Returns once every module file has been read. Nothing is added to the
+  /// AST until the module is loaded with #loadModule.
+  virtual void prefetchModules(ArrayRef<Identifier> names) override;
+
   /// Attempt to load a serialized AST into the given module.
   ///
   /// If the AST cannot be loaded and \p diagLoc is present, a diagnostic is
@@ -112,6 +147,9 @@ class SerializedASTFile final : public LoadedFile {
 public:
   bool isSIB() const { return IsSIB; }
 
+  /// \see ModuleFile::getInterfaceHash
+  StringRef getInterfaceHash() const;
+
   virtual bool isSystemModule() const override;
 
   virtual void lookupValue(Module::AccessPathTy accessPath,
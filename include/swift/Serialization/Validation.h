@@ -71,6 +71,7 @@ struct ValidationInfo {
   StringRef name = {};
   StringRef targetTriple = {};
   StringRef shortVersion = {};
+  StringRef interfaceHash = {};
   size_t bytes = 0;
   Status status = Status::Malformed;
 };
@@ -85,6 +86,7 @@ struct ValidationInfo {
 class ExtendedValidationInfo {
   SmallVector<StringRef, 4> ExtraClangImporterOpts;
   StringRef SDKPath;
+  StringRef ResilienceDomain;
   struct {
     unsigned IsSIB : 1;
     unsigned IsTestable : 1;
@@ -120,6 +122,10 @@ public:
   void setResilienceStrategy(ResilienceStrategy resilience) {
     Bits.ResilienceStrategy = unsigned(resilience);
   }
+  StringRef getResilienceDomain() const { return ResilienceDomain; }
+  void setResilienceDomain(StringRef domain) {
+    ResilienceDomain = domain;
+  }
 };
 
 /// Returns info about the serialized AST in the given data.
@@ -153,7 +153,11 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// If set, dumps the time taken to check each expression to
+    /// llvm::errs(), slowest first.
+    DebugTimeExpressions = 1 << 3
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -164,10 +168,14 @@ namespace swift {
   ///
   /// \param WarnLongFunctionBodies If non-zero, warn when a function body takes
   /// longer than this many milliseconds to type-check
+  ///
+  /// \param WarnLongExpressionTypeChecking If non-zero, warn when an
+  /// expression takes longer than this many milliseconds to type-check
   void performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                            OptionSet<TypeCheckingFlags> Options,
                            unsigned StartElem = 0,
-                           unsigned WarnLongFunctionBodies = 0);
+                           unsigned WarnLongFunctionBodies = 0,
+                           unsigned WarnLongExpressionTypeChecking = 0);
 
   /// Once type checking is complete, this walks protocol requirements
   /// to resolve default witnesses.
@@ -30,7 +30,7 @@
 
 /// Minor version changes when new APIs are added in ABI- and source-compatible
 /// way.
-#define SWIFT_REFLECTION_VERSION_MINOR 0
+#define SWIFT_REFLECTION_VERSION_MINOR 1
 
 #ifdef __cplusplus
 extern "C" {
@@ -160,6 +160,21 @@ int swift_reflection_projectExistential(SwiftReflectionContextRef ContextRef,
                                         swift_typeref_t *OutInstanceTypeRef,
                                         addr_t *OutStartOfInstanceData);
 
+/// Takes a census of the Swift heap objects in the given blocks of the
+/// target's memory, such as the blocks of its malloc zones.
+///
+/// A block is counted as a heap object if its first word is the isa pointer
+/// of a Swift class, or of a closure context or box whose metadata is
+/// described by the reflection info that has been added. The callback is
+/// invoked once for each type found, with the number of objects of the type
+/// and the total size of their blocks, in no particular order.
+void
+swift_reflection_takeHeapCensus(SwiftReflectionContextRef ContextRef,
+                                const swift_heap_block_t *Blocks,
+                                size_t NumBlocks,
+                                swift_census_callback_t Callback,
+                                void *CallbackContext);
+
 /// Dump a brief description of the typeref as a tree to stderr.
 void swift_reflection_dumpTypeRef(swift_typeref_t OpaqueTypeRef);
 
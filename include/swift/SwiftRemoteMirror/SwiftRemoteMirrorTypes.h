@@ -103,6 +103,28 @@ typedef struct swift_childinfo {
   swift_typeref_t TR;
 } swift_childinfo_t;
 
+/// A block of the target's memory, such as a block allocated by malloc,
+/// which may hold a heap object.
+typedef struct swift_heap_block {
+  addr_t Address;
+  uint64_t Size;
+} swift_heap_block_t;
+
+/// The heap objects of one type found by a heap census.
+typedef struct swift_census_entry {
+  /// The address of the objects' metadata in the target.
+  uintptr_t Metadata;
+
+  /// The number of objects.
+  uint64_t Count;
+
+  /// The total size of the blocks holding the objects.
+  uint64_t Bytes;
+} swift_census_entry_t;
+
+typedef void (*swift_census_callback_t)(void *CallbackContext,
+                                        swift_census_entry_t Entry);
+
 /// \brief An opaque pointer to a context which maintains state and
 /// caching of reflection structure for heap instances.
 typedef struct SwiftReflectionContext *SwiftReflectionContextRef;
@@ -32,6 +32,7 @@
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/StringExtras.h"
 #include "swift/Parse/Lexer.h" // bad dependency
 #include "clang/AST/Attr.h"
@@ -1392,8 +1393,14 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   // Check whether we already have an archetype builder for this
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
-  if (known != Impl.ArchetypeBuilders.end())
+  if (known != Impl.ArchetypeBuilders.end()) {
+    if (Stats)
+      ++Stats->getFrontendCounters().NumArchetypeBuilderCacheHits;
     return known->second.get();
+  }
+
+  if (Stats)
+    ++Stats->getFrontendCounters().NumArchetypeBuilderCacheMisses;
 
   // Create a new archetype builder with the given signature.
   auto builder = new ArchetypeBuilder(*mod, Diags);
@@ -1436,6 +1443,18 @@ ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   return nullptr;
 }
 
+void ASTContext::prefetchModules(ArrayRef<Identifier> ModuleNames) {
+  SmallVector<Identifier, 8> NotYetLoaded;
+  for (Identifier Name : ModuleNames)
+    if (!LoadedModules.count(Name))
+      NotYetLoaded.push_back(Name);
+  if (NotYetLoaded.empty())
+    return;
+
+  for (auto &loader : Impl.ModuleLoaders)
+    loader->prefetchModules(NotYetLoaded);
+}
+
 Module *ASTContext::getModuleByName(StringRef ModuleName) {
   SmallVector<std::pair<Identifier, SourceLoc>, 4>
   AccessPath;
@@ -1693,6 +1712,10 @@ size_t ASTContext::getSolverMemory() const {
   return Size;
 }
 
+size_t ASTContext::getPermanentBytesAllocated() const {
+  return Impl.Allocator.getBytesAllocated();
+}
+
 size_t ASTContext::Implementation::Arena::getTotalMemory() const {
   return sizeof(*this) +
     // TupleTypes ?
@@ -1509,6 +1509,7 @@ ValueDecl *swift::getBuiltinValueDecl(ASTContext &Context, Identifier Id) {
     return getSizeOrAlignOfOperation(Context, Id);
 
   case BuiltinValueKind::IsPOD:
+  case BuiltinValueKind::IsBitwiseTakable:
     return getIsPODOperation(Context, Id);
 
   case BuiltinValueKind::IsOptionalType:
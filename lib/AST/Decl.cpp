@@ -1246,7 +1246,8 @@ bool AbstractStorageDecl::hasFixedLayout(ModuleDecl *M,
   case ResilienceExpansion::Minimal:
     return hasFixedLayout();
   case ResilienceExpansion::Maximal:
-    return hasFixedLayout() || M == getModuleContext();
+    return hasFixedLayout() ||
+           M->isInSameResilienceDomain(getModuleContext());
   }
   llvm_unreachable("bad resilience expansion");
 }
@@ -1849,7 +1850,8 @@ bool NominalTypeDecl::hasFixedLayout(ModuleDecl *M,
   case ResilienceExpansion::Minimal:
     return hasFixedLayout();
   case ResilienceExpansion::Maximal:
-    return hasFixedLayout() || M == getModuleContext();
+    return hasFixedLayout() ||
+           M->isInSameResilienceDomain(getModuleContext());
   }
   llvm_unreachable("bad resilience expansion");
 }
@@ -1872,11 +1874,12 @@ bool NominalTypeDecl::derivesProtocolConformance(ProtocolDecl *protocol) const {
     case KnownProtocolKind::RawRepresentable:
       return enumDecl->hasRawType();
     
-    // Enums without associated values can implicitly derive Equatable and
-    // Hashable conformance.
+    // Enums can derive Equatable and Hashable conformance: implicitly if they
+    // have no associated values, and explicitly if all of the associated
+    // values conform.
     case KnownProtocolKind::Equatable:
     case KnownProtocolKind::Hashable:
-      return enumDecl->hasOnlyCasesWithoutAssociatedValues();
+      return true;
     
     // @objc enums can explicitly derive their _BridgedNSError conformance.
     case KnownProtocolKind::BridgedNSError:
@@ -1886,6 +1889,13 @@ bool NominalTypeDecl::derivesProtocolConformance(ProtocolDecl *protocol) const {
       return false;
     }
   }
+
+  // Structs can explicitly derive Equatable and Hashable conformance if all
+  // of their stored properties conform.
+  if (isa<StructDecl>(this)) {
+    return *knownProtocol == KnownProtocolKind::Equatable ||
+           *knownProtocol == KnownProtocolKind::Hashable;
+  }
   return false;
 }
 
@@ -482,6 +482,10 @@ ResilienceExpansion DeclContext::getResilienceExpansion() const {
       if (auto attr = func->getAttrs().getAttribute<InlineAttr>())
         if (attr->getKind() == InlineKind::Always)
           return ResilienceExpansion::Minimal;
+
+      // So are the bodies of @_inlineable functions.
+      if (func->getAttrs().hasAttribute<InlineableAttr>())
+        return ResilienceExpansion::Minimal;
     }
   }
 
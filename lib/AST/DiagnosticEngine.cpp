@@ -22,6 +22,7 @@
 #include "swift/AST/Pattern.h"
 #include "swift/AST/PrintOptions.h"
 #include "swift/AST/TypeRepr.h"
+#include "swift/AST/Types.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/Lexer.h" // bad dependency
 #include "swift/Config.h"
@@ -562,11 +563,99 @@ void DiagnosticEngine::emitTentativeDiagnostics() {
   TentativeDiagnostics.clear();
 }
 
+/// Append the bytes of \p value to \p key.
+template <typename T>
+static void appendToKey(std::string &key, const T &value) {
+  key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/// Append \p str to \p key, prefixed with its length.
+static void appendStringToKey(std::string &key, StringRef str) {
+  appendToKey(key, str.size());
+  key.append(str.begin(), str.end());
+}
+
+bool DiagnosticEngine::isDuplicateDiagnostic(const Diagnostic &diagnostic) {
+  // The key identifies the arguments by their identity rather than their
+  // text, so that no argument has to be printed to build it. Two diagnostics
+  // with the same key therefore always have the same text.
+  std::string key;
+  appendToKey(key, diagnostic.getID());
+  appendToKey(key, diagnostic.getLoc().getOpaquePointerValue());
+  appendToKey(key, diagnostic.getDecl());
+
+  for (auto &arg : diagnostic.getArgs()) {
+    appendToKey(key, arg.getKind());
+    switch (arg.getKind()) {
+    case DiagnosticArgumentKind::String:
+      appendStringToKey(key, arg.getAsString());
+      break;
+    case DiagnosticArgumentKind::Integer:
+      appendToKey(key, arg.getAsInteger());
+      break;
+    case DiagnosticArgumentKind::Unsigned:
+      appendToKey(key, arg.getAsUnsigned());
+      break;
+    case DiagnosticArgumentKind::Identifier:
+      appendToKey(key, arg.getAsIdentifier().getOpaqueValue());
+      break;
+    case DiagnosticArgumentKind::ObjCSelector:
+      appendToKey(key, arg.getAsObjCSelector().getOpaqueValue());
+      break;
+    case DiagnosticArgumentKind::Type: {
+      // Types containing type variables are freed along with their constraint
+      // system, and their storage may be reused for a different type.
+      Type type = arg.getAsType();
+      if (type && type->hasTypeVariable())
+        return false;
+      appendToKey(key, type.getPointer());
+      break;
+    }
+    case DiagnosticArgumentKind::TypeRepr:
+      appendToKey(key, arg.getAsTypeRepr());
+      break;
+    case DiagnosticArgumentKind::PatternKind:
+      appendToKey(key, arg.getAsPatternKind());
+      break;
+    case DiagnosticArgumentKind::StaticSpellingKind:
+      appendToKey(key, arg.getAsStaticSpellingKind());
+      break;
+    case DiagnosticArgumentKind::DescriptiveDeclKind:
+      appendToKey(key, arg.getAsDescriptiveDeclKind());
+      break;
+    case DiagnosticArgumentKind::DeclAttribute:
+      appendToKey(key, arg.getAsDeclAttribute());
+      break;
+    case DiagnosticArgumentKind::VersionTuple:
+      appendStringToKey(key, arg.getAsVersionTuple().getAsString());
+      break;
+    }
+  }
+
+  for (auto &fixIt : diagnostic.getFixIts()) {
+    appendToKey(key, fixIt.getRange().getStart().getOpaquePointerValue());
+    appendToKey(key, fixIt.getRange().getByteLength());
+    appendStringToKey(key, fixIt.getText());
+  }
+
+  return !EmittedDiagnostics.insert(key).second;
+}
+
 void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   auto behavior = state.determineBehavior(diagnostic.getID());
   if (behavior == DiagnosticState::Behavior::Ignore)
     return;
 
+  // Drop repeated diagnostics, e.g. from type-checking an expression again
+  // after a failure, along with their notes. Notes are only meaningful next to
+  // the diagnostic they are attached to, so they are never dropped on their
+  // own.
+  if (behavior != DiagnosticState::Behavior::Note &&
+      isDuplicateDiagnostic(diagnostic)) {
+    state.ignoreFollowingNotes();
+    return;
+  }
+
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
   if (loc.isInvalid() && diagnostic.getDecl()) {
@@ -18,6 +18,7 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/Module.h"
 #include "swift/AST/Types.h"
+#include "swift/Basic/Statistic.h"
 using namespace swift;
 
 GenericSignature::GenericSignature(ArrayRef<GenericTypeParamType *> params,
@@ -189,6 +190,22 @@ static int compareDependentTypes(const CanType *pa, const CanType *pb) {
   return 0;
 }
 
+/// Determine whether the given canonical signature places no constraints on
+/// any of its generic parameters.
+static bool isUnconstrainedSignature(CanGenericSignature sig) {
+  auto params = sig->getGenericParams();
+  auto reqts = sig->getRequirements();
+  if (params.size() != reqts.size())
+    return false;
+
+  for (unsigned i = 0, n = params.size(); i != n; ++i) {
+    if (reqts[i].getKind() != RequirementKind::WitnessMarker ||
+        !reqts[i].getFirstType()->isEqual(params[i]))
+      return false;
+  }
+  return true;
+}
+
 CanGenericSignature
 GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   // Start from the elementwise-canonical signature.
@@ -200,7 +217,22 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   if (cached != Context.ManglingSignatures.end()) {
     return cached->second;
   }
-  
+
+  // If every generic parameter is unconstrained, the canonical signature is
+  // already minimal: it consists of one witness marker per parameter, in
+  // parameter order, which is exactly what the archetype builder would
+  // produce. Skip building one.
+  if (isUnconstrainedSignature(canonical)) {
+    if (Context.Stats)
+      ++Context.Stats->getFrontendCounters()
+          .NumUnconstrainedManglingSignatures;
+    Context.ManglingSignatures.insert({{canonical, &M}, canonical});
+    return canonical;
+  }
+
+  if (Context.Stats)
+    ++Context.Stats->getFrontendCounters().NumManglingSignaturesComputed;
+
   // Otherwise, we need to compute it.
   // Dump the generic signature into an ArchetypeBuilder that will figure out
   // the minimal set of requirements.
@@ -1627,6 +1627,19 @@ void SourceFile::setTypeRefinementContext(TypeRefinementContext *Root) {
   TRC = Root;
 }
 
+void SourceFile::endDeclInterfaceHash(ArrayRef<const Decl *> decls) {
+  assert(!PendingDeclInterfaceHashes.empty() && "no declaration being hashed");
+  llvm::MD5 state = PendingDeclInterfaceHashes.pop_back_val();
+  llvm::MD5::MD5Result result;
+  state.final(result);
+  SmallString<32> str;
+  llvm::MD5::stringifyResult(result, str);
+
+  // Nested declarations finish first and keep their own, narrower hash.
+  for (const Decl *D : decls)
+    DeclInterfaceHashes.insert({D, str.str()});
+}
+
 //===----------------------------------------------------------------------===//
 // Miscellaneous
 //===----------------------------------------------------------------------===//
@@ -707,6 +707,10 @@ class swift::MemberLookupTable {
   /// results.
   ExtensionDecl *LastExtensionIncluded = nullptr;
 
+  /// The last extension of a run from the first extension whose members have
+  /// all been loaded, so that lookups don't have to visit them again.
+  ExtensionDecl *LastExtensionLoaded = nullptr;
+
   /// The type of the internal lookup table.
   typedef llvm::DenseMap<DeclName, llvm::TinyPtrVector<ValueDecl *>>
     LookupTable;
@@ -736,6 +740,23 @@ public:
                            ExtensionDecl *ext,
                            DeclRange members);
 
+  /// Whether the members of the given extension have been added to the
+  /// lookup table.
+  bool hasIncludedExtension(ExtensionDecl *ext) const;
+
+  /// Returns the first extension of \p nominal whose members may still need
+  /// to be loaded before a lookup.
+  ExtensionDecl *getFirstExtensionToLoad(NominalTypeDecl *nominal) const {
+    return LastExtensionLoaded ? LastExtensionLoaded->NextExtension.getPointer()
+                               : nominal->FirstExtension;
+  }
+
+  /// Note that every member of \p ext, and of every extension before it, has
+  /// been loaded.
+  void noteExtensionLoaded(ExtensionDecl *ext) {
+    LastExtensionLoaded = ext;
+  }
+
   /// Iterator into the lookup table.
   typedef LookupTable::iterator iterator;
 
@@ -829,21 +850,29 @@ void MemberLookupTable::addMembers(DeclRange members) {
   }
 }
 
-void MemberLookupTable::addExtensionMembers(NominalTypeDecl *nominal,
-                                            ExtensionDecl *ext,
-                                            DeclRange members) {
-  // We have not processed any extensions yet, so there's nothing to do.
+bool MemberLookupTable::hasIncludedExtension(ExtensionDecl *ext) const {
+  // We have not processed any extensions yet.
   if (!LastExtensionIncluded)
-    return;
+    return false;
 
-  // If this extension shows up in the list of extensions not yet included
-  // in the lookup table, there's nothing to do.
+  // Check whether this extension shows up in the list of extensions not yet
+  // included in the lookup table.
   for (auto notIncluded = LastExtensionIncluded->NextExtension.getPointer();
        notIncluded;
        notIncluded = notIncluded->NextExtension.getPointer()) {
     if (notIncluded == ext)
-      return;
+      return false;
   }
+  return true;
+}
+
+void MemberLookupTable::addExtensionMembers(NominalTypeDecl *nominal,
+                                            ExtensionDecl *ext,
+                                            DeclRange members) {
+  // If this extension hasn't been included in the lookup table, its members
+  // will be added when it is.
+  if (!hasIncludedExtension(ext))
+    return;
 
   // Add the new members to the lookup table.
   addMembers(members);
@@ -861,7 +890,8 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
                      : nominal->FirstExtension;
        next;
        (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
-    addMembers(next->getMembers());
+    // Members that haven't been loaded yet are added as they're loaded.
+    addMembers(next->getCurrentMembersWithoutLoading());
   }
 }
 
@@ -879,13 +909,11 @@ void NominalTypeDecl::addedMember(Decl *member) {
 void ExtensionDecl::addedMember(Decl *member) {
   if (NextExtension.getInt()) {
     auto nominal = getExtendedType()->getAnyNominal();
-    if (nominal->LookupTable.getPointer()) {
-      // Make sure we have the complete list of extensions.
-      // FIXME: This is completely unnecessary. We want to determine whether
-      // our own extension has already been included in the lookup table.
-      (void)nominal->getExtensions();
-
-      nominal->LookupTable.getPointer()->addMember(member);
+    if (auto table = nominal->LookupTable.getPointer()) {
+      // If this extension hasn't been included in the lookup table yet, the
+      // member will be added along with the rest of the extension.
+      if (table->hasIncludedExtension(this))
+        table->addMember(member);
     }
   }
 }
@@ -903,8 +931,9 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
     // Note that we'll have walked the members now.
     LookupTable.setInt(true);
 
-    // Add the members of the nominal declaration to the table.
-    LookupTable.getPointer()->addMembers(getMembers());
+    // Add the members of the nominal declaration to the table. Members that
+    // haven't been loaded yet are added as they're loaded.
+    LookupTable.getPointer()->addMembers(getCurrentMembersWithoutLoading());
   }
 
   if (!ignoreNewExtensions) {
@@ -924,16 +953,51 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
+  bool useNamedLazyMemberLoading =
+    getASTContext().LangOpts.NamedLazyMemberLoading;
+
   // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
+  // extensions), or at least all of the members named \p name.
+  SmallVector<ValueDecl *, 4> namedMembers;
+  auto loadMembers = [&](const IterableDeclContext *IDC, const Decl *D) {
+    if (useNamedLazyMemberLoading && IDC->isLazy()) {
+      if (auto found = IDC->getLoader()->loadNamedMembers(
+                         D, name.getBaseName(), IDC->getLoaderContextData())) {
+        namedMembers.append(found->begin(), found->end());
+        return;
+      }
+    }
+    (void)IDC->getMembers();
+  };
+
+  if (!LookupTable.getPointer()) {
+    auto &ctx = getASTContext();
+    LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
+  }
+
   if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
+    // Extensions at the front of the list whose members have all been
+    // loaded by earlier lookups don't need to be visited again; in a module
+    // with many extensions of a type, this keeps each lookup from walking
+    // all of them.
+    auto table = LookupTable.getPointer();
+    (void)getExtensions();
+    bool allLoaded = true;
+    for (auto E = table->getFirstExtensionToLoad(this); E;
+         E = E->NextExtension.getPointer()) {
+      loadMembers(E, E);
+      if (allLoaded && !E->isLazy())
+        table->noteExtensionLoaded(E);
+      else
+        allLoaded = false;
+    }
   }
 
-  (void)getMembers();
+  loadMembers(this, this);
 
   prepareLookupTable(ignoreNewExtensions);
+  for (auto member : namedMembers)
+    LookupTable.getPointer()->addMember(member);
 
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
@@ -29,7 +29,29 @@ static inline StringRef getUSRSpacePrefix() {
   return "s:";
 }
 
+static bool printDeclUSRUncached(const ValueDecl *D, raw_ostream &OS);
+
 bool ide::printDeclUSR(const ValueDecl *D, raw_ostream &OS) {
+  // Indexing and the IDE ask for the USR of the same declaration for every
+  // reference to it, and mangling is not cheap, so remember the result.
+  auto &Ctx = D->getASTContext();
+  auto known = Ctx.DeclUSRs.find(D);
+  if (known != Ctx.DeclUSRs.end()) {
+    OS << known->second;
+    return false;
+  }
+
+  llvm::SmallString<64> Buf;
+  llvm::raw_svector_ostream BufOS(Buf);
+  if (printDeclUSRUncached(D, BufOS))
+    return true;
+
+  Ctx.DeclUSRs[D] = Ctx.AllocateCopy(BufOS.str());
+  OS << BufOS.str();
+  return false;
+}
+
+static bool printDeclUSRUncached(const ValueDecl *D, raw_ostream &OS) {
   using namespace Mangle;
 
   if (!isa<FuncDecl>(D) && !D->hasName())
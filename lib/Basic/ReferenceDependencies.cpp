@@ -0,0 +1,279 @@
+//===--- ReferenceDependencies.cpp - Swift dependencies file format -------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ReferenceDependencies.h"
+#include "swift/Basic/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/YAMLParser.h"
+#include <vector>
+
+using namespace swift;
+using namespace swift::reference_dependencies;
+
+StringRef reference_dependencies::getSectionName(Section section) {
+  switch (section) {
+  case Section::ProvidesTopLevel: return "provides-top-level";
+  case Section::ProvidesNominal: return "provides-nominal";
+  case Section::ProvidesMember: return "provides-member";
+  case Section::ProvidesDynamicLookup: return "provides-dynamic-lookup";
+  case Section::DependsTopLevel: return "depends-top-level";
+  case Section::DependsMember: return "depends-member";
+  case Section::DependsNominal: return "depends-nominal";
+  case Section::DependsDynamicLookup: return "depends-dynamic-lookup";
+  case Section::DependsExternal: return "depends-external";
+  case Section::FingerprintsTopLevel: return "fingerprints-top-level";
+  case Section::FingerprintsNominal: return "fingerprints-nominal";
+  case Section::FingerprintsMember: return "fingerprints-member";
+  case Section::InterfaceHash: return "interface-hash";
+  }
+  llvm_unreachable("unhandled section");
+}
+
+Optional<Section> reference_dependencies::getSectionForName(StringRef name) {
+  return llvm::StringSwitch<Optional<Section>>(name)
+    .Case("provides-top-level", Section::ProvidesTopLevel)
+    .Case("provides-nominal", Section::ProvidesNominal)
+    .Case("provides-member", Section::ProvidesMember)
+    .Case("provides-dynamic-lookup", Section::ProvidesDynamicLookup)
+    .Case("depends-top-level", Section::DependsTopLevel)
+    .Case("depends-member", Section::DependsMember)
+    .Case("depends-nominal", Section::DependsNominal)
+    .Case("depends-dynamic-lookup", Section::DependsDynamicLookup)
+    .Case("depends-external", Section::DependsExternal)
+    .Case("fingerprints-top-level", Section::FingerprintsTopLevel)
+    .Case("fingerprints-nominal", Section::FingerprintsNominal)
+    .Case("fingerprints-member", Section::FingerprintsMember)
+    .Case("interface-hash", Section::InterfaceHash)
+    .Default(None);
+}
+
+unsigned reference_dependencies::getNumNamesPerEntry(Section section) {
+  switch (section) {
+  case Section::ProvidesMember:
+  case Section::DependsMember:
+  case Section::FingerprintsTopLevel:
+  case Section::FingerprintsNominal:
+    return 2;
+  case Section::FingerprintsMember:
+    return 3;
+  case Section::ProvidesTopLevel:
+  case Section::ProvidesNominal:
+  case Section::ProvidesDynamicLookup:
+  case Section::DependsTopLevel:
+  case Section::DependsNominal:
+  case Section::DependsDynamicLookup:
+  case Section::DependsExternal:
+  case Section::InterfaceHash:
+    return 1;
+  }
+  llvm_unreachable("unhandled section");
+}
+
+bool reference_dependencies::isBinaryFile(StringRef contents) {
+  return contents.startswith(StringRef(binary::Magic,
+                                       sizeof(binary::Magic)));
+}
+
+bool reference_dependencies::readBinaryFile(
+    StringRef contents,
+    llvm::function_ref<bool(Section, ArrayRef<StringRef>, bool)> callback) {
+  using namespace llvm::support;
+
+  if (contents.size() < binary::HeaderSize || !isBinaryFile(contents))
+    return true;
+
+  const char *start = contents.data();
+  const char *cursor = start + sizeof(binary::Magic);
+  if (endian::read32le(cursor) != binary::Version)
+    return true;
+  uint32_t numStrings = endian::read32le(cursor + 4);
+  uint32_t numRecords = endian::read32le(cursor + 8);
+
+  // Check the sizes up front so that nothing below reads past the end.
+  uint64_t stringTableOffset = binary::HeaderSize;
+  uint64_t recordsOffset =
+      stringTableOffset + uint64_t(numStrings) * binary::StringEntrySize;
+  uint64_t dataOffset =
+      recordsOffset + uint64_t(numRecords) * binary::RecordSize;
+  if (dataOffset > contents.size())
+    return true;
+  StringRef data = contents.substr(dataOffset);
+
+  auto getString = [&](uint32_t index, StringRef &result) -> bool {
+    if (index >= numStrings)
+      return true;
+    const char *entry = start + stringTableOffset +
+                        uint64_t(index) * binary::StringEntrySize;
+    uint32_t offset = endian::read32le(entry);
+    uint32_t length = endian::read32le(entry + 4);
+    if (uint64_t(offset) + length > data.size())
+      return true;
+    result = data.substr(offset, length);
+    return false;
+  };
+
+  for (uint32_t i = 0; i < numRecords; ++i) {
+    const char *record =
+        start + recordsOffset + uint64_t(i) * binary::RecordSize;
+    uint8_t rawSection = record[0];
+    uint8_t flags = record[1];
+    uint16_t numNames = endian::read16le(record + 2);
+
+    if (rawSection >= NumSections)
+      return true;
+    auto section = Section(rawSection);
+    if (numNames != getNumNamesPerEntry(section))
+      return true;
+
+    StringRef names[binary::MaxNamesPerRecord];
+    for (unsigned j = 0; j < numNames; ++j)
+      if (getString(endian::read32le(record + 4 + 4 * j), names[j]))
+        return true;
+
+    bool isCascading = !(flags & binary::IsPrivate);
+    if (callback(section, llvm::makeArrayRef(names, numNames), isCascading))
+      return true;
+  }
+
+  return false;
+}
+
+Writer::~Writer() = default;
+
+namespace {
+class YAMLWriter : public Writer {
+  raw_ostream &out;
+
+public:
+  explicit YAMLWriter(raw_ostream &out) : out(out) {
+    out << "### Swift dependencies file v0 ###\n";
+  }
+
+  void beginSection(Section section) override {
+    assert(section != Section::InterfaceHash && "use addInterfaceHash");
+    out << getSectionName(section) << ":\n";
+  }
+
+  void addEntry(ArrayRef<StringRef> names, bool isCascading) override {
+    assert(!names.empty());
+    out << "- ";
+    if (!isCascading)
+      out << "!private ";
+
+    if (names.size() == 1) {
+      out << "\"" << llvm::yaml::escape(names.front()) << "\"\n";
+      return;
+    }
+
+    out << "[";
+    swift::interleave(names, [this](StringRef name) {
+      out << "\"" << llvm::yaml::escape(name) << "\"";
+    }, [this] { out << ", "; });
+    out << "]\n";
+  }
+
+  void addInterfaceHash(StringRef hash) override {
+    out << getSectionName(Section::InterfaceHash) << ": \"" << hash << "\"\n";
+  }
+};
+
+class BinaryWriter : public Writer {
+  raw_ostream &out;
+
+  struct Record {
+    Section section;
+    bool isCascading;
+    SmallVector<uint32_t, binary::MaxNamesPerRecord> names;
+  };
+
+  Section currentSection = Section::ProvidesTopLevel;
+  std::vector<Record> records;
+
+  /// Maps each interned string to its index.
+  llvm::StringMap<uint32_t> stringIndices;
+  /// The interned strings, in order of first use.
+  std::vector<StringRef> strings;
+
+  uint32_t intern(StringRef name) {
+    auto insertResult = stringIndices.insert({name, strings.size()});
+    if (insertResult.second)
+      strings.push_back(insertResult.first->getKey());
+    return insertResult.first->getValue();
+  }
+
+  void addRecord(Section section, ArrayRef<StringRef> names,
+                 bool isCascading) {
+    assert(names.size() == getNumNamesPerEntry(section));
+    records.push_back({section, isCascading, {}});
+    for (StringRef name : names)
+      records.back().names.push_back(intern(name));
+  }
+
+public:
+  explicit BinaryWriter(raw_ostream &out) : out(out) {}
+
+  void beginSection(Section section) override {
+    assert(section != Section::InterfaceHash && "use addInterfaceHash");
+    currentSection = section;
+  }
+
+  void addEntry(ArrayRef<StringRef> names, bool isCascading) override {
+    addRecord(currentSection, names, isCascading);
+  }
+
+  void addInterfaceHash(StringRef hash) override {
+    addRecord(Section::InterfaceHash, hash, /*isCascading=*/true);
+  }
+
+  void finish() override {
+    using namespace llvm::support;
+    endian::Writer<little> LE(out);
+
+    out.write(binary::Magic, sizeof(binary::Magic));
+    LE.write<uint32_t>(binary::Version);
+    LE.write<uint32_t>(strings.size());
+    LE.write<uint32_t>(records.size());
+
+    uint32_t offset = 0;
+    for (StringRef str : strings) {
+      LE.write<uint32_t>(offset);
+      LE.write<uint32_t>(str.size());
+      offset += str.size();
+    }
+
+    for (const Record &record : records) {
+      LE.write<uint8_t>(static_cast<uint8_t>(record.section));
+      LE.write<uint8_t>(record.isCascading ? 0 : binary::IsPrivate);
+      LE.write<uint16_t>(record.names.size());
+      for (unsigned i = 0; i < binary::MaxNamesPerRecord; ++i)
+        LE.write<uint32_t>(i < record.names.size() ? record.names[i] : 0);
+    }
+
+    for (StringRef str : strings)
+      out << str;
+  }
+};
+} // end anonymous namespace
+
+std::unique_ptr<Writer> Writer::createYAML(raw_ostream &out) {
+  return std::unique_ptr<Writer>(new YAMLWriter(out));
+}
+
+std::unique_ptr<Writer> Writer::createBinary(raw_ostream &out) {
+  return std::unique_ptr<Writer>(new BinaryWriter(out));
+}
@@ -147,7 +147,7 @@ namespace {
         }
       }
       for (const auto &child : *node) {
-        hash(child.get());
+        hash(child);
       }
     }
   };
@@ -181,7 +181,7 @@ static bool deepEquals(Node *lhs, Node *rhs) {
 
   for (auto li = lhs->begin(), ri = lhs->begin(), le = lhs->end();
        li != le; ++li, ++ri) {
-    if (!deepEquals(li->get(), ri->get()))
+    if (!deepEquals(*li, *ri))
       return false;
   }
 
@@ -276,16 +276,16 @@ namespace {
     void mangleChildNodes(Node *node) { mangleNodes(node->begin(), node->end()); }
     void mangleNodes(Node::iterator i, Node::iterator e) {
       for (; i != e; ++i) {
-        mangle(i->get());
+        mangle(*i);
       }
     }
     void mangleSingleChildNode(Node *node) {
       assert(node->getNumChildren() == 1);
-      mangle(node->begin()->get());
+      mangle(*node->begin());
     }
     void mangleChildNode(Node *node, unsigned index) {
       assert(index < node->getNumChildren());
-      mangle(node->begin()[index].get());
+      mangle(node->begin()[index]);
     }
 
     void mangleSimpleEntity(Node *node, char basicKind, StringRef entityKind,
@@ -333,7 +333,7 @@ void Remangler::resetSubstitutions() {
 
 bool Remangler::trySubstitution(Node *node, SubstitutionEntry &entry) {
   auto isInSwiftModule = [](Node *node) -> bool {
-    auto context = node->begin()->get();
+    auto context = *node->begin();
     return (context->getKind() == Node::Kind::Module &&
             context->getText() == STDLIB_NAME);
   };
@@ -504,12 +504,12 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
   switch (kind) {
   case FunctionSigSpecializationParamKind::ConstantPropFunction:
     Out << "cpfr";
-    mangleIdentifier(node->getChild(1).get());
+    mangleIdentifier(node->getChild(1));
     Out << '_';
     return;
   case FunctionSigSpecializationParamKind::ConstantPropGlobal:
     Out << "cpg";
-    mangleIdentifier(node->getChild(1).get());
+    mangleIdentifier(node->getChild(1));
     Out << '_';
     return;
   case FunctionSigSpecializationParamKind::ConstantPropInteger:
@@ -528,15 +528,23 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
     else
       unreachable("Unknown encoding");
     Out << 'v';
-    mangleIdentifier(node->getChild(2).get());
+    mangleIdentifier(node->getChild(2));
     Out << '_';
     return;
   }
   case FunctionSigSpecializationParamKind::ClosureProp:
     Out << "cl";
-    mangleIdentifier(node->getChild(1).get());
+    mangleIdentifier(node->getChild(1));
     for (unsigned i = 2, e = node->getNumChildren(); i != e; ++i) {
-      mangleType(node->getChild(i).get());
+      mangleType(node->getChild(i));
+    }
+    Out << '_';
+    return;
+  case FunctionSigSpecializationParamKind::ClosurePropField:
+    Out << "cf" << node->getChild(1)->getText() << '_';
+    mangleIdentifier(node->getChild(2));
+    for (unsigned i = 3, e = node->getNumChildren(); i != e; ++i) {
+      mangleType(node->getChild(i));
     }
     Out << '_';
     return;
@@ -546,6 +554,11 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
   case FunctionSigSpecializationParamKind::BoxToStack:
     Out << "k_";
     return;
+  case FunctionSigSpecializationParamKind::ExistentialToConcrete:
+    Out << 'e';
+    mangleType(node->getChild(1));
+    Out << '_';
+    return;
   default:
     if (kindValue &
         unsigned(FunctionSigSpecializationParamKind::Dead))
@@ -576,7 +589,7 @@ void Remangler::mangleProtocolConformance(Node *node) {
   // type, protocol name, context
   assert(node->getNumChildren() == 3);
   mangleChildNode(node, 0);
-  mangleProtocolWithoutPrefix(node->begin()[1].get());
+  mangleProtocolWithoutPrefix(node->begin()[1]);
   mangleChildNode(node, 2);
 }
 
@@ -637,7 +650,7 @@ void Remangler::mangleFullTypeMetadata(Node *node) {
 
 void Remangler::mangleProtocolDescriptor(Node *node) {
   Out << "Mp";
-  mangleProtocolWithoutPrefix(node->begin()[0].get());
+  mangleProtocolWithoutPrefix(node->begin()[0]);
 }
 
 void Remangler::manglePartialApplyForwarder(Node *node) {
@@ -752,7 +765,7 @@ void Remangler::mangleAssociatedTypeWitnessTableAccessor(Node *node) {
   assert(node->getNumChildren() == 3);
   mangleChildNode(node, 0); // protocol conformance
   mangleChildNode(node, 1); // identifier
-  mangleProtocolWithoutPrefix(node->begin()[2].get()); // type
+  mangleProtocolWithoutPrefix(node->begin()[2]); // type
 }
 
 void Remangler::mangleReabstractionThunkHelper(Node *node) {
@@ -885,7 +898,7 @@ void Remangler::mangleImplicitClosure(Node *node, EntityContext &ctx) {
 
 void Remangler::mangleStatic(Node *node, EntityContext &ctx) {
   Out << 'Z';
-  mangleEntityContext(node->getChild(0).get(), ctx);
+  mangleEntityContext(node->getChild(0), ctx);
 }
 
 void Remangler::mangleSimpleEntity(Node *node, char basicKind,
@@ -893,7 +906,7 @@ void Remangler::mangleSimpleEntity(Node *node, char basicKind,
                                    EntityContext &ctx) {
   assert(node->getNumChildren() == 1);
   Out << basicKind;
-  mangleEntityContext(node->begin()[0].get(), ctx);
+  mangleEntityContext(node->begin()[0], ctx);
   Out << entityKind;
 }
 
@@ -902,7 +915,7 @@ void Remangler::mangleNamedEntity(Node *node, char basicKind,
                                   EntityContext &ctx) {
   assert(node->getNumChildren() == 2);
   if (basicKind != '\0') Out << basicKind;
-  mangleEntityContext(node->begin()[0].get(), ctx);
+  mangleEntityContext(node->begin()[0], ctx);
   Out << entityKind;
   mangleChildNode(node, 1); // decl name / index
 }
@@ -912,9 +925,9 @@ void Remangler::mangleTypedEntity(Node *node, char basicKind,
                                   EntityContext &ctx) {
   assert(node->getNumChildren() == 2);
   Out << basicKind;
-  mangleEntityContext(node->begin()[0].get(), ctx);
+  mangleEntityContext(node->begin()[0], ctx);
   Out << entityKind;
-  mangleEntityType(node->begin()[1].get(), ctx);
+  mangleEntityType(node->begin()[1], ctx);
 }
 
 void Remangler::mangleNamedAndTypedEntity(Node *node, char basicKind,
@@ -922,10 +935,10 @@ void Remangler::mangleNamedAndTypedEntity(Node *node, char basicKind,
                                           EntityContext &ctx) {
   assert(node->getNumChildren() == 3);
   Out << basicKind;
-  mangleEntityContext(node->begin()[0].get(), ctx);
+  mangleEntityContext(node->begin()[0], ctx);
   Out << entityKind;
   mangleChildNode(node, 1); // decl name / index
-  mangleEntityType(node->begin()[2].get(), ctx);
+  mangleEntityType(node->begin()[2], ctx);
 }
 
 void Remangler::mangleEntityContext(Node *node, EntityContext &ctx) {
@@ -951,7 +964,7 @@ void Remangler::mangleEntityContext(Node *node, EntityContext &ctx) {
 void Remangler::mangleEntityType(Node *node, EntityContext &ctx) {
   assert(node->getKind() == Node::Kind::Type);
   assert(node->getNumChildren() == 1);
-  node = node->begin()[0].get();
+  node = node->begin()[0];
 
   // Expand certain kinds of type within the entity context.
   switch (node->getKind()) {
@@ -964,11 +977,11 @@ void Remangler::mangleEntityType(Node *node, EntityContext &ctx) {
     unsigned inputIndex = node->getNumChildren() - 2;
     assert(inputIndex <= 1);
     for (unsigned i = 0; i <= inputIndex; ++i)
-      mangle(node->begin()[i].get());
-    auto returnType = node->begin()[inputIndex+1].get();
+      mangle(node->begin()[i]);
+    auto returnType = node->begin()[inputIndex+1];
     assert(returnType->getKind() == Node::Kind::ReturnType);
     assert(returnType->getNumChildren() == 1);
-    mangleEntityType(returnType->begin()[0].get(), ctx);
+    mangleEntityType(returnType->begin()[0], ctx);
     return;
   }
   default:
@@ -1091,8 +1104,8 @@ void Remangler::mangleReturnType(Node *node) {
 void Remangler::mangleImplFunctionType(Node *node) {
   Out << "XF";
   auto i = node->begin(), e = node->end();
-  if (i != e && i->get()->getKind() == Node::Kind::ImplConvention) {
-    StringRef text = (i++)->get()->getText();
+  if (i != e && (*i)->getKind() == Node::Kind::ImplConvention) {
+    StringRef text = (*i++)->getText();
     if (text == "@callee_unowned") {
       Out << 'd';
     } else if (text == "@callee_guaranteed") {
@@ -1106,16 +1119,16 @@ void Remangler::mangleImplFunctionType(Node *node) {
     Out << 't';
   }
   for (; i != e &&
-         i->get()->getKind() == Node::Kind::ImplFunctionAttribute; ++i) {
-    mangle(i->get()); // impl function attribute
+         (*i)->getKind() == Node::Kind::ImplFunctionAttribute; ++i) {
+    mangle(*i); // impl function attribute
   }
   EntityContext ctx(*this);
-  if (i != e && i->get()->getKind() == Node::Kind::Generics) {
-    mangleGenerics((i++)->get(), ctx);
+  if (i != e && (*i)->getKind() == Node::Kind::Generics) {
+    mangleGenerics(*i++, ctx);
   }
   Out << '_';
-  for (; i != e && i->get()->getKind() == Node::Kind::ImplParameter; ++i) {
-    mangleImplParameter(i->get());
+  for (; i != e && (*i)->getKind() == Node::Kind::ImplParameter; ++i) {
+    mangleImplParameter(*i);
   }
   Out << '_';
   mangleNodes(i, e); // impl results
@@ -1241,10 +1254,10 @@ void Remangler::mangleProtocolList(Node *node) {
 void Remangler::mangleProtocolListWithoutPrefix(Node *node) {
   assert(node->getKind() == Node::Kind::ProtocolList);
   assert(node->getNumChildren() == 1);
-  auto typeList = node->begin()[0].get();
+  auto typeList = node->begin()[0];
   assert(typeList->getKind() == Node::Kind::TypeList);
   for (auto &child : *typeList) {
-    mangleProtocolWithoutPrefix(child.get());
+    mangleProtocolWithoutPrefix(child);
   }
   Out << '_';
 }
@@ -1305,8 +1318,8 @@ void Remangler::mangleEntityGenericType(Node *node, EntityContext &ctx) {
   Out << 'U';
   assert(node->getNumChildren() == 2);
 
-  mangleGenerics(node->begin()[0].get(), ctx);
-  mangleEntityType(node->begin()[1].get(), ctx);
+  mangleGenerics(node->begin()[0], ctx);
+  mangleEntityType(node->begin()[1], ctx);
 }
 
 void Remangler::mangleDependentGenericSignature(Node *node) {
@@ -1325,8 +1338,8 @@ void Remangler::mangleDependentGenericSignature(Node *node) {
   
   // Remangle generic params.
   for (; i != e &&
-         i->get()->getKind() == Node::Kind::DependentGenericParamCount; ++i) {
-    auto count = i->get();
+         (*i)->getKind() == Node::Kind::DependentGenericParamCount; ++i) {
+    auto count = *i;
     if (count->getIndex() > 0)
       mangleIndex(count->getIndex() - 1);
     else
@@ -1349,30 +1362,30 @@ void Remangler::mangleDependentGenericParamCount(Node *node) {
 }
 
 void Remangler::mangleDependentGenericConformanceRequirement(Node *node) {
-  mangleConstrainedType(node->getChild(0).get());
+  mangleConstrainedType(node->getChild(0));
   // If the constraint represents a protocol, use the shorter mangling.
   if (node->getNumChildren() == 2
       && node->getChild(1)->getKind() == Node::Kind::Type
       && node->getChild(1)->getNumChildren() == 1
       && node->getChild(1)->getChild(0)->getKind() == Node::Kind::Protocol) {
-    mangleProtocolWithoutPrefix(node->getChild(1)->getChild(0).get());
+    mangleProtocolWithoutPrefix(node->getChild(1)->getChild(0));
     return;
   }
 
-  mangle(node->getChild(1).get());
+  mangle(node->getChild(1));
 }
 
 void Remangler::mangleDependentGenericSameTypeRequirement(Node *node) {
-  mangleConstrainedType(node->getChild(0).get());
+  mangleConstrainedType(node->getChild(0));
   Out << 'z';
-  mangle(node->getChild(1).get());
+  mangle(node->getChild(1));
 }
 
 void Remangler::mangleConstrainedType(Node *node) {
   if (node->getFirstChild()->getKind()
         == Node::Kind::DependentGenericParamType) {
     // Can be mangled without an introducer.
-    mangleDependentGenericParamIndex(node->getFirstChild().get());
+    mangleDependentGenericParamIndex(node->getFirstChild());
   } else {
     mangle(node);
   }
@@ -1389,9 +1402,9 @@ void Remangler::mangleGenerics(Node *node, EntityContext &ctx) {
 
   auto i = node->begin(), e = node->end();
   unsigned index = 0;
-  for (; i != e && i->get()->getKind() == Node::Kind::Archetype; ++i) {
-    auto child = i->get();
-    Archetypes[child->getText()] = ArchetypeInfo{index++, absoluteDepth};
+  for (; i != e && (*i)->getKind() == Node::Kind::Archetype; ++i) {
+    auto child = *i;
+    Archetypes[child->getText().str()] = ArchetypeInfo{index++, absoluteDepth};
     mangle(child); // archetype
   }
   if (i != e) {
@@ -1406,7 +1419,7 @@ void Remangler::mangleGenerics(Node *node, EntityContext &ctx) {
 void Remangler::mangleArchetype(Node *node) {
   if (node->hasChildren()) {
     assert(node->getNumChildren() == 1);
-    mangleProtocolListWithoutPrefix(node->begin()->get());
+    mangleProtocolListWithoutPrefix(*node->begin());
   } else {
     Out << '_';
   }
@@ -1415,7 +1428,7 @@ void Remangler::mangleArchetype(Node *node) {
 void Remangler::mangleAssociatedType(Node *node) {
   if (node->hasChildren()) {
     assert(node->getNumChildren() == 1);
-    mangleProtocolListWithoutPrefix(node->begin()->get());
+    mangleProtocolListWithoutPrefix(*node->begin());
   } else {
     Out << '_';
   }
@@ -1426,7 +1439,7 @@ void Remangler::mangleSelfTypeRef(Node *node) {
   if (trySubstitution(node, entry)) return;
   Out << "QP";
   assert(node->getNumChildren() == 1);
-  mangleProtocolWithoutPrefix(node->begin()[0].get());
+  mangleProtocolWithoutPrefix(node->begin()[0]);
   addSubstitution(entry);
 }
 
@@ -1458,11 +1471,11 @@ void Remangler::mangleExtension(Node *node, EntityContext &ctx) {
   } else {
     Out << 'E';
   }
-  mangleEntityContext(node->begin()[0].get(), ctx); // module
+  mangleEntityContext(node->begin()[0], ctx); // module
   if (node->getNumChildren() == 3) {
-    mangleDependentGenericSignature(node->begin()[2].get()); // generic sig
+    mangleDependentGenericSignature(node->begin()[2]); // generic sig
   }
-  mangleEntityContext(node->begin()[1].get(), ctx); // context
+  mangleEntityContext(node->begin()[1], ctx); // context
 }
 
 void Remangler::mangleModule(Node *node, EntityContext &ctx) {
@@ -1488,7 +1501,7 @@ void Remangler::mangleDependentMemberType(Node *node) {
   Node *base = node;
   do {
     members.push_back(base);
-    base = base->getFirstChild()->getFirstChild().get();
+    base = base->getFirstChild()->getFirstChild();
   } while (base->getKind() == Node::Kind::DependentMemberType);
 
   assert(base->getKind() == Node::Kind::DependentGenericParamType
@@ -1498,13 +1511,13 @@ void Remangler::mangleDependentMemberType(Node *node) {
   if (members.size() == 1) {
     Out << 'w';
     mangleDependentGenericParamIndex(base);
-    mangle(members[0]->getChild(1).get());
+    mangle(members[0]->getChild(1));
   } else {
     Out << 'W';
     mangleDependentGenericParamIndex(base);
 
     for (auto *member : reversed(members)) {
-      mangle(member->getChild(1).get());
+      mangle(member->getChild(1));
     }
     Out << '_';
   }
@@ -1516,7 +1529,7 @@ void Remangler::mangleDependentAssociatedTypeRef(Node *node) {
 
   if (node->getNumChildren() > 0) {
     Out << 'P';
-    mangleProtocolWithoutPrefix(node->getFirstChild().get());
+    mangleProtocolWithoutPrefix(node->getFirstChild());
   }
   mangleIdentifier(node);
 
@@ -1564,7 +1577,7 @@ void Remangler::mangleProtocol(Node *node, EntityContext &ctx) {
 void Remangler::mangleProtocolWithoutPrefix(Node *node) {
   if (node->getKind() == Node::Kind::Type) {
     assert(node->getNumChildren() == 1);
-    node = node->begin()[0].get();
+    node = node->begin()[0];
   }
 
   assert(node->getKind() == Node::Kind::Protocol);
@@ -1616,6 +1629,6 @@ std::string Demangle::mangleNode(const NodePointer &node) {
   if (!node) return "";
 
   DemanglerPrinter printer;
-  Remangler(printer).mangle(node.get());
+  Remangler(printer).mangle(node);
   return std::move(printer).str();
 }
@@ -15,6 +15,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace swift;
 
@@ -43,8 +44,17 @@ unsigned
 SourceManager::addNewSourceBuffer(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
   assert(Buffer);
   StringRef BufIdentifier = Buffer->getBufferIdentifier();
+  StringRef Text = Buffer->getBuffer();
   auto ID = LLVMSourceMgr.AddNewSourceBuffer(std::move(Buffer), llvm::SMLoc());
   BufIdentIDMap[BufIdentifier] = ID;
+
+  assert(LineStartOffsets.size() == ID - 1 && "buffer IDs are not sequential");
+  LineStartOffsets.emplace_back();
+  auto &LineStarts = LineStartOffsets.back();
+  LineStarts.push_back(0);
+  for (size_t Newline = Text.find('\n'); Newline != StringRef::npos;
+       Newline = Text.find('\n', Newline + 1))
+    LineStarts.push_back(Newline + 1);
   return ID;
 }
 
@@ -82,7 +92,6 @@ bool SourceManager::openVirtualFile(SourceLoc loc, StringRef name,
 
   CharSourceRange range = CharSourceRange(*this, loc, end);
   VirtualFiles[end.Value.getPointer()] = { range, name, lineOffset };
-  CachedVFile = {};
   return true;
 }
 
@@ -99,7 +108,6 @@ void SourceManager::closeVirtualFile(SourceLoc end) {
 #endif
     return;
   }
-  CachedVFile = {};
 
   CharSourceRange oldRange = virtualFile->Range;
   virtualFile->Range = CharSourceRange(*this, virtualFile->Range.getStart(),
@@ -113,21 +121,40 @@ void SourceManager::closeVirtualFile(SourceLoc end) {
 
 const SourceManager::VirtualFile *
 SourceManager::getVirtualFile(SourceLoc Loc) const {
-  const char *p = Loc.Value.getPointer();
-
-  if (CachedVFile.first == p)
-    return CachedVFile.second;
+  if (VirtualFiles.empty())
+    return nullptr;
 
   // Returns the first element that is >p.
-  auto VFileIt = VirtualFiles.upper_bound(p);
-  if (VFileIt != VirtualFiles.end() && VFileIt->second.Range.contains(Loc)) {
-    CachedVFile = { p, &VFileIt->second };
-    return CachedVFile.second;
-  }
+  auto VFileIt = VirtualFiles.upper_bound(Loc.Value.getPointer());
+  if (VFileIt != VirtualFiles.end() && VFileIt->second.Range.contains(Loc))
+    return &VFileIt->second;
 
   return nullptr;
 }
 
+std::pair<unsigned, unsigned>
+SourceManager::getRealLineAndColumn(SourceLoc Loc, unsigned BufferID) const {
+  if (BufferID == 0)
+    BufferID = findBufferContainingLoc(Loc);
+  unsigned Offset = getLocOffsetInBuffer(Loc, BufferID);
+
+  auto &LineStarts = LineStartOffsets[BufferID - 1];
+  auto NextLine = std::upper_bound(LineStarts.begin(), LineStarts.end(),
+                                   Offset);
+  unsigned Line = NextLine - LineStarts.begin();
+  unsigned LineStart = NextLine[-1];
+
+  // Like llvm::SourceMgr, only count '\n' as a line break, but start columns
+  // over after a '\r' as well.
+  StringRef LinePrefix(
+      LLVMSourceMgr.getMemoryBuffer(BufferID)->getBufferStart() + LineStart,
+      Offset - LineStart);
+  size_t CR = LinePrefix.rfind('\r');
+  unsigned Column = CR == StringRef::npos ? LinePrefix.size() + 1
+                                          : LinePrefix.size() - CR;
+  return { Line, Column };
+}
+
 
 Optional<unsigned> SourceManager::getIDForBufferIdentifier(
     StringRef BufIdentifier) {
@@ -287,29 +314,13 @@ llvm::Optional<unsigned> SourceManager::resolveFromLineCol(unsigned BufferId,
   if (Line == 0 || Col == 0) {
     return None;
   }
-  auto InputBuf = getLLVMSourceMgr().getMemoryBuffer(BufferId);
-  const char *Ptr = InputBuf->getBufferStart();
-  const char *End = InputBuf->getBufferEnd();
-  const char *LineStart = Ptr;
-  for (; Ptr < End; ++Ptr) {
-    if (*Ptr == '\n') {
-      --Line;
-      if (Line == 0)
-        break;
-      LineStart = Ptr+1;
-    }
-  }
-  if (Line != 0) {
+  // Only lines ending with a newline can be resolved, and the column may point
+  // at most at the newline.
+  auto &LineStarts = LineStartOffsets[BufferId - 1];
+  if (Line >= LineStarts.size())
     return None;
-  }
-  Ptr = LineStart;
-  for (; Ptr < End; ++Ptr) {
-    --Col;
-    if (Col == 0)
-      return Ptr - InputBuf->getBufferStart();
-    if (*Ptr == '\n')
-      break;
-  }
-  return None;
+  if (Col - 1 >= LineStarts[Line] - LineStarts[Line - 1])
+    return None;
+  return LineStarts[Line - 1] + Col - 1;
 }
 
@@ -0,0 +1,124 @@
+//===--- Statistic.cpp - Per-job compile statistics -----------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Statistic.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+
+/// Replaces characters that would be awkward in a file name.
+static void appendFilenameComponent(SmallVectorImpl<char> &result,
+                                    StringRef component) {
+  result.push_back('-');
+  for (char c : component) {
+    if (llvm::sys::path::is_separator(c) || c == ' ' || c == '%')
+      result.push_back('_');
+    else
+      result.push_back(c);
+  }
+}
+
+static void writeJSONString(llvm::raw_ostream &os, StringRef str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      os << '\\';
+    os << c;
+  }
+  os << '"';
+}
+
+UnifiedStatsReporter::UnifiedStatsReporter(StringRef programName,
+                                           StringRef moduleName,
+                                           StringRef inputName,
+                                           StringRef targetTriple,
+                                           StringRef outputType,
+                                           StringRef directory)
+  : StartTime(llvm::TimeRecord::getCurrentTime(/*Start=*/true)) {
+  SmallString<128> name("stats");
+  appendFilenameComponent(name, programName);
+  appendFilenameComponent(name, moduleName);
+  appendFilenameComponent(name, llvm::sys::path::filename(inputName));
+  appendFilenameComponent(name, targetTriple);
+  appendFilenameComponent(name, outputType);
+  name += "-%%%%%%%%.json";
+
+  Filename = directory;
+  llvm::sys::path::append(Filename, name.str());
+}
+
+UnifiedStatsReporter::~UnifiedStatsReporter() {
+  llvm::TimeRecord totalTime =
+      llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  totalTime -= StartTime;
+  recordTime("Frontend", totalTime);
+
+  // Every job gets its own file, so that jobs running in parallel never
+  // write to the same one.
+  int FD;
+  SmallString<128> path;
+  std::error_code EC = llvm::sys::fs::create_directories(
+                         llvm::sys::path::parent_path(Filename));
+  if (!EC)
+    EC = llvm::sys::fs::createUniqueFile(Filename, FD, path);
+  if (EC) {
+    llvm::errs() << "error: couldn't open stats file '" << Filename << "': "
+                 << EC.message() << "\n";
+    return;
+  }
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+
+  OS << "{\n";
+  bool first = true;
+  auto writeKey = [&](StringRef group, StringRef name, StringRef suffix) {
+    OS << (first ? "  " : ",\n  ");
+    first = false;
+    SmallString<64> key(group);
+    key += '.';
+    key += name;
+    key += suffix;
+    writeJSONString(OS, key);
+    OS << ": ";
+  };
+
+#define FRONTEND_STATISTIC(GROUP, NAME) \
+  writeKey(#GROUP, #NAME, ""); \
+  OS << Counters.NAME;
+#include "swift/Basic/Statistics.def"
+
+  std::lock_guard<std::mutex> lock(TimesMutex);
+  for (auto &entry : Counts) {
+    writeKey("count.swift", entry.getKey(), "");
+    OS << entry.second;
+  }
+  for (auto &entry : Times) {
+    writeKey("time.swift", entry.getKey(), ".wall");
+    OS << llvm::format("%.6f", entry.second.getWallTime());
+    writeKey("time.swift", entry.getKey(), ".cpu");
+    OS << llvm::format("%.6f", entry.second.getProcessTime());
+  }
+  OS << "\n}\n";
+}
+
+void UnifiedStatsReporter::recordTime(StringRef name,
+                                      const llvm::TimeRecord &elapsed) {
+  std::lock_guard<std::mutex> lock(TimesMutex);
+  Times[name] += elapsed;
+}
+
+void UnifiedStatsReporter::recordCount(StringRef name, size_t count) {
+  std::lock_guard<std::mutex> lock(TimesMutex);
+  Counts[name] += count;
+}
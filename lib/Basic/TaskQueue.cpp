@@ -29,11 +29,23 @@ using namespace swift::sys;
 #include "Default/TaskQueue.inc"
 #endif
 
-TaskQueue::TaskQueue(unsigned NumberOfParallelTasks)
-  : NumberOfParallelTasks(NumberOfParallelTasks) {}
+TaskQueue::TaskQueue(unsigned NumberOfParallelTasks, uint64_t MemoryLimit)
+  : NumberOfParallelTasks(NumberOfParallelTasks), MemoryLimit(MemoryLimit) {}
 
 TaskQueue::~TaskQueue() = default;
 
+void TaskQueue::notePeakMemory(StringRef MemoryClass, uint64_t PeakMemory) {
+  if (MemoryClass.empty() || PeakMemory == 0)
+    return;
+
+  // The first measurement replaces the estimate from an earlier execution.
+  uint64_t &Peak = PeakMemoryUsage[MemoryClass];
+  if (MeasuredMemoryClasses.insert(MemoryClass).second)
+    Peak = PeakMemory;
+  else
+    Peak = std::max(Peak, PeakMemory);
+}
+
 // DummyTaskQueue implementation
 
 DummyTaskQueue::DummyTaskQueue(unsigned NumberOfParallelTasks)
@@ -42,9 +54,11 @@ DummyTaskQueue::DummyTaskQueue(unsigned NumberOfParallelTasks)
 DummyTaskQueue::~DummyTaskQueue() = default;
 
 void DummyTaskQueue::addTask(const char *ExecPath, ArrayRef<const char *> Args,
-                             ArrayRef<const char *> Env, void *Context) {
-  QueuedTasks.emplace(
-    std::unique_ptr<DummyTask>(new DummyTask(ExecPath, Args, Env, Context)));
+                             ArrayRef<const char *> Env, void *Context,
+                             unsigned Priority, StringRef MemoryClass) {
+  QueuedTasks.push(
+    std::unique_ptr<DummyTask>(new DummyTask(ExecPath, Args, Env, Context)),
+    Priority);
 }
 
 bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
@@ -65,8 +79,7 @@ bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
     // at the parallel limit, and no earlier subtasks have failed.
     while (!SubtaskFailed && !QueuedTasks.empty() &&
            ExecutingTasks.size() < MaxNumberOfParallelTasks) {
-      std::unique_ptr<DummyTask> T(QueuedTasks.front().release());
-      QueuedTasks.pop();
+      std::unique_ptr<DummyTask> T = QueuedTasks.pop();
 
       if (Began)
         Began(++Pid, T->Context);
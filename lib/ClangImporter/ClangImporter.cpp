@@ -29,6 +29,7 @@
 #include "swift/AST/Types.h"
 #include "swift/Basic/Platform.h"
 #include "swift/Basic/Range.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/StringExtras.h"
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporterOptions.h"
@@ -456,6 +457,17 @@ getNormalInvocationArguments(std::vector<std::string> &invocationArgStrs,
     invocationArgStrs.back().append(moduleCachePath);
   }
 
+  if (importerOpts.BuildSessionTimestamp) {
+    invocationArgStrs.push_back("-fbuild-session-timestamp=" +
+        std::to_string(importerOpts.BuildSessionTimestamp));
+    invocationArgStrs.push_back("-fmodules-validate-once-per-build-session");
+  }
+
+  if (!importerOpts.PrecompiledBridgingHeader.empty()) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.PrecompiledBridgingHeader);
+  }
+
   if (importerOpts.DetailedPreprocessingRecord) {
     invocationArgStrs.insert(invocationArgStrs.end(), {
       "-Xclang", "-detailed-preprocessing-record",
@@ -980,6 +992,53 @@ bool ClangImporter::Implementation::importHeader(
   return false;
 }
 
+bool ClangImporter::Implementation::importPrecompiledBridgingHeader(
+    ClangImporter &importer, Module *adapter,
+    const clang::FileEntry *headerFile, bool trackParsedSymbols) {
+  clang::FileManager &fileManager = Instance->getFileManager();
+  std::string originalHeader = clang::ASTReader::getOriginalSourceFile(
+      PrecompiledBridgingHeader, fileManager,
+      Instance->getPCHContainerReader(), Instance->getDiagnostics());
+  if (fileManager.getFile(originalHeader) != headerFile)
+    return false;
+
+  assert(adapter);
+  ImportedHeaderOwners.push_back(adapter);
+
+  // Clang loaded the precompiled header before our listener was installed,
+  // so report the headers it was built from here.
+  ASTReaderCallbacks dependencyCollector(importer);
+  clang::ASTReader::readASTFileControlBlock(
+      PrecompiledBridgingHeader, fileManager,
+      Instance->getPCHContainerReader(),
+      /*FindModuleFileExtensions=*/false, dependencyCollector);
+
+  // Do for the imports recorded in the precompiled header what the
+  // preprocessor callbacks do for those of a parsed one.
+  clang::ASTContext &clangCtx = getClangASTContext();
+  for (clang::Decl *D : clangCtx.getTranslationUnitDecl()->decls()) {
+    if (!D->isFromASTFile())
+      continue;
+
+    if (auto *clangImport = dyn_cast<clang::ImportDecl>(D)) {
+      Module *nativeImported =
+          finishLoadingClangModule(importer, clangImport->getImportedModule(),
+                                   /*adapter=*/true);
+      ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+      if (trackParsedSymbols)
+        BridgeHeaderTopLevelImports.push_back(
+            createImportDecl(SwiftContext, adapter, clangImport, {}));
+      continue;
+    }
+
+    if (trackParsedSymbols)
+      addBridgeHeaderTopLevelDecls(D);
+  }
+
+  bumpGeneration();
+  return true;
+}
+
 bool ClangImporter::importHeader(StringRef header, Module *adapter,
                                  off_t expectedSize, time_t expectedModTime,
                                  StringRef cachedContents, SourceLoc diagLoc) {
@@ -1012,6 +1071,12 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
     return true;
   }
 
+  if (!Impl.PrecompiledBridgingHeader.empty() &&
+      Impl.importPrecompiledBridgingHeader(*this, adapter, headerFile,
+                                           trackParsedSymbols)) {
+    return false;
+  }
+
   llvm::SmallString<128> importLine{"#import \""};
   importLine += header;
   importLine += "\"\n";
@@ -1072,6 +1137,70 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  // The invocation still carries the Swift name lookup extension, so the
+  // lookup table of the header is written along with it.
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
+bool ClangImporter::canReadPCH(StringRef PCHFilename) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(Implementation::moduleImportBufferName,
+                               clang::IK_ObjC));
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+  invocation->getPreprocessorOpts().ImplicitPCHInclude = PCHFilename;
+
+  // Loading the header performs all of Clang's checks on it, so any error
+  // means it's out of date.
+  clang::CompilerInstance readInstance(
+    Impl.Instance->getPCHContainerOperations());
+  readInstance.setInvocation(&*invocation);
+  readInstance.createDiagnostics(new clang::IgnoringDiagConsumer);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  readInstance.setFileManager(&fileManager);
+  readInstance.createSourceManager(fileManager);
+
+  clang::SyntaxOnlyAction action;
+  return readInstance.ExecuteAction(action) &&
+         !readInstance.getDiagnostics().hasErrorOccurred();
+}
+
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
@@ -1235,6 +1364,7 @@ ClangImporter::Implementation::Implementation(ASTContext &ctx,
     InferImportAsMember(opts.InferImportAsMember),
     DisableSwiftBridgeAttr(opts.DisableSwiftBridgeAttr),
     HonorSwiftNewtypeAttr(opts.HonorSwiftNewtypeAttr),
+    PrecompiledBridgingHeader(opts.PrecompiledBridgingHeader),
     BridgingHeaderLookupTable(nullptr)
 {
   // Add filters to determine if a Clang availability attribute
@@ -2339,6 +2469,33 @@ auto ClangImporter::Implementation::importFullName(
        const clang::NamedDecl *D,
        ImportNameOptions options,
        clang::Sema *clangSemaOverride) -> ImportedName {
+  // Names computed against another Sema, such as the one writing a module
+  // file, aren't cached.
+  if (clangSemaOverride && clangSemaOverride != &getClangSema())
+    return importFullNameUncached(D, options, clangSemaOverride);
+
+  auto key = std::make_pair(D, static_cast<unsigned>(options.toRaw()));
+  auto known = ImportedNames.find(key);
+  if (known != ImportedNames.end()) {
+    if (SwiftContext.Stats)
+      ++SwiftContext.Stats->getFrontendCounters().NumImportedNameCacheHits;
+    return known->second;
+  }
+
+  if (SwiftContext.Stats)
+    ++SwiftContext.Stats->getFrontendCounters().NumImportedNamesComputed;
+
+  // Computing the name may recursively name overridden declarations, so
+  // don't hold on to an iterator across the call.
+  auto result = importFullNameUncached(D, options, clangSemaOverride);
+  ImportedNames[key] = result;
+  return result;
+}
+
+auto ClangImporter::Implementation::importFullNameUncached(
+       const clang::NamedDecl *D,
+       ImportNameOptions options,
+       clang::Sema *clangSemaOverride) -> ImportedName {
   clang::Sema &clangSema = clangSemaOverride ? *clangSemaOverride
                                              : getClangSema();
   ImportedName result;
@@ -4460,13 +4617,19 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
   assert(metadata.MajorVersion == SWIFT_LOOKUP_TABLE_VERSION_MAJOR);
   assert(metadata.MinorVersion == SWIFT_LOOKUP_TABLE_VERSION_MINOR);
 
+  // A precompiled bridging header has no module name, so its table is kept
+  // under a name no module can have.
+  bool isPCH = mod.Kind == clang::serialization::MK_PCH;
+  std::string moduleName = isPCH ? "<bridging-header-pch>" : mod.ModuleName;
+
   // Check whether we already have an entry in the set of lookup tables.
-  auto &entry = Impl.LookupTables[mod.ModuleName];
+  auto &entry = Impl.LookupTables[moduleName];
   if (entry) return nullptr;
 
   // Local function used to remove this entry when the reader goes away.
-  std::string moduleName = mod.ModuleName;
-  auto onRemove = [this, moduleName]() {
+  auto onRemove = [this, moduleName, isPCH]() {
+    if (isPCH)
+      Impl.BridgingHeaderPCHLookupTable = nullptr;
     Impl.LookupTables.erase(moduleName);
   };
 
@@ -4477,6 +4640,8 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
 
   // Create the lookup table.
   entry.reset(new SwiftLookupTable(tableReader.get()));
+  if (isPCH)
+    Impl.BridgingHeaderPCHLookupTable = entry.get();
 
   // Return the new reader.
   return std::move(tableReader);
@@ -4485,8 +4650,13 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
 SwiftLookupTable *ClangImporter::Implementation::findLookupTable(
                     const clang::Module *clangModule) {
   // If the Clang module is null, use the bridging header lookup table.
-  if (!clangModule)
+  // Headers parsed in addition to a precompiled bridging header are only
+  // found through forEachLookupTable.
+  if (!clangModule) {
+    if (BridgingHeaderPCHLookupTable)
+      return BridgingHeaderPCHLookupTable;
     return &BridgingHeaderLookupTable;
+  }
 
   // Submodules share lookup tables with their parents.
   if (clangModule->isSubModule())
@@ -4588,8 +4758,9 @@ void ClangImporter::Implementation::lookupValue(
 void ClangImporter::Implementation::lookupVisibleDecls(
        SwiftLookupTable &table,
        VisibleDeclConsumer &consumer) {
-  // Retrieve and sort all of the base names in this particular table.
-  auto baseNames = table.allBaseNames();
+  // Retrieve and sort the base names of the global entities in this
+  // particular table.
+  auto baseNames = table.allGlobalBaseNames();
   llvm::array_pod_sort(baseNames.begin(), baseNames.end());
 
   // Look for namespace-scope entities with each base name.
@@ -4645,8 +4816,9 @@ void ClangImporter::Implementation::lookupObjCMembers(
 void ClangImporter::Implementation::lookupAllObjCMembers(
        SwiftLookupTable &table,
        VisibleDeclConsumer &consumer) {
-  // Retrieve and sort all of the base names in this particular table.
-  auto baseNames = table.allBaseNames();
+  // Retrieve and sort the base names of the Objective-C members in this
+  // particular table.
+  auto baseNames = table.allObjCMemberBaseNames();
   llvm::array_pod_sort(baseNames.begin(), baseNames.end());
 
   // Look for Objective-C members with each base name.
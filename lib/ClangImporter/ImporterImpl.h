@@ -265,6 +265,9 @@ public:
   const bool DisableSwiftBridgeAttr;
   const bool HonorSwiftNewtypeAttr;
 
+  /// \see ClangImporterOptions::PrecompiledBridgingHeader
+  const std::string PrecompiledBridgingHeader;
+
   constexpr static const char * const moduleImportBufferName =
     "<swift-imported-modules>";
   constexpr static const char * const bridgingHeaderBufferName =
@@ -274,6 +277,10 @@ private:
   /// The Swift lookup table for the bridging header.
   SwiftLookupTable BridgingHeaderLookupTable;
 
+  /// The Swift lookup table stored in the precompiled bridging header, if
+  /// one was loaded. It's owned by \c LookupTables.
+  SwiftLookupTable *BridgingHeaderPCHLookupTable = nullptr;
+
   /// The Swift lookup tables, per module.
   ///
   /// Annoyingly, we list this table early so that it gets torn down after
@@ -467,6 +474,10 @@ private:
   void bumpGeneration() {
     ++Generation;
     SwiftContext.bumpGeneration();
+
+    // Newly visible declarations can change how names are imported, e.g. by
+    // introducing conflicts, so recompute them.
+    ImportedNames.clear();
   }
 
   /// \brief Cache enum infos, referenced with a dotted Clang name
@@ -738,6 +749,16 @@ public:
                     bool trackParsedSymbols,
                     std::unique_ptr<llvm::MemoryBuffer> contents);
 
+  /// Makes the contents of the precompiled bridging header, which Clang
+  /// loaded up front, available as if \p headerFile had been imported.
+  ///
+  /// \returns false if the precompiled header wasn't built from
+  /// \p headerFile, in which case nothing is done.
+  bool importPrecompiledBridgingHeader(ClangImporter &importer,
+                                       Module *adapter,
+                                       const clang::FileEntry *headerFile,
+                                       bool trackParsedSymbols);
+
   /// Returns the redeclaration of \p D that contains its definition for any
   /// tag type decl (struct, enum, or union) or Objective-C class or protocol.
   ///
@@ -930,6 +951,23 @@ public:
                               ImportNameOptions options = None,
                               clang::Sema *clangSemaOverride = nullptr);
 
+private:
+  /// Names computed by importFullName for the importer's own Sema, keyed by
+  /// declaration and options.
+  ///
+  /// Each declaration's name is needed several times over: when it's added
+  /// to a lookup table, when it's imported, for its Swift 2 name, and
+  /// whenever a method overriding it is named.
+  llvm::DenseMap<std::pair<const clang::NamedDecl *, unsigned>, ImportedName>
+    ImportedNames;
+
+  /// Compute the result of importFullName without consulting the cache.
+  ImportedName importFullNameUncached(const clang::NamedDecl *D,
+                                      ImportNameOptions options,
+                                      clang::Sema *clangSemaOverride);
+
+public:
+
   /// Imports the name of the given Clang macro into Swift.
   Identifier importMacroName(const clang::IdentifierInfo *clangIdentifier,
                              const clang::MacroInfo *macro,
@@ -1423,7 +1461,8 @@ public:
   /// Find the lookup table that corresponds to the given Clang module.
   ///
   /// \param clangModule The module, or null to indicate that we're talking
-  /// about the directly-parsed headers.
+  /// about the directly-parsed headers (or the precompiled bridging header
+  /// that stands in for them).
   SwiftLookupTable *findLookupTable(const clang::Module *clangModule);
 
   /// Visit each of the lookup tables in some deterministic order.
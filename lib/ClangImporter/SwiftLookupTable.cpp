@@ -56,6 +56,19 @@ bool SwiftLookupTable::contextRequiresName(ContextKind kind) {
   }
 }
 
+bool SwiftLookupTable::isObjCMemberContext(ContextKind kind) {
+  switch (kind) {
+  case ContextKind::ObjCClass:
+  case ContextKind::ObjCProtocol:
+  case ContextKind::Typedef:
+    return true;
+
+  case ContextKind::TranslationUnit:
+  case ContextKind::Tag:
+    return false;
+  }
+}
+
 /// Try to translate the given Clang declaration into a context.
 static Optional<SwiftLookupTable::StoredContext>
 translateDeclToContext(clang::NamedDecl *decl) {
@@ -474,6 +487,36 @@ SmallVector<StringRef, 4> SwiftLookupTable::allBaseNames() {
   return result;
 }
 
+SmallVector<StringRef, 4> SwiftLookupTable::collectBaseNames(
+    llvm::function_ref<bool(ContextKind)> filter) const {
+  SmallVector<StringRef, 4> result;
+  for (const auto &entry : LookupTable) {
+    for (const auto &fullEntry : entry.second) {
+      if (filter(fullEntry.Context.first)) {
+        result.push_back(entry.first);
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+SmallVector<StringRef, 4> SwiftLookupTable::allGlobalBaseNames() {
+  // If we have a reader, it recorded these names when the table was written.
+  if (Reader) return Reader->getGlobalBaseNames();
+
+  return collectBaseNames([](ContextKind kind) {
+    return kind == ContextKind::TranslationUnit;
+  });
+}
+
+SmallVector<StringRef, 4> SwiftLookupTable::allObjCMemberBaseNames() {
+  // If we have a reader, it recorded these names when the table was written.
+  if (Reader) return Reader->getObjCMemberBaseNames();
+
+  return collectBaseNames(isObjCMemberContext);
+}
+
 SmallVector<clang::NamedDecl *, 4>
 SwiftLookupTable::lookupObjCMembers(StringRef baseName) {
   SmallVector<clang::NamedDecl *, 4> result;
@@ -484,19 +527,10 @@ SwiftLookupTable::lookupObjCMembers(StringRef baseName) {
 
   // Walk each of the entries.
   for (auto &entry : known->second) {
-    // If we're looking in a particular context and it doesn't match the
-    // entry context, we're done.
-    switch (entry.Context.first) {
-    case ContextKind::TranslationUnit:
-    case ContextKind::Tag:
+    // If the entry isn't an Objective-C member, skip it.
+    if (!isObjCMemberContext(entry.Context.first))
       continue;
 
-    case ContextKind::ObjCClass:
-    case ContextKind::ObjCProtocol:
-    case ContextKind::Typedef:
-      break;
-    }
-
     // Map each of the declarations.
     for (auto &stored : entry.DeclsOrMacros) {
       assert(isDeclEntry(stored) && "Not a declaration?");
@@ -716,7 +750,15 @@ namespace {
 
     /// Record that contains the mapping from contexts to the list of
     /// globals that will be injected as members into those contexts.
-    GLOBALS_AS_MEMBERS_RECORD_ID
+    GLOBALS_AS_MEMBERS_RECORD_ID,
+
+    /// Record that contains the NUL-terminated base names that have entries
+    /// at translation unit scope.
+    GLOBAL_BASE_NAMES_RECORD_ID,
+
+    /// Record that contains the NUL-terminated base names that have entries
+    /// found by Objective-C member lookup.
+    OBJC_MEMBER_BASE_NAMES_RECORD_ID
   };
 
   using BaseNameToEntitiesTableRecordLayout
@@ -728,6 +770,12 @@ namespace {
   using GlobalsAsMembersTableRecordLayout
     = BCRecordLayout<GLOBALS_AS_MEMBERS_RECORD_ID, BCVBR<16>, BCBlob>;
 
+  using GlobalBaseNamesRecordLayout
+    = BCRecordLayout<GLOBAL_BASE_NAMES_RECORD_ID, BCBlob>;
+
+  using ObjCMemberBaseNamesRecordLayout
+    = BCRecordLayout<OBJC_MEMBER_BASE_NAMES_RECORD_ID, BCBlob>;
+
   /// Trait used to write the on-disk hash table for the base name -> entities
   /// mapping.
   class BaseNameToEntitiesTableWriterInfo {
@@ -929,6 +977,39 @@ void SwiftLookupTableWriter::writeExtensionContents(
     layout.emit(ScratchRecord, tableOffset, hashTableBlob);
   }
 
+  // Write the base names that have global or Objective-C member entries, so
+  // that enumerating either doesn't have to deserialize every entry.
+  {
+    llvm::SmallString<4096> globalNamesBlob;
+    llvm::SmallString<4096> objcMemberNamesBlob;
+    for (auto baseName : baseNames) {
+      bool hasGlobal = false, hasObjCMember = false;
+      for (const auto &entry : table.LookupTable[baseName]) {
+        auto kind = entry.Context.first;
+        hasGlobal |= kind == SwiftLookupTable::ContextKind::TranslationUnit;
+        hasObjCMember |= SwiftLookupTable::isObjCMemberContext(kind);
+      }
+
+      if (hasGlobal) {
+        globalNamesBlob += baseName;
+        globalNamesBlob.push_back('\0');
+      }
+      if (hasObjCMember) {
+        objcMemberNamesBlob += baseName;
+        objcMemberNamesBlob.push_back('\0');
+      }
+    }
+
+    if (!globalNamesBlob.empty()) {
+      GlobalBaseNamesRecordLayout layout(stream);
+      layout.emit(ScratchRecord, globalNamesBlob);
+    }
+    if (!objcMemberNamesBlob.empty()) {
+      ObjCMemberBaseNamesRecordLayout layout(stream);
+      layout.emit(ScratchRecord, objcMemberNamesBlob);
+    }
+  }
+
   // Write the categories, if there are any.
   if (!table.Categories.empty()) {
     SmallVector<clang::serialization::DeclID, 4> categoryIDs;
@@ -1180,6 +1261,8 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   std::unique_ptr<SerializedBaseNameToEntitiesTable> serializedTable;
   std::unique_ptr<SerializedGlobalsAsMembersTable> globalsAsMembersTable;
   ArrayRef<clang::serialization::DeclID> categories;
+  StringRef globalBaseNames;
+  StringRef objcMemberBaseNames;
   while (next.Kind != llvm::BitstreamEntry::EndBlock) {
     if (next.Kind == llvm::BitstreamEntry::Error)
       return nullptr;
@@ -1242,6 +1325,20 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
       break;
     }
 
+    case GLOBAL_BASE_NAMES_RECORD_ID:
+      // Already saw the global base names; input is malformed.
+      if (!globalBaseNames.empty()) return nullptr;
+
+      globalBaseNames = blobData;
+      break;
+
+    case OBJC_MEMBER_BASE_NAMES_RECORD_ID:
+      // Already saw the Objective-C member base names; input is malformed.
+      if (!objcMemberBaseNames.empty()) return nullptr;
+
+      objcMemberBaseNames = blobData;
+      break;
+
     default:
       // Unknown record, possibly for use by a future version of the
       // module format.
@@ -1257,7 +1354,8 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   return std::unique_ptr<SwiftLookupTableReader>(
            new SwiftLookupTableReader(extension, reader, moduleFile, onRemove,
                                       serializedTable.release(), categories,
-                                      globalsAsMembersTable.release()));
+                                      globalsAsMembersTable.release(),
+                                      globalBaseNames, objcMemberBaseNames));
 
 }
 
@@ -1270,6 +1368,25 @@ SmallVector<StringRef, 4> SwiftLookupTableReader::getBaseNames() {
   return results;
 }
 
+/// Split a blob of NUL-terminated base names.
+static SmallVector<StringRef, 4> splitBaseNames(StringRef blob) {
+  SmallVector<StringRef, 4> results;
+  while (!blob.empty()) {
+    auto split = blob.split('\0');
+    results.push_back(split.first);
+    blob = split.second;
+  }
+  return results;
+}
+
+SmallVector<StringRef, 4> SwiftLookupTableReader::getGlobalBaseNames() {
+  return splitBaseNames(GlobalBaseNames);
+}
+
+SmallVector<StringRef, 4> SwiftLookupTableReader::getObjCMemberBaseNames() {
+  return splitBaseNames(ObjCMemberBaseNames);
+}
+
 bool SwiftLookupTableReader::lookup(
        StringRef baseName,
        SmallVectorImpl<SwiftLookupTable::FullTableEntry> &entries) {
@@ -25,6 +25,7 @@
 #include "clang/Serialization/ModuleFileExtension.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <functional>
@@ -146,7 +147,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table minor version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 14; // Swift 2 names
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 15; // base name lists
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -179,6 +180,10 @@ public:
   /// Determine whether the given context requires a name to disambiguate.
   static bool contextRequiresName(ContextKind kind);
 
+  /// Determine whether entities in the given context are found by
+  /// Objective-C member lookup.
+  static bool isObjCMemberContext(ContextKind kind);
+
   /// A single entry referencing either a named declaration or a macro.
   typedef llvm::PointerUnion<clang::NamedDecl *, clang::MacroInfo *>
     SingleEntry;
@@ -289,6 +294,11 @@ private:
   friend class SwiftLookupTableReader;
   friend class SwiftLookupTableWriter;
 
+  /// Collect the base names of the in-memory entries for which any
+  /// entry's context satisfies \p filter.
+  SmallVector<StringRef, 4>
+  collectBaseNames(llvm::function_ref<bool(ContextKind)> filter) const;
+
   /// Find or create the table entry for the given base name. 
   llvm::DenseMap<StringRef, SmallVector<FullTableEntry, 2>>::iterator
   findOrCreate(StringRef baseName);
@@ -373,6 +383,17 @@ public:
   /// Retrieve the set of base names that are stored in the lookup table.
   SmallVector<StringRef, 4> allBaseNames();
 
+  /// Retrieve the set of base names that have at least one entry at
+  /// translation unit scope.
+  ///
+  /// Unlike \c allBaseNames, this does not include the (far more numerous)
+  /// names that only occur as Objective-C members or within tags.
+  SmallVector<StringRef, 4> allGlobalBaseNames();
+
+  /// Retrieve the set of base names that have at least one entry found by
+  /// Objective-C member lookup.
+  SmallVector<StringRef, 4> allObjCMemberBaseNames();
+
   /// Lookup Objective-C members with the given base name, regardless
   /// of context.
   SmallVector<clang::NamedDecl *, 4> lookupObjCMembers(StringRef baseName);
@@ -423,17 +444,27 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
   ArrayRef<clang::serialization::DeclID> Categories;
   void *GlobalsAsMembersTable;
 
+  /// NUL-terminated base names with translation-unit-scope entries.
+  StringRef GlobalBaseNames;
+
+  /// NUL-terminated base names with Objective-C member entries.
+  StringRef ObjCMemberBaseNames;
+
   SwiftLookupTableReader(clang::ModuleFileExtension *extension,
                          clang::ASTReader &reader,
                          clang::serialization::ModuleFile &moduleFile,
                          std::function<void()> onRemove,
                          void *serializedTable,
                          ArrayRef<clang::serialization::DeclID> categories,
-                         void *globalsAsMembersTable)
+                         void *globalsAsMembersTable,
+                         StringRef globalBaseNames,
+                         StringRef objcMemberBaseNames)
     : ModuleFileExtensionReader(extension), Reader(reader),
       ModuleFile(moduleFile), OnRemove(onRemove),
       SerializedTable(serializedTable), Categories(categories),
-      GlobalsAsMembersTable(globalsAsMembersTable) { }
+      GlobalsAsMembersTable(globalsAsMembersTable),
+      GlobalBaseNames(globalBaseNames),
+      ObjCMemberBaseNames(objcMemberBaseNames) { }
 
 public:
   /// Create a new lookup table reader for the given AST reader and stream
@@ -455,6 +486,14 @@ public:
   /// Retrieve the set of base names that are stored in the on-disk hash table.
   SmallVector<StringRef, 4> getBaseNames();
 
+  /// Retrieve the set of base names that have translation-unit-scope entries,
+  /// without deserializing those entries.
+  SmallVector<StringRef, 4> getGlobalBaseNames();
+
+  /// Retrieve the set of base names that have Objective-C member entries,
+  /// without deserializing those entries.
+  SmallVector<StringRef, 4> getObjCMemberBaseNames();
+
   /// Retrieve the set of entries associated with the given base name.
   ///
   /// \returns true if we found anything, false otherwise.
@@ -20,7 +20,9 @@ using namespace llvm::opt;
 
 JobAction::~JobAction() {
   if (getOwnsInputs()) {
-    llvm::DeleteContainerPointers(Inputs);
+    for (Action *Input : Inputs)
+      if (!SharedInputs.count(Input))
+        delete Input;
   }
 }
 
@@ -36,6 +38,7 @@ const char *Action::getClassName(ActionClass AC) {
     case REPLJob: return "repl";
     case LinkJob: return "link";
     case GenerateDSYMJob: return "generate-dSYM";
+    case GeneratePCHJob: return "generate-pch";
   }
 
   llvm_unreachable("invalid class");
@@ -62,3 +65,5 @@ void REPLJobAction::anchor() {}
 void LinkJobAction::anchor() {}
 
 void GenerateDSYMJobAction::anchor() {}
+
+void GeneratePCHJobAction::anchor() {}
@@ -0,0 +1,122 @@
+//===--- BuildStateCache.cpp - State kept between driver builds -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/BuildStateCache.h"
+#include "swift/Driver/Job.h"
+#include "swift/Driver/OutputFileMap.h"
+#include "swift/Driver/Types.h"
+
+using namespace swift;
+using namespace swift::driver;
+
+BuildStateCache::BuildStateCache(bool trustNotifications)
+  : TrustNotifications(trustNotifications) {}
+
+BuildStateCache::~BuildStateCache() = default;
+
+void BuildStateCache::beginBuild() {
+  // Without notifications, anything may have changed since the last build.
+  // The cached contents are kept, but will be checked against fresh statuses.
+  if (!TrustNotifications)
+    Statuses.clear();
+}
+
+void BuildStateCache::fileChanged(StringRef path) {
+  Statuses.erase(path);
+  OutputFileMaps.erase(path);
+  Buffers.erase(path);
+}
+
+void BuildStateCache::outputsChanged(const CommandOutput &output) {
+  for (const std::string &path : output.getPrimaryOutputFilenames())
+    fileChanged(path);
+  types::forAllTypes([&](types::ID type) {
+    const std::string &path = output.getAdditionalOutputForType(type);
+    if (!path.empty())
+      fileChanged(path);
+  });
+}
+
+void BuildStateCache::clear() {
+  Statuses.clear();
+  OutputFileMaps.clear();
+  Buffers.clear();
+}
+
+std::error_code
+BuildStateCache::getStatus(StringRef path,
+                           llvm::sys::fs::file_status &result) {
+  auto insertResult = Statuses.insert({path, StatusEntry()});
+  StatusEntry &entry = insertResult.first->getValue();
+  if (insertResult.second)
+    entry.Error = llvm::sys::fs::status(path, entry.Status);
+  result = entry.Status;
+  return entry.Error;
+}
+
+template <typename T>
+T *BuildStateCache::lookupContents(llvm::StringMap<ContentsEntry<T>> &cache,
+                                   StringRef path,
+                                   const llvm::sys::fs::file_status *&status) {
+  status = nullptr;
+  llvm::sys::fs::file_status currentStatus;
+  if (getStatus(path, currentStatus)) {
+    cache.erase(path);
+    return nullptr;
+  }
+  status = &Statuses.find(path)->getValue().Status;
+
+  auto iter = cache.find(path);
+  if (iter == cache.end())
+    return nullptr;
+  ContentsEntry<T> &entry = iter->getValue();
+  if (entry.ModTime != currentStatus.getLastModificationTime() ||
+      entry.Size != currentStatus.getSize()) {
+    cache.erase(iter);
+    return nullptr;
+  }
+  return entry.Contents.get();
+}
+
+const OutputFileMap *BuildStateCache::getOutputFileMap(StringRef path) {
+  const llvm::sys::fs::file_status *status;
+  if (auto *cached = lookupContents(OutputFileMaps, path, status))
+    return cached;
+  if (!status)
+    return nullptr;
+
+  auto OFM = OutputFileMap::loadFromPath(path);
+  if (!OFM)
+    return nullptr;
+  auto &entry = OutputFileMaps[path];
+  entry.ModTime = status->getLastModificationTime();
+  entry.Size = status->getSize();
+  entry.Contents = std::move(OFM);
+  return entry.Contents.get();
+}
+
+llvm::MemoryBuffer *BuildStateCache::getBuffer(StringRef path) {
+  const llvm::sys::fs::file_status *status;
+  if (auto *cached = lookupContents(Buffers, path, status))
+    return cached;
+  if (!status)
+    return nullptr;
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return nullptr;
+  auto &entry = Buffers[path];
+  entry.ModTime = status->getLastModificationTime();
+  entry.Size = status->getSize();
+  entry.Contents = std::move(buffer.get());
+  return entry.Contents.get();
+}
@@ -20,21 +20,33 @@
 #include "swift/Basic/Version.h"
 #include "swift/Basic/type_traits.h"
 #include "swift/Driver/Action.h"
+#include "swift/Driver/BuildStateCache.h"
+#include "swift/Driver/CompilationCache.h"
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Driver/ToolChain.h"
+#include "swift/Option/Options.h"
+#include "swift/Serialization/Validation.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <chrono>
+#include <functional>
+
 using namespace swift;
 using namespace swift::sys;
 using namespace swift::driver;
@@ -83,17 +95,49 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// In batch mode, compile jobs that are ready to run but have not yet been
+    /// handed to the TaskQueue, because they may still be batched together.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// A map from each batch job to the jobs it does the work of.
+    llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 8>, 4>
+        BatchConstituents;
+
+    /// Owns the batch jobs created while performing the compilation.
+    std::vector<std::unique_ptr<const Job>> BatchJobs;
+
+    /// The cache keys of the jobs which missed the compilation cache, under
+    /// which their outputs are stored once they succeed.
+    llvm::SmallDenseMap<const Job *, std::string, 16> CacheKeys;
+
+    /// Jobs whose outputs were restored from the compilation cache.
+    CommandSet RestoredCommands;
+
+    /// Restored jobs, and the text they printed, which have yet to be treated
+    /// as finished.
+    SmallVector<std::pair<const Job *, std::string>, 16> CachedCommands;
   };
 }
 
 Compilation::~Compilation() = default;
 
+void
+Compilation::setCompilationCache(std::unique_ptr<CompilationCache> NewCache) {
+  Cache = std::move(NewCache);
+}
+
 Job *Compilation::addJob(std::unique_ptr<Job> J) {
   Job *result = J.get();
   Jobs.emplace_back(std::move(J));
   return result;
 }
 
+void Compilation::enableBatchMode(const ToolChain &TC, const OutputInfo &OI) {
+  BatchModeToolChain = &TC;
+  BatchModeOutputInfo.reset(new OutputInfo(OI));
+}
+
 static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
                                     const CommandSet &FinishedCommands) {
   for (const Job *Cmd : JL) {
@@ -172,9 +216,11 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
   }
 }
 
-static void writeCompilationRecord(StringRef path, StringRef argsHash,
-                                   llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+static void
+writeCompilationRecord(StringRef path, StringRef argsHash,
+                       llvm::sys::TimeValue buildTime,
+                       const InputInfoMap &inputs,
+                       const llvm::StringMap<std::string> &externalHashes) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -213,6 +259,37 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  if (externalHashes.empty())
+    return;
+
+  // Sort the entries so that the record doesn't change needlessly.
+  std::vector<StringRef> dependencies;
+  for (auto &entry : externalHashes)
+    dependencies.push_back(entry.getKey());
+  std::sort(dependencies.begin(), dependencies.end());
+
+  out << "external_interface_hashes:\n";
+  for (StringRef dependency : dependencies) {
+    out << "  \"" << llvm::yaml::escape(dependency) << "\": \""
+        << llvm::yaml::escape(externalHashes.lookup(dependency)) << "\"\n";
+  }
+}
+
+/// Returns the interface hash of the module at \p path, or an empty string
+/// if it isn't a module or doesn't have one.
+static std::string readInterfaceHash(StringRef path) {
+  if (llvm::sys::path::extension(path) != ".swiftmodule")
+    return std::string();
+
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return std::string();
+
+  auto info = serialization::validateSerializedAST(buffer.get()->getBuffer());
+  if (info.status != serialization::Status::Valid)
+    return std::string();
+  return info.interfaceHash;
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -252,26 +329,259 @@ static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
   return true;
 }
 
+/// Maps the primary input of a frontend job to how long that job took, in
+/// milliseconds.
+using JobTimingMap = llvm::StringMap<unsigned>;
+
+/// Maps the class name of each kind of job to the largest peak resident
+/// memory, in bytes, of the jobs of that kind.
+using JobMemoryMap = llvm::StringMap<uint64_t>;
+
+/// Job timings are kept next to the build record, so that they are available
+/// whenever per-file dependency information is.
+static std::string getJobTimingsPath(StringRef compilationRecordPath) {
+  return (compilationRecordPath + ".timings").str();
+}
+
+/// Job memory usage is kept next to the build record, like the timings.
+static std::string getJobMemoryPath(StringRef compilationRecordPath) {
+  return (compilationRecordPath + ".memory").str();
+}
+
+/// Returns the key under which \p job's timing is recorded, or an empty
+/// string if it isn't recorded at all.
+static StringRef getJobTimingKey(const Job *job) {
+  const CommandOutput &output = job->getOutput();
+  if (output.getAdditionalOutputForType(types::TY_SwiftDeps).empty())
+    return StringRef();
+  return output.getBaseInput(0);
+}
+
+/// Reads a map of job timings or memory usage written by #writeJobHistory.
+template <typename T>
+static void readJobHistory(StringRef path, llvm::StringMap<T> &history) {
+  // A missing or malformed file just means there's no history to go on.
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return;
+
+  llvm::SourceMgr SM;
+  llvm::yaml::Stream stream(buffer.get()->getMemBufferRef(), SM);
+  auto I = stream.begin();
+  if (I == stream.end() || !I->getRoot())
+    return;
+  auto *topLevelMap = dyn_cast<llvm::yaml::MappingNode>(I->getRoot());
+  if (!topLevelMap)
+    return;
+
+  SmallString<64> keyScratch, valueScratch;
+  // FIXME: LLVM's YAML support does incremental parsing in such a way that
+  // for-range loops break.
+  for (auto i = topLevelMap->begin(), e = topLevelMap->end(); i != e; ++i) {
+    auto *key = dyn_cast<llvm::yaml::ScalarNode>(i->getKey());
+    auto *value = dyn_cast_or_null<llvm::yaml::ScalarNode>(i->getValue());
+    if (!key || !value)
+      return;
+    T parsedValue;
+    if (value->getValue(valueScratch).getAsInteger(10, parsedValue))
+      return;
+    history[key->getValue(keyScratch)] = parsedValue;
+  }
+}
+
+template <typename T>
+static void writeJobHistory(StringRef path,
+                            const llvm::StringMap<T> &history) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // The history only affects scheduling, so losing it is harmless.
+    out.clear_error();
+    return;
+  }
+
+  // Sort the entries so that the file doesn't change needlessly.
+  std::vector<StringRef> keys;
+  for (auto &entry : history)
+    keys.push_back(entry.getKey());
+  llvm::array_pod_sort(keys.begin(), keys.end());
+
+  for (StringRef key : keys) {
+    out << "\"" << llvm::yaml::escape(key) << "\": "
+        << history.lookup(key) << "\n";
+  }
+}
+
+/// Computes the priority with which each job in \p jobs should be scheduled:
+/// the expected time of the longest chain of jobs that starts with it.
+///
+/// Starting the jobs at the head of the longest chains first keeps one big
+/// file discovered late from stretching out the end of the build.
+template <typename JobList>
+static void computeJobPriorities(const JobList &jobs,
+                                 const JobTimingMap &timings,
+                                 llvm::DenseMap<const Job *, unsigned> &result) {
+  // Jobs we know nothing about (e.g. newly-added files) are assumed to take
+  // as long as an average job, so they aren't all left until the end.
+  uint64_t totalTime = 0;
+  unsigned numTimed = 0;
+  for (auto &entry : timings) {
+    totalTime += entry.getValue();
+    ++numTimed;
+  }
+  unsigned defaultCost = numTimed ? totalTime / numTimed : 0;
+
+  llvm::DenseMap<const Job *, TinyPtrVector<const Job *>> consumers;
+  for (const Job *cmd : jobs)
+    for (const Job *input : cmd->getInputs())
+      consumers[input].push_back(cmd);
+
+  std::function<unsigned(const Job *)> getPriority = [&](const Job *cmd) {
+    auto known = result.find(cmd);
+    if (known != result.end())
+      return known->second;
+
+    unsigned cost = 0;
+    StringRef key = getJobTimingKey(cmd);
+    if (!key.empty()) {
+      auto timing = timings.find(key);
+      cost = (timing != timings.end()) ? timing->getValue() : defaultCost;
+    }
+
+    unsigned longestTail = 0;
+    auto consumerIter = consumers.find(cmd);
+    if (consumerIter != consumers.end())
+      for (const Job *consumer : consumerIter->second)
+        longestTail = std::max(longestTail, getPriority(consumer));
+
+    unsigned priority = cost + longestTail;
+    result[cmd] = priority;
+    return priority;
+  };
+
+  for (const Job *cmd : jobs)
+    (void)getPriority(cmd);
+}
+
+/// The largest number of primary files given to one frontend process in batch
+/// mode. Past this, splitting the work further costs little, and keeps a
+/// single failing or slow file from holding up too much of the build.
+static const size_t MaxBatchSize = 25;
+
+/// Describes the outputs of \p Cmd, if it's a compile job which can be
+/// batched with other compile jobs with the same description.
+///
+/// Jobs with outputs that cover the whole frontend invocation rather than a
+/// single file (serialized diagnostics, fixits, an Objective-C header) always
+/// run on their own.
+static Optional<unsigned> getBatchSignature(const Job *Cmd) {
+  if (!isa<CompileJobAction>(Cmd->getSource()) ||
+      Cmd->getSource().size() != 1 ||
+      !Cmd->getExtraEnvironment().empty())
+    return None;
+
+  const CommandOutput &Output = Cmd->getOutput();
+  if (Output.getPrimaryOutputFilenames().size() != 1)
+    return None;
+
+  switch (Output.getPrimaryOutputType()) {
+  case types::TY_Object:
+  case types::TY_Assembly:
+  case types::TY_LLVM_IR:
+  case types::TY_LLVM_BC:
+  case types::TY_RawSIL:
+  case types::TY_SIL:
+    break;
+  default:
+    return None;
+  }
+
+  for (types::ID type : {types::TY_SerializedDiagnostics,
+                         types::TY_Remapping,
+                         types::TY_ObjCHeader}) {
+    if (!Output.getAdditionalOutputForType(type).empty())
+      return None;
+  }
+
+  unsigned Signature = Output.getPrimaryOutputType();
+  for (types::ID type : {types::TY_SwiftModuleFile,
+                         types::TY_SwiftModuleDocFile,
+                         types::TY_Dependencies,
+                         types::TY_SwiftDeps}) {
+    Signature <<= 1;
+    if (!Output.getAdditionalOutputForType(type).empty())
+      Signature |= 1;
+  }
+  return Signature;
+}
+
 int Compilation::performJobsImpl() {
   // Create a TaskQueue for execution.
   std::unique_ptr<TaskQueue> TQ;
   if (SkipTaskExecution)
     TQ.reset(new DummyTaskQueue(NumberOfParallelCommands));
   else
-    TQ.reset(new TaskQueue(NumberOfParallelCommands));
+    TQ.reset(new TaskQueue(NumberOfParallelCommands, JobMemoryLimit));
+
+  // Until a job of each kind finishes, expect it to use as much memory as
+  // the largest one of that kind in the last build. (Kinds which don't run
+  // this time keep their history.)
+  if (!CompilationRecordPath.empty()) {
+    JobMemoryMap JobMemory;
+    readJobHistory(getJobMemoryPath(CompilationRecordPath), JobMemory);
+    for (auto &entry : JobMemory)
+      TQ->setPeakMemoryUsage(entry.getKey(), entry.getValue());
+  }
 
   PerformJobsState State;
 
+  // Load how long each job took last time, so that the jobs on the longest
+  // paths through the build can be started first. When the jobs run one at a
+  // time, or can all run at once, the order doesn't matter, so keep it
+  // predictable.
+  JobTimingMap JobTimings;
+  llvm::DenseMap<const Job *, unsigned> JobPriorities;
+  if (!CompilationRecordPath.empty()) {
+    readJobHistory(getJobTimingsPath(CompilationRecordPath), JobTimings);
+
+    unsigned NumTimedJobs = 0;
+    for (const Job *Cmd : getJobs())
+      if (!getJobTimingKey(Cmd).empty())
+        ++NumTimedJobs;
+    unsigned NumParallelTasks = TQ->getNumberOfParallelTasks();
+    if (!JobTimings.empty() && NumParallelTasks > 1 &&
+        NumTimedJobs > NumParallelTasks)
+      computeJobPriorities(getJobs(), JobTimings, JobPriorities);
+  }
+  llvm::DenseMap<const Job *, std::chrono::steady_clock::time_point>
+    JobStartTimes;
+
   using DependencyGraph = DependencyGraph<const Job *>;
   DependencyGraph DepGraph;
   SmallPtrSet<const Job *, 16> DeferredCommands;
   SmallVector<const Job *, 16> InitialOutOfDateCommands;
 
+  // The interface hashes of the external dependencies as of the start of the
+  // build, for the next build to compare against. Dependencies which only
+  // turn up while the build runs were read too late to be trusted, and fall
+  // back to their modification times next time.
+  llvm::StringMap<std::string> ExternalInterfaceHashes;
+
   DependencyGraph::MarkTracer ActualIncrementalTracer;
   DependencyGraph::MarkTracer *IncrementalTracer = nullptr;
   if (ShowIncrementalBuildDecisions)
     IncrementalTracer = &ActualIncrementalTracer;
 
+  // Dependencies files are read through the state cache if there is one.
+  // A job's outputs are dropped from the cache as soon as it finishes (see
+  // taskFinished), so a reloaded file is always the one it just wrote.
+  auto loadDependencies = [&](const Job *Cmd, StringRef DependenciesFile) {
+    if (StateCache)
+      if (llvm::MemoryBuffer *Buffer = StateCache->getBuffer(DependenciesFile))
+        return DepGraph.loadFromBuffer(Cmd, *Buffer);
+    return DepGraph.loadFromPath(Cmd, DependenciesFile);
+  };
+
   auto noteBuilding = [&] (const Job *cmd, StringRef reason) {
     if (!ShowIncrementalBuildDecisions)
       return;
@@ -307,8 +617,78 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
+
+    if (Cache && isa<CompileJobAction>(Cmd->getSource())) {
+      std::string Key = Cache->computeKey(*Cmd, [&](StringRef Path) {
+        return isTemporaryFile(Path);
+      });
+      std::string CachedOutput;
+      if (Cache->restore(*Cmd, Key, CachedOutput)) {
+        State.RestoredCommands.insert(Cmd);
+        State.CachedCommands.push_back({Cmd, std::move(CachedOutput)});
+        return;
+      }
+      State.CacheKeys[Cmd] = std::move(Key);
+    }
+
+    if (getBatchModeEnabled() && getBatchSignature(Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
+
     TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+                (void *)Cmd, JobPriorities.lookup(Cmd),
+                Cmd->getSource().getClassName());
+  };
+
+  // In batch mode, hand the pending compile jobs to the TaskQueue, grouped
+  // into as many batches as there are parallel tasks (but none bigger than
+  // MaxBatchSize). Only jobs with the same kinds of outputs are grouped.
+  auto schedulePendingBatches = [&] {
+    if (State.PendingBatchableCommands.empty())
+      return;
+
+    llvm::MapVector<unsigned, SmallVector<const Job *, 16>> Groups;
+    for (const Job *Cmd : State.PendingBatchableCommands)
+      Groups[*getBatchSignature(Cmd)].push_back(Cmd);
+    State.PendingBatchableCommands.clear();
+
+    for (auto &Group : Groups) {
+      ArrayRef<const Job *> Cmds = Group.second;
+      size_t NumBatches = std::max<size_t>(
+          TQ->getNumberOfParallelTasks(),
+          (Cmds.size() + MaxBatchSize - 1) / MaxBatchSize);
+      NumBatches = std::min(NumBatches, Cmds.size());
+      size_t BatchSize = (Cmds.size() + NumBatches - 1) / NumBatches;
+
+      while (!Cmds.empty()) {
+        ArrayRef<const Job *> Batch =
+            Cmds.slice(0, std::min(BatchSize, Cmds.size()));
+        Cmds = Cmds.slice(Batch.size());
+
+        if (Batch.size() == 1) {
+          const Job *Cmd = Batch.front();
+          TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                      (void *)Cmd, JobPriorities.lookup(Cmd),
+                      Cmd->getSource().getClassName());
+          continue;
+        }
+
+        unsigned Priority = 0;
+        for (const Job *Cmd : Batch)
+          Priority = std::max(Priority, JobPriorities.lookup(Cmd));
+
+        std::unique_ptr<Job> BatchCmd =
+            BatchModeToolChain->constructBatchJob(Batch, *this,
+                                                  *BatchModeOutputInfo);
+        TQ->addTask(BatchCmd->getExecutable(), BatchCmd->getArguments(),
+                    llvm::None, (void *)BatchCmd.get(), Priority,
+                    BatchCmd->getSource().getClassName());
+        State.BatchConstituents[BatchCmd.get()].assign(Batch.begin(),
+                                                       Batch.end());
+        State.BatchJobs.push_back(std::move(BatchCmd));
+      }
+    }
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -344,7 +724,7 @@ int Compilation::performJobsImpl() {
       if (Cmd->getCondition() == Job::Condition::NewlyAdded) {
         DepGraph.addIndependentNode(Cmd);
       } else {
-        switch (DepGraph.loadFromPath(Cmd, DependenciesFile)) {
+        switch (loadDependencies(Cmd, DependenciesFile)) {
         case DependencyGraphImpl::LoadResult::HadError:
           disableIncrementalBuild();
           for (const Job *Cmd : DeferredCommands)
@@ -397,9 +777,26 @@ int Compilation::performJobsImpl() {
     // Check all cross-module dependencies as well.
     for (StringRef dependency : DepGraph.getExternalDependencies()) {
       llvm::sys::fs::file_status depStatus;
-      if (!llvm::sys::fs::status(dependency, depStatus))
-        if (depStatus.getLastModificationTime() < LastBuildTime)
+      if (!(StateCache ? StateCache->getStatus(dependency, depStatus)
+                       : llvm::sys::fs::status(dependency, depStatus))) {
+        if (depStatus.getLastModificationTime() < LastBuildTime) {
+          auto previousHash = PreviousExternalInterfaceHashes.find(dependency);
+          if (previousHash != PreviousExternalInterfaceHashes.end())
+            ExternalInterfaceHashes[dependency] = previousHash->getValue();
           continue;
+        }
+
+        // A module which was rebuilt without changing its interface doesn't
+        // affect the files which use it.
+        std::string hash = readInterfaceHash(dependency);
+        if (!hash.empty()) {
+          bool unchanged =
+              (hash == PreviousExternalInterfaceHashes.lookup(dependency));
+          ExternalInterfaceHashes[dependency] = std::move(hash);
+          if (unchanged)
+            continue;
+        }
+      }
 
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
@@ -425,9 +822,10 @@ int Compilation::performJobsImpl() {
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    JobStartTimes[BeganCmd] = std::chrono::steady_clock::now();
 
     // For verbose output, print out each command as it begins execution.
     if (Level == OutputLevel::Verbose)
@@ -443,11 +841,20 @@ int Compilation::performJobsImpl() {
   // to run.
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
                            void *Context) -> TaskFinishedResponse {
-    const Job *FinishedCmd = (const Job *)Context;
+    const Job *FinishedTask = (const Job *)Context;
+
+    // Whether or not it succeeded, the task may have rewritten its outputs.
+    if (StateCache) {
+      StateCache->outputsChanged(FinishedTask->getOutput());
+      auto Constituents = State.BatchConstituents.find(FinishedTask);
+      if (Constituents != State.BatchConstituents.end())
+        for (const Job *Cmd : Constituents->second)
+          StateCache->outputsChanged(Cmd->getOutput());
+    }
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
+      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedTask, Pid,
                                             ReturnCode, Output);
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
@@ -465,10 +872,10 @@ int Compilation::performJobsImpl() {
       if (Result == EXIT_SUCCESS)
         Result = ReturnCode;
 
-      if (!isa<CompileJobAction>(FinishedCmd->getSource()) ||
+      if (!isa<CompileJobAction>(FinishedTask->getSource()) ||
           ReturnCode != EXIT_FAILURE) {
         Diags.diagnose(SourceLoc(), diag::error_command_failed,
-                       FinishedCmd->getSource().getClassName(),
+                       FinishedTask->getSource().getClassName(),
                        ReturnCode);
       }
 
@@ -477,45 +884,74 @@ int Compilation::performJobsImpl() {
           TaskFinishedResponse::StopExecution;
     }
 
-    // When a task finishes, we need to reevaluate the other commands that
-    // might have been blocked.
-    markFinished(FinishedCmd);
-
-    // In order to handle both old dependencies that have disappeared and new
-    // dependencies that have arisen, we need to reload the dependency file.
-    if (getIncrementalBuildEnabled()) {
-      const CommandOutput &Output = FinishedCmd->getOutput();
-      StringRef DependenciesFile =
-        Output.getAdditionalOutputForType(types::TY_SwiftDeps);
-      if (!DependenciesFile.empty()) {
-        SmallVector<const Job *, 16> Dependents;
-        bool wasCascading = DepGraph.isMarked(FinishedCmd);
-
-        switch (DepGraph.loadFromPath(FinishedCmd, DependenciesFile)) {
-        case DependencyGraphImpl::LoadResult::HadError:
-          disableIncrementalBuild();
-          for (const Job *Cmd : DeferredCommands)
-            scheduleCommandIfNecessaryAndPossible(Cmd);
-          DeferredCommands.clear();
-          Dependents.clear();
-          break;
-        case DependencyGraphImpl::LoadResult::UpToDate:
-          if (!wasCascading)
+    // A batch task finishes all of the jobs it was made from at once.
+    SmallVector<const Job *, 8> FinishedCmds;
+    auto Constituents = State.BatchConstituents.find(FinishedTask);
+    if (Constituents != State.BatchConstituents.end())
+      FinishedCmds = Constituents->second;
+    else
+      FinishedCmds.push_back(FinishedTask);
+
+    // Charge each file in a batch an equal share of the batch's time.
+    auto Elapsed = std::chrono::steady_clock::now() -
+                   JobStartTimes.lookup(FinishedTask);
+    unsigned ElapsedPerCmd = std::chrono::duration_cast<
+        std::chrono::milliseconds>(Elapsed).count() / FinishedCmds.size();
+
+    for (const Job *FinishedCmd : FinishedCmds) {
+      // Jobs restored from the cache didn't take any time.
+      StringRef TimingKey = getJobTimingKey(FinishedCmd);
+      if (!TimingKey.empty() && !State.RestoredCommands.count(FinishedCmd))
+        JobTimings[TimingKey] = ElapsedPerCmd;
+
+      // The output of a batch can't be split between its jobs, so they are
+      // only stored if there wasn't any.
+      auto CacheKey = State.CacheKeys.find(FinishedCmd);
+      if (CacheKey != State.CacheKeys.end() &&
+          (FinishedCmds.size() == 1 || Output.empty()))
+        Cache->store(*FinishedCmd, CacheKey->second, Output);
+
+      // When a task finishes, we need to reevaluate the other commands that
+      // might have been blocked.
+      markFinished(FinishedCmd);
+
+      // In order to handle both old dependencies that have disappeared and new
+      // dependencies that have arisen, we need to reload the dependency file.
+      if (getIncrementalBuildEnabled()) {
+        const CommandOutput &Output = FinishedCmd->getOutput();
+        StringRef DependenciesFile =
+          Output.getAdditionalOutputForType(types::TY_SwiftDeps);
+        if (!DependenciesFile.empty()) {
+          SmallVector<const Job *, 16> Dependents;
+          bool wasCascading = DepGraph.isMarked(FinishedCmd);
+
+          switch (loadDependencies(FinishedCmd, DependenciesFile)) {
+          case DependencyGraphImpl::LoadResult::HadError:
+            disableIncrementalBuild();
+            for (const Job *Cmd : DeferredCommands)
+              scheduleCommandIfNecessaryAndPossible(Cmd);
+            DeferredCommands.clear();
+            Dependents.clear();
             break;
-          SWIFT_FALLTHROUGH;
-        case DependencyGraphImpl::LoadResult::AffectsDownstream:
-          DepGraph.markTransitive(Dependents, FinishedCmd);
-          break;
-        }
+          case DependencyGraphImpl::LoadResult::UpToDate:
+            if (!wasCascading)
+              break;
+            SWIFT_FALLTHROUGH;
+          case DependencyGraphImpl::LoadResult::AffectsDownstream:
+            DepGraph.markTransitive(Dependents, FinishedCmd);
+            break;
+          }
 
-        for (const Job *Cmd : Dependents) {
-          DeferredCommands.erase(Cmd);
-          noteBuilding(Cmd, "because of dependencies discovered later");
-          scheduleCommandIfNecessaryAndPossible(Cmd);
+          for (const Job *Cmd : Dependents) {
+            DeferredCommands.erase(Cmd);
+            noteBuilding(Cmd, "because of dependencies discovered later");
+            scheduleCommandIfNecessaryAndPossible(Cmd);
+          }
         }
       }
     }
 
+    schedulePendingBatches();
     return TaskFinishedResponse::ContinueExecution;
   };
 
@@ -547,9 +983,24 @@ int Compilation::performJobsImpl() {
     return TaskFinishedResponse::StopExecution;
   };
 
+  // Jobs restored from the cache finish as if they had run, which may
+  // schedule more jobs of either kind.
+  auto finishCachedCommands = [&] {
+    while (!State.CachedCommands.empty()) {
+      auto Cached = State.CachedCommands.pop_back_val();
+      taskBegan(0, (void *)Cached.first);
+      taskFinished(0, EXIT_SUCCESS, Cached.second, (void *)Cached.first);
+    }
+  };
+
+  schedulePendingBatches();
+
   do {
     // Ask the TaskQueue to execute.
-    TQ->execute(taskBegan, taskFinished, taskSignalled);
+    do {
+      finishCachedCommands();
+      TQ->execute(taskBegan, taskFinished, taskSignalled);
+    } while (Result == 0 && !State.CachedCommands.empty());
 
     // Mark all remaining deferred commands as skipped.
     for (const Job *Cmd : DeferredCommands) {
@@ -562,9 +1013,11 @@ int Compilation::performJobsImpl() {
       State.ScheduledCommands.insert(Cmd);
       markFinished(Cmd);
     }
+    schedulePendingBatches();
 
     // ...which may allow us to go on and do later tasks.
-  } while (Result == 0 && TQ->hasRemainingTasks());
+  } while (Result == 0 &&
+           (TQ->hasRemainingTasks() || !State.CachedCommands.empty()));
 
   if (Result == 0) {
     assert(State.BlockingCommands.empty() &&
@@ -596,7 +1049,18 @@ int Compilation::performJobsImpl() {
     populateInputInfoMap(InputInfo, State);
     checkForOutOfDateInputs(Diags, InputInfo);
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, ExternalInterfaceHashes);
+
+    // Only keep timings for files that are still part of the build.
+    JobTimingMap CurrentTimings;
+    for (const Job *Cmd : getJobs()) {
+      auto Timing = JobTimings.find(getJobTimingKey(Cmd));
+      if (Timing != JobTimings.end())
+        CurrentTimings[Timing->getKey()] = Timing->getValue();
+    }
+    writeJobHistory(getJobTimingsPath(CompilationRecordPath), CurrentTimings);
+    writeJobHistory(getJobMemoryPath(CompilationRecordPath),
+                    TQ->getPeakMemoryUsage());
   }
 
   if (Result == 0)
@@ -657,11 +1121,50 @@ static bool writeAllSourcesFile(DiagnosticEngine &diags, StringRef path,
   return true;
 }
 
+static bool writeSearchPathListing(DiagnosticEngine &diags, StringRef path,
+                                   const ArgList &args) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    out.clear_error();
+    diags.diagnose(SourceLoc(), diag::error_unable_to_make_temporary_file,
+                   error.message());
+    return false;
+  }
+
+  llvm::StringSet<> seenDirectories;
+  for (const Arg *A : args.filtered(options::OPT_I, options::OPT_F)) {
+    StringRef directory = A->getValue();
+    if (!seenDirectories.insert(directory).second)
+      continue;
+
+    // A directory which can't be read completely is left out, so the
+    // frontend will look in it as usual.
+    SmallVector<std::string, 32> entries;
+    std::error_code error;
+    llvm::sys::fs::directory_iterator it(directory, error), end;
+    for (; !error && it != end; it.increment(error))
+      entries.push_back(llvm::sys::path::filename(it->path()));
+    if (error)
+      continue;
+
+    out << directory << "\n";
+    for (StringRef entry : entries)
+      out << "\t" << entry << "\n";
+  }
+
+  return true;
+}
+
 int Compilation::performJobs() {
   if (AllSourceFilesPath)
     if (!writeAllSourcesFile(Diags, AllSourceFilesPath, getInputFiles()))
       return EXIT_FAILURE;
 
+  if (SearchPathListingPath)
+    if (!writeSearchPathListing(Diags, SearchPathListingPath, getArgs()))
+      return EXIT_FAILURE;
+
   // If we don't have to do any cleanup work, just exec the subprocess.
   if (Level < OutputLevel::Parseable &&
       (SaveTemps || TempFilePaths.empty()) &&
@@ -706,3 +1209,22 @@ const char *Compilation::getAllSourcesPath() const {
   }
   return AllSourceFilesPath;
 }
+
+const char *Compilation::getSearchPathListingPath() const {
+  if (!SearchPathListingPath) {
+    SmallString<128> Buffer;
+    std::error_code EC =
+        llvm::sys::fs::createTemporaryFile("search-paths", "", Buffer);
+    if (EC) {
+      Diags.diagnose(SourceLoc(),
+                     diag::error_unable_to_make_temporary_file,
+                     EC.message());
+      // FIXME: This should not take down the entire process.
+      llvm::report_fatal_error("unable to create listing of search paths");
+    }
+    auto *mutableThis = const_cast<Compilation *>(this);
+    mutableThis->addTemporaryFile(Buffer.str());
+    mutableThis->SearchPathListingPath = getArgs().MakeArgString(Buffer);
+  }
+  return SearchPathListingPath;
+}
@@ -0,0 +1,238 @@
+//===--- CompilationCache.cpp - Reuse the outputs of compile jobs ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/CompilationCache.h"
+#include "swift/Basic/Version.h"
+#include "swift/Driver/Job.h"
+#include "swift/Driver/Types.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace swift;
+using namespace swift::driver;
+
+CompilationCacheStore::~CompilationCacheStore() = default;
+
+static void getEntryPath(SmallVectorImpl<char> &path, StringRef directory,
+                         StringRef key, const llvm::Twine &suffix) {
+  path.assign(directory.begin(), directory.end());
+  llvm::sys::path::append(path, key + "." + suffix);
+}
+
+/// Adds the file at \p entryPath to the store, using \p write to fill in a
+/// temporary file which is then renamed, so that concurrent builds never see
+/// a partially written entry.
+static bool
+writeEntry(StringRef entryPath,
+           llvm::function_ref<std::error_code(StringRef)> write) {
+  SmallString<128> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(entryPath + "-%%%%%%%%.tmp", tmpPath))
+    return false;
+
+  if (write(tmpPath) || llvm::sys::fs::rename(tmpPath, entryPath)) {
+    llvm::sys::fs::remove(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+bool LocalCompilationCacheStore::restore(StringRef key,
+                                         ArrayRef<std::string> outputPaths,
+                                         std::string &output) {
+  // The output entry is written last, so if it's there, so are the files.
+  SmallString<128> path;
+  getEntryPath(path, Directory, key, "output");
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return false;
+
+  for (size_t i = 0, e = outputPaths.size(); i != e; ++i) {
+    getEntryPath(path, Directory, key, llvm::Twine(i));
+    if (llvm::sys::fs::copy_file(path, outputPaths[i]))
+      return false;
+  }
+
+  output = buffer.get()->getBuffer();
+  return true;
+}
+
+void LocalCompilationCacheStore::store(StringRef key,
+                                       ArrayRef<std::string> outputPaths,
+                                       StringRef output) {
+  // Errors are ignored: the entry is just not stored.
+  if (llvm::sys::fs::create_directories(Directory))
+    return;
+
+  SmallString<128> path;
+  for (size_t i = 0, e = outputPaths.size(); i != e; ++i) {
+    getEntryPath(path, Directory, key, llvm::Twine(i));
+    bool stored = writeEntry(path, [&](StringRef tmpPath) {
+      return llvm::sys::fs::copy_file(outputPaths[i], tmpPath);
+    });
+    if (!stored)
+      return;
+  }
+
+  getEntryPath(path, Directory, key, "output");
+  writeEntry(path, [&](StringRef tmpPath) {
+    std::error_code error;
+    llvm::raw_fd_ostream out(tmpPath, error, llvm::sys::fs::F_None);
+    if (error)
+      return error;
+    out << output;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      return std::make_error_code(std::errc::io_error);
+    }
+    return std::error_code();
+  });
+}
+
+/// Returns the paths of all of the outputs of a job, in a fixed order.
+static void getOutputPaths(const CommandOutput &output,
+                           SmallVectorImpl<std::string> &paths) {
+  for (const std::string &path : output.getPrimaryOutputFilenames())
+    paths.push_back(path);
+  types::forAllTypes([&](types::ID type) {
+    const std::string &path = output.getAdditionalOutputForType(type);
+    if (!path.empty())
+      paths.push_back(path);
+  });
+}
+
+static bool hashFileContents(llvm::MD5 &hash, StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return false;
+  hash.update(buffer.get()->getBuffer());
+  return true;
+}
+
+/// Appends the paths of the modules in \p directory to \p paths, including
+/// the files inside module directories.
+static void collectModuleFiles(StringRef directory,
+                               SmallVectorImpl<std::string> &paths,
+                               bool inModuleDirectory = false) {
+  std::error_code error;
+  for (llvm::sys::fs::directory_iterator it(directory, error), end;
+       !error && it != end; it.increment(error)) {
+    StringRef path = it->path();
+    if (!inModuleDirectory &&
+        llvm::sys::path::extension(path) != ".swiftmodule")
+      continue;
+
+    llvm::sys::fs::file_status status;
+    if (it->status(status))
+      continue;
+    if (llvm::sys::fs::is_directory(status)) {
+      if (!inModuleDirectory)
+        collectModuleFiles(path, paths, /*inModuleDirectory=*/true);
+    } else {
+      paths.push_back(path);
+    }
+  }
+}
+
+StringRef CompilationCache::getContentHash(StringRef path) {
+  auto inserted = ContentHashes.insert({path, std::string()});
+  std::string &result = inserted.first->getValue();
+  if (!inserted.second)
+    return result;
+
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status))
+    return result;
+
+  llvm::MD5 hash;
+  if (llvm::sys::fs::is_directory(status)) {
+    // The directory may be an import search path, so the modules in it are
+    // part of the key (and nothing else is, to keep it cheap).
+    SmallVector<std::string, 16> moduleFiles;
+    collectModuleFiles(path, moduleFiles);
+    std::sort(moduleFiles.begin(), moduleFiles.end());
+    for (StringRef moduleFile : moduleFiles) {
+      hash.update(moduleFile.substr(path.size()));
+      if (!hashFileContents(hash, moduleFile))
+        return result;
+    }
+  } else if (!llvm::sys::fs::is_regular_file(status) ||
+             !hashFileContents(hash, path)) {
+    return result;
+  }
+
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  SmallString<32> hashStr;
+  llvm::MD5::stringifyResult(hashBuf, hashStr);
+  result = hashStr.str();
+  return result;
+}
+
+std::string
+CompilationCache::computeKey(const Job &cmd,
+                             llvm::function_ref<bool(StringRef)> isTemporary) {
+  SmallVector<std::string, 8> outputPaths;
+  getOutputPaths(cmd.getOutput(), outputPaths);
+
+  llvm::MD5 hash;
+  auto addString = [&](StringRef str) {
+    hash.update(str);
+    hash.update(StringRef("\0", 1));
+  };
+
+  addString(version::getSwiftFullVersion());
+  addString(llvm::sys::path::filename(cmd.getExecutable()));
+  for (StringRef arg : cmd.getArguments()) {
+    if (std::find(outputPaths.begin(), outputPaths.end(),
+                  arg) != outputPaths.end()) {
+      addString("<output>");
+      continue;
+    }
+    if (arg.startswith("-")) {
+      addString(arg);
+      continue;
+    }
+
+    // Paths of temporary files change from one build to the next, but their
+    // contents don't.
+    addString(isTemporary(arg) ? "<temporary>" : arg);
+    addString(getContentHash(arg));
+  }
+
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  SmallString<32> hashStr;
+  llvm::MD5::stringifyResult(hashBuf, hashStr);
+  return hashStr.str();
+}
+
+bool CompilationCache::restore(const Job &cmd, StringRef key,
+                               std::string &output) {
+  SmallVector<std::string, 8> outputPaths;
+  getOutputPaths(cmd.getOutput(), outputPaths);
+  return Store->restore(key, outputPaths, output);
+}
+
+void CompilationCache::store(const Job &cmd, StringRef key, StringRef output) {
+  SmallVector<std::string, 8> outputPaths;
+  getOutputPaths(cmd.getOutput(), outputPaths);
+  for (const std::string &path : outputPaths)
+    if (!llvm::sys::fs::exists(path))
+      return;
+  Store->store(key, outputPaths, output);
+}
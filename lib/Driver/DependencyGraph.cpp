@@ -12,9 +12,9 @@
 
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/ReferenceDependencies.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
-#include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -48,15 +48,147 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using FingerprintCallbackTy = LoadResult(StringRef, DependencyKind, StringRef);
+using reference_dependencies::Section;
+
+/// Returns the key used to look up the fingerprint of a "provides" entry.
+static std::string getFingerprintKey(DependencyKind kind, StringRef name) {
+  std::string key;
+  key.reserve(name.size() + 1);
+  key.push_back(static_cast<char>(kind));
+  key += name;
+  return key;
+}
+
+namespace {
+/// The callbacks invoked for the entries of a dependencies file.
+struct DependencyFileCallbacks {
+  llvm::function_ref<DependencyCallbackTy> provides;
+  llvm::function_ref<DependencyCallbackTy> depends;
+  llvm::function_ref<InterfaceHashCallbackTy> interfaceHash;
+  llvm::function_ref<FingerprintCallbackTy> fingerprint;
+};
+} // end anonymous namespace
+
+/// Passes a single entry of a dependencies file, in either format, to the
+/// appropriate callback.
+static LoadResult handleEntry(Section section, ArrayRef<StringRef> names,
+                              bool isCascading,
+                              const DependencyFileCallbacks &callbacks) {
+  assert(names.size() == reference_dependencies::getNumNamesPerEntry(section));
+
+  enum class EntryKind { Provides, Depends, Fingerprint };
+  DependencyKind kind;
+  EntryKind entryKind;
+  switch (section) {
+  case Section::InterfaceHash:
+    return callbacks.interfaceHash(names.front());
+  case Section::ProvidesTopLevel:
+    kind = DependencyKind::TopLevelName;
+    entryKind = EntryKind::Provides;
+    break;
+  case Section::ProvidesNominal:
+    kind = DependencyKind::NominalType;
+    entryKind = EntryKind::Provides;
+    break;
+  case Section::ProvidesMember:
+    kind = DependencyKind::NominalTypeMember;
+    entryKind = EntryKind::Provides;
+    break;
+  case Section::ProvidesDynamicLookup:
+    kind = DependencyKind::DynamicLookupName;
+    entryKind = EntryKind::Provides;
+    break;
+  case Section::DependsTopLevel:
+    kind = DependencyKind::TopLevelName;
+    entryKind = EntryKind::Depends;
+    break;
+  case Section::DependsNominal:
+    kind = DependencyKind::NominalType;
+    entryKind = EntryKind::Depends;
+    break;
+  case Section::DependsMember:
+    kind = DependencyKind::NominalTypeMember;
+    entryKind = EntryKind::Depends;
+    break;
+  case Section::DependsDynamicLookup:
+    kind = DependencyKind::DynamicLookupName;
+    entryKind = EntryKind::Depends;
+    break;
+  case Section::DependsExternal:
+    kind = DependencyKind::ExternalFile;
+    entryKind = EntryKind::Depends;
+    break;
+  case Section::FingerprintsTopLevel:
+    kind = DependencyKind::TopLevelName;
+    entryKind = EntryKind::Fingerprint;
+    break;
+  case Section::FingerprintsNominal:
+    kind = DependencyKind::NominalType;
+    entryKind = EntryKind::Fingerprint;
+    break;
+  case Section::FingerprintsMember:
+    kind = DependencyKind::NominalTypeMember;
+    entryKind = EntryKind::Fingerprint;
+    break;
+  }
+
+  // Member entries come in the form ["{MangledBaseName}", "memberName"].
+  // Smash the type and member names together so we can continue using
+  // StringMap.
+  SmallString<64> appended;
+  StringRef name = names.front();
+  if (kind == DependencyKind::NominalTypeMember) {
+    appended += names[0];
+    appended.push_back('\0');
+    appended += names[1];
+    name = appended.str();
+  }
+
+  switch (entryKind) {
+  case EntryKind::Provides:
+    return callbacks.provides(name, kind, isCascading);
+  case EntryKind::Depends:
+    return callbacks.depends(name, kind, isCascading);
+  case EntryKind::Fingerprint:
+    return callbacks.fingerprint(name, kind, names.back());
+  }
+  llvm_unreachable("unhandled entry kind");
+}
+
+static LoadResult
+parseBinaryDependencyFile(StringRef contents,
+                          const DependencyFileCallbacks &callbacks) {
+  LoadResult result = LoadResult::UpToDate;
+  bool hadError = reference_dependencies::readBinaryFile(contents,
+      [&](Section section, ArrayRef<StringRef> names,
+          bool isCascading) -> bool {
+    switch (handleEntry(section, names, isCascading, callbacks)) {
+    case LoadResult::HadError:
+      return true;
+    case LoadResult::UpToDate:
+      return false;
+    case LoadResult::AffectsDownstream:
+      result = LoadResult::AffectsDownstream;
+      return false;
+    }
+    llvm_unreachable("unhandled load result");
+  });
+
+  if (hadError)
+    return LoadResult::HadError;
+  return result;
+}
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
-                    llvm::function_ref<DependencyCallbackTy> providesCallback,
-                    llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    const DependencyFileCallbacks &callbacks) {
   namespace yaml = llvm::yaml;
 
-  // FIXME: Switch to a format other than YAML.
+  // The binary format can be read in place.
+  if (reference_dependencies::isBinaryFile(buffer.getBuffer()))
+    return parseBinaryDependencyFile(buffer.getBuffer(), callbacks);
+
   llvm::SourceMgr SM;
   yaml::Stream stream(buffer.getMemBufferRef(), SM);
   auto I = stream.begin();
@@ -97,109 +229,64 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       return LoadResult::HadError;
     StringRef keyString = key->getValue(scratch);
 
-    if (keyString == "interface-hash") {
+    Optional<Section> section =
+        reference_dependencies::getSectionForName(keyString);
+    if (!section)
+      return LoadResult::HadError;
+
+    if (*section == Section::InterfaceHash) {
       auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
       if (!value)
         return LoadResult::HadError;
 
       StringRef valueString = value->getValue(scratch);
-      UPDATE_RESULT(interfaceHashCallback(valueString));
-
-    } else {
-      enum class DependencyDirection : bool {
-        Depends,
-        Provides
-      };
-      using KindPair = std::pair<DependencyKind, DependencyDirection>;
-
-      KindPair dirAndKind = llvm::StringSwitch<KindPair>(key->getValue(scratch))
-        .Case("depends-top-level",
-              std::make_pair(DependencyKind::TopLevelName,
-                             DependencyDirection::Depends))
-        .Case("depends-nominal",
-              std::make_pair(DependencyKind::NominalType,
-                             DependencyDirection::Depends))
-        .Case("depends-member",
-              std::make_pair(DependencyKind::NominalTypeMember,
-                             DependencyDirection::Depends))
-        .Case("depends-dynamic-lookup",
-              std::make_pair(DependencyKind::DynamicLookupName,
-                             DependencyDirection::Depends))
-        .Case("depends-external",
-              std::make_pair(DependencyKind::ExternalFile,
-                             DependencyDirection::Depends))
-        .Case("provides-top-level",
-              std::make_pair(DependencyKind::TopLevelName,
-                             DependencyDirection::Provides))
-        .Case("provides-nominal",
-              std::make_pair(DependencyKind::NominalType,
-                             DependencyDirection::Provides))
-        .Case("provides-member",
-              std::make_pair(DependencyKind::NominalTypeMember,
-                             DependencyDirection::Provides))
-        .Case("provides-dynamic-lookup",
-              std::make_pair(DependencyKind::DynamicLookupName,
-                             DependencyDirection::Provides))
-        .Default(std::make_pair(DependencyKind(),
-                                DependencyDirection::Depends));
-      if (dirAndKind.first == DependencyKind())
-        return LoadResult::HadError;
-
-      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
-      if (!entries)
-        return LoadResult::HadError;
-
-      if (dirAndKind.first == DependencyKind::NominalTypeMember) {
-        // Handle member dependencies specially. Rather than being a single
-        // string, they come in the form ["{MangledBaseName}", "memberName"].
-        for (yaml::Node &rawEntry : *entries) {
-          bool isCascading = rawEntry.getRawTag() != "!private";
-
-          auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
-          if (!entry)
-            return LoadResult::HadError;
+      UPDATE_RESULT(handleEntry(*section, valueString, /*isCascading=*/true,
+                                callbacks));
+      continue;
+    }
 
-          auto iter = entry->begin();
-          auto *base = dyn_cast<yaml::ScalarNode>(&*iter);
-          if (!base)
-            return LoadResult::HadError;
-          ++iter;
+    auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+    if (!entries)
+      return LoadResult::HadError;
 
-          auto *member = dyn_cast<yaml::ScalarNode>(&*iter);
-          if (!member)
-            return LoadResult::HadError;
-          ++iter;
+    unsigned numNames = reference_dependencies::getNumNamesPerEntry(*section);
+    using reference_dependencies::binary::MaxNamesPerRecord;
 
-          // FIXME: LLVM's YAML support doesn't implement == correctly for end
-          // iterators.
-          assert(!(iter != entry->end()));
+    for (yaml::Node &rawEntry : *entries) {
+      bool isCascading = rawEntry.getRawTag() != "!private";
 
-          bool isDepends = dirAndKind.second == DependencyDirection::Depends;
-          auto &callback = isDepends ? dependsCallback : providesCallback;
+      // Each name gets its own scratch space, since they must all stay valid
+      // until the entry is handled.
+      SmallString<64> nameScratch[MaxNamesPerRecord];
+      StringRef names[MaxNamesPerRecord];
 
-          // Smash the type and member names together so we can continue using
-          // StringMap.
-          SmallString<64> appended;
-          appended += base->getValue(scratch);
-          appended.push_back('\0');
-          appended += member->getValue(scratch);
+      if (numNames == 1) {
+        auto *entry = dyn_cast<yaml::ScalarNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+        names[0] = entry->getValue(nameScratch[0]);
 
-          UPDATE_RESULT(callback(appended.str(), dirAndKind.first,
-                                 isCascading));
-        }
       } else {
-        for (const yaml::Node &rawEntry : *entries) {
-          auto *entry = dyn_cast<yaml::ScalarNode>(&rawEntry);
-          if (!entry)
+        // Multiple names come as a sequence, such as
+        // ["{MangledBaseName}", "memberName"].
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        unsigned count = 0;
+        for (yaml::Node &rawName : *entry) {
+          auto *name = dyn_cast<yaml::ScalarNode>(&rawName);
+          if (!name || count == numNames)
             return LoadResult::HadError;
-
-          bool isDepends = dirAndKind.second == DependencyDirection::Depends;
-          auto &callback = isDepends ? dependsCallback : providesCallback;
-
-          UPDATE_RESULT(callback(entry->getValue(scratch), dirAndKind.first,
-                                 entry->getRawTag() != "!private"));
+          names[count] = name->getValue(nameScratch[count]);
+          ++count;
         }
+        if (count != numNames)
+          return LoadResult::HadError;
       }
+
+      UPDATE_RESULT(handleEntry(*section, llvm::makeArrayRef(names, numNames),
+                                isCascading, callbacks));
     }
   }
 
@@ -222,9 +309,12 @@ DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
 LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
+  bool hadAffectedDependency = false;
+  bool interfaceHashChanged = false;
+  llvm::StringMap<std::string> fingerprints;
 
-  auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
-                                      bool isCascading) -> LoadResult {
+  auto dependsCallback = [this, node, &hadAffectedDependency](
+      StringRef name, DependencyKind kind, bool isCascading) -> LoadResult {
     if (kind == DependencyKind::ExternalFile)
       ExternalDependencies.insert(name);
 
@@ -245,8 +335,10 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
       iter->flags |= flags;
     }
 
-    if (isCascading && (entries.second & kind))
+    if (isCascading && (entries.second & kind)) {
+      hadAffectedDependency = true;
       return LoadResult::AffectsDownstream;
+    }
     return LoadResult::UpToDate;
   };
 
@@ -267,7 +359,8 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  auto interfaceHashCallback = [this, node](StringRef hash) -> LoadResult {
+  auto interfaceHashCallback = [this, node, &interfaceHashChanged](
+      StringRef hash) -> LoadResult {
     auto insertResult = InterfaceHashes.insert(std::make_pair(node, hash));
 
     if (insertResult.second) {
@@ -279,14 +372,46 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     auto iter = insertResult.first;
     if (hash != iter->second) {
       iter->second = hash;
+      interfaceHashChanged = true;
       return LoadResult::AffectsDownstream;
     }
 
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  auto fingerprintCallback = [&fingerprints](StringRef name,
+                                             DependencyKind kind,
+                                             StringRef fingerprint)
+      -> LoadResult {
+    fingerprints[getFingerprintKey(kind, name)] = fingerprint;
+    return LoadResult::UpToDate;
+  };
+
+  LoadResult result = parseDependencyFile(buffer, {
+    providesCallback, dependsCallback, interfaceHashCallback,
+    fingerprintCallback
+  });
+  if (result == LoadResult::HadError)
+    return result;
+
+  auto &oldFingerprints = Fingerprints[node];
+  UnchangedProvides.erase(node);
+
+  // If the interface changed, remember which entries are known to be the
+  // same as before. Anything that's new, missing, or that has no fingerprint
+  // in either version of the file is considered changed.
+  if (interfaceHashChanged && !hadAffectedDependency) {
+    auto &unchanged = UnchangedProvides[node];
+    for (auto &entry : fingerprints) {
+      auto oldEntry = oldFingerprints.find(entry.getKey());
+      if (oldEntry != oldFingerprints.end() &&
+          oldEntry->getValue() == entry.getValue())
+        unchanged.insert(entry.getKey());
+    }
+  }
+
+  oldFingerprints = std::move(fingerprints);
+  return result;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -321,6 +446,15 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
+  // If the starting node was just reloaded with per-entry fingerprints, only
+  // the entries that actually changed need to be followed from it.
+  llvm::StringSet<> unchangedProvides;
+  auto knownUnchanged = UnchangedProvides.find(node);
+  if (knownUnchanged != UnchangedProvides.end()) {
+    unchangedProvides = std::move(knownUnchanged->second);
+    UnchangedProvides.erase(knownUnchanged);
+  }
+
   auto addDependentsToWorklist = [&](const void *next,
                                      ArrayRef<MarkTracerImpl::Entry> reason) {
     auto allProvided = Provides.find(next);
@@ -328,20 +462,34 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       return;
 
     for (const auto &provided : allProvided->second) {
+      DependencyMaskTy changedKinds = provided.kindMask;
+      if (next == node && !unchangedProvides.empty()) {
+        for (auto kind : { DependencyKind::TopLevelName,
+                           DependencyKind::NominalType,
+                           DependencyKind::NominalTypeMember }) {
+          if (!changedKinds.contains(kind))
+            continue;
+          if (unchangedProvides.count(getFingerprintKey(kind, provided.name)))
+            changedKinds -= kind;
+        }
+        if (!changedKinds)
+          continue;
+      }
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
 
-      if (allDependents->second.second.contains(provided.kindMask))
+      if (allDependents->second.second.contains(changedKinds))
         continue;
 
       // Record that we've traversed this dependency.
-      allDependents->second.second |= provided.kindMask;
+      allDependents->second.second |= changedKinds;
 
       for (const auto &dependent : allDependents->second.first) {
         if (dependent.node == next)
           continue;
-        auto intersectingKinds = provided.kindMask & dependent.kindMask;
+        auto intersectingKinds = changedKinds & dependent.kindMask;
         if (!intersectingKinds)
           continue;
         if (isMarked(dependent.node))
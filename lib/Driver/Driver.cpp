@@ -27,7 +27,9 @@
 #include "swift/Basic/Version.h"
 #include "swift/Basic/Range.h"
 #include "swift/Driver/Action.h"
+#include "swift/Driver/BuildStateCache.h"
 #include "swift/Driver/Compilation.h"
+#include "swift/Driver/CompilationCache.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/OutputFileMap.h"
 #include "swift/Driver/ToolChain.h"
@@ -191,7 +193,9 @@ class Driver::InputInfoMap
 };
 using InputInfoMap = Driver::InputInfoMap;
 
-static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
+static bool populateOutOfDateMap(InputInfoMap &map,
+                                 llvm::StringMap<std::string> &externalHashes,
+                                 StringRef argsHashStr,
                                  const InputFileList &inputs,
                                  StringRef buildRecordPath) {
   // Treat a missing file as "no previous build".
@@ -316,6 +320,24 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr == "external_interface_hashes") {
+      auto *hashMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!hashMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = hashMap->begin(), e = hashMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!key || !value)
+          return true;
+
+        SmallString<64> valueScratch;
+        externalHashes[key->getValue(scratch)] =
+            value->getValue(valueScratch);
+      }
     }
   }
 
@@ -410,7 +432,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     // REPL mode expects no input files, so suppress the error.
     SuppressNoInputFilesError = true;
 
-  std::unique_ptr<OutputFileMap> OFM = buildOutputFileMap(*TranslatedArgList);
+  std::unique_ptr<OutputFileMap> OwnedOFM;
+  const OutputFileMap *OFM = buildOutputFileMap(*TranslatedArgList, OwnedOFM);
 
   if (Diags.hadAnyError())
     return nullptr;
@@ -427,6 +450,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   computeArgsHash(ArgsHash, *TranslatedArgList);
 
   InputInfoMap outOfDateMap;
+  llvm::StringMap<std::string> externalInterfaceHashes;
   bool rebuildEverything = true;
   if (Incremental) {
     if (!OFM) {
@@ -449,8 +473,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
         rebuildEverything = true;
 
       } else {
-        if (populateOutOfDateMap(outOfDateMap, ArgsHash, Inputs,
-                                 buildRecordPath)) {
+        if (populateOutOfDateMap(outOfDateMap, externalInterfaceHashes,
+                                 ArgsHash, Inputs, buildRecordPath)) {
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
           rebuildEverything = false;
@@ -461,7 +485,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
 
   // Construct the graph of Actions.
   ActionList Actions;
-  buildActions(*TC, *TranslatedArgList, Inputs, OI, OFM.get(),
+  buildActions(*TC, *TranslatedArgList, Inputs, OI, OFM,
                rebuildEverything ? nullptr : &outOfDateMap, Actions);
 
   if (Diags.hadAnyError())
@@ -481,6 +505,15 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     }
   }
 
+  uint64_t JobMemoryLimitMB = 0;
+  if (const Arg *A = ArgList->getLastArg(options::OPT_job_memory_limit)) {
+    if (StringRef(A->getValue()).getAsInteger(10, JobMemoryLimitMB)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(*ArgList), A->getValue());
+      return nullptr;
+    }
+  }
+
   OutputLevel Level = OutputLevel::Normal;
   if (const Arg *A = ArgList->getLastArg(options::OPT_v,
                                          options::OPT_parseable_output)) {
@@ -502,7 +535,28 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
                                                  DriverSkipExecution,
                                                  SaveTemps));
 
-  buildJobs(Actions, OI, OFM.get(), *TC, *C);
+  C->setBuildStateCache(StateCache);
+  C->setJobMemoryLimit(JobMemoryLimitMB * 1024 * 1024);
+
+  // Skipped jobs don't write their outputs, so they mustn't be stored.
+  const Arg *CachePathArg =
+      C->getArgs().getLastArg(options::OPT_compilation_cache_path);
+  if (CachePathArg && !DriverSkipExecution) {
+    auto Store =
+        llvm::make_unique<LocalCompilationCacheStore>(CachePathArg->getValue());
+    C->setCompilationCache(
+        llvm::make_unique<CompilationCache>(std::move(Store)));
+  }
+
+  buildJobs(Actions, OI, OFM, *TC, *C);
+
+  // Batches are formed while the jobs run, from whichever compile jobs turn
+  // out to need running, so the jobs themselves stay one per file.
+  if (C->getArgs().hasFlag(options::OPT_enable_batch_mode,
+                           options::OPT_disable_batch_mode, false) &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      !OI.isMultiThreading() && Level != OutputLevel::Parseable)
+    C->enableBatchMode(*TC, OI);
 
   // For updating code we need to go through all the files and pick up changes,
   // even if they have compiler errors.
@@ -526,6 +580,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
       auto buildEntry = outOfDateMap.find(nullptr);
       if (buildEntry != outOfDateMap.end())
         C->setLastBuildTime(buildEntry->second.previousModTime);
+      C->setPreviousExternalInterfaceHashes(
+          std::move(externalInterfaceHashes));
     }
   }
 
@@ -970,6 +1026,14 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
 
   assert(OI.CompilerOutputType != types::ID::TY_INVALID);
 
+  // A multi-threaded whole-module compilation of one object file (-c -o)
+  // produces that single object, instead of one object per input file.
+  if (OI.isMultiThreading() &&
+      OI.CompilerMode == OutputInfo::Mode::SingleCompile &&
+      OI.CompilerOutputType == types::TY_Object && !OI.shouldLink() &&
+      Args.hasArg(options::OPT_o) && !Args.hasArg(options::OPT_embed_bitcode))
+    OI.MergeThreadOutputs = true;
+
   if (const Arg *A = Args.getLastArg(options::OPT_g_Group)) {
     if (A->getOption().matches(options::OPT_g))
       OI.DebugInfoKind = IRGenDebugInfoKind::Normal;
@@ -1006,6 +1070,16 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
     return;
   }
 
+  // Emitting the module separately lets the jobs of dependent modules start
+  // as soon as it is type-checked and serialized, without waiting for code
+  // generation. This only makes sense if the compile jobs produce something
+  // other than the module.
+  OI.ShouldEmitModuleSeparately =
+      OI.ShouldGenerateModule &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      OI.CompilerOutputType != types::TY_SwiftModuleFile &&
+      Args.hasArg(options::OPT_emit_module_separately);
+
   if (const Arg *A = Args.getLastArg(options::OPT_module_name)) {
     OI.ModuleName = A->getValue();
   } else if (OI.CompilerMode == OutputInfo::Mode::REPL) {
@@ -1121,6 +1195,30 @@ void Driver::buildActions(const ToolChain &TC,
   ActionList AllModuleInputs;
   ActionList AllLinkerInputs;
 
+  // Precompile the bridging header once for all of the compile jobs. The
+  // action is owned at the top level, since they all take it as an input.
+  std::unique_ptr<JobAction> PCH;
+  bool UsedPCH = false;
+  if (Args.hasArg(options::OPT_enable_bridging_pch)) {
+    if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+      StringRef Value = A->getValue();
+      types::ID Ty =
+          TC.lookupTypeForExtension(llvm::sys::path::extension(Value));
+      if (Ty == types::TY_ObjCHeader) {
+        StringRef PersistentPCHDir =
+            Args.getLastArgValue(options::OPT_pch_output_dir);
+        PCH.reset(new GeneratePCHJobAction(new InputAction(*A, Ty),
+                                           PersistentPCHDir));
+      }
+    }
+  }
+  auto addPCHInput = [&](JobAction *CompileAction) {
+    if (!PCH)
+      return;
+    CompileAction->addSharedInput(PCH.get());
+    UsedPCH = true;
+  };
+
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
@@ -1142,18 +1240,26 @@ void Driver::buildActions(const ToolChain &TC,
         };
         if (OutOfDateMap)
           previousBuildState = OutOfDateMap->lookup(InputArg);
+        // A separately emitted module is built from the sources themselves,
+        // rather than from the partial modules of the compile jobs.
+        if (OI.ShouldEmitModuleSeparately)
+          AllModuleInputs.push_back(Current.get());
         if (Args.hasArg(options::OPT_embed_bitcode)) {
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
-          AllModuleInputs.push_back(Current.get());
+          addPCHInput(cast<JobAction>(Current.get()));
+          if (!OI.ShouldEmitModuleSeparately)
+            AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
         } else {
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
-          AllModuleInputs.push_back(Current.get());
+          addPCHInput(cast<JobAction>(Current.get()));
+          if (!OI.ShouldEmitModuleSeparately)
+            AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
         break;
@@ -1185,6 +1291,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1224,7 +1331,7 @@ void Driver::buildActions(const ToolChain &TC,
           const Arg *InputArg = Input.second;
 
           CA->addInput(new InputAction(*InputArg, InputType));
-          if (OI.isMultiThreading()) {
+          if (OI.hasOutputPerThread()) {
             // With multi-threading we need a backend job for each output file
             // of the compilation.
             auto *BJA = new BackendJobAction(CA.get(), OI.CompilerOutputType,
@@ -1236,8 +1343,9 @@ void Driver::buildActions(const ToolChain &TC,
           }
           InputIndex++;
         }
+        addPCHInput(CA.get());
         Action *CAReleased = CA.release();
-        if (!OI.isMultiThreading()) {
+        if (!OI.hasOutputPerThread()) {
           // No multi-threading: the compilation only produces a single output
           // file.
           CA.reset(new BackendJobAction(CAReleased,
@@ -1256,6 +1364,7 @@ void Driver::buildActions(const ToolChain &TC,
 
       CA->addInput(new InputAction(*InputArg, InputType));
     }
+    addPCHInput(CA.get());
     AllModuleInputs.push_back(CA.get());
     AllLinkerInputs.push_back(CA.release());
     break;
@@ -1296,6 +1405,9 @@ void Driver::buildActions(const ToolChain &TC,
   }
   }
 
+  if (UsedPCH)
+    Actions.push_back(PCH.release());
+
   std::unique_ptr<JobAction> MergeModuleAction;
   if (OI.ShouldGenerateModule &&
       OI.CompilerMode != OutputInfo::Mode::SingleCompile &&
@@ -1378,14 +1490,21 @@ bool Driver::handleImmediateArgs(const ArgList &Args, const ToolChain &TC) {
   return true;
 }
 
-std::unique_ptr<OutputFileMap>
-Driver::buildOutputFileMap(const llvm::opt::DerivedArgList &Args) const {
+const OutputFileMap *
+Driver::buildOutputFileMap(const llvm::opt::DerivedArgList &Args,
+                           std::unique_ptr<OutputFileMap> &OwnedOFM) const {
   const Arg *A = Args.getLastArg(options::OPT_output_file_map);
   if (!A)
     return nullptr;
 
   // TODO: perform some preflight checks to ensure the file exists.
-  auto OFM = OutputFileMap::loadFromPath(A->getValue());
+  const OutputFileMap *OFM;
+  if (StateCache) {
+    OFM = StateCache->getOutputFileMap(A->getValue());
+  } else {
+    OwnedOFM = OutputFileMap::loadFromPath(A->getValue());
+    OFM = OwnedOFM.get();
+  }
   if (!OFM) {
     // TODO: emit diagnostic with error string
     Diags.diagnose(SourceLoc(), diag::error_unable_to_load_output_file_map);
@@ -1410,12 +1529,13 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
       // path specified using -o.
       // (Module outputs can be specified using -module-output-path, or will
       // be inferred if there are other top-level outputs. dSYM outputs are
-      // based on the image.)
+      // based on the image. The precompiled bridging header is only an input
+      // to the compile jobs.)
       if (Type != types::TY_Nothing && Type != types::TY_SwiftModuleFile &&
-          Type != types::TY_dSYM) {
+          Type != types::TY_dSYM && Type != types::TY_PCH) {
         // Multi-threading compilation has multiple outputs, except those
         // outputs which are produced before the llvm passes (e.g. emit-sil).
-        if (OI.isMultiThreading() && isa<CompileJobAction>(A) &&
+        if (OI.hasOutputPerThread() && isa<CompileJobAction>(A) &&
             types::isAfterLLVM(A->getType())) {
           NumOutputs += cast<CompileJobAction>(A)->size();
         } else {
@@ -1437,6 +1557,43 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
   }
 }
 
+/// Names the precompiled bridging header kept in \p PCHDir after the header
+/// and a hash of the options it is precompiled with, so that builds with
+/// different options don't keep replacing each other's PCH.
+static void getPersistentPCHPath(StringRef HeaderPath, StringRef PCHDir,
+                                 const OutputInfo &OI,
+                                 const llvm::opt::ArgList &Args,
+                                 llvm::SmallString<128> &Buffer) {
+  llvm::MD5 Hash;
+  auto addString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+
+  addString(version::getSwiftFullVersion());
+  addString(HeaderPath);
+  addString(OI.SDKPath);
+  for (const Arg *A : Args.filtered(options::OPT_target,
+                                    options::OPT_target_cpu,
+                                    options::OPT_I, options::OPT_F,
+                                    options::OPT_Xcc,
+                                    options::OPT_module_cache_path))
+    addString(A->getAsString(Args));
+
+  llvm::MD5::MD5Result HashBuf;
+  Hash.final(HashBuf);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(HashBuf, HashStr);
+
+  // Clang doesn't create the directory itself. If this fails, the frontend
+  // will say so when it can't write the PCH.
+  (void)llvm::sys::fs::create_directories(PCHDir);
+
+  Buffer = PCHDir;
+  llvm::sys::path::append(Buffer, llvm::sys::path::stem(HeaderPath) + "-" +
+                                      HashStr + ".pch");
+}
+
 static StringRef getOutputFilename(Compilation &C,
                                    const JobAction *JA,
                                    const OutputInfo &OI,
@@ -1484,6 +1641,16 @@ static StringRef getOutputFilename(Compilation &C,
     }
   }
 
+  // The precompiled bridging header is never treated as top-level.
+  if (auto *PCHAct = dyn_cast<GeneratePCHJobAction>(JA)) {
+    if (PCHAct->isPersistentPCH()) {
+      getPersistentPCHPath(BaseInput, PCHAct->getPersistentPCHDir(), OI, Args,
+                           Buffer);
+      return Buffer.str();
+    }
+    AtTopLevel = false;
+  }
+
   // dSYM actions are never treated as top-level.
   if (isa<GenerateDSYMJobAction>(JA)) {
     Buffer = InputJobs.front()->getOutput().getPrimaryOutputFilename();
@@ -1506,7 +1673,7 @@ static StringRef getOutputFilename(Compilation &C,
   StringRef BaseName(BaseInput);
   if (isa<MergeModuleJobAction>(JA) ||
       (OI.CompilerMode == OutputInfo::Mode::SingleCompile &&
-       !OI.isMultiThreading()) ||
+       !OI.hasOutputPerThread()) ||
       JA->getType() == types::TY_Image)
     BaseName = OI.ModuleName;
 
@@ -1591,7 +1758,8 @@ static void addAuxiliaryOutput(Compilation &C, CommandOutput &output,
 /// mtime has not changed), adjust the Job's condition accordingly.
 static void
 handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
-                          StringRef input, bool alwaysRebuildDependents) {
+                          StringRef input, bool alwaysRebuildDependents,
+                          BuildStateCache *stateCache) {
   if (inputInfo.status == CompileJobAction::InputInfo::NewlyAdded) {
     J->setCondition(Job::Condition::NewlyAdded);
     return;
@@ -1603,7 +1771,8 @@ handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
   }
 
   llvm::sys::fs::file_status inputStatus;
-  if (llvm::sys::fs::status(input, inputStatus))
+  if (stateCache ? stateCache->getStatus(input, inputStatus)
+                 : llvm::sys::fs::status(input, inputStatus))
     return;
 
   J->setInputModTime(inputStatus.getLastModificationTime());
@@ -1684,7 +1853,7 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
   llvm::SmallString<128> Buf;
   StringRef OutputFile;
 
-  if (OI.isMultiThreading() && isa<CompileJobAction>(JA) &&
+  if (OI.hasOutputPerThread() && isa<CompileJobAction>(JA) &&
       types::isAfterLLVM(JA->getType())) {
     // Multi-threaded compilation: A single frontend command produces multiple
     // output file: one for each input files.
@@ -1704,8 +1873,11 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
       OutputFunc(IA->getInputArg().getValue());
 
     }
-    // Add an output file for each input job.
+    // Add an output file for each input job, other than the precompiled
+    // bridging header.
     for (const Job *job : InputJobs) {
+      if (isa<GeneratePCHJobAction>(job->getSource()))
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
@@ -1717,7 +1889,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
   }
 
   // Choose the swiftmodule output path.
-  if (OI.ShouldGenerateModule && isa<CompileJobAction>(JA) &&
+  if (OI.ShouldGenerateModule && !OI.ShouldEmitModuleSeparately &&
+      isa<CompileJobAction>(JA) &&
       Output->getPrimaryOutputType() != types::TY_SwiftModuleFile) {
     StringRef OFMModuleOutputPath;
     if (OutputMap) {
@@ -1769,7 +1942,8 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
 
   // Choose the swiftdoc output path.
   if (OI.ShouldGenerateModule &&
-      (isa<CompileJobAction>(JA) || isa<MergeModuleJobAction>(JA))) {
+      ((isa<CompileJobAction>(JA) && !OI.ShouldEmitModuleSeparately) ||
+       isa<MergeModuleJobAction>(JA))) {
     StringRef OFMModuleDocOutputPath;
     if (OutputMap) {
       auto iter = OutputMap->find(types::TY_SwiftModuleDocFile);
@@ -1877,7 +2051,7 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
       bool alwaysRebuildDependents =
           C.getArgs().hasArg(options::OPT_driver_always_rebuild_dependents);
       handleCompileJobCondition(J, compileJob->getInputInfo(), BaseInput,
-                                alwaysRebuildDependents);
+                                alwaysRebuildDependents, StateCache);
     }
   }
 
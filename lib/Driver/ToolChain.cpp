@@ -48,6 +48,10 @@ const char *ToolChain::JobContext::getAllSourcesPath() const {
   return C.getAllSourcesPath();
 }
 
+const char *ToolChain::JobContext::getSearchPathListingPath() const {
+  return C.getSearchPathListingPath();
+}
+
 const char *
 ToolChain::JobContext::getTemporaryFilePath(const llvm::Twine &name,
                                             StringRef suffix) const {
@@ -85,6 +89,7 @@ ToolChain::constructJob(const JobAction &JA,
     CASE(ModuleWrapJob)
     CASE(LinkJob)
     CASE(GenerateDSYMJob)
+    CASE(GeneratePCHJob)
     CASE(AutolinkExtractJob)
     CASE(REPLJob)
 #undef CASE
@@ -121,6 +126,55 @@ ToolChain::constructJob(const JobAction &JA,
                                 std::move(invocationInfo.FilelistInfo));
 }
 
+std::unique_ptr<Job>
+ToolChain::constructBatchJob(ArrayRef<const Job *> jobs,
+                             Compilation &C,
+                             const OutputInfo &OI) const {
+  assert(jobs.size() > 1 && "a batch of one job is just that job");
+
+  // Besides its primary file, a compile job may only take the precompiled
+  // bridging header, which is the same for all of them.
+  auto getPrimaryInput = [](const Job *Cmd) -> const Action * {
+    assert(isa<CompileJobAction>(Cmd->getSource()) &&
+           Cmd->getSource().size() == 1 + Cmd->getInputs().size() &&
+           "only single-file compile jobs can be batched");
+    return *Cmd->getSource().begin();
+  };
+
+  // The frontend matches per-file outputs to primary files by position, so
+  // keep everything in command-line order.
+  SmallVector<const Job *, 16> sortedJobs(jobs.begin(), jobs.end());
+  std::sort(sortedJobs.begin(), sortedJobs.end(),
+            [&](const Job *LHS, const Job *RHS) {
+    return cast<InputAction>(getPrimaryInput(LHS))->getInputArg().getIndex() <
+           cast<InputAction>(getPrimaryInput(RHS))->getInputArg().getIndex();
+  });
+
+  SmallVector<const Action *, 16> inputActions;
+  auto output = llvm::make_unique<CommandOutput>(
+      sortedJobs.front()->getOutput().getPrimaryOutputType());
+  for (const Job *Cmd : sortedJobs) {
+    const CommandOutput &cmdOutput = Cmd->getOutput();
+    assert(cmdOutput.getPrimaryOutputType() == output->getPrimaryOutputType());
+    inputActions.push_back(getPrimaryInput(Cmd));
+    output->addPrimaryOutput(cmdOutput.getPrimaryOutputFilename(),
+                             cmdOutput.getBaseInput(0));
+  }
+
+  JobContext context{C, {}, inputActions, *output, OI};
+  InvocationInfo invocationInfo = constructBatchInvocation(sortedJobs,
+                                                           context);
+  assert(StringRef(SWIFT_EXECUTABLE_NAME) == invocationInfo.ExecutableName);
+
+  SmallVector<const Job *, 1> noInputs;
+  return llvm::make_unique<Job>(sortedJobs.front()->getSource(),
+                                std::move(noInputs), std::move(output),
+                                getDriver().getSwiftProgramPath().c_str(),
+                                std::move(invocationInfo.Arguments),
+                                std::move(invocationInfo.ExtraEnvironment),
+                                std::move(invocationInfo.FilelistInfo));
+}
+
 std::string
 ToolChain::findProgramRelativeToSwift(StringRef executableName) const {
   auto insertionResult =
@@ -126,9 +126,11 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
 
@@ -154,23 +156,16 @@ static void addCommonFrontendArgs(const ToolChain &TC,
 }
 
 
-ToolChain::InvocationInfo
-ToolChain::constructInvocation(const CompileJobAction &job,
-                               const JobContext &context) const {
-  InvocationInfo II{SWIFT_EXECUTABLE_NAME};
-  ArgStringList &Arguments = II.Arguments;
-
-  if (context.OI.CompilerMode == OutputInfo::Mode::UpdateCode)
-    II.ExecutableName = SWIFT_UPDATE_NAME;
-  else
-    Arguments.push_back("-frontend");
-
-  // Determine the frontend mode option.
+/// Determines the frontend mode option for a compile job whose primary output
+/// is of type \p PrimaryOutputType.
+static const char *getCompileFrontendModeOption(const OutputInfo &OI,
+                                                types::ID PrimaryOutputType,
+                                                const ArgList &Args) {
   const char *FrontendModeOption = nullptr;
-  switch (context.OI.CompilerMode) {
+  switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::SingleCompile: {
-    switch (context.Output.getPrimaryOutputType()) {
+    switch (PrimaryOutputType) {
     case types::TY_Object:
       FrontendModeOption = "-c";
       break;
@@ -201,7 +196,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
       break;
     case types::TY_Nothing:
       // We were told to output nothing, so get the last mode option and use that.
-      if (const Arg *A = context.Args.getLastArg(options::OPT_modes_Group))
+      if (const Arg *A = Args.getLastArg(options::OPT_modes_Group))
         FrontendModeOption = A->getSpelling().data();
       else
         llvm_unreachable("We were told to perform a standard compile, "
@@ -213,6 +208,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -234,13 +230,66 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     break;
   }
 
+  return FrontendModeOption;
+}
+
+/// Passes the precompiled bridging header if it's among \p inputs, the input
+/// jobs of a compile job.
+static void addBridgingPCHArgs(ArrayRef<const Job *> inputs,
+                               ArgStringList &arguments) {
+  for (const Job *input : inputs) {
+    assert(isa<GeneratePCHJobAction>(input->getSource()) &&
+           "The Swift frontend only expects to be fed the bridging PCH job!");
+    arguments.push_back("-import-objc-header-pch");
+    arguments.push_back(input->getOutput().getPrimaryOutputFilename().c_str());
+  }
+}
+
+/// Handle the arguments shared by every compile job, between the inputs and
+/// the per-file outputs.
+static void addCompileFrontendArgs(const ToolChain &TC,
+                                   const OutputInfo &OI,
+                                   const CommandOutput &output,
+                                   const ArgList &inputArgs,
+                                   ArgStringList &arguments) {
+  if (inputArgs.hasArg(options::OPT_parse_stdlib))
+    arguments.push_back("-disable-objc-attr-requires-foundation-module");
+
+  addCommonFrontendArgs(TC, OI, output, inputArgs, arguments);
+
+  // Pass the optimization level down to the frontend.
+  inputArgs.AddLastArg(arguments, options::OPT_O_Group);
+
+  if (inputArgs.hasArg(options::OPT_parse_as_library) ||
+      inputArgs.hasArg(options::OPT_emit_library))
+    arguments.push_back("-parse-as-library");
+
+  inputArgs.AddLastArg(arguments, options::OPT_parse_sil);
+  inputArgs.AddLastArg(arguments, options::OPT_enable_binary_dependencies);
+
+  arguments.push_back("-module-name");
+  arguments.push_back(inputArgs.MakeArgString(OI.ModuleName));
+}
+
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const CompileJobAction &job,
+                               const JobContext &context) const {
+  InvocationInfo II{SWIFT_EXECUTABLE_NAME};
+  ArgStringList &Arguments = II.Arguments;
+
+  if (context.OI.CompilerMode == OutputInfo::Mode::UpdateCode)
+    II.ExecutableName = SWIFT_UPDATE_NAME;
+  else
+    Arguments.push_back("-frontend");
+
+  const char *FrontendModeOption =
+      getCompileFrontendModeOption(context.OI,
+                                   context.Output.getPrimaryOutputType(),
+                                   context.Args);
   assert(FrontendModeOption != nullptr && "No frontend mode option specified!");
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
-
   // Add input arguments.
   switch (context.OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
@@ -292,23 +341,13 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     llvm_unreachable("REPL and immediate modes handled elsewhere");
   }
 
-  if (context.Args.hasArg(options::OPT_parse_stdlib))
-    Arguments.push_back("-disable-objc-attr-requires-foundation-module");
-
-  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+  addCompileFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
-
-  // Pass the optimization level down to the frontend.
-  context.Args.AddLastArg(Arguments, options::OPT_O_Group);
-
-  if (context.Args.hasArg(options::OPT_parse_as_library) ||
-      context.Args.hasArg(options::OPT_emit_library))
-    Arguments.push_back("-parse-as-library");
-
-  context.Args.AddLastArg(Arguments, options::OPT_parse_sil);
-
-  Arguments.push_back("-module-name");
-  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+  addBridgingPCHArgs(context.Inputs, Arguments);
+  if (context.Args.hasArg(options::OPT_validate_modules_once_per_build)) {
+    Arguments.push_back("-search-path-listing");
+    Arguments.push_back(context.getSearchPathListingPath());
+  }
 
   const std::string &ModuleOutputPath =
     context.Output.getAdditionalOutputForType(types::ID::TY_SwiftModuleFile);
@@ -385,6 +424,89 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   return II;
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructBatchInvocation(ArrayRef<const Job *> jobs,
+                                    const JobContext &context) const {
+  assert(context.OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+         "batch mode only applies to standard compiles");
+  InvocationInfo II{SWIFT_EXECUTABLE_NAME};
+  ArgStringList &Arguments = II.Arguments;
+
+  Arguments.push_back("-frontend");
+  Arguments.push_back(
+      getCompileFrontendModeOption(context.OI,
+                                   context.Output.getPrimaryOutputType(),
+                                   context.Args));
+
+  assert(context.Inputs.empty() &&
+         "The Swift frontend does not expect to be fed any input Jobs!");
+
+  // Add input arguments. The input actions are in command-line order, and
+  // every one of them is a primary file.
+  if (context.Args.hasArg(options::OPT_driver_use_filelists) ||
+      context.getTopLevelInputFiles().size() > TOO_MANY_FILES) {
+    Arguments.push_back("-filelist");
+    Arguments.push_back(context.getAllSourcesPath());
+    for (const Action *A : context.InputActions) {
+      Arguments.push_back("-primary-file");
+      cast<InputAction>(A)->getInputArg().render(context.Args, Arguments);
+    }
+  } else {
+    auto nextPrimary = context.InputActions.begin();
+    for (auto inputPair : context.getTopLevelInputFiles()) {
+      if (!types::isPartOfSwiftCompilation(inputPair.first))
+        continue;
+
+      if (nextPrimary != context.InputActions.end() &&
+          cast<InputAction>(*nextPrimary)->getInputArg().getIndex() ==
+            inputPair.second->getIndex()) {
+        Arguments.push_back("-primary-file");
+        ++nextPrimary;
+      }
+      Arguments.push_back(inputPair.second->getValue());
+    }
+    assert(nextPrimary == context.InputActions.end() &&
+           "primary files are not in command-line order");
+  }
+
+  // The batch's own output has no supplementary outputs, so this leaves out
+  // -emit-module-doc-path; it's passed per file below.
+  addCompileFrontendArgs(*this, context.OI, context.Output, context.Args,
+                         Arguments);
+  addBridgingPCHArgs(jobs.front()->getInputs(), Arguments);
+  if (context.Args.hasArg(options::OPT_validate_modules_once_per_build)) {
+    Arguments.push_back("-search-path-listing");
+    Arguments.push_back(context.getSearchPathListingPath());
+  }
+
+  // Each per-file output is repeated once per primary file, in the same
+  // order as the -primary-file arguments.
+  auto addOutputsOfType = [&](types::ID type, const char *option) {
+    for (const Job *Cmd : jobs) {
+      const std::string &path =
+          Cmd->getOutput().getAdditionalOutputForType(type);
+      if (path.empty())
+        continue;
+      Arguments.push_back(option);
+      Arguments.push_back(path.c_str());
+    }
+  };
+  addOutputsOfType(types::TY_SwiftModuleFile, "-emit-module-path");
+  addOutputsOfType(types::TY_SwiftModuleDocFile, "-emit-module-doc-path");
+  addOutputsOfType(types::TY_Dependencies, "-emit-dependencies-path");
+  addOutputsOfType(types::TY_SwiftDeps, "-emit-reference-dependencies-path");
+
+  for (const Job *Cmd : jobs) {
+    Arguments.push_back("-o");
+    Arguments.push_back(Cmd->getOutput().getPrimaryOutputFilename().c_str());
+  }
+
+  if (context.Args.hasArg(options::OPT_embed_bitcode_marker))
+    Arguments.push_back("-embed-bitcode-marker");
+
+  return II;
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const InterpretJobAction &job,
                                const JobContext &context) const {
@@ -417,6 +539,8 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
 
   context.Args.AddAllArgs(Arguments, options::OPT_l, options::OPT_framework);
 
+  context.Args.AddLastArg(Arguments, options::OPT_script_cache_path);
+
   // The immediate arguments must be last.
   context.Args.AddLastArg(Arguments, options::OPT__DASH_DASH);
 
@@ -470,6 +594,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -571,8 +696,23 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
   // mode options.
   Arguments.push_back("-emit-module");
 
-  if (context.Args.hasArg(options::OPT_driver_use_filelists) ||
-      context.Inputs.size() > TOO_MANY_FILES) {
+  if (context.OI.ShouldEmitModuleSeparately) {
+    // Build the module from all of the sources at once. The compile jobs
+    // report the same warnings.
+    if (context.Args.hasArg(options::OPT_driver_use_filelists) ||
+        context.InputActions.size() > TOO_MANY_FILES) {
+      Arguments.push_back("-filelist");
+      Arguments.push_back(context.getAllSourcesPath());
+    } else {
+      for (const Action *A : context.InputActions) {
+        if (!types::isPartOfSwiftCompilation(A->getType()))
+          continue;
+        cast<InputAction>(A)->getInputArg().render(context.Args, Arguments);
+      }
+    }
+    Arguments.push_back("-suppress-warnings");
+  } else if (context.Args.hasArg(options::OPT_driver_use_filelists) ||
+             context.Inputs.size() > TOO_MANY_FILES) {
     Arguments.push_back("-filelist");
     Arguments.push_back(context.getTemporaryFilePath("inputs", ""));
     II.FilelistInfo = {Arguments.back(), types::TY_SwiftModuleFile,
@@ -591,15 +731,25 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
            "every input to MergeModule must generate a swiftmodule");
   }
 
-  // Tell all files to parse as library, which is necessary to load them as
-  // serialized ASTs.
-  Arguments.push_back("-parse-as-library");
+  if (context.OI.ShouldEmitModuleSeparately) {
+    // Handle the sources the same way as the compile jobs do.
+    addCompileFrontendArgs(*this, context.OI, context.Output, context.Args,
+                           Arguments);
+  } else {
+    // Tell all files to parse as library, which is necessary to load them as
+    // serialized ASTs.
+    Arguments.push_back("-parse-as-library");
 
-  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
-                        Arguments);
+    addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                          Arguments);
 
-  Arguments.push_back("-module-name");
-  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+    Arguments.push_back("-module-name");
+    Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+  }
+  if (context.Args.hasArg(options::OPT_validate_modules_once_per_build)) {
+    Arguments.push_back("-search-path-listing");
+    Arguments.push_back(context.getSearchPathListingPath());
+  }
 
   assert(context.Output.getPrimaryOutputType() == types::TY_SwiftModuleFile &&
          "The MergeModule tool only produces swiftmodule files!");
@@ -707,6 +857,36 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return {"dsymutil", Arguments};
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+
+  // The header has to be precompiled with the same Clang options as the
+  // compile jobs will load it with.
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+  if (context.Args.hasArg(options::OPT_validate_modules_once_per_build)) {
+    Arguments.push_back("-search-path-listing");
+    Arguments.push_back(context.getSearchPathListingPath());
+  }
+
+  addInputsOfType(Arguments, context.InputActions, types::TY_ObjCHeader);
+
+  Arguments.push_back("-emit-pch");
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
@@ -15,9 +15,11 @@
 #include "swift/Strings.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/Basic/Platform.h"
+#include "swift/Basic/Range.h"
 #include "swift/Option/Options.h"
 #include "swift/Option/SanitizerOptions.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -94,14 +96,18 @@ static void debugFailWithCrash() {
 
 /// Try to read a file list file.
 ///
+/// If \p primaryFileArgs is non-empty, the index in the list of each primary
+/// file is appended to \p primaryFileIndices, in the same order.
+///
 /// Returns false on error.
 static bool readFileList(DiagnosticEngine &diags,
                          std::vector<std::string> &inputFiles,
                          const llvm::opt::Arg *filelistPath,
-                         const llvm::opt::Arg *primaryFileArg = nullptr,
-                         unsigned *primaryFileIndex = nullptr) {
-  assert((primaryFileArg == nullptr) || (primaryFileIndex != nullptr) &&
-         "did not provide argument for primary file index");
+                         ArrayRef<const llvm::opt::Arg *> primaryFileArgs = {},
+                         SmallVectorImpl<unsigned> *primaryFileIndices =
+                             nullptr) {
+  assert((primaryFileArgs.empty() || primaryFileIndices != nullptr) &&
+         "did not provide argument for primary file indices");
 
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
       llvm::MemoryBuffer::getFile(filelistPath->getValue());
@@ -111,29 +117,114 @@ static bool readFileList(DiagnosticEngine &diags,
     return false;
   }
 
-  bool foundPrimaryFile = false;
-  if (primaryFileIndex) *primaryFileIndex = 0;
+  // Map each primary file to its position in primaryFileArgs. If a file is
+  // named more than once, the first occurrence in the list wins.
+  llvm::StringMap<unsigned> primaryFilePositions;
+  for (unsigned i : indices(primaryFileArgs))
+    primaryFilePositions.insert({primaryFileArgs[i]->getValue(), i});
+  SmallVector<Optional<unsigned>, 4> foundIndices(primaryFileArgs.size());
 
   for (StringRef line : make_range(llvm::line_iterator(*buffer.get()), {})) {
+    if (!primaryFilePositions.empty()) {
+      auto found = primaryFilePositions.find(line);
+      if (found != primaryFilePositions.end()) {
+        foundIndices[found->second] = inputFiles.size();
+        primaryFilePositions.erase(found);
+      }
+    }
     inputFiles.push_back(line);
-
-    if (foundPrimaryFile || primaryFileArg == nullptr)
-      continue;
-    if (line == primaryFileArg->getValue())
-      foundPrimaryFile = true;
-    else
-      ++*primaryFileIndex;
   }
 
-  if (primaryFileArg && !foundPrimaryFile) {
-    diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
-                   primaryFileArg->getValue(), filelistPath->getValue());
-    return false;
+  for (unsigned i : indices(primaryFileArgs)) {
+    if (!foundIndices[i]) {
+      diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
+                     primaryFileArgs[i]->getValue(), filelistPath->getValue());
+      return false;
+    }
+    primaryFileIndices->push_back(*foundIndices[i]);
   }
 
   return true;
 }
 
+/// Splits up the per-file outputs of a frontend invocation with more than one
+/// primary file. Each such output is given once per primary file, in the same
+/// order as the -primary-file options themselves.
+///
+/// Returns true on error.
+static bool parseBatchPrimaryOutputs(FrontendOptions &Opts, ArgList &Args,
+                                     DiagnosticEngine &Diags) {
+  using namespace options;
+  assert(Opts.isBatchMode());
+
+  switch (Opts.RequestedAction) {
+  case FrontendOptions::EmitSILGen:
+  case FrontendOptions::EmitSIL:
+  case FrontendOptions::EmitIR:
+  case FrontendOptions::EmitBC:
+  case FrontendOptions::EmitAssembly:
+  case FrontendOptions::EmitObject:
+    break;
+  default:
+    Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_action);
+    return true;
+  }
+
+  // These outputs describe the whole invocation rather than any one file.
+  const OptSpecifier UnsupportedOptions[] = {
+    OPT_serialize_diagnostics, OPT_serialize_diagnostics_path,
+    OPT_emit_fixits_path, OPT_emit_objc_header, OPT_emit_objc_header_path,
+    OPT_num_threads
+  };
+  for (OptSpecifier Opt : UnsupportedOptions) {
+    if (const Arg *A = Args.getLastArg(Opt)) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_option,
+                     A->getSpelling());
+      return true;
+    }
+  }
+
+  unsigned NumPrimaries = Opts.BatchPrimaryInputs.size();
+  auto checkCount = [&](StringRef Spelling, size_t Count) -> bool {
+    if (Count == NumPrimaries)
+      return false;
+    Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count,
+                   Spelling, NumPrimaries, Count);
+    return true;
+  };
+
+  const Arg *OutputArg = Args.getLastArg(OPT_output_filelist, OPT_o);
+  if (checkCount(OutputArg ? OutputArg->getSpelling() : "-o",
+                 Opts.OutputFilenames.size()))
+    return true;
+  for (unsigned i : indices(Opts.BatchPrimaryInputs))
+    Opts.BatchPrimaryInputs[i].OutputFilename = Opts.OutputFilenames[i];
+
+  auto assignOutputs = [&](std::string BatchPrimaryInput::*Output,
+                           OptSpecifier OptWithoutPath,
+                           OptSpecifier OptWithPath) -> bool {
+    std::vector<std::string> Paths = Args.getAllArgValues(OptWithPath);
+    if (Paths.empty() && !Args.hasArg(OptWithoutPath))
+      return false;
+    const Arg *A = Args.getLastArg(OptWithPath, OptWithoutPath);
+    if (checkCount(A->getSpelling(), Paths.size()))
+      return true;
+    for (unsigned i : indices(Opts.BatchPrimaryInputs))
+      Opts.BatchPrimaryInputs[i].*Output = std::move(Paths[i]);
+    return false;
+  };
+
+  return assignOutputs(&BatchPrimaryInput::ModuleOutputPath,
+                       OPT_emit_module, OPT_emit_module_path) ||
+         assignOutputs(&BatchPrimaryInput::ModuleDocOutputPath,
+                       OPT_emit_module_doc, OPT_emit_module_doc_path) ||
+         assignOutputs(&BatchPrimaryInput::DependenciesFilePath,
+                       OPT_emit_dependencies, OPT_emit_dependencies_path) ||
+         assignOutputs(&BatchPrimaryInput::ReferenceDependenciesFilePath,
+                       OPT_emit_reference_dependencies,
+                       OPT_emit_reference_dependencies_path);
+}
+
 static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                               DiagnosticEngine &Diags) {
   using namespace options;
@@ -165,15 +256,27 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
 
   Opts.EmitVerboseSIL |= Args.hasArg(OPT_emit_verbose_sil);
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
+  Opts.EmitBinaryReferenceDependencies |=
+    Args.hasArg(OPT_enable_binary_dependencies);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
+  if (const Arg *A = Args.getLastArg(OPT_resilience_domain))
+    Opts.ResilienceDomain = A->getValue();
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
+  Opts.DebugTimeExpressionTypeChecking |=
+    Args.hasArg(OPT_debug_time_expression_type_checking);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_save_optimization_record_path))
+    Opts.OptRecordPath = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_script_cache_path))
+    Opts.ScriptCachePath = A->getValue();
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -185,6 +288,16 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_warn_long_expression_type_checking)) {
+    unsigned attempt;
+    if (StringRef(A->getValue()).getAsInteger(10, attempt)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+    } else {
+      Opts.WarnLongExpressionTypeChecking = attempt;
+    }
+  }
+
   Opts.PlaygroundTransform |= Args.hasArg(OPT_playground);
   if (Args.hasArg(OPT_disable_playground_transform))
     Opts.PlaygroundTransform = false;
@@ -201,13 +314,12 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  SmallVector<unsigned, 4> PrimaryFileIndices;
   if (const Arg *A = Args.getLastArg(OPT_filelist)) {
-    const Arg *primaryFileArg = Args.getLastArg(OPT_primary_file);
-    unsigned primaryFileIndex = 0;
+    SmallVector<const Arg *, 4> PrimaryFileArgs(
+        Args.filtered_begin(OPT_primary_file), Args.filtered_end());
     if (readFileList(Diags, Opts.InputFilenames, A,
-                     primaryFileArg, &primaryFileIndex)) {
-      if (primaryFileArg)
-        Opts.PrimaryInput = SelectedInput(primaryFileIndex);
+                     PrimaryFileArgs, &PrimaryFileIndices)) {
       assert(!Args.hasArg(OPT_INPUT) && "mixing -filelist with inputs");
     }
   } else {
@@ -217,7 +329,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       if (A->getOption().matches(OPT_INPUT)) {
         Opts.InputFilenames.push_back(A->getValue());
       } else if (A->getOption().matches(OPT_primary_file)) {
-        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+        PrimaryFileIndices.push_back(Opts.InputFilenames.size());
         Opts.InputFilenames.push_back(A->getValue());
       } else {
         llvm_unreachable("Unknown input-related argument!");
@@ -225,6 +337,15 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  // With more than one primary file, every primary gets its own outputs
+  // (see parseBatchPrimaryOutputs); the first one stands in as PrimaryInput
+  // for everything that only needs to know that there is a primary.
+  if (!PrimaryFileIndices.empty())
+    Opts.PrimaryInput = SelectedInput(PrimaryFileIndices.front());
+  if (PrimaryFileIndices.size() > 1)
+    for (unsigned Index : PrimaryFileIndices)
+      Opts.BatchPrimaryInputs.emplace_back(SelectedInput(Index));
+
   Opts.ParseStdlib |= Args.hasArg(OPT_parse_stdlib);
 
   // Determine what the user has asked the frontend to do.
@@ -264,6 +385,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::REPL;
     } else if (Opt.matches(OPT_interpret)) {
       Action = FrontendOptions::Immediate;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else {
       llvm_unreachable("Unhandled mode option");
     }
@@ -311,6 +434,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Diags.diagnose(SourceLoc(), diag::error_repl_requires_no_input_files);
       return true;
     }
+  } else if (Opts.RequestedAction == FrontendOptions::EmitPCH) {
+    if (Opts.InputFilenames.size() != 1) {
+      Diags.diagnose(SourceLoc(), diag::error_mode_requires_one_input_file);
+      return true;
+    }
   } else if (TreatAsSIL && Opts.PrimaryInput.hasValue()) {
     // If we have the SIL as our primary input, we can waive the one file
     // requirement as long as all the other inputs are SIBs.
@@ -486,6 +614,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitObject:
       Suffix = "o";
       break;
+
+    case FrontendOptions::EmitPCH:
+      Suffix = "pch";
+      break;
     }
 
     if (!Suffix.empty()) {
@@ -625,6 +757,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
       return true;
     case FrontendOptions::Parse:
@@ -651,6 +784,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
       return true;
     case FrontendOptions::Parse:
@@ -680,6 +814,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       if (!Opts.ModuleOutputPath.empty())
         Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_module);
       else
@@ -697,6 +832,9 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (Opts.isBatchMode() && parseBatchPrimaryOutputs(Opts, Args, Diags))
+    return true;
+
   if (const Arg *A = Args.getLastArg(OPT_module_link_name)) {
     Opts.ModuleLinkName = A->getValue();
   }
@@ -740,6 +878,9 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   Opts.EnableExperimentalPropertyBehaviors |=
     Args.hasArg(OPT_enable_experimental_property_behaviors);
 
+  Opts.NamedLazyMemberLoading |=
+    Args.hasArg(OPT_enable_named_lazy_member_loading);
+
   Opts.DisableAvailabilityChecking |=
       Args.hasArg(OPT_disable_availability_checking);
   
@@ -759,6 +900,7 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
+  Opts.SolverComponentCache |= Args.hasArg(OPT_enable_solver_component_cache);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
 
@@ -810,6 +952,17 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     
     Opts.SolverMemoryThreshold = threshold;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_diagnosis_recheck_limit)) {
+    unsigned limit;
+    if (StringRef(A->getValue()).getAsInteger(10, limit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.DiagnosisRecheckLimit = limit;
+  }
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_D),
                                  Args.filtered_end())) {
@@ -889,6 +1042,18 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.DisableSwiftBridgeAttr |= Args.hasArg(OPT_disable_swift_bridge_attr);
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header_pch))
+    Opts.PrecompiledBridgingHeader = A->getValue();
+
+  // The driver writes the listing when the build starts, so it also tells
+  // when the build session began.
+  if (const Arg *A = Args.getLastArg(OPT_search_path_listing)) {
+    llvm::sys::fs::file_status status;
+    if (!llvm::sys::fs::status(A->getValue(), status))
+      Opts.BuildSessionTimestamp =
+          status.getLastModificationTime().toEpochTime();
+  }
+
   return false;
 }
 
@@ -931,6 +1096,9 @@ static bool ParseSearchPathArgs(SearchPathOptions &Opts,
 
   Opts.SkipRuntimeLibraryImportPath |= Args.hasArg(OPT_nostdimport);
 
+  if (const Arg *A = Args.getLastArg(OPT_search_path_listing))
+    Opts.SearchPathListingPath = A->getValue();
+
   // Opts.RuntimeIncludePath is set by calls to
   // setRuntimeIncludePath() or setMainExecutablePath().
   // Opts.RuntimeImportPath is set by calls to
@@ -994,6 +1162,13 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
       return true;
     }
   }
+  if (const Arg *A = Args.getLastArg(OPT_sil_link_body_size_limit)) {
+    if (StringRef(A->getValue()).getAsInteger(10, Opts.LinkBodySizeLimit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
   if (const Arg *A = Args.getLastArg(OPT_num_threads)) {
     if (StringRef(A->getValue()).getAsInteger(10, Opts.NumThreads)) {
       Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
@@ -1076,8 +1251,15 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.UseProfile = A->getValue();
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
+  Opts.EnableGuaranteedNormalArguments |=
+    Args.hasArg(OPT_enable_guaranteed_normal_arguments);
+  Opts.EnableStackAllocatedLocalVars |=
+    Args.hasArg(OPT_enable_stack_allocated_local_vars);
+  Opts.AssumeSingleThreaded |= Args.hasArg(OPT_assume_single_threaded);
 
   if (Args.hasArg(OPT_debug_on_sil)) {
     // Derive the name of the SIL file for debugging from
@@ -1228,11 +1410,28 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.PrintInlineTree |= Args.hasArg(OPT_print_llvm_inline_tree);
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
+  Opts.EnableDynamicStackAllocation |=
+    Args.hasArg(OPT_enable_dynamic_stack_allocation);
+  Opts.EnableStructFieldReordering |=
+    Args.hasArg(OPT_enable_struct_field_reordering);
+  Opts.EnableInlineRefCounting |= Args.hasArg(OPT_enable_inline_refcounting);
 
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
     !Args.hasArg(OPT_disable_incremental_llvm_codegeneration);
 
+  if (const Arg *A = Args.getLastArg(OPT_llvm_codegen_cache_path))
+    Opts.LLVMCodeGenCachePath = A->getValue();
+
+  if (const Arg *A = Args.getLastArg(OPT_outline_value_operations)) {
+    if (StringRef(A->getValue()).getAsInteger(10,
+                                      Opts.OutlineValueOperationsThreshold)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
+
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.EmbedMode = IRGenEmbedMode::EmbedBitcode;
   else if (Args.hasArg(OPT_embed_bitcode_marker))
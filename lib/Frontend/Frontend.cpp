@@ -22,6 +22,7 @@
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/Module.h"
+#include "swift/Basic/Range.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Parse/Lexer.h"
@@ -52,6 +53,45 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+void CompilerInstance::recordPrimaryBuffer(unsigned InputIndex,
+                                           unsigned BufferID) {
+  const FrontendOptions &Opts = Invocation.getFrontendOptions();
+  if (Opts.PrimaryInput && Opts.PrimaryInput->isFilename() &&
+      Opts.PrimaryInput->Index == InputIndex)
+    PrimaryBufferID = BufferID;
+
+  for (unsigned i : indices(Opts.BatchPrimaryInputs))
+    if (Opts.BatchPrimaryInputs[i].Input.Index == InputIndex)
+      BatchPrimaryBufferIDs[i] = BufferID;
+}
+
+void CompilerInstance::recordPrimarySourceFile(SourceFile *SF) {
+  unsigned BufferID = SF->getBufferID().getValue();
+  if (BufferID == PrimaryBufferID)
+    setPrimarySourceFile(SF);
+
+  for (unsigned i : indices(BatchPrimaryBufferIDs)) {
+    if (BatchPrimaryBufferIDs[i] != BufferID)
+      continue;
+    BatchPrimarySourceFiles[i] = SF;
+    if (i < BatchNameTrackers.size())
+      SF->setReferencedNameTracker(BatchNameTrackers[i]);
+  }
+}
+
+bool CompilerInstance::isPrimaryBuffer(unsigned BufferID) const {
+  return BufferID == PrimaryBufferID ||
+         std::find(BatchPrimaryBufferIDs.begin(), BatchPrimaryBufferIDs.end(),
+                   BufferID) != BatchPrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  return SF == PrimarySourceFile ||
+         std::find(BatchPrimarySourceFiles.begin(),
+                   BatchPrimarySourceFiles.end(),
+                   SF) != BatchPrimarySourceFiles.end();
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
@@ -132,6 +172,10 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
   const Optional<SelectedInput> &PrimaryInput =
     Invocation.getFrontendOptions().PrimaryInput;
+  BatchPrimaryBufferIDs.assign(
+      Invocation.getFrontendOptions().BatchPrimaryInputs.size(),
+      NO_SUCH_BUFFER);
+  BatchPrimarySourceFiles.assign(BatchPrimaryBufferIDs.size(), nullptr);
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -166,9 +210,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode || (MainMode && filename(File) == "main.swift"))
         MainBufferID = ExistingBufferID.getValue();
 
-      if (PrimaryInput && PrimaryInput->isFilename() &&
-          PrimaryInput->Index == i)
-        PrimaryBufferID = ExistingBufferID.getValue();
+      recordPrimaryBuffer(i, ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -209,8 +251,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
     if (SILMode || (MainMode && filename(File) == "main.swift"))
       MainBufferID = BufferID;
 
-    if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
-      PrimaryBufferID = BufferID;
+    recordPrimaryBuffer(i, BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -234,10 +275,32 @@ Module *CompilerInstance::getMainModule() {
       MainModule->setResilienceStrategy(ResilienceStrategy::Resilient);
     else if (Invocation.getFrontendOptions().SILSerializeAll)
       MainModule->setResilienceStrategy(ResilienceStrategy::Fragile);
+
+    StringRef Domain = Invocation.getFrontendOptions().ResilienceDomain;
+    if (!Domain.empty())
+      MainModule->setResilienceDomain(Context->getIdentifier(Domain));
   }
   return MainModule;
 }
 
+namespace {
+/// Charges the permanent-arena allocations made during its lifetime to a
+/// source file's \c ASTBytesAllocated.
+class ChargeASTAllocations {
+  SourceFile &SF;
+  size_t Start;
+
+public:
+  explicit ChargeASTAllocations(SourceFile &SF)
+    : SF(SF), Start(SF.getASTContext().getPermanentBytesAllocated()) {}
+
+  ~ChargeASTAllocations() {
+    SF.ASTBytesAllocated +=
+      SF.getASTContext().getPermanentBytesAllocated() - Start;
+  }
+};
+} // end anonymous namespace
+
 void CompilerInstance::performSema() {
   const FrontendOptions &options = Invocation.getFrontendOptions();
   const InputFileKind Kind = Invocation.getInputKind();
@@ -385,6 +448,20 @@ void CompilerInstance::performSema() {
 
   PersistentParserState PersistentState;
 
+  // Function bodies in files other than the primary ones are never
+  // type-checked, so don't bother parsing them.
+  SkipNonTransparentFunctions SkipNonPrimaryBodies;
+  bool SkippedNonPrimaryBodies = false;
+  auto getDelayedParsingCallbacks =
+      [&](unsigned BufferID) -> DelayedParsingCallbacks * {
+    if (DelayedCB)
+      return DelayedCB.get();
+    if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBuffer(BufferID))
+      return nullptr;
+    SkippedNonPrimaryBodies = true;
+    return &SkipNonPrimaryBodies;
+  };
+
   // Make sure the main file is the first file in the module. This may only be
   // a source file, or it may be a SIL file, which requires pumping the parser.
   // We parse it last, though, to make sure that it can use decls from other
@@ -401,8 +478,8 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
-      setPrimarySourceFile(MainFile);
+    if (isPrimaryBuffer(MainBufferID))
+      recordPrimarySourceFile(MainFile);
   }
 
   bool hadLoadError = false;
@@ -427,21 +504,23 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
-      setPrimarySourceFile(NextInput);
+    if (isPrimaryBuffer(BufferID))
+      recordPrimarySourceFile(NextInput);
 
     auto &Diags = NextInput->getASTContext().Diags;
     auto DidSuppressWarnings = Diags.getSuppressWarnings();
     auto IsPrimary
-      = PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID;
+      = PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBuffer(BufferID);
     Diags.setSuppressWarnings(DidSuppressWarnings || !IsPrimary);
 
+    ChargeASTAllocations Charge(*NextInput);
     bool Done;
     do {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          getDelayedParsingCallbacks(BufferID));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -468,6 +547,9 @@ void CompilerInstance::performSema() {
   if (options.DebugTimeFunctionBodies) {
     TypeCheckOptions |= TypeCheckingFlags::DebugTimeFunctionBodies;
   }
+  if (options.DebugTimeExpressionTypeChecking) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugTimeExpressions;
+  }
   if (options.actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
@@ -475,7 +557,7 @@ void CompilerInstance::performSema() {
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
     bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+      (PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBuffer(MainBufferID));
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -485,6 +567,9 @@ void CompilerInstance::performSema() {
     Diags.setSuppressWarnings(DidSuppressWarnings || !mainIsPrimary);
 
     SILParserState SILContext(TheSILModule.get());
+    DelayedParsingCallbacks *MainDelayedCB =
+      getDelayedParsingCallbacks(MainBufferID);
+    ChargeASTAllocations Charge(MainFile);
     unsigned CurTUElem = 0;
     bool Done;
     do {
@@ -494,11 +579,12 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, MainDelayedCB);
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
       }
       CurTUElem = MainFile.Decls.size();
     } while (!Done);
@@ -515,17 +601,20 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimarySourceFile(SF)) {
+        ChargeASTAllocations Charge(*SF);
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
-                            options.WarnLongFunctionBodies);
+                            options.WarnLongFunctionBodies,
+                            options.WarnLongExpressionTypeChecking);
+      }
 
   // Even if there were no source files, we should still record known
   // protocols.
   if (auto *stdlib = Context->getStdlibModule())
     Context->recordKnownProtocols(stdlib);
 
-  if (DelayedCB) {
+  if (DelayedCB || SkippedNonPrimaryBodies) {
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
@@ -539,7 +628,7 @@ void CompilerInstance::performSema() {
 
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimarySourceFile(SF))
         finishTypeChecking(*SF);
 }
 
@@ -39,6 +39,7 @@ bool FrontendOptions::actionHasOutput() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return true;
   }
   llvm_unreachable("Unknown ActionType");
@@ -66,6 +67,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return false;
   }
   llvm_unreachable("Unknown ActionType");
@@ -88,3 +90,19 @@ void FrontendOptions::forAllOutputPaths(
       fn(*next);
   }
 }
+
+FrontendOptions
+FrontendOptions::getOptionsForBatchPrimary(unsigned Index) const {
+  assert(Index < BatchPrimaryInputs.size() && "not a batch primary");
+  const BatchPrimaryInput &Primary = BatchPrimaryInputs[Index];
+
+  FrontendOptions Result = *this;
+  Result.BatchPrimaryInputs.clear();
+  Result.PrimaryInput = Primary.Input;
+  Result.setSingleOutputFilename(Primary.OutputFilename);
+  Result.ModuleOutputPath = Primary.ModuleOutputPath;
+  Result.ModuleDocOutputPath = Primary.ModuleDocOutputPath;
+  Result.DependenciesFilePath = Primary.DependenciesFilePath;
+  Result.ReferenceDependenciesFilePath = Primary.ReferenceDependenciesFilePath;
+  return Result;
+}
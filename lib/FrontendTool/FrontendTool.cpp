@@ -33,8 +33,12 @@
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
+#include "swift/Basic/Range.h"
+#include "swift/Basic/ReferenceDependencies.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -43,6 +47,7 @@
 #include "swift/Option/Options.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -174,6 +179,35 @@ static bool extendedTypeIsPrivate(TypeLoc inheritedType) {
   return std::all_of(protocols.begin(), protocols.end(), declIsPrivate);
 }
 
+/// Combines the interface hashes of \p decls into the fingerprint of a single
+/// "provides" entry.
+///
+/// The interface tokens outside of any declaration are folded into every
+/// fingerprint, since there's no way to tell which entries they affect.
+/// Returns an empty string if any of the declarations has no recorded hash,
+/// in which case the entry should not get a fingerprint at all.
+static std::string getFingerprint(const SourceFile *SF,
+                                  StringRef hashOutsideDecls,
+                                  ArrayRef<const Decl *> decls) {
+  if (decls.empty())
+    return std::string();
+
+  llvm::MD5 fingerprint;
+  fingerprint.update(hashOutsideDecls);
+  for (const Decl *D : decls) {
+    StringRef declHash = SF->getDeclInterfaceHash(D);
+    if (declHash.empty())
+      return std::string();
+    fingerprint.update(declHash);
+  }
+
+  llvm::MD5::MD5Result result;
+  fingerprint.final(result);
+  llvm::SmallString<32> str;
+  llvm::MD5::stringifyResult(result, str);
+  return str.str();
+}
+
 static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   Mangle::Mangler mangler(/*debug style=*/false, /*Unicode=*/true);
   mangler.mangleContext(type, Mangle::Mangler::BindGenerics::None);
@@ -202,16 +236,23 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     return true;
   }
 
-  auto escape = [](Identifier name) -> std::string {
-    return llvm::yaml::escape(name.str());
-  };
-
-  out << "### Swift dependencies file v0 ###\n";
+  using reference_dependencies::Section;
+  using reference_dependencies::Writer;
+  std::unique_ptr<Writer> writer;
+  if (opts.EmitBinaryReferenceDependencies)
+    writer = Writer::createBinary(out);
+  else
+    writer = Writer::createYAML(out);
 
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
 
-  out << "provides-top-level:\n";
+  // The declarations behind each "provides" entry, for computing fingerprints.
+  llvm::MapVector<Identifier, SmallVector<const Decl *, 1>> topLevelDecls;
+  llvm::DenseMap<const NominalTypeDecl *,
+                 SmallVector<const Decl *, 2>> extensionDecls;
+
+  writer->beginSection(Section::ProvidesTopLevel);
   for (const Decl *D : SF->Decls) {
     switch (D->getKind()) {
     case DeclKind::Module:
@@ -243,6 +284,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         }
       }
       extendedNominals[NTD] |= !justMembers;
+      extensionDecls[NTD].push_back(ED);
       findNominals(extendedNominals, ED->getMembers());
       break;
     }
@@ -250,7 +292,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::InfixOperator:
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
-      out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      writer->addEntry(cast<OperatorDecl>(D)->getName().str());
+      topLevelDecls[cast<OperatorDecl>(D)->getName()].push_back(D);
       break;
 
     case DeclKind::Enum:
@@ -264,7 +307,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           NTD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(NTD->getName()) << "\"\n";
+      writer->addEntry(NTD->getName().str());
+      topLevelDecls[NTD->getName()].push_back(D);
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -280,7 +324,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(VD->getName()) << "\"\n";
+      writer->addEntry(VD->getName().str());
+      topLevelDecls[VD->getName()].push_back(D);
       break;
     }
 
@@ -302,21 +347,16 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     }
   }
 
-  out << "provides-nominal:\n";
+  writer->beginSection(Section::ProvidesNominal);
   for (auto entry : extendedNominals) {
     if (!entry.second)
       continue;
-    out << "- \"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\"\n";
+    writer->addEntry(StringRef(mangleTypeAsContext(entry.first)));
   }
 
-  out << "provides-member:\n";
-  for (auto entry : extendedNominals) {
-    out << "- [\"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\", \"\"]\n";
-  }
+  writer->beginSection(Section::ProvidesMember);
+  for (auto entry : extendedNominals)
+    writer->addEntry({ mangleTypeAsContext(entry.first), "" });
 
   // This is also part of "provides-member".
   for (auto *ED : extensionsWithJustMembers) {
@@ -329,8 +369,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         continue;
       }
-      out << "- [\"" << mangledName << "\", \""
-          << escape(VD->getName()) << "\"]\n";
+      writer->addEntry({ mangledName, VD->getName().str() });
     }
   }
 
@@ -338,36 +377,99 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     // FIXME: This requires a traversal of the whole file to compute.
     // We should (a) see if there's a cheaper way to keep it up to date,
     // and/or (b) see if we can fast-path cases where there's no ObjC involved.
-    out << "provides-dynamic-lookup:\n";
+    writer->beginSection(Section::ProvidesDynamicLookup);
     class ValueDeclPrinter : public VisibleDeclConsumer {
     private:
-      raw_ostream &out;
-      std::string (*escape)(Identifier);
+      Writer &writer;
     public:
-      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape)
-        : out(out), escape(escape) {}
+      explicit ValueDeclPrinter(Writer &writer) : writer(writer) {}
 
       void foundDecl(ValueDecl *VD, DeclVisibilityKind Reason) override {
-        out << "- \"" << escape(VD->getName()) << "\"\n";
+        writer.addEntry(VD->getName().str());
       }
     };
-    ValueDeclPrinter printer(out, escape);
+    ValueDeclPrinter printer(*writer);
     SF->lookupClassMembers({}, printer);
   }
 
+  // Fingerprints let the driver tell which of the entries above changed when
+  // the interface hash of the file changes. Entries without a fingerprint are
+  // always considered changed.
+  llvm::SmallString<32> hashOutsideDecls;
+  SF->getInterfaceHashOutsideDecls(hashOutsideDecls);
+
+  writer->beginSection(Section::FingerprintsTopLevel);
+  for (auto &entry : topLevelDecls) {
+    std::string fingerprint = getFingerprint(SF, hashOutsideDecls,
+                                             entry.second);
+    if (fingerprint.empty())
+      continue;
+    writer->addEntry({ entry.first.str(), fingerprint });
+  }
+
+  // A nominal's fingerprint covers all of its members, as well as any
+  // extensions of it in this file, so that layout changes are never missed.
+  llvm::MapVector<const NominalTypeDecl *, std::string> nominalFingerprints;
+  for (auto entry : extendedNominals) {
+    const NominalTypeDecl *NTD = entry.first;
+    SmallVector<const Decl *, 4> decls;
+    if (NTD->getDeclContext()->getParentSourceFile() == SF)
+      decls.push_back(NTD);
+    auto extensions = extensionDecls.find(NTD);
+    if (extensions != extensionDecls.end())
+      decls.append(extensions->second.begin(), extensions->second.end());
+
+    std::string fingerprint = getFingerprint(SF, hashOutsideDecls, decls);
+    if (!fingerprint.empty())
+      nominalFingerprints[NTD] = fingerprint;
+  }
+
+  writer->beginSection(Section::FingerprintsNominal);
+  for (auto entry : nominalFingerprints) {
+    if (!extendedNominals.lookup(entry.first))
+      continue;
+    writer->addEntry({ mangleTypeAsContext(entry.first), entry.second });
+  }
+
+  writer->beginSection(Section::FingerprintsMember);
+  for (auto entry : nominalFingerprints)
+    writer->addEntry({ mangleTypeAsContext(entry.first), "", entry.second });
+
+  // Members added by extensions are fingerprinted individually, so that
+  // changing one of them doesn't affect the users of the others.
+  using MemberKeyTy = std::pair<const NominalTypeDecl *, Identifier>;
+  llvm::MapVector<MemberKeyTy, SmallVector<const Decl *, 1>> memberDecls;
+  for (auto *ED : extensionsWithJustMembers) {
+    auto *NTD = ED->getExtendedType()->getAnyNominal();
+    for (auto *member : ED->getMembers()) {
+      auto *VD = dyn_cast<ValueDecl>(member);
+      if (!VD || !VD->hasName() ||
+          VD->getFormalAccess() == Accessibility::Private) {
+        continue;
+      }
+      memberDecls[{NTD, VD->getName()}].push_back(VD);
+    }
+  }
+
+  for (auto &entry : memberDecls) {
+    std::string fingerprint = getFingerprint(SF, hashOutsideDecls,
+                                             entry.second);
+    if (fingerprint.empty())
+      continue;
+    writer->addEntry({ mangleTypeAsContext(entry.first.first),
+                       entry.first.second.str(), fingerprint });
+  }
+
   ReferencedNameTracker *tracker = SF->getReferencedNameTracker();
 
   // FIXME: Sort these?
-  out << "depends-top-level:\n";
+  writer->beginSection(Section::DependsTopLevel);
   for (auto &entry : tracker->getTopLevelNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addEntry(entry.first.str(), /*isCascading=*/entry.second);
   }
 
-  out << "depends-member:\n";
+  writer->beginSection(Section::DependsMember);
   auto &memberLookupTable = tracker->getUsedMembers();
   using TableEntryTy = std::pair<ReferencedNameTracker::MemberPair, bool>;
   std::vector<TableEntryTy> sortedMembers{
@@ -394,18 +496,14 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         entry.first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "[\"";
-    out << mangleTypeAsContext(entry.first.first);
-    out << "\", \"";
+    StringRef memberName;
     if (!entry.first.second.empty())
-      out << escape(entry.first.second);
-    out << "\"]\n";
+      memberName = entry.first.second.str();
+    writer->addEntry({ mangleTypeAsContext(entry.first.first), memberName },
+                     /*isCascading=*/entry.second);
   }
 
-  out << "depends-nominal:\n";
+  writer->beginSection(Section::DependsNominal);
   for (auto i = sortedMembers.begin(), e = sortedMembers.end(); i != e; ++i) {
     bool isCascading = i->second;
     while (i+1 != e && i[0].first.first == i[1].first.first) {
@@ -417,32 +515,25 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         i->first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!isCascading)
-      out << "!private ";
-    out << "\"";
-    out <<  mangleTypeAsContext(i->first.first);
-    out << "\"\n";
+    writer->addEntry(StringRef(mangleTypeAsContext(i->first.first)),
+                     isCascading);
   }
 
   // FIXME: Sort these?
-  out << "depends-dynamic-lookup:\n";
+  writer->beginSection(Section::DependsDynamicLookup);
   for (auto &entry : tracker->getDynamicLookupNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    writer->addEntry(entry.first.str(), /*isCascading=*/entry.second);
   }
 
-  out << "depends-external:\n";
-  for (auto &entry : depTracker.getDependencies()) {
-    out << "- \"" << llvm::yaml::escape(entry) << "\"\n";
-  }
+  writer->beginSection(Section::DependsExternal);
+  for (auto &entry : depTracker.getDependencies())
+    writer->addEntry(StringRef(entry));
 
   llvm::SmallString<32> interfaceHash;
   SF->getInterfaceHash(interfaceHash);
-  out << "interface-hash: \"" << interfaceHash << "\"\n";
+  writer->addInterfaceHash(interfaceHash);
+  writer->finish();
 
   return false;
 }
@@ -607,6 +698,80 @@ private:
 
 // This is a separate function so that it shows up in stack traces.
 LLVM_ATTRIBUTE_NOINLINE
+static size_t countInstructions(const SILModule &Module) {
+  size_t Count = 0;
+  for (const SILFunction &F : Module.getFunctionList())
+    for (const SILBasicBlock &BB : F)
+      Count += BB.size();
+  return Count;
+}
+
+static void countStatsPostSILGen(UnifiedStatsReporter &Stats,
+                                 const SILModule &Module) {
+  auto &C = Stats.getFrontendCounters();
+  C.NumSILGenFunctions += Module.getFunctionList().size();
+  C.NumSILGenVtables += Module.getVTableList().size();
+  C.NumSILGenWitnessTables += Module.getWitnessTableList().size();
+  C.NumSILGenGlobalVariables += Module.getSILGlobalList().size();
+  C.NumSILGenInstructions += countInstructions(Module);
+}
+
+static void countStatsPostSILOpt(UnifiedStatsReporter &Stats,
+                                 const SILModule &Module) {
+  auto &C = Stats.getFrontendCounters();
+  C.NumSILOptFunctions += Module.getFunctionList().size();
+  C.NumSILOptVtables += Module.getVTableList().size();
+  C.NumSILOptWitnessTables += Module.getWitnessTableList().size();
+  C.NumSILOptGlobalVariables += Module.getSILGlobalList().size();
+  C.NumSILOptInstructions += countInstructions(Module);
+  C.NumSILArenaBytesAllocated += Module.getArenaBytesAllocated();
+  C.NumSILInstBytesAllocated += Module.getInstBytesAllocated();
+  C.MaxLiveSILInstructions =
+    std::max<size_t>(C.MaxLiveSILInstructions,
+                     Module.getMaxLiveInstructions());
+}
+
+static void countStatsPostCompile(UnifiedStatsReporter &Stats,
+                                  CompilerInstance &Instance) {
+  auto &C = Stats.getFrontendCounters();
+  C.NumSourceBuffers = Instance.getSourceMgr().getLLVMSourceMgr()
+                         .getNumBuffers();
+  C.NumLoadedModules = Instance.getASTContext().LoadedModules.size();
+  C.NumASTBytesAllocated =
+    Instance.getASTContext().getPermanentBytesAllocated();
+  for (auto File : Instance.getMainModule()->getFiles())
+    if (auto SF = dyn_cast<SourceFile>(File))
+      C.MaxASTBytesAllocatedPerFile =
+        std::max<size_t>(C.MaxASTBytesAllocatedPerFile, SF->ASTBytesAllocated);
+}
+
+/// Creates the stats reporter for this job, naming its file after the module,
+/// the primary input and the kind of output.
+static std::unique_ptr<UnifiedStatsReporter>
+createStatsReporter(const CompilerInvocation &Invocation) {
+  const FrontendOptions &opts = Invocation.getFrontendOptions();
+
+  StringRef InputName = "all";
+  if (opts.isBatchMode())
+    InputName = "batch";
+  else if (opts.PrimaryInput.hasValue() &&
+           opts.PrimaryInput->isFilename())
+    InputName = opts.InputFilenames[opts.PrimaryInput->Index];
+
+  StringRef OutputType = llvm::sys::path::extension(
+                           opts.getSingleOutputFilename());
+  if (OutputType.startswith("."))
+    OutputType = OutputType.drop_front();
+  if (OutputType.empty())
+    OutputType = "none";
+
+  return llvm::make_unique<UnifiedStatsReporter>("swift-frontend",
+                                                 opts.ModuleName, InputName,
+                                                 Invocation.getTargetTriple(),
+                                                 OutputType,
+                                                 opts.StatsOutputDir);
+}
+
 static void debugFailWithAssertion() {
   // This assertion should always fail, per the user's request, and should
   // not be converted to llvm_unreachable.
@@ -619,6 +784,28 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        IRGenOptions &IRGenOpts,
+                                        SourceFile *PrimarySourceFile,
+                                        int &ReturnValue,
+                                        FrontendObserver *observer,
+                                        StringRef ScriptCacheEntryPath);
+
+/// Precompiles the bridging header given as the input, unless the output is
+/// a precompiled header which can still be used.
+/// \returns true on error
+static bool precompileBridgingHeader(CompilerInstance &Instance,
+                                     const FrontendOptions &opts) {
+  auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+  StringRef PCHPath = opts.getSingleOutputFilename();
+  if (llvm::sys::fs::exists(PCHPath) && clangImporter->canReadPCH(PCHPath))
+    return false;
+  return clangImporter->emitBridgingPCH(opts.InputFilenames[0], PCHPath);
+}
+
 /// Performs the compile requested by the user.
 /// \returns true on error
 static bool performCompile(CompilerInstance &Instance,
@@ -629,6 +816,9 @@ static bool performCompile(CompilerInstance &Instance,
   FrontendOptions opts = Invocation.getFrontendOptions();
   FrontendOptions::ActionType Action = opts.RequestedAction;
 
+  if (Action == FrontendOptions::EmitPCH)
+    return precompileBridgingHeader(Instance, opts);
+
   IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
 
   bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
@@ -669,10 +859,34 @@ static bool performCompile(CompilerInstance &Instance,
     return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
   }
 
+  // Run a script compiled by an earlier run if it is still up to date.
+  std::string ScriptCacheEntryPath;
+  if (Action == FrontendOptions::Immediate && !opts.ScriptCachePath.empty()) {
+    ScriptCacheEntryPath =
+      getScriptCacheEntryPath(opts.ScriptCachePath, Args,
+                              Invocation.getInputFilenames());
+    const ProcessCmdLine &CmdLine = ProcessCmdLine(opts.ImmediateArgv.begin(),
+                                                   opts.ImmediateArgv.end());
+    if (!ScriptCacheEntryPath.empty() &&
+        RunCachedScript(Instance, ScriptCacheEntryPath, CmdLine, IRGenOpts,
+                        ReturnValue))
+      return false;
+  }
+
   ReferencedNameTracker nameTracker;
+  std::vector<ReferencedNameTracker> batchNameTrackers;
   bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
-    Instance.setReferencedNameTracker(&nameTracker);
+  if (shouldTrackReferences) {
+    if (opts.isBatchMode()) {
+      batchNameTrackers.resize(opts.BatchPrimaryInputs.size());
+      SmallVector<ReferencedNameTracker *, 8> trackers;
+      for (ReferencedNameTracker &tracker : batchNameTrackers)
+        trackers.push_back(&tracker);
+      Instance.setBatchReferencedNameTrackers(trackers);
+    } else {
+      Instance.setReferencedNameTracker(&nameTracker);
+    }
+  }
 
   if (Action == FrontendOptions::DumpParse ||
       Action == FrontendOptions::DumpInterfaceHash)
@@ -728,12 +942,51 @@ static bool performCompile(CompilerInstance &Instance,
   if (opts.PrintClangStats && Context.getClangModuleLoader())
     Context.getClangModuleLoader()->printStatistics();
 
+  if (!opts.isBatchMode())
+    return performCompileStepsPostSema(Instance, Invocation, opts, IRGenOpts,
+                                       PrimarySourceFile, ReturnValue,
+                                       observer, ScriptCacheEntryPath);
+
+  // In batch mode, everything from here on happens once per primary file,
+  // sharing the ASTContext and every module loaded during type-checking.
+  ArrayRef<SourceFile *> primaryFiles = Instance.getBatchPrimarySourceFiles();
+  bool hadError = false;
+  for (unsigned i : indices(opts.BatchPrimaryInputs)) {
+    FrontendOptions primaryOpts = opts.getOptionsForBatchPrimary(i);
+    IRGenOptions primaryIRGenOpts = IRGenOpts;
+    if (Invocation.getSILOptions().SILOutputFileNameForDebugging.empty()) {
+      unsigned Index = primaryOpts.PrimaryInput->Index;
+      primaryIRGenOpts.MainInputFilename = primaryOpts.InputFilenames[Index];
+    }
+    primaryIRGenOpts.OutputFilenames = primaryOpts.OutputFilenames;
+    hadError |= performCompileStepsPostSema(Instance, Invocation, primaryOpts,
+                                            primaryIRGenOpts, primaryFiles[i],
+                                            ReturnValue, observer,
+                                            StringRef());
+  }
+  return hadError;
+}
+
+/// Performs everything after semantic analysis for the primary file described
+/// by \p opts, or for the whole module if there is no primary file.
+/// \returns true on error
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        IRGenOptions &IRGenOpts,
+                                        SourceFile *PrimarySourceFile,
+                                        int &ReturnValue,
+                                        FrontendObserver *observer,
+                                        StringRef ScriptCacheEntryPath) {
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  ASTContext &Context = Instance.getASTContext();
+
   if (!opts.DependenciesFilePath.empty())
     (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
                                opts);
 
-  if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
+  if (!opts.ReferenceDependenciesFilePath.empty())
+    emitReferenceDependencies(Context.Diags, PrimarySourceFile,
                               *Instance.getDependencyTracker(), opts);
 
   if (Context.hadError())
@@ -778,6 +1031,9 @@ static bool performCompile(CompilerInstance &Instance,
     observer->performedSILGeneration(*SM);
   }
 
+  if (Context.Stats)
+    countStatsPostSILGen(*Context.Stats, *SM);
+
   // We've been told to emit SIL after SILGen, so write it now.
   if (Action == FrontendOptions::EmitSILGen) {
     // If we are asked to link all, link all.
@@ -824,6 +1080,18 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (!opts.OptRecordPath.empty()) {
+    std::error_code EC;
+    auto OS = llvm::make_unique<llvm::raw_fd_ostream>(opts.OptRecordPath, EC,
+                                                      llvm::sys::fs::F_None);
+    if (EC) {
+      Context.Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                             opts.OptRecordPath, EC.message());
+      return true;
+    }
+    SM->setOptRecordStream(std::move(OS));
+  }
+
   // Perform SIL optimization passes if optimizations haven't been disabled.
   // These may change across compiler versions.
   {
@@ -851,6 +1119,9 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (Context.Stats)
+    countStatsPostSILOpt(*Context.Stats, *SM);
+
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
@@ -949,10 +1220,14 @@ static bool performCompile(CompilerInstance &Instance,
     }
 
     ReturnValue =
-      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
+      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions(),
+                     ScriptCacheEntryPath);
     return false;
   }
 
+  // Nothing looks at SIL function bodies once they have been lowered.
+  IRGenOpts.ReleaseSILAfterIRGen = true;
+
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = llvm::getGlobalContext();
@@ -1150,6 +1425,12 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     llvm::EnableStatistics();
   }
 
+  std::unique_ptr<UnifiedStatsReporter> StatsReporter;
+  if (!Invocation.getFrontendOptions().StatsOutputDir.empty()) {
+    StatsReporter = createStatsReporter(Invocation);
+    SharedTimer::setStatsReporter(StatsReporter.get());
+  }
+
   if (Invocation.getDiagnosticOptions().VerifyDiagnostics) {
     enableDiagnosticVerifier(Instance.getSourceMgr());
   }
@@ -1164,6 +1445,8 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     return 1;
   }
 
+  Instance.getASTContext().Stats = StatsReporter.get();
+
   // The compiler instance has been configured; notify our observer.
   if (observer) {
     observer->configuredCompiler(Instance);
@@ -1191,6 +1474,14 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     }
   }
 
+  if (StatsReporter) {
+    countStatsPostCompile(*StatsReporter, Instance);
+    SharedTimer::setStatsReporter(nullptr);
+    Instance.getASTContext().Stats = nullptr;
+    // Writes out the stats file.
+    StatsReporter.reset();
+  }
+
   return (HadError ? 1 : ReturnValue);
 }
 
@@ -73,10 +73,10 @@ void CodeCompletionCache::setImpl(const Key &K, ValueRefCntPtr V,
   }
   Impl->TheCache.set(K, V);
 
-  // FIXME: we could write the results to disk in the background, since they're
-  // immutable at this point.
+  // The results are immutable at this point, so write them to disk in the
+  // background rather than making this completion wait for it.
   if (nextCache && setChain)
-    nextCache->set(K, V);
+    nextCache->setAsync(K, V);
 }
 
 CodeCompletionCache::CodeCompletionCache(OnDiskCodeCompletionCache *nextCache)
@@ -161,13 +161,17 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   (void)stringCount; // so it is not seen as "unused" in release builds.
   
   // STRINGS
+  // Copy the whole string table in one go and point into it, rather than
+  // allocating a copy for every reference to a string.
+  const char *stringsCopy =
+      copyString(*V.Sink.Allocator, StringRef(strings, end - strings)).data();
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
       return "";
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(stringsCopy + (p - strings), size);
   };
 
   // CHUNKS
@@ -482,7 +486,41 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   return V;
 }
 
+void OnDiskCodeCompletionCache::setAsync(const Key &K, ValueRefCntPtr V) {
+  std::lock_guard<std::mutex> lock(pendingWritesMutex);
+  pendingWrites.emplace_back(K, V);
+  if (!writer.joinable())
+    writer = std::thread([this] { runWriter(); });
+  pendingWritesChanged.notify_one();
+}
+
+void OnDiskCodeCompletionCache::runWriter() {
+  std::unique_lock<std::mutex> lock(pendingWritesMutex);
+  while (true) {
+    pendingWritesChanged.wait(
+        lock, [this] { return stopWriter || !pendingWrites.empty(); });
+    if (pendingWrites.empty())
+      return;
+
+    auto write = std::move(pendingWrites.front());
+    pendingWrites.pop_front();
+    lock.unlock();
+    // Failing to write the cache isn't fatal; the results are recomputed
+    // the next time they're needed.
+    (void)set(write.first, write.second);
+    lock.lock();
+  }
+}
+
 OnDiskCodeCompletionCache::OnDiskCodeCompletionCache(Twine cacheDirectory)
     : cacheDirectory(cacheDirectory.str()) {}
 
-OnDiskCodeCompletionCache::~OnDiskCodeCompletionCache() {}
+OnDiskCodeCompletionCache::~OnDiskCodeCompletionCache() {
+  {
+    std::lock_guard<std::mutex> lock(pendingWritesMutex);
+    stopWriter = true;
+  }
+  pendingWritesChanged.notify_one();
+  if (writer.joinable())
+    writer.join();
+}
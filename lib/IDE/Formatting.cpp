@@ -16,6 +16,7 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/IDE/Formatting.h"
+#include "swift/IDE/Utils.h"
 #include "swift/Subsystems.h"
 
 using namespace swift;
@@ -662,7 +663,6 @@ class FormatWalker : public SourceEntityWalker {
 public:
   explicit FormatWalker(SourceFile &SF, SourceManager &SM)
   :SF(SF), SM(SM),
-  Tokens(tokenize(Options, SM, SF.getBufferID().getValue())),
   CurrentTokIt(Tokens.begin()),
   SCollector(SM, Tokens, TargetLocation) {}
 
@@ -671,7 +671,34 @@ public:
     TargetLocation = Loc;
     TargetLine = SM.getLineNumber(TargetLocation);
     AtStart = AtEnd = swift::ASTWalker::ParentTy();
-    walk(SF);
+
+    // Only the top-level declarations around the target line can affect its
+    // indentation, so only they are lexed and walked.
+    unsigned BufferID = SF.getBufferID().getValue();
+    StringRef Text = SM.getLLVMSourceMgr().getMemoryBuffer(BufferID)
+                       ->getBuffer();
+    unsigned Offset = SM.getLocOffsetInBuffer(Loc, BufferID);
+    unsigned LineEnd = std::min(Text.find_first_of("\r\n", Offset),
+                                Text.size());
+    SmallVector<Decl *, 4> Decls;
+    auto Range = findTopLevelDeclsInRange(SF, Offset, LineEnd, Decls);
+    // The sibling collector looks at the token after the last node it visits,
+    // so include the first token after the range too.
+    unsigned LexEnd = Range.second;
+    if (LexEnd < Text.size()) {
+      SourceLoc End = SM.getLocForOffset(BufferID, LexEnd);
+      LexEnd = SM.getLocOffsetInBuffer(Lexer::getLocForEndOfToken(SM, End),
+                                       BufferID);
+    }
+    Tokens.clear();
+    if (Range.first != LexEnd)
+      Tokens = tokenize(Options, SM, BufferID, Range.first, LexEnd);
+    CurrentTokIt = Tokens.begin();
+
+    for (Decl *D : Decls) {
+      if (walk(D))
+        break;
+    }
     scanForComments(SourceLoc());
     return FormatContext(SM, Stack, AtStart, AtEnd, InDocCommentBlock,
                          InCommentLine, SCollector.getSiblingInfo());
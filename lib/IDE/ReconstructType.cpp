@@ -18,6 +18,8 @@
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/Strings.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 
 #include <cstdio>
 #include <cstdarg>
@@ -940,7 +942,8 @@ static void VisitNodeAssociatedTypeRef(
   }
   result._types.clear();
   result._error = stringWithFormat(
-      "unable to find associated type %s in context", ident->getText().c_str());
+      "unable to find associated type %s in context",
+      ident->getText().str().c_str());
 }
 
 static void VisitNodeBoundGeneric(
@@ -987,7 +990,7 @@ static void VisitNodeBuiltinTypeName(
     ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
-  std::string builtin_name = cur_node->getText();
+  std::string builtin_name = cur_node->getText().str();
 
   StringRef builtin_name_ref(builtin_name);
 
@@ -1416,7 +1419,7 @@ static void VisitNodeFunction(
       if (decl_scope_result._decls.size() == 0) {
         result._error = stringWithFormat(
             "demangled identifier %s could not be found by name lookup",
-            (*pos)->getText().c_str());
+            (*pos)->getText().str().c_str());
         break;
       }
       std::copy(decl_scope_result._decls.begin(),
@@ -1780,7 +1783,7 @@ static void VisitNodeIdentifier(
     if (result._error.empty())
       result._error =
           stringWithFormat("unable to find Node::Kind::Identifier '%s'",
-                           cur_node->getText().c_str());
+                           cur_node->getText().str().c_str());
   }
 }
 
@@ -1839,7 +1842,8 @@ static void VisitNodePrivateDeclName(
     if (result._error.empty())
       result._error = stringWithFormat(
           "unable to find Node::Kind::PrivateDeclName '%s' in '%s'",
-          id_node->getText().c_str(), priv_decl_id_node->getText().c_str());
+          id_node->getText().str().c_str(),
+          priv_decl_id_node->getText().str().c_str());
   }
 }
 
@@ -1903,8 +1907,8 @@ static void VisitNodeModule(
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
   std::string error;
-  const char *module_name = cur_node->getText().c_str();
-  if (!module_name || *module_name == '\0') {
+  std::string module_name = cur_node->getText().str();
+  if (module_name.empty()) {
     result._error = stringWithFormat("error: empty module name.");
     return;
   }
@@ -1913,7 +1917,7 @@ static void VisitNodeModule(
       DeclsLookupSource::GetDeclsLookupSource(*ast, ConstString(module_name));
   if (!result._module) {
     result._error = stringWithFormat("unable to load module '%s' (%s)",
-                                     module_name, error.data());
+                                     module_name.c_str(), error.data());
   }
 }
 
@@ -2076,14 +2080,14 @@ static void VisitNodeTupleElement(
     ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
     Demangle::NodePointer &cur_node, VisitNodeResult &result,
     const VisitNodeResult &generic_context) { // set by GenericType case
-  const char *tuple_name = NULL;
+  StringRef tuple_name;
   VisitNodeResult tuple_type_result;
   Demangle::Node::iterator end = cur_node->end();
   for (Demangle::Node::iterator pos = cur_node->begin(); pos != end; ++pos) {
     const Demangle::Node::Kind child_node_kind = (*pos)->getKind();
     switch (child_node_kind) {
     case Demangle::Node::Kind::TupleElementName:
-      tuple_name = (*pos)->getText().c_str();
+      tuple_name = (*pos)->getText();
       break;
     case Demangle::Node::Kind::Type:
       nodes.push_back((*pos)->getFirstChild());
@@ -2096,7 +2100,7 @@ static void VisitNodeTupleElement(
 
   if (tuple_type_result._error.empty() &&
       tuple_type_result._types.size() == 1) {
-    if (tuple_name)
+    if (!tuple_name.empty())
       result._tuple_type_element =
           TupleTypeElt(tuple_type_result._types.front().getPointer(),
                        ast->getIdentifier(tuple_name));
@@ -2384,6 +2388,69 @@ VisitNode(ASTContext *ast, std::vector<Demangle::NodePointer> &nodes,
   nodes.pop_back();
 }
 
+namespace {
+/// The decls and types found for mangled names in one ASTContext.
+///
+/// The debugger asks for the same names over and over, and each lookup
+/// demangles the name and looks it up in the modules again. Only successful
+/// lookups are cached, because a failed one may succeed once more modules
+/// are loaded.
+class ReconstructedTypeCache {
+  std::mutex Mutex;
+  llvm::StringMap<Decl *> DeclsBySymbolName;
+  llvm::StringMap<Type> TypesByTypeName;
+  llvm::StringMap<Type> TypesBySymbolName;
+
+  template <typename T>
+  T lookup(llvm::StringMap<T> &map, StringRef name) {
+    std::lock_guard<std::mutex> guard(Mutex);
+    return map.lookup(name);
+  }
+
+  template <typename T>
+  void insert(llvm::StringMap<T> &map, StringRef name, T value) {
+    std::lock_guard<std::mutex> guard(Mutex);
+    map[name] = value;
+  }
+
+public:
+  Decl *lookupDecl(StringRef symbolName) {
+    return lookup(DeclsBySymbolName, symbolName);
+  }
+  void insertDecl(StringRef symbolName, Decl *decl) {
+    insert(DeclsBySymbolName, symbolName, decl);
+  }
+
+  Type lookupType(StringRef name, bool isSymbolName) {
+    return lookup(isSymbolName ? TypesBySymbolName : TypesByTypeName, name);
+  }
+  void insertType(StringRef name, bool isSymbolName, Type type) {
+    insert(isSymbolName ? TypesBySymbolName : TypesByTypeName, name, type);
+  }
+};
+} // end anonymous namespace
+
+static std::mutex ReconstructedTypeCachesMutex;
+static llvm::DenseMap<ASTContext *, std::unique_ptr<ReconstructedTypeCache>>
+  ReconstructedTypeCaches;
+
+/// Returns the cache for \p ctx, creating it on first use.
+///
+/// The caches live outside the ASTContext so that the AST library doesn't
+/// have to know about them; each one is destroyed with its context.
+static ReconstructedTypeCache &getReconstructedTypeCache(ASTContext &ctx) {
+  std::lock_guard<std::mutex> guard(ReconstructedTypeCachesMutex);
+  auto &cache = ReconstructedTypeCaches[&ctx];
+  if (!cache) {
+    cache.reset(new ReconstructedTypeCache());
+    ctx.addCleanup([&ctx] {
+      std::lock_guard<std::mutex> guard(ReconstructedTypeCachesMutex);
+      ReconstructedTypeCaches.erase(&ctx);
+    });
+  }
+  return *cache;
+}
+
 Decl *ide::getDeclFromUSR(ASTContext &context, StringRef USR,
                           std::string &error) {
   if (!USR.startswith("s:")) {
@@ -2404,15 +2471,25 @@ Decl *ide::getDeclFromUSR(ASTContext &context, StringRef USR,
 Decl *ide::getDeclFromMangledSymbolName(ASTContext &context,
                                         StringRef mangledName,
                                         std::string &error) {
+  auto &cache = getReconstructedTypeCache(context);
+  if (Decl *cached = cache.lookupDecl(mangledName)) {
+    error.clear();
+    return cached;
+  }
+
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
   nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size()));
+      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size(),
+                                     factory));
   VisitNodeResult emptyGenericContext;
   VisitNodeResult result;
   VisitNode(&context, nodes, result, emptyGenericContext);
   error = result._error;
   if (error.empty() && result._decls.size() == 1) {
-    return result._decls.front();
+    Decl *decl = result._decls.front();
+    cache.insertDecl(mangledName, decl);
+    return decl;
   } else {
     llvm::raw_string_ostream OS(error);
     OS << "decl for symbol name '" << mangledName << "' was not found";
@@ -2424,16 +2501,26 @@ Decl *ide::getDeclFromMangledSymbolName(ASTContext &context,
 Type ide::getTypeFromMangledTypename(ASTContext &Ctx,
                                      StringRef mangledName,
                                      std::string &error) {
+  auto &cache = getReconstructedTypeCache(Ctx);
+  if (Type cached = cache.lookupType(mangledName, /*isSymbolName*/ false)) {
+    error.clear();
+    return cached;
+  }
+
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
   nodes.push_back(
-      Demangle::demangleTypeAsNode(mangledName.data(), mangledName.size()));
+      Demangle::demangleTypeAsNode(mangledName.data(), mangledName.size(),
+                                   factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
   VisitNode(&Ctx, nodes, result, empty_generic_context);
   error = result._error;
   if (error.empty() && result._types.size() == 1) {
-    return result._types.front().getPointer();
+    Type type = result._types.front().getPointer();
+    cache.insertType(mangledName, /*isSymbolName*/ false, type);
+    return type;
   } else {
     error = stringWithFormat("type for typename '%s' was not found",
                              mangledName);
@@ -2445,16 +2532,26 @@ Type ide::getTypeFromMangledTypename(ASTContext &Ctx,
 Type ide::getTypeFromMangledSymbolname(ASTContext &Ctx,
                                        StringRef mangledName,
                                        std::string &error) {
+  auto &cache = getReconstructedTypeCache(Ctx);
+  if (Type cached = cache.lookupType(mangledName, /*isSymbolName*/ true)) {
+    error.clear();
+    return cached;
+  }
+
+  Demangle::NodeFactory factory;
   std::vector<Demangle::NodePointer> nodes;
   nodes.push_back(
-      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size()));
+      Demangle::demangleSymbolAsNode(mangledName.data(), mangledName.size(),
+                                     factory));
   VisitNodeResult empty_generic_context;
   VisitNodeResult result;
 
   VisitNode(&Ctx, nodes, result, empty_generic_context);
   error = result._error;
   if (error.empty() && result._types.size() == 1) {
-    return result._types.front().getPointer();
+    Type type = result._types.front().getPointer();
+    cache.insertType(mangledName, /*isSymbolName*/ true, type);
+    return type;
   } else {
     error = stringWithFormat("type for symbolname '%s' was not found",
                              mangledName);
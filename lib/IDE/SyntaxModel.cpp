@@ -23,9 +23,11 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/Token.h"
 #include "swift/Config.h"
+#include "swift/IDE/Utils.h"
 #include "swift/Subsystems.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include <vector>
 #include <regex>
 
@@ -38,22 +40,31 @@ struct SyntaxModelContext::Implementation {
   SourceFile &SrcFile;
   const LangOptions &LangOpts;
   const SourceManager &SrcMgr;
-  std::vector<SyntaxNode> TokenNodes;
+
+  /// The token nodes of the whole file, computed by the first walk of it.
+  Optional<std::vector<SyntaxNode>> TokenNodes;
 
   Implementation(SourceFile &SrcFile)
     : SrcFile(SrcFile),
       LangOpts(SrcFile.getASTContext().LangOpts),
       SrcMgr(SrcFile.getASTContext().SourceMgr) {}
+
+  std::vector<SyntaxNode> getTokenNodes(unsigned Offset, unsigned EndOffset);
 };
 
 SyntaxModelContext::SyntaxModelContext(SourceFile &SrcFile)
-  : Impl(*new Implementation(SrcFile)) {
-  const bool IsPlayground = Impl.LangOpts.Playground;
-  const SourceManager &SM = Impl.SrcMgr;
-  std::vector<Token> Tokens = swift::tokenize(Impl.LangOpts, SM,
-                                              *Impl.SrcFile.getBufferID(),
-                                              /*Offset=*/0,
-                                              /*EndOffset=*/0,
+  : Impl(*new Implementation(SrcFile)) {}
+
+/// Returns the token nodes of the bytes from \p Offset to \p EndOffset, which
+/// must be between tokens, or of the whole file if both are 0.
+std::vector<SyntaxNode>
+SyntaxModelContext::Implementation::getTokenNodes(unsigned Offset,
+                                                  unsigned EndOffset) {
+  const bool IsPlayground = LangOpts.Playground;
+  const SourceManager &SM = SrcMgr;
+  std::vector<Token> Tokens = swift::tokenize(LangOpts, SM,
+                                              *SrcFile.getBufferID(),
+                                              Offset, EndOffset,
                                               /*KeepComments=*/true,
                                            /*TokenizeInterpolatedString=*/true);
   std::vector<SyntaxNode> Nodes;
@@ -200,7 +211,7 @@ SyntaxModelContext::SyntaxModelContext(SourceFile &SrcFile)
     Nodes.emplace_back(Kind, CharSourceRange(Loc, Length.getValue()));
   }
 
-  Impl.TokenNodes = std::move(Nodes);
+  return Nodes;
 }
 
 SyntaxModelContext::~SyntaxModelContext() {
@@ -282,6 +293,11 @@ public:
 
   void visitSourceFile(SourceFile &SrcFile, ArrayRef<SyntaxNode> Tokens);
 
+  /// Walks the top-level declarations \p Decls of \p SrcFile, which are
+  /// covered by \p Tokens.
+  void visitDecls(SourceFile &SrcFile, ArrayRef<Decl *> Decls,
+                  ArrayRef<SyntaxNode> Tokens);
+
   std::pair<bool, Expr *> walkToExprPre(Expr *E) override;
   Expr *walkToExprPost(Expr *E) override;
   std::pair<bool, Stmt *> walkToStmtPre(Stmt *S) override;
@@ -418,9 +434,45 @@ CharSourceRange parameterNameRangeOfCallArg(const TupleExpr *TE,
 } // anonymous namespace
 
 bool SyntaxModelContext::walk(SyntaxModelWalker &Walker) {
+  if (!Impl.TokenNodes)
+    Impl.TokenNodes = Impl.getTokenNodes(/*Offset=*/0, /*EndOffset=*/0);
+
+  ModelASTWalker ASTWalk(Impl.LangOpts, Impl.SrcMgr,
+                         *Impl.SrcFile.getBufferID(), Walker);
+  ASTWalk.visitSourceFile(Impl.SrcFile, *Impl.TokenNodes);
+  return true;
+}
+
+bool SyntaxModelContext::walk(SyntaxModelWalker &Walker, unsigned Offset,
+                              unsigned Length) {
+  SmallVector<Decl *, 4> Decls;
+  auto Range = findTopLevelDeclsInRange(Impl.SrcFile, Offset, Offset + Length,
+                                        Decls);
+
+  std::vector<SyntaxNode> RangeTokenNodes;
+  ArrayRef<SyntaxNode> TokenNodes;
+  if (Impl.TokenNodes) {
+    // Reuse the nodes of a previous walk of the whole file.
+    const SourceManager &SM = Impl.SrcMgr;
+    unsigned BufferID = *Impl.SrcFile.getBufferID();
+    auto IsBefore = [&](const SyntaxNode &Node, unsigned NodeOffset) {
+      return SM.getLocOffsetInBuffer(Node.Range.getStart(), BufferID) <
+             NodeOffset;
+    };
+    ArrayRef<SyntaxNode> AllNodes = *Impl.TokenNodes;
+    auto First = std::lower_bound(AllNodes.begin(), AllNodes.end(),
+                                  Range.first, IsBefore);
+    auto Last = std::lower_bound(First, AllNodes.end(), Range.second,
+                                 IsBefore);
+    TokenNodes = AllNodes.slice(First - AllNodes.begin(), Last - First);
+  } else if (Range.first != Range.second) {
+    RangeTokenNodes = Impl.getTokenNodes(Range.first, Range.second);
+    TokenNodes = RangeTokenNodes;
+  }
+
   ModelASTWalker ASTWalk(Impl.LangOpts, Impl.SrcMgr,
                          *Impl.SrcFile.getBufferID(), Walker);
-  ASTWalk.visitSourceFile(Impl.SrcFile, Impl.TokenNodes);
+  ASTWalk.visitDecls(Impl.SrcFile, Decls, TokenNodes);
   return true;
 }
 
@@ -434,6 +486,20 @@ void ModelASTWalker::visitSourceFile(SourceFile &SrcFile,
     passNode(TokNode);
 }
 
+void ModelASTWalker::visitDecls(SourceFile &SrcFile, ArrayRef<Decl *> Decls,
+                                ArrayRef<SyntaxNode> Tokens) {
+  TokenNodes = Tokens;
+  llvm::SaveAndRestore<ParentTy> SAR(Parent, SrcFile.getParentModule());
+  for (Decl *D : Decls) {
+    if (D->walk(*this))
+      break;
+  }
+
+  // Pass the rest of the token nodes.
+  for (auto &TokNode : TokenNodes)
+    passNode(TokNode);
+}
+
 std::pair<bool, Expr *> ModelASTWalker::walkToExprPre(Expr *E) {
   if (isVisitedBeforeInIfConfigStmt(E))
     return {false, E};
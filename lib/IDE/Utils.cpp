@@ -772,3 +772,47 @@ void ide::collectModuleNames(StringRef SDKPath,
   }
 }
 
+
+std::pair<unsigned, unsigned>
+ide::findTopLevelDeclsInRange(SourceFile &SF, unsigned Offset,
+                              unsigned EndOffset,
+                              SmallVectorImpl<Decl *> &Decls) {
+  const SourceManager &SM = SF.getASTContext().SourceMgr;
+  unsigned BufferID = *SF.getBufferID();
+  unsigned Begin = 0;
+  unsigned End = SM.getRangeForBuffer(BufferID).getByteLength();
+
+  // An empty range still overlaps the declaration containing it.
+  unsigned OverlapEnd = std::max(EndOffset, Offset + 1);
+
+  unsigned DeclsBegin = Offset;
+  unsigned DeclsEnd = EndOffset;
+  for (Decl *D : SF.Decls) {
+    SourceRange Range = D->getSourceRange();
+    if (D->isImplicit() || Range.isInvalid())
+      continue;
+    // The accessors of a variable are outside of its source range.
+    if (auto *VD = dyn_cast<VarDecl>(D)) {
+      if (VD->getBracesRange().isValid())
+        Range.End = VD->getBracesRange().End;
+    }
+    unsigned DeclBegin = SM.getLocOffsetInBuffer(Range.Start, BufferID);
+    unsigned DeclEnd = SM.getLocOffsetInBuffer(
+      Lexer::getLocForEndOfToken(SM, Range.End), BufferID);
+
+    if (DeclEnd <= Offset) {
+      Begin = std::max(Begin, DeclEnd);
+    } else if (DeclBegin >= OverlapEnd) {
+      End = std::min(End, DeclBegin);
+    } else {
+      Decls.push_back(D);
+      DeclsBegin = std::min(DeclsBegin, DeclBegin);
+      DeclsEnd = std::max(DeclsEnd, DeclEnd);
+    }
+  }
+
+  // The declarations inside a top-level #if are top-level too, so the
+  // declarations before and after the range may be inside one which overlaps
+  // it.
+  return { std::min(Begin, DeclsBegin), std::max(End, DeclsEnd) };
+}
@@ -74,14 +74,22 @@ protected:
 
   llvm::Constant *getRelativeAddressFromNextField(ConstantReference referent,
                                             llvm::IntegerType *addressTy) {
+    return getRelativeAddressFromField(referent, getNextOffset(), addressTy);
+  }
+
+  /// Produce a relative address of \p referent from the field at
+  /// \p fieldOffset, which may be a field that was reserved earlier.
+  llvm::Constant *getRelativeAddressFromField(ConstantReference referent,
+                                              Size fieldOffset,
+                                              llvm::IntegerType *addressTy) {
     assert(relativeAddressBase && "no relative address base set");
     
-    // Determine the address of the next field in the initializer.
+    // Determine the address of the field in the initializer.
     llvm::Constant *fieldAddr =
       llvm::ConstantExpr::getPtrToInt(relativeAddressBase, IGM.IntPtrTy);
     fieldAddr = llvm::ConstantExpr::getAdd(fieldAddr,
                           llvm::ConstantInt::get(IGM.SizeTy,
-                                                 getNextOffset().getValue()));
+                                                 fieldOffset.getValue()));
     llvm::Constant *referentValue =
       llvm::ConstantExpr::getPtrToInt(referent.getValue(), IGM.IntPtrTy);
 
@@ -206,6 +206,14 @@ void irgen::emitBuiltinCall(IRGenFunction &IGF, Identifier FnId,
     return;
   }
 
+  if (Builtin.ID == BuiltinValueKind::IsBitwiseTakable) {
+    args.claimAll();
+    auto valueTy = getLoweredTypeAndTypeInfo(IGF.IGM,
+                                             substitutions[0].getReplacement());
+    out.add(valueTy.second.getIsBitwiseTakable(IGF, valueTy.first));
+    return;
+  }
+
 
   // addressof expects an lvalue argument.
   if (Builtin.ID == BuiltinValueKind::AddressOf) {
@@ -731,6 +739,8 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      if (IGF.IGM.TargetInfo.OnceDonePredicateNeedsAcquire)
+        PredValue->setOrdering(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
@@ -2053,6 +2053,17 @@ llvm::Constant *IRGenModule::emitProtocolConformances() {
                                       /*initializer*/ nullptr,
                                       "\x01l_protocol_conformances");
 
+  // Group the records by protocol. The runtime indexes each section by
+  // protocol when it is first scanned, and contiguous records collapse into
+  // a single entry of that index.
+  std::stable_sort(ProtocolConformances.begin(), ProtocolConformances.end(),
+                   [](NormalProtocolConformance *lhs,
+                      NormalProtocolConformance *rhs) {
+    ProtocolDecl *lhsProto = lhs->getProtocol();
+    ProtocolDecl *rhsProto = rhs->getProtocol();
+    return ProtocolType::compareProtocols(&lhsProto, &rhsProto) < 0;
+  });
+
   SmallVector<llvm::Constant*, 8> elts;
   for (auto *conformance : ProtocolConformances) {
     emitAssociatedTypeMetadataRecord(conformance);
@@ -1096,7 +1096,11 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
                                            CanSILFunctionType origType,
                                            CanSILFunctionType substType,
                                            CanSILFunctionType outType,
-                                           Explosion &out) {
+                                           Explosion &out,
+                                           int &StackAllocSize) {
+  int AvailableStackSize = StackAllocSize;
+  StackAllocSize = -1;
+
   // If we have a single Swift-refcounted context value, we can adopt it
   // directly as our closure context without creating a box and thunk.
   enum HasSingleSwiftRefcountedContext { Maybe, Yes, No, Thunkable }
@@ -1310,7 +1314,19 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
     // Allocate a new object.
     HeapNonFixedOffsets offsets(IGF, layout);
 
-    data = IGF.emitUnmanagedAlloc(layout, "closure", descriptor, &offsets);
+    if (layout.isFixedLayout() &&
+        (int)layout.getSize().getValue() < AvailableStackSize) {
+      // Allocate the context on the stack.
+      auto Alloca = IGF.createAlloca(layout.getType(), layout.getAlignment(),
+                                     "closure.raw");
+      data = IGF.Builder.CreateBitCast(Alloca.getAddress(),
+                                       IGF.IGM.RefCountedPtrTy);
+      data = IGF.emitInitStackObjectCall(
+          layout.getPrivateMetadata(IGF.IGM, descriptor), data, "closure");
+      StackAllocSize = layout.getSize().getValue();
+    } else {
+      data = IGF.emitUnmanagedAlloc(layout, "closure", descriptor, &offsets);
+    }
     Address dataAddr = layout.emitCastTo(IGF, data);
     
     unsigned i = 0;
@@ -47,6 +47,11 @@ namespace irgen {
 
   /// Emit a partial application thunk for a function pointer applied to a
   /// partial set of argument values.
+  ///
+  /// If \p StackAllocSize is not negative, it is the number of bytes available
+  /// for allocating the context on the stack. On return it is the number of
+  /// bytes actually allocated on the stack, or -1 if the context is not a
+  /// stack allocation.
   void emitFunctionPartialApplication(IRGenFunction &IGF,
                                       SILFunction &SILFn,
                                       llvm::Value *fnPtr,
@@ -57,7 +62,8 @@ namespace irgen {
                                       CanSILFunctionType origType,
                                       CanSILFunctionType substType,
                                       CanSILFunctionType outType,
-                                      Explosion &out);
+                                      Explosion &out,
+                                      int &StackAllocSize);
   
 } // end namespace irgen
 } // end namespace swift
@@ -1465,6 +1465,66 @@ static void maybeEmitNominalTypeMetadataAccessFunction(IRGenModule &IGM,
   builder.createMetadataAccessFunction();
 }
 
+/// Should a use of the metadata for the given type check the accessor's
+/// cache variable inline, instead of always calling the accessor?
+///
+/// This is done for fully-substituted generic types, tuple types and function
+/// types when optimizing: their accessors are emitted into every module that
+/// uses them, along with their cache variables, and calling the runtime to
+/// unique them is slow enough that we want the common, already-initialized
+/// case to be just a load.
+static bool shouldInlineTypeMetadataCacheCheck(IRGenModule &IGM,
+                                               CanType type,
+                                               ForDefinition_t shouldDefine) {
+  if (!IGM.IRGen.Opts.Optimize)
+    return false;
+
+  // We can only see the cache variable of accessors we define ourselves.
+  if (!shouldDefine)
+    return false;
+
+  return isa<BoundGenericType>(type) || isa<TupleType>(type) ||
+         isa<AnyFunctionType>(type);
+}
+
+/// Load the metadata from the cache variable of the given accessor, and
+/// call the accessor only if it has not been initialized yet.
+static llvm::Value *emitInlineCachedTypeMetadataAccess(IRGenFunction &IGF,
+                                                       CanType type,
+                                                 llvm::Function *accessor) {
+  auto cacheVariable =
+    IGF.IGM.getAddrOfTypeMetadataLazyCacheVariable(type, NotForDefinition);
+  Address cache(cacheVariable, IGF.IGM.getPointerAlignment());
+
+  // This is the same naked load that emitLazyCacheAccessFunction does.
+  auto load = IGF.Builder.CreateLoad(cache);
+  if (IGF.IGM.IRGen.Opts.Sanitize == SanitizerKind::Thread)
+    load->setOrdering(llvm::AtomicOrdering::Acquire);
+
+  llvm::Constant *null =
+    llvm::ConstantPointerNull::get(IGF.IGM.TypeMetadataPtrTy);
+  auto isNullBB = IGF.createBasicBlock("metadataCacheIsNull");
+  auto contBB = IGF.createBasicBlock("metadataCacheCont");
+  llvm::Value *comparison = IGF.Builder.CreateICmpEQ(load, null);
+  IGF.Builder.CreateCondBr(comparison, isNullBB, contBB);
+  auto loadBB = IGF.Builder.GetInsertBlock();
+
+  // The accessor initializes the cache variable.
+  IGF.Builder.emitBlock(isNullBB);
+  llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
+  call->setCallingConv(IGF.IGM.DefaultCC);
+  call->setDoesNotAccessMemory();
+  call->setDoesNotThrow();
+  IGF.Builder.CreateBr(contBB);
+  auto callBB = IGF.Builder.GetInsertBlock();
+
+  IGF.Builder.emitBlock(contBB);
+  auto phi = IGF.Builder.CreatePHI(IGF.IGM.TypeMetadataPtrTy, 2);
+  phi->addIncoming(load, loadBB);
+  phi->addIncoming(call, callBB);
+  return phi;
+}
+
 /// Emit a call to the type metadata accessor for the given function.
 static llvm::Value *emitCallToTypeMetadataAccessFunction(IRGenFunction &IGF,
                                                          CanType type,
@@ -1474,17 +1534,25 @@ static llvm::Value *emitCallToTypeMetadataAccessFunction(IRGenFunction &IGF,
         IGF.tryGetLocalTypeData(type, LocalTypeDataKind::forTypeMetadata()))
     return local;
   
-  llvm::Constant *accessor =
+  llvm::Function *accessor =
     getTypeMetadataAccessFunction(IGF.IGM, type, shouldDefine);
-  llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
-  call->setCallingConv(IGF.IGM.DefaultCC);
-  call->setDoesNotAccessMemory();
-  call->setDoesNotThrow();
+
+  llvm::Value *result;
+  if (shouldInlineTypeMetadataCacheCheck(IGF.IGM, type, shouldDefine)) {
+    result = emitInlineCachedTypeMetadataAccess(IGF, type, accessor);
+  } else {
+    llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
+    call->setCallingConv(IGF.IGM.DefaultCC);
+    call->setDoesNotAccessMemory();
+    call->setDoesNotThrow();
+    result = call;
+  }
   
   // Save the metadata for future lookups.
-  IGF.setScopedLocalTypeData(type, LocalTypeDataKind::forTypeMetadata(), call);
+  IGF.setScopedLocalTypeData(type, LocalTypeDataKind::forTypeMetadata(),
+                             result);
   
-  return call;
+  return result;
 }
 
 /// Produce the type metadata pointer for the given type.
@@ -2845,10 +2913,20 @@ namespace {
 
     SmallVector<FillOp, 8> FillOps;
 
-    enum { TemplateHeaderFieldCount = 5 };
     enum { NumPrivateDataWords = swift::NumGenericMetadataPrivateDataWords };
     Size TemplateHeaderSize;
 
+    /// The 32-bit fields at the start of the template header don't fill a
+    /// whole number of words on 64-bit targets, so the private data needs to
+    /// be padded out.
+    bool needsTemplateHeaderPadding() const {
+      return IGM.getPointerSize() != Size(4);
+    }
+
+    unsigned getTemplateHeaderFieldCount() const {
+      return needsTemplateHeaderPadding() ? 6 : 5;
+    }
+
   protected:
     /// The offset of the address point in the type we're emitting.
     Size AddressPoint = Size::invalid();
@@ -2984,11 +3062,15 @@ namespace {
     }
 
     void layout() {
+      Size headerFieldsSize = Size(12);
+      if (needsTemplateHeaderPadding())
+        headerFieldsSize += Size(4);
       TemplateHeaderSize =
-        ((NumPrivateDataWords + 1) * IGM.getPointerSize()) + Size(8);
+        NumPrivateDataWords * IGM.getPointerSize() + headerFieldsSize;
 
       // Leave room for the header.
-      auto header = this->reserveFields(TemplateHeaderFieldCount,
+      Size headerOffset = super::getNextOffset();
+      auto header = this->reserveFields(getTemplateHeaderFieldCount(),
                                         TemplateHeaderSize);
 
       // Lay out the template data.
@@ -3009,10 +3091,16 @@ namespace {
       // Fill in the header:
       unsigned Field = 0;
       auto headerFields =
-        this->claimReservation(header, TemplateHeaderFieldCount);
+        this->claimReservation(header, getTemplateHeaderFieldCount());
 
-      //   Metadata *(*CreateFunction)(GenericMetadata *, const void*);
-      headerFields[Field++] = emitCreateFunction();
+      //   RelativeDirectPointer<Metadata *(GenericMetadata *, const void*)>
+      //     CreateFunction;
+      // This is relative so that the pattern doesn't need to be rebased when
+      // the image is loaded.
+      headerFields[Field++] =
+        this->getRelativeAddressFromField(
+                              {emitCreateFunction(), ConstantReference::Direct},
+                              headerOffset, IGM.RelativeAddressTy);
       
       //   uint32_t MetadataSize;
       // We compute this assuming that every entry in the metadata table
@@ -3034,10 +3122,14 @@ namespace {
       headerFields[Field++]
         = llvm::ConstantInt::get(IGM.Int16Ty, AddressPoint.getValue());
 
+      //   (padding to pointer alignment)
+      if (needsTemplateHeaderPadding())
+        headerFields[Field++] = llvm::ConstantInt::get(IGM.Int32Ty, 0);
+
       //   void *PrivateData[NumPrivateDataWords];
       headerFields[Field++] = getPrivateDataInit();
 
-      assert(TemplateHeaderFieldCount == Field);
+      assert(getTemplateHeaderFieldCount() == Field);
     }
 
     /// Write down the index of the address point.
@@ -3048,7 +3140,6 @@ namespace {
 
     /// Ignore the preallocated header.
     Size getNextOffset() const {
-      // Note that the header fields are all pointer-sized.
       return super::getNextOffset() - TemplateHeaderSize;
     }
 
@@ -135,15 +135,15 @@ public:
 
   void assignWithCopy(IRGenFunction &IGF, Address dest,
                       Address src, SILType T) const override {
-    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
-    for (auto &field : getFields()) {
-      if (field.isEmpty()) continue;
-
-      Address destField = field.projectAddress(IGF, dest, offsets);
-      Address srcField = field.projectAddress(IGF, src, offsets);
-      field.getTypeInfo().assignWithCopy(IGF, destField, srcField,
-                                         field.getType(IGF.IGM, T));
+    if (shouldOutlineValueOperations(IGF.IGM, T)) {
+      callOutlinedOperation(IGF, "assignWithCopy", {dest, src}, T,
+                            [&](IRGenFunction &helperIGF,
+                                ArrayRef<Address> addrs) {
+        emitAssignWithCopy(helperIGF, addrs[0], addrs[1], T);
+      });
+      return;
     }
+    emitAssignWithCopy(IGF, dest, src, T);
   }
 
   void assignWithTake(IRGenFunction &IGF, Address dest,
@@ -169,15 +169,15 @@ public:
                LoadableTypeInfo::initializeWithCopy(IGF, dest, src, T);
     }
 
-    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
-    for (auto &field : getFields()) {
-      if (field.isEmpty()) continue;
-
-      Address destField = field.projectAddress(IGF, dest, offsets);
-      Address srcField = field.projectAddress(IGF, src, offsets);
-      field.getTypeInfo().initializeWithCopy(IGF, destField, srcField,
-                                             field.getType(IGF.IGM, T));
+    if (shouldOutlineValueOperations(IGF.IGM, T)) {
+      callOutlinedOperation(IGF, "initializeWithCopy", {dest, src}, T,
+                            [&](IRGenFunction &helperIGF,
+                                ArrayRef<Address> addrs) {
+        emitInitializeWithCopy(helperIGF, addrs[0], addrs[1], T);
+      });
+      return;
     }
+    emitInitializeWithCopy(IGF, dest, src, T);
   }
   
   void initializeWithTake(IRGenFunction &IGF,
@@ -203,6 +203,45 @@ public:
   }
 
   void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
+    if (shouldOutlineValueOperations(IGF.IGM, T)) {
+      callOutlinedOperation(IGF, "destroy", {addr}, T,
+                            [&](IRGenFunction &helperIGF,
+                                ArrayRef<Address> addrs) {
+        emitDestroy(helperIGF, addrs[0], T);
+      });
+      return;
+    }
+    emitDestroy(IGF, addr, T);
+  }
+
+private:
+  void emitAssignWithCopy(IRGenFunction &IGF, Address dest,
+                          Address src, SILType T) const {
+    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
+    for (auto &field : getFields()) {
+      if (field.isEmpty()) continue;
+
+      Address destField = field.projectAddress(IGF, dest, offsets);
+      Address srcField = field.projectAddress(IGF, src, offsets);
+      field.getTypeInfo().assignWithCopy(IGF, destField, srcField,
+                                         field.getType(IGF.IGM, T));
+    }
+  }
+
+  void emitInitializeWithCopy(IRGenFunction &IGF, Address dest,
+                              Address src, SILType T) const {
+    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
+    for (auto &field : getFields()) {
+      if (field.isEmpty()) continue;
+
+      Address destField = field.projectAddress(IGF, dest, offsets);
+      Address srcField = field.projectAddress(IGF, src, offsets);
+      field.getTypeInfo().initializeWithCopy(IGF, destField, srcField,
+                                             field.getType(IGF.IGM, T));
+    }
+  }
+
+  void emitDestroy(IRGenFunction &IGF, Address addr, SILType T) const {
     auto offsets = asImpl().getNonFixedOffsets(IGF, T);
     for (auto &field : getFields()) {
       if (field.isPOD()) continue;
@@ -211,6 +250,57 @@ public:
                                   field.getType(IGF.IGM, T));
     }
   }
+
+  /// Should copies and destroys of values of type \p T call a helper function
+  /// shared by all their uses, instead of handling each field inline?
+  ///
+  /// This is only done for fixed-size, non-generic types, whose number of
+  /// non-trivial fields reaches -outline-value-operations.
+  bool shouldOutlineValueOperations(IRGenModule &IGM, SILType T) const {
+    unsigned threshold = IGM.IRGen.Opts.OutlineValueOperationsThreshold;
+    if (threshold == 0 || !this->isFixedSize() || T.hasArchetype())
+      return false;
+
+    unsigned numNonTrivialFields = 0;
+    for (auto &field : getFields())
+      if (!field.isPOD())
+        ++numNonTrivialFields;
+    return numNonTrivialFields >= threshold;
+  }
+
+  /// Calls the helper function performing \p operation on the values of
+  /// type \p T at \p addrs. If the helper does not exist yet, its body is
+  /// emitted with \p emitInline.
+  void callOutlinedOperation(IRGenFunction &IGF, StringRef operation,
+                             ArrayRef<Address> addrs, SILType T,
+                             llvm::function_ref<void(IRGenFunction &,
+                                                     ArrayRef<Address>)>
+                                 emitInline) const {
+    IRGenModule &IGM = IGF.IGM;
+    llvm::SmallString<64> name;
+    llvm::raw_svector_ostream(name) << "__swift_outlined_" << operation << '_';
+    IGM.mangleType(T.getSwiftRValueType(), name);
+
+    llvm::Type *ptrTy = this->getStorageType()->getPointerTo();
+    Alignment align = cast<FixedTypeInfo>(this)->getFixedAlignment();
+    SmallVector<llvm::Type *, 2> argTys(addrs.size(), ptrTy);
+
+    auto fn = IGM.getOrCreateHelperFunction(name, IGM.VoidTy, argTys,
+                                            [&](IRGenFunction &helperIGF) {
+      SmallVector<Address, 2> helperAddrs;
+      for (auto &arg : helperIGF.CurFn->args())
+        helperAddrs.push_back(Address(&arg, align));
+      emitInline(helperIGF, helperAddrs);
+      helperIGF.Builder.CreateRetVoid();
+    });
+
+    SmallVector<llvm::Value *, 2> args;
+    for (Address addr : addrs)
+      args.push_back(IGF.Builder.CreateBitCast(addr.getAddress(), ptrTy));
+    auto call = IGF.Builder.CreateCall(fn, args);
+    call->setCallingConv(IGM.DefaultCC);
+    call->setDoesNotThrow();
+  }
 };
 
 template <class Impl, class Base, class FieldImpl_,
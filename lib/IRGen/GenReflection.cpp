@@ -27,6 +27,7 @@
 #include "GenClass.h"
 #include "GenHeap.h"
 #include "GenProto.h"
+#include "GenStruct.h"
 #include "IRGenModule.h"
 #include "LoadableTypeInfo.h"
 
@@ -344,6 +345,10 @@ class FieldTypeMetadataBuilder : public ReflectionMetadataBuilder {
             kind = FieldDescriptorKind::ObjCClass;
           else
             kind = FieldDescriptorKind::Class;
+        } else if (canReorderStructFields(IGM, cast<StructDecl>(NTD)) &&
+                   isa<FixedTypeInfo>(IGM.getTypeInfoForUnlowered(type))) {
+          // Fields are only reordered if they all have a fixed size.
+          kind = FieldDescriptorKind::ReorderedStruct;
         }
 
         addConstantInt16(uint16_t(kind));
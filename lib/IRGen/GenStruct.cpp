@@ -107,6 +107,9 @@ namespace {
      public RecordTypeInfo<Impl, Base, FieldInfoType> {
     typedef RecordTypeInfo<Impl, Base, FieldInfoType> super;
 
+    /// The index of the field providing the struct's extra inhabitants.
+    unsigned ExtraInhabitantFieldIndex = 0;
+
   protected:
     template <class... As>
     StructTypeInfoBase(StructTypeInfoKind kind, As &&...args)
@@ -185,17 +188,30 @@ namespace {
       llvm_unreachable("bad field layout kind");
     }
 
-    // For now, just use extra inhabitants from the first field.
-    // FIXME: generalize
+    /// Use the extra inhabitants of the field with the given index, rather
+    /// than those of the first field.
+    void setExtraInhabitantFieldIndex(unsigned index) {
+      assert(index < asImpl().getFields().size());
+      ExtraInhabitantFieldIndex = index;
+    }
+
+    const FieldInfoType &getExtraInhabitantField() const {
+      return asImpl().getFields()[ExtraInhabitantFieldIndex];
+    }
+
+    // The extra inhabitants of the struct are those of a single field, which
+    // is the first one unless the builder picked another.
     bool mayHaveExtraInhabitants(IRGenModule &IGM) const override {
       if (asImpl().getFields().empty()) return false;
-      return asImpl().getFields()[0].getTypeInfo().mayHaveExtraInhabitants(IGM);
+      return getExtraInhabitantField().getTypeInfo()
+               .mayHaveExtraInhabitants(IGM);
     }
 
     // This is dead code in NonFixedStructTypeInfo.
     unsigned getFixedExtraInhabitantCount(IRGenModule &IGM) const {
       if (asImpl().getFields().empty()) return 0;
-      auto &fieldTI = cast<FixedTypeInfo>(asImpl().getFields()[0].getTypeInfo());
+      auto &fieldTI =
+        cast<FixedTypeInfo>(getExtraInhabitantField().getTypeInfo());
       return fieldTI.getFixedExtraInhabitantCount(IGM);
     }
 
@@ -203,8 +219,14 @@ namespace {
     APInt getFixedExtraInhabitantValue(IRGenModule &IGM,
                                        unsigned bits,
                                        unsigned index) const {
-      auto &fieldTI = cast<FixedTypeInfo>(asImpl().getFields()[0].getTypeInfo());
-      return fieldTI.getFixedExtraInhabitantValue(IGM, bits, index);
+      auto &field = getExtraInhabitantField();
+      auto &fieldTI = cast<FixedTypeInfo>(field.getTypeInfo());
+      APInt value = fieldTI.getFixedExtraInhabitantValue(IGM, bits, index);
+
+      // Move the value to the position of the field within the struct.
+      if (ExtraInhabitantFieldIndex != 0)
+        value = value.shl(field.getFixedByteOffset().getValueInBits());
+      return value;
     }
 
     // This is dead code in NonFixedStructTypeInfo.
@@ -212,10 +234,10 @@ namespace {
       if (asImpl().getFields().empty())
         return APInt();
       
-      // Currently we only use the first field's extra inhabitants. The other
-      // fields can be ignored.
-      const FixedTypeInfo &fieldTI
-        = cast<FixedTypeInfo>(asImpl().getFields()[0].getTypeInfo());
+      // We only use one field's extra inhabitants. The other fields can be
+      // ignored.
+      auto &field = getExtraInhabitantField();
+      const FixedTypeInfo &fieldTI = cast<FixedTypeInfo>(field.getTypeInfo());
       auto targetSize = asImpl().getFixedSize().getValueInBits();
       
       if (fieldTI.isKnownEmpty(ResilienceExpansion::Maximal))
@@ -224,13 +246,15 @@ namespace {
       APInt fieldMask = fieldTI.getFixedExtraInhabitantMask(IGM);
       if (targetSize > fieldMask.getBitWidth())
         fieldMask = fieldMask.zext(targetSize);
+      if (ExtraInhabitantFieldIndex != 0)
+        fieldMask = fieldMask.shl(field.getFixedByteOffset().getValueInBits());
       return fieldMask;
     }
 
     llvm::Value *getExtraInhabitantIndex(IRGenFunction &IGF,
                                          Address structAddr,
                                          SILType structType) const override {
-      auto &field = asImpl().getFields()[0];
+      auto &field = getExtraInhabitantField();
       Address fieldAddr =
         asImpl().projectFieldAddress(IGF, structAddr, structType, field.Field);
       return field.getTypeInfo().getExtraInhabitantIndex(IGF, fieldAddr,
@@ -241,7 +265,7 @@ namespace {
                               llvm::Value *index,
                               Address structAddr,
                               SILType structType) const override {
-      auto &field = asImpl().getFields()[0];
+      auto &field = getExtraInhabitantField();
       Address fieldAddr =
         asImpl().projectFieldAddress(IGF, structAddr, structType, field.Field);
       field.getTypeInfo().storeExtraInhabitant(IGF, index, fieldAddr,
@@ -524,7 +548,7 @@ namespace {
     LoadableStructTypeInfo *createLoadable(ArrayRef<StructFieldInfo> fields,
                                            StructLayout &&layout,
                                            unsigned explosionSize) {
-      return LoadableStructTypeInfo::create(fields,
+      auto *ti = LoadableStructTypeInfo::create(fields,
                                             explosionSize,
                                             layout.getType(),
                                             layout.getSize(),
@@ -532,17 +556,47 @@ namespace {
                                             layout.getAlignment(),
                                             layout.isPOD(),
                                             layout.isAlwaysFixedSize());
+      chooseExtraInhabitantField(ti);
+      return ti;
     }
 
     FixedStructTypeInfo *createFixed(ArrayRef<StructFieldInfo> fields,
                                      StructLayout &&layout) {
-      return FixedStructTypeInfo::create(fields, layout.getType(),
+      auto *ti = FixedStructTypeInfo::create(fields, layout.getType(),
                                          layout.getSize(),
                                          std::move(layout.getSpareBits()),
                                          layout.getAlignment(),
                                          layout.isPOD(),
                                          layout.isBitwiseTakable(),
                                          layout.isAlwaysFixedSize());
+      chooseExtraInhabitantField(ti);
+      return ti;
+    }
+
+    /// Use the extra inhabitants of the field which has the most of them,
+    /// e.g. a class reference after an integer field.
+    ///
+    /// The runtime instantiates the value witnesses of generic structs using
+    /// the extra inhabitants of their first field, so generic structs, and
+    /// structs nested in generic contexts, must keep using the first field.
+    template <class StructTI>
+    void chooseExtraInhabitantField(StructTI *ti) {
+      if (TheStruct->getAnyNominal()->isGenericContext())
+        return;
+
+      auto fields = ti->getFields();
+      unsigned bestIndex = 0, bestCount = 0;
+      for (unsigned i = 0, e = fields.size(); i != e; ++i) {
+        if (fields[i].isEmpty())
+          continue;
+        auto &fieldTI = cast<FixedTypeInfo>(fields[i].getTypeInfo());
+        unsigned count = fieldTI.getFixedExtraInhabitantCount(IGM);
+        if (count > bestCount) {
+          bestIndex = i;
+          bestCount = count;
+        }
+      }
+      ti->setExtraInhabitantFieldIndex(bestIndex);
     }
 
     NonFixedStructTypeInfo *createNonFixed(ArrayRef<StructFieldInfo> fields,
@@ -565,8 +619,12 @@ namespace {
     }
 
     StructLayout performLayout(ArrayRef<const TypeInfo *> fieldTypes) {
+      auto strategy = LayoutStrategy::Optimal;
+      if (auto *decl = TheStruct->getStructOrBoundGenericStruct())
+        if (canReorderStructFields(IGM, decl))
+          strategy = LayoutStrategy::OptimalReordered;
       return StructLayout(IGM, TheStruct, LayoutKind::NonHeapObject,
-                          LayoutStrategy::Optimal, fieldTypes, StructTy);
+                          strategy, fieldTypes, StructTy);
     }
   };
 
@@ -827,6 +885,29 @@ irgen::getPhysicalStructMemberAccessStrategy(IRGenModule &IGM,
   FOR_STRUCT_IMPL(IGM, baseType, getFieldAccessStrategy, baseType, field);
 }
 
+bool irgen::canReorderStructFields(IRGenModule &IGM, StructDecl *decl) {
+  if (!IGM.IRGen.Opts.EnableStructFieldReordering)
+    return false;
+
+  // Imported structs have the layout of their C declaration.
+  if (decl->hasClangNode())
+    return false;
+
+  // The runtime lays out the fields of generic structs in declaration order.
+  if (decl->isGenericContext())
+    return false;
+
+  // Other modules must be able to compute the layout of public,
+  // @_fixed_layout and @_versioned structs.
+  if (decl->getEffectiveAccess() >= Accessibility::Public)
+    return false;
+  if (decl->getAttrs().hasAttribute<FixedLayoutAttr>() ||
+      decl->getAttrs().hasAttribute<VersionedAttr>())
+    return false;
+
+  return true;
+}
+
 void IRGenModule::emitStructDecl(StructDecl *st) {
   emitStructMetadata(*this, st);
   emitNestedTypeDecls(st->getMembers());
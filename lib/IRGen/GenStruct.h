@@ -24,6 +24,7 @@ namespace llvm {
 namespace swift {
   class CanType;
   class SILType;
+  class StructDecl;
   class VarDecl;
 
 namespace irgen {
@@ -56,6 +57,11 @@ namespace irgen {
   getPhysicalStructMemberAccessStrategy(IRGenModule &IGM,
                                         SILType baseType, VarDecl *field);
 
+  /// Return true if the stored properties of the given struct may be laid
+  /// out in a different order than they are declared in, because no other
+  /// module and no runtime layout algorithm depends on their order.
+  bool canReorderStructFields(IRGenModule &IGM, StructDecl *decl);
+
 } // end namespace irgen
 } // end namespace swift
 
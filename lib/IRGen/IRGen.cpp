@@ -23,6 +23,7 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Platform.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
@@ -47,6 +48,7 @@
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MD5.h"
 #include "llvm/ADT/StringSet.h"
@@ -78,6 +80,12 @@ static void addSwiftContractPass(const PassManagerBuilder &Builder,
     PM.add(createSwiftARCContractPass());
 }
 
+static void addSwiftInlineRefCountingPass(const PassManagerBuilder &Builder,
+                                          PassManagerBase &PM) {
+  if (Builder.OptLevel > 0)
+    PM.add(createSwiftInlineRefCountingPass());
+}
+
 static void addSwiftStackPromotionPass(const PassManagerBuilder &Builder,
                                        PassManagerBase &PM) {
   if (Builder.OptLevel > 0)
@@ -156,6 +164,12 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
                            addSwiftContractPass);
   }
 
+  // Expand retains and releases only after the ARC passes, which only know
+  // about the runtime calls, are done with them.
+  if (Opts.EnableInlineRefCounting)
+    PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast,
+                           addSwiftInlineRefCountingPass);
+
   if (Opts.Sanitize == SanitizerKind::Address) {
     PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast,
                            addAddressSanitizerPasses);
@@ -267,6 +281,8 @@ static void getHashOfModule(MD5::MD5Result &Result, IRGenOptions &Opts,
   // Add all options which influence the llvm compilation but are not yet
   // reflected in the llvm module itself.
   HashStream << Opts.getLLVMCodeGenOptionsHash();
+  HashStream << TargetMachine->getTargetCPU();
+  HashStream << TargetMachine->getTargetFeatureString();
 
   HashStream.final(Result);
 }
@@ -318,6 +334,48 @@ static bool needsRecompile(StringRef OutputFilename, ArrayRef<uint8_t> HashData,
   return true;
 }
 
+/// Computes the path of the object file in the codegen cache \p CacheDir for
+/// an LLVM module with the hash \p Result.
+static void getCachedObjectPath(SmallVectorImpl<char> &Path, StringRef CacheDir,
+                                MD5::MD5Result &Result) {
+  SmallString<32> HashStr;
+  MD5::stringifyResult(Result, HashStr);
+  Path.assign(CacheDir.begin(), CacheDir.end());
+  llvm::sys::path::append(Path, HashStr + ".o");
+}
+
+/// Adds the object file \p OutputFilename to the codegen cache as
+/// \p CachedFilename.
+///
+/// The file is copied to a temporary file first and then renamed, so that
+/// concurrent compilations never see a partially written cache entry. Errors
+/// are ignored: the cache is just not updated.
+static void addToCodeGenCache(StringRef OutputFilename,
+                              StringRef CachedFilename,
+                              llvm::sys::Mutex *DiagMutex) {
+  StringRef CacheDir = llvm::sys::path::parent_path(CachedFilename);
+  if (llvm::sys::fs::create_directories(CacheDir))
+    return;
+
+  SmallString<128> TmpFilename;
+  if (llvm::sys::fs::createUniqueFile(CachedFilename + "-%%%%%%%%.tmp",
+                                      TmpFilename))
+    return;
+
+  if (llvm::sys::fs::copy_file(OutputFilename, TmpFilename) ||
+      llvm::sys::fs::rename(TmpFilename, CachedFilename)) {
+    llvm::sys::fs::remove(TmpFilename);
+    return;
+  }
+
+  DEBUG(
+    if (DiagMutex) DiagMutex->lock();
+    llvm::dbgs() << OutputFilename << ": added to cache as " << CachedFilename
+                 << '\n';
+    if (DiagMutex) DiagMutex->unlock();
+  );
+}
+
 /// Run the LLVM passes. In multi-threaded compilation this will be done for
 /// multiple LLVM modules in parallel.
 static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
@@ -326,7 +384,12 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::Module *Module,
                         llvm::TargetMachine *TargetMachine,
                         StringRef OutputFilename) {
-  if (Opts.UseIncrementalLLVMCodeGen && HashGlobal) {
+  bool UseCodeGenCache = !Opts.LLVMCodeGenCachePath.empty() &&
+                         Opts.OutputKind == IRGenOutputKind::ObjectFile &&
+                         !Opts.PrintInlineTree && !OutputFilename.empty();
+  SmallString<128> CachedFilename;
+
+  if ((Opts.UseIncrementalLLVMCodeGen || UseCodeGenCache) && HashGlobal) {
     // Check if we can skip the llvm part of the compilation if we have an
     // existing object file which was generated from the same llvm IR.
     MD5::MD5Result Result;
@@ -341,13 +404,28 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     );
 
     ArrayRef<uint8_t> HashData(Result, sizeof(MD5::MD5Result));
-    if (Opts.OutputKind == IRGenOutputKind::ObjectFile &&
+    if (Opts.UseIncrementalLLVMCodeGen &&
+        Opts.OutputKind == IRGenOutputKind::ObjectFile &&
         !Opts.PrintInlineTree &&
         !needsRecompile(OutputFilename, HashData, HashGlobal, DiagMutex)) {
       // The llvm IR did not change. We don't need to re-create the object file.
       return false;
     }
 
+    if (UseCodeGenCache) {
+      // An identical module was compiled before: reuse its object file.
+      getCachedObjectPath(CachedFilename, Opts.LLVMCodeGenCachePath, Result);
+      if (!llvm::sys::fs::copy_file(CachedFilename, OutputFilename)) {
+        DEBUG(
+          if (DiagMutex) DiagMutex->lock();
+          llvm::dbgs() << OutputFilename << ": using cached "
+                       << CachedFilename << '\n';
+          if (DiagMutex) DiagMutex->unlock();
+        );
+        return false;
+      }
+    }
+
     // Store the hash in the global variable so that it is written into the
     // object file.
     auto *HashConstant = ConstantDataArray::get(Module->getContext(), HashData);
@@ -431,6 +509,12 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     SharedTimer timer("LLVM output");
     EmitPasses.run(*Module);
   }
+
+  if (!CachedFilename.empty()) {
+    // Close the object file before copying it.
+    RawOS.reset();
+    addToCodeGenCache(OutputFilename, CachedFilename, DiagMutex);
+  }
   return false;
 }
 
@@ -542,8 +626,35 @@ static void initLLVMModule(const IRGenModule &IGM) {
   Module->setDataLayout(IGM.DataLayout.getStringRepresentation());
 }
 
+/// Adds the contents of \p Module to the IRModule counters.
+static void countStatsOfIRModule(UnifiedStatsReporter &Stats,
+                                 const llvm::Module &Module) {
+  auto &C = Stats.getFrontendCounters();
+  C.NumIRGlobals += Module.getGlobalList().size();
+  C.NumIRFunctions += Module.getFunctionList().size();
+  for (const llvm::Function &F : Module) {
+    C.NumIRBasicBlocks += F.size();
+    for (const llvm::BasicBlock &BB : F)
+      C.NumIRInstructions += BB.size();
+  }
+}
+
 /// Generates LLVM IR, runs the LLVM passes and produces the output file.
 /// All this is done in a single thread.
+/// Frees the bodies of all SIL functions in \p SILMod, if requested, so that
+/// they don't stay alive while LLVM optimizes and emits code. IR generation
+/// of the module must be complete.
+static void releaseSILFunctionBodies(const IRGenOptions &Opts,
+                                     SILModule &SILMod) {
+  if (!Opts.ReleaseSILAfterIRGen)
+    return;
+
+  SharedTimer timer("Releasing SIL");
+  for (SILFunction &F : SILMod)
+    if (F.isDefinition())
+      F.convertToDeclaration();
+}
+
 static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
                                                          swift::Module *M,
                                                          SILModule *SILMod,
@@ -634,9 +745,14 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
     setModuleFlags(IGM);
   }
 
+  if (Ctx.Stats)
+    countStatsOfIRModule(*Ctx.Stats, *IGM.getModule());
+
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  releaseSILFunctionBodies(Opts, *SILMod);
+
   embedBitcode(IGM.getModule(), Opts);
 
   if (performLLVM(Opts, IGM.Context.Diags, nullptr, IGM.ModuleHash,
@@ -826,11 +942,16 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
       return;
 
     setModuleFlags(*IGM);
+
+    if (Ctx.Stats)
+      countStatsOfIRModule(*Ctx.Stats, *IGM->getModule());
   }
 
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  releaseSILFunctionBodies(Opts, *SILMod);
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -848,11 +969,124 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   }
 }
 
+/// Links the relocatable object files \p Inputs into the single relocatable
+/// object file \p OutputFilename, with "ld -r".
+///
+/// Hidden symbols stay global in the output, so that its symbol table is the
+/// same as if the module had been compiled into one object in one thread.
+static bool mergeObjectFiles(ArrayRef<std::string> Inputs,
+                             StringRef OutputFilename, ASTContext &Ctx) {
+  auto LinkerPath = llvm::sys::findProgramByName("ld");
+  if (!LinkerPath) {
+    Ctx.Diags.diagnose(SourceLoc(), diag::error_merging_object_files,
+                       OutputFilename, "unable to find 'ld'");
+    return true;
+  }
+
+  std::string Output = OutputFilename;
+  std::vector<const char *> Args;
+  Args.push_back(LinkerPath->c_str());
+  Args.push_back("-r");
+  if (Ctx.LangOpts.Target.isOSDarwin())
+    Args.push_back("-keep_private_externs");
+  Args.push_back("-o");
+  Args.push_back(Output.c_str());
+  for (const std::string &Input : Inputs)
+    Args.push_back(Input.c_str());
+  Args.push_back(nullptr);
+
+  std::string ErrorMsg;
+  int Result = llvm::sys::ExecuteAndWait(*LinkerPath, Args.data(),
+                                         /*env=*/nullptr, /*redirects=*/nullptr,
+                                         /*secondsToWait=*/0,
+                                         /*memoryLimit=*/0, &ErrorMsg);
+  if (Result != 0) {
+    if (ErrorMsg.empty())
+      ErrorMsg = "'ld' exited with code " + std::to_string(Result);
+    Ctx.Diags.diagnose(SourceLoc(), diag::error_merging_object_files,
+                       OutputFilename, ErrorMsg);
+    return true;
+  }
+  return false;
+}
+
+/// Like performParallelIRGeneration, but for a single object file: each
+/// thread writes the object of its source files to a temporary file, and the
+/// temporary files are then merged into the requested output.
+static void performParallelIRGenerationToSingleObject(IRGenOptions &Opts,
+                                                      swift::Module *M,
+                                                      SILModule *SILMod,
+                                                      StringRef ModuleName,
+                                                      int numThreads) {
+  auto &Ctx = M->getASTContext();
+  std::string OutputFilename = Opts.getSingleOutputFilename();
+  StringRef Stem = llvm::sys::path::stem(OutputFilename);
+
+  std::vector<std::string> PartFilenames;
+  auto removePartFiles = [&] {
+    for (const std::string &PartFilename : PartFilenames)
+      llvm::sys::fs::remove(PartFilename);
+  };
+
+  for (auto *File : M->getFiles()) {
+    auto SF = dyn_cast<SourceFile>(File);
+    if (!SF || SF->ASTStage < SourceFile::TypeChecked)
+      continue;
+
+    SmallString<128> PartFilename;
+    if (std::error_code EC = llvm::sys::fs::createTemporaryFile(
+            Stem, "o", PartFilename)) {
+      Ctx.Diags.diagnose(SourceLoc(), diag::error_opening_output,
+                         PartFilename, EC.message());
+      removePartFiles();
+      return;
+    }
+    PartFilenames.push_back(PartFilename.str());
+  }
+
+  std::vector<std::string> SavedOutputFilenames =
+      std::move(Opts.OutputFilenames);
+  Opts.OutputFilenames = PartFilenames;
+  // The temporary files are always new, so there is nothing to reuse.
+  bool SavedIncremental = Opts.UseIncrementalLLVMCodeGen;
+  Opts.UseIncrementalLLVMCodeGen = false;
+
+  ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads);
+
+  Opts.OutputFilenames = std::move(SavedOutputFilenames);
+  Opts.UseIncrementalLLVMCodeGen = SavedIncremental;
+
+  if (!Ctx.hadError())
+    mergeObjectFiles(PartFilenames, OutputFilename, Ctx);
+  removePartFiles();
+}
+
+/// Returns true if the multi-threaded compilation of \p M must produce one
+/// object file for all of its source files.
+static bool needsSingleObjectOutput(const IRGenOptions &Opts,
+                                    swift::Module *M) {
+  if (Opts.OutputKind != IRGenOutputKind::ObjectFile ||
+      Opts.OutputFilenames.size() != 1)
+    return false;
+
+  unsigned NumSourceFiles = 0;
+  for (auto *File : M->getFiles()) {
+    auto SF = dyn_cast<SourceFile>(File);
+    if (SF && SF->ASTStage >= SourceFile::TypeChecked)
+      ++NumSourceFiles;
+  }
+  return NumSourceFiles > 1;
+}
 
 std::unique_ptr<llvm::Module> swift::
 performIRGeneration(IRGenOptions &Opts, swift::Module *M, SILModule *SILMod,
                     StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
   int numThreads = SILMod->getOptions().NumThreads;
+  if (numThreads != 0 && needsSingleObjectOutput(Opts, M)) {
+    ::performParallelIRGenerationToSingleObject(Opts, M, SILMod, ModuleName,
+                                                numThreads);
+    return nullptr;
+  }
   if (numThreads != 0) {
     ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads);
     // TODO: Parallel LLVM compilation cannot be used if a (single) module is
@@ -17,6 +17,7 @@
 #define DEBUG_TYPE "debug-info"
 #include "IRGenDebugInfo.h"
 #include "GenOpaque.h"
+#include "GenStruct.h"
 #include "GenType.h"
 #include "Linking.h"
 #include "swift/AST/Expr.h"
@@ -1054,18 +1055,31 @@ IRGenDebugInfo::getStructMembers(NominalTypeDecl *D, Type BaseTy,
                                  llvm::DIScope *Scope, llvm::DIFile *File,
                                  unsigned Flags, unsigned &SizeInBits) {
   SmallVector<llvm::Metadata *, 16> Elements;
-  unsigned OffsetInBits = 0;
+  unsigned OffsetInBits = 0, EndInBits = 0;
+
+  // The stored properties of some structs are not laid out in declaration
+  // order, so take their offsets from the struct's layout.
+  auto *SD = dyn_cast<StructDecl>(D);
+  bool UseLayoutOffsets = SD && canReorderStructFields(IGM, SD);
+  unsigned SizeOfByte = CI.getTargetInfo().getCharWidth();
+
   for (VarDecl *VD : D->getStoredProperties()) {
     auto memberTy =
         BaseTy->getTypeOfMember(IGM.getSwiftModule(), VD, nullptr);
     DebugTypeInfo DbgTy(VD, IGM.getTypeInfoForUnlowered(
                                 IGM.getSILTypes().getAbstractionPattern(VD),
                                 memberTy));
+    if (UseLayoutOffsets)
+      if (auto *Offset = emitPhysicalStructMemberFixedOffset(
+              IGM, IGM.getLoweredType(BaseTy), VD))
+        OffsetInBits =
+            cast<llvm::ConstantInt>(Offset)->getZExtValue() * SizeOfByte;
     Elements.push_back(createMemberType(DbgTy, VD->getName().str(),
                                         OffsetInBits, Scope, File, Flags));
+    EndInBits = std::max(EndInBits, OffsetInBits);
   }
-  if (OffsetInBits > SizeInBits)
-    SizeInBits = OffsetInBits;
+  if (EndInBits > SizeInBits)
+    SizeInBits = EndInBits;
   return DBuilder.getOrCreateArray(Elements);
 }
 
@@ -1076,6 +1090,11 @@ llvm::DICompositeType *IRGenDebugInfo::createStructType(
     llvm::DIType *DerivedFrom, unsigned RuntimeLang, StringRef UniqueID) {
   StringRef Name = Decl->getName().str();
 
+  if (auto *Ref = createReferenceToDefinition(
+          DbgTy, Decl, llvm::dwarf::DW_TAG_structure_type, Scope, File, Line,
+          SizeInBits, AlignInBits, UniqueID))
+    return Ref;
+
   // Forward declare this first because types may be recursive.
   auto FwdDecl = llvm::TempDIType(
     DBuilder.createReplaceableCompositeType(
@@ -1100,6 +1119,37 @@ llvm::DICompositeType *IRGenDebugInfo::createStructType(
   return DITy;
 }
 
+llvm::DICompositeType *IRGenDebugInfo::createReferenceToDefinition(
+    DebugTypeInfo DbgTy, NominalTypeDecl *Decl, unsigned Tag,
+    llvm::DIScope *Scope, llvm::DIFile *File, unsigned Line,
+    unsigned SizeInBits, unsigned AlignInBits, StringRef UniqueID) {
+  // Types without a unique identifier can't be referred to, and the type info
+  // of types with archetypes depends on their generic context.
+  TypeBase *Ty = DbgTy.getType();
+  if (UniqueID.empty() || Ty->hasArchetype() || Ty->hasTypeParameter())
+    return nullptr;
+
+  IRGenModule *Owner = Decl->getParentModule() == IGM.getSwiftModule()
+                           ? IGM.IRGen.getGenModule(Decl->getDeclContext())
+                           : IGM.IRGen.getPrimaryIGM();
+  // The definition must be emitted here if the owning compile unit is
+  // already complete.
+  if (Owner == &IGM || !Owner->DebugInfo || Owner->DebugInfo->IsFinalized)
+    return nullptr;
+
+  Owner->DebugInfo->emitTypeDefinition(Ty);
+  return DBuilder.createForwardDecl(Tag, Decl->getName().str(), Scope, File,
+                                    Line, llvm::dwarf::DW_LANG_Swift,
+                                    SizeInBits, AlignInBits, UniqueID);
+}
+
+void IRGenDebugInfo::emitTypeDefinition(TypeBase *Ty) {
+  if (DITypeCache.count(Ty))
+    return;
+  DebugTypeInfo DbgTy(Ty, IGM.getTypeInfoForUnlowered(Ty), nullptr);
+  DBuilder.retainType(getOrCreateType(DbgTy));
+}
+
 llvm::DINodeArray IRGenDebugInfo::getEnumElements(DebugTypeInfo DbgTy,
                                                   EnumDecl *ED,
                                                   llvm::DIScope *Scope,
@@ -1149,6 +1199,11 @@ llvm::DICompositeType *IRGenDebugInfo::createEnumType(
   unsigned SizeInBits = DbgTy.size.getValue() * SizeOfByte;
   unsigned AlignInBits = DbgTy.align.getValue() * SizeOfByte;
 
+  if (auto *Ref = createReferenceToDefinition(
+          DbgTy, Decl, llvm::dwarf::DW_TAG_union_type, Scope, File, Line,
+          SizeInBits, AlignInBits, MangledName))
+    return Ref;
+
   // FIXME: Is DW_TAG_union_type the right thing here?
   // Consider using a DW_TAG_variant_type instead.
   auto FwdDecl = llvm::TempDIType(
@@ -1780,4 +1835,5 @@ void IRGenDebugInfo::finalize() {
 
   // Finalize the DIBuilder.
   DBuilder.finalize();
+  IsFinalized = true;
 }
@@ -76,6 +76,7 @@ class IRGenDebugInfo {
   llvm::MDNode *EntryPointFn = nullptr; /// Scope of SWIFT_ENTRY_POINT_FUNCTION.
   TypeAliasDecl *MetadataTypeDecl;      /// The type decl for swift.type.
   llvm::DIType *InternalType; /// Catch-all type for opaque internal types.
+  bool IsFinalized = false;   /// Whether the DIBuilder was finalized.
 
   SILLocation::DebugLoc LastDebugLoc; /// The last location that was emitted.
   const SILDebugScope *LastScope;     /// The scope of that last location.
@@ -190,6 +191,11 @@ public:
   void emitTypeMetadata(IRGenFunction &IGF, llvm::Value *Metadata,
                         StringRef Name);
 
+  /// Emit the definition of the debug type of \p Ty and retain it in the
+  /// compile unit, because other compile units of a multi-threaded
+  /// compilation only refer to it.
+  void emitTypeDefinition(TypeBase *Ty);
+
   /// Return the DIBuilder.
   llvm::DIBuilder &getBuilder() { return DBuilder; }
 
@@ -272,6 +278,20 @@ private:
                    llvm::DIType *DerivedFrom, unsigned RuntimeLang,
                    StringRef UniqueID);
 
+  /// In multi-threaded compilation, the definition of the debug type of a
+  /// nominal type is only emitted in one compile unit: the one of the source
+  /// file declaring it, or the primary one for types of other modules.
+  /// Other compile units refer to it by its unique identifier.
+  ///
+  /// \returns a forward declaration which refers to the definition in
+  /// another compile unit, or null if the definition is needed here.
+  llvm::DICompositeType *
+  createReferenceToDefinition(DebugTypeInfo DbgTy, NominalTypeDecl *Decl,
+                              unsigned Tag, llvm::DIScope *Scope,
+                              llvm::DIFile *File, unsigned Line,
+                              unsigned SizeInBits, unsigned AlignInBits,
+                              StringRef UniqueID);
+
   /// Create a member of a struct, class, tuple, or enum.
   llvm::DIDerivedType *createMemberType(DebugTypeInfo DbgTy, StringRef Name,
                                         unsigned &OffsetInBits,
@@ -334,8 +334,16 @@ public:
   llvm::DenseMap<SILValue, LoweredValue> LoweredValues;
   llvm::DenseMap<SILType, LoweredValue> LoweredUndefs;
 
-  /// All alloc_ref instructions which allocate the object on the stack.
+  /// All alloc_ref and partial_apply instructions which allocate the object
+  /// or closure context on the stack.
   llvm::SmallPtrSet<SILInstruction *, 8> StackAllocs;
+
+  /// The stack pointers saved before the dynamically-sized allocas of
+  /// alloc_stack instructions, to be restored by their dealloc_stacks.
+  ///
+  /// \see IRGenOptions::EnableDynamicStackAllocation
+  llvm::DenseMap<AllocStackInst *, llvm::Value *> DynamicStackAllocs;
+
   /// With closure captures it is actually possible to have two function
   /// arguments that both have the same name. Until this is fixed, we need to
   /// also hash the ArgNo here.
@@ -696,6 +704,9 @@ public:
   void emitDebugInfoForAllocStack(AllocStackInst *i, const TypeInfo &type,
                                   llvm::Value *addr);
   void visitAllocStackInst(AllocStackInst *i);
+  ContainedAddress emitDynamicAllocStack(AllocStackInst *i,
+                                         const TypeInfo &type,
+                                         StringRef name);
   void visitAllocRefInst(AllocRefInst *i);
   void visitAllocRefDynamicInst(AllocRefDynamicInst *i);
   void visitAllocBoxInst(AllocBoxInst *i);
@@ -2163,6 +2174,13 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
     = getPartialApplicationFunction(*this, i->getCallee(),
                                     i->getSubstitutions());
 
+  int StackAllocSize = -1;
+  if (i->canAllocOnStack()) {
+    estimateStackSize();
+    // Is there enough space for stack allocation?
+    StackAllocSize = IGM.IRGen.Opts.StackPromotionSizeLimit - EstimatedStackSize;
+  }
+
   // Create the thunk and function value.
   Explosion function;
   emitFunctionPartialApplication(*this, *CurSILFn,
@@ -2170,7 +2188,12 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
                                  params, i->getSubstitutions(),
                                  origCalleeTy, i->getSubstCalleeType(),
                                  i->getType().castTo<SILFunctionType>(),
-                                 function);
+                                 function, StackAllocSize);
+  if (StackAllocSize >= 0) {
+    // Remember that this partial_apply allocates the context on the stack.
+    StackAllocs.insert(i);
+    EstimatedStackSize += StackAllocSize;
+  }
   setLoweredExplosion(v, function);
 }
 
@@ -3453,6 +3476,18 @@ void IRGenSILFunction::visitAllocStackInst(swift::AllocStackInst *i) {
 # endif
 
   (void) Decl;
+
+  // Allocate values of non-fixed size with a dynamically-sized alloca, so
+  // that values that don't fit into a fixed-size buffer don't end up on the
+  // heap.
+  if (!isa<FixedTypeInfo>(type) &&
+      IGM.IRGen.Opts.EnableDynamicStackAllocation) {
+    auto addr = emitDynamicAllocStack(i, type, dbgname);
+    emitDebugInfoForAllocStack(i, type, addr.getAddress().getAddress());
+    setLoweredContainedAddress(i, addr);
+    return;
+  }
+
   // If a dynamic alloc_stack is immediately initialized by a copy_addr
   // operation, we can combine the allocation and initialization using an
   // optimized value witness.
@@ -3471,6 +3506,40 @@ void IRGenSILFunction::visitAllocStackInst(swift::AllocStackInst *i) {
   setLoweredContainedAddress(i, addr);
 }
 
+/// Allocate the storage for an alloc_stack of non-fixed type with an alloca
+/// of the type's dynamic size.
+///
+/// The stack pointer is saved first and restored by the dealloc_stack. SIL
+/// guarantees that stack allocations are deallocated in reverse order, so
+/// this can't free any other allocation that is still live.
+ContainedAddress
+IRGenSILFunction::emitDynamicAllocStack(AllocStackInst *i,
+                                        const TypeInfo &type,
+                                        StringRef name) {
+  SILType T = i->getElementType();
+  llvm::Value *size, *alignMask;
+  std::tie(size, alignMask) = type.getSizeAndAlignmentMask(*this, T);
+
+  auto stackSave = Builder.CreateCall(
+      llvm::Intrinsic::getDeclaration(&IGM.Module,
+                                      llvm::Intrinsic::stacksave), {});
+  DynamicStackAllocs[i] = stackSave;
+
+  // The alignment of an alloca must be a constant, so over-allocate by the
+  // alignment mask and align the address ourselves.
+  llvm::Value *allocSize = Builder.CreateAdd(size, alignMask);
+  auto *alloca = Builder.CreateAlloca(IGM.Int8Ty, allocSize, name);
+  alloca->setAlignment(IGM.getPointerAlignment().getValue());
+
+  llvm::Value *addr = Builder.CreatePtrToInt(alloca, IGM.SizeTy);
+  addr = Builder.CreateAdd(addr, alignMask);
+  addr = Builder.CreateAnd(addr, Builder.CreateNot(alignMask));
+  addr = Builder.CreateIntToPtr(addr, type.getStorageType()->getPointerTo());
+
+  Address container(alloca, IGM.getPointerAlignment());
+  return { container, type.getAddressForPointer(addr) };
+}
+
 void IRGenSILFunction::visitAllocRefInst(swift::AllocRefInst *i) {
   int StackAllocSize = -1;
   if (i->canAllocOnStack()) {
@@ -3506,6 +3575,18 @@ void IRGenSILFunction::visitDeallocStackInst(swift::DeallocStackInst *i) {
   const TypeInfo &allocatedTI = getTypeInfo(allocatedType);
   Address container = getLoweredContainerOfAddress(i->getOperand());
 
+  // Dynamically-sized allocas are freed by restoring the stack pointer.
+  if (auto *ASI = dyn_cast<AllocStackInst>(i->getOperand())) {
+    auto found = DynamicStackAllocs.find(ASI);
+    if (found != DynamicStackAllocs.end()) {
+      Builder.CreateCall(
+          llvm::Intrinsic::getDeclaration(&IGM.Module,
+                                          llvm::Intrinsic::stackrestore),
+          found->second);
+      return;
+    }
+  }
+
   // If the type isn't fixed-size, check whether we added an emission note.
   // If so, we should deallocate and destroy at the same time.
   if (!isa<FixedTypeInfo>(allocatedTI) && claimEmissionNote(i)) {
@@ -3539,9 +3620,16 @@ void IRGenSILFunction::visitDeallocRefInst(swift::DeallocRefInst *i) {
   }
   // It's a dealloc_ref [stack]. Even if the alloc_ref did not allocate the
   // object on the stack, we don't have to deallocate it, because it is
-  // deallocated in the final release.
-  assert(ARI->canAllocOnStack());
-  if (StackAllocs.count(ARI)) {
+  // deallocated in the final release. The same is true for the context of a
+  // partial_apply [stack].
+  auto *Alloc = cast<SILInstruction>(i->getOperand());
+  assert((ARI ? ARI->canAllocOnStack()
+              : cast<PartialApplyInst>(Alloc)->canAllocOnStack()) &&
+         "dealloc_ref [stack] must be paired with a stack allocation");
+  // A thick function is lowered as the function pointer and the context.
+  if (!ARI)
+    selfValue = self.claimNext();
+  if (StackAllocs.count(Alloc)) {
     if (IGM.IRGen.Opts.EmitStackPromotionChecks) {
       selfValue = Builder.CreateBitCast(selfValue, IGM.RefCountedPtrTy);
       emitVerifyEndOfLifetimeCall(selfValue);
@@ -4642,56 +4730,51 @@ void IRGenSILFunction::visitClassMethodInst(swift::ClassMethodInst *i) {
 }
 
 static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        TupleInst *TI);
-
-/// Generate ConstantStruct for StructInst.
-static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        StructInst *SI) {
-  SmallVector<llvm::Constant*, 32> Elts;
-  assert(SI->getNumOperands() == STy->getNumElements() &&
-         "mismatch StructInst with its lowered StructType!");
-  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i) {
-    if (auto *Elem = dyn_cast<StructInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *Elem = dyn_cast<TupleInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *ILI = dyn_cast<IntegerLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantInt(IGM, ILI));
-    else if (auto *FLI = dyn_cast<FloatLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantFP(IGM, FLI));
-    else if (auto *SLI = dyn_cast<StringLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
-    else
-      llvm_unreachable("Unexpected SILInstruction in static initializer!");
+                                        SILInstruction *Aggregate);
+
+/// Generate the constant for an element of type \p Ty of an aggregate in a
+/// static initializer.
+static llvm::Constant *getConstantElement(IRGenModule &IGM, llvm::Type *Ty,
+                                          SILValue Elem) {
+  if (isa<StructInst>(Elem) || isa<TupleInst>(Elem))
+    return getConstantValue(IGM, cast<llvm::StructType>(Ty),
+                            cast<SILInstruction>(Elem));
+  if (auto *ILI = dyn_cast<IntegerLiteralInst>(Elem))
+    return getConstantInt(IGM, ILI);
+  if (auto *FLI = dyn_cast<FloatLiteralInst>(Elem))
+    return getConstantFP(IGM, FLI);
+  if (auto *SLI = dyn_cast<StringLiteralInst>(Elem))
+    return getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding());
+
+  // Casts of literals, which are allowed by
+  // SILGlobalVariable::canBeStaticInitializer.
+  if (auto *BI = dyn_cast<BuiltinInst>(Elem)) {
+    auto *Opd = getConstantElement(IGM, nullptr, BI->getArguments()[0]);
+    switch (BI->getBuiltinInfo().ID) {
+    case BuiltinValueKind::FPTrunc:
+      return llvm::ConstantExpr::getFPTrunc(Opd, Ty);
+    case BuiltinValueKind::Trunc:
+      return llvm::ConstantExpr::getTrunc(Opd, Ty);
+    case BuiltinValueKind::ZExt:
+      return llvm::ConstantExpr::getZExt(Opd, Ty);
+    case BuiltinValueKind::SExt:
+      return llvm::ConstantExpr::getSExt(Opd, Ty);
+    default:
+      break;
+    }
   }
-  return llvm::ConstantStruct::get(STy, Elts);
+  llvm_unreachable("Unexpected SILInstruction in static initializer!");
 }
 
-
-/// Generate ConstantStruct for StructInst.
+/// Generate ConstantStruct for StructInst or TupleInst.
 static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        TupleInst *TI) {
+                                        SILInstruction *Aggregate) {
   SmallVector<llvm::Constant*, 32> Elts;
-  assert(TI->getNumOperands() == STy->getNumElements() &&
+  assert(Aggregate->getNumOperands() == STy->getNumElements() &&
          "mismatch StructInst with its lowered StructType!");
-  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i) {
-    if (auto *Elem = dyn_cast<StructInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *Elem = dyn_cast<TupleInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *ILI = dyn_cast<IntegerLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantInt(IGM, ILI));
-    else if (auto *FLI = dyn_cast<FloatLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantFP(IGM, FLI));
-    else if (auto *SLI = dyn_cast<StringLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
-    else
-      llvm_unreachable("Unexpected SILInstruction in static initializer!");
-  }
+  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i)
+    Elts.push_back(getConstantElement(IGM, STy->getElementType(i),
+                                      Aggregate->getOperand(i)));
   return llvm::ConstantStruct::get(STy, Elts);
 }
 
@@ -4713,15 +4796,12 @@ void IRGenModule::emitSILStaticInitializers() {
     auto *InitValue = Global.getValueOfStaticInitializer();
 
     // Set the IR global's initializer to the constant for this SIL
-    // struct.
-    if (auto *SI = dyn_cast<StructInst>(InitValue)) {
-      IRGlobal->setInitializer(getConstantValue(*this, STy, SI));
-      continue;
-    }
+    // struct or tuple.
+    IRGlobal->setInitializer(getConstantValue(*this, STy, InitValue));
 
-    // Set the IR global's initializer to the constant for this SIL
-    // tuple.
-    auto *TI = cast<TupleInst>(InitValue);
-    IRGlobal->setInitializer(getConstantValue(*this, STy, TI));
+    // A statically initialized let is never written, so it can be placed in
+    // read-only data and LLVM can fold loads from it.
+    if (Global.isLet())
+      IRGlobal->setConstant(true);
   }
 }
@@ -116,11 +116,56 @@ public:
     return emitLoadOfIsPOD(IGF, T);
   }
 
+  llvm::Value *getIsBitwiseTakable(IRGenFunction &IGF,
+                                   SILType T) const override {
+    return emitLoadOfIsBitwiseTakable(IGF, T);
+  }
+
   llvm::Value *isDynamicallyPackedInline(IRGenFunction &IGF,
                                          SILType T) const override {
     return emitLoadOfIsInline(IGF, T);
   }
 
+  // Array operations call the type's array value witnesses, rather than
+  // looping over the elements here. The runtime gives POD and
+  // bitwise-takable layouts memcpy and memmove witnesses, which we can't
+  // know about statically.
+
+  void destroyArray(IRGenFunction &IGF, Address addr, llvm::Value *count,
+                    SILType T) const override {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return;
+    emitDestroyArrayCall(IGF, T, addr, count);
+  }
+
+  void initializeArrayWithCopy(IRGenFunction &IGF,
+                               Address dest, Address src, llvm::Value *count,
+                               SILType T) const override {
+    if (this->isPOD(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithCopy(IGF, dest, src, count, T);
+    emitInitializeArrayWithCopyCall(IGF, T, dest, src, count);
+  }
+
+  void initializeArrayWithTakeFrontToBack(IRGenFunction &IGF,
+                                          Address dest, Address src,
+                                          llvm::Value *count,
+                                          SILType T) const override {
+    if (this->isBitwiseTakable(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithTakeFrontToBack(IGF, dest, src, count,
+                                                       T);
+    emitInitializeArrayWithTakeFrontToBackCall(IGF, T, dest, src, count);
+  }
+
+  void initializeArrayWithTakeBackToFront(IRGenFunction &IGF,
+                                          Address dest, Address src,
+                                          llvm::Value *count,
+                                          SILType T) const override {
+    if (this->isBitwiseTakable(ResilienceExpansion::Maximal))
+      return super::initializeArrayWithTakeBackToFront(IGF, dest, src, count,
+                                                       T);
+    emitInitializeArrayWithTakeBackToFrontCall(IGF, T, dest, src, count);
+  }
+
   /// FIXME: Dynamic extra inhabitant lookup.
   bool mayHaveExtraInhabitants(IRGenModule &) const override { return false; }
   llvm::Value *getExtraInhabitantIndex(IRGenFunction &IGF,
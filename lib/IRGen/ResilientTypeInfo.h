@@ -112,40 +112,15 @@ public:
     emitInitializeWithCopyCall(IGF, T, dest, src);
   }
 
-  void initializeArrayWithCopy(IRGenFunction &IGF,
-                               Address dest, Address src, llvm::Value *count,
-                               SILType T) const override {
-    emitInitializeArrayWithCopyCall(IGF, T, dest, src, count);
-  }
-
   void initializeWithTake(IRGenFunction &IGF,
                         Address dest, Address src, SILType T) const override {
     emitInitializeWithTakeCall(IGF, T, dest, src);
   }
 
-  void initializeArrayWithTakeFrontToBack(IRGenFunction &IGF,
-                                          Address dest, Address src,
-                                          llvm::Value *count,
-                                          SILType T) const override {
-    emitInitializeArrayWithTakeFrontToBackCall(IGF, T, dest, src, count);
-  }
-
-  void initializeArrayWithTakeBackToFront(IRGenFunction &IGF,
-                                          Address dest, Address src,
-                                          llvm::Value *count,
-                                          SILType T) const override {
-    emitInitializeArrayWithTakeBackToFrontCall(IGF, T, dest, src, count);
-  }
-
   void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
     emitDestroyCall(IGF, T, addr);
   }
 
-  void destroyArray(IRGenFunction &IGF, Address addr, llvm::Value *count,
-                    SILType T) const override {
-    emitDestroyArrayCall(IGF, T, addr, count);
-  }
-
   bool mayHaveExtraInhabitants(IRGenModule &IGM) const override {
     return true;
   }
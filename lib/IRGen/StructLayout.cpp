@@ -204,9 +204,28 @@ bool StructLayoutBuilder::addFields(llvm::MutableArrayRef<ElementLayout> elts,
   // Track whether we've added any storage to our layout.
   bool addedStorage = false;
 
+  // Determine the order in which to lay out the elements. Reordering is
+  // only possible if all of them have a fixed size; the runtime lays out
+  // everything else in declaration order. The sort is stable, so elements
+  // of the same alignment stay in declaration order.
+  SmallVector<ElementLayout *, 8> order;
+  for (auto &elt : elts)
+    order.push_back(&elt);
+  if (strategy == LayoutStrategy::OptimalReordered &&
+      std::all_of(elts.begin(), elts.end(), [](ElementLayout &elt) {
+        return isa<FixedTypeInfo>(elt.getType());
+      })) {
+    std::stable_sort(order.begin(), order.end(),
+                     [](ElementLayout *lhs, ElementLayout *rhs) {
+      return cast<FixedTypeInfo>(lhs->getType()).getFixedAlignment() >
+             cast<FixedTypeInfo>(rhs->getType()).getFixedAlignment();
+    });
+  }
+
   // Loop through the elements.  The only valid field in each element
   // is Type; StructIndex and ByteOffset need to be laid out.
-  for (auto &elt : elts) {
+  for (auto *eltPtr : order) {
+    auto &elt = *eltPtr;
     auto &eltTI = elt.getType();
     IsKnownPOD &= eltTI.isPOD(ResilienceExpansion::Maximal);
     IsKnownBitwiseTakable &= eltTI.isBitwiseTakable(ResilienceExpansion::Maximal);
@@ -43,6 +43,11 @@ enum class LayoutStrategy {
   /// Compute an optimal layout;  there are no constraints at all.
   Optimal,
 
+  /// Like 'optimal', but fixed-size fields may also be laid out by
+  /// decreasing alignment instead of in declaration order, which avoids
+  /// padding between them.
+  OptimalReordered,
+
   /// The 'universal' strategy: all modules must agree on the layout.
   Universal
 };
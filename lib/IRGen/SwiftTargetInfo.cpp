@@ -54,6 +54,12 @@ static void configureARM64(IRGenModule &IGM, const llvm::Triple &triple,
 
   // arm64 requires ISA-masking.
   target.ObjCUseISAMask = true;
+
+  // arm64 returns up to eight integers and eight floating-point values in
+  // registers, so four-word structs don't need to go through memory. The same
+  // limit applies to arguments, which have eight registers of each kind to
+  // share between them.
+  target.MaxScalarsForDirectResult = 4;
 }
 
 /// Configures target-specific information for x86-64 platforms.
@@ -134,10 +140,13 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
+  // -1 as ABI for the "done" value. The runtime's own implementation on other
+  // platforms uses the same value, but unlike dispatch_once it doesn't make
+  // the initialized state visible to other threads without an acquire load.
+  if (!triple.isWindowsCygwinEnvironment()) {
     target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
+    target.OnceDonePredicateNeedsAcquire = !triple.isOSDarwin();
+  }
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
@@ -79,7 +79,12 @@ public:
   /// Changes to this must be kept in sync with swift/Runtime/Metadata.h.
   uint64_t LeastValidPointerValue;
 
-  /// The maximum number of scalars that we allow to be returned directly.
+  /// The maximum number of scalars that we allow to be returned directly
+  /// (and passed directly as a single argument).
+  ///
+  /// This must not exceed the number of return registers of the platform's C
+  /// calling convention, which Swift functions currently use. Changing it
+  /// changes the ABI of every function with a struct result of that size.
   unsigned MaxScalarsForDirectResult = 3;
 
   /// Inline assembly to mark a call to objc_retainAutoreleasedReturnValue.
@@ -95,6 +100,10 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check for OnceDonePredicateValue must be an acquire
+  /// load, so that the initialized values are visible to this thread.
+  bool OnceDonePredicateNeedsAcquire = false;
 };
 
 }
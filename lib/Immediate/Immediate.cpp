@@ -27,16 +27,24 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
 
 #include <dlfcn.h>
 
@@ -189,23 +197,19 @@ bool swift::immediate::linkLLVMModules(llvm::Module *Module,
   return !Failed;
 }
 
-bool swift::immediate::IRGenImportedModules(
-    CompilerInstance &CI,
-    llvm::Module &Module,
-    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
-    SmallVectorImpl<llvm::Function*> &InitFns,
-    IRGenOptions &IRGenOpts,
-    const SILOptions &SILOpts) {
-  swift::Module *M = CI.getMainModule();
-
-  // Perform autolinking.
-  SmallVector<LinkLibrary, 4> AllLinkLibraries(IRGenOpts.LinkLibraries);
+/// Collects the libraries which the main module of \p CI links against,
+/// including the ones of all modules it imports.
+static void collectLinkLibraries(CompilerInstance &CI,
+                                 const IRGenOptions &IRGenOpts,
+                                 SmallVectorImpl<LinkLibrary> &AllLinkLibraries) {
+  AllLinkLibraries.append(IRGenOpts.LinkLibraries.begin(),
+                          IRGenOpts.LinkLibraries.end());
   auto addLinkLibrary = [&](LinkLibrary linkLib) {
     AllLinkLibraries.push_back(linkLib);
   };
 
-  M->forAllVisibleModules({}, /*includePrivateTopLevel=*/true,
-                          [&](Module::ImportedModule import) {
+  CI.getMainModule()->forAllVisibleModules({}, /*includePrivateTopLevel=*/true,
+                                           [&](Module::ImportedModule import) {
     import.second->collectLinkLibraries(addLinkLibrary);
   });
 
@@ -218,7 +222,20 @@ bool swift::immediate::IRGenImportedModules(
     next->collectLinkLibraries(addLinkLibrary);
     prev = next;
   }
+}
+
+bool swift::immediate::IRGenImportedModules(
+    CompilerInstance &CI,
+    llvm::Module &Module,
+    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
+    SmallVectorImpl<llvm::Function*> &InitFns,
+    IRGenOptions &IRGenOpts,
+    const SILOptions &SILOpts) {
+  swift::Module *M = CI.getMainModule();
 
+  // Perform autolinking.
+  SmallVector<LinkLibrary, 4> AllLinkLibraries;
+  collectLinkLibraries(CI, IRGenOpts, AllLinkLibraries);
   tryLoadLibraries(AllLinkLibraries, CI.getASTContext().SearchPathOpts,
                    CI.getDiags());
 
@@ -277,27 +294,104 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
-int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
-  ASTContext &Context = CI.getASTContext();
-  
-  // IRGen the main module.
-  auto *swiftModule = CI.getMainModule();
-  // FIXME: We shouldn't need to use the global context here, but
-  // something is persisting across calls to performIRGeneration.
-  auto ModuleOwner = performIRGeneration(
-      IRGenOpts, swiftModule, CI.getSILModule(), swiftModule->getName().str(),
-      llvm::getGlobalContext());
-  auto *Module = ModuleOwner.get();
+namespace {
+/// A persistent cache of the objects compiled by the JIT.
+///
+/// Objects are stored in a directory by the hash of the LLVM module they were
+/// compiled from, so running an unchanged script again only loads the object
+/// instead of compiling the script and all imported source modules.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  std::string CacheDir;
+  std::string CPU;
+  std::string Features;
+
+  /// Computes the path of the cached object of \p M.
+  void getCachedObjectPath(SmallVectorImpl<char> &Path,
+                           const llvm::Module *M) {
+    llvm::SmallString<0> Bitcode;
+    {
+      llvm::raw_svector_ostream OS(Bitcode);
+      llvm::WriteBitcodeToFile(M, OS);
+      // Recompile if the LLVM pipeline of the compiler or the target changed.
+      OS << version::getSwiftFullVersion() << CPU << Features;
+    }
+    llvm::MD5 Hash;
+    Hash.update(Bitcode);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+
+    SmallString<32> HashStr;
+    llvm::MD5::stringifyResult(Result, HashStr);
+    Path.assign(CacheDir.begin(), CacheDir.end());
+    llvm::sys::path::append(Path, HashStr + ".o");
+  }
 
-  if (Context.hadError())
-    return -1;
+public:
+  ImmediateObjectCache(StringRef CacheDir, StringRef CPU,
+                       ArrayRef<std::string> Features)
+    : CacheDir(CacheDir), CPU(CPU) {
+    for (auto &Feature : Features)
+      this->Features += Feature + ",";
+  }
 
-  SmallVector<llvm::Function*, 8> InitFns;
-  llvm::SmallPtrSet<swift::Module *, 8> ImportedModules;
-  if (IRGenImportedModules(CI, *Module, ImportedModules, InitFns,
-                           IRGenOpts, SILOpts))
-    return -1;
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // Errors are ignored: the cache is just not updated.
+    if (llvm::sys::fs::create_directories(CacheDir))
+      return;
+
+    SmallString<128> CachedFilename;
+    getCachedObjectPath(CachedFilename, M);
+
+    // Write to a temporary file first, so that concurrent runs never see a
+    // partially written cache entry.
+    int FD;
+    SmallString<128> TmpFilename;
+    if (llvm::sys::fs::createUniqueFile(CachedFilename + "-%%%%%%%%.tmp", FD,
+                                        TmpFilename))
+      return;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Obj.getBuffer();
+      OS.close();
+      if (OS.has_error()) {
+        OS.clear_error();
+        llvm::sys::fs::remove(TmpFilename);
+        return;
+      }
+    }
+    if (llvm::sys::fs::rename(TmpFilename, CachedFilename))
+      llvm::sys::fs::remove(TmpFilename);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    SmallString<128> CachedFilename;
+    getCachedObjectPath(CachedFilename, M);
+
+    auto Buffer = llvm::MemoryBuffer::getFile(CachedFilename);
+    if (!Buffer)
+      return nullptr;
+
+    DEBUG(llvm::dbgs() << "Loading cached object " << CachedFilename << '\n');
+    // The JIT takes ownership of the returned buffer.
+    return llvm::MemoryBuffer::getMemBufferCopy((*Buffer)->getBuffer());
+  }
+};
+} // end anonymous namespace
+
+/// JIT-compiles \p ModuleOwner and runs the initialization functions
+/// \p InitFns of the imported source modules, the static constructors and
+/// finally main().
+///
+/// Compiled objects are cached in \p ObjectCacheDir, if it isn't empty.
+static int runModule(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
+                     IRGenOptions &IRGenOpts,
+                     std::unique_ptr<llvm::Module> ModuleOwner,
+                     ArrayRef<llvm::Function *> InitFns,
+                     StringRef ObjectCacheDir) {
+  ASTContext &Context = CI.getASTContext();
+  auto *Module = ModuleOwner.get();
 
   llvm::PassManagerBuilder PMBuilder;
   PMBuilder.OptLevel = 2;
@@ -316,7 +410,7 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   std::string CPU;
   std::vector<std::string> Features;
   std::tie(TargetOpt, CPU, Features)
-    = getIRTargetOptions(IRGenOpts, swiftModule->getASTContext());
+    = getIRTargetOptions(IRGenOpts, Context);
   builder.setRelocationModel(llvm::Reloc::PIC_);
   builder.setTargetOptions(TargetOpt);
   builder.setMCPU(CPU);
@@ -329,6 +423,14 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
     return -1;
   }
 
+  // With a codegen cache, reuse the object of a previous run of an identical
+  // script and its imported modules instead of compiling them again.
+  std::unique_ptr<ImmediateObjectCache> ObjCache;
+  if (!ObjectCacheDir.empty()) {
+    ObjCache.reset(new ImmediateObjectCache(ObjectCacheDir, CPU, Features));
+    EE->setObjectCache(ObjCache.get());
+  }
+
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
 
@@ -347,3 +449,231 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   llvm::Function *EntryFn = Module->getFunction("main");
   return EE->runFunctionAsMain(EntryFn, CmdLine, 0);
 }
+
+// A script cache entry consists of the bitcode of the linked LLVM module of
+// the script, in <entry>.bc, and a manifest in <entry>.manifest. Each line of
+// the manifest is one of
+//
+//   dep <size> <mtime> <path>   a file the script was compiled from
+//   lib <kind> <name>           a library to load before running the script
+//   init <name>                 the initializer of an imported source module
+
+/// Returns true if the file \p Path still has the \p Size and the
+/// modification time \p MTime recorded in a script cache manifest.
+static bool isUnchanged(StringRef Path, uint64_t Size, uint64_t MTime) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status))
+    return false;
+  return Status.getSize() == Size &&
+         Status.getLastModificationTime().toEpochTime() == MTime;
+}
+
+/// Writes a script cache entry for \p Module, which was compiled from the main
+/// module of \p CI and all modules it imports.
+///
+/// The entry is written to temporary files first and then renamed, so that
+/// concurrent runs never see a partially written entry. Errors are ignored:
+/// the cache is just not updated.
+static void writeScriptCacheEntry(CompilerInstance &CI,
+                                  const IRGenOptions &IRGenOpts,
+                                  StringRef EntryPath,
+                                  const llvm::Module &Module,
+                                  ArrayRef<llvm::Function *> InitFns) {
+  StringRef CacheDir = llvm::sys::path::parent_path(EntryPath);
+  if (llvm::sys::fs::create_directories(CacheDir))
+    return;
+
+  auto writeFile = [&](StringRef Filename,
+                       llvm::function_ref<void(llvm::raw_ostream &)> Write) {
+    int FD;
+    SmallString<128> TmpFilename;
+    if (llvm::sys::fs::createUniqueFile(Filename + "-%%%%%%%%.tmp", FD,
+                                        TmpFilename))
+      return false;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      Write(OS);
+      OS.close();
+      if (OS.has_error()) {
+        OS.clear_error();
+        llvm::sys::fs::remove(TmpFilename);
+        return false;
+      }
+    }
+    if (llvm::sys::fs::rename(TmpFilename, Filename)) {
+      llvm::sys::fs::remove(TmpFilename);
+      return false;
+    }
+    return true;
+  };
+
+  // The bitcode must be in place before the manifest which refers to it.
+  if (!writeFile(EntryPath.str() + ".bc", [&](llvm::raw_ostream &OS) {
+        llvm::WriteBitcodeToFile(&Module, OS);
+      }))
+    return;
+
+  writeFile(EntryPath.str() + ".manifest", [&](llvm::raw_ostream &OS) {
+    for (auto &Entry : CI.getASTContext().LoadedModules) {
+      for (auto *File : Entry.second->getFiles()) {
+        StringRef Filename;
+        if (auto *SF = dyn_cast<SourceFile>(File))
+          Filename = SF->getFilename();
+        else if (auto *LF = dyn_cast<LoadedFile>(File))
+          Filename = LF->getFilename();
+        llvm::sys::fs::file_status Status;
+        if (Filename.empty() || llvm::sys::fs::status(Filename, Status))
+          continue;
+        OS << "dep " << Status.getSize() << ' '
+           << Status.getLastModificationTime().toEpochTime() << ' '
+           << Filename << '\n';
+      }
+    }
+
+    SmallVector<LinkLibrary, 4> AllLinkLibraries;
+    collectLinkLibraries(CI, IRGenOpts, AllLinkLibraries);
+    for (auto &Lib : AllLinkLibraries)
+      OS << "lib " << static_cast<unsigned>(Lib.getKind()) << ' '
+         << Lib.getName() << '\n';
+
+    for (auto *InitFn : InitFns)
+      OS << "init " << InitFn->getName() << '\n';
+  });
+}
+
+std::string
+swift::getScriptCacheEntryPath(StringRef CacheDir,
+                               ArrayRef<const char *> Args,
+                               ArrayRef<std::string> InputFilenames) {
+  llvm::MD5 Hash;
+  auto addString = [&](StringRef Str) {
+    // Include the terminator, so that adjacent strings can't run together.
+    Hash.update(llvm::ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(Str.data()), Str.size() + 1));
+  };
+
+  addString(version::getSwiftFullVersion());
+  // The arguments of the script itself don't affect its compilation.
+  for (StringRef Arg : Args) {
+    if (Arg == "--")
+      break;
+    addString(Arg);
+  }
+  for (auto &Filename : InputFilenames) {
+    auto Buffer = llvm::MemoryBuffer::getFile(Filename);
+    if (!Buffer)
+      return std::string();
+    addString((*Buffer)->getBuffer());
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(Result, HashStr);
+
+  SmallString<128> EntryPath = CacheDir;
+  llvm::sys::path::append(EntryPath, HashStr);
+  return EntryPath.str();
+}
+
+bool swift::RunCachedScript(CompilerInstance &CI, StringRef EntryPath,
+                            const ProcessCmdLine &CmdLine,
+                            IRGenOptions &IRGenOpts, int &ReturnValue) {
+  auto Manifest = llvm::MemoryBuffer::getFile(EntryPath + ".manifest");
+  if (!Manifest)
+    return false;
+
+  SmallVector<LinkLibrary, 4> AllLinkLibraries;
+  SmallVector<StringRef, 4> InitFnNames;
+  SmallVector<StringRef, 32> Lines;
+  (*Manifest)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                 /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef Kind;
+    std::tie(Kind, Line) = Line.split(' ');
+    if (Kind == "dep") {
+      StringRef Size, MTime;
+      std::tie(Size, Line) = Line.split(' ');
+      std::tie(MTime, Line) = Line.split(' ');
+      uint64_t SizeValue, MTimeValue;
+      if (Size.getAsInteger(10, SizeValue) ||
+          MTime.getAsInteger(10, MTimeValue) ||
+          !isUnchanged(Line, SizeValue, MTimeValue)) {
+        DEBUG(llvm::dbgs() << "Script cache entry " << EntryPath
+                           << " is out of date\n");
+        return false;
+      }
+    } else if (Kind == "lib") {
+      StringRef LibKind;
+      std::tie(LibKind, Line) = Line.split(' ');
+      unsigned LibKindValue;
+      if (LibKind.getAsInteger(10, LibKindValue))
+        return false;
+      AllLinkLibraries.push_back(
+          LinkLibrary(Line, static_cast<LibraryKind>(LibKindValue)));
+    } else if (Kind == "init") {
+      InitFnNames.push_back(Line);
+    } else {
+      return false;
+    }
+  }
+
+  // FIXME: We shouldn't need to use the global context here, but
+  // something is persisting across calls to performIRGeneration.
+  llvm::SMDiagnostic Err;
+  auto ModuleOwner = llvm::parseIRFile(EntryPath.str() + ".bc", Err,
+                                       llvm::getGlobalContext());
+  if (!ModuleOwner)
+    return false;
+
+  SmallVector<llvm::Function *, 8> InitFns;
+  for (StringRef Name : InitFnNames) {
+    llvm::Function *InitFn = ModuleOwner->getFunction(Name);
+    if (!InitFn)
+      return false;
+    InitFns.push_back(InitFn);
+  }
+
+  DEBUG(llvm::dbgs() << "Running script from cache entry " << EntryPath
+                     << '\n');
+  tryLoadLibraries(AllLinkLibraries, CI.getASTContext().SearchPathOpts,
+                   CI.getDiags());
+  ReturnValue = runModule(CI, CmdLine, IRGenOpts, std::move(ModuleOwner),
+                          InitFns, llvm::sys::path::parent_path(EntryPath));
+  return true;
+}
+
+int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
+                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                          StringRef ScriptCacheEntryPath) {
+  ASTContext &Context = CI.getASTContext();
+  
+  // IRGen the main module.
+  auto *swiftModule = CI.getMainModule();
+  // FIXME: We shouldn't need to use the global context here, but
+  // something is persisting across calls to performIRGeneration.
+  auto ModuleOwner = performIRGeneration(
+      IRGenOpts, swiftModule, CI.getSILModule(), swiftModule->getName().str(),
+      llvm::getGlobalContext());
+  auto *Module = ModuleOwner.get();
+
+  if (Context.hadError())
+    return -1;
+
+  SmallVector<llvm::Function*, 8> InitFns;
+  llvm::SmallPtrSet<swift::Module *, 8> ImportedModules;
+  if (IRGenImportedModules(CI, *Module, ImportedModules, InitFns,
+                           IRGenOpts, SILOpts))
+    return -1;
+
+  // The objects of cached scripts are cached alongside them.
+  StringRef ObjectCacheDir = IRGenOpts.LLVMCodeGenCachePath;
+  if (!ScriptCacheEntryPath.empty()) {
+    writeScriptCacheEntry(CI, IRGenOpts, ScriptCacheEntryPath, *Module,
+                          InitFns);
+    ObjectCacheDir = llvm::sys::path::parent_path(ScriptCacheEntryPath);
+  }
+
+  return runModule(CI, CmdLine, IRGenOpts, std::move(ModuleOwner), InitFns,
+                   ObjectCacheDir);
+}
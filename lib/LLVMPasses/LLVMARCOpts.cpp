@@ -22,6 +22,7 @@
 #include "LLVMARCOpts.h"
 #include "swift/Basic/NullablePtr.h"
 #include "swift/Basic/Fallthrough.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
@@ -35,6 +36,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TinyPtrVector.h"
@@ -52,6 +54,8 @@ STATISTIC(NumNoopDeleted,
           "Number of no-op swift calls eliminated");
 STATISTIC(NumRetainReleasePairs,
           "Number of swift retain/release pairs eliminated");
+STATISTIC(NumGlobalRetainReleasePairs,
+          "Number of retain/release pairs eliminated across blocks");
 STATISTIC(NumObjCRetainReleasePairs,
           "Number of objc retain/release pairs eliminated");
 STATISTIC(NumAllocateReleasePairs,
@@ -964,6 +968,198 @@ static bool performGeneralOptimizations(Function &F, ARCEntryPointBuilder &B,
 }
 
 
+//===----------------------------------------------------------------------===//
+//                      Global Retain/Release Pairing
+//===----------------------------------------------------------------------===//
+
+/// The maximum number of blocks we look at after a retain when searching for
+/// the releases it pairs with.
+static const unsigned MaxPairingRegionSize = 32;
+
+/// getMatchingReleaseKind - Return the kind of release that balances the given
+/// kind of retain, or RT_Unknown if it is not a retain we pair globally.
+static RT_Kind getMatchingReleaseKind(RT_Kind RetainKind) {
+  switch (RetainKind) {
+  case RT_Retain:        return RT_Release;
+  case RT_UnknownRetain: return RT_UnknownRelease;
+  case RT_BridgeRetain:  return RT_BridgeRelease;
+  case RT_ObjCRetain:    return RT_ObjCRelease;
+  default:               return RT_Unknown;
+  }
+}
+
+namespace {
+enum class PairingScanResult {
+  /// A release of the object was found.
+  FoundRelease,
+  /// The end of the block was reached without finding a release.
+  ReachedEnd,
+  /// Something that might decrement a reference count was found.
+  Blocked
+};
+} // end anonymous namespace
+
+/// scanForPairedRelease - Scan forward from \p I to the end of its block,
+/// looking for a release of kind \p ReleaseKind of \p Object.  Everything
+/// before it must be something that a retain could be moved over, i.e.
+/// something that can't decrement a reference count.
+static PairingScanResult scanForPairedRelease(BasicBlock::iterator I,
+                                              BasicBlock::iterator E,
+                                              Value *Object,
+                                              RT_Kind ReleaseKind,
+                                              SwiftRCIdentity *RC,
+                                              CallInst *&Release) {
+  for (; I != E; ++I) {
+    Instruction &CurInst = *I;
+    switch (classifyInstruction(CurInst)) {
+    case RT_NoMemoryAccessed:
+    case RT_AllocObject:
+    case RT_CheckUnowned:
+    case RT_FixLifetime:
+    case RT_Retain:
+    case RT_UnknownRetain:
+    case RT_BridgeRetain:
+    case RT_RetainUnowned:
+    case RT_ObjCRetain:
+      continue;
+
+    case RT_Release:
+    case RT_UnknownRelease:
+    case RT_BridgeRelease:
+    case RT_ObjCRelease: {
+      // A release of some other object might run a deinit that releases ours.
+      CallInst &ThisRelease = cast<CallInst>(CurInst);
+      Value *ThisReleasedObject =
+        RC->getSwiftRCIdentityRoot(ThisRelease.getArgOperand(0));
+      if (ThisReleasedObject != Object ||
+          classifyInstruction(ThisRelease) != ReleaseKind)
+        return PairingScanResult::Blocked;
+      Release = &ThisRelease;
+      return PairingScanResult::FoundRelease;
+    }
+
+    case RT_RetainN:
+    case RT_UnknownRetainN:
+    case RT_BridgeRetainN:
+    case RT_ReleaseN:
+    case RT_UnknownReleaseN:
+    case RT_BridgeReleaseN:
+      return PairingScanResult::Blocked;
+
+    case RT_Unknown:
+      // Load, store, memcpy etc can't do a release.
+      if (isa<LoadInst>(CurInst) || isa<StoreInst>(CurInst) ||
+          isa<MemIntrinsic>(CurInst))
+        continue;
+
+      // Neither can a call that doesn't write memory.
+      if (auto *CI = dyn_cast<CallInst>(&CurInst))
+        if (CI->onlyReadsMemory())
+          continue;
+
+      return PairingScanResult::Blocked;
+    }
+  }
+  return PairingScanResult::ReachedEnd;
+}
+
+/// performGlobalRetainReleasePairing - Try to pair a retain that reaches the
+/// end of its block with releases of the same object in the blocks after it.
+///
+/// The blocks between the retain and the releases form a region which can
+/// only be entered through the retain and which can't decrement any
+/// reference count, and every path out of the retain must end in exactly one
+/// of the releases. Then the retain and all of the releases can be deleted.
+/// This catches pairs that LLVM inlining exposes across control flow, e.g. a
+/// retain before a diamond and a release after it.
+static bool performGlobalRetainReleasePairing(CallInst &Retain,
+                                              SwiftRCIdentity *RC) {
+  RT_Kind ReleaseKind = getMatchingReleaseKind(classifyInstruction(Retain));
+  if (ReleaseKind == RT_Unknown || !Retain.use_empty())
+    return false;
+
+  Value *RetainedObject = RC->getSwiftRCIdentityRoot(Retain.getArgOperand(0));
+  BasicBlock *RetainBB = Retain.getParent();
+
+  // Pairs within the block are left to the local optimizations.
+  CallInst *Release = nullptr;
+  if (scanForPairedRelease(std::next(Retain.getIterator()), RetainBB->end(),
+                           RetainedObject, ReleaseKind, RC, Release)
+        != PairingScanResult::ReachedEnd)
+    return false;
+
+  // The blocks that we scanned to the end without finding a release. Every
+  // path through them has passed the retain and has not yet been released.
+  SmallPtrSet<BasicBlock *, 8> PassedThrough;
+  PassedThrough.insert(RetainBB);
+
+  SmallPtrSet<BasicBlock *, 8> Visited;
+  SmallVector<CallInst *, 4> Releases;
+  SmallVector<BasicBlock *, 8> Worklist(succ_begin(RetainBB),
+                                        succ_end(RetainBB));
+  if (Worklist.empty())
+    return false;
+
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.pop_back_val();
+    if (!Visited.insert(BB).second)
+      continue;
+
+    // Coming back to the retain's block (e.g. around a loop) would pair the
+    // releases with more than one execution of the retain.
+    if (BB == RetainBB || Visited.size() > MaxPairingRegionSize)
+      return false;
+
+    Release = nullptr;
+    switch (scanForPairedRelease(BB->begin(), BB->end(), RetainedObject,
+                                 ReleaseKind, RC, Release)) {
+    case PairingScanResult::Blocked:
+      return false;
+    case PairingScanResult::FoundRelease:
+      Releases.push_back(Release);
+      continue;
+    case PairingScanResult::ReachedEnd:
+      // A path leaves the function without releasing the object.
+      if (succ_begin(BB) == succ_end(BB))
+        return false;
+      PassedThrough.insert(BB);
+      Worklist.append(succ_begin(BB), succ_end(BB));
+      continue;
+    }
+  }
+
+  // Every block in the region must only be entered from the region, and not
+  // from a block after one of the releases.
+  for (BasicBlock *BB : Visited)
+    for (BasicBlock *Pred : predecessors(BB))
+      if (!PassedThrough.count(Pred))
+        return false;
+
+  Retain.eraseFromParent();
+  for (CallInst *PairedRelease : Releases)
+    PairedRelease->eraseFromParent();
+  ++NumGlobalRetainReleasePairs;
+  return true;
+}
+
+/// performGlobalOptimizations - Pair the retains that the local optimizations
+/// left behind with releases in other blocks.
+static bool performGlobalOptimizations(Function &F, SwiftRCIdentity *RC) {
+  SmallVector<CallInst *, 16> Retains;
+  for (BasicBlock &BB : F)
+    for (Instruction &I : BB)
+      if (getMatchingReleaseKind(classifyInstruction(I)) != RT_Unknown)
+        Retains.push_back(cast<CallInst>(&I));
+
+  // Only releases are deleted besides the retain being processed, so the
+  // other retains stay valid.
+  bool Changed = false;
+  for (CallInst *Retain : Retains)
+    Changed |= performGlobalRetainReleasePairing(*Retain, RC);
+  return Changed;
+}
+
+
 //===----------------------------------------------------------------------===//
 //                            SwiftARCOpt Pass
 //===----------------------------------------------------------------------===//
@@ -1017,5 +1213,9 @@ bool SwiftARCOpt::runOnFunction(Function &F) {
   //    escape.
   Changed |= performGeneralOptimizations(F, B, RC);
 
+  // Finally, pair up the retains and releases that are still separated by
+  // control flow.
+  Changed |= performGlobalOptimizations(F, RC);
+
   return Changed;
 }
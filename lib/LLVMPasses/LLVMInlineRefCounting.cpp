@@ -0,0 +1,179 @@
+//===--- LLVMInlineRefCounting.cpp - Inline retains and releases ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass replaces calls to swift_retain, swift_release and their _n
+// variants with the atomic operations they perform on the object's strong
+// reference count, so that hot code doesn't pay for a call and the register
+// spills around it. A release still calls the runtime, through
+// swift_releaseToZero, when it drops the count to zero.
+//
+// The ARC passes only understand the runtime calls, so this must run after
+// them. It is enabled by -enable-inline-refcounting. Code compiled this way
+// bypasses the _swift_retain and _swift_release hooks used by
+// instrumentation.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-inline-refcounting"
+#include "swift/LLVMPasses/Passes.h"
+#include "LLVMARCOpts.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+
+using namespace llvm;
+using namespace swift;
+
+STATISTIC(NumRetainsInlined, "Number of swift_retain calls inlined");
+STATISTIC(NumReleasesInlined, "Number of swift_release calls inlined");
+
+/// The amount a single retain adds to the strong reference count.
+///
+/// This must match StrongRefCount::RC_ONE in SwiftShims/RefCount.h.
+static const uint32_t RefCountOne = 4;
+
+//===----------------------------------------------------------------------===//
+//                        SwiftInlineRefCounting Pass
+//===----------------------------------------------------------------------===//
+
+char SwiftInlineRefCounting::ID = 0;
+
+INITIALIZE_PASS_BEGIN(SwiftInlineRefCounting,
+                      "swift-inline-refcounting",
+                      "Swift inline reference counting pass", false, false)
+INITIALIZE_PASS_END(SwiftInlineRefCounting,
+                    "swift-inline-refcounting",
+                    "Swift inline reference counting pass", false, false)
+
+llvm::FunctionPass *swift::createSwiftInlineRefCountingPass() {
+  initializeSwiftInlineRefCountingPass(*llvm::PassRegistry::getPassRegistry());
+  return new SwiftInlineRefCounting();
+}
+
+void SwiftInlineRefCounting::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
+}
+
+/// Returns the amount by which a call to a retain or release entry point
+/// changes the strong reference count, or 0 if it isn't one we expand.
+static uint32_t getRefCountDelta(CallInst *CI, RT_Kind kind) {
+  // The non-atomic variants are rare, and are left alone.
+  if (CI->getCalledFunction()->getName().find("nonatomic") != StringRef::npos)
+    return 0;
+
+  switch (kind) {
+  case RT_Retain:
+  case RT_Release:
+    return RefCountOne;
+  case RT_RetainN:
+  case RT_ReleaseN: {
+    auto *n = dyn_cast<ConstantInt>(CI->getArgOperand(1));
+    if (!n || n->getValue().ugt(UINT32_MAX / RefCountOne))
+      return 0;
+    return uint32_t(n->getZExtValue()) * RefCountOne;
+  }
+  default:
+    return 0;
+  }
+}
+
+/// Returns the address of the strong reference count of \p object, which is
+/// the 32-bit field after the metadata pointer.
+static Value *getRefCountAddress(IRBuilder<> &B, const DataLayout &DL,
+                                 Value *object) {
+  Value *bytes = B.CreatePointerCast(object, B.getInt8PtrTy());
+  Value *field = B.CreateConstInBoundsGEP1_32(B.getInt8Ty(), bytes,
+                                              DL.getPointerSize());
+  return B.CreatePointerCast(field, B.getInt32Ty()->getPointerTo());
+}
+
+/// Returns the runtime function which finishes a release that dropped the
+/// strong reference count to zero.
+static Constant *getReleaseToZero(Module &M, Type *objectTy) {
+  auto attrs = AttributeSet::get(M.getContext(), AttributeSet::FunctionIndex,
+                                 Attribute::NoUnwind);
+  return M.getOrInsertFunction("swift_releaseToZero", attrs,
+                               Type::getVoidTy(M.getContext()), objectTy,
+                               nullptr);
+}
+
+/// Replaces a retain or release of \p delta with the equivalent inline code,
+/// which for a retain is an atomic add and for a release is:
+///
+///   if (object) {
+///     old = atomic_fetch_sub(&object->refCount, delta, release);
+///     if (old == delta)
+///       swift_releaseToZero(object);
+///   }
+static void expandRefCountCall(CallInst *CI, bool isRelease, uint32_t delta) {
+  Value *object = CI->getArgOperand(0);
+  const DataLayout &DL = CI->getModule()->getDataLayout();
+
+  IRBuilder<> B(CI);
+  Value *isNonNull = B.CreateIsNotNull(object);
+  TerminatorInst *nonNullTerm =
+    SplitBlockAndInsertIfThen(isNonNull, CI, /*Unreachable*/ false);
+
+  B.SetInsertPoint(nonNullTerm);
+  Value *refCount = getRefCountAddress(B, DL, object);
+  Value *deltaValue = B.getInt32(delta);
+  if (!isRelease) {
+    B.CreateAtomicRMW(AtomicRMWInst::Add, refCount, deltaValue,
+                      AtomicOrdering::Monotonic);
+    ++NumRetainsInlined;
+  } else {
+    // Only a count which was exactly the delta, with no flags set, drops to
+    // zero; the runtime decides whether the object is deallocated.
+    Value *old = B.CreateAtomicRMW(AtomicRMWInst::Sub, refCount, deltaValue,
+                                   AtomicOrdering::Release);
+    Value *isZero = B.CreateICmpEQ(old, deltaValue);
+    TerminatorInst *zeroTerm =
+      SplitBlockAndInsertIfThen(isZero, nonNullTerm, /*Unreachable*/ false);
+    B.SetInsertPoint(zeroTerm);
+    Module &M = *CI->getModule();
+    CallInst *slowCall =
+      B.CreateCall(getReleaseToZero(M, object->getType()), object);
+    slowCall->setDoesNotThrow();
+    ++NumReleasesInlined;
+  }
+
+  CI->eraseFromParent();
+}
+
+bool SwiftInlineRefCounting::runOnFunction(Function &F) {
+  // Expanding splits blocks, so collect the calls first.
+  SmallVector<std::pair<CallInst *, RT_Kind>, 16> calls;
+  for (BasicBlock &BB : F) {
+    for (Instruction &I : BB) {
+      RT_Kind kind = classifyInstruction(I);
+      if (kind != RT_Retain && kind != RT_RetainN &&
+          kind != RT_Release && kind != RT_ReleaseN)
+        continue;
+      calls.push_back({cast<CallInst>(&I), kind});
+    }
+  }
+
+  bool changed = false;
+  for (auto &call : calls) {
+    uint32_t delta = getRefCountDelta(call.first, call.second);
+    if (!delta)
+      continue;
+    bool isRelease = call.second == RT_Release || call.second == RT_ReleaseN;
+    expandRefCountCall(call.first, isRelease, delta);
+    changed = true;
+  }
+  return changed;
+}
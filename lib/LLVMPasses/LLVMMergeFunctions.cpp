@@ -52,6 +52,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
+#include <thread>
 #include <vector>
 
 using namespace llvm;
@@ -61,6 +62,10 @@ using namespace swift;
 
 STATISTIC(NumSwiftFunctionsMerged, "Number of functions merged");
 STATISTIC(NumSwiftThunksWritten, "Number of thunks generated");
+STATISTIC(NumSwiftInstructionsMerged,
+          "Number of instructions removed by merging functions");
+STATISTIC(NumSwiftFunctionComparisons,
+          "Number of full comparisons of functions with the same hash");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "swiftmergefunc-sanity",
@@ -75,6 +80,16 @@ static cl::opt<unsigned> FunctionMergeThreshold(
              "'0' disables function merging at all."),
     cl::init(30), cl::Hidden);
 
+static cl::opt<unsigned> NumHashThreads(
+    "swiftmergefunc-hash-threads",
+    cl::desc("The number of threads used to hash the functions of a module. "
+             "'0' uses one thread per hardware thread."),
+    cl::init(0), cl::Hidden);
+
+/// The minimum number of functions hashed by each thread. Smaller modules are
+/// hashed on the pass's own thread.
+static const unsigned MinFunctionsPerHashThread = 1024;
+
 namespace {
 
 // TODO: the following code (GlobalNumberState, FunctionComparator) is copied
@@ -1276,17 +1291,60 @@ public:
 };
 } // end anonymous namespace
 
+/// Adds the properties of \p Ty which FunctionComparator::cmpTypes() compares
+/// to \p H. Only the top level of the type is considered, which is enough to
+/// separate most functions of different layout.
+static void hashType(HashAccumulator64 &H, Type *Ty, const DataLayout &DL) {
+  if (auto *PTy = dyn_cast<PointerType>(Ty)) {
+    // cmpTypes() compares pointers in address space 0 as integers.
+    if (PTy->getAddressSpace() == 0) {
+      H.add(Type::IntegerTyID);
+      H.add(DL.getPointerSizeInBits(0));
+      return;
+    }
+    H.add(Type::PointerTyID);
+    H.add(PTy->getAddressSpace());
+    return;
+  }
+  H.add(Ty->getTypeID());
+  switch (Ty->getTypeID()) {
+  case Type::IntegerTyID:
+    H.add(cast<IntegerType>(Ty)->getBitWidth());
+    break;
+  case Type::VectorTyID:
+    H.add(cast<VectorType>(Ty)->getNumElements());
+    break;
+  case Type::StructTyID:
+    H.add(cast<StructType>(Ty)->getNumElements());
+    H.add(cast<StructType>(Ty)->isPacked());
+    break;
+  case Type::FunctionTyID:
+    H.add(cast<FunctionType>(Ty)->getNumParams());
+    H.add(cast<FunctionType>(Ty)->isVarArg());
+    break;
+  case Type::ArrayTyID:
+    H.add(cast<ArrayType>(Ty)->getNumElements());
+    break;
+  default:
+    break;
+  }
+}
+
 // A function hash is calculated by considering only the number of arguments and
 // whether a function is varargs, the order of basic blocks (given by the
 // successors of each basic block in depth first order), and the order of
-// opcodes of each instruction within each of these basic blocks. This mirrors
-// the strategy compare() uses to compare functions by walking the BBs in depth
-// first order and comparing each instruction in sequence. Because this hash
-// does not look at the operands, it is insensitive to things such as the
-// target of calls and the constants used in the function, which makes it useful
-// when possibly merging functions which are the same modulo constants and call
-// targets.
+// opcodes of each instruction within each of these basic blocks, together with
+// the properties cmpOperations() compares: the number of operands, the result
+// type and the optional flags. This mirrors the strategy compare() uses to
+// compare functions by walking the BBs in depth first order and comparing each
+// instruction in sequence. Because this hash does not look at the operands, it
+// is insensitive to things such as the target of calls and the constants used
+// in the function, which makes it useful when possibly merging functions which
+// are the same modulo constants and call targets.
+//
+// The function is only read, so different functions can be hashed in parallel.
 FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
+  const DataLayout &DL = F.getParent()->getDataLayout();
   HashAccumulator64 H;
   H.add(F.isVarArg());
   H.add(F.arg_size());
@@ -1305,6 +1363,13 @@ FunctionComparator::FunctionHash FunctionComparator::functionHash(Function &F) {
     H.add(45798); 
     for (auto &Inst : *BB) {
       H.add(Inst.getOpcode());
+      // GEPs with the same constant offset are equal regardless of their
+      // operands and types (see cmpGEPs()).
+      if (isa<GetElementPtrInst>(Inst))
+        continue;
+      H.add(Inst.getNumOperands());
+      H.add(Inst.getRawSubclassOptionalData());
+      hashType(H, Inst.getType(), DL);
     }
     const TerminatorInst *Term = BB->getTerminator();
     for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
@@ -1354,9 +1419,8 @@ private:
     /// A very cheap hash, used to early exit if functions do not match.
     FunctionComparator::FunctionHash Hash;
   public:
-    // Note the hash is recalculated potentially multiple times, but it is cheap.
     EquivalenceClass(FunctionEntry *First)
-      : First(First), Hash(FunctionComparator::functionHash(*First->F)) {
+      : First(First), Hash(First->Hash) {
       assert(!First->Next);
     }
   };
@@ -1371,6 +1435,7 @@ private:
       // Order first by hashes, then full function comparison.
       if (LHS.Hash != RHS.Hash)
         return LHS.Hash < RHS.Hash;
+      ++NumSwiftFunctionComparisons;
       FunctionComparator FCmp(LHS.First->F, RHS.First->F, GlobalNumbers);
       return FCmp.compare() == -1;
     }
@@ -1379,13 +1444,18 @@ private:
 
   /// 
   struct FunctionEntry {
-    FunctionEntry(Function *F, FnTreeType::iterator I) :
-        F(F), Next(nullptr), numUnhandledCallees(0), TreeIter(I),
+    FunctionEntry(Function *F, FunctionComparator::FunctionHash Hash,
+                  FnTreeType::iterator I) :
+        F(F), Hash(Hash), Next(nullptr), numUnhandledCallees(0), TreeIter(I),
         isMerged(false) { }
 
     /// Back-link to the function.
     AssertingVH<Function> F;
 
+    /// The hash of the function. It is computed once, and again only when
+    /// calls in the function are rewritten to call a merged function.
+    FunctionComparator::FunctionHash Hash;
+
     /// The next function in its equivalence class.
     FunctionEntry *Next;
 
@@ -1500,6 +1570,11 @@ private:
     return false;
   }
 
+  /// Computes the hashes of \p Funcs, in parallel for large modules.
+  static void hashFunctions(
+      std::vector<std::pair<FunctionComparator::FunctionHash, Function *>>
+          &Funcs);
+
   /// Checks the rules of order relation introduced among functions set.
   /// Returns true, if sanity check has been passed, and false if failed.
   bool doSanityCheck(std::vector<WeakVH> &Worklist);
@@ -1667,9 +1742,10 @@ bool SwiftMergeFunctions::runOnModule(Module &M) {
 
   for (Function &Func : M) {
     if (isEligibleFunction(&Func)) {
-      HashedFuncs.push_back({FunctionComparator::functionHash(Func), &Func});
+      HashedFuncs.push_back({0, &Func});
     }
   }
+  hashFunctions(HashedFuncs);
 
   std::stable_sort(
       HashedFuncs.begin(), HashedFuncs.end(),
@@ -1685,7 +1761,7 @@ bool SwiftMergeFunctions::runOnModule(Module &M) {
   for (auto I = HashedFuncs.begin(), IE = HashedFuncs.end(); I != IE; ++I) {
 
     Function *F = I->second;
-    FuncEntryStorage.push_back(FunctionEntry(F, FnTree.end()));
+    FuncEntryStorage.push_back(FunctionEntry(F, I->first, FnTree.end()));
     FunctionEntry &FE = FuncEntryStorage.back();
     FuncEntries[F] = &FE;
 
@@ -1776,6 +1852,37 @@ bool SwiftMergeFunctions::runOnModule(Module &M) {
   return Changed;
 }
 
+void SwiftMergeFunctions::hashFunctions(
+    std::vector<std::pair<FunctionComparator::FunctionHash, Function *>>
+        &Funcs) {
+  auto hashRange = [&Funcs](size_t Begin, size_t End) {
+    for (size_t Idx = Begin; Idx < End; ++Idx)
+      Funcs[Idx].first = FunctionComparator::functionHash(*Funcs[Idx].second);
+  };
+
+  unsigned NumThreads = NumHashThreads;
+  if (NumThreads == 0)
+    NumThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  NumThreads = std::min<size_t>(NumThreads,
+                                Funcs.size() / MinFunctionsPerHashThread);
+  if (NumThreads <= 1) {
+    hashRange(0, Funcs.size());
+    return;
+  }
+
+  // Each thread hashes a contiguous range of functions, and this thread
+  // hashes the last one.
+  size_t ChunkSize = (Funcs.size() + NumThreads - 1) / NumThreads;
+  std::vector<std::thread> Threads;
+  for (unsigned ThreadIdx = 0; ThreadIdx + 1 < NumThreads; ++ThreadIdx) {
+    size_t Begin = ThreadIdx * ChunkSize;
+    Threads.push_back(std::thread(hashRange, Begin, Begin + ChunkSize));
+  }
+  hashRange((NumThreads - 1) * ChunkSize, Funcs.size());
+  for (std::thread &Thread : Threads)
+    Thread.join();
+}
+
 void SwiftMergeFunctions::updateUnhandledCalleeCount(FunctionEntry *FE,
                                                      int Delta) {
   // Iterate over all functions of FE's equivalence class.
@@ -1945,6 +2052,13 @@ bool SwiftMergeFunctions::tryMapToParameter(FunctionInfos &FInfos,
   return true;
 }
 
+static int getNumInstructions(Function *F) {
+  int Count = 0;
+  for (BasicBlock &BB : *F)
+    Count += BB.size();
+  return Count;
+}
+
 /// Merge all functions in \p FInfos by creating thunks which call the single
 /// merged function with additional parameters.
 void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
@@ -2001,6 +2115,9 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
 
   for (unsigned FIdx = 0, NumFuncs = FInfos.size(); FIdx < NumFuncs; ++FIdx) {
     Function *OrigFunc = FInfos[FIdx].F;
+    // The body of the first function was moved into the merged function, all
+    // the others are removed.
+    int NumRemoved = (FIdx != 0 ? getNumInstructions(OrigFunc) : 0);
     if (replaceDirectCallers(OrigFunc, NewFunction, Params, FIdx)) {
       // We could replace all uses (and the function is not externally visible),
       // so we can delete the original function.
@@ -2013,7 +2130,10 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
     } else {
       // Otherwise we need a thunk which calls the merged function.
       writeThunk(NewFunction, OrigFunc, Params, FIdx);
+      NumRemoved -= getNumInstructions(OrigFunc);
     }
+    if (NumRemoved > 0)
+      NumSwiftInstructionsMerged += NumRemoved;
     ++NumSwiftFunctionsMerged;
   }
 }
@@ -2139,7 +2259,13 @@ bool SwiftMergeFunctions::replaceDirectCallers(Function *Old, Function *New,
   if (!AllReplaced)
     return false;
 
+  // The callers get new call operands, which changes their hash.
+  SmallPtrSet<FunctionEntry *, 8> ChangedCallers;
+
   for (CallInst *CI : Callers) {
+    if (FunctionEntry *FE = getEntry(CI->getFunction()))
+      ChangedCallers.insert(FE);
+
     auto &Context = New->getContext();
     auto NewFuncAttrs = New->getAttributes();
     auto CallSiteAttrs = CI->getAttributes();
@@ -2185,6 +2311,10 @@ bool SwiftMergeFunctions::replaceDirectCallers(Function *Old, Function *New,
     CI->replaceAllUsesWith(NewCI);
     CI->eraseFromParent();
   }
+
+  for (FunctionEntry *FE : ChangedCallers)
+    FE->Hash = FunctionComparator::functionHash(*FE->F);
+
   return Old->hasLocalLinkage();
 }
 
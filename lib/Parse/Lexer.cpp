@@ -28,6 +28,10 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -306,8 +310,76 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+//===----------------------------------------------------------------------===//
+// Fast scanning
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// The bytes that stop skipPlainCharacters, besides the stop characters it is
+/// given.  Nul and the bytes of non-ASCII characters always stop it.
+enum class StopBytes {
+  /// '\n' and '\r'.
+  Newlines,
+  /// Every ASCII control character, including newlines and tabs, which
+  /// string literals have to diagnose.
+  Controls,
+};
+} // end anonymous namespace
+
+static bool isStopByte(char C, StopBytes Stops, char A, char B, char D) {
+  if (C == A || C == B || C == D || (signed char)C <= 0)
+    return true;
+  if (Stops == StopBytes::Controls)
+    return C < 0x20 || C == 0x7F;
+  return C == '\n' || C == '\r';
+}
+
+/// skipPlainCharacters - Return the first byte at or after Ptr that is one
+/// of A, B or D, or one of the bytes described by Stops.  The buffer has to
+/// be nul terminated at End, which always stops the scan.
+///
+/// Comments, string literals and the rest of a line are mostly made up of
+/// characters the lexer doesn't have to look at individually, so this skips
+/// them 16 bytes at a time where SSE2 is available.
+static const char *skipPlainCharacters(const char *Ptr, const char *End,
+                                       StopBytes Stops,
+                                       char A, char B, char D) {
+#if defined(__SSE2__)
+  const __m128i VA = _mm_set1_epi8(A);
+  const __m128i VB = _mm_set1_epi8(B);
+  const __m128i VD = _mm_set1_epi8(D);
+  while (End - Ptr >= 16) {
+    __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    __m128i Hits = _mm_or_si128(_mm_cmpeq_epi8(Chunk, VA),
+                                _mm_or_si128(_mm_cmpeq_epi8(Chunk, VB),
+                                             _mm_cmpeq_epi8(Chunk, VD)));
+    if (Stops == StopBytes::Controls) {
+      // The signed comparison also catches the non-ASCII bytes.
+      Hits = _mm_or_si128(Hits,
+          _mm_or_si128(_mm_cmplt_epi8(Chunk, _mm_set1_epi8(0x20)),
+                       _mm_cmpeq_epi8(Chunk, _mm_set1_epi8(0x7F))));
+    } else {
+      Hits = _mm_or_si128(Hits,
+          _mm_or_si128(_mm_cmpeq_epi8(Chunk, _mm_setzero_si128()),
+              _mm_or_si128(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')),
+                           _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\r')))));
+      // The non-ASCII bytes have their top bit set already.
+      Hits = _mm_or_si128(Hits, Chunk);
+    }
+    if (unsigned Mask = _mm_movemask_epi8(Hits))
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  while (!isStopByte(*Ptr, Stops, A, B, D))
+    ++Ptr;
+  return Ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipPlainCharacters(CurPtr, BufferEnd, StopBytes::Newlines,
+                                 '\n', '\n', '\n');
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +433,8 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainCharacters(CurPtr, BufferEnd, StopBytes::Newlines,
+                                 '*', '/', '/');
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -568,8 +642,14 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, without decoding the ASCII part.
+  while (true) {
+    while (clang::isIdentifierBody(*CurPtr, /*dollar*/true))
+      ++CurPtr;
+    if ((signed char)*CurPtr >= 0 ||
+        !advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd))
+      break;
+  }
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1232,6 +1312,11 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Printable ASCII characters other than quotes and backslashes stand for
+    // themselves; skip straight to the next one that needs lexCharacter.
+    CurPtr = skipPlainCharacters(CurPtr, BufferEnd, StopBytes::Controls,
+                                 '"', '\'', '\\');
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -204,6 +204,32 @@ namespace {
       }
     }
   };
+
+  /// An RAII type to compute the interface hash of a single declaration, to
+  /// be used as its fingerprint in the reference dependencies file. Tokens of
+  /// nested declarations also contribute to the hashes of the declarations
+  /// that contain them.
+  struct RecordDeclInterfaceHash {
+    Parser &TheParser;
+    SmallVector<const Decl *, 4> Decls;
+    bool IsRecording;
+
+    explicit RecordDeclInterfaceHash(Parser &P)
+      : TheParser(P), IsRecording(P.IsParsingInterfaceTokens) {
+      if (IsRecording)
+        TheParser.SF.beginDeclInterfaceHash();
+    }
+
+    void add(const Decl *D) {
+      if (IsRecording)
+        Decls.push_back(D);
+    }
+
+    ~RecordDeclInterfaceHash() {
+      if (IsRecording)
+        TheParser.SF.endDeclInterfaceHash(Decls);
+    }
+  };
 }
 
 /// \brief Main entrypoint for the parser.
@@ -1978,9 +2004,11 @@ void Parser::delayParseFromBeginningToHere(ParserPosition BeginParserPosition,
 /// \endverbatim
 ParserStatus Parser::parseDecl(ParseDeclOptions Flags,
                                llvm::function_ref<void(Decl*)> Handler) {
+  RecordDeclInterfaceHash DeclHash(*this);
   Decl* LastDecl = nullptr;
   auto InternalHandler  = [&](Decl *D) {
     LastDecl = D;
+    DeclHash.add(D);
     Handler(D);
   };
   ParserPosition BeginParserPosition;
@@ -1952,55 +1952,59 @@ public:
     });
     decls.erase(newEnd, decls.end());
 
+    // Compute the sort keys of each decl once up front, rather than on every
+    // comparison; counting the members of an extension takes linear time.
+    struct SortEntry {
+      const Decl *D;
+      StringRef Name;
+      unsigned NumMembers;
+    };
+    SmallVector<SortEntry, 64> entries;
+    entries.reserve(decls.size());
+    for (const Decl *D : decls) {
+      if (auto VD = dyn_cast<ValueDecl>(D)) {
+        entries.push_back({VD, VD->getName().str(), 0});
+        continue;
+      }
+      auto ED = cast<ExtensionDecl>(D);
+      auto baseClass = ED->getExtendedType()->getClassOrBoundGenericClass();
+      auto members = ED->getMembers();
+      entries.push_back({ED, baseClass->getName().str(),
+                         unsigned(std::distance(members.begin(),
+                                                members.end()))});
+    }
+
     // REVERSE sort the decls, since we are going to copy them onto a stack.
-    llvm::array_pod_sort(decls.begin(), decls.end(),
-                         [](Decl * const *lhs, Decl * const *rhs) -> int {
+    llvm::array_pod_sort(entries.begin(), entries.end(),
+                         [](const SortEntry *lhs, const SortEntry *rhs) -> int {
       enum : int {
         Ascending = -1,
         Equivalent = 0,
         Descending = 1,
       };
 
-      assert(*lhs != *rhs && "duplicate top-level decl");
-
-      auto getSortName = [](const Decl *D) -> StringRef {
-        if (auto VD = dyn_cast<ValueDecl>(D))
-          return VD->getName().str();
-
-        if (auto ED = dyn_cast<ExtensionDecl>(D)) {
-          auto baseClass = ED->getExtendedType()->getClassOrBoundGenericClass();
-          return baseClass->getName().str();
-        }
-        llvm_unreachable("unknown top-level ObjC decl");
-      };
+      assert(lhs->D != rhs->D && "duplicate top-level decl");
 
       // Sort by names.
-      int result = getSortName(*rhs).compare(getSortName(*lhs));
+      int result = rhs->Name.compare(lhs->Name);
       if (result != 0)
         return result;
 
       // Prefer value decls to extensions.
-      assert(!(isa<ValueDecl>(*lhs) && isa<ValueDecl>(*rhs)));
-      if (isa<ValueDecl>(*lhs) && !isa<ValueDecl>(*rhs))
+      assert(!(isa<ValueDecl>(lhs->D) && isa<ValueDecl>(rhs->D)));
+      if (isa<ValueDecl>(lhs->D) && !isa<ValueDecl>(rhs->D))
         return Descending;
-      if (!isa<ValueDecl>(*lhs) && isa<ValueDecl>(*rhs))
+      if (!isa<ValueDecl>(lhs->D) && isa<ValueDecl>(rhs->D))
         return Ascending;
 
       // Break ties in extensions by putting smaller extensions last (in reverse
       // order).
-      // FIXME: This will end up taking linear time.
-      auto lhsMembers = cast<ExtensionDecl>(*lhs)->getMembers();
-      auto rhsMembers = cast<ExtensionDecl>(*rhs)->getMembers();
-      unsigned numLHSMembers = std::distance(lhsMembers.begin(), 
-                                             lhsMembers.end());
-      unsigned numRHSMembers = std::distance(rhsMembers.begin(), 
-                                             rhsMembers.end());
-      if (numLHSMembers != numRHSMembers)
-        return numLHSMembers < numRHSMembers ? Descending : Ascending;
+      if (lhs->NumMembers != rhs->NumMembers)
+        return lhs->NumMembers < rhs->NumMembers ? Descending : Ascending;
 
       // Or the extension with fewer protocols.
-      auto lhsProtos = cast<ExtensionDecl>(*lhs)->getLocalProtocols();
-      auto rhsProtos = cast<ExtensionDecl>(*rhs)->getLocalProtocols();
+      auto lhsProtos = cast<ExtensionDecl>(lhs->D)->getLocalProtocols();
+      auto rhsProtos = cast<ExtensionDecl>(rhs->D)->getLocalProtocols();
       if (lhsProtos.size() != rhsProtos.size())
         return lhsProtos.size() < rhsProtos.size() ? Descending : Ascending;
 
@@ -2008,8 +2012,8 @@ public:
       // alphabetically first.
       auto mismatch =
         std::mismatch(lhsProtos.begin(), lhsProtos.end(), rhsProtos.begin(),
-                      [getSortName] (const ProtocolDecl *nextLHSProto,
-                                     const ProtocolDecl *nextRHSProto) {
+                      [] (const ProtocolDecl *nextLHSProto,
+                          const ProtocolDecl *nextRHSProto) {
         return nextLHSProto->getName() != nextRHSProto->getName();
       });
       if (mismatch.first == lhsProtos.end())
@@ -2019,7 +2023,9 @@ public:
     });
 
     assert(declsToWrite.empty());
-    declsToWrite.assign(decls.begin(), decls.end());
+    declsToWrite.reserve(entries.size());
+    for (auto &entry : entries)
+      declsToWrite.push_back(entry.D);
 
     while (!declsToWrite.empty()) {
       const Decl *D = declsToWrite.back();
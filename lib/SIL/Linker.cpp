@@ -24,6 +24,8 @@ using namespace swift;
 using namespace Lowering;
 
 STATISTIC(NumFuncLinked, "Number of SIL functions linked");
+STATISTIC(NumFuncBodiesSkipped,
+          "Number of SIL function bodies not linked because of their size");
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -49,6 +51,24 @@ static bool shouldImportFunction(SILFunction *F) {
 //                               Linker Helpers
 //===----------------------------------------------------------------------===//
 
+bool SILLinkerVisitor::isBodyTooLargeToLink(SILFunction *F) const {
+  unsigned Limit = Mod.getOptions().LinkBodySizeLimit;
+  if (!isLinkAll() || Limit == 0 || F->getSerializedBodySize() <= Limit)
+    return false;
+
+  // Transparent and always-inline functions are inlined regardless of their
+  // size, and shared functions must have a body in every module that uses
+  // them. Generic bodies are needed for specialization, and semantics
+  // functions are recognized by the optimizer.
+  if (F->isTransparent() || F->getInlineStrategy() == AlwaysInline ||
+      hasSharedVisibility(F->getLinkage()) || F->hasSemanticsAttrs() ||
+      F->getLoweredFunctionType()->isPolymorphic())
+    return false;
+
+  ++NumFuncBodiesSkipped;
+  return true;
+}
+
 /// Process F, recursively deserializing any thing F may reference.
 bool SILLinkerVisitor::processFunction(SILFunction *F) {
   if (Mode == LinkingMode::LinkNone)
@@ -59,6 +79,9 @@ bool SILLinkerVisitor::processFunction(SILFunction *F) {
 
   // If F is a declaration, first deserialize it.
   if (F->isExternalDeclaration()) {
+    if (isBodyTooLargeToLink(F))
+      return false;
+
     auto *NewFn = Loader->lookupSILFunction(F);
 
     if (!NewFn || NewFn->isExternalDeclaration())
@@ -374,7 +397,7 @@ bool SILLinkerVisitor::process() {
                                << F->getName() << "\n");
             F->setBare(IsBare);
 
-            if (F->isExternalDeclaration()) {
+            if (F->isExternalDeclaration() && !isBodyTooLargeToLink(F)) {
               if (auto *NewFn = Loader->lookupSILFunction(F)) {
                 if (NewFn->isExternalDeclaration())
                   continue;
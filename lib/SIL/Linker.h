@@ -99,6 +99,10 @@ private:
   /// everything, not just transparent/shared functions.
   bool isLinkAll() const { return Mode == LinkingMode::LinkAll; }
 
+  /// Returns true if the serialized body of the declaration F is too large to
+  /// be worth deserializing just because we are linking everything.
+  bool isBodyTooLargeToLink(SILFunction *F) const;
+
   bool linkInVTable(ClassDecl *D);
 
   // Main loop of the visitor. Called by one of the other *visit* methods.
@@ -100,6 +100,19 @@ setArgumentClosureProp(unsigned ArgNo, ThinToThickFunctionInst *TTTFI) {
   Info.second = TTTFI;
 }
 
+void
+FunctionSignatureSpecializationMangler::
+setArgumentClosurePropField(unsigned ArgNo, unsigned FieldNo,
+                            SILInstruction *Closure) {
+  assert((isa<PartialApplyInst>(Closure) ||
+          isa<ThinToThickFunctionInst>(Closure)) &&
+         "We only support partial_apply and thin_to_thick_function");
+  auto &Info = Args[ArgNo];
+  Info.first = ArgumentModifierIntBase(ArgumentModifier::ClosurePropField);
+  Info.second = Closure;
+  ClosureFields[ArgNo] = FieldNo;
+}
+
 void
 FunctionSignatureSpecializationMangler::
 setArgumentConstantProp(unsigned ArgNo, LiteralInst *LI) {
@@ -132,6 +145,16 @@ setArgumentBoxToStack(unsigned ArgNo) {
   Args[ArgNo].first = ArgumentModifierIntBase(ArgumentModifier::BoxToStack);
 }
 
+void
+FunctionSignatureSpecializationMangler::
+setArgumentExistentialToConcrete(unsigned ArgNo,
+                                 SILInstruction *InitExistential) {
+  auto &Info = Args[ArgNo];
+  Info.first =
+    ArgumentModifierIntBase(ArgumentModifier::ExistentialToConcrete);
+  Info.second = InitExistential;
+}
+
 void
 FunctionSignatureSpecializationMangler::
 setReturnValueOwnedToUnowned() {
@@ -225,6 +248,44 @@ void FunctionSignatureSpecializationMangler::mangleClosureProp(
   M.mangleIdentifierSymbol(FRI->getReferencedFunction()->getName());
 }
 
+void FunctionSignatureSpecializationMangler::
+mangleExistentialToConcrete(SILInstruction *InitExistential) {
+  Mangler &M = getMangler();
+  M.append("e");
+
+  // Mangle the concrete type the existential was initialized with.
+  CanType ConcreteType;
+  if (auto *IE = dyn_cast<InitExistentialAddrInst>(InitExistential))
+    ConcreteType = IE->getFormalConcreteType();
+  else
+    ConcreteType =
+      cast<InitExistentialRefInst>(InitExistential)->getFormalConcreteType();
+  M.mangleType(ConcreteType, 0);
+}
+
+void FunctionSignatureSpecializationMangler::
+mangleClosurePropField(unsigned FieldNo, SILInstruction *Closure) {
+  Mangler &M = getMangler();
+  M.append("cf");
+  M.mangleNatural(APInt(32, FieldNo));
+  M.append("_");
+
+  // Then mangle the closure in the same way as a closure which is passed
+  // directly.
+  SILValue Callee;
+  OperandValueArrayRef CapturedArgs((ArrayRef<Operand>()));
+  if (auto *PAI = dyn_cast<PartialApplyInst>(Closure)) {
+    Callee = PAI->getCallee();
+    CapturedArgs = PAI->getArguments();
+  } else {
+    Callee = cast<ThinToThickFunctionInst>(Closure)->getCallee();
+  }
+  auto *FRI = cast<FunctionRefInst>(Callee);
+  M.mangleIdentifierSymbol(FRI->getReferencedFunction()->getName());
+  for (SILValue Arg : CapturedArgs)
+    M.mangleType(Arg->getType().getSwiftRValueType(), 0);
+}
+
 void FunctionSignatureSpecializationMangler::mangleArgument(
     ArgumentModifierIntBase ArgMod, NullablePtr<SILInstruction> Inst) {
   if (ArgMod == ArgumentModifierIntBase(ArgumentModifier::ConstantProp)) {
@@ -258,6 +319,12 @@ void FunctionSignatureSpecializationMangler::mangleArgument(
     return;
   }
 
+  if (ArgMod ==
+        ArgumentModifierIntBase(ArgumentModifier::ExistentialToConcrete)) {
+    mangleExistentialToConcrete(Inst.get());
+    return;
+  }
+
   bool hasSomeMod = false;
   if (ArgMod & ArgumentModifierIntBase(ArgumentModifier::Dead)) {
     M.append("d");
@@ -297,7 +364,11 @@ void FunctionSignatureSpecializationMangler::mangleSpecialization() {
     ArgumentModifierIntBase ArgMod;
     NullablePtr<SILInstruction> Inst;
     std::tie(ArgMod, Inst) = Args[i];
-    mangleArgument(ArgMod, Inst);
+    if (ArgMod ==
+          ArgumentModifierIntBase(ArgumentModifier::ClosurePropField))
+      mangleClosurePropField(ClosureFields[i], Inst.get());
+    else
+      mangleArgument(ArgMod, Inst);
     M.append("_");
   }
 
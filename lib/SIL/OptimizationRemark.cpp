@@ -0,0 +1,80 @@
+//===--- OptimizationRemark.cpp - Records of SIL optimizations ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SIL/OptimizationRemark.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/Basic/SourceManager.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
+#include <tuple>
+
+using namespace swift;
+using namespace OptRemark;
+
+/// Writes \p Str as a single-quoted YAML scalar.
+static void writeQuoted(llvm::raw_ostream &OS, StringRef Str) {
+  OS << '\'';
+  for (char C : Str) {
+    if (C == '\'')
+      OS << '\'';
+    OS << C;
+  }
+  OS << '\'';
+}
+
+bool Emitter::isEnabled() const {
+  return Module.getOptRecordStream() != nullptr;
+}
+
+void Emitter::emitPassed(StringRef RemarkName, SILInstruction *I,
+                         const Twine &Message) {
+  emitPassed(RemarkName, I->getLoc(), *I->getFunction(), Message);
+}
+
+void Emitter::emitMissed(StringRef RemarkName, SILInstruction *I,
+                         const Twine &Message) {
+  emitMissed(RemarkName, I->getLoc(), *I->getFunction(), Message);
+}
+
+void Emitter::emit(StringRef Kind, StringRef RemarkName, SILLocation Loc,
+                   SILFunction &F, const Twine &Message) {
+  llvm::raw_ostream &OS = *Module.getOptRecordStream();
+
+  OS << "--- !" << Kind << "\n";
+  OS << "Pass:            " << PassName << "\n";
+  OS << "Name:            " << RemarkName << "\n";
+
+  SourceLoc SrcLoc = Loc.getSourceLoc();
+  if (SrcLoc.isValid()) {
+    const SourceManager &SM = Module.getASTContext().SourceMgr;
+    unsigned BufferID = SM.findBufferContainingLoc(SrcLoc);
+    unsigned Line, Column;
+    std::tie(Line, Column) = SM.getLineAndColumn(SrcLoc, BufferID);
+    OS << "DebugLoc:        { File: ";
+    writeQuoted(OS, SM.getIdentifierForBuffer(BufferID));
+    OS << ", Line: " << Line << ", Column: " << Column << " }\n";
+  }
+
+  OS << "Function:        ";
+  writeQuoted(OS, F.getName());
+  OS << "\n";
+
+  SmallString<128> MessageStr;
+  OS << "Args:\n";
+  OS << "  - String:          ";
+  writeQuoted(OS, Message.toStringRef(MessageStr));
+  OS << "\n";
+  OS << "...\n";
+}
@@ -156,6 +156,8 @@ SILBasicBlock *SILBasicBlock::splitBasicBlock(iterator I) {
   // Move all of the specified instructions from the original basic block into
   // the new basic block.
   New->InstList.splice(New->end(), InstList, I, end());
+  // Both halves run as often as the original block did.
+  New->ExecutionCount = ExecutionCount;
   return New;
 }
 
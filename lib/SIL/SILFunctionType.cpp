@@ -830,18 +830,25 @@ struct DeallocatorConventions : Conventions {
 namespace {
   /// The default Swift conventions.
   struct DefaultConventions : Conventions {
+    /// Whether normal (non-self) parameters are passed at +0.
+    bool GuaranteedNormalArguments;
 
-    DefaultConventions()
-      : Conventions(ConventionsKind::Default) {}
+    DefaultConventions(bool guaranteedNormalArguments = false)
+      : Conventions(ConventionsKind::Default),
+        GuaranteedNormalArguments(guaranteedNormalArguments) {}
 
     ParameterConvention getIndirectParameter(unsigned index,
                               const AbstractionPattern &type) const override {
-      return ParameterConvention::Indirect_In;
+      return GuaranteedNormalArguments
+        ? ParameterConvention::Indirect_In_Guaranteed
+        : ParameterConvention::Indirect_In;
     }
 
     ParameterConvention getDirectParameter(unsigned index,
                               const AbstractionPattern &type) const override {
-      return ParameterConvention::Direct_Owned;
+      return GuaranteedNormalArguments
+        ? ParameterConvention::Direct_Guaranteed
+        : ParameterConvention::Direct_Owned;
     }
 
     ParameterConvention getCallee() const override {
@@ -949,13 +956,20 @@ static CanSILFunctionType getNativeSILFunctionType(SILModule &M,
                                 None, constant);
     
     case SILDeclRef::Kind::Func:
-    case SILDeclRef::Kind::Allocator:
     case SILDeclRef::Kind::Destroyer:
     case SILDeclRef::Kind::GlobalAccessor:
     case SILDeclRef::Kind::GlobalGetter:
     case SILDeclRef::Kind::DefaultArgGenerator:
     case SILDeclRef::Kind::IVarInitializer:
     case SILDeclRef::Kind::IVarDestroyer:
+      return getSILFunctionType(M, origType, substInterfaceType, extInfo,
+                    DefaultConventions(
+                      M.getOptions().EnableGuaranteedNormalArguments),
+                    None, constant);
+
+    // Allocating initializers and enum element constructors store their
+    // arguments into the new value, so they take them at +1.
+    case SILDeclRef::Kind::Allocator:
     case SILDeclRef::Kind::EnumElement:
       return getSILFunctionType(M, origType, substInterfaceType,
                                 extInfo, DefaultConventions(),
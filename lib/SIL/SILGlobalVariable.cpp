@@ -108,6 +108,12 @@ static bool analyzeStaticInitializer(SILFunction *F, SILInstruction *&Val,
           if (isa<LiteralInst>(bi->getArguments()[0]))
             continue;
           break;
+        case BuiltinValueKind::Trunc:
+        case BuiltinValueKind::ZExt:
+        case BuiltinValueKind::SExt:
+          if (isa<IntegerLiteralInst>(bi->getArguments()[0]))
+            continue;
+          break;
         default:
           return false;
         }
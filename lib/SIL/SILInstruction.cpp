@@ -802,6 +802,8 @@ bool SILInstruction::mayRelease() const {
         case llvm::Intrinsic::memcpy:
         case llvm::Intrinsic::memmove:
         case llvm::Intrinsic::memset:
+        // Profile counter increments only update their own counter.
+        case llvm::Intrinsic::instrprof_increment:
           return false;
         default:
           break;
@@ -858,6 +860,10 @@ bool SILInstruction::isAllocatingStack() const {
     if (ARI->canAllocOnStack())
       return true;
   }
+  if (auto *PAI = dyn_cast<PartialApplyInst>(this)) {
+    if (PAI->canAllocOnStack())
+      return true;
+  }
   return false;
 }
 
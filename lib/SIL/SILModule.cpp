@@ -105,10 +105,13 @@ void *SILModule::allocate(unsigned Size, unsigned Align) const {
 }
 
 void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
+  InstBytesAllocated += Size;
+  MaxLiveInsts = std::max(MaxLiveInsts, ++NumLiveInsts);
   return AlignedAlloc(Size, Align);
 }
 
 void SILModule::deallocateInst(SILInstruction *I) {
+  --NumLiveInsts;
   AlignedFree(I);
 }
 
@@ -309,7 +312,7 @@ SILFunction *SILModule::getOrCreateFunction(SILLocation loc,
                                             SILDeclRef constant,
                                             ForDefinition_t forDefinition) {
 
-  auto name = constant.mangle();
+  auto name = getMangledName(constant);
   auto constantType = Types.getConstantType(constant).castTo<SILFunctionType>();
   SILLinkage linkage = constant.getLinkage(forDefinition);
 
@@ -469,8 +472,18 @@ const BuiltinInfo &SILModule::getBuiltinInfo(Identifier ID) {
 }
 
 SILFunction *SILModule::lookUpFunction(SILDeclRef fnRef) {
-  auto name = fnRef.mangle();
-  return lookUpFunction(name);
+  return lookUpFunction(getMangledName(fnRef));
+}
+
+StringRef SILModule::getMangledName(SILDeclRef fnRef) {
+  auto &name = DeclRefNames[fnRef];
+  if (name.empty()) {
+    std::string mangled = fnRef.mangle();
+    char *buffer = static_cast<char *>(allocate(mangled.size(), 1));
+    std::copy(mangled.begin(), mangled.end(), buffer);
+    name = StringRef(buffer, mangled.size());
+  }
+  return name;
 }
 
 bool SILModule::linkFunction(SILFunction *Fun, SILModule::LinkingMode Mode) {
@@ -520,6 +520,14 @@ public:
       for (auto Id : PredIDs)
         *this << ' ' << Id;
     }
+
+    if (auto Count = BB->getExecutionCount()) {
+      if (BB->pred_empty())
+        PrintState.OS.PadToColumn(50);
+      else
+        *this << ' ';
+      *this << "// Execution count: " << *Count;
+    }
     *this << '\n';
 
     for (const SILInstruction &I : *BB) {
@@ -863,6 +871,8 @@ public:
   
   void visitPartialApplyInst(PartialApplyInst *CI) {
     *this << "partial_apply ";
+    if (CI->canAllocOnStack())
+      *this << "[stack] ";
     *this << getID(CI->getCallee());
     printSubstitutions(CI->getSubstitutions());
     *this << '(';
@@ -1446,6 +1446,12 @@ public:
   void checkDeallocRefInst(DeallocRefInst *DI) {
     require(DI->getOperand()->getType().isObject(),
             "Operand of dealloc_ref must be object");
+    if (auto *PAI = dyn_cast<PartialApplyInst>(DI->getOperand())) {
+      require(DI->canAllocOnStack() && PAI->canAllocOnStack(),
+              "dealloc_ref of a closure context needs [stack] on both the "
+              "partial_apply and the dealloc_ref");
+      return;
+    }
     require(DI->getOperand()->getType().getClassOrBoundGenericClass(),
             "Operand of dealloc_ref must be of class type");
   }
@@ -1067,6 +1067,52 @@ namespace {
       return new (TC, Dependent) AddressOnlyTypeLowering(silType);
     }
 
+    /// Returns the key under which the classification of the nominal type
+    /// \p type is shared with other TypeConverters, or an empty key if it
+    /// depends on a generic context and can't be shared.
+    std::pair<CanType, const ModuleDecl *> getSharedKey(CanType type) {
+      if (Dependent || Sig || Expansion != ResilienceExpansion::Minimal ||
+          type->hasTypeParameter() || type->hasArchetype() ||
+          type->hasDynamicSelfType())
+        return {CanType(), nullptr};
+      return {type, M.getSwiftModule()};
+    }
+
+    /// Lowers the nominal type \p type using a classification computed by
+    /// another TypeConverter, if there is one, or else by calling
+    /// \p lowerUncached and recording the result.
+    template <class LoadableLowering, class UncachedFn>
+    const TypeLowering *lowerNominalShared(CanType type,
+                                           UncachedFn lowerUncached) {
+      auto key = getSharedKey(type);
+      if (!key.first)
+        return lowerUncached();
+
+      auto &kinds = M.getASTContext().LoweredTypeKinds;
+      auto found = kinds.find(key);
+      if (found != kinds.end()) {
+        switch (LoweredTypeKind(found->second)) {
+        case LoweredTypeKind::Trivial:
+          return handleTrivial(type);
+        case LoweredTypeKind::AddressOnly:
+          return handleAddressOnly(type);
+        case LoweredTypeKind::Reference:
+        case LoweredTypeKind::AggWithReference:
+          return new (TC, Dependent) LoadableLowering(OrigType);
+        }
+        llvm_unreachable("bad type classification");
+      }
+
+      auto *lowering = lowerUncached();
+      LoweredTypeKind kind = LoweredTypeKind::AggWithReference;
+      if (lowering->isAddressOnly())
+        kind = LoweredTypeKind::AddressOnly;
+      else if (lowering->isTrivial())
+        kind = LoweredTypeKind::Trivial;
+      kinds[key] = unsigned(kind);
+      return lowering;
+    }
+
     /// @unowned is basically like a reference type lowering except
     /// it manipulates unowned reference counts instead of strong.
     const TypeLowering *visitUnownedStorageType(CanUnownedStorageType type) {
@@ -1146,7 +1192,12 @@ namespace {
     }
 
     const TypeLowering *visitAnyStructType(CanType structType, StructDecl *D) {
+      return lowerNominalShared<LoadableStructTypeLowering>(structType, [&] {
+        return lowerStructType(structType, D);
+      });
+    }
 
+    const TypeLowering *lowerStructType(CanType structType, StructDecl *D) {
       // For now, if the type does not have a fixed layout in all resilience
       // domains, we will treat it as address-only in SIL.
       if (!D->hasFixedLayout(M.getSwiftModule(), Expansion))
@@ -1176,7 +1227,12 @@ namespace {
     }
         
     const TypeLowering *visitAnyEnumType(CanType enumType, EnumDecl *D) {
+      return lowerNominalShared<LoadableEnumTypeLowering>(enumType, [&] {
+        return lowerEnumType(enumType, D);
+      });
+    }
 
+    const TypeLowering *lowerEnumType(CanType enumType, EnumDecl *D) {
       // For now, if the type does not have a fixed layout in all resilience
       // domains, we will treat it as address-only in SIL.
       if (!D->hasFixedLayout(M.getSwiftModule(), Expansion))
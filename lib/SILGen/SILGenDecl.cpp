@@ -23,6 +23,7 @@
 #include "swift/SIL/SILWitnessVisitor.h"
 #include "swift/SIL/TypeLowering.h"
 #include "swift/AST/AST.h"
+#include "swift/AST/ASTWalker.h"
 #include "swift/AST/Mangle.h"
 #include "swift/AST/Module.h"
 #include "swift/AST/NameLookup.h"
@@ -281,11 +282,21 @@ public:
 
     SILType lType = SGF.getLoweredType(decl->getType()->getRValueType());
 
-    // The variable may have its lifetime extended by a closure, heap-allocate
-    // it using a box.
-    AllocBoxInst *allocBox =
-        SGF.B.createAllocBox(decl, lType, {decl->isLet(), ArgNo});
-    SILValue addr = SGF.B.createProjectBox(decl, allocBox);
+    SILValue addr;
+    SILValue box;
+    if (SGF.SGM.M.getOptions().EnableStackAllocatedLocalVars &&
+        !SGF.isCapturedLocalVar(decl)) {
+      // Nothing can extend the lifetime of the variable past its scope, so
+      // it can live on the stack. The dealloc_stack cleanup is pushed below
+      // the cleanups of the variable itself.
+      addr = SGF.B.createAllocStack(decl, lType, {decl->isLet(), ArgNo});
+      SGF.enterDeallocStackCleanup(addr);
+    } else {
+      // The variable may have its lifetime extended by a closure,
+      // heap-allocate it using a box.
+      box = SGF.B.createAllocBox(decl, lType, {decl->isLet(), ArgNo});
+      addr = SGF.B.createProjectBox(decl, box);
+    }
 
     // Mark the memory as uninitialized, so DI will track it for us.
     if (NeedsMarkUninit)
@@ -293,7 +304,7 @@ public:
 
     /// Remember that this is the memory location that we're emitting the
     /// decl to.
-    SGF.VarLocs[decl] = SILGenFunction::VarLoc::get(addr, allocBox);
+    SGF.VarLocs[decl] = SILGenFunction::VarLoc::get(addr, box);
 
     // Push a cleanup to destroy the local variable.  This has to be
     // inactive until the variable is initialized.
@@ -1261,6 +1272,66 @@ SILGenFunction::emitLocalVariableWithCleanup(VarDecl *vd, bool NeedsMarkUninit,
       new LocalVariableInitialization(vd, NeedsMarkUninit, ArgNo, *this));
 }
 
+namespace {
+/// Collects the declarations captured by the closures and local functions
+/// nested in a local context.
+class CaptureCollector : public ASTWalker {
+  llvm::SmallPtrSetImpl<ValueDecl *> &Captured;
+
+  void collect(CaptureInfo &captureInfo) {
+    if (!captureInfo.hasBeenComputed()) {
+      Complete = false;
+      return;
+    }
+    for (auto capture : captureInfo.getCaptures())
+      Captured.insert(capture.getDecl());
+  }
+
+public:
+  bool Complete = true;
+
+  CaptureCollector(llvm::SmallPtrSetImpl<ValueDecl *> &Captured)
+    : Captured(Captured) {}
+
+  std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
+    if (auto *closure = dyn_cast<AbstractClosureExpr>(E))
+      collect(closure->getCaptureInfo());
+    return { true, E };
+  }
+
+  bool walkToDeclPre(Decl *D) override {
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D))
+      collect(AFD->getCaptureInfo());
+    return true;
+  }
+};
+} // end anonymous namespace
+
+bool SILGenFunction::isCapturedLocalVar(VarDecl *vd) {
+  // 'self' and variables with observers are emitted into boxes
+  // unconditionally; the code that consumes them expects a box.
+  if (vd->isSelfParameter() || vd->hasObservers())
+    return true;
+
+  DeclContext *DC = vd->getDeclContext();
+  auto found = ScannedCaptureContexts.find(DC);
+  if (found == ScannedCaptureContexts.end()) {
+    CaptureCollector collector(CapturedLocalDecls);
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(DC))
+      AFD->walk(collector);
+    else if (auto *closure = dyn_cast<AbstractClosureExpr>(DC))
+      closure->walk(collector);
+    else
+      collector.Complete = false;
+    found = ScannedCaptureContexts.insert({DC, collector.Complete}).first;
+  }
+
+  // If we couldn't see every capture list, assume the worst.
+  if (!found->second)
+    return true;
+  return CapturedLocalDecls.count(vd);
+}
+
 /// Create an Initialization for an uninitialized temporary.
 std::unique_ptr<TemporaryInitialization>
 SILGenFunction::emitTemporary(SILLocation loc, const TypeLowering &tempTL) {
@@ -1325,7 +1396,9 @@ void SILGenFunction::deallocateUninitializedLocalVariable(SILLocation silLoc,
   // Ignore let values captured without a memory location.
   if (!loc.value->getType().isAddress()) return;
 
-  assert(loc.box && "captured var should have been given a box");
+  // Stack-allocated variables are deallocated by their own cleanup.
+  if (!loc.box) return;
+
   B.createDeallocBox(silLoc, loc.value->getType().getObjectType(),
                      loc.box);
 }
@@ -19,6 +19,7 @@
 #include "swift/AST/AnyFunctionRef.h"
 #include "swift/SIL/SILBuilder.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/SmallPtrSet.h"
 
 namespace swift {
   class ParameterList;
@@ -431,6 +432,15 @@ public:
   /// emitted. The map is queried to produce the lvalue for a DeclRefExpr to
   /// a local variable.
   llvm::DenseMap<ValueDecl*, VarLoc> VarLocs;
+
+  /// The local contexts whose closures and local functions have been scanned
+  /// for captures by isCapturedLocalVar, mapped to whether the capture lists
+  /// of all of them were available.
+  llvm::DenseMap<DeclContext *, bool> ScannedCaptureContexts;
+
+  /// The declarations captured by some closure or local function in one of
+  /// the ScannedCaptureContexts.
+  llvm::SmallPtrSet<ValueDecl *, 8> CapturedLocalDecls;
  
   /// When rebinding 'self' during an initializer delegation, we have to be
   /// careful to preserve the object at 1 retain count during the delegation
@@ -1526,6 +1536,10 @@ public:
   emitLocalVariableWithCleanup(VarDecl *D, bool NeedsMarkUninit,
                                unsigned ArgNo = 0);
 
+  /// Returns true if \p vd may be captured by a closure or local function,
+  /// and therefore has to be given a box.
+  bool isCapturedLocalVar(VarDecl *vd);
+
   /// Emit the allocation for a local temporary, provides an
   /// Initialization that can be used to initialize it, and registers
   /// cleanups in the active scope.
@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -63,7 +64,7 @@ static void walkForProfiling(AbstractFunctionDecl *Root, ASTWalker &Walker) {
 ProfilerRAII::ProfilerRAII(SILGenModule &SGM, AbstractFunctionDecl *D)
     : SGM(SGM), PreviousProfiler(std::move(SGM.Profiler)) {
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  if ((!Opts.GenerateProfile && !SGM.ProfileReader) || isUnmappedDecl(D))
     return;
   SGM.Profiler =
       llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
@@ -679,6 +680,15 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
 
+  if (SGM.ProfileReader) {
+    // A function that wasn't run, or whose counters no longer line up with
+    // the source, gets no counts.
+    if (SGM.ProfileReader->getFunctionCounts(getPGOFuncName(), FunctionHash,
+                                             RegionCounts) ||
+        RegionCounts.size() != NumRegionCounters)
+      RegionCounts.clear();
+  }
+
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SGM.M.getASTContext().SourceMgr);
     walkForProfiling(Root, Coverage);
@@ -700,6 +710,12 @@ static SILLocation getLocation(ASTNode Node) {
     llvm_unreachable("unsupported ASTNode");
 }
 
+std::string SILGenProfiling::getPGOFuncName() const {
+  return llvm::getPGOFuncName(CurrentFuncName,
+                              getEquivalentPGOLinkage(CurrentFuncLinkage),
+                              CurrentFileName);
+}
+
 void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   auto &C = Builder.getASTContext();
 
@@ -707,12 +723,18 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   assert(CounterIt != RegionCounterMap.end() &&
          "cannot increment non-existent counter");
 
+  if (SGM.ProfileReader) {
+    if (!RegionCounts.empty() && Builder.hasValidInsertionPoint())
+      Builder.getInsertionBB()->setExecutionCount(
+          RegionCounts[CounterIt->second]);
+    if (!SGM.M.getOptions().GenerateProfile)
+      return;
+  }
+
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
-  std::string PGOFuncName = llvm::getPGOFuncName(
-      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
-      CurrentFileName);
+  std::string PGOFuncName = getPGOFuncName();
 
   SILLocation Loc = getLocation(Node);
   SILValue Args[] = {
@@ -43,6 +43,10 @@ private:
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The current function's counter values in the profile given with
+  /// -profile-use, or empty if the profile doesn't have them.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
@@ -53,12 +57,18 @@ public:
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
   /// Emit SIL to increment the counter for \c Node.
+  ///
+  /// When building with -profile-use instead, attach the counter's value to
+  /// the current block.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
 private:
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(AbstractFunctionDecl *Root);
 
+  /// The name of the current function in profile data.
+  std::string getPGOFuncName() const;
+
   friend struct ProfilerRAII;
 };
 
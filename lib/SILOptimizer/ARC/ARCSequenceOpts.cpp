@@ -14,6 +14,7 @@
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "ARCSequenceOpts.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SILOptimizer/Utils/Local.h"
@@ -52,10 +53,14 @@ void ARCPairingContext::optimizeMatchingSet(
     ARCMatchingSet &MatchSet, llvm::SmallVectorImpl<SILInstruction *> &NewInsts,
     llvm::SmallVectorImpl<SILInstruction *> &DeadInsts) {
   DEBUG(llvm::dbgs() << "**** Optimizing Matching Set ****\n");
+  OptRemark::Emitter ORE(DEBUG_TYPE, F.getModule());
   // Add the old increments to the delete list.
   for (SILInstruction *Increment : MatchSet.Increments) {
     MadeChange = true;
     DEBUG(llvm::dbgs() << "    Deleting increment: " << *Increment);
+    ORE.emitPassed("RetainReleasePairRemoved", Increment,
+                   "removed retain paired with " +
+                   Twine(MatchSet.Decrements.size()) + " release(s)");
     DeadInsts.push_back(Increment);
     ++NumRefCountOpsRemoved;
   }
@@ -73,6 +78,7 @@ bool ARCPairingContext::performMatching(
     llvm::SmallVectorImpl<SILInstruction *> &NewInsts,
     llvm::SmallVectorImpl<SILInstruction *> &DeadInsts) {
   bool MatchedPair = false;
+  OptRemark::Emitter ORE(DEBUG_TYPE, F.getModule());
 
   DEBUG(llvm::dbgs() << "**** Computing ARC Matching Sets for " << F.getName()
                      << " ****\n");
@@ -102,6 +108,9 @@ bool ARCPairingContext::performMatching(
       // happen here since we may remove instructions that are insertion points
       // for other instructions.
       optimizeMatchingSet(Set, NewInsts, DeadInsts);
+    } else {
+      ORE.emitMissed("RetainNotPaired", Increment,
+                     "could not pair retain with a release");
     }
   }
 
@@ -302,19 +302,22 @@ bool swift::mustUseValue(SILInstruction *User, SILValue Ptr,
 /// guaranteed parameters if we are known safe in both directions.
 bool swift::mustGuaranteedUseValue(SILInstruction *User, SILValue Ptr,
                                    AliasAnalysis *AA) {
-  // Right now just pattern match applies.
-  auto *AI = dyn_cast<ApplyInst>(User);
-  if (!AI)
+  // Right now just pattern match full apply sites.
+  if (!isa<FullApplySite>(User))
     return false;
 
-  // For now just look for guaranteed self.
-  //
-  // TODO: Expand this to handle *any* guaranteed parameter.
-  if (!AI->hasGuaranteedSelfArgument())
-    return false;
+  FullApplySite FAS(User);
 
-  // Return true if Ptr alias's self.
-  return AA->isMustAlias(AI->getSelfArgument(), Ptr);
+  // Return true if Ptr must alias any argument that is passed @guaranteed.
+  auto Params = FAS.getSubstCalleeType()->getParameters();
+  auto Args = FAS.getArgumentsWithoutIndirectResults();
+  for (unsigned i : indices(Params)) {
+    if (!Params[i].isGuaranteed())
+      continue;
+    if (AA->isMustAlias(Args[i], Ptr))
+      return true;
+  }
+  return false;
 }
 
 //===----------------------------------------------------------------------===//
@@ -434,12 +437,16 @@ mayGuaranteedUseValue(SILInstruction *User, SILValue Ptr, AliasAnalysis *AA) {
   // iterate through the function parameters. If any of the parameters are
   // guaranteed, attempt to prove that the passed in parameter cannot alias
   // Ptr. If we fail, return true.
+  //
+  // The parameters do not include the indirect results, so index into the
+  // arguments that follow them.
   CanSILFunctionType FType = FAS.getSubstCalleeType();
   auto Params = FType->getParameters();
-  for (unsigned i : indices(Params)) {    
+  auto Args = FAS.getArgumentsWithoutIndirectResults();
+  for (unsigned i : indices(Params)) {
     if (!Params[i].isGuaranteed())
       continue;
-    SILValue Op = FAS.getArgument(i);
+    SILValue Op = Args[i];
     if (!AA->isNoAlias(Op, Ptr))
       return true;
   }
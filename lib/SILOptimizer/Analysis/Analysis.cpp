@@ -27,6 +27,15 @@
 
 using namespace swift;
 
+const char *SILAnalysis::getKindName(AnalysisKind Kind) {
+  switch (Kind) {
+#define ANALYSIS(NAME) \
+  case AnalysisKind::NAME: return #NAME;
+#include "swift/SILOptimizer/Analysis/Analysis.def"
+  }
+  llvm_unreachable("unhandled analysis kind");
+}
+
 void SILAnalysis::verifyFunction(SILFunction *F) {
   // Only functions with bodies can be analyzed by the analysis.
   assert(F->isDefinition() && "Can't analyze external functions");
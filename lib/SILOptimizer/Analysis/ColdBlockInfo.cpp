@@ -106,11 +106,20 @@ ColdBlockInfo::BranchHint ColdBlockInfo::getBranchHint(SILValue Cond,
   return BranchHint::None;
 }
 
+/// \return true if the profile says that \p BB was never executed.
+static bool isNeverExecuted(const SILBasicBlock *BB) {
+  auto Count = BB->getExecutionCount();
+  return Count && *Count == 0;
+}
+
 /// \return true if the CFG edge FromBB->ToBB is directly gated by a _slowPath
-/// branch hint.
+/// branch hint, or if the profile says it was never taken.
 bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB,
                                const SILBasicBlock *ToBB,
                                int recursionDepth) {
+  if (isNeverExecuted(ToBB) && !isNeverExecuted(FromBB))
+    return true;
+
   auto *CBI = dyn_cast<CondBranchInst>(FromBB->getTerminator());
   if (!CBI)
     return false;
@@ -127,7 +136,8 @@ bool ColdBlockInfo::isSlowPath(const SILBasicBlock *FromBB,
   return ToBB == ColdTarget;
 }
 
-/// \return true if the given block is dominated by a _slowPath branch hint.
+/// \return true if the given block is dominated by a _slowPath branch hint, or
+/// by a block that the profile says was never executed.
 ///
 /// Cache all blocks visited to avoid introducing quadratic behavior.
 bool ColdBlockInfo::isCold(const SILBasicBlock *BB, int recursionDepth) {
@@ -142,12 +152,20 @@ bool ColdBlockInfo::isCold(const SILBasicBlock *BB, int recursionDepth) {
   if (!Node)
     return true;
 
+  // A block can't run more often than the blocks that dominate it, so
+  // everything below a block that never ran is cold too.
+  if (isNeverExecuted(BB)) {
+    ColdBlockMap[BB] = true;
+    return true;
+  }
+
   std::vector<const SILBasicBlock*> DomChain;
   DomChain.push_back(BB);
   bool IsCold = false;
   Node = Node->getIDom();
   while (Node) {
-    if (isSlowPath(Node->getBlock(), DomChain.back(), recursionDepth)) {
+    if (isSlowPath(Node->getBlock(), DomChain.back(), recursionDepth) ||
+        isNeverExecuted(Node->getBlock())) {
       IsCold = true;
       break;
     }
@@ -1033,6 +1033,8 @@ void EscapeAnalysis::buildConnectionGraph(FunctionInfo *FInfo,
   if (BottomUpOrder.prepareForVisiting(FInfo))
     return;
 
+  recordComputed();
+
   DEBUG(llvm::dbgs() << "  >> build graph for " <<
         FInfo->Graph.F->getName() << '\n');
 
@@ -1208,6 +1210,25 @@ void EscapeAnalysis::analyzeInstruction(SILInstruction *I,
       return;
     }
 
+    if (auto *PAI = dyn_cast<PartialApplyInst>(FAS.getCallee())) {
+      // Calling a closure passes the captured values to the closure's
+      // function, but the closure context itself is not visible to the
+      // function and does not escape. This lets a non-escaping closure be
+      // stack promoted after the function it is passed to is inlined.
+      for (SILValue Captured : PAI->getArguments())
+        setEscapesGlobal(ConGraph, Captured);
+      if (auto *TAI = dyn_cast<TryApplyInst>(I)) {
+        setEscapesGlobal(ConGraph, TAI->getNormalBB()->getBBArg(0));
+        setEscapesGlobal(ConGraph, TAI->getErrorBB()->getBBArg(0));
+      }
+      for (SILValue Arg : FAS.getArguments()) {
+        if (!isNonWritableMemoryAddress(Arg))
+          setEscapesGlobal(ConGraph, Arg);
+      }
+      setEscapesGlobal(ConGraph, I);
+      return;
+    }
+
     if (RecursionDepth < MaxRecursionDepth) {
       CalleeList Callees = BCA->getCalleeList(FAS);
       if (Callees.allCalleesVisible()) {
@@ -1838,6 +1859,9 @@ bool EscapeAnalysis::canParameterEscape(FullApplySite FAS, int ParamIdx,
 }
 
 void EscapeAnalysis::invalidate(InvalidationKind K) {
+  for (auto &Entry : Function2Info)
+    if (Entry.second->isValid())
+      recordInvalidated();
   Function2Info.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
@@ -204,6 +204,15 @@ MemBehavior MemoryBehaviorVisitor::visitBuiltinInst(BuiltinInst *BI) {
     return MemBehavior::None;
   }
 
+  // A profile counter increment only writes to a counter of the profiling
+  // runtime, which no SIL value refers to. It still has side effects, so it
+  // isn't removed, but it doesn't block optimizations of the code around it.
+  if (BI->getIntrinsicInfo().ID == llvm::Intrinsic::instrprof_increment) {
+    DEBUG(llvm::dbgs() << "  Found profile counter increment. Returning"
+                          " None.\n");
+    return MemBehavior::None;
+  }
+
   // If the builtin is side effect free, then it can only read memory.
   if (!BI->mayHaveSideEffects()) {
     DEBUG(llvm::dbgs() << "  Found apply of side effect free builtin. "
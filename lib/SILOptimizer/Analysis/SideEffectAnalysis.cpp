@@ -152,7 +152,13 @@ bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
     Effects.Traps = true;
     return true;
   }
-  switch (F->getEffectsKind()) {
+  EffectsKind Kind = F->getEffectsKind();
+  // For a declaration, fall back to what the defining module found out when
+  // it analyzed the body.
+  if (Kind == EffectsKind::Unspecified && !F->isDefinition())
+    Kind = F->getInferredEffectsKind();
+
+  switch (Kind) {
     case EffectsKind::ReadNone:
       return true;
     case EffectsKind::ReadOnly:
@@ -248,6 +254,8 @@ void SideEffectAnalysis::analyzeFunction(FunctionInfo *FInfo,
   if (BottomUpOrder.prepareForVisiting(FInfo))
     return;
 
+  recordComputed();
+
   // Handle @effects attributes
   if (getDefinedEffects(FInfo->FE, FInfo->F)) {
     DEBUG(llvm::dbgs() << "  -- has defined effects " <<
@@ -501,6 +509,9 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
 }
 
 void SideEffectAnalysis::invalidate(InvalidationKind K) {
+  for (auto &Entry : Function2Info)
+    if (Entry.second->isValid())
+      recordInvalidated();
   Function2Info.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
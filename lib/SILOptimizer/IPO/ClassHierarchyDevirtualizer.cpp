@@ -0,0 +1,192 @@
+//===--- ClassHierarchyDevirtualizer.cpp - Devirtualize final methods -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Devirtualize all class_method calls to methods which are effectively final,
+// i.e. which are not overridden by any subclass of the class they are called
+// on.
+//
+// The callees of private methods, and of internal methods in whole-module
+// compilation, are statically knowable. For these methods the class hierarchy
+// analysis knows every subclass which could override them, and a method is
+// effectively final for a class if all of the class's subclasses inherit its
+// implementation from the vtable of the class.
+//
+// With the class_method calls gone, dead function elimination no longer
+// keeps the implementations alive through the vtables, and drops the vtable
+// entries and the methods once they are inlined everywhere.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "class-hierarchy-devirtualizer"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/Basic/Demangle.h"
+#include "swift/SIL/OptimizationRemark.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Devirtualize.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+#include <algorithm>
+
+using namespace swift;
+
+STATISTIC(NumFinalMethods, "Number of methods inferred to be final");
+STATISTIC(NumFinalCallsDevirtualized,
+          "Number of class_method calls to final methods devirtualized");
+
+namespace {
+
+class ClassHierarchyDevirtualizer : public SILModuleTransform {
+  ClassHierarchyAnalysis *CHA;
+
+  /// Maps a method called on a class to its implementation, if the method is
+  /// effectively final for the class, or to null if it isn't.
+  llvm::DenseMap<std::pair<ClassDecl *, SILDeclRef>, SILFunction *>
+    FinalImplementations;
+
+  SILFunction *getFinalImplementation(ClassDecl *CD, SILDeclRef Member);
+  bool devirtualizeFinalCalls(SILFunction &F, OptRemark::Emitter &ORE);
+
+public:
+  void run() override;
+
+  StringRef getName() override { return "Class Hierarchy Devirtualizer"; }
+};
+
+} // end anonymous namespace
+
+/// Returns the implementation of \p Member for instances of \p CD if no
+/// subclass of \p CD overrides it, or null otherwise.
+SILFunction *
+ClassHierarchyDevirtualizer::getFinalImplementation(ClassDecl *CD,
+                                                    SILDeclRef Member) {
+  auto Found = FinalImplementations.find({CD, Member});
+  if (Found != FinalImplementations.end())
+    return Found->second;
+
+  SILModule &M = *getModule();
+  SILFunction *Impl = M.lookUpFunctionInVTable(CD, Member);
+  if (Impl) {
+    // Subclasses without a vtable in the module are unknown, and
+    // lookUpFunctionInVTable returns null for them.
+    auto InheritsImpl = [&](ClassDecl *Sub) {
+      return M.lookUpFunctionInVTable(Sub, Member) == Impl;
+    };
+    auto &DirectSubs = CHA->getDirectSubClasses(CD);
+    auto &IndirectSubs = CHA->getIndirectSubClasses(CD);
+    if (!std::all_of(DirectSubs.begin(), DirectSubs.end(), InheritsImpl) ||
+        !std::all_of(IndirectSubs.begin(), IndirectSubs.end(), InheritsImpl))
+      Impl = nullptr;
+  }
+
+  if (Impl) {
+    DEBUG(llvm::dbgs() << "  " << Impl->getName() << " is final for "
+                       << CD->getName() << "\n");
+    ++NumFinalMethods;
+  }
+  FinalImplementations[{CD, Member}] = Impl;
+  return Impl;
+}
+
+/// Devirtualize the class_method calls in \p F to methods which are final
+/// for the static type of their instance.
+bool ClassHierarchyDevirtualizer::devirtualizeFinalCalls(
+    SILFunction &F, OptRemark::Emitter &ORE) {
+  SILModule &M = F.getModule();
+  llvm::SmallVector<SILInstruction *, 8> DeadApplies;
+  llvm::SmallVector<ApplySite, 8> NewApplies;
+
+  for (auto &BB : F) {
+    for (auto It = BB.begin(), End = BB.end(); It != End;) {
+      auto &I = *It++;
+      auto Apply = FullApplySite::isa(&I);
+      if (!Apply)
+        continue;
+      auto *CMI = dyn_cast<ClassMethodInst>(Apply.getCallee());
+      if (!CMI)
+        continue;
+
+      // Overrides of other methods can be added in other modules.
+      SILDeclRef Member = CMI->getMember();
+      if (!calleesAreStaticallyKnowable(M, Member))
+        continue;
+
+      auto Instance = stripUpCasts(CMI->getOperand());
+      auto ClassType = Instance->getType();
+      if (ClassType.is<MetatypeType>())
+        ClassType = ClassType.getMetatypeInstanceType(M);
+      auto *CD = ClassType.getClassOrBoundGenericClass();
+      if (!CD || !getFinalImplementation(CD, Member))
+        continue;
+
+      auto NewInstPair = tryDevirtualizeClassMethod(Apply, Instance);
+      if (!NewInstPair.second)
+        continue;
+
+      ++NumFinalCallsDevirtualized;
+      if (ORE.isEnabled()) {
+        StringRef Callee =
+            NewInstPair.second.getReferencedFunction()->getName();
+        ORE.emitPassed("DevirtualizedFinalMethod", &I,
+                       "devirtualized call to " +
+                       Demangle::demangleSymbolAsString(
+                           Callee.data(), Callee.size(),
+                           Demangle::DemangleOptions::
+                               SimplifiedUIDemangleOptions()) +
+                       ", which is not overridden in the module");
+      }
+
+      if (!isa<TryApplyInst>(&I))
+        I.replaceAllUsesWith(NewInstPair.first);
+      DeadApplies.push_back(&I);
+      NewApplies.push_back(NewInstPair.second);
+    }
+  }
+
+  while (!DeadApplies.empty()) {
+    auto *AI = DeadApplies.pop_back_val();
+    recursivelyDeleteTriviallyDeadInstructions(AI, true);
+  }
+
+  // Link in the bodies of the new callees, after deleting the old applies as
+  // in the Devirtualizer.
+  for (auto Apply : NewApplies) {
+    auto *CalleeFn = Apply.getReferencedFunction();
+    if (!CalleeFn->isDefinition())
+      M.linkFunction(CalleeFn, SILModule::LinkingMode::LinkAll);
+  }
+
+  return !NewApplies.empty();
+}
+
+void ClassHierarchyDevirtualizer::run() {
+  CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
+  OptRemark::Emitter ORE(DEBUG_TYPE, *getModule());
+  FinalImplementations.clear();
+
+  DEBUG(llvm::dbgs() << "***** ClassHierarchyDevirtualizer *****\n");
+  for (auto &F : *getModule()) {
+    if (F.isExternalDeclaration() || !F.shouldOptimize())
+      continue;
+    if (devirtualizeFinalCalls(F, ORE))
+      invalidateAnalysis(&F,
+                         SILAnalysis::InvalidationKind::CallsAndInstructions);
+  }
+}
+
+SILTransform *swift::createClassHierarchyDevirtualizer() {
+  return new ClassHierarchyDevirtualizer();
+}
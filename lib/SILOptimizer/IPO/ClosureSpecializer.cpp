@@ -52,6 +52,18 @@
 /// 3. Handling addresses. We currently do not handle address types. We can in
 ///    the future by introducing alloc_stacks.
 ///
+/// 4. Closures stored in a struct. A closure may also be passed as a field of
+///    a struct argument, e.g. a struct holding a callback, and then be
+///    extracted and invoked in the callee. In this case we keep the struct
+///    argument and map the struct_extracts of the closure field in the callee
+///    to the "copy" partial apply. We only do this for @guaranteed structs, so
+///    the reference count operations on the extracted closure in the callee
+///    are balanced and can be moved to the "copy" partial apply, which is
+///    released at the exits like any guaranteed closure. Once the extracted
+///    field is dead in the specialized function, function signature
+///    optimization explodes the struct argument and drops the closure field,
+///    and the original closure context can be removed.
+///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "closure-specialization"
@@ -133,7 +145,15 @@ public:
 private:
   static SILFunction *initCloned(const CallSiteDescriptor &CallSiteDesc,
                                  StringRef ClonedName);
+
+  void visitStructExtractInst(StructExtractInst *Inst);
+
   const CallSiteDescriptor &CallSiteDesc;
+
+  /// If the closure is passed in a struct field, the struct argument of the
+  /// original function and the "copy" of the closure its field is mapped to.
+  SILArgument *ClosureAggregateArg = nullptr;
+  SILInstruction *FieldClosure = nullptr;
 };
 
 } // end anonymous namespace
@@ -151,6 +171,10 @@ class CallSiteDescriptor {
   unsigned ClosureIndex;
   SILParameterInfo ClosureParamInfo;
 
+  // If the closure is passed as a field of the struct argument at
+  // ClosureIndex, this is the index of the field.
+  Optional<unsigned> ClosureFieldNo;
+
   // This is only needed if we have guaranteed parameters. In most cases it will
   // have only one element, a return inst.
   llvm::TinyPtrVector<SILBasicBlock *> NonFailureExitBBs;
@@ -158,9 +182,10 @@ class CallSiteDescriptor {
 public:
   CallSiteDescriptor(ClosureInfo *CInfo, FullApplySite AI,
                      unsigned ClosureIndex, SILParameterInfo ClosureParamInfo,
-                     llvm::TinyPtrVector<SILBasicBlock *> &&NonFailureExitBBs)
+                     llvm::TinyPtrVector<SILBasicBlock *> &&NonFailureExitBBs,
+                     Optional<unsigned> ClosureFieldNo = None)
     : CInfo(CInfo), AI(AI), ClosureIndex(ClosureIndex),
-      ClosureParamInfo(ClosureParamInfo),
+      ClosureParamInfo(ClosureParamInfo), ClosureFieldNo(ClosureFieldNo),
       NonFailureExitBBs(NonFailureExitBBs) {}
 
   CallSiteDescriptor(CallSiteDescriptor&&) =default;
@@ -184,6 +209,12 @@ public:
 
   unsigned getClosureIndex() const { return ClosureIndex; }
 
+  /// Returns true if the closure is passed as a field of a struct argument
+  /// instead of being passed directly.
+  bool isClosureInField() const { return ClosureFieldNo.hasValue(); }
+
+  unsigned getClosureFieldNo() const { return ClosureFieldNo.getValue(); }
+
   SILParameterInfo getClosureParameterInfo() const { return ClosureParamInfo; }
 
   SILInstruction *
@@ -273,11 +304,12 @@ static void rewriteApplyInst(const CallSiteDescriptor &CSDesc,
   SILBuilderWithScope Builder(Closure);
   FunctionRefInst *FRI = Builder.createFunctionRef(AI.getLoc(), NewF);
 
-  // Create the args for the new apply by removing the closure argument...
+  // Create the args for the new apply by removing the closure argument, unless
+  // the closure is passed in a struct which the callee still receives...
   llvm::SmallVector<SILValue, 8> NewArgs;
   unsigned Index = 0;
   for (auto Arg : AI.getArguments()) {
-    if (Index != CSDesc.getClosureIndex())
+    if (Index != CSDesc.getClosureIndex() || CSDesc.isClosureInField())
       NewArgs.push_back(Arg);
     Index++;
   }
@@ -401,6 +433,13 @@ std::string CallSiteDescriptor::createName() const {
   FunctionSignatureSpecializationMangler FSSM(P, M, isFragile(),
                                               getApplyCallee());
 
+  if (isClosureInField()) {
+    FSSM.setArgumentClosurePropField(getClosureIndex(), getClosureFieldNo(),
+                                     getClosure());
+    FSSM.mangle();
+    return M.finalize();
+  }
+
   if (auto *PAI = dyn_cast<PartialApplyInst>(getClosure())) {
     FSSM.setArgumentClosureProp(getClosureIndex(), PAI);
     FSSM.mangle();
@@ -509,11 +548,13 @@ ClosureSpecCloner::initCloned(const CallSiteDescriptor &CallSiteDesc,
   llvm::SmallVector<SILParameterInfo, 4> NewParameterInfoList;
 
   // First add to NewParameterInfoList all of the SILParameterInfo in the
-  // original function except for the closure.
+  // original function except for the closure. A struct containing the closure
+  // is kept.
   CanSILFunctionType ClosureUserFunTy = ClosureUser->getLoweredFunctionType();
   unsigned Index = ClosureUserFunTy->getNumIndirectResults();
   for (auto &param : ClosureUserFunTy->getParameters()) {
-    if (Index != CallSiteDesc.getClosureIndex())
+    if (Index != CallSiteDesc.getClosureIndex() ||
+        CallSiteDesc.isClosureInField())
       NewParameterInfoList.push_back(param);
     ++Index;
   }
@@ -596,8 +637,11 @@ void ClosureSpecCloner::populateCloned() {
   for (size_t i = 0, e = ClosureUserEntryBB->bbarg_size(); i != e; ++i) {
     SILArgument *Arg = ClosureUserEntryBB->getBBArg(i);
     if (i == CallSiteDesc.getClosureIndex()) {
-      ClosureArg = Arg;
-      continue;
+      if (!CallSiteDesc.isClosureInField()) {
+        ClosureArg = Arg;
+        continue;
+      }
+      ClosureAggregateArg = Arg;
     }
 
     // Otherwise, create a new argument which copies the original argument
@@ -633,7 +677,10 @@ void ClosureSpecCloner::populateCloned() {
   SILValue FnVal =
       Builder.createFunctionRef(CallSiteDesc.getLoc(), ClosedOverFun);
   auto *NewClosure = CallSiteDesc.createNewClosure(Builder, FnVal, NewPAIArgs);
-  ValueMap.insert(std::make_pair(ClosureArg, SILValue(NewClosure)));
+  if (ClosureArg)
+    ValueMap.insert(std::make_pair(ClosureArg, SILValue(NewClosure)));
+  else
+    FieldClosure = NewClosure;
 
   BBMap.insert(std::make_pair(ClosureUserEntryBB, ClonedEntryBB));
   // Recursively visit original BBs in depth-first preorder, starting with the
@@ -683,6 +730,17 @@ void ClosureSpecCloner::populateCloned() {
   }
 }
 
+/// Replace the extracts of the closure field of the struct argument with the
+/// "copy" of the closure.
+void ClosureSpecCloner::visitStructExtractInst(StructExtractInst *Inst) {
+  if (ClosureAggregateArg && Inst->getOperand() == ClosureAggregateArg &&
+      Inst->getFieldNo() == CallSiteDesc.getClosureFieldNo()) {
+    ValueMap.insert(std::make_pair(Inst, SILValue(FieldClosure)));
+    return;
+  }
+  SuperTy::visitStructExtractInst(Inst);
+}
+
 //===----------------------------------------------------------------------===//
 //                            Closure Specializer
 //===----------------------------------------------------------------------===//
@@ -701,6 +759,10 @@ public:
   void gatherCallSites(SILFunction *Caller,
                        llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
+  void gatherFieldCallSites(StructInst *SI, unsigned FieldNo,
+                            ClosureInfo *&CInfo,
+                            llvm::DenseSet<FullApplySite> &VisitedAI,
+                            llvm::DenseSet<FullApplySite> &MultipleClosureAI);
   bool specialize(SILFunction *Caller);
 
   ArrayRef<SILInstruction *> getPropagatedClosures() {
@@ -738,6 +800,12 @@ void ClosureSpecializer::gatherCallSites(
 
       // Go through all uses of our closure.
       for (auto *Use : II.getUses()) {
+        if (auto *SI = dyn_cast<StructInst>(Use->getUser())) {
+          gatherFieldCallSites(SI, Use->getOperandNumber(), CInfo, VisitedAI,
+                               MultipleClosureAI);
+          continue;
+        }
+
         // If this use is not an apply inst or an apply inst with
         // substitutions, there is nothing interesting for us to do, so
         // continue...
@@ -832,6 +900,104 @@ void ClosureSpecializer::gatherCallSites(
   }
 }
 
+/// Returns true if \p Arg of a callee has an extract of field \p FieldNo which
+/// is invoked, and if all extracts of the field are only invoked or retained
+/// and released.
+static bool isClosureFieldOnlyApplied(SILArgument *Arg, unsigned FieldNo) {
+  bool IsApplied = false;
+  for (auto *ArgUse : Arg->getUses()) {
+    auto *SEI = dyn_cast<StructExtractInst>(ArgUse->getUser());
+    if (!SEI || SEI->getFieldNo() != FieldNo)
+      continue;
+    for (auto *Op : SEI->getUses()) {
+      if (isa<RefCountingInst>(Op->getUser()))
+        continue;
+      auto UserAI = FullApplySite::isa(Op->getUser());
+      if (!UserAI || UserAI.getCallee() != SEI)
+        return false;
+      IsApplied = true;
+    }
+  }
+  return IsApplied;
+}
+
+/// Gather the call sites which are passed the closure as field \p FieldNo of
+/// the struct \p SI and invoke it.
+///
+/// We only handle applies in the block of the closure. Otherwise we would have
+/// to extend the lifetime of the captured arguments to cover the apply, and
+/// the lifetime frontier of the closure only reaches to the struct.
+void ClosureSpecializer::gatherFieldCallSites(
+    StructInst *SI, unsigned FieldNo, ClosureInfo *&CInfo,
+    llvm::DenseSet<FullApplySite> &VisitedAI,
+    llvm::DenseSet<FullApplySite> &MultipleClosureAI) {
+  auto *Closure = cast<SILInstruction>(SI->getOperand(FieldNo));
+
+  for (auto *Use : SI->getUses()) {
+    auto AI = FullApplySite::isa(Use->getUser());
+    if (!AI || AI.hasSubstitutions() ||
+        AI.getParent() != Closure->getParent())
+      continue;
+
+    // Find the index of the struct argument. The callee is not allowed to see
+    // the struct in any other argument.
+    Optional<unsigned> ClosureIndex;
+    bool IsPassedTwice = false;
+    for (unsigned i = 0, e = AI.getNumArguments(); i != e; ++i) {
+      if (AI.getArgument(i) != SILValue(SI))
+        continue;
+      IsPassedTwice |= ClosureIndex.hasValue();
+      ClosureIndex = i;
+    }
+    if (!ClosureIndex.hasValue() || IsPassedTwice)
+      continue;
+
+    if (!VisitedAI.insert(AI).second) {
+      MultipleClosureAI.insert(AI);
+      continue;
+    }
+
+    SILFunction *ApplyCallee = AI.getReferencedFunction();
+    if (!ApplyCallee || ApplyCallee->isExternalDeclaration())
+      continue;
+
+    DEBUG(llvm::dbgs() << "    Found callsite with closure in field " << FieldNo
+          << " of argument " << ClosureIndex.getValue() << ": "
+          << *AI.getInstruction());
+
+    // Make sure that the closure is only invoked in the callee, so that the
+    // struct_extracts can be replaced by the copy of the closure.
+    SILArgument *Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
+    if (!isClosureFieldOnlyApplied(Arg, FieldNo))
+      continue;
+
+    auto NumIndirectResults = AI.getSubstCalleeType()->getNumIndirectResults();
+    assert(ClosureIndex.getValue() >= NumIndirectResults);
+    auto ParamInfo = AI.getSubstCalleeType()->getParameters();
+    SILParameterInfo ClosureParamInfo =
+      ParamInfo[ClosureIndex.getValue() - NumIndirectResults];
+
+    // The callee must not consume the struct. Otherwise it could consume the
+    // closure field with a release that we can't move to the copy of the
+    // closure.
+    llvm::TinyPtrVector<SILBasicBlock *> NonFailureExitBBs;
+    if (!ClosureParamInfo.isGuaranteed() ||
+        !findAllNonFailureExitBBs(ApplyCallee, NonFailureExitBBs))
+      continue;
+
+    if (!CInfo) {
+      CInfo = new ClosureInfo(Closure);
+      ValueLifetimeAnalysis VLA(CInfo->Closure);
+      VLA.computeFrontier(CInfo->LifetimeFrontier,
+                          ValueLifetimeAnalysis::AllowToModifyCFG);
+    }
+
+    CInfo->CallSites.push_back(
+      CallSiteDescriptor(CInfo, AI, ClosureIndex.getValue(), ClosureParamInfo,
+                         std::move(NonFailureExitBBs), FieldNo));
+  }
+}
+
 bool ClosureSpecializer::specialize(SILFunction *Caller) {
   DEBUG(llvm::dbgs() << "Optimizing callsites that take closure argument in "
                      << Caller->getName() << '\n');
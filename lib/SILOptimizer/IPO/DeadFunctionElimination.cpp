@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-dead-function-elimination"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/PatternMatch.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILVisitor.h"
@@ -24,6 +25,7 @@
 using namespace swift;
 
 STATISTIC(NumDeadFunc, "Number of dead functions eliminated");
+STATISTIC(NumDeadVTableEntries, "Number of dead vtable entries eliminated");
 STATISTIC(NumEliminatedExternalDefs, "Number of external function definitions eliminated");
 
 namespace {
@@ -362,11 +364,18 @@ class DeadFunctionElimination : FunctionLivenessComputation {
 
   /// Removes all dead methods from vtables and witness tables.
   void removeDeadEntriesFromTables() {
+    OptRemark::Emitter ORE(DEBUG_TYPE, *Module);
     for (SILVTable &vTable : Module->getVTableList()) {
-      vTable.removeEntries_if([this](SILVTable::Pair &entry) -> bool {
+      vTable.removeEntries_if([&](SILVTable::Pair &entry) -> bool {
         if (!isAlive(entry.second)) {
           DEBUG(llvm::dbgs() << "  erase dead vtable method " <<
                 entry.second->getName() << "\n");
+          ++NumDeadVTableEntries;
+          ORE.emitPassed("DeadVTableEntry", entry.second->getLocation(),
+                         *entry.second,
+                         Twine("removed the vtable entry of ") +
+                         vTable.getClass()->getName().str() + " for " +
+                         entry.second->getName() + ", which is never called");
           return true;
         }
         return false;
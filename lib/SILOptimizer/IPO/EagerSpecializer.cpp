@@ -21,7 +21,11 @@
 /// types specified in the attribute into the function's generic
 /// signature. Dispatch to each specialized function is implemented by inserting
 /// call at the beginning of the original generic function guarded by a type
-/// check.
+/// check. The checks are tried in the order the attributes are written, and
+/// the metatype of each generic parameter is only loaded once, so a function
+/// with several specializations tests each candidate with a single compare per
+/// parameter. Callers that cannot be specialized themselves, such as callers
+/// in other modules, reach the specializations through this dispatch.
 ///
 /// TODO: We have not determined whether to support inexact type checks. It
 /// will be a tradeoff between utility of the attribute vs. cost of the check.
@@ -214,62 +218,117 @@ static SILType getThickMetatypeType(CanType Ty) {
 }
 
 namespace {
-/// Helper class for emitting code to dispatch to a specialized function.
+/// Helper class for emitting code to dispatch to specialized functions.
+///
+/// The dispatch is a chain of type checks at the top of the original generic
+/// function, one link per specialization, ending in the original generic body.
 class EagerDispatch {
   SILFunction *GenericFunc;
-  const SILSpecializeAttr &SA;
-  const ReabstractionInfo &ReInfo;
 
   SILBuilder Builder;
   SILLocation Loc;
 
+  /// The number of dispatches that have not been emitted yet.
+  unsigned NumRemaining;
+
+  /// The block holding the original generic body, which is reached when no
+  /// specialization matches.
+  SILBasicBlock *GenericBodyBB = nullptr;
+
+  /// The unterminated block where the next specialization's type checks go.
+  SILBasicBlock *NextCheckBB = nullptr;
+
+  /// The thick metatype of each dependent type in the generic signature, as a
+  /// Builtin.Word. Null for dependent types that are not SubstitutableTypes.
+  SmallVector<SILValue, 4> GenericMTVals;
+
 public:
   // Instantiate a SILBuilder for inserting instructions at the top of the
-  // original generic function.
-  EagerDispatch(SILFunction *GenericFunc, const SILSpecializeAttr &SA,
-                const ReabstractionInfo &ReInfo)
-    : GenericFunc(GenericFunc), SA(SA), ReInfo(ReInfo), Builder(*GenericFunc),
-      Loc(GenericFunc->getLocation()) {
+  // original generic function, which will dispatch to \p NumDispatches
+  // specialized functions.
+  EagerDispatch(SILFunction *GenericFunc, unsigned NumDispatches)
+    : GenericFunc(GenericFunc), Builder(*GenericFunc),
+      Loc(GenericFunc->getLocation()), NumRemaining(NumDispatches) {
 
     Builder.setCurrentDebugScope(GenericFunc->getDebugScope());
   }
-  
-  void emitDispatchTo(SILFunction *NewFunc);
+
+  /// Adds a dispatch to \p NewFunc, checked after all the previously added
+  /// ones.
+  void emitDispatchTo(const SILSpecializeAttr &SA,
+                      const ReabstractionInfo &ReInfo, SILFunction *NewFunc);
 
 protected:
-  void emitTypeCheck(SILBasicBlock *FailedTypeCheckBB,
-                     SubstitutableType *ParamTy, Type SubTy);
+  void emitGenericMetatypes();
 
-  SILValue emitArgumentCast(SILArgument *OrigArg, unsigned Idx);
-  
-  SILValue emitArgumentConversion(SmallVectorImpl<SILValue> &CallArgs);
+  void emitTypeCheck(SILBasicBlock *FailedTypeCheckBB, SILValue GenericMTVal,
+                     Type SubTy);
+
+  SILValue emitArgumentCast(const ReabstractionInfo &ReInfo,
+                            SILArgument *OrigArg, unsigned Idx);
+
+  SILValue emitArgumentConversion(const ReabstractionInfo &ReInfo,
+                                  SmallVectorImpl<SILValue> &CallArgs);
 };
 }
 
+/// Splits the entry block so that the original body starts in GenericBodyBB,
+/// and loads the metatypes of the generic parameters in the entry block.
+void EagerDispatch::emitGenericMetatypes() {
+  auto &EntryBB = GenericFunc->front();
+  GenericBodyBB = EntryBB.splitBasicBlock(EntryBB.begin());
+  Builder.setInsertionPoint(&EntryBB);
+  NextCheckBB = &EntryBB;
+
+  auto &Ctx = Builder.getASTContext();
+  auto WordTy = SILType::getBuiltinWordType(Ctx);
+  auto GenericSig =
+    GenericFunc->getLoweredFunctionType()->getGenericSignature();
+  for (auto DepTy : GenericSig->getAllDependentTypes()) {
+    auto ParamTy = DepTy->getAs<SubstitutableType>();
+    if (!ParamTy) {
+      GenericMTVals.push_back(SILValue());
+      continue;
+    }
+    // Instantiate a thick metatype for T.Type
+    auto ContextTy = GenericFunc->mapTypeIntoContext(ParamTy);
+    auto GenericMT = Builder.createMetatype(
+      Loc, getThickMetatypeType(ContextTy->getCanonicalType()));
+    GenericMTVals.push_back(
+      Builder.createUncheckedBitwiseCast(Loc, GenericMT, WordTy));
+  }
+}
+
 /// Inserts type checks in the original generic function for dispatching to the
 /// given specialized function. Converts call arguments. Emits an invocation of
 /// the specialized function. Handle the return value.
-void EagerDispatch::emitDispatchTo(SILFunction *NewFunc) {
+void EagerDispatch::emitDispatchTo(const SILSpecializeAttr &SA,
+                                   const ReabstractionInfo &ReInfo,
+                                   SILFunction *NewFunc) {
 
   // 1. Emit a cascading sequence of type checks blocks.
 
-  // First split the entry BB, moving all instructions to the FailedTypeCheckBB.
-  auto &EntryBB = GenericFunc->front();
-  SILBasicBlock *FailedTypeCheckBB = EntryBB.splitBasicBlock(EntryBB.begin());
-  Builder.setInsertionPoint(&EntryBB, EntryBB.begin());
+  assert(NumRemaining && "More dispatches than expected.");
+  if (!NextCheckBB)
+    emitGenericMetatypes();
+
+  // If any check fails, try the next specialization, or fall back to the
+  // generic body after the last one.
+  SILBasicBlock *FailedTypeCheckBB =
+    --NumRemaining ? GenericFunc->createBasicBlock() : GenericBodyBB;
+  Builder.setInsertionPoint(NextCheckBB);
+  NextCheckBB = FailedTypeCheckBB;
 
   // Iterate over all dependent types in the generic signature, which will match
   // the specialized attribute's substitution list. Visit only
   // SubstitutableTypes, skipping DependentTypes.
-  auto GenericSig =
-    GenericFunc->getLoweredFunctionType()->getGenericSignature();
   auto SubIt = SA.getSubstitutions().begin();
   auto SubEnd = SA.getSubstitutions().end();
-  for (auto DepTy : GenericSig->getAllDependentTypes()) {
+  for (SILValue GenericMTVal : GenericMTVals) {
     assert(SubIt != SubEnd && "Not enough substitutions.");
-    
-    if (auto ParamTy = DepTy->getAs<SubstitutableType>())
-      emitTypeCheck(FailedTypeCheckBB, ParamTy, SubIt->getReplacement());
+
+    if (GenericMTVal)
+      emitTypeCheck(FailedTypeCheckBB, GenericMTVal, SubIt->getReplacement());
     ++SubIt;
   }
   assert(SubIt == SubEnd && "Too many substitutions.");
@@ -278,7 +337,7 @@ void EagerDispatch::emitDispatchTo(SILFunction *NewFunc) {
   // 2. Convert call arguments, casting and adjusting for calling convention.
 
   SmallVector<SILValue, 8> CallArgs;
-  SILValue StoreResultTo = emitArgumentConversion(CallArgs);
+  SILValue StoreResultTo = emitArgumentConversion(ReInfo, CallArgs);
 
   // 3. Emit an invocation of the specialized function.
 
@@ -319,30 +378,24 @@ void EagerDispatch::emitDispatchTo(SILFunction *NewFunc) {
 // Postcondition: Builder's insertion block is a new block that defines the
 // specialized call argument and has not been terminated.
 //
-// The type check is emitted in the current block as: 
-// metatype $@thick T.Type
-// %a = unchecked_bitwise_cast % to $Builtin.Int64
+// The type check is emitted in the current block as:
 // metatype $@thick <Specialized>.Type
 // %b = unchecked_bitwise_cast % to $Builtin.Int64
 // builtin "cmp_eq_Int64"(%a : $Builtin.Int64, %b : $Builtin.Int64)
 //   : $Builtin.Int1
 // cond_br %
+//
+// where %a is the generic parameter's metatype, loaded once in the entry
+// block by emitGenericMetatypes.
 void EagerDispatch::
-emitTypeCheck(SILBasicBlock *FailedTypeCheckBB, SubstitutableType *ParamTy,
+emitTypeCheck(SILBasicBlock *FailedTypeCheckBB, SILValue GenericMTVal,
               Type SubTy) {
-  // Instantiate a thick metatype for T.Type
-  auto ContextTy = GenericFunc->mapTypeIntoContext(ParamTy);
-  auto GenericMT = Builder.createMetatype(
-    Loc, getThickMetatypeType(ContextTy->getCanonicalType()));
-
   // Instantiate a thick metatype for <Specialized>.Type
   auto SpecializedMT = Builder.createMetatype(
     Loc, getThickMetatypeType(SubTy->getCanonicalType()));
 
   auto &Ctx = Builder.getASTContext();
   auto WordTy = SILType::getBuiltinWordType(Ctx);
-  auto GenericMTVal =
-    Builder.createUncheckedBitwiseCast(Loc, GenericMT, WordTy);
   auto SpecializedMTVal =
     Builder.createUncheckedBitwiseCast(Loc, SpecializedMT, WordTy);
 
@@ -357,7 +410,8 @@ emitTypeCheck(SILBasicBlock *FailedTypeCheckBB, SubstitutableType *ParamTy,
 }
 
 /// Cast a generic argument to its specialized type.
-SILValue EagerDispatch::emitArgumentCast(SILArgument *OrigArg, unsigned Idx) {
+SILValue EagerDispatch::emitArgumentCast(const ReabstractionInfo &ReInfo,
+                                         SILArgument *OrigArg, unsigned Idx) {
 
   auto CastTy = ReInfo.getSubstitutedType()->getSILArgumentType(Idx);
   assert(CastTy.isAddress() ==
@@ -378,7 +432,8 @@ SILValue EagerDispatch::emitArgumentCast(SILArgument *OrigArg, unsigned Idx) {
 /// Returns the SILValue to store the result into if the specialized function
 /// has a direct result.
 SILValue EagerDispatch::
-emitArgumentConversion(SmallVectorImpl<SILValue> &CallArgs) {
+emitArgumentConversion(const ReabstractionInfo &ReInfo,
+                       SmallVectorImpl<SILValue> &CallArgs) {
   auto OrigArgs = GenericFunc->getArguments();
   assert(OrigArgs.size() == ReInfo.getNumArguments() && "signature mismatch");
   
@@ -387,7 +442,7 @@ emitArgumentConversion(SmallVectorImpl<SILValue> &CallArgs) {
   for (auto *OrigArg : OrigArgs) {
     unsigned Idx = OrigArg->getIndex();
 
-    auto CastArg = emitArgumentCast(OrigArg, Idx);
+    auto CastArg = emitArgumentCast(ReInfo, OrigArg, Idx);
     DEBUG(dbgs() << "  Cast generic arg: "; CastArg->print(dbgs()));
 
     if (ReInfo.isArgConverted(OrigArg->getIndex())) {
@@ -480,13 +535,18 @@ void EagerSpecializerTransform::run() {
       SpecializedFuncs.push_back(NewFunc);
     }
 
-    // Emit a type check and dispatch to each specialized function.
+    // Emit a type check and dispatch to each specialized function, in the
+    // order the attributes were written.
+    unsigned NumDispatches =
+      std::count_if(SpecializedFuncs.begin(), SpecializedFuncs.end(),
+                    [](SILFunction *NewFunc) { return NewFunc != nullptr; });
+    EagerDispatch Dispatch(&F, NumDispatches);
     for_each3(F.getSpecializeAttrs(), SpecializedFuncs, ReInfoVec,
              [&](const SILSpecializeAttr *SA, SILFunction *NewFunc,
                  const ReabstractionInfo &ReInfo) {
       if (NewFunc) {
         Changed = true;
-        EagerDispatch(&F, *SA, ReInfo).emitDispatchTo(NewFunc);
+        Dispatch.emitDispatchTo(*SA, ReInfo, NewFunc);
       }
     });
     // As specializations are created, the attributes should be removed.
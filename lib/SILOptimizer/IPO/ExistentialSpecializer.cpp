@@ -0,0 +1,442 @@
+//===--- ExistentialSpecializer.cpp - Specialize existential arguments ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specialize functions which take protocol typed arguments for the concrete
+// types their callers pass them.
+//
+// A function which takes an argument of protocol type opens the existential
+// and calls the protocol requirements through witness_method, even if all of
+// its callers pass a value of the same concrete type. If the caller
+// initializes the existential right before the call, e.g.
+//
+//   %e = alloc_stack $P
+//   %a = init_existential_addr %e : $*P, $S
+//   store %x to %a : $*S
+//   apply %f(%e) : $@convention(thin) (@in P) -> ()
+//
+// then the callee is cloned and the clone re-wraps the argument in an
+// existential which is initialized with the concrete type in its entry block:
+//
+//   bb0(%0 : $*P):
+//     %1 = alloc_stack $P
+//     %2 = init_existential_addr %1 : $*P, $S
+//     %3 = open_existential_addr %0 : $*P to $*@opened("...") P
+//     %4 = unchecked_addr_cast %3 : $*@opened("...") P to $*S
+//     copy_addr [take] %4 to [initialization] %2 : $*S
+//     deinit_existential_addr %0 : $*P
+//     ... the original body, using %1 instead of %0 ...
+//
+// The signature of the clone is unchanged, so only the callee of the apply
+// is replaced. SILCombine then propagates the concrete type from the
+// init_existential into the witness_method instructions of the clone, which
+// can then be devirtualized and the callees specialized and inlined.
+//
+// Class existentials are re-wrapped with init_existential_ref, which costs
+// nothing at runtime. Opaque existentials are only handled when they are
+// passed @in, since the value can then be moved into the new existential.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "existential-specialize"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/Basic/Range.h"
+#include "swift/SIL/Mangle.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumExistentialArgsSpecialized,
+          "Number of existential arguments specialized for a concrete type");
+
+namespace {
+
+/// An argument of protocol type and the init_existential instruction which
+/// gives it its concrete type in the caller.
+struct ExistentialArgument {
+  unsigned ArgNo;
+  SILInstruction *InitExistential;
+};
+
+/// Specialize functions for the concrete types of their existential
+/// arguments.
+class ExistentialSpecializer : public SILModuleTransform {
+public:
+  void run() override;
+
+  StringRef getName() override { return "Existential Specializer"; }
+
+protected:
+  bool optimizeApply(FullApplySite Apply,
+                     llvm::SmallVectorImpl<SILFunction *> &Worklist);
+  SILFunction *specializeExistentialArgs(FullApplySite Apply,
+                                         SILFunction *OrigF,
+                                         ArrayRef<ExistentialArgument> Args,
+                                         bool &IsNew);
+};
+
+/// Clone a function, re-wrapping some of its existential arguments in
+/// existentials which are initialized with a known concrete type.
+class ExistentialSpecializerCloner
+  : public SILClonerWithScopes<ExistentialSpecializerCloner> {
+  using SuperTy = SILClonerWithScopes<ExistentialSpecializerCloner>;
+  friend class SILVisitor<ExistentialSpecializerCloner>;
+  friend class SILCloner<ExistentialSpecializerCloner>;
+
+  SILFunction *OrigF;
+  ArrayRef<ExistentialArgument> Args;
+
+  /// The stack locations of the re-wrapped opaque existentials.
+  llvm::SmallVector<AllocStackInst *, 4> AllocStacks;
+
+public:
+  ExistentialSpecializerCloner(SILFunction *OrigF, SILFunction *NewF,
+                               ArrayRef<ExistentialArgument> Args)
+    : SuperTy(*NewF), OrigF(OrigF), Args(Args) {}
+
+  void cloneBlocks();
+
+protected:
+  SILValue wrapConcreteValue(SILArgument *Arg,
+                             SILInstruction *InitExistential);
+};
+
+} // end anonymous namespace
+
+/// Create an existential which holds the value of the existential argument
+/// \p Arg, but is initialized with the concrete type of \p InitExistential.
+SILValue ExistentialSpecializerCloner::wrapConcreteValue(
+    SILArgument *Arg, SILInstruction *InitExistential) {
+  SILBuilder &B = getBuilder();
+  auto Loc = RegularLocation::getAutoGeneratedLocation();
+  auto OpenedType =
+    ArchetypeType::getOpened(Arg->getType().getSwiftRValueType());
+
+  if (auto *IER = dyn_cast<InitExistentialRefInst>(InitExistential)) {
+    auto *Open = B.createOpenExistentialRef(
+        Loc, Arg, SILType::getPrimitiveObjectType(OpenedType));
+    auto *Concrete = B.createUncheckedRefCast(Loc, Open,
+                                              IER->getOperand()->getType());
+    return B.createInitExistentialRef(Loc, Arg->getType(),
+                                      IER->getFormalConcreteType(), Concrete,
+                                      IER->getConformances());
+  }
+
+  // The argument is passed @in, so its value can be moved into the new
+  // existential, leaving only the buffer of the argument to deallocate.
+  auto *IEA = cast<InitExistentialAddrInst>(InitExistential);
+  auto *ASI = B.createAllocStack(Loc, Arg->getType().getObjectType());
+  AllocStacks.push_back(ASI);
+  auto *Buffer = B.createInitExistentialAddr(Loc, ASI,
+                                             IEA->getFormalConcreteType(),
+                                             IEA->getLoweredConcreteType(),
+                                             IEA->getConformances());
+  auto *Open = B.createOpenExistentialAddr(
+      Loc, Arg, SILType::getPrimitiveAddressType(OpenedType));
+  auto *Concrete = B.createUncheckedAddrCast(Loc, Open,
+                                             IEA->getLoweredConcreteType());
+  B.createCopyAddr(Loc, Concrete, Buffer, IsTake, IsInitialization);
+  B.createDeinitExistentialAddr(Loc, Arg);
+  return ASI;
+}
+
+/// Clone the original function into the specialized function, replacing the
+/// specialized arguments with the re-wrapped existentials.
+void ExistentialSpecializerCloner::cloneBlocks() {
+  SILFunction &CloneF = getBuilder().getFunction();
+  SILModule &M = CloneF.getModule();
+
+  // Create the entry basic block with the same arguments as the original.
+  SILBasicBlock *OrigEntryBB = &*OrigF->begin();
+  SILBasicBlock *ClonedEntryBB = new (M) SILBasicBlock(&CloneF);
+  for (auto *Arg : OrigEntryBB->getBBArgs()) {
+    SILValue MappedValue = new (M)
+        SILArgument(ClonedEntryBB, remapType(Arg->getType()), Arg->getDecl());
+    ValueMap.insert(std::make_pair(Arg, MappedValue));
+  }
+  BBMap.insert(std::make_pair(OrigEntryBB, ClonedEntryBB));
+
+  // Uses of the specialized arguments in the original body are mapped to the
+  // re-wrapped existentials.
+  getBuilder().setInsertionPoint(ClonedEntryBB);
+  for (auto &EA : Args) {
+    SILArgument *Arg = ClonedEntryBB->getBBArg(EA.ArgNo);
+    ValueMap[OrigEntryBB->getBBArg(EA.ArgNo)] =
+      wrapConcreteValue(Arg, EA.InitExistential);
+  }
+
+  // Recursively visit original BBs in depth-first preorder, starting with the
+  // entry block, cloning all instructions other than terminators.
+  visitSILBasicBlock(OrigEntryBB);
+
+  // Now iterate over the BBs and fix up the terminators.
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    getBuilder().setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+
+  if (AllocStacks.empty())
+    return;
+
+  // Deallocate the stack locations of the re-wrapped existentials on every
+  // path which leaves the function.
+  for (auto &BB : CloneF) {
+    TermInst *Term = BB.getTerminator();
+    if (!isa<ReturnInst>(Term) && !isa<ThrowInst>(Term))
+      continue;
+    SILBuilderWithScope Builder(Term);
+    for (auto *ASI : reversed(AllocStacks))
+      Builder.createDeallocStack(RegularLocation::getAutoGeneratedLocation(),
+                                 ASI);
+  }
+}
+
+/// Returns the init_existential_addr which initializes the stack location
+/// \p ASI, if it is the only instruction which could give the location a
+/// dynamic type before it is passed to \p Apply.
+static InitExistentialAddrInst *getStackInitExistential(AllocStackInst *ASI,
+                                                        FullApplySite Apply) {
+  InitExistentialAddrInst *SingleInit = nullptr;
+  for (auto *Use : ASI->getUses()) {
+    auto *User = Use->getUser();
+
+    // Ignore instructions which can not change the dynamic type.
+    if (isa<DeallocStackInst>(User) || isa<DebugValueAddrInst>(User) ||
+        isa<DestroyAddrInst>(User) || isa<OpenExistentialAddrInst>(User))
+      continue;
+    if (auto *CAI = dyn_cast<CopyAddrInst>(User)) {
+      if (CAI->getDest() == ASI)
+        return nullptr;
+      continue;
+    }
+    if (auto *IEA = dyn_cast<InitExistentialAddrInst>(User)) {
+      if (SingleInit)
+        return nullptr;
+      SingleInit = IEA;
+      continue;
+    }
+    if (FullApplySite AI = FullApplySite::isa(User)) {
+      // Ignore calls which only read or consume the existential.
+      auto Idx = Use->getOperandNumber() - ApplyInst::getArgumentOperandNumber();
+      auto Conv = AI.getArgumentConvention(Idx);
+      if (Conv != SILArgumentConvention::Indirect_In &&
+          Conv != SILArgumentConvention::Indirect_In_Guaranteed)
+        return nullptr;
+      continue;
+    }
+    // Bail if there is any unknown (and potentially writing) instruction.
+    return nullptr;
+  }
+  if (!SingleInit)
+    return nullptr;
+
+  // A very simple dominance check. As ASI is an operand of Apply, SingleInit
+  // dominates Apply if it is in the same block as ASI or Apply.
+  SILBasicBlock *BB = SingleInit->getParent();
+  if (BB != ASI->getParent() && BB != Apply.getParent())
+    return nullptr;
+  return SingleInit;
+}
+
+/// Returns the init_existential which gives the argument \p ArgNo of \p Apply
+/// its concrete type, if the argument can be specialized for it.
+static SILInstruction *getConcreteInitExistential(FullApplySite Apply,
+                                                  unsigned ArgNo) {
+  SILValue Arg = Apply.getArgument(ArgNo);
+  SILModule &M = Apply.getModule();
+
+  SILInstruction *IE = nullptr;
+  CanType ConcreteType;
+  if (auto *IER = dyn_cast<InitExistentialRefInst>(Arg)) {
+    IE = IER;
+    ConcreteType = IER->getFormalConcreteType();
+  } else if (auto *ASI = dyn_cast<AllocStackInst>(Arg)) {
+    if (Apply.getArgumentConvention(ArgNo) != SILArgumentConvention::Indirect_In)
+      return nullptr;
+    if (Arg->getType().getPreferredExistentialRepresentation(M) !=
+          ExistentialRepresentation::Opaque)
+      return nullptr;
+    auto *IEA = getStackInitExistential(ASI, Apply);
+    if (!IEA)
+      return nullptr;
+    IE = IEA;
+    ConcreteType = IEA->getFormalConcreteType();
+  } else {
+    return nullptr;
+  }
+
+  // The specialization isn't generic, so it can't refer to the archetypes of
+  // the caller.
+  if (ConcreteType->hasArchetype())
+    return nullptr;
+  return IE;
+}
+
+/// For now, we only specialize if the callee opens the existential, which
+/// means the concrete type can be propagated into a witness_method.
+static bool isProfitable(SILFunction *Callee, unsigned ArgNo) {
+  SILArgument *Arg = Callee->begin()->getBBArg(ArgNo);
+  for (auto *Use : Arg->getUses()) {
+    auto *User = Use->getUser();
+    if (isa<OpenExistentialAddrInst>(User) ||
+        isa<OpenExistentialRefInst>(User))
+      return true;
+  }
+  return false;
+}
+
+static std::string getClonedName(SILFunction *F, IsFragile_t Fragile,
+                                 ArrayRef<ExistentialArgument> Args) {
+  Mangle::Mangler M;
+  auto P = SpecializationPass::ExistentialSpecializer;
+  FunctionSignatureSpecializationMangler Mangler(P, M, Fragile, F);
+  for (auto &EA : Args)
+    Mangler.setArgumentExistentialToConcrete(EA.ArgNo, EA.InitExistential);
+  Mangler.mangle();
+  return M.finalize();
+}
+
+/// Create the specialization of \p OrigF for the concrete types of \p Args,
+/// or return the existing one.
+SILFunction *ExistentialSpecializer::specializeExistentialArgs(
+    FullApplySite Apply, SILFunction *OrigF,
+    ArrayRef<ExistentialArgument> Args, bool &IsNew) {
+  IsFragile_t Fragile = IsNotFragile;
+  if (Apply.getFunction()->isFragile() && OrigF->isFragile())
+    Fragile = IsFragile;
+
+  std::string Name = getClonedName(OrigF, Fragile, Args);
+
+  // See if we already have a version of this function in the module. If so,
+  // just return it.
+  IsNew = false;
+  if (auto *NewF = getModule()->lookUpFunction(Name)) {
+    assert(NewF->isFragile() == Fragile);
+    DEBUG(llvm::dbgs()
+              << "  Found an already specialized version of the callee: ";
+          NewF->printName(llvm::dbgs()); llvm::dbgs() << "\n");
+    return NewF;
+  }
+
+  IsNew = true;
+  SILFunction *NewF = getModule()->createFunction(
+      SILLinkage::Shared, Name, OrigF->getLoweredFunctionType(),
+      /*contextGenericParams*/ nullptr, OrigF->getLocation(), OrigF->isBare(),
+      OrigF->isTransparent(), Fragile, OrigF->isThunk(),
+      OrigF->getClassVisibility(), OrigF->getInlineStrategy(),
+      OrigF->getEffectsKind(),
+      /*InsertBefore*/ OrigF, OrigF->getDebugScope(), OrigF->getDeclContext());
+  NewF->setDeclCtx(OrigF->getDeclContext());
+  DEBUG(llvm::dbgs() << "  Specialize callee as ";
+        NewF->printName(llvm::dbgs()); llvm::dbgs() << "\n");
+
+  ExistentialSpecializerCloner Cloner(OrigF, NewF, Args);
+  Cloner.cloneBlocks();
+  return NewF;
+}
+
+bool ExistentialSpecializer::optimizeApply(
+    FullApplySite Apply, llvm::SmallVectorImpl<SILFunction *> &Worklist) {
+  // Generic callees are handled by the generic specializer.
+  if (Apply.hasSubstitutions())
+    return false;
+
+  auto *FRI = dyn_cast<FunctionRefInst>(Apply.getCallee());
+  if (!FRI)
+    return false;
+  SILFunction *Callee = FRI->getReferencedFunction();
+  if (Callee->isExternalDeclaration() || !Callee->shouldOptimize() ||
+      Callee->getLoweredFunctionType()->isPolymorphic())
+    return false;
+
+  // A fragile caller can't refer to a specialization of a callee which isn't.
+  SILFunction *Caller = Apply.getFunction();
+  if (Caller->isFragile() && !Callee->isFragile())
+    return false;
+
+  llvm::SmallVector<ExistentialArgument, 4> Args;
+  for (unsigned i = 0, e = Apply.getNumArguments(); i != e; ++i) {
+    if (!Apply.getArgument(i)->getType().isExistentialType())
+      continue;
+    SILInstruction *IE = getConcreteInitExistential(Apply, i);
+    if (!IE || !isProfitable(Callee, i))
+      continue;
+    Args.push_back({i, IE});
+  }
+  if (Args.empty())
+    return false;
+
+  DEBUG(llvm::dbgs() << "Specializing existential arguments of:\n"
+        << "  " << Callee->getName() << "\n" << *Apply.getInstruction());
+  NumExistentialArgsSpecialized += Args.size();
+  bool IsNew;
+  SILFunction *NewF = specializeExistentialArgs(Apply, Callee, Args, IsNew);
+  if (IsNew)
+    Worklist.push_back(NewF);
+
+  // The specialization has the same signature, so only the callee changes.
+  SILBuilderWithScope Builder(Apply.getInstruction());
+  auto *NewFRI = Builder.createFunctionRef(Apply.getLoc(), NewF);
+  Apply.getInstruction()->setOperand(0, NewFRI);
+  if (FRI->use_empty())
+    FRI->eraseFromParent();
+  DEBUG(llvm::dbgs() << "  Rewrote caller:\n" << *Apply.getInstruction());
+  return true;
+}
+
+void ExistentialSpecializer::run() {
+  DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
+  bool HasChanged = false;
+
+  // Specializations are optimized after the functions that exist now, as the
+  // concrete types can be propagated through them into their own callees.
+  llvm::SmallVector<SILFunction *, 32> Worklist;
+  for (auto &F : *getModule())
+    Worklist.push_back(&F);
+
+  for (unsigned Idx = 0; Idx != Worklist.size(); ++Idx) {
+    SILFunction *F = Worklist[Idx];
+
+    // Don't optimize functions that are marked with the opt.never attribute.
+    if (!F->shouldOptimize())
+      continue;
+
+    // Cache cold blocks per function.
+    ColdBlockInfo ColdBlocks(DA);
+    for (auto &BB : *F) {
+      if (ColdBlocks.isCold(&BB))
+        continue;
+
+      auto I = BB.begin();
+      while (I != BB.end()) {
+        SILInstruction *Inst = &*I;
+        ++I;
+        if (FullApplySite Apply = FullApplySite::isa(Inst))
+          HasChanged |= optimizeApply(Apply, Worklist);
+      }
+    }
+  }
+
+  if (HasChanged) {
+    invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+  }
+}
+
+SILTransform *swift::createExistentialSpecializer() {
+  return new ExistentialSpecializer();
+}
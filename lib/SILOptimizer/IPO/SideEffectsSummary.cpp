@@ -0,0 +1,87 @@
+//===--- SideEffectsSummary.cpp - Record effects for serialization --------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Clients of a module see most of its functions only as declarations, for
+// which side-effect analysis has to assume the worst. This pass condenses
+// what side-effect analysis knows about each fragile function defined in
+// the module into an EffectsKind, which is serialized with the function and
+// consulted by side-effect analysis in clients.
+//
+// Only fragile functions are summarized: their bodies are part of the
+// module's interface, so the summary can't be invalidated by a new version
+// of the module.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "side-effects-summary"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+
+using namespace swift;
+
+STATISTIC(NumReadNone, "Number of functions summarized as readnone");
+STATISTIC(NumReadOnly, "Number of functions summarized as readonly");
+
+/// Returns the strongest EffectsKind that is implied by \p FE, in the sense
+/// in which SideEffectAnalysis interprets @effects attributes.
+static EffectsKind
+getEffectsKind(const SideEffectAnalysis::FunctionEffects &FE) {
+  if (FE.mayAllocObjects() || FE.mayTrap() || FE.mayReadRC())
+    return EffectsKind::Unspecified;
+
+  bool Reads = false;
+  auto isReadOnly = [&](const SideEffectAnalysis::Effects &E) {
+    Reads |= E.mayRead();
+    return !E.mayWrite() && !E.mayRetain() && !E.mayRelease();
+  };
+  if (!isReadOnly(FE.getGlobalEffects()))
+    return EffectsKind::Unspecified;
+  for (const auto &E : FE.getParameterEffects())
+    if (!isReadOnly(E))
+      return EffectsKind::Unspecified;
+
+  return Reads ? EffectsKind::ReadOnly : EffectsKind::ReadNone;
+}
+
+namespace {
+
+class SideEffectsSummary : public SILModuleTransform {
+  void run() override {
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+
+    for (auto &F : *getModule()) {
+      if (!F.isDefinition() || !F.isFragile() ||
+          isAvailableExternally(F.getLinkage()) || F.hasEffectsKind())
+        continue;
+
+      EffectsKind Kind = getEffectsKind(SEA->getEffects(&F));
+      F.setInferredEffectsKind(Kind);
+
+      if (Kind == EffectsKind::ReadNone)
+        ++NumReadNone;
+      else if (Kind == EffectsKind::ReadOnly)
+        ++NumReadOnly;
+    }
+  }
+
+  StringRef getName() override { return "Side Effects Summary"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createSideEffectsSummary() {
+  return new SideEffectsSummary();
+}
@@ -707,21 +707,23 @@ static SILValue getSub(SILLocation Loc, SILValue Val, unsigned SubVal,
   return B.createTupleExtract(Loc, AI, 0);
 }
 
-/// A canonical induction variable incremented by one from Start to End-1.
+/// A canonical induction variable incremented by a positive constant Step from
+/// Start to End-Step.
 struct InductionInfo {
   SILArgument *HeaderVal;
   BuiltinInst *Inc;
   SILValue Start;
   SILValue End;
+  unsigned Step;
   BuiltinValueKind Cmp;
   bool IsOverflowCheckInserted;
 
   InductionInfo()
-      : Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
+      : Step(1), Cmp(BuiltinValueKind::None), IsOverflowCheckInserted(false) {}
 
   InductionInfo(SILArgument *HV, BuiltinInst *I, SILValue S, SILValue E,
-                BuiltinValueKind C, bool IsOverflowChecked = false)
-      : HeaderVal(HV), Inc(I), Start(S), End(E), Cmp(C),
+                unsigned St, BuiltinValueKind C, bool IsOverflowChecked = false)
+      : HeaderVal(HV), Inc(I), Start(S), End(E), Step(St), Cmp(C),
         IsOverflowCheckInserted(IsOverflowChecked) {}
 
   bool isValid() { return Start && End; }
@@ -734,13 +736,15 @@ struct InductionInfo {
   }
 
   SILValue getLastValue(SILLocation &Loc, SILBuilder &B) {
-    return getSub(Loc, End, 1, B);
+    return getSub(Loc, End, Step, B);
   }
 
   /// If necessary insert an overflow for this induction variable.
   /// If we compare for equality we need to make sure that the range does wrap.
   /// We would have trapped either when overflowing or when accessing an array
   /// out of bounds in the original loop.
+  /// For a Step other than one we also need End-Start to be a multiple of Step,
+  /// otherwise the loop steps over End and only stops when it overflows.
   /// Returns true if an overflow check was inserted.
   bool checkOverflow(SILBuilder &Builder) {
     if (IsOverflowCheckInserted || Cmp != BuiltinValueKind::ICMP_EQ)
@@ -751,6 +755,8 @@ struct InductionInfo {
     auto *CmpSGE = Builder.createBuiltinBinaryFunction(
         Loc, "cmp_sge", Start->getType(), ResultTy, {Start, End});
     Builder.createCondFail(Loc, CmpSGE);
+    if (Step != 1)
+      checkStepDividesRange(Builder);
     IsOverflowCheckInserted = true;
 
     // We can now remove the cond fail on the increment the above comparison
@@ -760,12 +766,33 @@ struct InductionInfo {
       CondFail->eraseFromParent();
     return true;
   }
+
+private:
+  /// Insert a check that (End - Start) % Step == 0.
+  void checkStepDividesRange(SILBuilder &Builder) {
+    auto Loc = Inc->getLoc();
+    auto Ty = Start->getType();
+    auto BoolTy = SILType::getBuiltinIntegerType(1, Builder.getASTContext());
+    SILValue SubArgs[] = {End, Start,
+                          Builder.createIntegerLiteral(Loc, BoolTy, -1)};
+    auto *Sub = Builder.createBuiltinBinaryFunctionWithOverflow(
+        Loc, "ssub_with_overflow", SubArgs);
+    Builder.createCondFail(Loc, Builder.createTupleExtract(Loc, Sub, 1));
+    SILValue Distance = Builder.createTupleExtract(Loc, Sub, 0);
+    SILValue StepVal = Builder.createIntegerLiteral(Loc, Ty, Step);
+    auto *Rem = Builder.createBuiltinBinaryFunction(Loc, "srem", Ty, Ty,
+                                                    {Distance, StepVal});
+    SILValue Zero = Builder.createIntegerLiteral(Loc, Ty, 0);
+    auto *CmpNE = Builder.createBuiltinBinaryFunction(Loc, "cmp_ne", Ty,
+                                                      BoolTy, {Rem, Zero});
+    Builder.createCondFail(Loc, CmpNE);
+  }
 };
 
 /// Analyse canonical induction variables in a loop to find their start and end
 /// values.
 /// At the moment we only handle very simple induction variables that increment
-/// by one and use equality comparison.
+/// by a positive constant and use equality comparison.
 class InductionAnalysis {
   using InductionInfoMap = llvm::DenseMap<SILArgument *, InductionInfo *>;
 
@@ -823,8 +850,13 @@ private:
   /// Analyse one potential induction variable starting at Arg.
   InductionInfo *analyseIndVar(SILArgument *HeaderVal, BuiltinInst *Inc,
                                IntegerLiteralInst *IncVal) {
-    if (IncVal->getValue() != 1)
+    // Accept constant strides, as produced by e.g. stride(from:to:by:) once
+    // the exit condition is canonicalized. Restrict the step so that
+    // End - Step can be formed as an integer literal.
+    const APInt &IncAmount = IncVal->getValue();
+    if (!IncAmount.isStrictlyPositive() || IncAmount.getActiveBits() > 16)
       return nullptr;
+    unsigned Step = IncAmount.getZExtValue();
 
     // Find the start value.
     auto *PreheaderTerm = dyn_cast<BranchInst>(Preheader->getTerminator());
@@ -867,14 +899,19 @@ private:
 
     // Check whether the addition is overflow checked by a cond_fail or whether
     // code in the preheader's predecessor ensures that we won't overflow.
+    // A range check does not tell us that a larger step hits End exactly, so
+    // for those we rely on the overflow check (see checkOverflow).
     bool IsRangeChecked = false;
     if (!isOverflowChecked(Inc)) {
+      if (Step != 1)
+        return nullptr;
       IsRangeChecked = isRangeChecked(Start, End, Preheader, DT);
       if (!IsRangeChecked)
         return nullptr;
     }
-    return new (Allocator.Allocate()) InductionInfo(
-        HeaderVal, Inc, Start, End, BuiltinValueKind::ICMP_EQ, IsRangeChecked);
+    return new (Allocator.Allocate())
+        InductionInfo(HeaderVal, Inc, Start, End, Step,
+                      BuiltinValueKind::ICMP_EQ, IsRangeChecked);
   }
 };
 
@@ -921,7 +958,12 @@ public:
   }
 
   /// Returns true if the loop iterates from 0 until count of \p Array.
+  ///
+  /// With a step other than one the loop only stops at count if the step
+  /// divides it, which is established by the hoisted overflow check.
   bool isZeroToCount(SILValue Array) {
+    if (Ind->Step != 1 && !Ind->IsOverflowCheckInserted)
+      return false;
     return getZeroToCountArray(Ind->Start, Ind->End) == Array;
   }
 
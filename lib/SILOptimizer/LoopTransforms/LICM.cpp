@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-licm"
 
 #include "swift/SIL/Dominance.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
@@ -378,6 +379,110 @@ static bool sinkFixLifetime(SILLoop *Loop, DominanceInfo *DomTree,
   return Changed;
 }
 
+/// Returns true if no instruction in the range [\p Start, \p End) may decrement
+/// or check the reference count of \p Ptr.
+static bool isRefCountNeutralRange(SILBasicBlock::iterator Start,
+                                   SILBasicBlock::iterator End, SILValue Ptr,
+                                   AliasAnalysis *AA) {
+  return std::none_of(Start, End, [&](SILInstruction &I) {
+    return mayDecrementRefCount(&I, Ptr, AA) || mayCheckRefCount(&I);
+  });
+}
+
+/// Returns the release of \p Retain's operand in \p BB after \p Start.
+static SILInstruction *findMatchingRelease(SILInstruction *Retain,
+                                           SILBasicBlock::iterator Start,
+                                           SILBasicBlock *BB) {
+  for (auto &I : llvm::make_range(Start, BB->end())) {
+    if (isa<StrongRetainInst>(Retain) && isa<StrongReleaseInst>(&I) &&
+        I.getOperand(0) == Retain->getOperand(0))
+      return &I;
+    if (isa<RetainValueInst>(Retain) && isa<ReleaseValueInst>(&I) &&
+        I.getOperand(0) == Retain->getOperand(0))
+      return &I;
+  }
+  return nullptr;
+}
+
+/// Hoist a retain at the start of each iteration and the matching release at
+/// the end of the iteration of a loop invariant value out of the loop.
+///
+///   preheader:                      preheader:
+///     br header                       strong_retain %x
+///   header:                           br header
+///     strong_retain %x              header:
+///     ...                     =>      ...
+///     strong_release %x               cond_br %c, exit, header
+///     cond_br %c, exit, header      exit:
+///   exit:                             strong_release %x
+///
+/// This is legal if nothing can decrement or check the reference count of %x
+/// between the release and the retain of the next iteration. There, the
+/// reference count of %x is now higher by one. Everywhere else in the loop it
+/// is the same. As we process loops bottom up, the retain and release get
+/// another chance to be hoisted out of the parent loops afterwards.
+static bool hoistRetainReleasePairs(SILLoop *Loop, AliasAnalysis *AA,
+                                    DominanceInfo *DomTree, SILLoopInfo *LI) {
+  auto *Preheader = Loop->getLoopPreheader();
+  auto *Header = Loop->getHeader();
+  auto *Latch = Loop->getLoopLatch();
+  auto *ExitingBB = Loop->getExitingBlock();
+  auto *ExitBB = Loop->getExitBlock();
+  if (!Preheader || !Latch || !ExitingBB || !ExitBB)
+    return false;
+
+  // Every iteration must pass through the exiting block, either directly
+  // before the backedge or before a split backedge.
+  if (Latch != ExitingBB && Latch->getSinglePredecessor() != ExitingBB)
+    return false;
+
+  bool Changed = false;
+  for (auto It = Header->begin(), E = Header->end(); It != E;) {
+    SILInstruction *Retain = &*It++;
+    if (!isa<StrongRetainInst>(Retain) && !isa<RetainValueInst>(Retain))
+      continue;
+    SILValue Ptr = Retain->getOperand(0);
+    if (!hasLoopInvariantOperands(Retain, Loop))
+      continue;
+
+    auto ReleaseSearchStart = ExitingBB == Header ? It : ExitingBB->begin();
+    auto *Release = findMatchingRelease(Retain, ReleaseSearchStart, ExitingBB);
+    if (!Release)
+      continue;
+
+    // Check the range from the release to the retain of the next iteration.
+    auto AfterRelease = std::next(SILBasicBlock::iterator(Release));
+    if (!isRefCountNeutralRange(Header->begin(),
+                                SILBasicBlock::iterator(Retain), Ptr, AA) ||
+        !isRefCountNeutralRange(AfterRelease, ExitingBB->end(), Ptr, AA) ||
+        (Latch != ExitingBB &&
+         !isRefCountNeutralRange(Latch->begin(), Latch->end(), Ptr, AA)))
+      continue;
+
+    // Find or create a block on the exit edge for the release.
+    auto Succs = ExitingBB->getSuccessors();
+    unsigned EdgeIdx = 0;
+    for (unsigned Idx = 0, NumSuccs = Succs.size(); Idx != NumSuccs; ++Idx) {
+      SILBasicBlock *Succ = Succs[Idx];
+      if (Succ == ExitBB)
+        EdgeIdx = Idx;
+    }
+    auto *SplitBB = splitCriticalEdge(ExitingBB->getTerminator(), EdgeIdx,
+                                      DomTree, LI);
+    if (SplitBB)
+      ExitBB = SplitBB;
+
+    DEBUG(llvm::dbgs() << "  hoisting retain/release pair " << *Retain
+                       << "    and " << *Release);
+    if (It == SILBasicBlock::iterator(Release))
+      ++It;
+    Retain->moveBefore(Preheader->getTerminator());
+    Release->moveBefore(&*ExitBB->begin());
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
 /// \brief Summary of may writes occurring in the loop tree rooted at \p
 /// Loop. This includes all writes of the sub loops and the loop itself.
@@ -529,6 +634,7 @@ void LoopTreeOptimization::optimizeLoop(SILLoop *CurrentLoop,
   Changed |= hoistInstructions(CurrentLoop, DomTree, SafeReads,
                                RunsOnHighLevelSil);
   Changed |= sinkFixLifetime(CurrentLoop, DomTree, LoopInfo);
+  Changed |= hoistRetainReleasePairs(CurrentLoop, AA, DomTree, LoopInfo);
 }
 
 namespace {
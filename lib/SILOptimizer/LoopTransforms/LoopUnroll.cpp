@@ -30,6 +30,9 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The maximum number of copies of the loop body in a partially unrolled loop.
+static const unsigned SILLoopPartialUnrollMaxFactor = 8;
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -121,6 +124,10 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
   if (!CondBr)
     return None;
 
+  // The loop must be exited if the exit condition is true.
+  if (Loop->contains(CondBr->getTrueBB()))
+    return None;
+
   // Match an add 1 recurrence.
   SILArgument *RecArg;
   IntegerLiteralInst *End;
@@ -162,6 +169,21 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
   return Dist.getZExtValue();
 }
 
+/// Return the cost of the instructions in one iteration of the loop, or None if
+/// we can't duplicate the instructions in the loop.
+static Optional<uint64_t> getLoopIterationCost(SILLoop *Loop) {
+  uint64_t Cost = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return None;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+    }
+  }
+  return Cost;
+}
+
 /// Check whether we can duplicate the instructions in the loop and use a
 /// heuristic that looks at the trip count and the cost of the instructions in
 /// the loop to determine whether we should unroll this loop.
@@ -171,18 +193,29 @@ static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
     return false;
 
   // We can unroll a loop if we can duplicate the instructions it holds.
-  uint64_t Cost = 0;
-  for (auto *BB : Loop->getBlocks()) {
-    for (auto &Inst : *BB) {
-      if (!Loop->canDuplicate(&Inst))
-        return false;
-      if (instructionInlineCost(Inst) != InlineCost::Free)
-        ++Cost;
-      if (Cost * TripCount > SILLoopUnrollThreshold)
-        return false;
-  }
+  Optional<uint64_t> Cost = getLoopIterationCost(Loop);
+  return Cost && Cost.getValue() * TripCount <= SILLoopUnrollThreshold;
+}
+
+/// Determine the number of copies of the loop body for a loop which is too
+/// large to unroll fully. Returns 1 if the loop should not be partially
+/// unrolled.
+///
+/// We only pick factors which divide the trip count. Then only the exit check
+/// of the last copy can be taken, and the exit checks of the other copies can
+/// be removed without generating a remainder loop.
+static unsigned getPartialUnrollFactor(SILLoop *Loop, uint64_t TripCount) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+  Optional<uint64_t> Cost = getLoopIterationCost(Loop);
+  if (!Cost)
+    return 1;
+
+  for (unsigned Factor = SILLoopPartialUnrollMaxFactor; Factor > 1; --Factor) {
+    if (Factor < TripCount && TripCount % Factor == 0 &&
+        Cost.getValue() * Factor <= SILLoopUnrollThreshold)
+      return Factor;
   }
-  return true;
+  return 1;
 }
 
 /// Redirect the terminator of the current loop iteration's latch to the next
@@ -263,6 +296,59 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
   CondBr->eraseFromParent();
 }
 
+/// Redirect the terminator of the latch of a copy of the loop body in a
+/// partially unrolled loop to the header of the next copy. If \p KeepExit is
+/// false the exit check of the copy can't be taken and is removed.
+static void redirectPartialTerminator(SILBasicBlock *Latch,
+                                      SILBasicBlock *CurrentHeader,
+                                      SILBasicBlock *NextHeader,
+                                      bool KeepExit) {
+  auto *CurrentTerminator = Latch->getTerminator();
+
+  // Handle the split backedge case.
+  if (auto *Br = dyn_cast<BranchInst>(CurrentTerminator)) {
+    if (!KeepExit) {
+      auto *CondBr =
+          cast<CondBranchInst>(Latch->getSinglePredecessor()->getTerminator());
+      if (CondBr->getTrueBB() == Latch)
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getTrueArgs());
+      else
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getFalseArgs());
+      CondBr->eraseFromParent();
+    }
+    SILBuilder(Br).createBranch(Br->getLoc(), NextHeader, Br->getArgs());
+    Br->eraseFromParent();
+    return;
+  }
+
+  // Otherwise, we have a conditional branch to the header.
+  auto *CondBr = cast<CondBranchInst>(CurrentTerminator);
+  bool HeaderIsTrueBB = CondBr->getTrueBB() == CurrentHeader;
+  if (!KeepExit) {
+    if (HeaderIsTrueBB)
+      SILBuilder(CondBr).createBranch(CondBr->getLoc(), NextHeader,
+                                      CondBr->getTrueArgs());
+    else
+      SILBuilder(CondBr).createBranch(CondBr->getLoc(), NextHeader,
+                                      CondBr->getFalseArgs());
+    CondBr->eraseFromParent();
+    return;
+  }
+
+  if (HeaderIsTrueBB) {
+    SILBuilder(CondBr).createCondBranch(
+        CondBr->getLoc(), CondBr->getCondition(), NextHeader,
+        CondBr->getTrueArgs(), CondBr->getFalseBB(), CondBr->getFalseArgs());
+  } else {
+    SILBuilder(CondBr).createCondBranch(
+        CondBr->getLoc(), CondBr->getCondition(), CondBr->getTrueBB(),
+        CondBr->getTrueArgs(), NextHeader, CondBr->getFalseArgs());
+  }
+  CondBr->eraseFromParent();
+}
+
 /// Collect all the loop live out values in the map that maps original live out
 /// value to live out value in the cloned loop.
 static void collectLoopLiveOutValues(
@@ -325,7 +411,8 @@ updateSSA(SILLoop *Loop,
 }
 
 /// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
+/// count lis below a threshold. Otherwise, try to partially unroll the loop by
+/// a factor of the trip count.
 static bool tryToUnrollLoop(SILLoop *Loop) {
   assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
 
@@ -344,8 +431,14 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   if (!MaxTripCount)
     return false;
 
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
-    return false;
+  // The number of copies of the loop body, including the original one.
+  uint64_t UnrollFactor = MaxTripCount.getValue();
+  bool IsFullUnroll = canAndShouldUnrollLoop(Loop, UnrollFactor);
+  if (!IsFullUnroll) {
+    UnrollFactor = getPartialUnrollFactor(Loop, MaxTripCount.getValue());
+    if (UnrollFactor == 1)
+      return false;
+  }
 
   // TODO: We need to split edges from non-condbr exits for the SSA updater. For
   // now just don't handle loops containing such exits.
@@ -355,8 +448,9 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     if (!isa<CondBranchInst>(Exit->getTerminator()))
       return false;
 
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
+  DEBUG(llvm::dbgs() << (IsFullUnroll ? "Unrolling" : "Partially unrolling")
+                     << " loop in " << Header->getParent()->getName() << " by "
+                     << UnrollFactor << " " << *Loop << "\n");
 
   SmallVector<SILBasicBlock *, 16> Headers;
   Headers.push_back(Header);
@@ -366,8 +460,8 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
 
   DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
 
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+  // Copy the body UnrollFactor-1 times.
+  for (uint64_t Cnt = 1; Cnt < UnrollFactor; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -404,6 +498,17 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     auto *CurrentLatch = Latches[Iteration];
     auto LastIteration = End - 1;
     auto *OriginalHeader = Headers[0];
+
+    // In a partially unrolled loop the last copy branches back to the
+    // original header, and only its exit check can be taken.
+    if (!IsFullUnroll) {
+      bool IsLast = Iteration == LastIteration;
+      redirectPartialTerminator(
+          CurrentLatch, Headers[Iteration],
+          IsLast ? OriginalHeader : Headers[Iteration + 1], IsLast);
+      continue;
+    }
+
     auto *NextIterationsHeader =
         Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
 
@@ -12,7 +12,9 @@
 
 #define DEBUG_TYPE "sil-passmanager"
 
+#include "swift/AST/ASTContext.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
@@ -23,14 +25,22 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/TimeValue.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/GraphWriter.h"
 
 using namespace swift;
 
 STATISTIC(NumOptzIterations, "Number of optimization iterations");
+STATISTIC(NumAllocBoxToStackSkipped,
+          "Number of functions skipped by AllocBoxToStack");
+STATISTIC(NumDefiniteInitSkipped,
+          "Number of functions skipped by DefiniteInitialization");
+STATISTIC(NumPredictableMemOptSkipped,
+          "Number of functions skipped by PredictableMemoryOptimizations");
 
 llvm::cl::opt<bool> SILPrintAll(
     "sil-print-all", llvm::cl::init(false),
@@ -90,10 +100,44 @@ llvm::cl::list<std::string>
                      llvm::cl::desc("Disable passes "
                                     "which contain a string from this list"));
 
+llvm::cl::opt<bool> SILPrintAnalysisStats(
+    "sil-print-analysis-stats", llvm::cl::init(false),
+    llvm::cl::desc("Print how often each analysis was computed and "
+                   "invalidated"));
+
+llvm::cl::opt<unsigned> SILExpensivePassSizeLimit(
+    "sil-expensive-pass-size-limit", llvm::cl::init(UINT_MAX),
+    llvm::cl::desc("Skip expensive passes (RLE, DSE, LICM, ARC loop opts) "
+                   "on functions with more than <N> instructions"));
+
+llvm::cl::opt<unsigned> SILFunctionTimeBudget(
+    "sil-function-time-budget", llvm::cl::init(0),
+    llvm::cl::desc("Stop running function passes on a function after <N> ms "
+                   "were spent optimizing it (0 means no budget)"));
+
+llvm::cl::opt<unsigned> SILModuleTimeBudget(
+    "sil-module-time-budget", llvm::cl::init(0),
+    llvm::cl::desc("Stop optimizing after <N> ms were spent in SIL passes "
+                   "(0 means no budget)"));
+
 llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+/// Adds the time since \p StartTime to the time spent in \p T.
+static void recordPassStats(UnifiedStatsReporter &Stats, SILTransform *T,
+                            const llvm::TimeRecord &StartTime) {
+  llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  Elapsed -= StartTime;
+  Stats.recordTime(("SILOptimizer." + T->getName()).str(), Elapsed);
+  ++Stats.getFrontendCounters().NumSILPassesRun;
+}
+
+static uint64_t getNanosecondsSince(llvm::sys::TimeValue StartTime) {
+  llvm::sys::TimeValue Elapsed = llvm::sys::TimeValue::now() - StartTime;
+  return Elapsed.seconds() * 1000000000ULL + Elapsed.nanoseconds();
+}
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -177,8 +221,151 @@ SILPassManager::SILPassManager(SILModule *M, llvm::StringRef Stage) :
 }
 
 bool SILPassManager::continueTransforming() {
-  return Mod->getStage() == SILStage::Raw ||
-         NumPassesRun < SILNumOptPassesToRun;
+  if (Mod->getStage() == SILStage::Raw)
+    return true;
+  if (SILModuleTimeBudget && TotalPassTime > SILModuleTimeBudget * 1000000ULL)
+    return false;
+  return NumPassesRun < SILNumOptPassesToRun;
+}
+
+/// Return true if \p T is one of the passes whose compile time grows quickly
+/// with the function size, and that -sil-expensive-pass-size-limit skips.
+static bool isExpensivePass(SILTransform *T) {
+  switch (T->getPassKind()) {
+  case PassKind::RedundantLoadElimination:
+  case PassKind::DeadStoreElimination:
+  case PassKind::LICM:
+  case PassKind::ARCLoopOpts:
+    return true;
+  default:
+    return false;
+  }
+}
+
+namespace {
+/// A summary of the kinds of instructions in a function which some passes
+/// exclusively operate on. Functions that don't contain any of them, such as
+/// most trivial accessors, can skip those passes.
+struct FunctionShape {
+  bool HasAllocBox = false;
+  bool HasAllocStack = false;
+  /// mark_uninitialized, assign or mark_function_escape.
+  bool HasRawMemoryInst = false;
+
+  explicit FunctionShape(SILFunction *F) {
+    for (SILBasicBlock &BB : *F) {
+      for (SILInstruction &I : BB) {
+        switch (I.getKind()) {
+        case ValueKind::AllocBoxInst:
+          HasAllocBox = true;
+          break;
+        case ValueKind::AllocStackInst:
+          HasAllocStack = true;
+          break;
+        case ValueKind::MarkUninitializedInst:
+        case ValueKind::AssignInst:
+        case ValueKind::MarkFunctionEscapeInst:
+          HasRawMemoryInst = true;
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+};
+} // end anonymous namespace
+
+/// Returns true if the result of \p T depends only on the instructions
+/// summarized by FunctionShape.
+static bool isShapeSensitivePass(SILTransform *T) {
+  switch (T->getPassKind()) {
+  case PassKind::AllocBoxToStack:
+  case PassKind::DefiniteInitialization:
+  case PassKind::PredictableMemoryOptimizations:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Returns true if \p T provably has no work to do on a function with shape
+/// \p Shape.
+static bool hasNoWork(SILTransform *T, const FunctionShape &Shape) {
+  switch (T->getPassKind()) {
+  case PassKind::AllocBoxToStack:
+    if (Shape.HasAllocBox)
+      return false;
+    ++NumAllocBoxToStackSkipped;
+    return true;
+  case PassKind::DefiniteInitialization:
+    if (Shape.HasRawMemoryInst)
+      return false;
+    ++NumDefiniteInitSkipped;
+    return true;
+  case PassKind::PredictableMemoryOptimizations:
+    if (Shape.HasAllocBox || Shape.HasAllocStack)
+      return false;
+    ++NumPredictableMemOptSkipped;
+    return true;
+  default:
+    return false;
+  }
+}
+
+static unsigned getNumInstructions(SILFunction *F) {
+  unsigned Count = 0;
+  for (SILBasicBlock &BB : *F)
+    Count += BB.size();
+  return Count;
+}
+
+void SILPassManager::chargeTime(SILTransform *T, SILFunction *F,
+                                uint64_t Delta) {
+  PassTimeMap[T->getName()] += Delta;
+  TotalPassTime += Delta;
+
+  if (SILModuleTimeBudget && !BudgetExceeded &&
+      TotalPassTime > SILModuleTimeBudget * 1000000ULL) {
+    BudgetExceeded = true;
+    llvm::dbgs() << "*** SIL module time budget exceeded after "
+                 << T->getName() << " (" << StageName << ") ***\n";
+  }
+
+  if (!F || !SILFunctionTimeBudget)
+    return;
+
+  uint64_t &FunctionTime = FunctionTimeMap[F];
+  uint64_t Budget = SILFunctionTimeBudget * 1000000ULL;
+  bool WasOverBudget = FunctionTime > Budget;
+  FunctionTime += Delta;
+  if (!WasOverBudget && FunctionTime > Budget) {
+    BudgetExceeded = true;
+    llvm::dbgs() << "*** SIL function time budget exceeded for "
+                 << F->getName() << " after " << T->getName() << " ("
+                 << StageName << ") ***\n";
+  }
+}
+
+bool SILPassManager::isOverTimeBudget(SILFunction *F) {
+  if (!SILFunctionTimeBudget)
+    return false;
+  auto Iter = FunctionTimeMap.find(F);
+  return Iter != FunctionTimeMap.end() &&
+         Iter->second > SILFunctionTimeBudget * 1000000ULL;
+}
+
+void SILPassManager::printPassTimes(llvm::raw_ostream &OS) {
+  std::vector<std::pair<StringRef, uint64_t>> Times;
+  for (auto &Entry : PassTimeMap)
+    Times.push_back({Entry.getKey(), Entry.getValue()});
+  std::sort(Times.begin(), Times.end(),
+            [](const std::pair<StringRef, uint64_t> &LHS,
+               const std::pair<StringRef, uint64_t> &RHS) {
+              return LHS.second > RHS.second;
+            });
+  for (auto &Entry : Times)
+    OS << "  " << Entry.second << " (" << Entry.first << ")\n";
 }
 
 bool SILPassManager::analysesUnlocked() {
@@ -215,6 +402,15 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
 
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
+  // The function size is only computed if there is a limit.
+  unsigned NumInstructions = 0;
+  if (SILExpensivePassSizeLimit != UINT_MAX)
+    NumInstructions = getNumInstructions(F);
+
+  // The function shape is computed on demand, and recomputed after a pass
+  // changed the function.
+  llvm::Optional<FunctionShape> Shape;
+
   for (auto SFT : FuncTransforms) {
     PrettyStackTraceSILFunctionTransform X(SFT);
     SFT->injectPassManager(this);
@@ -238,6 +434,34 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
       continue;
     }
 
+    if (isShapeSensitivePass(SFT)) {
+      if (!Shape)
+        Shape.emplace(F);
+      if (hasNoWork(SFT, *Shape)) {
+        if (SILPrintPassName)
+          llvm::dbgs() << "(No work) Stage: " << StageName
+                       << " Pass: " << SFT->getName()
+                       << ", Function: " << F->getName() << "\n";
+        continue;
+      }
+    }
+
+    if (NumInstructions > SILExpensivePassSizeLimit && isExpensivePass(SFT)) {
+      if (SILPrintPassName)
+        llvm::dbgs() << "(Too large) Stage: " << StageName
+                     << " Pass: " << SFT->getName()
+                     << ", Function: " << F->getName() << "\n";
+      continue;
+    }
+
+    if (isOverTimeBudget(F)) {
+      if (SILPrintPassName)
+        llvm::dbgs() << "(Over budget) Stage: " << StageName
+                     << " Pass: " << SFT->getName()
+                     << ", Function: " << F->getName() << "\n";
+      continue;
+    }
+
     CurrentPassHasInvalidated = false;
 
     if (SILPrintPassName)
@@ -253,20 +477,26 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
     }
 
     llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+    UnifiedStatsReporter *Stats = Mod->getASTContext().Stats;
+    llvm::TimeRecord StatsStartTime;
+    if (Stats)
+      StatsStartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
     Mod->registerDeleteNotificationHandler(SFT);
     if (breakBeforeRunning(F->getName(), SFT->getName()))
       LLVM_BUILTIN_DEBUGTRAP;
     SFT->run();
     assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
     Mod->removeDeleteNotificationHandler(SFT);
+    if (Stats)
+      recordPassStats(*Stats, SFT, StatsStartTime);
 
     // Did running the transform result in new functions being added
     // to the top of our worklist?
     bool newFunctionsAdded = (F != FunctionWorklist.back());
 
+    uint64_t Delta = getNanosecondsSince(StartTime);
+    chargeTime(SFT, F, Delta);
     if (SILPrintPassTime) {
-      auto Delta =
-          llvm::sys::TimeValue::now().nanoseconds() - StartTime.nanoseconds();
       llvm::dbgs() << Delta << " (" << SFT->getName() << "," << F->getName()
                    << ")\n";
     }
@@ -282,6 +512,8 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
     // Remember if this pass didn't change anything.
     if (!CurrentPassHasInvalidated)
       completedPasses.set((size_t)SFT->getPassKind());
+    else
+      Shape.reset();
 
     if (Options.VerifyAll &&
         (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
@@ -341,6 +573,12 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
 
   // Pop functions off the worklist, and run all function transforms
   // on each of them.
+  //
+  // FIXME: Functions in independent SCCs of the call graph could be optimized
+  // in parallel, but function transforms are not safe to run concurrently:
+  // they create and delete functions in the shared SILModule, allocate from
+  // its allocator and type lowering caches, push new functions onto this
+  // worklist, and read and invalidate analyses that are cached per module.
   while (!FunctionWorklist.empty() && continueTransforming()) {
     auto *F = FunctionWorklist.back();
 
@@ -428,17 +666,22 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   }
 
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+  UnifiedStatsReporter *Stats = Mod->getASTContext().Stats;
+  llvm::TimeRecord StatsStartTime;
+  if (Stats)
+    StatsStartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
   SMT->run();
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
+  if (Stats)
+    recordPassStats(*Stats, SMT, StatsStartTime);
 
-  if (SILPrintPassTime) {
-    auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
-      StartTime.nanoseconds();
+  uint64_t Delta = getNanosecondsSince(StartTime);
+  chargeTime(SMT, nullptr, Delta);
+  if (SILPrintPassTime)
     llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
-  }
 
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SMT, nullptr,
@@ -450,7 +693,7 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   }
 
   if (Options.VerifyAll &&
-      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
+      (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
     Mod->verify();
     verifyAnalyses();
   }
@@ -533,6 +776,31 @@ SILPassManager::~SILPassManager() {
   for (auto T : Transformations)
     delete T;
 
+  // Report which passes used up the compile-time budget.
+  if (BudgetExceeded) {
+    llvm::dbgs() << "*** SIL pass times (ns)"
+                 << (StageName.empty() ? "" : " for ") << StageName
+                 << " ***\n";
+    printPassTimes(llvm::dbgs());
+  }
+
+  UnifiedStatsReporter *Stats = Mod->getASTContext().Stats;
+  if (SILPrintAnalysisStats)
+    llvm::dbgs() << "*** SIL analysis statistics"
+                 << (StageName.empty() ? "" : " for ") << StageName
+                 << " ***\n";
+  for (auto A : Analysis) {
+    if (SILPrintAnalysisStats)
+      llvm::dbgs() << "  " << SILAnalysis::getKindName(A->getKind()) << ": "
+                   << A->getNumComputed() << " computed, "
+                   << A->getNumInvalidated() << " invalidated\n";
+    if (Stats) {
+      auto &Counters = Stats->getFrontendCounters();
+      Counters.NumAnalysisComputations += A->getNumComputed();
+      Counters.NumAnalysisInvalidations += A->getNumInvalidated();
+    }
+  }
+
   // delete the analysis.
   for (auto A : Analysis) {
     Mod->removeDeleteNotificationHandler(A);
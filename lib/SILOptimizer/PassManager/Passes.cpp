@@ -312,6 +312,9 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
 
   // Perform lowering optimizations.
   PM.setStageName("Lower");
+  // Devirtualize the calls to methods which are not overridden, so that dead
+  // function elimination can remove them from the vtables.
+  PM.addClassHierarchyDevirtualizer();
   PM.addDeadFunctionElimination();
   PM.addDeadObjectElimination();
 
@@ -331,6 +334,12 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // Specialize closure.
   PM.addClosureSpecializer();
 
+  // Specialize functions for the concrete types of their protocol typed
+  // arguments. SILCombine then propagates the concrete types into the
+  // witness_method instructions of the specializations, so this should run
+  // before the last round of devirtualization and inlining.
+  PM.addExistentialSpecializer();
+
   // Do the second stack promotion on low-level SIL.
   PM.addStackPromotion();
 
@@ -388,9 +397,21 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // after FSO.
   PM.addLateReleaseHoisting();
 
+  // Reference counting operations on objects that never leave their function
+  // don't need to be atomic. This must come after the ARC optimizations,
+  // which create new, atomic, retains and releases.
+  PM.addNonAtomicRC();
+
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
+
+  // Summarize the effects of fragile functions for clients of this module.
+  // The bodies are final by now.
+  PM.addSideEffectsSummary();
+
+  // Has only an effect if the -assume-single-threaded option is specified.
+  PM.addAssumeSingleThreaded();
   
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
@@ -428,6 +449,9 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   // eventually remove unused declarations.
   PM.addExternalDefsToDecls();
 
+  // Has only an effect if the -assume-single-threaded option is specified.
+  PM.addAssumeSingleThreaded();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
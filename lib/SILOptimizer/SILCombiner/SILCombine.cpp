@@ -21,6 +21,10 @@
 #define DEBUG_TYPE "sil-combine"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "SILCombiner.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/Basic/Range.h"
+#include "swift/Basic/Statistic.h"
+#include "swift/SIL/CFG.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/DebugUtils.h"
@@ -28,9 +32,10 @@
 #include "swift/SILOptimizer/Analysis/SimplifyInstruction.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Local.h"
-#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
@@ -38,30 +43,35 @@ using namespace swift;
 STATISTIC(NumSimplified, "Number of instructions simplified");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
+STATISTIC(NumIterationLimitReached,
+          "Number of functions which reached the iteration limit");
+
+llvm::cl::opt<unsigned> SILCombineMaxIterations(
+    "sil-combine-max-iterations", llvm::cl::init(1000),
+    llvm::cl::desc("Stop combining a function after <N> iterations"));
 
 //===----------------------------------------------------------------------===//
 //                              Utility Methods
 //===----------------------------------------------------------------------===//
 
-/// addReachableCodeToWorklist - Walk the function in depth-first order, adding
-/// all reachable code to the worklist.
+/// addReachableCodeToWorklist - Walk the function in reverse post-order,
+/// adding all reachable code to the worklist.
 ///
 /// This has a couple of tricks to make the code faster and more powerful.  In
 /// particular, we DCE instructions as we go, to avoid adding them to the
 /// worklist (this significantly speeds up SILCombine on code where many
 /// instructions are dead or constant).
+///
+/// Reverse post-order visits every definition outside of a loop before its
+/// uses, so that operands are combined before the instructions using them
+/// and fewer users have to be revisited.
 void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
-  llvm::SmallVector<SILBasicBlock *, 256> Worklist;
   llvm::SmallVector<SILInstruction *, 128> InstrsForSILCombineWorklist;
-  llvm::SmallPtrSet<SILBasicBlock *, 32> Visited;
-
-  Worklist.push_back(BB);
-  do {
-    BB = Worklist.pop_back_val();
-
-    // We have now visited this block!  If we've already been here, ignore it.
-    if (!Visited.insert(BB).second) continue;
 
+  // The post-order is computed up front because blocks are modified below.
+  llvm::SmallVector<SILBasicBlock *, 32> PostOrder(llvm::po_begin(BB),
+                                                   llvm::po_end(BB));
+  for (SILBasicBlock *BB : reversed(PostOrder)) {
     for (SILBasicBlock::iterator BBI = BB->begin(), E = BB->end(); BBI != E; ) {
       SILInstruction *Inst = &*BBI;
       ++BBI;
@@ -86,11 +96,7 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
 
       InstrsForSILCombineWorklist.push_back(Inst);
     }
-
-    // Recursively visit successors.
-    for (auto SI = BB->succ_begin(), SE = BB->succ_end(); SI != SE; ++SI)
-      Worklist.push_back(*SI);
-  } while (!Worklist.empty());
+  }
 
   // Once we've found all of the instructions to add to the worklist, add them
   // in reverse order. This way SILCombine will visit from the top of the
@@ -170,7 +176,7 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     DEBUG(llvm::raw_string_ostream SS(OrigI); I->print(SS); OrigI = SS.str(););
     DEBUG(llvm::dbgs() << "SC: Visiting: " << OrigI << '\n');
 
-    if (SILInstruction *Result = visit(I)) {
+    if (SILInstruction *Result = visitAndRecordStats(I)) {
       ++NumCombined;
       // Should we replace the old instruction with a new one?
       if (Result != I) {
@@ -236,14 +242,72 @@ void SILCombineWorklist::addInitialGroup(ArrayRef<SILInstruction *> List) {
     }
 }
 
+SILInstruction *SILCombiner::visitAndRecordStats(SILInstruction *I) {
+  if (VisitorStatsByKind.empty())
+    return visit(I);
+
+  auto &Stats = VisitorStatsByKind[size_t(I->getKind())];
+  ++Stats.Visits;
+  llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+  SILInstruction *Result = visit(I);
+  llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  Elapsed -= StartTime;
+  Stats.Time += Elapsed;
+  if (Result)
+    ++Stats.Combines;
+  return Result;
+}
+
+static StringRef getValueKindName(ValueKind Kind) {
+  switch (Kind) {
+#define VALUE(Id, Parent) case ValueKind::Id: return #Id;
+#include "swift/SIL/SILNodes.def"
+  }
+  llvm_unreachable("Unhandled ValueKind in switch.");
+}
+
+void SILCombiner::recordVisitorStats(UnifiedStatsReporter &Stats) {
+  for (size_t i = 0, e = VisitorStatsByKind.size(); i != e; ++i) {
+    auto &KindStats = VisitorStatsByKind[i];
+    if (!KindStats.Visits)
+      continue;
+    std::string Prefix = "SILCombine.";
+    Prefix += getValueKindName(ValueKind(i));
+    Stats.recordCount(Prefix + ".Visits", KindStats.Visits);
+    Stats.recordCount(Prefix + ".Combines", KindStats.Combines);
+    Stats.recordTime(Prefix, KindStats.Time);
+  }
+}
+
 bool SILCombiner::runOnFunction(SILFunction &F) {
   clear();
 
+  UnifiedStatsReporter *Stats = F.getModule().getASTContext().Stats;
+  if (Stats)
+    VisitorStatsByKind.resize(size_t(ValueKind::Last_SILInstruction) + 1);
+
   bool Changed = false;
   // Perform iterations until we do not make any changes.
   while (doOneIteration(F, Iteration)) {
     Changed = true;
     Iteration++;
+
+    // A function which keeps changing is most likely being rewritten back
+    // and forth by two peepholes; stop rather than loop forever.
+    if (Iteration == SILCombineMaxIterations) {
+      ++NumIterationLimitReached;
+      DEBUG(llvm::dbgs() << "SC: reached the iteration limit of "
+                         << SILCombineMaxIterations << " on "
+                         << F.getName() << "\n");
+      if (Stats)
+        Stats->recordCount("SILCombine.IterationLimitReached", 1);
+      break;
+    }
+  }
+
+  if (Stats) {
+    recordVisitorStats(*Stats);
+    VisitorStatsByKind.clear();
   }
 
   // Cleanup the builder and return whether or not we made any changes.
@@ -28,10 +28,13 @@
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Timer.h"
+#include <vector>
 
 namespace swift {
 
 class AliasAnalysis;
+class UnifiedStatsReporter;
 
 /// This is the worklist management logic for SILCombine.
 class SILCombineWorklist {
@@ -125,6 +128,18 @@ class SILCombiner :
   /// Cast optimizer
   CastOptimizer CastOpt;
 
+  /// The work done by the visitor of one kind of instruction.
+  struct VisitorStats {
+    unsigned Visits = 0;
+    unsigned Combines = 0;
+    llvm::TimeRecord Time;
+  };
+
+  /// Statistics for each kind of instruction, indexed by ValueKind. It is
+  /// empty unless the function's ASTContext is collecting statistics (see
+  /// -stats-output-dir).
+  std::vector<VisitorStats> VisitorStatsByKind;
+
 public:
   SILCombiner(SILBuilder &B, AliasAnalysis *AA, bool removeCondFails)
       : AA(AA), Worklist(), MadeChange(false), RemoveCondFails(removeCondFails),
@@ -266,6 +281,13 @@ private:
   /// Perform one SILCombine iteration.
   bool doOneIteration(SILFunction &F, unsigned Iteration);
 
+  /// Visit \p I, recording the time spent in VisitorStatsByKind if it is
+  /// being collected.
+  SILInstruction *visitAndRecordStats(SILInstruction *I);
+
+  /// Add the contents of VisitorStatsByKind to \p Stats.
+  void recordVisitorStats(UnifiedStatsReporter &Stats);
+
   /// Add reachable code to the worklist. Meant to be used when starting to
   /// process a new function.
   void addReachableCodeToWorklist(SILBasicBlock *BB);
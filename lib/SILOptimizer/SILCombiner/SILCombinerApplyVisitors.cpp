@@ -36,6 +36,11 @@ using namespace swift::PatternMatch;
 ///   %closure_typeB
 static bool foldInverseReabstractionThunks(PartialApplyInst *PAI,
                                            SILCombiner *Combiner) {
+  // We can't replace a stack allocated context: its dealloc_ref [stack] must
+  // stay paired with the partial_apply.
+  if (PAI->canAllocOnStack())
+    return false;
+
   auto PAIArg = isPartialApplyOfReabstractionThunk(PAI);
   if (!PAIArg)
     return false;
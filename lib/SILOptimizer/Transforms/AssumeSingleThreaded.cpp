@@ -0,0 +1,65 @@
+//===--- AssumeSingleThreaded.cpp - Assume single-threaded execution ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Marks all reference counting operations as non-atomic if the module is
+// compiled with -assume-single-threaded.
+//
+// This is meant for programs, such as pre-forked server workers, that never
+// share objects between threads. It runs at the very end of the pipeline, so
+// that reference counting operations created by earlier passes are covered
+// too. Reference counting emitted by IRGen itself, e.g. in value witnesses,
+// remains atomic.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "assume-single-threaded"
+
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+namespace {
+
+class AssumeSingleThreaded : public SILFunctionTransform {
+  void run() override {
+    SILFunction *F = getFunction();
+    if (!F->getModule().getOptions().AssumeSingleThreaded)
+      return;
+
+    bool Changed = false;
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        auto *RCI = dyn_cast<RefCountingInst>(&I);
+        if (!RCI || RCI->isNonAtomic())
+          continue;
+        RCI->setNonAtomic();
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "Assume single threaded"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createAssumeSingleThreaded() {
+  return new AssumeSingleThreaded();
+}
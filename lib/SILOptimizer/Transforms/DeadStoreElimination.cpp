@@ -65,6 +65,7 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/BlockDataflow.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/LSBase.h"
 #include "swift/SILOptimizer/Utils/Local.h"
@@ -160,14 +161,22 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run DSE on functions with 256 basic blocks and 256 locations,
-/// which is a large function.  
-constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
+/// Each basic block keeps a few bit vectors with a bit per location, so this
+/// also bounds the memory we use. Since only the locations that are currently
+/// tracked are visited, the time is bounded by the alias query budget below
+/// rather than by this.
+constexpr unsigned MaxLSLocationBBMultiplicationNone = 2048*2048;
 
 /// we could run optimistic DSE on functions with less than 64 basic blocks
 /// and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
+/// The number of alias queries the pessimistic data flow may make for a
+/// function. After that, an instruction that may read from memory is taken to
+/// read all tracked locations, so large functions are still optimized in
+/// linear time, just with less precision in their earlier blocks.
+constexpr unsigned MaxAliasQueriesPessimistic = 256*1024;
+
 /// forward declaration.
 class DSEContext;
 /// BlockState summarizes how LSLocations are used in a basic block.
@@ -353,6 +362,28 @@ private:
   /// Keeps a map between the accessed SILValue and the location.
   LSLocationBaseMap BaseToLocIndex;
 
+  /// Map every basic block to the stack allocated locations deallocated in
+  /// it.
+  llvm::DenseMap<SILBasicBlock *, llvm::SmallVector<unsigned, 4>>
+    BBToDeallocatedLocations;
+
+  /// The number of alias queries that may still be made, if they are limited.
+  /// They are only limited for the pessimistic data flow, where giving up on
+  /// some locations early can not make the data flow inconsistent.
+  Optional<unsigned> AliasQueryBudget;
+
+  /// Account for an alias query. Returns false if the alias query budget is
+  /// used up, in which case the caller must conservatively assume that the
+  /// query would have found an alias.
+  bool consumeAliasQuery() {
+    if (!AliasQueryBudget)
+      return true;
+    if (*AliasQueryBudget == 0)
+      return false;
+    --*AliasQueryBudget;
+    return true;
+  }
+
   /// Return the BlockState for the basic block this basic block belongs to.
   BlockState *getBlockState(SILBasicBlock *B) { return BBToLocState[B]; }
 
@@ -442,6 +473,17 @@ public:
   /// Returns the location vault of the current function.
   std::vector<LSLocation> &getLocationVault() { return LocationVault; }
 
+  /// Find the basic blocks the stack allocated locations are deallocated in.
+  void computeDeallocatedLocations();
+
+  /// Returns the stack allocated locations deallocated in the basic block.
+  ArrayRef<unsigned> getDeallocatedLocations(SILBasicBlock *BB) {
+    auto Iter = BBToDeallocatedLocations.find(BB);
+    if (Iter == BBToDeallocatedLocations.end())
+      return {};
+    return Iter->second;
+  }
+
   /// Returns the epilogue release matcher we are using.
   ConsumedArgToEpilogueReleaseMatcher &getERM() const { return ERM; }
 
@@ -542,7 +584,7 @@ DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount)
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
+  // The bit vectors of the data flow would take too much memory.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
     return ProcessKind::ProcessNone;
 
@@ -648,19 +690,21 @@ void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
 }
 
 void BlockState::initStoreSetAtEndOfBlock(DSEContext &Ctx) {
-  std::vector<LSLocation> &LocationVault = Ctx.getLocationVault();
   // We set the store bit at the end of the basic block in which a stack
   // allocated location is deallocated.
+  for (unsigned i : Ctx.getDeallocatedLocations(BB))
+    startTrackingLocation(BBDeallocateLocation, i);
+}
+
+void DSEContext::computeDeallocatedLocations() {
+  // Look up the deallocations of each stack allocated location once, rather
+  // than once per basic block.
   for (unsigned i = 0; i < LocationVault.size(); ++i) {
-    // Turn on the store bit at the block which the stack slot is deallocated.
-    if (auto *ASI = dyn_cast<AllocStackInst>(LocationVault[i].getBase())) {
-      for (auto X : findDeallocStackInst(ASI)) {
-        SILBasicBlock *DSIBB = X->getParent();
-        if (DSIBB != BB)
-          continue;
-        startTrackingLocation(BBDeallocateLocation, i);
-      }
-    }
+    auto *ASI = dyn_cast<AllocStackInst>(LocationVault[i].getBase());
+    if (!ASI)
+      continue;
+    for (auto X : findDeallocStackInst(ASI))
+      BBToDeallocatedLocations[X->getParent()].push_back(i);
   }
 }
 
@@ -708,9 +752,8 @@ void DSEContext::invalidateBaseForGenKillSet(SILValue B, BlockState *S) {
 }
 
 void DSEContext::invalidateBaseForDSE(SILValue B, BlockState *S) {
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBWriteSetMid.test(i))
-      continue;
+  for (int i = S->BBWriteSetMid.find_first(); i != -1;
+       i = S->BBWriteSetMid.find_next(i)) {
     if (LocationVault[i].getBase() != B)
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
@@ -740,9 +783,12 @@ void DSEContext::processReadForDSE(BlockState *S, unsigned bit) {
   // Remove any may/must-aliasing stores to the LSLocation, as they can't be
   // used to kill any upward visible stores due to the interfering load.
   LSLocation &R = LocationVault[bit];
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->isTrackingLocation(S->BBWriteSetMid, i))
-      continue;
+  for (int i = S->BBWriteSetMid.find_first(); i != -1;
+       i = S->BBWriteSetMid.find_next(i)) {
+    if (!consumeAliasQuery()) {
+      S->BBWriteSetMid.reset();
+      break;
+    }
     LSLocation &L = LocationVault[i];
     if (!L.isMayAliasLSLocation(R, AA))
       continue;
@@ -757,9 +803,8 @@ void DSEContext::processReadForGenKillSet(BlockState *S, unsigned bit) {
   // Even though, LSLocations are canonicalized, we still need to consult
   // alias analysis to determine whether 2 LSLocations are disjointed.
   LSLocation &R = LocationVault[bit];
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
-      continue;
+  for (int i = S->BBMaxStoreSet.find_first(); i != -1;
+       i = S->BBMaxStoreSet.find_next(i)) {
     // Do nothing if the read location NoAlias with the current location.
     LSLocation &L = LocationVault[i];
     if (!L.isMayAliasLSLocation(R, AA))
@@ -830,9 +875,11 @@ bool DSEContext::processWriteForDSE(BlockState *S, unsigned bit) {
   // If a tracked store must aliases with this store, then this store is dead.
   bool StoreDead = false;
   LSLocation &R = LocationVault[bit];
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->isTrackingLocation(S->BBWriteSetMid, i))
-      continue;
+  for (int i = S->BBWriteSetMid.find_first(); i != -1;
+       i = S->BBWriteSetMid.find_next(i)) {
+    // Without an alias query the store has to be kept.
+    if (!consumeAliasQuery())
+      break;
     // If 2 locations may alias, we can still keep both stores.
     LSLocation &L = LocationVault[i];
     if (!L.isMustAliasLSLocation(R, AA))
@@ -991,9 +1038,8 @@ void DSEContext::processStoreInst(SILInstruction *I, DSEKind Kind) {
 void DSEContext::processDebugValueAddrInstForGenKillSet(SILInstruction *I) {
   BlockState *S = getBlockState(I);
   SILValue Mem = cast<DebugValueAddrInst>(I)->getOperand();
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
-      continue;
+  for (int i = S->BBMaxStoreSet.find_first(); i != -1;
+       i = S->BBMaxStoreSet.find_next(i)) {
     if (AA->isNoAlias(Mem, LocationVault[i].getBase()))
       continue;
     S->stopTrackingLocation(S->BBGenSet, i);
@@ -1004,9 +1050,12 @@ void DSEContext::processDebugValueAddrInstForGenKillSet(SILInstruction *I) {
 void DSEContext::processDebugValueAddrInstForDSE(SILInstruction *I) {
   BlockState *S = getBlockState(I);
   SILValue Mem = cast<DebugValueAddrInst>(I)->getOperand();
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->isTrackingLocation(S->BBWriteSetMid, i))
-      continue;
+  for (int i = S->BBWriteSetMid.find_first(); i != -1;
+       i = S->BBWriteSetMid.find_next(i)) {
+    if (!consumeAliasQuery()) {
+      S->BBWriteSetMid.reset();
+      break;
+    }
     if (AA->isNoAlias(Mem, LocationVault[i].getBase()))
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
@@ -1031,9 +1080,8 @@ void DSEContext::processDebugValueAddrInst(SILInstruction *I, DSEKind Kind) {
 
 void DSEContext::processUnknownReadInstForGenKillSet(SILInstruction *I) {
   BlockState *S = getBlockState(I);
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
-      continue;
+  for (int i = S->BBMaxStoreSet.find_first(); i != -1;
+       i = S->BBMaxStoreSet.find_next(i)) {
     if (!AA->mayReadFromMemory(I, LocationVault[i].getBase()))
       continue;
     // Update the genset and kill set.
@@ -1044,9 +1092,12 @@ void DSEContext::processUnknownReadInstForGenKillSet(SILInstruction *I) {
 
 void DSEContext::processUnknownReadInstForDSE(SILInstruction *I) {
   BlockState *S = getBlockState(I);
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->isTrackingLocation(S->BBWriteSetMid, i))
-      continue;
+  for (int i = S->BBWriteSetMid.find_first(); i != -1;
+       i = S->BBWriteSetMid.find_next(i)) {
+    if (!consumeAliasQuery()) {
+      S->BBWriteSetMid.reset();
+      break;
+    }
     if (!AA->mayReadFromMemory(I, LocationVault[i].getBase()))
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
@@ -1109,27 +1160,9 @@ void DSEContext::runIterativeDSE() {
   // Process each basic block with the gen and kill set. Every time the
   // BBWriteSetIn of a basic block changes, the optimization is rerun on its
   // predecessors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-  // Push into reverse post order so that we can pop from the back and get
-  // post order.
-  for (SILBasicBlock *B : PO->getReversePostOrder()) {
-    WorkList.push_back(B);
-    HandledBBs.insert(B);
-  }
-  while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
-    if (processBasicBlockWithGenKillSet(BB)) {
-      for (auto X : BB->getPreds()) {
-        // We do not push basic block into the worklist if its already 
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
-  }
+  solveBlockDataflow(PO, DataflowDirection::Backward, [&](SILBasicBlock *BB) {
+    return processBasicBlockWithGenKillSet(BB);
+  });
 }
 
 bool DSEContext::run() {
@@ -1149,6 +1182,13 @@ bool DSEContext::run() {
   // Do we run a pessimistic data flow ?
   bool Optimistic = Kind == ProcessKind::ProcessOptimistic ? true : false;
 
+  // The pessimistic data flow can give up on locations at any point, so
+  // bound the time it takes on large functions.
+  if (!Optimistic)
+    AliasQueryBudget = MaxAliasQueriesPessimistic;
+
+  computeDeallocatedLocations();
+
   // For all basic blocks in the function, initialize a BB state.
   //
   // Initialize the BBToLocState mapping.
@@ -17,6 +17,8 @@
 
 #define DEBUG_TYPE "sil-devirtualizer"
 
+#include "swift/Basic/Demangle.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
@@ -54,6 +56,7 @@ bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
   bool Changed = false;
   llvm::SmallVector<SILInstruction *, 8> DeadApplies;
   llvm::SmallVector<ApplySite, 8> NewApplies;
+  OptRemark::Emitter ORE(DEBUG_TYPE, F.getModule());
 
   for (auto &BB : F) {
     for (auto It = BB.begin(), End = BB.end(); It != End;) {
@@ -66,11 +69,28 @@ bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
         continue;
 
       auto NewInstPair = tryDevirtualizeApply(Apply, CHA);
-      if (!NewInstPair.second)
+      if (!NewInstPair.second) {
+        // Only dynamically dispatched calls are worth reporting.
+        if (isa<ClassMethodInst>(Apply.getCallee()) ||
+            isa<WitnessMethodInst>(Apply.getCallee()))
+          ORE.emitMissed("NoDevirtualization", &I,
+                         "could not devirtualize the callee");
         continue;
+      }
 
       Changed = true;
 
+      if (ORE.isEnabled()) {
+        StringRef Callee =
+            NewInstPair.second.getReferencedFunction()->getName();
+        ORE.emitPassed("Devirtualized", &I,
+                       "devirtualized call to " +
+                       Demangle::demangleSymbolAsString(
+                           Callee.data(), Callee.size(),
+                           Demangle::DemangleOptions::
+                               SimplifiedUIDemangleOptions()));
+      }
+
       auto *AI = Apply.getInstruction();
       if (!isa<TryApplyInst>(AI))
         AI->replaceAllUsesWith(NewInstPair.first);
@@ -17,6 +17,7 @@
 
 #define DEBUG_TYPE "sil-generic-specializer"
 
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
@@ -38,8 +39,11 @@ class GenericSpecializer : public SILFunctionTransform {
     DEBUG(llvm::dbgs() << "***** GenericSpecializer on function:" << F.getName()
                        << " *****\n");
 
+    // New specializations are reported to the pass manager as they are
+    // created, so there is no need to invalidate module-wide information
+    // about the set of functions (e.g. the callee cache).
     if (specializeAppliesInFunction(F))
-      invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
   }
 
   StringRef getName() override { return "Generic Specializer"; }
@@ -50,6 +54,7 @@ class GenericSpecializer : public SILFunctionTransform {
 bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
   DeadInstructionSet DeadApplies;
   llvm::SmallSetVector<SILInstruction *, 8> Applies;
+  OptRemark::Emitter ORE(DEBUG_TYPE, F.getModule());
 
   bool Changed = false;
   for (auto &BB : F) {
@@ -88,6 +93,15 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
       llvm::SmallVector<SILFunction *, 2> NewFunctions;
       trySpecializeApplyOfGeneric(Apply, DeadApplies, NewFunctions);
 
+      if (ORE.isEnabled()) {
+        StringRef CalleeName = Apply.getReferencedFunction()->getName();
+        if (DeadApplies.empty())
+          ORE.emitMissed("NoSpecialization", I,
+                         "could not specialize " + CalleeName);
+        else
+          ORE.emitPassed("Specialized", I, "specialized " + CalleeName);
+      }
+
       // Remove all the now-dead applies. We must do this immediately
       // rather than defer it in order to avoid problems with cloning
       // dead instructions when doing recursive specialization.
@@ -0,0 +1,100 @@
+//===--- NonAtomicRC.cpp - Use non-atomic RC for thread-local objects -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Marks reference counting operations on objects that never escape the
+// function which allocates them as non-atomic.
+//
+// An object that doesn't escape its allocating function can't be reached by
+// any other thread, so its reference count doesn't need to be updated with
+// atomic read-modify-write operations. This uses the same escape analysis as
+// stack promotion, but also applies to objects which can't be put on the
+// stack, e.g. because their lifetime isn't known.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "non-atomic-rc"
+
+#include "swift/SIL/InstructionUtils.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumNonAtomicRCInsts,
+          "Number of reference counting instructions made non-atomic");
+
+using namespace swift;
+
+namespace {
+
+class NonAtomicRC : public SILFunctionTransform {
+  /// Returns true if \p V refers to an object which is allocated in the
+  /// current function and doesn't escape it.
+  bool isThreadLocalObject(SILValue V, EscapeAnalysis *EA,
+                           EscapeAnalysis::ConnectionGraph *ConGraph) {
+    auto *ARI = dyn_cast<AllocRefInst>(stripCasts(V));
+    if (!ARI)
+      return false;
+
+    // Objective-C objects may be retained by the Objective-C runtime, which
+    // we don't see.
+    if (ARI->isObjC())
+      return false;
+
+    auto *Node = ConGraph->getNodeOrNull(ARI, EA);
+    return Node && !Node->escapes();
+  }
+
+  void run() override {
+    SILFunction *F = getFunction();
+    auto *EA = PM->getAnalysis<EscapeAnalysis>();
+    auto *ConGraph = EA->getConnectionGraph(F);
+    if (!ConGraph)
+      return;
+
+    DEBUG(llvm::dbgs() << "** NonAtomicRC in " << F->getName() << " **\n");
+
+    bool Changed = false;
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        if (!isa<StrongRetainInst>(&I) && !isa<StrongReleaseInst>(&I) &&
+            !isa<RetainValueInst>(&I) && !isa<ReleaseValueInst>(&I))
+          continue;
+
+        auto *RCI = cast<RefCountingInst>(&I);
+        if (RCI->isNonAtomic())
+          continue;
+
+        if (!isThreadLocalObject(RCI->getOperand(0), EA, ConGraph))
+          continue;
+
+        DEBUG(llvm::dbgs() << "    make non-atomic: " << *RCI);
+        RCI->setNonAtomic();
+        ++NumNonAtomicRCInsts;
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "NonAtomicRC"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createNonAtomicRC() {
+  return new NonAtomicRC();
+}
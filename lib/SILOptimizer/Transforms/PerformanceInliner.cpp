@@ -1014,6 +1014,13 @@ class SILPerformanceInliner {
     /// The benefit of a onFastPath builtin.
     FastPathBuiltinBenefit = RemovedCallBenefit + 40,
 
+    /// The benefit of a call site that the profile says is hot.
+    HotCallSiteBenefit = RemovedCallBenefit + 80,
+
+    /// A call site is hot if it ran at least 1/HotCallSiteFraction as often as
+    /// the most frequently called function in the profile.
+    HotCallSiteFraction = 100,
+
     /// Approximately up to this cost level a function can be inlined without
     /// increasing the code size.
     TrivialFunctionThreshold = 18,
@@ -1052,6 +1059,8 @@ class SILPerformanceInliner {
 
   bool isProfitableInColdBlock(FullApplySite AI, SILFunction *Callee);
 
+  bool isHotCallSite(FullApplySite AI);
+
   void visitColdBlocks(SmallVectorImpl<FullApplySite> &AppliesToInline,
                        SILBasicBlock *root, DominanceInfo *DT);
 
@@ -1193,6 +1202,9 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
 
   CallerWeight.updateBenefit(Benefit, BaseBenefit);
 
+  if (isHotCallSite(AI))
+    CallerWeight.updateBenefit(Benefit, HotCallSiteBenefit);
+
   // Go through all blocks of the function, accumulate the cost and find
   // benefits.
   while (SILBasicBlock *block = domOrder.getNext()) {
@@ -1286,6 +1298,25 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   return true;
 }
 
+/// Return true if the profile given with -profile-use says that this call site
+/// is one of the hottest in the module.
+bool SILPerformanceInliner::isHotCallSite(FullApplySite AI) {
+  SILFunction *Caller = AI.getFunction();
+  uint64_t MaxCount = Caller->getModule().getMaxProfileEntryCount();
+  if (MaxCount == 0)
+    return false;
+
+  // Only the first block of each profiled region has a count. The nearest
+  // one that dominates the call site ran at least as often as the call.
+  DominanceInfo *DT = DA->get(Caller);
+  for (auto *Node = DT->getNode(AI.getInstruction()->getParent()); Node;
+       Node = Node->getIDom()) {
+    if (auto Count = Node->getBlock()->getExecutionCount())
+      return *Count != 0 && *Count >= MaxCount / HotCallSiteFraction;
+  }
+  return false;
+}
+
 /// Return true if inlining this call site into a cold block is profitable.
 bool SILPerformanceInliner::isProfitableInColdBlock(FullApplySite AI,
                                                     SILFunction *Callee) {
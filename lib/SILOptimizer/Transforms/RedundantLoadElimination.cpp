@@ -83,6 +83,7 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/BlockDataflow.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/Utils/LSBase.h"
@@ -90,6 +91,7 @@
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/None.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -174,14 +176,22 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
-constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
+/// Each basic block keeps a few bit vectors with a bit per location, so this
+/// also bounds the memory we use. Since only the locations that are currently
+/// tracked are visited, the time is bounded by the alias query budget below
+/// rather than by this.
+constexpr unsigned MaxLSLocationBBMultiplicationNone = 2048*2048;
 
 /// we could run optimistic RLE on functions with less than 64 basic blocks
 /// and 64 locations which is a sizeable function.
 constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
 
+/// The number of alias queries the one iteration data flow may make for a
+/// function. After that, an instruction that may write to memory is taken to
+/// clobber all tracked locations, so large functions are still optimized in
+/// linear time, just with less precision in their later blocks.
+constexpr unsigned MaxAliasQueriesOneIteration = 256*1024;
+
 /// forward declaration.
 class RLEContext;
 
@@ -477,6 +487,11 @@ private:
   /// walked, i.e. when the we generate the genset and killset.
   llvm::DenseSet<SILBasicBlock *> BBWithLoads;
 
+  /// The number of alias queries that may still be made, if they are limited.
+  /// They are only limited for the one iteration data flow, where giving up
+  /// on some locations early can not make the data flow inconsistent.
+  llvm::Optional<unsigned> AliasQueryBudget;
+
 public:
   RLEContext(SILFunction *F, SILPassManager *PM, AliasAnalysis *AA,
              TypeExpansionAnalysis *TE, PostOrderFunctionInfo *PO,
@@ -514,6 +529,18 @@ public:
   /// Returns the alias analysis we will use during all computations.
   AliasAnalysis *getAA() const { return AA; }
 
+  /// Account for an alias query. Returns false if the alias query budget is
+  /// used up, in which case the caller must conservatively assume that the
+  /// query would have found an alias.
+  bool consumeAliasQuery() {
+    if (!AliasQueryBudget)
+      return true;
+    if (*AliasQueryBudget == 0)
+      return false;
+    --*AliasQueryBudget;
+    return true;
+  }
+
   /// Returns the current type expansion analysis we are .
   TypeExpansionAnalysis *getTE() const { return TE; }
 
@@ -613,19 +640,26 @@ void BlockState::mergePredecessorAvailSetAndValue(RLEContext &Ctx) {
     BlockState &OtherState = Ctx.getBlockState(*Iter);
     ForwardSetIn &= OtherState.ForwardSetOut;
 
-    // Merge in the predecessor state.
-    for (unsigned i = 0; i < LocationNum; ++i) {
-      if (OtherState.ForwardSetOut[i]) {
-        // There are multiple values from multiple predecessors, set this as
-        // a covering value. We do not need to track the value itself, as we
-        // can always go to the predecessors BlockState to find it.
-        ForwardValIn[i] = Ctx.getValueBit(LSValue(true));
-        continue;
-      }
-      // If this location does have an available value, then clear it.
-      stopTrackingValue(ForwardValIn, i);
-      stopTrackingLocation(ForwardSetIn, i);
+    // Merge in the predecessor state. Only the locations that have a value
+    // are visited, rather than all of the locations.
+    //
+    // If this location does not have an available value in the predecessor,
+    // then clear it.
+    llvm::SmallVector<unsigned, 8> Unavailable;
+    for (auto &Entry : ForwardValIn) {
+      if (!OtherState.ForwardSetOut[Entry.first])
+        Unavailable.push_back(Entry.first);
     }
+    for (unsigned L : Unavailable)
+      stopTrackingValue(ForwardValIn, L);
+
+    // There are multiple values from multiple predecessors, set this as
+    // a covering value. We do not need to track the value itself, as we
+    // can always go to the predecessors BlockState to find it.
+    unsigned CoveringValue = Ctx.getValueBit(LSValue(true));
+    for (int i = OtherState.ForwardSetOut.find_first(); i != -1;
+         i = OtherState.ForwardSetOut.find_next(i))
+      ForwardValIn[i] = CoveringValue;
   }
 }
 
@@ -736,9 +770,8 @@ void BlockState::updateGenKillSetForWrite(RLEContext &Ctx, unsigned B) {
   // This is a store, invalidate any location that this location may alias, as
   // their values can no longer be forwarded.
   LSLocation &R = Ctx.getLocation(B);
-  for (unsigned i = 0; i < LocationNum; ++i) {
-    if (!isTrackingLocation(ForwardSetMax, i))
-      continue;
+  for (int i = ForwardSetMax.find_first(); i != -1;
+       i = ForwardSetMax.find_next(i)) {
     LSLocation &L = Ctx.getLocation(i);
     if (!L.isMayAliasLSLocation(R, Ctx.getAA()))
       continue;
@@ -764,9 +797,12 @@ void BlockState::updateForwardSetForWrite(RLEContext &Ctx, unsigned B) {
   // This is a store, invalidate any location that this location may alias, as
   // their values can no longer be forwarded.
   LSLocation &R = Ctx.getLocation(B);
-  for (unsigned i = 0; i < LocationNum; ++i) {
-    if (!isTrackingLocation(ForwardSetIn, i))
-      continue;
+  for (int i = ForwardSetIn.find_first(); i != -1;
+       i = ForwardSetIn.find_next(i)) {
+    if (!Ctx.consumeAliasQuery()) {
+      ForwardSetIn.reset();
+      break;
+    }
     LSLocation &L = Ctx.getLocation(i);
     if (!L.isMayAliasLSLocation(R, Ctx.getAA()))
       continue;
@@ -783,9 +819,13 @@ void BlockState::updateForwardSetAndValForWrite(RLEContext &Ctx, unsigned L,
   // This is a store, invalidate any location that this location may alias, as
   // their values can no longer be forwarded.
   LSLocation &R = Ctx.getLocation(L);
-  for (unsigned i = 0; i < LocationNum; ++i) {
-    if (!isTrackingLocation(ForwardSetIn, i))
-      continue;
+  for (int i = ForwardSetIn.find_first(); i != -1;
+       i = ForwardSetIn.find_next(i)) {
+    if (!Ctx.consumeAliasQuery()) {
+      ForwardSetIn.reset();
+      ForwardValIn.clear();
+      break;
+    }
     LSLocation &L = Ctx.getLocation(i);
     if (!L.isMayAliasLSLocation(R, Ctx.getAA()))
       continue;
@@ -929,9 +969,8 @@ void BlockState::processLoadInst(RLEContext &Ctx, LoadInst *LI, RLEKind Kind) {
 void BlockState::processUnknownWriteInstForGenKillSet(RLEContext &Ctx,
                                                       SILInstruction *I) {
   auto *AA = Ctx.getAA();
-  for (unsigned i = 0; i < LocationNum; ++i) {
-    if (!isTrackingLocation(ForwardSetMax, i))
-      continue;
+  for (int i = ForwardSetMax.find_first(); i != -1;
+       i = ForwardSetMax.find_next(i)) {
     // Invalidate any location this instruction may write to.
     //
     // TODO: checking may alias with Base is overly conservative,
@@ -948,9 +987,13 @@ void BlockState::processUnknownWriteInstForGenKillSet(RLEContext &Ctx,
 void BlockState::processUnknownWriteInstForRLE(RLEContext &Ctx,
                                                SILInstruction *I) {
   auto *AA = Ctx.getAA();
-  for (unsigned i = 0; i < LocationNum; ++i) {
-    if (!isTrackingLocation(ForwardSetIn, i))
-      continue;
+  for (int i = ForwardSetIn.find_first(); i != -1;
+       i = ForwardSetIn.find_next(i)) {
+    if (!Ctx.consumeAliasQuery()) {
+      ForwardSetIn.reset();
+      ForwardValIn.clear();
+      break;
+    }
     // Invalidate any location this instruction may write to.
     //
     // TODO: checking may alias with Base is overly conservative,
@@ -1002,7 +1045,8 @@ processDeallocStackInstForGenKillSet(RLEContext &Ctx, SILInstruction *I) {
 void BlockState::
 processDeallocStackInstForRLE(RLEContext &Ctx, SILInstruction *I) {
   SILValue ASI = findAllocStackInst(I);
-  for (unsigned i = 0; i < LocationNum; ++i) {
+  for (int i = ForwardSetIn.find_first(); i != -1;
+       i = ForwardSetIn.find_next(i)) {
     LSLocation &R = Ctx.getLocation(i);
     if (R.getBase() != ASI)
       continue;
@@ -1104,7 +1148,7 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
     HandledBBs.insert(B);
   }
 
-  // Data flow may take too long to run.
+  // The bit vectors of the data flow would take too much memory.
   if (BBCount * LocationCount > MaxLSLocationBBMultiplicationNone)
     return ProcessKind::ProcessNone;
 
@@ -1333,34 +1377,14 @@ void RLEContext::processBasicBlocksWithGenKillSet() {
   // Process each basic block with the gen and kill set. Every time the
   // ForwardSetOut of a basic block changes, the optimization is rerun on its
   // successors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-
-  // Push into the worklist in post order so that we can pop from the back and
-  // get reverse post order.
-  for (SILBasicBlock *BB : PO->getPostOrder()) {
-    WorkList.push_back(BB);
-    HandledBBs.insert(BB);
-  }
-  while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
-
+  solveBlockDataflow(PO, DataflowDirection::Forward, [&](SILBasicBlock *BB) {
     // Intersection.
     BlockState &Forwarder = getBlockState(BB);
     // Compute the ForwardSetIn at the beginning of the basic block.
     Forwarder.mergePredecessorAvailSet(*this);
 
-    if (Forwarder.processBasicBlockWithGenKillSet()) {
-      for (auto &X : BB->getSuccessors()) {
-        // We do not push basic block into the worklist if its already
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
-  }
+    return Forwarder.processBasicBlockWithGenKillSet();
+  });
 }
 
 void RLEContext::processBasicBlocksForAvailValue() {
@@ -1462,6 +1486,11 @@ bool RLEContext::run() {
   bool Optimistic = Kind == ProcessKind::ProcessMultipleIterations ?
                         true : false;
 
+  // The one iteration data flow can give up on locations at any point, so
+  // bound the time it takes on large functions.
+  if (!Optimistic)
+    AliasQueryBudget = MaxAliasQueriesOneIteration;
+
   // These are a list of basic blocks that we actually processed.
   // We do not process unreachable block, instead we set their liveouts to nil.
   llvm::DenseSet<SILBasicBlock *> BBToProcess;
@@ -24,6 +24,7 @@
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/InstructionUtils.h"
+#include "swift/SIL/OptimizationRemark.h"
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -534,6 +535,8 @@ namespace {
 
     void run() override {
       ClassHierarchyAnalysis *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
+      SILFunction &F = *getFunction();
+      OptRemark::Emitter ORE(DEBUG_TYPE, F.getModule());
 
       bool Changed = false;
 
@@ -548,8 +551,21 @@ namespace {
       }
 
       // Go over the collected calls and try to insert speculative calls.
-      for (auto AI : ToSpecialize)
-        Changed |= tryToSpeculateTarget(AI, CHA);
+      for (auto AI : ToSpecialize) {
+        // The apply may be replaced, so describe it up front.
+        SILLocation Loc = AI.getLoc();
+        StringRef Method = cast<ClassMethodInst>(AI.getCallee())
+                               ->getMember().getDecl()->getName().str();
+
+        if (tryToSpeculateTarget(AI, CHA)) {
+          Changed = true;
+          ORE.emitPassed("SpeculativelyDevirtualized", Loc, F,
+                         "speculatively devirtualized call to " + Method);
+        } else {
+          ORE.emitMissed("NoSpeculativeDevirtualization", Loc, F,
+                         "could not speculate the targets of " + Method);
+        }
+      }
 
       if (Changed) {
         invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
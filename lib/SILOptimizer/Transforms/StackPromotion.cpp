@@ -220,6 +220,11 @@ static bool isPromotableAllocInst(SILInstruction *I) {
       return true;
     return false;
   }
+  // Check for closure context allocation. A partial_apply without arguments
+  // doesn't allocate a context.
+  if (auto *PAI = dyn_cast<PartialApplyInst>(I))
+    return PAI->getNumArguments() != 0 && !PAI->canAllocOnStack();
+
   // Check for array buffer allocation.
   auto *AI = dyn_cast<ApplyInst>(I);
   if (AI && AI->getNumArguments() == 3) {
@@ -300,6 +305,15 @@ void StackPromoter::tryPromoteAlloc(SILInstruction *I) {
     ChangedInsts = true;
     return;
   }
+  if (auto *PAI = dyn_cast<PartialApplyInst>(I)) {
+    assert(!AllocInsertionPoint && "can't move a partial_apply");
+    // It's a closure context. Like for objects, we set the [stack] attribute
+    // and end the context's lifetime with a dealloc_ref [stack].
+    PAI->setStackAllocatable();
+    B.createDeallocRef(I->getLoc(), I, true);
+    ChangedInsts = true;
+    return;
+  }
   if (auto *AI = dyn_cast<ApplyInst>(I)) {
     assert(!AllocInsertionPoint && "can't move call to swift_bufferAlloc");
     // It's an array buffer allocation.
@@ -489,8 +503,9 @@ bool StackPromoter::canPromoteAlloc(SILInstruction *AI,
     if (!RestartPoint)
       return false;
 
-    // Moving a buffer allocation call is not trivial because we would need to
-    // move all the parameter calculations as well. So we just don't do it.
+    // Moving a buffer allocation call or a partial_apply is not trivial
+    // because we would need to move all the parameter calculations as well. So
+    // we just don't do it.
     if (!isa<AllocRefInst>(AI))
       return false;
 
@@ -14,6 +14,7 @@
 #include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Utils/Devirtualize.h"
 #include "swift/AST/Decl.h"
+#include "swift/AST/ProtocolConformance.h"
 #include "swift/AST/Types.h"
 #include "swift/SIL/SILDeclRef.h"
 #include "swift/SIL/SILFunction.h"
@@ -766,8 +767,13 @@ static void getWitnessMethodSubstitutions(ApplySite AI, SILFunction *F,
 /// Generate a new apply of a function_ref to replace an apply of a
 /// witness_method when we've determined the actual function we'll end
 /// up calling.
+///
+/// If \p CastSelf is true, the self argument is a value of an archetype,
+/// which is known to be the concrete type of the witness, and it is cast to
+/// the concrete type.
 static ApplySite devirtualizeWitnessMethod(ApplySite AI, SILFunction *F,
-                                           ArrayRef<Substitution> Subs) {
+                                           ArrayRef<Substitution> Subs,
+                                           bool CastSelf = false) {
   // We know the witness thunk and the corresponding set of substitutions
   // required to invoke the protocol method at this point.
   auto &Module = AI.getModule();
@@ -797,8 +803,14 @@ static ApplySite devirtualizeWitnessMethod(ApplySite AI, SILFunction *F,
     SILValue A = AI.getArgument(ArgN);
     auto ParamType = SubstCalleeCanType->getSILArgumentType(
       SubstCalleeCanType->getNumSILArguments() - AI.getNumArguments() + ArgN);
-    if (A->getType() != ParamType)
+    if (CastSelf && ArgN == ArgE - 1) {
+      if (ParamType.isAddress())
+        A = B.createUncheckedAddrCast(AI.getLoc(), A, ParamType);
+      else
+        A = B.createUncheckedRefCast(AI.getLoc(), A, ParamType);
+    } else if (A->getType() != ParamType) {
       A = B.createUpcast(AI.getLoc(), A, ParamType);
+    }
 
     Arguments.push_back(A);
   }
@@ -857,6 +869,133 @@ DevirtualizationResult swift::tryDevirtualizeWitnessMethod(ApplySite AI) {
   return std::make_pair(Result.getInstruction(), Result);
 }
 
+/// Returns the conformance of the only type in the module which conforms to
+/// the protocol \p PD, if no type outside of the module can conform to it.
+static NormalProtocolConformance *
+getSingleConformance(ProtocolDecl *PD, SILModule &M,
+                     ClassHierarchyAnalysis *CHA) {
+  const DeclContext *DC = M.getAssociatedContext();
+
+  // Without an associated context we cannot perform any
+  // access-based optimizations.
+  if (!DC)
+    return nullptr;
+
+  // Objective-C protocols don't have witness tables.
+  if (PD->isObjC() || PD->getModuleContext() != M.getSwiftModule())
+    return nullptr;
+
+  if (!PD->hasAccessibility())
+    return nullptr;
+
+  // Only consider 'private' protocols, unless we are in whole-module
+  // compilation.
+  switch (PD->getEffectiveAccess()) {
+  case Accessibility::Public:
+    return nullptr;
+  case Accessibility::Internal:
+    if (!M.isWholeModule())
+      return nullptr;
+    break;
+  case Accessibility::Private:
+    break;
+  }
+
+  auto &Impls = CHA->getProtocolImplementations(PD);
+  if (Impls.size() != 1)
+    return nullptr;
+
+  // The class hierarchy analysis only sees the nominal type declarations of
+  // the module. Make sure that there is no other witness table, e.g. for an
+  // imported type which conforms to the protocol in an extension.
+  NormalProtocolConformance *Single = nullptr;
+  for (auto &WT : M.getWitnessTableList()) {
+    if (WT.getConformance()->getProtocol() != PD)
+      continue;
+    if (Single || WT.isDeclaration())
+      return nullptr;
+    Single = WT.getConformance();
+  }
+  if (!Single)
+    return nullptr;
+
+  auto *NTD = Single->getType()->getAnyNominal();
+  if (NTD != Impls[0] || NTD->isGenericContext())
+    return nullptr;
+
+  // Subclasses of a class share its conformance, so the dynamic type is only
+  // known for final classes.
+  if (auto *CD = dyn_cast<ClassDecl>(NTD))
+    if (!CD->isFinal())
+      return nullptr;
+
+  return Single;
+}
+
+/// Devirtualize a witness_method call on an archetype, e.g. an opened
+/// existential, if only one type in the module conforms to the protocol.
+/// The archetype must then be bound to this type.
+static DevirtualizationResult
+tryDevirtualizeWitnessMethodOfSingleConformance(FullApplySite AI,
+                                                ClassHierarchyAnalysis *CHA) {
+  auto *WMI = cast<WitnessMethodInst>(AI.getCallee());
+  if (!WMI->getConformance().isAbstract())
+    return std::make_pair(nullptr, FullApplySite());
+
+  CanType SelfType = WMI->getLookupType();
+  if (!isa<ArchetypeType>(SelfType) || !AI.hasSelfArgument())
+    return std::make_pair(nullptr, FullApplySite());
+
+  // Only the self argument can be cast to the concrete type. Bail if any
+  // other argument or the result is of the Self type.
+  SILValue Self = AI.getSelfArgument();
+  if (Self->getType().getSwiftRValueType() != SelfType)
+    return std::make_pair(nullptr, FullApplySite());
+  auto MentionsSelf = [&SelfType](SILType Ty) -> bool {
+    return Ty.getSwiftRValueType().findIf([&SelfType](Type T) -> bool {
+      return T->getCanonicalType() == SelfType;
+    });
+  };
+  if (MentionsSelf(AI.getType()))
+    return std::make_pair(nullptr, FullApplySite());
+  for (auto Arg : AI.getArgumentsWithoutSelf())
+    if (MentionsSelf(Arg->getType()))
+      return std::make_pair(nullptr, FullApplySite());
+
+  auto *Conformance = getSingleConformance(WMI->getLookupProtocol(),
+                                           AI.getModule(), CHA);
+  if (!Conformance)
+    return std::make_pair(nullptr, FullApplySite());
+
+  // A reference can only be cast to a class.
+  if (!Self->getType().isAddress() &&
+      !isa<ClassDecl>(Conformance->getType()->getAnyNominal()))
+    return std::make_pair(nullptr, FullApplySite());
+
+  SILFunction *F;
+  ArrayRef<Substitution> Subs;
+  SILWitnessTable *WT;
+  std::tie(F, WT, Subs) =
+    AI.getModule().lookUpFunctionInWitnessTable(
+        ProtocolConformanceRef(Conformance), WMI->getMember());
+
+  if (!F)
+    return std::make_pair(nullptr, FullApplySite());
+
+  if (AI.getFunction()->isFragile()) {
+    // function_ref inside fragile function cannot reference a private or
+    // hidden symbol.
+    if (!F->hasValidLinkageForFragileRef())
+      return std::make_pair(nullptr, FullApplySite());
+  }
+
+  DEBUG(llvm::dbgs() << "    Single conformance of "
+                     << WMI->getLookupProtocol()->getName() << ": "
+                     << Conformance->getType() << "\n");
+  auto Result = devirtualizeWitnessMethod(AI, F, Subs, /*CastSelf*/ true);
+  return std::make_pair(Result.getInstruction(), Result);
+}
+
 //===----------------------------------------------------------------------===//
 //                              Top Level Driver
 //===----------------------------------------------------------------------===//
@@ -872,8 +1011,14 @@ swift::tryDevirtualizeApply(FullApplySite AI, ClassHierarchyAnalysis *CHA) {
   //   %8 = witness_method $Optional<UInt16>, #LogicValue.boolValue!getter.1
   //   %9 = apply %8<Self = CodeUnit?>(%6#1) : ...
   //
-  if (isa<WitnessMethodInst>(AI.getCallee()))
-    return tryDevirtualizeWitnessMethod(AI);
+  // If the conformance is abstract, but only one type in the module conforms
+  // to the protocol, devirtualize to the witness of this type.
+  if (isa<WitnessMethodInst>(AI.getCallee())) {
+    auto Result = tryDevirtualizeWitnessMethod(AI);
+    if (!Result.second && CHA)
+      Result = tryDevirtualizeWitnessMethodOfSingleConformance(AI, CHA);
+    return Result;
+  }
 
   /// Optimize a class_method and alloc_ref pair into a direct function
   /// reference:
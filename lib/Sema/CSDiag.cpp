@@ -2850,6 +2850,16 @@ typeCheckChildIndependently(Expr *subExpr, Type convertType,
   
     CS->TC.addExprForDiagnosis(subExpr, subExpr);
   }
+
+  // Diagnosing a failure can re-type-check the same subexpressions many times
+  // with different contextual types, taking much longer than type-checking
+  // the whole expression did. Once the budget for the outermost diagnosis is
+  // spent, pretend as though the subexpression had been checked with nothing
+  // learned; the callers then fall back to more generic diagnostics.
+  if (CS->TC.NumDiagnosisRechecks >=
+        CS->TC.Context.LangOpts.DiagnosisRecheckLimit)
+    return subExpr;
+  ++CS->TC.NumDiagnosisRechecks;
   
   // If we have a conversion type, but it has type variables (from the current
   // ConstraintSystem), then we can't use it.
@@ -5398,7 +5408,13 @@ void ConstraintSystem::diagnoseFailureForExpr(Expr *expr) {
   // Look through RebindSelfInConstructorExpr to avoid weird sema issues.
   if (auto *RB = dyn_cast<RebindSelfInConstructorExpr>(expr))
     expr = RB->getSubExpr();
-  
+
+  // Nested diagnoses share the re-type-checking budget of the outermost one.
+  if (TC.DiagnosisDepth == 0)
+    TC.NumDiagnosisRechecks = 0;
+  llvm::SaveAndRestore<unsigned> depth(TC.DiagnosisDepth,
+                                       TC.DiagnosisDepth + 1);
+
   FailureDiagnosis diagnosis(expr, this);
   
   // Now, attempt to diagnose the failure from the info we've collected.
@@ -15,9 +15,12 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
+#include "swift/Basic/Statistic.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -418,6 +421,13 @@ ConstraintSystem::SolverState::~SolverState() {
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
 
+  if (auto *Stats = CS.getTypeChecker().Context.Stats) {
+    auto &counters = Stats->getFrontendCounters();
+    ++counters.NumSolutionAttempts;
+    #define CS_STATISTIC(Name, Description) counters.Name += Name;
+    #include "ConstraintSolverStats.def"
+  }
+
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
   // FIXME: This is not at all thread-safe.
@@ -1275,6 +1285,25 @@ bool ConstraintSystem::solve(SmallVectorImpl<Solution> &solutions,
   return solutions.empty();
 }
 
+/// Copy a partial solution out of the component cache.
+static Solution copySolution(const Solution &solution) {
+  Solution copy(solution.getConstraintSystem(), solution.getFixedScore());
+  copy.typeBindings = solution.typeBindings;
+  copy.overloadChoices = solution.overloadChoices;
+  copy.ConstraintRestrictions = solution.ConstraintRestrictions;
+  copy.Fixes = solution.Fixes;
+  copy.DisjunctionChoices = solution.DisjunctionChoices;
+  copy.OpenedTypes = solution.OpenedTypes;
+  copy.OpenedExistentialTypes = solution.OpenedExistentialTypes;
+  return copy;
+}
+
+static bool isSameScore(const Optional<Score> &x, const Optional<Score> &y) {
+  if (!x || !y)
+    return !x && !y;
+  return *x == *y;
+}
+
 bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
                                 FreeTypeVariableBinding allowFreeTypeVariables){
   // If we already failed, or simplification fails, we're done.
@@ -1360,6 +1389,24 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     constraintBuckets[constraintComponent[constraint]].push_back(constraint);
   }
 
+  // Solve the components with the fewest disjunctions first. The components
+  // are independent, so this doesn't change their solutions, but if any of
+  // them fails then so does the whole system, and a small component finds
+  // that out sooner than a large one.
+  SmallVector<unsigned, 4> numComponentDisjunctions(numComponents, 0);
+  SmallVector<unsigned, 4> componentOrder;
+  for (unsigned component = 0; component != numComponents; ++component) {
+    componentOrder.push_back(component);
+    for (auto &constraint : constraintBuckets[component]) {
+      if (constraint.getKind() == ConstraintKind::Disjunction)
+        ++numComponentDisjunctions[component];
+    }
+  }
+  std::stable_sort(componentOrder.begin(), componentOrder.end(),
+                   [&](unsigned lhs, unsigned rhs) {
+    return numComponentDisjunctions[lhs] < numComponentDisjunctions[rhs];
+  });
+
   // Function object that returns all constraints placed into buckets
   // back to the list of constraints.
   auto returnAllConstraints = [&] {
@@ -1374,7 +1421,73 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
   std::unique_ptr<SmallVector<Solution, 4>[]> 
     partialSolutions(new SmallVector<Solution, 4>[numComponents]);
   Optional<Score> PreviousBestScore = solverState->BestScore;
-  for (unsigned component = 0; component != numComponents; ++component) {
+
+  // With the component cache, another term of an enclosing disjunction that
+  // leaves an identical component behind reuses the partial solutions
+  // computed here. Those then must not mention anything decided outside of
+  // the component, so collect what has been decided so far.
+  bool useComponentCache = TC.getLangOpts().SolverComponentCache;
+  llvm::SmallPtrSet<TypeVariableType *, 16> outerTypeVars;
+  llvm::SmallPtrSet<ConstraintLocator *, 8> outerOverloads;
+  llvm::SmallPtrSet<ConstraintLocator *, 4> outerDisjunctionChoices;
+  llvm::SmallPtrSet<ConstraintLocator *, 4> outerOpenedTypes;
+  llvm::SmallPtrSet<ConstraintLocator *, 4> outerOpenedExistentials;
+  llvm::DenseSet<std::pair<CanType, CanType>> outerRestrictions;
+  if (useComponentCache) {
+    outerTypeVars.insert(TypeVariables.begin(), TypeVariables.end());
+    for (auto resolved = resolvedOverloadSets;
+         resolved; resolved = resolved->Previous)
+      outerOverloads.insert(resolved->Locator);
+    for (auto &choice : DisjunctionChoices)
+      outerDisjunctionChoices.insert(choice.first);
+    for (auto &opened : OpenedTypes)
+      outerOpenedTypes.insert(opened.first);
+    for (auto &openedExistential : OpenedExistentialTypes)
+      outerOpenedExistentials.insert(openedExistential.first);
+
+    // Restrictions are recorded by the types they relate. If those types
+    // still depend on the bindings made within a component, there is no
+    // telling an outer restriction from one made in the component.
+    for (auto &restriction : ConstraintRestrictions) {
+      using std::get;
+      Type first = simplifyType(get<0>(restriction));
+      Type second = simplifyType(get<1>(restriction));
+      if (first->hasTypeVariable() || second->hasTypeVariable()) {
+        useComponentCache = false;
+        break;
+      }
+      outerRestrictions.insert({first->getCanonicalType(),
+                                second->getCanonicalType()});
+    }
+  }
+
+  // Remove everything that was decided outside of the given component from
+  // one of its partial solutions.
+  auto removeOuterDecisions = [&](Solution &solution, unsigned component) {
+    SmallVector<TypeVariableType *, 16> outerBindings;
+    for (auto &binding : solution.typeBindings) {
+      if (!outerTypeVars.count(binding.first))
+        continue;
+      auto known = typeVarComponent.find(binding.first);
+      if (known == typeVarComponent.end() || known->second != component)
+        outerBindings.push_back(binding.first);
+    }
+    for (auto typeVar : outerBindings)
+      solution.typeBindings.erase(typeVar);
+
+    for (auto locator : outerOverloads)
+      solution.overloadChoices.erase(locator);
+    for (auto locator : outerDisjunctionChoices)
+      solution.DisjunctionChoices.erase(locator);
+    for (auto locator : outerOpenedTypes)
+      solution.OpenedTypes.erase(locator);
+    for (auto locator : outerOpenedExistentials)
+      solution.OpenedExistentialTypes.erase(locator);
+    for (auto &restriction : outerRestrictions)
+      solution.ConstraintRestrictions.erase(restriction);
+  };
+
+  for (unsigned component : componentOrder) {
     assert(InactiveConstraints.empty() && 
            "Some constraints were not transferred?");
     ++solverState->NumComponentsSplit;
@@ -1397,15 +1510,51 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
 
       TypeVariables.push_back(typeVar);
     }
-    
+
+    // The outcome of solving this component only depends on its constraints,
+    // its type variables and their current bindings, as long as the scores
+    // used to prune solutions are the same.
+    std::vector<void *> cacheKey;
+    SolverState::CachedComponent *cached = nullptr;
+    if (useComponentCache) {
+      for (auto &constraint : InactiveConstraints)
+        cacheKey.push_back(&constraint);
+      cacheKey.push_back(nullptr);
+      for (unsigned i = 0, n = typeVars.size(); i != n; ++i) {
+        if (components[i] != component)
+          continue;
+        cacheKey.push_back(typeVars[i]);
+        cacheKey.push_back(simplifyType(typeVars[i]).getPointer());
+      }
+
+      auto known = solverState->ComponentCache.find(cacheKey);
+      if (known != solverState->ComponentCache.end() &&
+          known->second.CurrentScore == CurrentScore &&
+          isSameScore(known->second.BestScore, solverState->BestScore) &&
+          known->second.HandlingFavoredConstraint == HandlingFavoredConstraint)
+        cached = &known->second;
+    }
+
     // Solve for this component. If it fails, we're done.
     bool failed;
-    if (TC.getLangOpts().DebugConstraintSolver) {
-      auto &log = getASTContext().TypeCheckerDebug->getStream();
-      log.indent(solverState->depth * 2) << "(solving component #" 
-                                         << component << "\n";
-    }
-    {
+    if (cached) {
+      ++solverState->NumComponentsReused;
+      if (TC.getLangOpts().DebugConstraintSolver) {
+        auto &log = getASTContext().TypeCheckerDebug->getStream();
+        log.indent(solverState->depth * 2) << "(reusing component #"
+                                           << component << "\n";
+      }
+
+      failed = cached->Failed;
+      for (auto &solution : cached->Solutions)
+        partialSolutions[component].push_back(copySolution(solution));
+    } else {
+      if (TC.getLangOpts().DebugConstraintSolver) {
+        auto &log = getASTContext().TypeCheckerDebug->getStream();
+        log.indent(solverState->depth * 2) << "(solving component #" 
+                                           << component << "\n";
+      }
+
       // Introduce a scope for this partial solution.
       SolverScope scope(*this);
       llvm::SaveAndRestore<SolverScope *> 
@@ -1415,6 +1564,23 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
                                allowFreeTypeVariables);
     }
 
+    // Remember how this component went, unless we gave up on it.
+    auto cacheComponent = [&] {
+      if (!useComponentCache || cached || getExpressionTooComplex())
+        return;
+
+      auto &entry = solverState->ComponentCache[cacheKey];
+      entry.CurrentScore = CurrentScore;
+      entry.BestScore = PreviousBestScore;
+      entry.HandlingFavoredConstraint = HandlingFavoredConstraint;
+      entry.Failed = failed;
+      entry.Solutions.clear();
+      for (auto &solution : partialSolutions[component]) {
+        entry.Solutions.push_back(copySolution(solution));
+        removeOuterDecisions(entry.Solutions.back(), component);
+      }
+    };
+
     // Put the constraints back into their original bucket.
     auto &bucket = constraintBuckets[component];
     bucket.splice(bucket.end(), InactiveConstraints);
@@ -1425,7 +1591,8 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
         log.indent(solverState->depth * 2) << "failed component #" 
                                            << component << ")\n";
       }
-      
+
+      cacheComponent();
       TypeVariables = std::move(allTypeVariables);
       returnAllConstraints();
       return true;
@@ -1444,9 +1611,12 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     TypeVariables = std::move(allTypeVariables);
 
     // For each of the partial solutions, subtract off the current score.
-    // It doesn't contribute.
-    for (auto &solution : partialSolutions[component])
-      solution.getFixedScore() -= CurrentScore;
+    // It doesn't contribute. Cached solutions already had it subtracted.
+    if (!cached) {
+      for (auto &solution : partialSolutions[component])
+        solution.getFixedScore() -= CurrentScore;
+      cacheComponent();
+    }
 
     // Restore the previous best score.
     solverState->BestScore = PreviousBestScore;
@@ -37,6 +37,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include <cstddef>
 #include <functional>
+#include <map>
+#include <vector>
 
 namespace swift {
 
@@ -1029,6 +1031,26 @@ private:
     /// Refers to the innermost partial solution scope.
     SolverScope *PartialSolutionScope = nullptr;
 
+    /// The outcome of solving a connected component, along with the state
+    /// outside of the component that it depends on.
+    struct CachedComponent {
+      Score CurrentScore;
+      Optional<Score> BestScore;
+      bool HandlingFavoredConstraint;
+
+      /// Whether the component had no solutions.
+      bool Failed;
+
+      /// The partial solutions, which only record what was decided within
+      /// the component.
+      SmallVector<Solution, 4> Solutions;
+    };
+
+    /// Connected components that have already been solved, keyed by their
+    /// constraints, type variables and the current bindings of those type
+    /// variables. Only used with -enable-solver-component-cache.
+    std::map<std::vector<void *>, CachedComponent> ComponentCache;
+
     // Statistics
     #define CS_STATISTIC(Name, Description) unsigned Name = 0;
     #include "ConstraintSolverStats.def"
@@ -21,29 +21,204 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/Stmt.h"
 #include "swift/AST/Expr.h"
+#include "swift/AST/Pattern.h"
 #include "swift/AST/Types.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/raw_ostream.h"
 #include "DerivedConformances.h"
 
 using namespace swift;
 using namespace DerivedConformance;
 
-/// Common preconditions for Equatable and Hashable.
-static bool canDeriveConformance(NominalTypeDecl *type) {
-  // The type must be an enum.
-  // TODO: Structs with Equatable/Hashable/Comparable members
-  auto enumDecl = dyn_cast<EnumDecl>(type);
-  if (!enumDecl)
+/// Common preconditions for Equatable and Hashable: the type must be an enum
+/// whose associated values, or a struct whose stored properties, all conform
+/// to \p protocol. The members which don't are diagnosed.
+static bool canDeriveConformance(TypeChecker &tc, Decl *parentDecl,
+                                 NominalTypeDecl *type,
+                                 ProtocolDecl *protocol) {
+  auto parentDC = cast<DeclContext>(parentDecl);
+  Type selfTy = parentDC->getDeclaredTypeInContext();
+  Type protocolTy = protocol->getDeclaredType();
+
+  bool canDerive = true;
+  auto diagnoseFailure = [&] {
+    if (canDerive)
+      tc.diagnose(parentDecl->getLoc(), diag::type_does_not_conform,
+                  selfTy, protocolTy);
+    canDerive = false;
+  };
+  auto checkMember = [&](ValueDecl *member, Type memberTy, bool isPayload) {
+    // Invalid members have already been diagnosed.
+    if (memberTy->is<ErrorType>()) {
+      canDerive = false;
+      return;
+    }
+    if (tc.conformsToProtocol(memberTy, protocol, parentDC, None))
+      return;
+    diagnoseFailure();
+    tc.diagnose(member->getLoc(),
+                diag::derived_conformance_member_does_not_conform,
+                isPayload, memberTy, protocolTy);
+  };
+
+  if (auto enumDecl = dyn_cast<EnumDecl>(type)) {
+    for (auto elt : enumDecl->getAllElements()) {
+      tc.validateDecl(elt);
+      if (!elt->hasArgumentType())
+        continue;
+
+      Type argTy = ArchetypeBuilder::mapTypeIntoContext(
+          parentDC, elt->getArgumentInterfaceType());
+      if (auto tupleTy = argTy->getAs<TupleType>()) {
+        for (auto &tupleElt : tupleTy->getElements())
+          checkMember(elt, tupleElt.getType(), /*isPayload=*/true);
+      } else {
+        checkMember(elt, argTy, /*isPayload=*/true);
+      }
+    }
+    return canDerive;
+  }
+
+  auto structDecl = dyn_cast<StructDecl>(type);
+  if (!structDecl)
     return false;
-  
-  // The enum must not have associated values.
-  // TODO: Enums with Equatable/Hashable/Comparable payloads
-  if (!enumDecl->hasOnlyCasesWithoutAssociatedValues())
+
+  // The stored properties of a struct may not be accessible from other
+  // modules, nor its layout known.
+  if (parentDecl->getModuleContext() != structDecl->getModuleContext()) {
+    diagnoseFailure();
+    tc.diagnose(parentDecl->getLoc(),
+                diag::derived_conformance_struct_other_module,
+                selfTy, protocolTy);
     return false;
-  
-  return true;
+  }
+
+  for (auto var : structDecl->getStoredProperties()) {
+    tc.validateDecl(var);
+    if (!var->hasType()) {
+      canDerive = false;
+      continue;
+    }
+    checkMember(var, var->getType()->getReferenceStorageReferent(),
+                /*isPayload=*/false);
+  }
+  return canDerive;
+}
+
+/// Looks up the declaration named \p name in the standard library.
+static ValueDecl *lookupStdlibDecl(ASTContext &C, StringRef name) {
+  auto stdlib = C.getStdlibModule();
+  if (!stdlib)
+    return nullptr;
+
+  SmallVector<ValueDecl *, 1> results;
+  stdlib->lookupValue({}, C.getIdentifier(name), NLKind::QualifiedLookup,
+                      results);
+  return results.size() == 1 ? results.front() : nullptr;
+}
+
+/// Returns true if two values of \p structDecl are equal exactly when their
+/// representations are, because its stored properties are all of the same
+/// standard library integer type, which leaves no padding between them.
+static bool isBitwiseComparable(StructDecl *structDecl) {
+  CanType fieldTy;
+  unsigned numFields = 0;
+  for (auto var : structDecl->getStoredProperties()) {
+    CanType ty = var->getType()->getCanonicalType();
+    if (fieldTy && fieldTy != ty)
+      return false;
+    fieldTy = ty;
+    ++numFields;
+  }
+
+  // With a single field there is nothing to gain.
+  if (numFields < 2)
+    return false;
+
+  auto fieldDecl = fieldTy->getStructOrBoundGenericStruct();
+  if (!fieldDecl || !fieldDecl->getModuleContext()->isStdlibModule())
+    return false;
+  return llvm::StringSwitch<bool>(fieldDecl->getName().str())
+    .Cases("Int", "Int8", "Int16", "Int32", "Int64", true)
+    .Cases("UInt", "UInt8", "UInt16", "UInt32", "UInt64", true)
+    .Default(false);
+}
+
+/// Create a pattern matching the case \p elt of an enum which binds each of
+/// its associated values to a new variable, named \p prefix followed by the
+/// value's index.
+/// \p boundVars The variables are appended to this vector.
+static Pattern *
+createPayloadBindingPattern(ASTContext &C, AbstractFunctionDecl *funcDecl,
+                           Type enumType, EnumElementDecl *elt,
+                           StringRef prefix,
+                           SmallVectorImpl<VarDecl *> &boundVars) {
+  auto bindPayload = [&]() -> Pattern * {
+    llvm::SmallString<8> name(prefix);
+    name += llvm::utostr(boundVars.size());
+    auto var = new (C) VarDecl(/*static*/false, /*let*/true, SourceLoc(),
+                               C.getIdentifier(name), Type(), funcDecl);
+    var->setImplicit();
+    boundVars.push_back(var);
+
+    Pattern *namePat = new (C) NamedPattern(var, /*implicit*/true);
+    return new (C) VarPattern(SourceLoc(), /*isLet*/true, namePat,
+                              /*implicit*/true);
+  };
+
+  // generate: (let a0, let a1, ...)
+  Pattern *payloadPat = nullptr;
+  if (elt->hasArgumentType()) {
+    Type argTy = elt->getArgumentInterfaceType();
+    if (auto tupleTy = argTy->getAs<TupleType>()) {
+      SmallVector<TuplePatternElt, 4> elts;
+      for (unsigned i = 0, e = tupleTy->getNumElements(); i != e; ++i)
+        elts.push_back(TuplePatternElt(bindPayload()));
+      payloadPat = TuplePattern::create(C, SourceLoc(), elts, SourceLoc(),
+                                        /*implicit*/true);
+    } else {
+      payloadPat = new (C) ParenPattern(SourceLoc(), bindPayload(),
+                                        SourceLoc(), /*implicit*/true);
+    }
+  }
+
+  // generate: .<Case>(...)
+  auto pat = new (C) EnumElementPattern(TypeLoc::withoutLoc(enumType),
+                                        SourceLoc(), SourceLoc(),
+                                        Identifier(), elt, payloadPat);
+  pat->setImplicit();
+  return pat;
+}
+
+static ReturnStmt *createReturnBool(ASTContext &C, bool value) {
+  auto boolExpr = new (C) BooleanLiteralExpr(value, SourceLoc(),
+                                             /*implicit*/true);
+  return new (C) ReturnStmt(SourceLoc(), boolExpr, /*implicit*/true);
+}
+
+/// Create 'guard _derivedEquals(lhs, rhs) else { return false }'.
+///
+/// The comparison goes through the stdlib's '_derivedEquals', since the '=='
+/// operators visible from the type aren't visible from derived declarations.
+/// Each comparison is its own statement, so that the type checker never has
+/// to solve a long chain of '&&'s.
+static Stmt *createGuardEquals(ASTContext &C, Expr *lhs, Expr *rhs) {
+  auto equalsDecl = lookupStdlibDecl(C, "_derivedEquals");
+  assert(equalsDecl && "should have checked for _derivedEquals");
+
+  auto equalsRef = new (C) DeclRefExpr(equalsDecl, DeclNameLoc(),
+                                       /*implicit*/true);
+  auto args = TupleExpr::createImplicit(C, { lhs, rhs }, { });
+  auto cmpExpr = new (C) CallExpr(equalsRef, args, /*Implicit=*/true);
+
+  auto elseBody = BraceStmt::create(C, SourceLoc(),
+                                    ASTNode(createReturnBool(C, false)),
+                                    SourceLoc());
+  return new (C) GuardStmt(SourceLoc(), cmpExpr, elseBody, /*implicit*/true,
+                           C);
 }
 
 /// Create AST statements which convert from an enum to an Int with a switch.
@@ -166,9 +341,132 @@ static void deriveBodyEquatable_enum_eq(AbstractFunctionDecl *eqDecl) {
   eqDecl->setBody(body);
 }
 
-/// Derive an '==' operator implementation for an enum.
+/// Derive the body for an '==' operator for an enum with associated values.
+static void deriveBodyEquatable_enum_payload_eq(AbstractFunctionDecl *eqDecl) {
+  auto parentDC = eqDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto args = eqDecl->getParameterLists().back();
+  auto aParam = args->get(0);
+  auto bParam = args->get(1);
+
+  Type enumType = aParam->getType();
+  auto enumDecl = cast<EnumDecl>(enumType->getAnyNominal());
+
+  SmallVector<CaseStmt*, 4> cases;
+  for (auto elt : enumDecl->getAllElements()) {
+    // generate: case (.<Case>(let a0, ...), .<Case>(let b0, ...)):
+    SmallVector<VarDecl *, 4> aPayload, bPayload;
+    TuplePatternElt patElts[] = {
+      TuplePatternElt(createPayloadBindingPattern(C, eqDecl, enumType, elt,
+                                                  "a", aPayload)),
+      TuplePatternElt(createPayloadBindingPattern(C, eqDecl, enumType, elt,
+                                                  "b", bPayload)),
+    };
+    auto pat = TuplePattern::create(C, SourceLoc(), patElts, SourceLoc(),
+                                    /*implicit*/true);
+    auto labelItem = CaseLabelItem(/*IsDefault=*/false, pat, SourceLoc(),
+                                   nullptr);
+
+    // generate: guard _derivedEquals(a0, b0) else { return false }
+    //           ...
+    //           return true
+    SmallVector<ASTNode, 4> statements;
+    for (unsigned i = 0, e = aPayload.size(); i != e; ++i) {
+      auto aRef = new (C) DeclRefExpr(aPayload[i], DeclNameLoc(),
+                                      /*implicit*/true);
+      auto bRef = new (C) DeclRefExpr(bPayload[i], DeclNameLoc(),
+                                      /*implicit*/true);
+      statements.push_back(createGuardEquals(C, aRef, bRef));
+    }
+    statements.push_back(createReturnBool(C, true));
+
+    auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                     /*HasBoundDecls=*/!aPayload.empty(),
+                                     SourceLoc(), body));
+  }
+
+  // generate: default: return false
+  if (cases.size() > 1) {
+    auto anyPat = new (C) AnyPattern(SourceLoc());
+    anyPat->setImplicit();
+    auto dfltLabelItem =
+      CaseLabelItem(/*IsDefault=*/true, anyPat, SourceLoc(), nullptr);
+    auto dfltBody = BraceStmt::create(C, SourceLoc(),
+                                      ASTNode(createReturnBool(C, false)),
+                                      SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), dfltLabelItem,
+                                     /*HasBoundDecls=*/false, SourceLoc(),
+                                     dfltBody));
+  }
+
+  // generate: switch (a, b) { }
+  auto aRef = new (C) DeclRefExpr(aParam, DeclNameLoc(), /*implicit*/true);
+  auto bRef = new (C) DeclRefExpr(bParam, DeclNameLoc(), /*implicit*/true);
+  auto abExpr = TupleExpr::createImplicit(C, { aRef, bRef }, { });
+  auto switchStmt = SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), abExpr,
+                                       SourceLoc(), cases, SourceLoc(), C);
+
+  auto body = BraceStmt::create(C, SourceLoc(), ASTNode(switchStmt),
+                                SourceLoc());
+  eqDecl->setBody(body);
+}
+
+/// Derive the body for an '==' operator for a struct.
+static void deriveBodyEquatable_struct_eq(AbstractFunctionDecl *eqDecl) {
+  auto parentDC = eqDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto args = eqDecl->getParameterLists().back();
+  auto aParam = args->get(0);
+  auto bParam = args->get(1);
+
+  auto structDecl = cast<StructDecl>(aParam->getType()->getAnyNominal());
+
+  SmallVector<ASTNode, 8> statements;
+  if (isBitwiseComparable(structDecl)) {
+    // generate: return _isBitwiseEqual(a, b)
+    auto bitwiseEqualDecl = lookupStdlibDecl(C, "_isBitwiseEqual");
+    assert(bitwiseEqualDecl && "should have checked for _isBitwiseEqual");
+
+    auto aRef = new (C) DeclRefExpr(aParam, DeclNameLoc(), /*implicit*/true);
+    auto bRef = new (C) DeclRefExpr(bParam, DeclNameLoc(), /*implicit*/true);
+    auto fnRef = new (C) DeclRefExpr(bitwiseEqualDecl, DeclNameLoc(),
+                                     /*implicit*/true);
+    auto abExpr = TupleExpr::createImplicit(C, { aRef, bRef }, { });
+    auto cmpExpr = new (C) CallExpr(fnRef, abExpr, /*Implicit=*/true);
+    statements.push_back(new (C) ReturnStmt(SourceLoc(), cmpExpr,
+                                            /*implicit*/true));
+  } else {
+    // generate: guard _derivedEquals(a.<field>, b.<field>) else {
+    //             return false
+    //           }
+    //           ...
+    //           return true
+    //
+    // The fields are referenced directly, since they may not be accessible
+    // from the derived declaration.
+    for (auto var : structDecl->getStoredProperties()) {
+      auto aRef = new (C) DeclRefExpr(aParam, DeclNameLoc(), /*implicit*/true);
+      auto bRef = new (C) DeclRefExpr(bParam, DeclNameLoc(), /*implicit*/true);
+      auto aField = new (C) MemberRefExpr(aRef, SourceLoc(), var,
+                                          DeclNameLoc(), /*Implicit=*/true);
+      auto bField = new (C) MemberRefExpr(bRef, SourceLoc(), var,
+                                          DeclNameLoc(), /*Implicit=*/true);
+      statements.push_back(createGuardEquals(C, aField, bField));
+    }
+    statements.push_back(createReturnBool(C, true));
+  }
+
+  auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+  eqDecl->setBody(body);
+}
+
+/// Derive an '==' operator implementation for an enum or a struct.
 static ValueDecl *
-deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
+deriveEquatable_eq(TypeChecker &tc, Decl *parentDecl, NominalTypeDecl *typeDecl,
+                   void (*bodySynthesizer)(AbstractFunctionDecl *)) {
   // enum SomeEnum<T...> {
   //   case A, B, C
   // }
@@ -188,16 +486,47 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   //   }
   //   return index_a == index_b
   // }
+  //
+  // enum SomeEnum<T...> {
+  //   case A(T, Int), B
+  // }
+  // @derived
+  // func ==<T...>(a: SomeEnum<T...>, b: SomeEnum<T...>) -> Bool {
+  //   switch (a, b) {
+  //   case (.A(let a0, let a1), .A(let b0, let b1)):
+  //     guard _derivedEquals(a0, b0) else { return false }
+  //     guard _derivedEquals(a1, b1) else { return false }
+  //     return true
+  //   case (.B, .B):
+  //     return true
+  //   default:
+  //     return false
+  //   }
+  // }
+  //
+  // struct SomeStruct<T...> {
+  //   var x: T
+  //   var y: Int
+  // }
+  // @derived
+  // func ==<T...>(a: SomeStruct<T...>, b: SomeStruct<T...>) -> Bool {
+  //   guard _derivedEquals(a.x, b.x) else { return false }
+  //   guard _derivedEquals(a.y, b.y) else { return false }
+  //   return true
+  // }
+  //
+  // A struct whose stored properties are all integers of the same type is
+  // instead compared with 'return _isBitwiseEqual(a, b)'.
   
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
-  auto enumTy = parentDC->getDeclaredTypeInContext();
+  auto selfTy = parentDC->getDeclaredTypeInContext();
   
   auto getParamDecl = [&](StringRef s) -> ParamDecl* {
     return new (C) ParamDecl(/*isLet*/true, SourceLoc(), SourceLoc(),
                              Identifier(), SourceLoc(), C.getIdentifier(s),
-                             enumTy, parentDC);
+                             selfTy, parentDC);
   };
   
   auto params = ParameterList::create(C, {
@@ -227,14 +556,25 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
                 diag::broken_equatable_eq_operator);
     return nullptr;
   }
-  if (!C.getEqualIntDecl(nullptr)) {
-    tc.diagnose(parentDecl->getLoc(), diag::no_equal_overload_for_int);
-    return nullptr;
+  if (bodySynthesizer == &deriveBodyEquatable_enum_eq) {
+    if (!C.getEqualIntDecl(nullptr)) {
+      tc.diagnose(parentDecl->getLoc(), diag::no_equal_overload_for_int);
+      return nullptr;
+    }
+  } else {
+    for (StringRef helperName : { "_derivedEquals", "_isBitwiseEqual" }) {
+      if (!lookupStdlibDecl(C, helperName)) {
+        tc.diagnose(parentDecl->getLoc(),
+                    diag::broken_stdlib_derived_conformance_support,
+                    helperName);
+        return nullptr;
+      }
+    }
   }
 
   eqDecl->setOperatorDecl(op);
-  eqDecl->setDerivedForTypeDecl(enumDecl);
-  eqDecl->setBodySynthesizer(&deriveBodyEquatable_enum_eq);
+  eqDecl->setDerivedForTypeDecl(typeDecl);
+  eqDecl->setBodySynthesizer(bodySynthesizer);
 
   // Compute the type.
   auto paramsTy = params->getType(C);
@@ -248,9 +588,9 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   // Compute the interface type.
   Type interfaceTy;
   if (auto genericSig = parentDC->getGenericSignatureOfContext()) {
-    auto enumIfaceTy = parentDC->getDeclaredInterfaceType();
+    auto selfIfaceTy = parentDC->getDeclaredInterfaceType();
     TupleTypeElt ifaceParamElts[] = {
-      enumIfaceTy, enumIfaceTy,
+      selfIfaceTy, selfIfaceTy,
     };
     auto ifaceParamsTy = TupleType::get(ifaceParamElts, C);
     
@@ -262,15 +602,15 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   }
   eqDecl->setInterfaceType(interfaceTy);
 
-  // Since we can't insert the == operator into the same FileUnit as the enum,
+  // Since we can't insert the == operator into the same FileUnit as the type
   // itself, we have to give it at least internal access.
-  eqDecl->setAccessibility(std::max(enumDecl->getFormalAccess(),
+  eqDecl->setAccessibility(std::max(typeDecl->getFormalAccess(),
                                     Accessibility::Internal));
 
-  // If the enum was not imported, the derived conformance is either from the
-  // enum itself or an extension, in which case we will emit the declaration
+  // If the type was not imported, the derived conformance is either from the
+  // type itself or an extension, in which case we will emit the declaration
   // normally.
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.Context.addExternalDecl(eqDecl);
   
   // Since it's an operator we insert the decl after the type at global scope.
@@ -284,15 +624,21 @@ ValueDecl *DerivedConformance::deriveEquatable(TypeChecker &tc,
                                                NominalTypeDecl *type,
                                                ValueDecl *requirement) {
   // Check that we can actually derive Equatable for this type.
-  if (!canDeriveConformance(type))
+  auto protocol = tc.Context.getProtocol(KnownProtocolKind::Equatable);
+  if (!canDeriveConformance(tc, parentDecl, type, protocol))
     return nullptr;
 
   // Build the necessary decl.
   if (requirement->getName().str() == "==") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveEquatable_enum_eq(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
+    if (auto theEnum = dyn_cast<EnumDecl>(type)) {
+      if (theEnum->hasOnlyCasesWithoutAssociatedValues())
+        return deriveEquatable_eq(tc, parentDecl, theEnum,
+                                  &deriveBodyEquatable_enum_eq);
+      return deriveEquatable_eq(tc, parentDecl, theEnum,
+                                &deriveBodyEquatable_enum_payload_eq);
+    }
+    return deriveEquatable_eq(tc, parentDecl, type,
+                              &deriveBodyEquatable_struct_eq);
   }
   tc.diagnose(requirement->getLoc(),
               diag::broken_equatable_requirement);
@@ -322,10 +668,157 @@ deriveBodyHashable_enum_hashValue(AbstractFunctionDecl *hashValueDecl) {
   hashValueDecl->setBody(body);
 }
 
-/// Derive a 'hashValue' implementation for an enum.
+/// Create 'var hasher = _Hasher()' in a derived 'hashValue' getter.
+/// \p stmts The generated statement is appended to this vector.
+/// \return The hasher variable.
+static VarDecl *createHasher(SmallVectorImpl<ASTNode> &stmts,
+                             AbstractFunctionDecl *getterDecl) {
+  ASTContext &C = getterDecl->getASTContext();
+  auto hasherDecl = dyn_cast_or_null<NominalTypeDecl>(
+      lookupStdlibDecl(C, "_Hasher"));
+  assert(hasherDecl && "should have checked for _Hasher");
+
+  auto hasherVar = new (C) VarDecl(/*static*/false, /*let*/false,
+                                   SourceLoc(), C.getIdentifier("hasher"),
+                                   Type(), getterDecl);
+  hasherVar->setImplicit();
+
+  auto hasherTypeExpr = TypeExpr::createImplicit(hasherDecl->getDeclaredType(),
+                                                 C);
+  auto noArgs = TupleExpr::createEmpty(C, SourceLoc(), SourceLoc(),
+                                       /*Implicit=*/true);
+  auto initExpr = new (C) CallExpr(hasherTypeExpr, noArgs, /*Implicit=*/true);
+
+  Pattern *hasherPat = new (C) NamedPattern(hasherVar, /*implicit*/true);
+  auto hasherBind = PatternBindingDecl::create(C, SourceLoc(),
+                                               StaticSpellingKind::None,
+                                               SourceLoc(), hasherPat,
+                                               initExpr, getterDecl);
+  hasherBind->setImplicit();
+
+  stmts.push_back(hasherBind);
+  return hasherVar;
+}
+
+/// Create a call to the method \p name of the hasher \p hasherVar, passing
+/// \p arg, if any.
+static Expr *createHasherCall(ASTContext &C, VarDecl *hasherVar,
+                              StringRef name, Expr *arg) {
+  auto hasherRef = new (C) DeclRefExpr(hasherVar, DeclNameLoc(),
+                                       /*implicit*/true);
+  auto fnExpr = new (C) UnresolvedDotExpr(hasherRef, SourceLoc(),
+                                          C.getIdentifier(name),
+                                          DeclNameLoc(), /*implicit*/true);
+  Expr *argExpr;
+  if (arg) {
+    argExpr = new (C) ParenExpr(SourceLoc(), arg, SourceLoc(),
+                                /*hasTrailingClosure*/false);
+    argExpr->setImplicit();
+  } else {
+    argExpr = TupleExpr::createEmpty(C, SourceLoc(), SourceLoc(),
+                                     /*Implicit=*/true);
+  }
+  return new (C) CallExpr(fnExpr, argExpr, /*Implicit=*/true);
+}
+
+/// Create 'return hasher.finalize()'.
+static ReturnStmt *createReturnHash(ASTContext &C, VarDecl *hasherVar) {
+  auto finalizeExpr = createHasherCall(C, hasherVar, "finalize", nullptr);
+  return new (C) ReturnStmt(SourceLoc(), finalizeExpr, /*implicit*/true);
+}
+
+static void
+deriveBodyHashable_enum_payload_hashValue(AbstractFunctionDecl *hashValueDecl) {
+  auto parentDC = hashValueDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto enumDecl = parentDC->getAsEnumOrEnumExtensionContext();
+  Type enumType = parentDC->getDeclaredTypeInContext();
+  SmallVector<ASTNode, 3> statements;
+  VarDecl *hasherVar = createHasher(statements, hashValueDecl);
+
+  unsigned index = 0;
+  SmallVector<CaseStmt*, 4> cases;
+  for (auto elt : enumDecl->getAllElements()) {
+    // generate: case .<Case>(let a0, ...):
+    SmallVector<VarDecl *, 4> payload;
+    auto pat = createPayloadBindingPattern(C, hashValueDecl, enumType, elt,
+                                           "a", payload);
+    auto labelItem = CaseLabelItem(/*IsDefault=*/false, pat, SourceLoc(),
+                                   nullptr);
+
+    // generate: hasher.append(<index>)
+    //           hasher.append(a0)
+    //           ...
+    SmallVector<ASTNode, 4> caseStatements;
+    llvm::SmallString<8> indexVal;
+    APInt(32, index++).toString(indexVal, 10, /*signed*/ false);
+    auto indexStr = C.AllocateCopy(indexVal);
+    auto indexExpr = new (C) IntegerLiteralExpr(StringRef(indexStr.data(),
+                                                indexStr.size()), SourceLoc(),
+                                                /*implicit*/ true);
+    caseStatements.push_back(createHasherCall(C, hasherVar, "append",
+                                              indexExpr));
+    for (auto var : payload) {
+      auto varRef = new (C) DeclRefExpr(var, DeclNameLoc(), /*implicit*/true);
+      caseStatements.push_back(createHasherCall(C, hasherVar, "append",
+                                                varRef));
+    }
+
+    auto body = BraceStmt::create(C, SourceLoc(), caseStatements,
+                                  SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                     /*HasBoundDecls=*/!payload.empty(),
+                                     SourceLoc(), body));
+  }
+
+  // generate: switch self { }
+  auto selfRef = createSelfDeclRef(hashValueDecl);
+  auto switchStmt = SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), selfRef,
+                                       SourceLoc(), cases, SourceLoc(), C);
+  statements.push_back(switchStmt);
+  statements.push_back(createReturnHash(C, hasherVar));
+
+  auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+  hashValueDecl->setBody(body);
+}
+
+static void
+deriveBodyHashable_struct_hashValue(AbstractFunctionDecl *hashValueDecl) {
+  auto parentDC = hashValueDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto structDecl = cast<StructDecl>(
+      parentDC->getAsNominalTypeOrNominalTypeExtensionContext());
+  SmallVector<ASTNode, 8> statements;
+  VarDecl *hasherVar = createHasher(statements, hashValueDecl);
+
+  if (isBitwiseComparable(structDecl)) {
+    // generate: hasher._appendBitPattern(self)
+    auto selfRef = createSelfDeclRef(hashValueDecl);
+    statements.push_back(createHasherCall(C, hasherVar, "_appendBitPattern",
+                                          selfRef));
+  } else {
+    // generate: hasher.append(self.<field>)
+    //           ...
+    for (auto var : structDecl->getStoredProperties()) {
+      auto selfRef = createSelfDeclRef(hashValueDecl);
+      auto field = new (C) MemberRefExpr(selfRef, SourceLoc(), var,
+                                         DeclNameLoc(), /*Implicit=*/true);
+      statements.push_back(createHasherCall(C, hasherVar, "append", field));
+    }
+  }
+  statements.push_back(createReturnHash(C, hasherVar));
+
+  auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+  hashValueDecl->setBody(body);
+}
+
+/// Derive a 'hashValue' implementation for an enum or a struct.
 static ValueDecl *
-deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
-                              EnumDecl *enumDecl) {
+deriveHashable_hashValue(TypeChecker &tc, Decl *parentDecl,
+                         NominalTypeDecl *typeDecl,
+                         void (*bodySynthesizer)(AbstractFunctionDecl *)) {
   // enum SomeEnum {
   //   case A, B, C
   //   @derived var hashValue: Int {
@@ -341,6 +834,36 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   //     return index.hashValue
   //   }
   // }
+  //
+  // enum SomeEnum {
+  //   case A(Int, String), B
+  //   @derived var hashValue: Int {
+  //     var hasher = _Hasher()
+  //     switch self {
+  //     case A(let a0, let a1):
+  //       hasher.append(0)
+  //       hasher.append(a0)
+  //       hasher.append(a1)
+  //     case B:
+  //       hasher.append(1)
+  //     }
+  //     return hasher.finalize()
+  //   }
+  // }
+  //
+  // struct SomeStruct {
+  //   var x: Int
+  //   var y: String
+  //   @derived var hashValue: Int {
+  //     var hasher = _Hasher()
+  //     hasher.append(self.x)
+  //     hasher.append(self.y)
+  //     return hasher.finalize()
+  //   }
+  // }
+  //
+  // A struct whose stored properties are all integers of the same type is
+  // instead hashed with 'hasher._appendBitPattern(self)'.
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
@@ -349,18 +872,25 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   // We can't form a Hashable conformance if Int isn't Hashable or
   // IntegerLiteralConvertible.
   if (!tc.conformsToProtocol(intType,C.getProtocol(KnownProtocolKind::Hashable),
-                             enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(), diag::broken_int_hashable_conformance);
+                             typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(), diag::broken_int_hashable_conformance);
     return nullptr;
   }
 
   ProtocolDecl *intLiteralProto =
       C.getProtocol(KnownProtocolKind::IntegerLiteralConvertible);
-  if (!tc.conformsToProtocol(intType, intLiteralProto, enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(),
+  if (!tc.conformsToProtocol(intType, intLiteralProto, typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(),
                 diag::broken_int_integer_literal_convertible_conformance);
     return nullptr;
   }
+
+  if (bodySynthesizer != &deriveBodyHashable_enum_hashValue &&
+      !dyn_cast_or_null<NominalTypeDecl>(lookupStdlibDecl(C, "_Hasher"))) {
+    tc.diagnose(parentDecl->getLoc(),
+                diag::broken_stdlib_derived_conformance_support, "_Hasher");
+    return nullptr;
+  }
   
   auto selfDecl = ParamDecl::createUnboundSelf(SourceLoc(), parentDC);
   
@@ -378,7 +908,7 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
                        /*GenericParams=*/nullptr, params,
                        Type(), TypeLoc::withoutLoc(intType), parentDC);
   getterDecl->setImplicit();
-  getterDecl->setBodySynthesizer(deriveBodyHashable_enum_hashValue);
+  getterDecl->setBodySynthesizer(bodySynthesizer);
 
   // Compute the type of hashValue().
   GenericParamList *genericParams = getterDecl->getGenericParamsOfContext();
@@ -404,12 +934,12 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
     interfaceType = FunctionType::get(selfType, methodType);
   
   getterDecl->setInterfaceType(interfaceType);
-  getterDecl->setAccessibility(enumDecl->getFormalAccess());
+  getterDecl->setAccessibility(typeDecl->getFormalAccess());
 
-  // If the enum was not imported, the derived conformance is either from the
-  // enum itself or an extension, in which case we will emit the declaration
+  // If the type was not imported, the derived conformance is either from the
+  // type itself or an extension, in which case we will emit the declaration
   // normally.
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.Context.addExternalDecl(getterDecl);
   
   // Create the property.
@@ -420,7 +950,7 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   hashValueDecl->setImplicit();
   hashValueDecl->makeComputed(SourceLoc(), getterDecl,
                               nullptr, nullptr, SourceLoc());
-  hashValueDecl->setAccessibility(enumDecl->getFormalAccess());
+  hashValueDecl->setAccessibility(typeDecl->getFormalAccess());
 
   Pattern *hashValuePat = new (C) NamedPattern(hashValueDecl, /*implicit*/true);
   hashValuePat->setType(intType);
@@ -447,15 +977,21 @@ ValueDecl *DerivedConformance::deriveHashable(TypeChecker &tc,
                                               NominalTypeDecl *type,
                                               ValueDecl *requirement) {
   // Check that we can actually derive Hashable for this type.
-  if (!canDeriveConformance(type))
+  auto protocol = tc.Context.getProtocol(KnownProtocolKind::Hashable);
+  if (!canDeriveConformance(tc, parentDecl, type, protocol))
     return nullptr;
   
   // Build the necessary decl.
   if (requirement->getName().str() == "hashValue") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveHashable_enum_hashValue(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
+    if (auto theEnum = dyn_cast<EnumDecl>(type)) {
+      if (theEnum->hasOnlyCasesWithoutAssociatedValues())
+        return deriveHashable_hashValue(tc, parentDecl, theEnum,
+                                        &deriveBodyHashable_enum_hashValue);
+      return deriveHashable_hashValue(
+          tc, parentDecl, theEnum, &deriveBodyHashable_enum_payload_hashValue);
+    }
+    return deriveHashable_hashValue(tc, parentDecl, type,
+                                    &deriveBodyHashable_struct_hashValue);
   }
   tc.diagnose(requirement->getLoc(),
               diag::broken_hashable_requirement);
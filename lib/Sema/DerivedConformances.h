@@ -66,9 +66,8 @@ Type deriveRawRepresentable(TypeChecker &tc,
 
 /// Derive an Equatable requirement for a type.
 ///
-/// Currently this is only implemented for enums without associated values.
-/// Obvious generalizations would be to enums with all-Hashable payloads and to
-/// structs with all-Hashable stored properties.
+/// This is implemented for enums whose associated values, if any, are all
+/// Equatable, and for structs whose stored properties are all Equatable.
 ///
 /// \returns the derived member, which will also be added to the type.
 ValueDecl *deriveEquatable(TypeChecker &tc,
@@ -78,9 +77,8 @@ ValueDecl *deriveEquatable(TypeChecker &tc,
   
 /// Derive a Hashable requirement for a type.
 ///
-/// Currently this is only implemented for enums without associated values.
-/// Obvious generalizations would be to enums with all-Hashable payloads and to
-/// structs with all-Hashable stored properties.
+/// This is implemented for enums whose associated values, if any, are all
+/// Hashable, and for structs whose stored properties are all Hashable.
 ///
 /// \returns the derived member, which will also be added to the type.
 ValueDecl *deriveHashable(TypeChecker &tc,
@@ -21,8 +21,39 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/Basic/Defer.h"
+#include "swift/Basic/Statistic.h"
+#include "llvm/Support/Timer.h"
 using namespace swift;
 
+/// The name under which the time spent on requests of the given kind is
+/// recorded.
+static StringRef getRequestTimerName(TypeCheckRequest::Kind kind) {
+  switch (kind) {
+#define TYPE_CHECK_REQUEST(Request,PayloadName) \
+  case TypeCheckRequest::Request:               \
+    return "TypeCheckRequest." #Request;
+
+#include "swift/Sema/TypeCheckRequestKinds.def"
+  }
+}
+
+/// Counts a request, and whether it was already satisfied.
+static void countRequest(UnifiedStatsReporter &stats,
+                         TypeCheckRequest::Kind kind, bool satisfied) {
+  auto &counters = stats.getFrontendCounters();
+  switch (kind) {
+#define TYPE_CHECK_REQUEST(Request,PayloadName)           \
+  case TypeCheckRequest::Request:                         \
+    if (satisfied)                                        \
+      ++counters.Request##RequestsAlreadySatisfied;       \
+    else                                                  \
+      ++counters.Request##RequestsProcessed;              \
+    return;
+
+#include "swift/Sema/TypeCheckRequestKinds.def"
+  }
+}
+
 ASTContext &IterativeTypeChecker::getASTContext() const {
   return TC.Context;
 }
@@ -67,7 +98,25 @@ bool IterativeTypeChecker::breakCycle(TypeCheckRequest request) {
 
 void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
   // If the request has already been satisfied, we're done.
-  if (isSatisfied(request)) return;
+  auto *stats = getASTContext().Stats;
+  bool satisfied = isSatisfied(request);
+  if (stats)
+    countRequest(*stats, request.getKind(), satisfied);
+  if (satisfied) return;
+
+  // Record the time spent on this request, including the requests it
+  // depends on.
+  llvm::TimeRecord startTime;
+  if (stats)
+    startTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+  defer {
+    if (stats) {
+      llvm::TimeRecord elapsed =
+        llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+      elapsed -= startTime;
+      stats->recordTime(getRequestTimerName(request.getKind()), elapsed);
+    }
+  };
 
   // Check for circular dependencies in our requests.
   // FIXME: This stack operation is painfully inefficient.
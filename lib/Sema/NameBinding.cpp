@@ -301,6 +301,18 @@ void swift::performNameBinding(SourceFile &SF, unsigned StartElem) {
 
   SmallVector<std::pair<ImportedModule, ImportOptions>, 8> ImportedModules;
 
+  // Let the module loaders read all of the imported modules at once, rather
+  // than one at a time as each import is bound.
+  SmallVector<Identifier, 8> ImportedModuleNames;
+  for (auto D : llvm::makeArrayRef(SF.Decls).slice(StartElem)) {
+    if (auto *ID = dyn_cast<ImportDecl>(D)) {
+      Identifier Name = ID->getModulePath().front().first;
+      if (Name != SF.getParentModule()->getName())
+        ImportedModuleNames.push_back(Name);
+    }
+  }
+  SF.getASTContext().prefetchModules(ImportedModuleNames);
+
   // Do a prepass over the declarations to find and load the imported modules
   // and map operator decls.
   for (auto D : llvm::makeArrayRef(SF.Decls).slice(StartElem)) {
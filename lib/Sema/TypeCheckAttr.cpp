@@ -57,6 +57,7 @@ public:
   IGNORED_ATTR(FixedLayout)
   IGNORED_ATTR(Infix)
   IGNORED_ATTR(Inline)
+  IGNORED_ATTR(Inlineable)
   IGNORED_ATTR(NSApplicationMain)
   IGNORED_ATTR(NSCopying)
   IGNORED_ATTR(NoReturn)
@@ -694,6 +695,7 @@ public:
 
   void visitWarnUnusedResultAttr(WarnUnusedResultAttr *attr);
   void visitSpecializeAttr(SpecializeAttr *attr);
+  void visitInlineableAttr(InlineableAttr *attr);
 };
 } // end anonymous namespace
 
@@ -1255,6 +1257,30 @@ void AttributeChecker::visitRethrowsAttr(RethrowsAttr *attr) {
   attr->setInvalid();
 }
 
+void AttributeChecker::visitInlineableAttr(InlineableAttr *attr) {
+  // The body is serialized, so it must be callable from other modules, and
+  // there must be exactly one body to call.
+  auto *VD = cast<ValueDecl>(D);
+  if (isa<ProtocolDecl>(D->getDeclContext())) {
+    TC.diagnose(attr->getLocation(),
+                diag::inlineable_in_protocols_not_supported);
+    attr->setInvalid();
+    return;
+  }
+
+  if (VD->getAttrs().hasAttribute<DynamicAttr>()) {
+    TC.diagnose(attr->getLocation(), diag::inlineable_dynamic_not_supported);
+    attr->setInvalid();
+    return;
+  }
+
+  if (VD->getEffectiveAccess() != Accessibility::Public) {
+    TC.diagnose(attr->getLocation(), diag::inlineable_decl_not_public);
+    attr->setInvalid();
+    return;
+  }
+}
+
 bool AttributeChecker::visitAbstractAccessibilityAttr(
     AbstractAccessibilityAttr *attr) {
   DeclContext *dc = D->getDeclContext();
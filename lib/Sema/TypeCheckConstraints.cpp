@@ -37,6 +37,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1342,6 +1343,25 @@ namespace {
   };
 }
 
+namespace {
+  /// Used for debugging which expressions are taking a long time to
+  /// type-check.
+  class ExpressionTimer {
+    TypeChecker &TC;
+    SourceLoc Loc;
+    llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+
+  public:
+    ExpressionTimer(TypeChecker &tc, Expr *E) : TC(tc), Loc(E->getLoc()) {}
+
+    ~ExpressionTimer() {
+      llvm::TimeRecord endTime = llvm::TimeRecord::getCurrentTime(false);
+      auto elapsed = endTime.getProcessTime() - StartTime.getProcessTime();
+      TC.recordExpressionTime(Loc, elapsed * 1000);
+    }
+  };
+}
+
 #pragma mark High-level entry points
 bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       TypeLoc convertType,
@@ -1350,6 +1370,13 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       ExprTypeCheckListener *listener) {
   PrettyStackTraceExpr stackTrace(Context, "type-checking", expr);
 
+  Optional<ExpressionTimer> timer;
+  if ((DebugTimeExpressions || WarnLongExpressionTypeChecking) &&
+      !IsTimingExpression)
+    timer.emplace(*this, expr);
+  llvm::SaveAndRestore<bool> timing(IsTimingExpression,
+                                    IsTimingExpression || timer.hasValue());
+
   // Construct a constraint system from this expression.
   ConstraintSystemOptions csOptions = ConstraintSystemFlags::AllowFixes;
   if (options.contains(TypeCheckExprFlags::PreferForceUnwrapToOptional))
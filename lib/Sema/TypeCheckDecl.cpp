@@ -36,6 +36,7 @@
 #include "swift/Serialization/SerializedModuleLoader.h"
 #include "swift/Strings.h"
 #include "swift/Basic/Defer.h"
+#include "swift/Basic/Statistic.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/APSInt.h"
@@ -5464,6 +5465,7 @@ public:
     UNINTERESTING_ATTR(SetterAccessibility)
     UNINTERESTING_ATTR(UIApplicationMain)
     UNINTERESTING_ATTR(Versioned)
+    UNINTERESTING_ATTR(Inlineable)
     UNINTERESTING_ATTR(ObjCNonLazyRealization)
     UNINTERESTING_ATTR(UnsafeNoObjCTaggedPointer)
     UNINTERESTING_ATTR(SwiftNativeObjCRuntimeBase)
@@ -6519,6 +6521,13 @@ void TypeChecker::checkDeclCircularity(NominalTypeDecl *decl) {
 }
 
 void TypeChecker::validateDecl(ValueDecl *D, bool resolveTypeParams) {
+  if (auto *stats = Context.Stats) {
+    auto &counters = stats->getFrontendCounters();
+    ++counters.NumValidateDeclCalls;
+    if (D->hasType())
+      ++counters.NumValidateDeclCallsAlreadyTyped;
+  }
+
   if (hasEnabledForbiddenTypecheckPrefix())
     checkForForbiddenPrefix(D);
 
@@ -39,6 +39,8 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 
 using namespace swift;
@@ -54,6 +56,19 @@ TypeChecker::TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags)
 }
 
 TypeChecker::~TypeChecker() {
+  if (DebugTimeExpressions) {
+    std::stable_sort(ExpressionTimes.begin(), ExpressionTimes.end(),
+                     [](const std::pair<double, SourceLoc> &lhs,
+                        const std::pair<double, SourceLoc> &rhs) {
+      return lhs.first > rhs.first;
+    });
+    for (auto &entry : ExpressionTimes) {
+      llvm::errs() << llvm::format("%0.1f", entry.first) << "ms\t";
+      entry.second.print(llvm::errs(), Context.SourceMgr);
+      llvm::errs() << "\n";
+    }
+  }
+
   auto clangImporter =
     static_cast<ClangImporter *>(Context.getClangModuleLoader());
   clangImporter->clearTypeResolver();
@@ -61,6 +76,18 @@ TypeChecker::~TypeChecker() {
   Context.setLazyResolver(nullptr);
 }
 
+void TypeChecker::recordExpressionTime(SourceLoc loc, double elapsedMS) {
+  if (DebugTimeExpressions)
+    ExpressionTimes.push_back({elapsedMS, loc});
+
+  unsigned roundedMS = static_cast<unsigned>(elapsedMS);
+  if (WarnLongExpressionTypeChecking != 0 &&
+      roundedMS >= WarnLongExpressionTypeChecking) {
+    diagnose(loc, diag::debug_long_expression, roundedMS,
+             WarnLongExpressionTypeChecking);
+  }
+}
+
 void TypeChecker::handleExternalDecl(Decl *decl) {
   if (auto SD = dyn_cast<StructDecl>(decl)) {
     addImplicitConstructors(SD);
@@ -537,7 +564,8 @@ void swift::typeCheckExternalDefinitions(SourceFile &SF) {
 void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                                 OptionSet<TypeCheckingFlags> Options,
                                 unsigned StartElem,
-                                unsigned WarnLongFunctionBodies) {
+                                unsigned WarnLongFunctionBodies,
+                                unsigned WarnLongExpressionTypeChecking) {
   if (SF.ASTStage == SourceFile::TypeChecked)
     return;
 
@@ -559,6 +587,10 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
 
+    TC.setWarnLongExpressionTypeChecking(WarnLongExpressionTypeChecking);
+    if (Options.contains(TypeCheckingFlags::DebugTimeExpressions))
+      TC.enableDebugTimeExpressions();
+
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
     
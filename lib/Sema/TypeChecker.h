@@ -541,6 +541,14 @@ private:
   /// The set of expressions currently being analyzed for failures.
   llvm::DenseMap<Expr*, Expr*> DiagnosedExprs;
 
+  /// The number of subexpressions re-type-checked while diagnosing the
+  /// outermost expression that failed to type-check.
+  unsigned NumDiagnosisRechecks = 0;
+
+  /// The depth of nested failure diagnoses. Re-type-checking a subexpression
+  /// which fails diagnoses it from within the diagnosis of its parent.
+  unsigned DiagnosisDepth = 0;
+
   Module *StdlibModule = nullptr;
 
   /// The index of the next response metavariable to bind to a REPL result.
@@ -556,6 +564,25 @@ private:
   /// to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If non-zero, warn when type-checking an expression takes longer than
+  /// this many milliseconds.
+  ///
+  /// Intended for debugging purposes only.
+  unsigned WarnLongExpressionTypeChecking = 0;
+
+  /// If true, the time it takes to type-check each expression is recorded,
+  /// and dumped to llvm::errs() (slowest first) when the type checker is
+  /// destroyed.
+  bool DebugTimeExpressions = false;
+
+  /// The time taken to type-check each expression, in milliseconds, along with
+  /// its location. Only filled in if DebugTimeExpressions is set.
+  std::vector<std::pair<double, SourceLoc>> ExpressionTimes;
+
+  /// Whether an expression is currently being timed. Expressions checked
+  /// while checking another one are counted as part of the outer expression.
+  bool IsTimingExpression = false;
+
   /// Indicate that the type checker is checking code that will be
   /// immediately executed. This will suppress certain warnings
   /// when executing scripts.
@@ -586,6 +613,24 @@ public:
     WarnLongFunctionBodies = timeInMS;
   }
 
+  /// Dump the time it takes to type-check each expression to llvm::errs(),
+  /// slowest first, when the type checker is destroyed.
+  void enableDebugTimeExpressions() {
+    DebugTimeExpressions = true;
+  }
+
+  /// If \p timeInMS is non-zero, warn when an expression takes longer than
+  /// this many milliseconds to type-check.
+  ///
+  /// Intended for debugging purposes only.
+  void setWarnLongExpressionTypeChecking(unsigned timeInMS) {
+    WarnLongExpressionTypeChecking = timeInMS;
+  }
+
+  /// Records that the expression at \p loc took \p elapsedMS milliseconds to
+  /// type-check.
+  void recordExpressionTime(SourceLoc loc, double elapsedMS);
+
   bool getInImmediateMode() {
     return InImmediateMode;
   }
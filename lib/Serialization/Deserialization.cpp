@@ -16,6 +16,7 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
@@ -1824,6 +1825,9 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   if (declOrOffset.isComplete())
     return declOrOffset;
 
+  if (auto *Stats = getContext().Stats)
+    ++Stats->getFrontendCounters().NumDeclsDeserialized;
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(declOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -2335,6 +2339,8 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theStruct, rawInheritedIDs);
 
     theStruct->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    if (DeclMembersByName)
+      LazyMemberContextIDs[theStruct] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theStruct->setConformanceLoader(
       this,
@@ -2927,6 +2933,8 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theClass, rawInheritedIDs);
 
     theClass->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    if (DeclMembersByName)
+      LazyMemberContextIDs[theClass] = DID;
     theClass->setHasDestructor();
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theClass->setConformanceLoader(
@@ -2994,6 +3002,8 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     handleInherited(theEnum, rawInheritedIDs);
 
     theEnum->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    if (DeclMembersByName)
+      LazyMemberContextIDs[theEnum] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     theEnum->setConformanceLoader(
       this,
@@ -3189,6 +3199,8 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
     }
 
     extension->setMemberLoader(this, DeclTypeCursor.GetCurrentBitNo());
+    if (DeclMembersByName)
+      LazyMemberContextIDs[extension] = DID;
     skipRecord(DeclTypeCursor, decls_block::MEMBERS);
     extension->setConformanceLoader(
       this,
@@ -3361,6 +3373,9 @@ Type ModuleFile::getType(TypeID TID) {
   if (typeOrOffset.isComplete())
     return typeOrOffset;
 
+  if (auto *Stats = getContext().Stats)
+    ++Stats->getFrontendCounters().NumTypesDeserialized;
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(typeOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -4089,6 +4104,8 @@ Type ModuleFile::getType(TypeID TID) {
 
 void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   PrettyStackTraceDecl trace("loading members for", D);
+  if (auto *Stats = getContext().Stats)
+    ++Stats->getFrontendCounters().NumMemberListsLoaded;
 
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(contextData);
@@ -4103,6 +4120,9 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   else
     IDC = cast<ExtensionDecl>(D);
 
+  // Any members that were already loaded by name are the same decls, and are
+  // only now being added to the context.
+  LazyMemberContextIDs.erase(D);
   for (auto member : members)
     IDC->addMember(member);
 
@@ -4113,6 +4133,31 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+Optional<TinyPtrVector<ValueDecl *>>
+ModuleFile::loadNamedMembers(const Decl *D, Identifier N,
+                             uint64_t contextData) {
+  auto knownID = LazyMemberContextIDs.find(D);
+  if (knownID == LazyMemberContextIDs.end())
+    return None;
+
+  PrettyStackTraceDecl trace("loading members named", D);
+  if (auto *Stats = getContext().Stats)
+    ++Stats->getFrontendCounters().NumNamedMemberLookups;
+
+  TinyPtrVector<ValueDecl *> results;
+  auto iter = DeclMembersByName->find({knownID->second, N.str()});
+  if (iter == DeclMembersByName->end())
+    return results;
+
+  for (DeclID memberID : *iter) {
+    auto *member = dyn_cast_or_null<ValueDecl>(getDecl(memberID));
+    if (!member)
+      return None;
+    results.push_back(member);
+  }
+  return results;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
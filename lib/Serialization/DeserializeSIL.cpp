@@ -379,13 +379,13 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   DeclID clangNodeOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, inferredEffect, numSpecAttrs, numInsts;
   ArrayRef<uint64_t> SemanticsIDs;
   // TODO: read fragile
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangNodeOwnerID,
-                                SemanticsIDs);
+                                inferredEffect, numSpecAttrs, numInsts,
+                                funcTyID, clangNodeOwnerID, SemanticsIDs);
 
   if (funcTyID == 0) {
     DEBUG(llvm::dbgs() << "SILFunction typeID is 0.\n");
@@ -460,6 +460,9 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   assert(fn->empty() &&
          "SILFunction to be deserialized starts being empty.");
 
+  fn->setInferredEffectsKind((EffectsKind)inferredEffect);
+  fn->setSerializedBodySize(numInsts);
+
   fn->setBare(IsBare);
   if (!fn->hasLocation()) fn->setLocation(loc);
 
@@ -662,7 +665,8 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   SILBuilder Builder(BB);
   Builder.setCurrentDebugScope(Fn->getDebugScope());
   unsigned OpCode = 0, TyCategory = 0, TyCategory2 = 0, TyCategory3 = 0,
-           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0;
+           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0,
+           IsOnStack = 0;
   ValueID ValID, ValID2, ValID3;
   TypeID TyID, TyID2, TyID3;
   TypeID ConcreteTyID;
@@ -726,6 +730,10 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
     case SIL_PARTIAL_APPLY:
       OpCode = (unsigned)ValueKind::PartialApplyInst;
       break;
+    case SIL_PARTIAL_APPLY_ON_STACK:
+      OpCode = (unsigned)ValueKind::PartialApplyInst;
+      IsOnStack = true;
+      break;
     case SIL_BUILTIN:
       OpCode = (unsigned)ValueKind::BuiltinInst;
       break;
@@ -1031,7 +1039,7 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
     ResultVal = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
                                            Substitutions, Args,
-                                           closureTy);
+                                           closureTy, IsOnStack != 0);
     break;
   }
   case ValueKind::BuiltinInst: {
@@ -1854,12 +1862,12 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   DeclID clangOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, inferredEffect, numSpecAttrs, numInsts;
   ArrayRef<uint64_t> SemanticsIDs;
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangOwnerID,
-                                SemanticsIDs);
+                                inferredEffect, numSpecAttrs, numInsts,
+                                funcTyID, clangOwnerID, SemanticsIDs);
   auto linkage = fromStableSILLinkage(rawLinkage);
   if (!linkage) {
     DEBUG(llvm::dbgs() << "invalid linkage code " << rawLinkage
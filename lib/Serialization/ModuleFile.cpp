@@ -114,6 +114,9 @@ static bool readOptionsBlock(llvm::BitstreamCursor &cursor,
       options_block::ResilienceStrategyLayout::readRecord(scratch, Strategy);
       extendedInfo.setResilienceStrategy(ResilienceStrategy(Strategy));
       break;
+    case options_block::RESILIENCE_DOMAIN:
+      extendedInfo.setResilienceDomain(blobData);
+      break;
     default:
       // Unknown options record, possibly for use by a future version of the
       // module format.
@@ -204,6 +207,9 @@ validateControlBlock(llvm::BitstreamCursor &cursor,
     case control_block::TARGET:
       result.targetTriple = blobData;
       break;
+    case control_block::INTERFACE_HASH:
+      result.interfaceHash = blobData;
+      break;
     default:
       // Unknown metadata record, possibly for use by a future version of the
       // module format.
@@ -377,6 +383,50 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk table of members by name.
+class ModuleFile::DeclMemberTableInfo {
+public:
+  using internal_key_type = std::pair<uint32_t, StringRef>;
+  using external_key_type = internal_key_type;
+  using data_type = SmallVector<DeclID, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type key) {
+    return key;
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.second, key.first);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint32_t contextID = endian::readNext<uint32_t, little, unaligned>(data);
+    return { contextID, StringRef(reinterpret_cast<const char *>(data),
+                                  length - sizeof(uint32_t)) };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      result.push_back(endian::readNext<uint32_t, little, unaligned>(data));
+      length -= sizeof(uint32_t);
+    }
+    return result;
+  }
+};
+
 std::unique_ptr<ModuleFile::SerializedDeclTable>
 ModuleFile::readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
   uint32_t tableOffset;
@@ -388,6 +438,18 @@ ModuleFile::readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                                 base + sizeof(uint32_t), base));
 }
 
+std::unique_ptr<ModuleFile::SerializedDeclMemberTable>
+ModuleFile::readDeclMemberTable(ArrayRef<uint64_t> fields,
+                                StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberTable>;
+  return OwnedTable(SerializedDeclMemberTable::Create(base + tableOffset,
+    base + sizeof(uint32_t), base));
+}
+
 std::unique_ptr<ModuleFile::SerializedLocalDeclTable>
 ModuleFile::readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
   uint32_t tableOffset;
@@ -516,6 +578,9 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
       case index_block::OPERATOR_METHODS:
         OperatorMethodDecls = readDeclTable(scratch, blobData);
         break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMembersByName = readDeclMemberTable(scratch, blobData);
+        break;
       case index_block::OBJC_METHODS:
         ObjCMethods = readObjCMethodTable(scratch, blobData);
         break;
@@ -787,6 +852,7 @@ ModuleFile::ModuleFile(
       }
       Name = info.name;
       TargetTriple = info.targetTriple;
+      InterfaceHash = info.interfaceHash;
 
       hasValidControlBlock = true;
       break;
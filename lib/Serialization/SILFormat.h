@@ -246,7 +246,9 @@ namespace sil_block {
                      BCFixed<1>, // global_init
                      BCFixed<2>, // inlineStrategy
                      BCFixed<2>, // side effect info.
+                     BCFixed<2>, // inferred side effect info
                      BCFixed<2>, // number of specialize attributes
+                     BCVBR<8>,   // number of instructions in the body
                      TypeIDField,// SILFunctionType
                      DeclIDField,// ClangNode owner
                      BCArray<IdentifierIDField> // Semantics Attribute
@@ -330,7 +332,8 @@ namespace sil_block {
     SIL_PARTIAL_APPLY,
     SIL_BUILTIN,
     SIL_TRY_APPLY,
-    SIL_NON_THROWING_APPLY
+    SIL_NON_THROWING_APPLY,
+    SIL_PARTIAL_APPLY_ON_STACK
   };
   
   using SILInstApplyLayout = BCRecordLayout<
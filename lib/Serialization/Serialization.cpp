@@ -29,7 +29,9 @@
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
 
 #include "clang/Basic/Module.h"
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -50,6 +52,8 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <functional>
+#include <thread>
 #include <vector>
 
 using namespace swift;
@@ -108,6 +112,46 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk table of members by name.
+  class DeclMemberTableInfo {
+  public:
+    using key_type = std::pair<uint32_t, Identifier>;
+    using key_type_ref = const key_type &;
+    using data_type = Serializer::DeclMemberTableData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.second.empty());
+      return llvm::HashString(key.second.str(), key.first);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint32_t) + key.second.str().size();
+      uint32_t dataLength = sizeof(uint32_t) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint32_t>(key.first);
+      out << key.second.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data)
+        writer.write<uint32_t>(entry);
+    }
+  };
+
   class LocalDeclTableInfo {
   public:
     using key_type = std::string;
@@ -434,6 +478,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(control_block, METADATA);
   BLOCK_RECORD(control_block, MODULE_NAME);
   BLOCK_RECORD(control_block, TARGET);
+  BLOCK_RECORD(control_block, INTERFACE_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   BLOCK_RECORD(options_block, SDK_PATH);
@@ -441,6 +486,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(options_block, IS_SIB);
   BLOCK_RECORD(options_block, IS_TESTABLE);
   BLOCK_RECORD(options_block, RESILIENCE_STRATEGY);
+  BLOCK_RECORD(options_block, RESILIENCE_DOMAIN);
 
   BLOCK(INPUT_BLOCK);
   BLOCK_RECORD(input_block, IMPORTED_MODULE);
@@ -472,6 +518,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, DECL_CONTEXT_OFFSETS);
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
+  BLOCK_RECORD(index_block, DECL_MEMBER_NAMES);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -564,7 +611,67 @@ void Serializer::writeDocBlockInfoBlock() {
 #undef BLOCK_RECORD
 }
 
-void Serializer::writeHeader(const SerializationOptions &options) {
+/// Computes a hash of everything in \p DC which the clients of the module
+/// depend on: the interface tokens of its source files (those outside of
+/// function bodies), and the SIL of the functions whose bodies can be inlined
+/// into clients.
+///
+/// \returns false if some part of the module can't be hashed.
+static bool computeInterfaceHash(ModuleOrSourceFile DC, const SILModule *SILMod,
+                                 const SerializationOptions &options,
+                                 SmallVectorImpl<char> &result) {
+  // Every function body is inlinable.
+  if (options.SerializeAllSIL)
+    return false;
+
+  llvm::MD5 hash;
+  auto hashFile = [&](FileUnit *file) -> bool {
+    SmallString<32> fileHash;
+    if (auto *SF = dyn_cast<SourceFile>(file)) {
+      SF->getInterfaceHash(fileHash);
+    } else if (auto *ASTFile = dyn_cast<SerializedASTFile>(file)) {
+      // Partial modules being merged.
+      fileHash = ASTFile->getInterfaceHash();
+      if (fileHash.empty())
+        return false;
+    } else {
+      return false;
+    }
+    hash.update(fileHash);
+    return true;
+  };
+
+  if (auto *SF = DC.dyn_cast<SourceFile *>()) {
+    if (!hashFile(SF))
+      return false;
+  } else {
+    for (FileUnit *file : DC.get<Module *>()->getFiles())
+      if (!hashFile(file))
+        return false;
+  }
+
+  if (SILMod) {
+    SmallString<256> printedBody;
+    for (const SILFunction &F : *SILMod) {
+      if (F.isExternalDeclaration() || !F.isFragile())
+        continue;
+      printedBody.clear();
+      llvm::raw_svector_ostream out(printedBody);
+      F.print(out);
+      hash.update(out.str());
+    }
+  }
+
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  SmallString<32> hashStr;
+  llvm::MD5::stringifyResult(hashBuf, hashStr);
+  result.assign(hashStr.begin(), hashStr.end());
+  return true;
+}
+
+void Serializer::writeHeader(const SerializationOptions &options,
+                             const SILModule *SILMod) {
   {
     BCBlockRAII restoreBlock(Out, CONTROL_BLOCK_ID, 3);
     control_block::ModuleNameLayout ModuleName(Out);
@@ -584,6 +691,13 @@ void Serializer::writeHeader(const SerializationOptions &options) {
 
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
+    SmallString<32> interfaceHash;
+    if (computeInterfaceHash(SF ? ModuleOrSourceFile(SF) : M, SILMod, options,
+                             interfaceHash)) {
+      control_block::InterfaceHashLayout InterfaceHash(Out);
+      InterfaceHash.emit(ScratchRecord, interfaceHash);
+    }
+
     {
       llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
 
@@ -600,6 +714,11 @@ void Serializer::writeHeader(const SerializationOptions &options) {
         Strategy.emit(ScratchRecord, unsigned(M->getResilienceStrategy()));
       }
 
+      if (!M->getResilienceDomain().empty()) {
+        options_block::ResilienceDomainLayout Domain(Out);
+        Domain.emit(ScratchRecord, M->getResilienceDomain().str());
+      }
+
       if (options.SerializeOptionsForDebugging) {
         options_block::SDKPathLayout SDKPath(Out);
         options_block::XCCLayout XCC(Out);
@@ -1247,9 +1366,14 @@ static bool shouldSerializeMember(Decl *D) {
   }
 }
 
-void Serializer::writeMembers(DeclRange members, bool isClass) {
+void Serializer::writeMembers(const Decl *parent, DeclRange members,
+                              bool isClass) {
   using namespace decls_block;
 
+  // Protocols always load all of their members along with their default
+  // witness table, so there's no point in indexing them.
+  DeclID parentID = isa<ProtocolDecl>(parent) ? 0 : addDeclRef(parent);
+
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
   SmallVector<DeclID, 16> memberIDs;
   for (auto member : members) {
@@ -1259,6 +1383,13 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (parentID != 0) {
+      if (auto VD = dyn_cast<ValueDecl>(member)) {
+        if (VD->hasName())
+          DeclMembersByName[{parentID, VD->getName()}].push_back(memberID);
+      }
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -2103,7 +2234,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(extension->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(extension->getGenericRequirements());
-    writeMembers(extension->getMembers(), isClassExtension);
+    writeMembers(extension, extension->getMembers(), isClassExtension);
     writeConformances(conformances, DeclTypeAbbrCodes);
 
     break;
@@ -2282,7 +2413,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theStruct->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theStruct->getGenericRequirements());
-    writeMembers(theStruct->getMembers(), false);
+    writeMembers(theStruct, theStruct->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2316,7 +2447,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theEnum->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theEnum->getGenericRequirements());
-    writeMembers(theEnum->getMembers(), false);
+    writeMembers(theEnum, theEnum->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2353,7 +2484,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theClass->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theClass->getGenericRequirements());
-    writeMembers(theClass->getMembers(), true);
+    writeMembers(theClass, theClass->getMembers(), true);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2389,7 +2520,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(proto->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(proto->getGenericRequirements());
-    writeMembers(proto->getMembers(), true);
+    writeMembers(proto, proto->getMembers(), true);
     writeDefaultWitnessTable(proto, DeclTypeAbbrCodes);
     break;
   }
@@ -3406,45 +3537,49 @@ void Serializer::writeOffsets(const index_block::OffsetsLayout &Offsets,
   Offsets.emit(ScratchRecord, getOffsetRecordCode(values), values);
 }
 
-/// Writes an in-memory decl table to an on-disk representation, using the
-/// given layout.
-static void writeDeclTable(const index_block::DeclListLayout &DeclList,
-                           index_block::RecordKind kind,
-                           const Serializer::DeclTable &table) {
-  if (table.empty())
-    return;
+namespace {
+/// An on-disk hash table, built in memory so that it can be emitted as the
+/// blob of a record.
+struct HashTableBlob {
+  llvm::SmallString<4096> Data;
+  uint32_t Offset = 0;
+};
+} // end anonymous namespace
 
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
-    for (auto &entry : table)
-      generator.insert(entry.first, entry.second);
+/// Builds an on-disk hash table from the entries of \p generator.
+template <typename Info>
+static void emitHashTable(HashTableBlob &blob,
+                          llvm::OnDiskChainedHashTableGenerator<Info> &generator) {
+  llvm::raw_svector_ostream blobStream(blob.Data);
+  // Make sure that no bucket is at offset 0
+  endian::Writer<little>(blobStream).write<uint32_t>(0);
+  blob.Offset = generator.Emit(blobStream);
+}
 
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+/// Builds the on-disk representation of an in-memory decl table.
+///
+/// This only reads \p table, so tables can be built concurrently.
+template <typename Info, typename Table>
+static void buildDeclTable(HashTableBlob &blob, const Table &table) {
+  if (table.empty())
+    return;
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  llvm::OnDiskChainedHashTableGenerator<Info> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  emitHashTable(blob, generator);
 }
 
-static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
-                                index_block::RecordKind kind,
-                                LocalTypeHashTableGenerator &generator) {
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+/// Writes an on-disk decl table built by buildDeclTable, using the given
+/// layout.
+static void writeDeclTable(const index_block::DeclListLayout &DeclList,
+                           index_block::RecordKind kind,
+                           const HashTableBlob &blob) {
+  if (blob.Data.empty())
+    return;
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  SmallVector<uint64_t, 8> scratch;
+  DeclList.emit(scratch, kind, blob.Offset, blob.Data);
 }
 
 namespace {
@@ -3866,7 +4001,7 @@ namespace {
   };
 } // end anonymous namespace
 
-static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
+static void buildObjCMethodTable(HashTableBlob &blob,
                                  Serializer::ObjCMethodTable &objcMethods) {
   // Collect all of the Objective-C selectors in the method table.
   std::vector<ObjCSelector> selectors;
@@ -3879,21 +4014,10 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
 
   // Create the on-disk hash table.
   llvm::OnDiskChainedHashTableGenerator<ObjCMethodTableInfo> generator;
-  llvm::SmallString<32> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    for (auto selector : selectors) {
-      generator.insert(selector, objcMethods[selector]);
-    }
-
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
+  for (auto selector : selectors) {
+    generator.insert(selector, objcMethods[selector]);
   }
-
-  SmallVector<uint64_t, 8> scratch;
-  out.emit(scratch, tableOffset, hashTableBlob);
+  emitHashTable(blob, generator);
 }
 
 /// Add operator methods from the given declaration type.
@@ -3954,6 +4078,10 @@ static void addOperatorsAndTopLevel(Serializer &S, Range members,
   }
 }
 
+/// The number of lookup table entries above which the tables are built on
+/// separate threads. Below it, the cost of starting the threads dominates.
+static const size_t ParallelLookupTableThreshold = 4096;
+
 void Serializer::writeAST(ModuleOrSourceFile DC) {
   DeclTable topLevelDecls, extensionDecls, operatorDecls, operatorMethodDecls;
   ObjCMethodTable objcMethods;
@@ -4040,6 +4168,47 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
   writeAllDeclsAndTypes();
   writeAllIdentifiers();
 
+  // All decl IDs have been assigned, so the on-disk lookup tables can now
+  // be built. Each builder only reads its own table and the records are
+  // emitted below in a fixed order, so the output doesn't depend on how the
+  // builders are scheduled.
+  HashTableBlob topLevelBlob, operatorBlob, extensionBlob, classMemberBlob,
+                operatorMethodBlob, declMemberBlob, localTypeBlob,
+                objcMethodBlob;
+  std::function<void()> tableBuilders[] = {
+    [&]{ buildDeclTable<DeclTableInfo>(topLevelBlob, topLevelDecls); },
+    [&]{ buildDeclTable<DeclTableInfo>(operatorBlob, operatorDecls); },
+    [&]{ buildDeclTable<DeclTableInfo>(extensionBlob, extensionDecls); },
+    [&]{ buildDeclTable<DeclTableInfo>(classMemberBlob, ClassMembersByName); },
+    [&]{
+      buildDeclTable<DeclTableInfo>(operatorMethodBlob, operatorMethodDecls);
+    },
+    [&]{
+      buildDeclTable<DeclMemberTableInfo>(declMemberBlob, DeclMembersByName);
+    },
+    [&]{
+      if (hasLocalTypes)
+        emitHashTable(localTypeBlob, localTypeGenerator);
+    },
+    [&]{ buildObjCMethodTable(objcMethodBlob, objcMethods); },
+  };
+
+  size_t numTableEntries = topLevelDecls.size() + operatorDecls.size() +
+    extensionDecls.size() + ClassMembersByName.size() +
+    operatorMethodDecls.size() + DeclMembersByName.size() +
+    objcMethods.size();
+  if (numTableEntries < ParallelLookupTableThreshold) {
+    for (auto &builder : tableBuilders)
+      builder();
+  } else {
+    SharedTimer timer("Serialization (lookup tables)");
+    std::vector<std::thread> threads;
+    for (auto &builder : tableBuilders)
+      threads.push_back(std::thread(builder));
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
   {
     BCBlockRAII restoreBlock(Out, INDEX_BLOCK_ID, 4);
 
@@ -4052,17 +4221,19 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeOffsets(Offsets, NormalConformanceOffsets);
 
     index_block::DeclListLayout DeclList(Out);
-    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelDecls);
-    writeDeclTable(DeclList, index_block::OPERATORS, operatorDecls);
-    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
-    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
-    writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
+    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelBlob);
+    writeDeclTable(DeclList, index_block::OPERATORS, operatorBlob);
+    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionBlob);
+    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, classMemberBlob);
+    writeDeclTable(DeclList, index_block::OPERATOR_METHODS,
+                   operatorMethodBlob);
+    writeDeclTable(DeclList, index_block::DECL_MEMBER_NAMES, declMemberBlob);
     if (hasLocalTypes)
-      writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
-                          localTypeGenerator);
+      writeDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS, localTypeBlob);
 
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
-    writeObjCMethodTable(ObjCMethodTable, objcMethods);
+    SmallVector<uint64_t, 8> scratch;
+    ObjCMethodTable.emit(scratch, objcMethodBlob.Offset, objcMethodBlob.Data);
 
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
@@ -4097,7 +4268,7 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
 
   {
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
-    S.writeHeader(options);
+    S.writeHeader(options, SILMod);
     S.writeInputBlock(options);
     S.writeSIL(SILMod, options.SerializeAllSIL);
     S.writeAST(DC);
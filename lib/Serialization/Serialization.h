@@ -123,12 +123,25 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  using DeclMemberTableData = SmallVector<DeclID, 2>;
+
+  /// The in-memory representation of what will eventually be an on-disk hash
+  /// table from (context decl ID, member base name) to the members with that
+  /// name.
+  using DeclMemberTable =
+    llvm::MapVector<std::pair<uint32_t, Identifier>, DeclMemberTableData>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// The members of each nominal type and extension, by name.
+  ///
+  /// This lets clients look up a member without deserializing the others.
+  DeclMemberTable DeclMembersByName;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -227,7 +240,11 @@ private:
 
   /// Writes the Swift module file header and name, plus metadata determining
   /// if the module can be loaded.
-  void writeHeader(const SerializationOptions &options = {});
+  ///
+  /// \p SILMod is the SIL which will be serialized, if any, whose inlinable
+  /// function bodies are part of the module's interface hash.
+  void writeHeader(const SerializationOptions &options = {},
+                   const SILModule *SILMod = nullptr);
 
   /// Writes the Swift doc module file header and name.
   void writeDocHeader();
@@ -254,10 +271,11 @@ private:
 
   /// Writes an array of members for a decl context.
   ///
+  /// \param parent The nominal type or extension the members belong to
   /// \param members The decls within the context
   /// \param isClass True if the context could be a class context (class,
   ///        class extension, or protocol).
-  void writeMembers(DeclRange members, bool isClass);
+  void writeMembers(const Decl *parent, DeclRange members, bool isClass);
 
   /// Write a default witness table for a protocol.
   ///
@@ -351,12 +351,21 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     clangNodeOwnerID = S.addDeclRef(F.getClangNodeOwner());
 
   unsigned numSpecAttrs = NoBody ? 0 : F.getSpecializeAttrs().size();
+
+  // Record the size of the body up front so that clients can decide whether
+  // they want it without deserializing it.
+  unsigned numInsts = 0;
+  if (!NoBody)
+    for (const SILBasicBlock &BB : F)
+      numInsts += std::distance(BB.begin(), BB.end());
+
   SILFunctionLayout::emitRecord(
       Out, ScratchRecord, abbrCode, toStableSILLinkage(Linkage),
       (unsigned)F.isTransparent(), (unsigned)F.isFragile(),
       (unsigned)F.isThunk(), (unsigned)F.isGlobalInit(),
       (unsigned)F.getInlineStrategy(), (unsigned)F.getEffectsKind(),
-      (unsigned)numSpecAttrs, FnID, clangNodeOwnerID, SemanticsIDs);
+      (unsigned)F.getInferredEffectsKind(), (unsigned)numSpecAttrs, numInsts, FnID, clangNodeOwnerID,
+      SemanticsIDs);
 
   if (NoBody)
     return;
@@ -764,7 +773,8 @@ void SILSerializer::writeSILInstruction(const SILInstruction &SI) {
       Args.push_back(addValueRef(Arg));
     }
     SILInstApplyLayout::emitRecord(Out, ScratchRecord,
-        SILAbbrCodes[SILInstApplyLayout::Code], SIL_PARTIAL_APPLY,
+        SILAbbrCodes[SILInstApplyLayout::Code],
+        PAI->canAllocOnStack() ? SIL_PARTIAL_APPLY_ON_STACK : SIL_PARTIAL_APPLY,
         PAI->getSubstitutions().size(),
         S.addTypeRef(PAI->getCallee()->getType().getSwiftRValueType()),
         S.addTypeRef(PAI->getSubstCalleeType()),
@@ -17,12 +17,20 @@
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Version.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/LineIterator.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <system_error>
+#include <thread>
 
 using namespace swift;
 
@@ -30,10 +38,49 @@ namespace {
 typedef std::pair<Identifier, SourceLoc> AccessPathElem;
 } // end unnamed namespace
 
+struct SerializedModuleLoader::PrefetchedModule {
+  std::unique_ptr<ModuleFile> File;
+  serialization::ValidationInfo LoadInfo;
+  serialization::ExtendedValidationInfo ExtendedInfo;
+  std::string ModuleBufferID;
+  std::string ModuleDocBufferID;
+
+  /// The number of search paths there were when the module was found.
+  ///
+  /// Loading a module can add search paths, which might change where a later
+  /// import is found.
+  size_t NumSearchPaths = 0;
+};
+
+/// Reads the listing written by the driver: each directory on a line of its
+/// own, followed by the names of its entries, each indented by a tab.
+static void
+readSearchPathListing(StringRef path,
+                      llvm::StringMap<llvm::StringSet<>> &listing) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return;
+
+  llvm::StringSet<> *entries = nullptr;
+  for (llvm::line_iterator line(*buffer.get(), /*SkipBlanks=*/true), end;
+       line != end; ++line) {
+    if (line->startswith("\t")) {
+      if (entries)
+        entries->insert(line->drop_front());
+    } else {
+      entries = &listing[*line];
+    }
+  }
+}
+
 // Defined out-of-line so that we can see ~ModuleFile.
 SerializedModuleLoader::SerializedModuleLoader(ASTContext &ctx,
                                                DependencyTracker *tracker)
-  : ModuleLoader(tracker), Ctx(ctx) {}
+  : ModuleLoader(tracker), Ctx(ctx) {
+  if (!ctx.SearchPathOpts.SearchPathListingPath.empty())
+    readSearchPathListing(ctx.SearchPathOpts.SearchPathListingPath,
+                          SearchPathListing);
+}
 SerializedModuleLoader::~SerializedModuleLoader() = default;
 
 static std::error_code
@@ -42,12 +89,19 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 std::unique_ptr<llvm::MemoryBuffer> &ModuleBuffer,
                 std::unique_ptr<llvm::MemoryBuffer> &ModuleDocBuffer,
                 llvm::SmallVectorImpl<char> &Scratch) {
+  // Module files are only ever read through the bitstream reader, which
+  // doesn't need a null terminator. Not asking for one means large files are
+  // always mapped read-only instead of being copied onto the heap, so all the
+  // frontend jobs in a build that import a module share the same pages.
+
   // Try to open the module file first.  If we fail, don't even look for the
   // module documentation file.
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +110,9 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -67,16 +123,38 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   return std::error_code();
 }
 
+static size_t getNumSearchPaths(const ASTContext &ctx) {
+  return ctx.SearchPathOpts.ImportSearchPaths.size() +
+         ctx.SearchPathOpts.FrameworkSearchPaths.size();
+}
+
+/// Returns false if \p listing says there is no \p entry in \p directory.
+///
+/// Directories which aren't in the listing, such as search paths added while
+/// importing, may contain anything.
+static bool
+mayContain(const llvm::StringMap<llvm::StringSet<>> &listing,
+           StringRef directory, StringRef entry) {
+  auto found = listing.find(directory);
+  return found == listing.end() || found->getValue().count(entry);
+}
+
+/// Looks for the module named \p moduleName in the search paths.
+///
+/// This only reads from \p ctx and \p listing, so it can be called from any
+/// thread as long as the search paths aren't being changed.
 static std::error_code
-findModule(ASTContext &ctx, AccessPathElem moduleID,
+findModule(const ASTContext &ctx,
+           const llvm::StringMap<llvm::StringSet<>> &listing,
+           StringRef moduleName,
            std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
            std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
            bool &isFramework) {
-  llvm::SmallString<64> moduleFilename(moduleID.first.str());
+  llvm::SmallString<64> moduleFilename(moduleName);
   moduleFilename += '.';
   moduleFilename += SERIALIZED_MODULE_EXTENSION;
 
-  llvm::SmallString<64> moduleDocFilename(moduleID.first.str());
+  llvm::SmallString<64> moduleDocFilename(moduleName);
   moduleDocFilename += '.';
   moduleDocFilename += SERIALIZED_MODULE_DOC_EXTENSION;
 
@@ -98,6 +176,8 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
 
   isFramework = false;
   for (auto path : ctx.SearchPathOpts.ImportSearchPaths) {
+    if (!mayContain(listing, path, moduleFilename))
+      continue;
     auto err = openModuleFiles(path,
                                moduleFilename.str(), moduleDocFilename.str(),
                                moduleBuffer, moduleDocBuffer,
@@ -115,11 +195,13 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
   }
 
   {
-    llvm::SmallString<64> moduleFramework(moduleID.first.str());
+    llvm::SmallString<64> moduleFramework(moduleName);
     moduleFramework += ".framework";
     isFramework = true;
 
     for (auto path : ctx.SearchPathOpts.FrameworkSearchPaths) {
+      if (!mayContain(listing, path, moduleFramework))
+        continue;
       currPath = path;
       llvm::sys::path::append(currPath, moduleFramework.str(),
                               "Modules", moduleFilename.str());
@@ -150,29 +232,41 @@ FileUnit *SerializedModuleLoader::loadAST(
     bool isFramework) {
   assert(moduleInputBuffer);
 
-  const char *moduleBufferID = moduleInputBuffer->getBufferIdentifier();
-  const char *moduleDocBufferID = nullptr;
-  if (moduleDocInputBuffer)
-    moduleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
-
   if (moduleInputBuffer->getBufferSize() % 4 != 0) {
     if (diagLoc)
       Ctx.Diags.diagnose(*diagLoc, diag::serialization_malformed_module,
-                         moduleBufferID);
+                         moduleInputBuffer->getBufferIdentifier());
     return nullptr;
   }
 
-  serialization::ExtendedValidationInfo extendedInfo;
-  std::unique_ptr<ModuleFile> loadedModuleFile;
-  serialization::ValidationInfo loadInfo =
-      ModuleFile::load(std::move(moduleInputBuffer),
-                       std::move(moduleDocInputBuffer),
-                       isFramework, loadedModuleFile,
-                       &extendedInfo);
+  PrefetchedModule moduleFile;
+  moduleFile.ModuleBufferID = moduleInputBuffer->getBufferIdentifier();
+  if (moduleDocInputBuffer)
+    moduleFile.ModuleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
+  moduleFile.LoadInfo = ModuleFile::load(std::move(moduleInputBuffer),
+                                         std::move(moduleDocInputBuffer),
+                                         isFramework, moduleFile.File,
+                                         &moduleFile.ExtendedInfo);
+  return loadAST(M, diagLoc, moduleFile);
+}
+
+FileUnit *SerializedModuleLoader::loadAST(Module &M,
+                                          Optional<SourceLoc> diagLoc,
+                                          PrefetchedModule &moduleFile) {
+  StringRef moduleBufferID = moduleFile.ModuleBufferID;
+  StringRef moduleDocBufferID = moduleFile.ModuleDocBufferID;
+  std::unique_ptr<ModuleFile> &loadedModuleFile = moduleFile.File;
+  serialization::ValidationInfo &loadInfo = moduleFile.LoadInfo;
+  const serialization::ExtendedValidationInfo &extendedInfo =
+      moduleFile.ExtendedInfo;
+
   if (loadInfo.status == serialization::Status::Valid) {
     Ctx.bumpGeneration();
 
     M.setResilienceStrategy(extendedInfo.getResilienceStrategy());
+    if (!extendedInfo.getResilienceDomain().empty())
+      M.setResilienceDomain(
+          Ctx.getIdentifier(extendedInfo.getResilienceDomain()));
 
     // We've loaded the file. Now try to bring it into the AST.
     auto fileUnit = new (Ctx) SerializedASTFile(M, *loadedModuleFile,
@@ -236,9 +330,9 @@ FileUnit *SerializedModuleLoader::loadAST(
     break;
 
   case serialization::Status::MalformedDocumentation:
-    assert(moduleDocBufferID);
+    assert(!moduleDocBufferID.empty());
     Ctx.Diags.diagnose(*diagLoc, diag::serialization_malformed_module,
-                       moduleDocBufferID ? moduleDocBufferID : "");
+                       moduleDocBufferID);
     break;
 
   case serialization::Status::MissingDependency: {
@@ -376,9 +470,31 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
     }
   }
 
+  // Then see if we've already read it.
+  if (!moduleInputBuffer) {
+    auto prefetchedIter = PrefetchedModules.find(moduleID.first.str());
+    if (prefetchedIter != PrefetchedModules.end()) {
+      std::unique_ptr<PrefetchedModule> prefetched =
+        std::move(prefetchedIter->second);
+      PrefetchedModules.erase(prefetchedIter);
+
+      if (prefetched->NumSearchPaths == getNumSearchPaths(Ctx)) {
+        addDependency(prefetched->ModuleBufferID);
+
+        auto M = Module::create(moduleID.first, Ctx);
+        Ctx.LoadedModules[moduleID.first] = M;
+        if (!loadAST(*M, moduleID.second, *prefetched))
+          M->setFailedToLoad();
+        return M;
+      }
+    }
+  }
+
   // Otherwise look on disk.
   if (!moduleInputBuffer) {
-    if (std::error_code err = findModule(Ctx, moduleID, moduleInputBuffer,
+    if (std::error_code err = findModule(Ctx, SearchPathListing,
+                                         moduleID.first.str(),
+                                         moduleInputBuffer,
                                          moduleDocInputBuffer,
                                          isFramework)) {
       if (err != std::errc::no_such_file_or_directory) {
@@ -405,6 +521,105 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
   return M;
 }
 
+std::unique_ptr<SerializedModuleLoader::PrefetchedModule>
+SerializedModuleLoader::prefetchModule(StringRef moduleName) const {
+  std::unique_ptr<llvm::MemoryBuffer> moduleInputBuffer;
+  std::unique_ptr<llvm::MemoryBuffer> moduleDocInputBuffer;
+  bool isFramework = false;
+  if (findModule(Ctx, SearchPathListing, moduleName, moduleInputBuffer,
+                 moduleDocInputBuffer, isFramework))
+    return nullptr;
+  if (moduleInputBuffer->getBufferSize() % 4 != 0)
+    return nullptr;
+
+  std::unique_ptr<PrefetchedModule> result(new PrefetchedModule());
+  result->ModuleBufferID = moduleInputBuffer->getBufferIdentifier();
+  if (moduleDocInputBuffer)
+    result->ModuleDocBufferID = moduleDocInputBuffer->getBufferIdentifier();
+  result->NumSearchPaths = getNumSearchPaths(Ctx);
+  result->LoadInfo = ModuleFile::load(std::move(moduleInputBuffer),
+                                      std::move(moduleDocInputBuffer),
+                                      isFramework, result->File,
+                                      &result->ExtendedInfo);
+  return result;
+}
+
+void SerializedModuleLoader::prefetchModules(ArrayRef<Identifier> names) {
+  // The most threads to read module files on, including this one. Reading is
+  // mostly waiting on the file system, so more than this doesn't help.
+  const unsigned MaxPrefetchThreads = 8;
+
+  // Everything the worker threads look at is set up here, so that they never
+  // touch the ASTContext.
+  std::mutex mutex;
+  std::condition_variable workChanged;
+  std::vector<std::string> worklist;
+  llvm::StringSet<> seen;
+  unsigned numBusy = 0;
+  unsigned numPrefetched = 0;
+
+  for (auto &loaded : Ctx.LoadedModules)
+    seen.insert(loaded.first.str());
+  for (auto &registered : MemoryBuffers)
+    seen.insert(registered.getKey());
+  for (auto &prefetched : PrefetchedModules)
+    seen.insert(prefetched.getKey());
+
+  for (Identifier name : names)
+    if (seen.insert(name.str()).second)
+      worklist.push_back(name.str());
+  if (worklist.empty())
+    return;
+
+  auto work = [&] {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      workChanged.wait(lock, [&] { return !worklist.empty() || numBusy == 0; });
+      if (worklist.empty())
+        return;
+
+      std::string name = std::move(worklist.back());
+      worklist.pop_back();
+      ++numBusy;
+      lock.unlock();
+
+      std::unique_ptr<PrefetchedModule> result = prefetchModule(name);
+
+      lock.lock();
+      --numBusy;
+      if (result) {
+        // The dependencies will almost certainly be imported too.
+        for (const ModuleFile::Dependency &dependency :
+               result->File->getDependencies()) {
+          if (dependency.isHeader())
+            continue;
+          StringRef dependencyName = dependency.RawPath.split('\0').first;
+          if (!dependencyName.empty() && seen.insert(dependencyName).second)
+            worklist.push_back(dependencyName);
+        }
+        PrefetchedModules[name] = std::move(result);
+        ++numPrefetched;
+      }
+      workChanged.notify_all();
+    }
+  };
+
+  unsigned numThreads = 1;
+  if (llvm::llvm_is_multithreaded())
+    numThreads = std::max(1u, std::min(std::thread::hardware_concurrency(),
+                                       MaxPrefetchThreads));
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < numThreads; ++i)
+    threads.push_back(std::thread(work));
+  work();
+  for (std::thread &thread : threads)
+    thread.join();
+
+  if (Ctx.Stats)
+    Ctx.Stats->getFrontendCounters().NumModuleFilesPrefetched += numPrefetched;
+}
+
 void SerializedModuleLoader::loadExtensions(NominalTypeDecl *nominal,
                                             unsigned previousGeneration) {
   for (auto &modulePair : LoadedModuleFiles) {
@@ -467,6 +682,10 @@ void SerializedASTFile::collectLinkLibraries(
   }
 }
 
+StringRef SerializedASTFile::getInterfaceHash() const {
+  return File.getInterfaceHash();
+}
+
 bool SerializedASTFile::isSystemModule() const {
   if (auto Mod = File.getShadowedModule()) {
     return Mod->isSystemModule();
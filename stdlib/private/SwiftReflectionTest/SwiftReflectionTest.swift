@@ -29,6 +29,7 @@ let RequestSymbolAddress = "s"
 let RequestStringLength = "l"
 let RequestDone = "d"
 let RequestPointerSize = "p"
+let RequestHeapBlocks = "h"
 
 internal func debugLog(_ message: String) {
 #if DEBUG_LOG
@@ -43,6 +44,7 @@ public enum InstanceKind : UInt8 {
   case Existential
   case ErrorExistential
   case Closure
+  case HeapCensus
 }
 
 /// Represents a section in a loaded image in this process.
@@ -251,6 +253,19 @@ internal func sendPointerSize() {
   sendValue(pointerSize)
 }
 
+/// The addresses and sizes of the blocks whose census the parent is taking.
+internal var heapBlocks: [(address: UInt, size: UInt)] = []
+
+/// Send the blocks whose census the parent is taking.
+internal func sendHeapBlocks() {
+  debugLog("BEGIN \(#function)"); defer { debugLog("END \(#function)") }
+  sendValue(UInt(heapBlocks.count))
+  for block in heapBlocks {
+    sendValue(block.address)
+    sendValue(block.size)
+  }
+}
+
 /// Hold an `instance` and wait for the parent to query for information.
 ///
 /// This is the main "run loop" of the test harness.
@@ -283,6 +298,8 @@ internal func reflect(instanceAddress: UInt, kind: InstanceKind) {
       sendStringLength()
     case String(validatingUTF8: RequestPointerSize)!:
       sendPointerSize();
+    case String(validatingUTF8: RequestHeapBlocks)!:
+      sendHeapBlocks()
     case String(validatingUTF8: RequestDone)!:
       return;
     default:
@@ -476,6 +493,19 @@ public func reflect(function: (Int, String, AnyObject?) -> ()) {
   fn.deallocateCapacity(sizeof(ThickFunction3.self))
 }
 
+/// Take a census of the Swift heap objects among the given malloc blocks, as
+/// a memory debugger would after enumerating the blocks of the malloc zones.
+///
+/// Blocks that don't hold Swift heap objects, such as ones allocated with
+/// `malloc` directly, aren't counted.
+public func reflectHeapCensus(blocks: [UnsafePointer<Void>]) {
+  heapBlocks = blocks.map {
+    (address: unsafeBitCast($0, to: UInt.self), size: UInt(malloc_size($0)))
+  }
+  reflect(instanceAddress: UInt(blocks.count), kind: .HeapCensus)
+  heapBlocks = []
+}
+
 /// Call this function to indicate to the parent that there are
 /// no more instances to look at.
 public func doneReflecting() {
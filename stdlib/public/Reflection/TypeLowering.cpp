@@ -22,6 +22,7 @@
 #include "swift/Reflection/TypeRef.h"
 #include "swift/Reflection/TypeRefBuilder.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace swift;
@@ -241,6 +242,7 @@ class ExistentialTypeInfoBuilder {
           continue;
         case FieldDescriptorKind::ObjCClass:
         case FieldDescriptorKind::Struct:
+        case FieldDescriptorKind::ReorderedStruct:
         case FieldDescriptorKind::Enum:
         case FieldDescriptorKind::Class:
           Invalid = true;
@@ -768,6 +770,29 @@ public:
         builder.addField(Field.first, Field.second);
       return builder.build();
     }
+    case FieldDescriptorKind::ReorderedStruct: {
+      // IRGen laid out the struct's fields by decreasing alignment, keeping
+      // declaration order among fields of the same alignment.
+      auto Fields = TC.getBuilder().getFieldTypeRefs(TR, FD);
+      std::vector<unsigned> Alignments;
+      std::vector<unsigned> Order;
+      for (auto Field : Fields) {
+        auto *FieldTI = TC.getTypeInfo(Field.second);
+        if (FieldTI == nullptr)
+          return nullptr;
+        Order.push_back(Alignments.size());
+        Alignments.push_back(FieldTI->getAlignment());
+      }
+      std::stable_sort(Order.begin(), Order.end(),
+                       [&](unsigned LHS, unsigned RHS) {
+                         return Alignments[LHS] > Alignments[RHS];
+                       });
+
+      RecordTypeInfoBuilder builder(TC, RecordKind::Struct);
+      for (unsigned i : Order)
+        builder.addField(Fields[i].first, Fields[i].second);
+      return builder.build();
+    }
     case FieldDescriptorKind::Enum: {
       // Sort enum into payload and no-payload cases.
       unsigned NoPayloadCases = 0;
@@ -1026,6 +1051,7 @@ const TypeInfo *TypeConverter::getClassInstanceTypeInfo(const TypeRef *TR,
     return builder.build();
   }
   case FieldDescriptorKind::Struct:
+  case FieldDescriptorKind::ReorderedStruct:
   case FieldDescriptorKind::Enum:
   case FieldDescriptorKind::ObjCProtocol:
   case FieldDescriptorKind::ClassProtocol:
@@ -28,26 +28,65 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::indexReflectionInfos() {
+  for (auto e = ReflectionInfos.size(); NumIndexedReflectionInfos != e;
+       ++NumIndexedReflectionInfos) {
+    auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    // emplace() keeps the existing entry, so the first image to describe a
+    // type wins, as it did when the sections were searched in order.
+    for (auto &FD : Info.fieldmd) {
+      if (!FD.hasMangledTypeName())
+        continue;
+      FieldTypeInfoIndex.emplace(FD.getMangledTypeName(), &FD);
+    }
+
+    for (auto &AssocTyDescriptor : Info.assocty) {
+      auto ConformingTypeName =
+        AssocTyDescriptor.getMangledConformingTypeName();
+      AssociatedTypeIndex[ConformingTypeName].push_back(&AssocTyDescriptor);
+    }
+
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (!BuiltinTypeDescriptor.hasMangledTypeName())
+        continue;
+      BuiltinTypeInfoIndex.emplace(BuiltinTypeDescriptor.getMangledTypeName(),
+                                   &BuiltinTypeDescriptor);
+    }
+
+    for (auto &CD : Info.capture) {
+      auto RemoteAddress = ((uintptr_t) &CD -
+                            Info.LocalStartAddress +
+                            Info.RemoteStartAddress);
+      CaptureDescriptorIndex.emplace(RemoteAddress, &CD);
+    }
+  }
+}
+
 const AssociatedTypeDescriptor * TypeRefBuilder::
 lookupAssociatedTypes(const std::string &MangledTypeName,
                       const DependentMemberTypeRef *DependentMember) {
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
+  indexReflectionInfos();
+
+  auto Found = AssociatedTypeIndex.find(MangledTypeName);
+  if (Found == AssociatedTypeIndex.end())
+    return nullptr;
+
+  for (auto *AssocTyDescriptor : Found->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    Demangle::NodeFactory Factory;
+    auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName,
+                                                       Factory);
+    auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
+
+    auto &Conformance = *DependentMember->getProtocol();
+    if (auto Protocol = dyn_cast<ProtocolTypeRef>(TR)) {
+      if (*Protocol != Conformance)
         continue;
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
-
-      auto &Conformance = *DependentMember->getProtocol();
-      if (auto Protocol = dyn_cast<ProtocolTypeRef>(TR)) {
-        if (*Protocol != Conformance)
-          continue;
-        return &AssocTyDescriptor;
-      }
+      return AssocTyDescriptor;
     }
   }
   return nullptr;
@@ -63,7 +102,9 @@ getDependentMemberTypeRef(const std::string &MangledTypeName,
         continue;
 
       auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+      Demangle::NodeFactory Factory;
+      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName,
+                                                    Factory);
       return swift::remote::decodeMangledType(*this, Demangled);
     }
   }
@@ -82,19 +123,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = FieldTypeInfoIndex.find(MangledName);
+  if (Found == FieldTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 std::vector<std::pair<std::string, const TypeRef *>> TypeRefBuilder::
@@ -115,8 +148,9 @@ getFieldTypeRefs(const TypeRef *TR, const FieldDescriptor *FD) {
       continue;
     }
 
+    Demangle::NodeFactory Factory;
     auto Demangled
-      = Demangle::demangleTypeAsNode(Field.getMangledTypeName());
+      = Demangle::demangleTypeAsNode(Field.getMangledTypeName(), Factory);
     auto Unsubstituted = swift::remote::decodeMangledType(*this, Demangled);
     if (!Unsubstituted)
       return {};
@@ -137,36 +171,20 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = BuiltinTypeInfoIndex.find(MangledName);
+  if (Found == BuiltinTypeInfoIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 const CaptureDescriptor *
 TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
-  for (auto Info : ReflectionInfos) {
-    for (auto &CD : Info.capture) {
-      auto OtherAddr = ((uintptr_t) &CD -
-                        Info.LocalStartAddress +
-                        Info.RemoteStartAddress);
-      if (OtherAddr == RemoteAddress)
-        return &CD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto Found = CaptureDescriptorIndex.find(RemoteAddress);
+  if (Found == CaptureDescriptorIndex.end())
+    return nullptr;
+  return Found->second;
 }
 
 /// Get the unsubstituted capture types for a closure context.
@@ -178,7 +196,8 @@ TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
       auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+      Demangle::NodeFactory Factory;
+      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
       TR = swift::remote::decodeMangledType(*this, DemangleTree);
     }
     Info.CaptureTypes.push_back(TR);
@@ -188,7 +207,8 @@ TypeRefBuilder::getClosureContextInfo(const CaptureDescriptor &CD) {
     const TypeRef *TR = nullptr;
     if (i->hasMangledTypeName()) {
       auto MangledName = i->getMangledTypeName();
-      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+      Demangle::NodeFactory Factory;
+      auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
       TR = swift::remote::decodeMangledType(*this, DemangleTree);
     }
 
@@ -216,7 +236,8 @@ TypeRefBuilder::dumpTypeRef(const std::string &MangledName,
   auto TypeName = Demangle::demangleTypeAsString(MangledName);
   OS << TypeName << '\n';
 
-  auto DemangleTree = Demangle::demangleTypeAsNode(MangledName);
+  Demangle::NodeFactory Factory;
+  auto DemangleTree = Demangle::demangleTypeAsNode(MangledName, Factory);
   auto TR = swift::remote::decodeMangledType(*this, DemangleTree);
   if (!TR) {
     OS << "!!! Invalid typeref: " << MangledName << '\n';
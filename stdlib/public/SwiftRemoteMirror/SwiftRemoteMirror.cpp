@@ -13,6 +13,7 @@
 #include "swift/Reflection/ReflectionContext.h"
 #include "swift/Reflection/TypeLowering.h"
 #include "swift/Remote/CMemoryReader.h"
+#include "swift/Remote/CachingMemoryReader.h"
 #include "swift/SwiftRemoteMirror/SwiftRemoteMirror.h"
 
 using namespace swift;
@@ -38,7 +39,8 @@ swift_reflection_createReflectionContext(void *ReaderContext,
     getSymbolAddress
   };
 
-  auto Reader = std::make_shared<CMemoryReader>(ReaderImpl);
+  auto Reader = std::make_shared<CachingMemoryReader>(
+    std::make_shared<CMemoryReader>(ReaderImpl));
   auto Context
     = new ReflectionContext<External<RuntimeTarget<sizeof(uintptr_t)>>>(Reader);
   return reinterpret_cast<SwiftReflectionContextRef>(Context);
@@ -276,6 +278,30 @@ int swift_reflection_projectExistential(SwiftReflectionContextRef ContextRef,
   return Success;
 }
 
+void
+swift_reflection_takeHeapCensus(SwiftReflectionContextRef ContextRef,
+                                const swift_heap_block_t *Blocks,
+                                size_t NumBlocks,
+                                swift_census_callback_t Callback,
+                                void *CallbackContext) {
+  auto Context = reinterpret_cast<NativeReflectionContext *>(ContextRef);
+  using StoredPointer = NativeReflectionContext::StoredPointer;
+  std::vector<std::pair<StoredPointer, uint64_t>> HeapBlocks;
+  HeapBlocks.reserve(NumBlocks);
+  for (size_t i = 0; i < NumBlocks; ++i)
+    HeapBlocks.push_back({StoredPointer(Blocks[i].Address), Blocks[i].Size});
+
+  auto Census = Context->takeHeapCensus(HeapBlocks);
+  for (auto &Entry : Census) {
+    swift_census_entry_t Result = {
+      (uintptr_t) Entry.first,
+      Entry.second.Count,
+      Entry.second.Bytes
+    };
+    Callback(CallbackContext, Result);
+  }
+}
+
 void swift_reflection_dumpTypeRef(swift_typeref_t OpaqueTypeRef) {
   auto TR = reinterpret_cast<const TypeRef *>(OpaqueTypeRef);
   if (TR == nullptr) {
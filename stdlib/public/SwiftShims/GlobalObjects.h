@@ -42,6 +42,12 @@ struct _SwiftEmptyArrayStorage _swiftEmptyArrayStorage;
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride;
 
+/// The strings "\0" through "\x7f", each one code unit long and followed by
+/// a null terminator, so that one-character ASCII strings can be created
+/// without allocating.
+extern SWIFT_RUNTIME_STDLIB_INTERFACE
+const __swift_uint8_t *_swift_stdlib_ASCIICharacterStrings;
+
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 void *_swift_stdlib_ProcessArguments;
 
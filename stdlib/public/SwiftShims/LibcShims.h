@@ -46,6 +46,12 @@ int _swift_stdlib_putchar_unlocked(int c);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_fwrite_stdout(const void *ptr, __swift_size_t size,
                                            __swift_size_t nitems);
+/// Like `_swift_stdlib_fwrite_stdout`, for a caller that holds the stdout
+/// lock.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_size_t _swift_stdlib_fwrite_unlocked_stdout(const void *ptr,
+                                                    __swift_size_t size,
+                                                    __swift_size_t nitems);
 
 // String handling <string.h>
 __attribute__((__pure__)) SWIFT_RUNTIME_STDLIB_INTERFACE __swift_size_t
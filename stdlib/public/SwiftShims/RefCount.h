@@ -191,6 +191,17 @@ class StrongRefCount {
     return doDecrementShouldDeallocateN<false>(n);
   }
 
+  // Set the RC_DEALLOCATING_FLAG flag after a decrement made by compiled
+  // code dropped the reference count to zero.
+  // Return true if the caller should now deallocate the object.
+  bool setDeallocatingAfterDecrementToZero() {
+    // This is the second half of doDecrementShouldDeallocate().
+    uint32_t oldval = 0;
+    uint32_t newval = RC_DEALLOCATING_FLAG;
+    return __atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+  }
+
   // Set the RC_DEALLOCATING_FLAG flag non-atomically.
   //
   // Precondition: the reference count must be 1
@@ -397,9 +408,10 @@ private:
 class WeakRefCount {
   uint32_t refCount;
 
+  // The low bit is set once the object has a weak reference side table.
+  // The remaining bits are the reference count.
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -435,6 +447,18 @@ class WeakRefCount {
     refCount = RC_ONE + RC_ONE;
   }
 
+  /// Record that a weak reference side table has been created for the
+  /// object.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  /// Return true if a weak reference side table has been created for the
+  /// object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
+
   // Increment the weak reference count.
   void increment() {
     uint32_t newval = __atomic_add_fetch(&refCount, RC_ONE, __ATOMIC_RELAXED);
@@ -75,6 +75,14 @@ int _swift_stdlib_putc_stderr(int C);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// Calls `work(context, i)` for every `i` in `0..<iterations`, concurrently
+/// on the runtime's worker threads, and returns once all of the calls have
+/// finished.  The calling thread takes part in the work.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_concurrentPerform(
+    __swift_size_t iterations, void *context,
+    void (*work)(void *context, __swift_size_t index));
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
@@ -157,29 +157,51 @@ extension _ArrayBufferProtocol where Index == Int {
       // so as not to self-clobber.
       newTailStart.moveInitializeBackwardFrom(oldTailStart, count: tailCount)
 
-      // Assign over the original subRange
-      var i = newValues.startIndex
-      for j in CountableRange(subRange) {
-        elements[j] = newValues[i]
-        newValues.formIndex(after: &i)
+      let copied: Void? = newValues._withContiguousStorageIfAvailable {
+        (source) -> Void in
+        _debugPrecondition(source.count == newCount,
+          "invalid Collection: count differed in successive traversals")
+        let sourceStart = UnsafeMutablePointer<Element>(source.baseAddress!)
+        (elements + subRange.lowerBound).assignFrom(
+          sourceStart, count: eraseCount)
+        oldTailStart.initializeFrom(sourceStart + eraseCount, count: growth)
       }
-      // Initialize the hole left by sliding the tail forward
-      for j in oldTailIndex..<newTailIndex {
-        (elements + j).initialize(with: newValues[i])
-        newValues.formIndex(after: &i)
+      if copied == nil {
+        // Assign over the original subRange
+        var i = newValues.startIndex
+        for j in CountableRange(subRange) {
+          elements[j] = newValues[i]
+          newValues.formIndex(after: &i)
+        }
+        // Initialize the hole left by sliding the tail forward
+        for j in oldTailIndex..<newTailIndex {
+          (elements + j).initialize(with: newValues[i])
+          newValues.formIndex(after: &i)
+        }
+        _expectEnd(i, newValues)
       }
-      _expectEnd(i, newValues)
     }
     else { // We're not growing the buffer
-      // Assign all the new elements into the start of the subRange
-      var i = subRange.lowerBound
-      var j = newValues.startIndex
-      for _ in 0..<newCount {
-        elements[i] = newValues[j]
-        formIndex(after: &i)
-        newValues.formIndex(after: &j)
+      let copied: Void? = newValues._withContiguousStorageIfAvailable {
+        (source) -> Void in
+        _debugPrecondition(source.count == newCount,
+          "invalid Collection: count differed in successive traversals")
+        if let sourceStart = source.baseAddress {
+          (elements + subRange.lowerBound).assignFrom(
+            UnsafeMutablePointer(sourceStart), count: newCount)
+        }
+      }
+      if copied == nil {
+        // Assign all the new elements into the start of the subRange
+        var i = subRange.lowerBound
+        var j = newValues.startIndex
+        for _ in 0..<newCount {
+          elements[i] = newValues[j]
+          formIndex(after: &i)
+          newValues.formIndex(after: &j)
+        }
+        _expectEnd(j, newValues)
       }
-      _expectEnd(j, newValues)
 
       // If the size didn't change, we're done.
       if growth == 0 {
@@ -0,0 +1,383 @@
+//===--- ByteBuffer.swift - A copy-on-write buffer of bytes ---*- swift -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  A growable, copy-on-write buffer of raw bytes whose slices share its
+//  storage, with helpers that fill and drain it with read(2) and write(2).
+//
+//===----------------------------------------------------------------------===//
+
+import SwiftShims
+
+/// The heap storage of a `ByteBuffer`; its header is the number of bytes
+/// it can hold.
+internal final class _ByteBufferStorage : ManagedBuffer<Int, UInt8> {
+
+  /// Returns new storage that can hold at least `minimumCapacity` bytes.
+  internal static func _create(minimumCapacity: Int) -> _ByteBufferStorage {
+    return unsafeDowncast(
+      _ByteBufferStorage.create(minimumCapacity: minimumCapacity) {
+        $0.capacity
+      },
+      to: _ByteBufferStorage.self)
+  }
+
+  /// The address of the first byte.
+  ///
+  /// Only valid while `self` is alive.
+  internal var _bytes: UnsafeMutablePointer<UInt8> {
+    return withUnsafeMutablePointerToElements { $0 }
+  }
+}
+
+/// A contiguous, growable buffer of bytes with value semantics.
+///
+/// A `ByteBuffer` is its own `SubSequence`: slicing one shares its storage
+/// rather than copying it, and the bytes are only copied when a buffer
+/// whose storage is shared is mutated.  Like `ArraySlice`, a slice keeps
+/// the indices of the buffer it was taken from.
+///
+/// `read(from:maxCount:)` and `write(to:)` move bytes between a buffer and
+/// a file descriptor without any intermediate copy.
+///
+///     var buffer = ByteBuffer()
+///     while buffer.read(from: fd, maxCount: 4096) > 0 {}
+///     let header = buffer[0..<16]   // shares `buffer`'s storage
+public struct ByteBuffer
+  : RandomAccessCollection, MutableCollection, RangeReplaceableCollection {
+
+  public typealias Index = Int
+  public typealias Indices = CountableRange<Int>
+  public typealias SubSequence = ByteBuffer
+
+  /// Creates an empty buffer.
+  public init() {
+    self.init(_storage: nil, startIndex: 0, endIndex: 0, storageOffset: 0)
+  }
+
+  /// Creates a buffer of `count` bytes, each equal to `repeatedValue`.
+  public init(repeating repeatedValue: UInt8, count: Int) {
+    _precondition(count >= 0, "Can't construct ByteBuffer with count < 0")
+    self.init()
+    if count == 0 {
+      return
+    }
+    _reserveUnique(count, growing: false).initialize(
+      with: repeatedValue, count: count)
+    _endIndex = count
+  }
+
+  /// Creates a buffer containing the bytes of `elements`.
+  public init<S : Sequence where S.Iterator.Element == UInt8>(_ elements: S) {
+    self.init()
+    append(contentsOf: elements)
+  }
+
+  internal init(
+    _storage: _ByteBufferStorage?,
+    startIndex: Int, endIndex: Int, storageOffset: Int
+  ) {
+    self._storage = _storage
+    self._startIndex = startIndex
+    self._endIndex = endIndex
+    self._storageOffset = storageOffset
+  }
+
+  /// The position of the first byte.
+  public var startIndex: Int {
+    return _startIndex
+  }
+
+  /// The buffer's "past the end" position.
+  public var endIndex: Int {
+    return _endIndex
+  }
+
+  public func index(after i: Int) -> Int {
+    return i + 1
+  }
+
+  public func index(before i: Int) -> Int {
+    return i - 1
+  }
+
+  /// The number of bytes in the buffer.
+  public var count: Int {
+    return _endIndex - _startIndex
+  }
+
+  /// The number of bytes the buffer can hold without allocating new
+  /// storage, if its storage is not shared.
+  public var capacity: Int {
+    guard let storage = _storage else { return 0 }
+    return storage.value - _storageOffset
+  }
+
+  /// Reserve enough space to store `minimumCapacity` bytes.
+  ///
+  /// - Postcondition: `capacity >= minimumCapacity` and the buffer has
+  ///   mutable contiguous storage.
+  public mutating func reserveCapacity(_ minimumCapacity: Int) {
+    if minimumCapacity > 0 {
+      _reserveUnique(minimumCapacity, growing: false)
+    }
+  }
+
+  /// Access the byte at `position`.
+  ///
+  /// - Precondition: `position` is a valid position in `self` and
+  ///   `position != endIndex`.
+  public subscript(position: Int) -> UInt8 {
+    get {
+      _checkIndex(position)
+      return _storage!._bytes[_storageOffset + position - _startIndex]
+    }
+    set {
+      _checkIndex(position)
+      _reserveUnique(count, growing: false)[position - _startIndex] = newValue
+    }
+  }
+
+  /// Access the bytes in `bounds`.
+  ///
+  /// The returned buffer shares storage with `self`.
+  public subscript(bounds: Range<Int>) -> ByteBuffer {
+    get {
+      _checkBounds(bounds)
+      return ByteBuffer(
+        _storage: _storage,
+        startIndex: bounds.lowerBound, endIndex: bounds.upperBound,
+        storageOffset: _storageOffset + bounds.lowerBound - _startIndex)
+    }
+    set {
+      replaceSubrange(bounds, with: newValue)
+    }
+  }
+
+  /// Replace the bytes in `subrange` with `newElements`.
+  ///
+  /// Invalidates all indices with respect to `self`.
+  ///
+  /// - Complexity: O(`subrange.count`) if `subrange.upperBound
+  ///   == endIndex` and `newElements.isEmpty`, O(`count`) otherwise.
+  public mutating func replaceSubrange<
+    C : Collection where C.Iterator.Element == UInt8
+  >(_ subrange: Range<Int>, with newElements: C) {
+    _checkBounds(subrange)
+    let insertCount: Int = numericCast(newElements.count)
+    let newCount = count - subrange.count + insertCount
+    if newCount == 0 {
+      if !isUniquelyReferencedNonObjC(&_storage) {
+        _storage = nil
+        _storageOffset = 0
+      }
+      _endIndex = _startIndex
+      return
+    }
+
+    let tailCount = _endIndex - subrange.upperBound
+    let bytes = _reserveUnique(
+      newCount, growing: newCount > count && subrange.upperBound == _endIndex)
+    let head = bytes + (subrange.lowerBound - _startIndex)
+    let tail = head + subrange.count
+    let newTail = head + insertCount
+    if newTail < tail {
+      newTail.moveInitializeFrom(tail, count: tailCount)
+    } else if newTail > tail {
+      newTail.moveInitializeBackwardFrom(tail, count: tailCount)
+    }
+    head.initializeFrom(newElements)
+    _endIndex = _startIndex + newCount
+  }
+
+  /// Append `newElement` to the buffer.
+  ///
+  /// - Complexity: Amortized O(1) unless `self`'s storage is shared.
+  public mutating func append(_ newElement: UInt8) {
+    let oldCount = count
+    _reserveUnique(oldCount + 1, growing: true)[oldCount] = newElement
+    _endIndex += 1
+  }
+
+  /// Append the bytes of `newElements` to the buffer.
+  ///
+  /// Sources with contiguous storage are copied in one go.
+  public mutating func append<
+    S : Sequence where S.Iterator.Element == UInt8
+  >(contentsOf newElements: S) {
+    let copied: Void? = newElements._withContiguousStorageIfAvailable {
+      (source) -> Void in
+      guard let sourceStart = source.baseAddress, source.count != 0
+        else { return }
+      let oldCount = count
+      (_reserveUnique(oldCount + source.count, growing: true) + oldCount)
+        .initializeFrom(sourceStart, count: source.count)
+      _endIndex += source.count
+    }
+    if copied != nil {
+      return
+    }
+    reserveCapacity(count + newElements.underestimatedCount)
+    for byte in newElements {
+      append(byte)
+    }
+  }
+
+  /// Call `body(p)`, where `p` is a pointer to the buffer's contiguous
+  /// bytes.
+  ///
+  /// The pointer passed as an argument to `body` is valid only for the
+  /// lifetime of the closure. Do not escape it from the closure for later
+  /// use.
+  public func withUnsafeBufferPointer<R>(
+    _ body: @noescape (UnsafeBufferPointer<UInt8>) throws -> R
+  ) rethrows -> R {
+    defer { _fixLifetime(self) }
+    return try body(UnsafeBufferPointer(
+      start: _storage.map { UnsafePointer($0._bytes + _storageOffset) },
+      count: count))
+  }
+
+  /// Call `body(p)`, where `p` is a pointer to the buffer's mutable
+  /// contiguous bytes.
+  ///
+  /// The pointer passed as an argument to `body` is valid only for the
+  /// lifetime of the closure. Do not escape it from the closure for later
+  /// use.
+  public mutating func withUnsafeMutableBufferPointer<R>(
+    _ body: @noescape (UnsafeMutableBufferPointer<UInt8>) throws -> R
+  ) rethrows -> R {
+    let start: UnsafeMutablePointer<UInt8>? =
+      count == 0 ? nil : _reserveUnique(count, growing: false)
+    defer { _fixLifetime(self) }
+    return try body(UnsafeMutableBufferPointer(start: start, count: count))
+  }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    _ body: @noescape (UnsafeBufferPointer<UInt8>) throws -> R
+  ) rethrows -> R? {
+    return try withUnsafeBufferPointer(body)
+  }
+
+  /// Read up to `maxCount` bytes from the file descriptor `fd` with a
+  /// single `read(2)` call, appending them directly to the buffer's
+  /// storage.
+  ///
+  /// - Returns: The number of bytes read, `0` at end of file, or `-1` if
+  ///   `read(2)` failed, in which case the buffer is left unchanged and
+  ///   `errno` describes the error.
+  @discardableResult
+  public mutating func read(from fd: CInt, maxCount: Int) -> Int {
+    _precondition(maxCount >= 0, "Can't read a negative number of bytes")
+    if maxCount == 0 {
+      return 0
+    }
+    let oldCount = count
+    let bytes = _reserveUnique(oldCount + maxCount, growing: true)
+    let result = _swift_stdlib_read(fd, bytes + oldCount, maxCount)
+    if result > 0 {
+      _endIndex += result
+    }
+    return result
+  }
+
+  /// Write the buffer's bytes to the file descriptor `fd`, calling
+  /// `write(2)` until all of them are written or it fails.
+  ///
+  /// - Returns: The number of bytes written, which is less than `count`
+  ///   only if `write(2)` failed; `errno` then describes the error.
+  @discardableResult
+  public func write(to fd: CInt) -> Int {
+    return withUnsafeBufferPointer {
+      (bytes) -> Int in
+      var written = 0
+      while written != bytes.count {
+        let result = _swift_stdlib_write(
+          fd, bytes.baseAddress! + written, bytes.count - written)
+        if result < 0 {
+          break
+        }
+        written += result
+      }
+      return written
+    }
+  }
+
+  internal func _checkIndex(_ position: Int) {
+    _precondition(
+      position >= _startIndex && position < _endIndex, "Index out of range")
+  }
+
+  internal func _checkBounds(_ bounds: Range<Int>) {
+    _precondition(
+      bounds.lowerBound >= _startIndex && bounds.upperBound <= _endIndex,
+      "ByteBuffer range out of bounds")
+  }
+
+  /// Ensure that `self` uniquely owns storage that can hold
+  /// `minimumCapacity` bytes, copying its bytes to new storage if it does
+  /// not, and return the address of its first byte.
+  ///
+  /// If `growing` is `true`, new storage grows geometrically, so that
+  /// repeated appends take amortized constant time.
+  ///
+  /// - Precondition: `minimumCapacity > 0 || count > 0`.
+  @discardableResult
+  internal mutating func _reserveUnique(
+    _ minimumCapacity: Int, growing: Bool
+  ) -> UnsafeMutablePointer<UInt8> {
+    if _fastPath(
+      isUniquelyReferencedNonObjC(&_storage) && capacity >= minimumCapacity) {
+      return _storage!._bytes + _storageOffset
+    }
+    var newCapacity = Swift.max(minimumCapacity, count)
+    if growing {
+      newCapacity = Swift.max(newCapacity, _growArrayCapacity(capacity))
+    }
+    let newStorage = _ByteBufferStorage._create(minimumCapacity: newCapacity)
+    let newBytes = newStorage._bytes
+    if let oldStorage = _storage {
+      newBytes.initializeFrom(oldStorage._bytes + _storageOffset, count: count)
+    }
+    _storage = newStorage
+    _storageOffset = 0
+    return newBytes
+  }
+
+  internal var _storage: _ByteBufferStorage?
+  internal var _startIndex: Int
+  internal var _endIndex: Int
+
+  /// The offset in `_storage` of the byte at `_startIndex`.
+  internal var _storageOffset: Int
+}
+
+/// Returns `true` iff `lhs` and `rhs` contain the same bytes.
+public func == (lhs: ByteBuffer, rhs: ByteBuffer) -> Bool {
+  if lhs.count != rhs.count {
+    return false
+  }
+  if lhs.isEmpty {
+    return true
+  }
+  return lhs.withUnsafeBufferPointer {
+    (lhs) -> Bool in
+    rhs.withUnsafeBufferPointer {
+      (rhs) -> Bool in
+      _swift_stdlib_memcmp(lhs.baseAddress!, rhs.baseAddress!, lhs.count) == 0
+    }
+  }
+}
+
+/// Returns `true` iff `lhs` and `rhs` do not contain the same bytes.
+public func != (lhs: ByteBuffer, rhs: ByteBuffer) -> Bool {
+  return !(lhs == rhs)
+}
@@ -339,6 +339,11 @@ public struct Character :
   /// Hash values are not guaranteed to be equal across different executions of
   /// your program. Do not save hash values to use during a future execution.
   public var hashValue: Int {
+#if !_runtime(_ObjC)
+    if case let .small(bits) = _representation {
+      return Character._hashSmall(Character._smallValue(bits))
+    }
+#endif
     // FIXME(performance): constructing a temporary string is extremely
     // wasteful and inefficient.
     return String(self).hashValue
@@ -366,6 +371,11 @@ extension String {
   /// - Parameter c: The character to convert to a string.
   public init(_ c: Character) {
     switch c._representation {
+    case let .small(_63bits)
+      where Bool(Builtin.cmp_uge_Int63(_63bits, _minASCIICharReprBuiltin)):
+      self = String(_StringCore(
+        _asciiCharacter: UInt8(truncatingBitPattern:
+          Character._smallValue(_63bits))))
     case let .small(_63bits):
       let value = Character._smallValue(_63bits)
       let smallUTF8 = Character._SmallUTF8(value)
@@ -391,12 +401,97 @@ internal var _minASCIICharReprBuiltin: Builtin.Int63 {
   }
 }
 
+#if !_runtime(_ObjC)
+extension Character {
+  /// Returns true if the `.small` character `value` is made of ASCII code
+  /// units only, in which case a `String` containing it has ASCII storage.
+  @inline(__always)
+  internal static func _isSmallASCII(_ value: UInt64) -> Bool {
+    // The unused bytes are 0xFF, so they are masked out.
+    let size = UInt64(_smallSize(value))
+    let usedBytes: UInt64 = size == 8 ? ~0 : (1 << (size &* 8)) &- 1
+    return value & usedBytes & 0x8080_8080_8080_8080 == 0
+  }
+
+  /// Compares the `.small` characters `lhs` and `rhs` like the `String`s
+  /// containing them would be compared, without creating those strings.
+  ///
+  /// - returns:
+  ///   * an unspecified value less than zero if `lhs < rhs`,
+  ///   * zero if `lhs == rhs`,
+  ///   * an unspecified value greater than zero if `lhs > rhs`.
+  @inline(never)
+  internal static func _compareSmall(_ lhs: UInt64, _ rhs: UInt64) -> Int {
+    let lhsCount = Int32(_smallSize(lhs))
+    let rhsCount = Int32(_smallSize(rhs))
+    let isASCII = _isSmallASCII(lhs) && _isSmallASCII(rhs)
+
+    // The code units are stored from the lowest byte up, so the
+    // little-endian form of the value has them in order in memory.
+    var lhsUTF8 = lhs.littleEndian
+    var rhsUTF8 = rhs.littleEndian
+    return withUnsafePointers(&lhsUTF8, &rhsUTF8) {
+      (lhsUTF8Ptr, rhsUTF8Ptr) -> Int in
+      let lhsPtr = UnsafePointer<Int8>(lhsUTF8Ptr)
+      let rhsPtr = UnsafePointer<Int8>(rhsUTF8Ptr)
+      if isASCII {
+        return Int(_swift_stdlib_unicode_compare_ascii_ascii(
+          lhsPtr, lhsCount, rhsPtr, rhsCount))
+      }
+      return Int(_swift_stdlib_unicode_compare_utf8_utf8(
+        lhsPtr, lhsCount, rhsPtr, rhsCount))
+    }
+  }
+
+  /// Returns the hash value of the `String` containing the `.small`
+  /// character `value`, without creating that string.
+  @inline(never)
+  internal static func _hashSmall(_ value: UInt64) -> Int {
+    if _isSmallASCII(value) {
+      let count = Int32(_smallSize(value))
+      var utf8 = value.littleEndian
+      return withUnsafePointer(&utf8) {
+        _swift_stdlib_unicode_hash_ascii(UnsafePointer<Int8>($0), count)
+      }
+    }
+
+    // Non-ASCII strings are stored and hashed as UTF-16.
+    let utf16 = _SmallUTF16(value)
+    var buffer: (UInt16, UInt16, UInt16, UInt16) = (0, 0, 0, 0)
+    return withUnsafeMutablePointer(&buffer) {
+      (bufferPtr) -> Int in
+      let units = UnsafeMutablePointer<UInt16>(bufferPtr)
+      for i in utf16.indices {
+        units[i] = utf16[i]
+      }
+      return _swift_stdlib_unicode_hash(units, Int32(utf16.count))
+    }
+  }
+}
+#endif
+
 public func ==(lhs: Character, rhs: Character) -> Bool {
   switch (lhs._representation, rhs._representation) {
-  case let (.small(lbits), .small(rbits)) where
-    Bool(Builtin.cmp_uge_Int63(lbits, _minASCIICharReprBuiltin))
-    && Bool(Builtin.cmp_uge_Int63(rbits, _minASCIICharReprBuiltin)):
-    return Bool(Builtin.cmp_eq_Int63(lbits, rbits))
+  case let (.small(lbits), .small(rbits)):
+    // Identical code units always compare equal.
+    if Bool(Builtin.cmp_eq_Int63(lbits, rbits)) {
+      return true
+    }
+    if Bool(Builtin.cmp_uge_Int63(lbits, _minASCIICharReprBuiltin))
+      && Bool(Builtin.cmp_uge_Int63(rbits, _minASCIICharReprBuiltin)) {
+      return false
+    }
+#if _runtime(_ObjC)
+    return String(lhs) == String(rhs)
+#else
+    // ASCII strings are equal only if their code units are (see String.==).
+    let lhsValue = Character._smallValue(lbits)
+    let rhsValue = Character._smallValue(rbits)
+    if Character._isSmallASCII(lhsValue) && Character._isSmallASCII(rhsValue) {
+      return false
+    }
+    return Character._compareSmall(lhsValue, rhsValue) == 0
+#endif
   default:
     // FIXME(performance): constructing two temporary strings is extremely
     // wasteful and inefficient.
@@ -406,12 +501,22 @@ public func ==(lhs: Character, rhs: Character) -> Bool {
 
 public func <(lhs: Character, rhs: Character) -> Bool {
   switch (lhs._representation, rhs._representation) {
-  case let (.small(lbits), .small(rbits)) where
+  case let (.small(lbits), .small(rbits)):
+    if Bool(Builtin.cmp_eq_Int63(lbits, rbits)) {
+      return false
+    }
     // Note: This is consistent with Foundation but unicode incorrect.
     // See String._compareASCII.
-    Bool(Builtin.cmp_uge_Int63(lbits, _minASCIICharReprBuiltin))
-    && Bool(Builtin.cmp_uge_Int63(rbits, _minASCIICharReprBuiltin)):
-    return Bool(Builtin.cmp_ult_Int63(lbits, rbits))
+    if Bool(Builtin.cmp_uge_Int63(lbits, _minASCIICharReprBuiltin))
+      && Bool(Builtin.cmp_uge_Int63(rbits, _minASCIICharReprBuiltin)) {
+      return Bool(Builtin.cmp_ult_Int63(lbits, rbits))
+    }
+#if _runtime(_ObjC)
+    return String(lhs) < String(rhs)
+#else
+    return Character._compareSmall(
+      Character._smallValue(lbits), Character._smallValue(rbits)) < 0
+#endif
   default:
     // FIXME(performance): constructing two temporary strings is extremely
     // wasteful and inefficient.
@@ -1681,6 +1681,17 @@ extension Sequence
       return p
     }
   }
+
+  public func _withContiguousStorageIfAvailable<R>(
+    _ body: @noescape (UnsafeBufferPointer<Iterator.Element>) throws -> R
+  ) rethrows -> R? {
+    if let s = self._baseAddressIfContiguous {
+      defer { _fixLifetime(self._owner) }
+      return try body(
+        UnsafeBufferPointer(start: UnsafePointer(s), count: self.count))
+    }
+    return nil
+  }
 }
 
 extension Collection {
@@ -126,6 +126,114 @@ func _mixInt(_ value: Int) -> Int {
 #endif
 }
 
+/// An incremental hasher, which mixes the words and bytes appended to it into
+/// a seeded state.
+///
+/// Derived `hashValue` implementations append the stored properties or
+/// payloads of their type to one of these.  Hand-written ones can do the same
+/// instead of combining the hash values of their fields with ad-hoc
+/// arithmetic:
+///
+///     var hashValue: Int {
+///       var hasher = _Hasher()
+///       hasher.append(x)
+///       hasher.append(y)
+///       return hasher.finalize()
+///     }
+public struct _Hasher {
+  internal var _state: UInt64
+  internal var _count: UInt64
+
+  public init() {
+    _state = _HashingDetail.getExecutionSeed()
+    _count = 0
+  }
+
+  /// Mixes `value` into the state.
+  public mutating func append(_ value: UInt64) {
+    _state = _HashingDetail.hash16Bytes(_state, value)
+    _count = _count &+ 1
+  }
+
+  /// Mixes `value` into the state.
+  public mutating func append(_ value: Int) {
+    append(UInt64(UInt(bitPattern: value)))
+  }
+
+  /// Mixes the hash value of `value` into the state.
+  public mutating func append<H : Hashable>(_ value: H) {
+    append(value.hashValue)
+  }
+
+  /// Mixes the `count` bytes starting at `bytes` into the state, a word at a
+  /// time.
+  public mutating func append(bytes: UnsafePointer<UInt8>, count: Int) {
+    var position = bytes
+    var remaining = count
+    while remaining >= 8 {
+      var word: UInt64 = 0
+      _memcpy(dest: &word, src: UnsafeMutablePointer(position), size: 8)
+      append(word)
+      position += 8
+      remaining -= 8
+    }
+
+    // The last word holds the remaining bytes and their number, so that byte
+    // sequences which differ only in trailing zeros hash differently.
+    var tail = UInt64(remaining) << 56
+    for i in 0..<remaining {
+      tail |= UInt64(position[i]) << UInt64(i &* 8)
+    }
+    append(tail)
+  }
+
+  /// Mixes the bytes of the representation of `value` into the state.
+  ///
+  /// This is only meaningful for types whose values are equal exactly when
+  /// their representations are, which rules out types with padding,
+  /// references or floating-point values.
+  public mutating func _appendBitPattern<T>(_ value: T) {
+    var value = value
+    withUnsafePointer(&value) {
+      append(bytes: UnsafePointer($0), count: sizeof(T.self))
+    }
+  }
+
+  /// Returns the hash value of everything appended so far.
+  public func finalize() -> Int {
+    return Int(truncatingBitPattern:
+      _HashingDetail.hash16Bytes(_state, _count))
+  }
+}
+
+//
+// Support for derived conformances.
+//
+
+/// Returns `lhs == rhs`.
+///
+/// Derived `==` implementations compare stored properties and payloads with
+/// this, which finds the `==` of their `Equatable` conformance wherever it is
+/// declared.
+@_transparent
+public // COMPILER_INTRINSIC
+func _derivedEquals<T : Equatable>(_ lhs: T, _ rhs: T) -> Bool {
+  return lhs == rhs
+}
+
+/// Returns `true` if `lhs` and `rhs` have the same representation.
+///
+/// Derived `==` implementations use this for structs whose stored properties
+/// are all integers of the same type, which leaves no padding between them.
+public // COMPILER_INTRINSIC
+func _isBitwiseEqual<T>(_ lhs: T, _ rhs: T) -> Bool {
+  var lhs = lhs
+  var rhs = rhs
+  return withUnsafePointers(&lhs, &rhs) {
+    _swift_stdlib_memcmp($0, $1, sizeof(T.self)) == 0
+  }
+}
+
 /// Given a hash value, returns an integer value within the given range that
 /// corresponds to a hash value.
 ///
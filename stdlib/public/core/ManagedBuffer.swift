@@ -72,6 +72,30 @@ public class ManagedProtoBuffer<Value, Element> : NonObjectiveCBase {
     return ManagedBufferPointer(self).withUnsafeMutablePointers(body)
   }
 
+  /// Accesses the initialized `Element` at `index`.
+  ///
+  /// Use `initializeElement(at:to:)` to construct an element in raw
+  /// storage; assigning through this subscript destroys the old element.
+  ///
+  /// - Precondition: `index >= 0 && index < capacity`, and the element at
+  ///   `index` has been initialized.
+  public final subscript(elementAt index: Int) -> Element {
+    unsafeAddress {
+      return UnsafePointer(ManagedBufferPointer(self)._elementAddress(index))
+    }
+    unsafeMutableAddress {
+      return ManagedBufferPointer(self)._elementAddress(index)
+    }
+  }
+
+  /// Initialize the raw `Element` storage at `index` with `newValue`.
+  ///
+  /// - Precondition: `index >= 0 && index < capacity`, and the element at
+  ///   `index` is not initialized.
+  public final func initializeElement(at index: Int, to newValue: Element) {
+    ManagedBufferPointer(self)._elementAddress(index).initialize(with: newValue)
+  }
+
   //===--- internal/private API -------------------------------------------===//
 
   /// Make ordinary initialization unavailable
@@ -286,6 +310,31 @@ public struct ManagedBufferPointer<Value, Element> : Equatable {
     return result
   }
 
+  /// Accesses the initialized `Element` at `index`.
+  ///
+  /// Use `initializeElement(at:to:)` to construct an element in raw
+  /// storage; assigning through this subscript destroys the old element.
+  ///
+  /// - Precondition: `index >= 0 && index < capacity`, and the element at
+  ///   `index` has been initialized.
+  public subscript(elementAt index: Int) -> Element {
+    unsafeAddress {
+      return UnsafePointer(_elementAddress(index))
+    }
+    unsafeMutableAddress {
+      return _elementAddress(index)
+    }
+  }
+
+  /// Initialize the raw `Element` storage at `index` with `newValue`.
+  ///
+  /// - Precondition: `index >= 0 && index < capacity`, and the element at
+  ///   `index` is not initialized.
+  public func initializeElement(at index: Int, to newValue: Element) {
+    _elementAddress(index).initialize(with: newValue)
+    _fixLifetime(_nativeBuffer)
+  }
+
   /// Returns `true` iff `self` holds the only strong reference to its buffer.
   ///
   /// See `isUniquelyReferenced` for details.
@@ -436,6 +485,16 @@ public struct ManagedBufferPointer<Value, Element> : Equatable {
   }
 
   /// Offset from the allocated storage for `self` to the `Element` storage
+  /// The address of the `Element` at `index`.
+  ///
+  /// Checking `index` against `capacity` needs the allocation size, so it
+  /// is only done in debug builds.
+  internal func _elementAddress(_ index: Int) -> UnsafeMutablePointer<Element> {
+    _debugPrecondition(
+      index >= 0 && index < capacity, "ManagedBuffer element index out of range")
+    return _elementPointer + index
+  }
+
   internal static var _elementOffset: Int {
     _onFastPath()
     return _roundUp(
@@ -478,13 +478,30 @@ internal struct _Stdout : OutputStream {
     if string._core.isASCII {
       defer { _fixLifetime(string) }
 
-      _swift_stdlib_fwrite_stdout(UnsafePointer(string._core.startASCII),
-                                  string._core.count, 1)
+      _swift_stdlib_fwrite_unlocked_stdout(
+        UnsafePointer(string._core.startASCII), string._core.count, 1)
       return
     }
 
-    for c in string.utf8 {
-      _swift_stdlib_putchar_unlocked(Int32(c))
+    // Transcode into a stack buffer and hand it to stdio a chunk at a time,
+    // rather than making a call per byte.
+    var buffer = _Buffer72()
+    withUnsafeMutablePointer(&buffer) {
+      (bufferPtr) in
+      let bufferUTF8Ptr = UnsafeMutablePointer<UTF8.CodeUnit>(bufferPtr)
+      let capacity = sizeof(_Buffer72.self)
+      var count = 0
+      for c in string.utf8 {
+        bufferUTF8Ptr[count] = c
+        count += 1
+        if count == capacity {
+          _swift_stdlib_fwrite_unlocked_stdout(bufferUTF8Ptr, count, 1)
+          count = 0
+        }
+      }
+      if count != 0 {
+        _swift_stdlib_fwrite_unlocked_stdout(bufferUTF8Ptr, count, 1)
+      }
     }
   }
 }
@@ -580,6 +580,16 @@ public protocol Sequence {
     _ preprocess: @noescape () throws -> R
   ) rethrows -> R?
 
+  /// If the elements of `self` are stored contiguously in memory, call
+  /// `body` with a buffer pointer to them and return its result.
+  /// Otherwise, return `nil`.
+  ///
+  /// Lets bulk copies of such sequences run as a single memory copy
+  /// rather than an element-by-element iteration.
+  func _withContiguousStorageIfAvailable<R>(
+    _ body: @noescape (UnsafeBufferPointer<Iterator.Element>) throws -> R
+  ) rethrows -> R?
+
   /// Create a native array buffer containing the elements of `self`,
   /// in the same order.
   func _copyToNativeArrayBuffer() -> _ContiguousArrayBuffer<Iterator.Element>
@@ -915,6 +925,12 @@ extension Sequence {
     return nil
   }
 
+  public func _withContiguousStorageIfAvailable<R>(
+    _ body: @noescape (UnsafeBufferPointer<Iterator.Element>) throws -> R
+  ) rethrows -> R? {
+    return nil
+  }
+
   public func _customContainsEquatableElement(
     _ element: Iterator.Element
   ) -> Bool? {
@@ -1171,6 +1187,17 @@ extension Sequence {
   public func _copyContents(
     initializing ptr: UnsafeMutablePointer<Iterator.Element>
   ) -> UnsafeMutablePointer<Iterator.Element> {
+    let end = _withContiguousStorageIfAvailable {
+      (source) -> UnsafeMutablePointer<Iterator.Element> in
+      if let sourceStart = source.baseAddress {
+        ptr.initializeFrom(sourceStart, count: source.count)
+      }
+      return ptr + source.count
+    }
+    if let end = end {
+      return end
+    }
+
     var p = UnsafeMutablePointer<Iterator.Element>(ptr)
     for x in IteratorSequence(self.makeIterator()) {
       p.initialize(with: x)
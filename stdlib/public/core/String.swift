@@ -309,6 +309,17 @@ extension String {
     return String._fromCodeUnitSequence(encoding, input: input)!
   }
 
+  /// Returns the string holding the well-formed UTF-8 in `input`, which
+  /// doesn't allocate if `input` is a single ASCII code unit.
+  static func _fromWellFormedUTF8(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>
+  ) -> String {
+    if input.count == 1 && input[0] < 0x80 {
+      return String(_StringCore(_asciiCharacter: input[0]))
+    }
+    return String._fromWellFormedCodeUnitSequence(UTF8.self, input: input)
+  }
+
   public // @testable
   static func _fromCodeUnitSequence<
     Encoding: UnicodeCodec, Input: Collection
@@ -344,8 +355,14 @@ extension String : _BuiltinUnicodeScalarLiteralConvertible {
   @effects(readonly)
   public // @testable
   init(_builtinUnicodeScalarLiteral value: Builtin.Int32) {
+    let scalar = UInt32(value)
+    if scalar < 0x80 {
+      self = String(_StringCore(
+        _asciiCharacter: UInt8(truncatingBitPattern: scalar)))
+      return
+    }
     self = String._fromWellFormedCodeUnitSequence(
-      UTF32.self, input: CollectionOfOne(UInt32(value)))
+      UTF32.self, input: CollectionOfOne(scalar))
   }
 }
 
@@ -367,9 +384,8 @@ extension String : _BuiltinExtendedGraphemeClusterLiteralConvertible {
     _builtinExtendedGraphemeClusterLiteral start: Builtin.RawPointer,
     utf8CodeUnitCount: Builtin.Word,
     isASCII: Builtin.Int1) {
-    self = String._fromWellFormedCodeUnitSequence(
-      UTF8.self,
-      input: UnsafeBufferPointer(
+    self = String._fromWellFormedUTF8(
+      UnsafeBufferPointer(
         start: UnsafeMutablePointer<UTF8.CodeUnit>(start),
         count: Int(utf8CodeUnitCount)))
   }
@@ -596,7 +612,7 @@ extension String {
       let lhsPtr = UnsafePointer<Int8>(_core.startASCII)
       let rhsPtr = UnsafePointer<Int8>(rhs._core.startASCII)
 
-      return Int(_swift_stdlib_unicode_compare_utf8_utf8(
+      return Int(_swift_stdlib_unicode_compare_ascii_ascii(
         lhsPtr, Int32(_core.count),
         rhsPtr, Int32(rhs._core.count)))
     }
@@ -91,6 +91,13 @@ public struct _StringBuffer {
     _ input: Input, encoding: Encoding.Type, repairIllFormedSequences: Bool,
     minimumCapacity: Int = 0
   ) -> (_StringBuffer?, hadError: Bool) {
+    if encoding == UTF8.self,
+       let utf8 = input as? UnsafeBufferPointer<UTF8.CodeUnit> {
+      return fromUTF8(
+        utf8, repairIllFormedSequences: repairIllFormedSequences,
+        minimumCapacity: minimumCapacity)
+    }
+
     // Determine how many UTF-16 code units we'll need
     let inputStream = input.makeIterator()
     guard let (utf16Count, isAscii) = UTF16.transcodedLength(
@@ -135,6 +142,38 @@ public struct _StringBuffer {
     }
   }
 
+  /// Like `fromCodeUnits`, for UTF-8 in contiguous memory, which is measured
+  /// and transcoded with `UTF8`'s buffer-level primitives.
+  static func fromUTF8(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>,
+    repairIllFormedSequences: Bool,
+    minimumCapacity: Int = 0
+  ) -> (_StringBuffer?, hadError: Bool) {
+    guard let (utf16Count, isAscii) = UTF8._transcodedLengthToUTF16(
+        of: input,
+        repairingIllFormedSequences: repairIllFormedSequences) else {
+      return (nil, true)
+    }
+
+    let result = _StringBuffer(
+        capacity: max(utf16Count, minimumCapacity),
+        initialSize: utf16Count,
+        elementWidth: isAscii ? 1 : 2)
+
+    if isAscii {
+      if utf16Count != 0 {
+        _memcpy(
+          dest: UnsafeMutablePointer(result.start),
+          src: UnsafeMutablePointer(input.baseAddress!),
+          size: UInt(utf16Count))
+      }
+      return (result, false)
+    }
+    let hadError = UTF8._transcodeToUTF16(
+      input, into: result._storage.baseAddress)
+    return (result, hadError)
+  }
+
   /// A pointer to the start of this buffer's data area.
   public // @testable
   var start: UnsafeMutablePointer<_RawByte> {
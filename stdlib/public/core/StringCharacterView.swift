@@ -198,6 +198,23 @@ extension String.CharacterView : BidirectionalCollection {
       }
 
       let startIndexUTF16 = start._position
+
+      // Fast path: no grapheme cluster rule joins two ASCII scalars other
+      // than CR-LF, so an ASCII scalar followed by another is a cluster of
+      // its own.
+      let core = start._core
+      let u0 = core[startIndexUTF16]
+      if u0 < 0x80 {
+        let next = startIndexUTF16 + 1
+        if next == end._position {
+          return 1
+        }
+        let u1 = core[next]
+        if u1 < 0x80 {
+          return u0 == 0x0d && u1 == 0x0a ? 2 : 1
+        }
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
@@ -238,6 +255,21 @@ extension String.CharacterView : BidirectionalCollection {
       }
 
       let endIndexUTF16 = end._position
+
+      // Fast path: see _measureExtendedGraphemeClusterForward.
+      let core = start._core
+      let u1 = core[endIndexUTF16 - 1]
+      if u1 < 0x80 {
+        let previous = endIndexUTF16 - 1
+        if previous == start._position {
+          return 1
+        }
+        let u0 = core[previous - 1]
+        if u0 < 0x80 {
+          return u0 == 0x0d && u1 == 0x0a ? 2 : 1
+        }
+      }
+
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
           _UnicodeGraphemeClusterBreakPropertyTrie()
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 /// The core implementation of a highly-optimizable String that
 /// can store both ASCII and UTF-16, and can wrap native Swift
 /// _StringBuffer or NSString instances.
@@ -520,6 +522,27 @@ public struct _StringCore {
     _invariantCheck()
   }
 
+  /// Append the ASCII code units in `ascii` to `self`.
+  ///
+  /// - Complexity: O(`ascii.count`), amortized over repeated appends.
+  mutating func _appendASCII(_ ascii: UnsafeBufferPointer<UTF8.CodeUnit>) {
+    _invariantCheck()
+    let destination = _growBuffer(count + ascii.count, minElementWidth: 1)
+
+    if _fastPath(elementWidth == 1) {
+      UnsafeMutablePointer<UTF8.CodeUnit>(destination).initializeFrom(
+        UnsafeMutablePointer(ascii.baseAddress!), count: ascii.count)
+    }
+    else {
+      let destination16
+        = UnsafeMutablePointer<UTF16.CodeUnit>(destination._rawValue)
+      for i in 0..<ascii.count {
+        destination16[i] = UTF16.CodeUnit(ascii[i])
+      }
+    }
+    _invariantCheck()
+  }
+
   @inline(never)
   mutating func append(_ rhs: _StringCore) {
     _invariantCheck()
@@ -729,3 +752,21 @@ var _emptyStringBase: OpaquePointer {
   return OpaquePointer(
     UnsafeMutablePointer<UInt16>(Builtin.addressof(&_emptyStringStorage)))
 }
+
+extension _StringCore {
+  /// Create a string holding just the ASCII code unit `c`, backed by
+  /// statically-allocated storage rather than a new `_StringBuffer`.
+  ///
+  /// Like a string literal, the result has no owner, so it is never retained
+  /// and is copied the first time it is appended to.
+  init(_asciiCharacter c: UInt8) {
+    _sanityCheck(c < 0x80, "not an ASCII code unit")
+    self.init(
+      baseAddress: OpaquePointer(
+        _swift_stdlib_ASCIICharacterStrings + Int(c) &* 2),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+}
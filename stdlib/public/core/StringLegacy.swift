@@ -65,6 +65,11 @@ extension String {
 
 extension String {
   public init(_ _c: UnicodeScalar) {
+    if _c.isASCII {
+      self = String(_StringCore(
+        _asciiCharacter: UInt8(truncatingBitPattern: _c.value)))
+      return
+    }
     self = String(repeating: _c, count: 1)
   }
 }
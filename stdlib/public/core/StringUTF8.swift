@@ -475,6 +475,24 @@ public func < (
 }
 
 // Index conversions
+extension String.UTF8View {
+  /// If the string is stored as contiguous ASCII, in which every code unit
+  /// is one byte of UTF-8, call `body` with a buffer pointer to the code
+  /// units of this view and return its result.  Otherwise, return `nil`.
+  public func _withContiguousStorageIfAvailable<R>(
+    _ body: @noescape (UnsafeBufferPointer<UTF8.CodeUnit>) throws -> R
+  ) rethrows -> R? {
+    guard _core.isASCII && _core.hasContiguousStorage && _core.count != 0
+      else { return nil }
+    defer { _fixLifetime(_core) }
+    let start = _startIndex._coreIndex
+    return try body(
+      UnsafeBufferPointer(
+        start: UnsafePointer(_core.startASCII) + start,
+        count: _endIndex._coreIndex - start))
+  }
+}
+
 extension String.UTF8View.Index {
   internal init(_ core: _StringCore, _utf16Offset: Int) {
       let (_, buffer) = core._encodeSomeUTF8(from: _utf16Offset)
@@ -441,6 +441,148 @@ public struct UTF8 : UnicodeCodec {
   }
 }
 
+// Buffer-level UTF-8 primitives.  Unlike `decode(_:)` they work on code
+// units in contiguous memory, so runs of ASCII can be examined a word at a
+// time rather than one code unit at a time.
+extension UTF8 {
+  /// Returns the number of ASCII code units at the start of `input`.
+  public // @testable
+  static func _asciiPrefixCount(_ input: UnsafeBufferPointer<CodeUnit>) -> Int {
+    guard let start = input.baseAddress else { return 0 }
+    let count = input.count
+    let wordSize = strideof(UInt.self)
+    let highBits = (~UInt(0) / 0xff) << 7
+
+    // Examine single code units until the rest of `input` is word-aligned.
+    let misalignment = Int(UInt(bitPattern: start) & UInt(wordSize &- 1))
+    let alignedOffset = min(count, (wordSize &- misalignment) & (wordSize &- 1))
+    var i = 0
+    while i < alignedOffset {
+      if start[i] & 0x80 != 0 { return i }
+      i += 1
+    }
+
+    // Two words at a time, then one, then finish the tail.
+    while i + 2 &* wordSize <= count {
+      let words = UnsafePointer<UInt>(start + i)
+      if (words[0] | words[1]) & highBits != 0 { break }
+      i += 2 &* wordSize
+    }
+    while i + wordSize <= count {
+      if UnsafePointer<UInt>(start + i).pointee & highBits != 0 { break }
+      i += wordSize
+    }
+    while i < count && start[i] & 0x80 == 0 {
+      i += 1
+    }
+    return i
+  }
+
+  /// Decodes the code unit sequence starting at offset `i` of `input`, with
+  /// the same results as `_decodeOne(_: UInt32)`.
+  internal static func _decodeOne(
+    _ input: UnsafeBufferPointer<CodeUnit>, at i: Int
+  ) -> (result: UInt32?, length: UInt8) {
+    _sanityCheck(i >= 0 && i < input.count)
+    var buffer: UInt32 = 0
+    var shift: UInt32 = 0
+    for j in i..<min(i + 4, input.count) {
+      buffer |= UInt32(input[j]) << shift
+      shift += 8
+    }
+    return _decodeOne(buffer)
+  }
+
+  /// Returns the number of UTF-16 code units needed to hold `input`, and
+  /// whether `input` is all ASCII.
+  ///
+  /// The result is the same as that of
+  /// `UTF16.transcodedLength(of:decodedAs:repairingIllFormedSequences:)`
+  /// for `input`, decoded as UTF-8.
+  public // @testable
+  static func _transcodedLengthToUTF16(
+    of input: UnsafeBufferPointer<CodeUnit>,
+    repairingIllFormedSequences: Bool
+  ) -> (count: Int, isASCII: Bool)? {
+    let inputCount = input.count
+    var i = _asciiPrefixCount(input)
+    if i == inputCount {
+      return (i, true)
+    }
+
+    let start = input.baseAddress!
+    var count = i
+    while i < inputCount {
+      if start[i] & 0x80 == 0 {
+        let n = _asciiPrefixCount(
+          UnsafeBufferPointer(start: start + i, count: inputCount - i))
+        i += n
+        count += n
+        continue
+      }
+      let (result, length) = _decodeOne(input, at: i)
+      i += Int(length)
+      if let scalar = result {
+        count += scalar > 0xffff ? 2 : 1
+      } else {
+        if !repairingIllFormedSequences {
+          return nil
+        }
+        count += 1
+      }
+    }
+    return (count, false)
+  }
+
+  /// Transcodes `input` to UTF-16, replacing ill-formed sequences with
+  /// U+FFFD, and writes the result to `output`, which must have room for the
+  /// count that `_transcodedLengthToUTF16(of:repairingIllFormedSequences:)`
+  /// returns.
+  ///
+  /// - Returns: `true` if `input` contained ill-formed sequences.
+  public // @testable
+  static func _transcodeToUTF16(
+    _ input: UnsafeBufferPointer<CodeUnit>,
+    into output: UnsafeMutablePointer<UTF16.CodeUnit>
+  ) -> Bool {
+    guard let start = input.baseAddress else { return false }
+    let inputCount = input.count
+    var hadError = false
+    var i = 0
+    var p = output
+    while i < inputCount {
+      if start[i] & 0x80 == 0 {
+        let n = _asciiPrefixCount(
+          UnsafeBufferPointer(start: start + i, count: inputCount - i))
+        for j in 0..<n {
+          p[j] = UTF16.CodeUnit(start[i + j])
+        }
+        i += n
+        p += n
+        continue
+      }
+      let (result, length) = _decodeOne(input, at: i)
+      i += Int(length)
+      guard let scalar = result else {
+        hadError = true
+        p.pointee = 0xfffd
+        p += 1
+        continue
+      }
+      if scalar <= 0xffff {
+        p.pointee = UTF16.CodeUnit(truncatingBitPattern: scalar)
+        p += 1
+      } else {
+        let us = UnicodeScalar(_unchecked: scalar)
+        p[0] = UTF16.leadSurrogate(us)
+        p[1] = UTF16.trailSurrogate(us)
+        p += 2
+      }
+    }
+    return hadError
+  }
+}
+
 /// A codec for translating between Unicode scalar values and UTF-16 code
 /// units.
 public struct UTF16 : UnicodeCodec {
@@ -370,6 +370,12 @@ func _ascii16(_ c: UnicodeScalar) -> UTF16.CodeUnit {
   return UTF16.CodeUnit(c.value)
 }
 
+/// Returns c as a UTF8.CodeUnit.  Meant to be used as _ascii8("x").
+internal func _ascii8(_ c: UnicodeScalar) -> UTF8.CodeUnit {
+  _sanityCheck(c.value >= 0 && c.value <= 0x7F, "not ASCII")
+  return UTF8.CodeUnit(c.value)
+}
+
 extension UnicodeScalar {
   /// Creates an instance of the NUL scalar value.
   @available(*, unavailable, message: "use 'UnicodeScalar(0)'")
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// A wrapper around the control bytes of a hash table with `capacity`
+/// buckets: one byte per bucket, stored in words so that a group of
+/// `bytesPerGroup` buckets can be examined at once.
+///
+/// The byte of an empty bucket is `emptyByte`. The byte of an occupied bucket
+/// has its high bit set and holds seven bits of the hash of the key stored in
+/// it, so most buckets holding other keys can be skipped without comparing
+/// keys. If `capacity` is smaller than a group, the bytes past the end are
+/// `paddingByte`, which is neither empty nor occupied.
+public // @testable
+struct _UnsafeHashControlBytes {
+  public // @testable
+  let values: UnsafeMutablePointer<UInt>
+
+  public // @testable
+  let capacity: Int
+
+  public // @testable
+  static var emptyByte: UInt8 { return 0 }
+
+  public // @testable
+  static var paddingByte: UInt8 { return 1 }
+
+  public // @testable
+  static var bytesPerGroup: Int { return strideof(UInt.self) }
+
+  /// Returns the control byte for a key whose hash, after `_mixInt`, is
+  /// `mixedHashValue`.
+  ///
+  /// The byte is taken from the top bits of the hash, which are not used to
+  /// pick the key's bucket in any table that fits in memory.
+  public // @testable
+  static func occupiedByte(forMixedHashValue mixedHashValue: UInt) -> UInt8 {
+    return 0x80 | UInt8(truncatingBitPattern:
+      mixedHashValue >> UInt(UInt._sizeInBits - 7))
+  }
+
+  public // @testable
+  static func isOccupied(_ byte: UInt8) -> Bool {
+    return byte & 0x80 != 0
+  }
+
+  public // @testable
+  static func groupIndex(_ i: Int) -> Int {
+    // Note: We perform the operation on UInts to get faster unsigned math
+    // (shifts).
+    return Int(bitPattern: UInt(bitPattern: i) / UInt(bytesPerGroup))
+  }
+
+  public // @testable
+  static func byteIndex(_ i: Int) -> Int {
+    return Int(bitPattern: UInt(bitPattern: i) % UInt(bytesPerGroup))
+  }
+
+  public // @testable
+  static func sizeInWords(forCapacity capacity: Int) -> Int {
+    return (capacity + bytesPerGroup - 1) / bytesPerGroup
+  }
+
+  /// Returns a word with the high bit of each byte of `group` that equals
+  /// `byte` set.
+  ///
+  /// A byte just above a match may also be reported, but the lowest bit set
+  /// is always a true match.
+  public // @testable
+  static func matches(_ byte: UInt8, in group: UInt) -> UInt {
+    let lowBits = ~UInt(0) / 0xff
+    let highBits = lowBits << 7
+    let x = group ^ (lowBits &* UInt(byte))
+    return (x &- lowBits) & ~x & highBits
+  }
+
+  /// Returns the index of the byte marked by the lowest bit set in `mask`,
+  /// which must not be zero.
+  public // @testable
+  static func lowestByteIndex(_ mask: UInt) -> Int {
+    _sanityCheck(mask != 0)
+    let bit = Int(Int64(Builtin.int_cttz_Int64(
+      UInt64(mask)._value, true._value)))
+    return bit / 8
+  }
+
+  public // @testable
+  init(storage: UnsafeMutablePointer<UInt>, capacity: Int) {
+    self.capacity = capacity
+    self.values = storage
+  }
+
+  public // @testable
+  var numberOfGroups: Int {
+    return _UnsafeHashControlBytes.sizeInWords(forCapacity: capacity)
+  }
+
+  /// Marks every bucket empty.
+  public // @testable
+  func initializeToEmpty() {
+    let numberOfBytes =
+      numberOfGroups * _UnsafeHashControlBytes.bytesPerGroup
+    let bytes = UnsafeMutablePointer<UInt8>(values)
+    bytes.initialize(
+      with: _UnsafeHashControlBytes.emptyByte, count: capacity)
+    (bytes + capacity).initialize(
+      with: _UnsafeHashControlBytes.paddingByte,
+      count: numberOfBytes - capacity)
+  }
+
+  /// Returns group `g`, with the byte of its first bucket in the low bits.
+  public // @testable
+  func group(at g: Int) -> UInt {
+    _sanityCheck(g < numberOfGroups && g >= 0, "index out of bounds")
+    return UInt(littleEndian: values[g])
+  }
+
+  public // @testable
+  subscript(i: Int) -> UInt8 {
+    get {
+      _sanityCheck(i < capacity && i >= 0, "index out of bounds")
+      return UnsafeMutablePointer<UInt8>(values)[i]
+    }
+    nonmutating set {
+      _sanityCheck(i < capacity && i >= 0, "index out of bounds")
+      UnsafeMutablePointer<UInt8>(values)[i] = newValue
+    }
+  }
+}
@@ -18,17 +18,17 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PointerIntPair.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
 #include "Private.h"
+#include "RuntimeStats.h"
 #include "../SwiftShims/RuntimeShims.h"
 #include "stddef.h"
 
@@ -318,54 +318,79 @@ std::string swift::nameForMetadata(const Metadata *type,
   return result;
 }
 
-SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
-extern "C"
-TwoWordPair<const char *, uintptr_t>::Return
-swift_getTypeName(const Metadata *type, bool qualified) {
-  using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
+namespace {
+  struct TypeNameCacheKey {
+    const Metadata *Type;
+    bool Qualified;
 
-  static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
-  auto &cache = TypeNameCache.get();
+    TypeNameCacheKey(const Metadata *type, bool qualified)
+      : Type(type), Qualified(qualified) {}
+  };
 
-  // Attempt read-only lookup of cache entry.
-  {
-    StaticScopedReadLock guard(TypeNameCacheLock);
+  /// The name of a type, allocated after the entry.
+  struct TypeNameCacheEntry {
+  private:
+    const Metadata * const Type;
+    const bool Qualified;
+    const size_t Length;
 
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
+    char *getTrailingName() {
+      return reinterpret_cast<char *>(this + 1);
+    }
+
+  public:
+    TypeNameCacheEntry(TypeNameCacheKey key, const std::string &name)
+      : Type(key.Type), Qualified(key.Qualified), Length(name.size()) {
+      memcpy(getTrailingName(), name.c_str(), Length + 1);
     }
-  }
 
-  // Read-only lookup failed to find item, we may need to create it.
-  {
-    StaticScopedWriteLock guard(TypeNameCacheLock);
+    const char *getName() { return getTrailingName(); }
+    size_t getLength() const { return Length; }
 
-    // Do lookup again just to make sure it wasn't created by another
-    // thread before we acquired the write lock.
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
+    int compareWithKey(TypeNameCacheKey key) const {
+      if (key.Type != Type) {
+        return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
+      } else if (key.Qualified != Qualified) {
+        return (key.Qualified < Qualified ? -1 : 1);
+      } else {
+        return 0;
+      }
     }
 
-    // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
-    // Copy it to memory we can reference forever.
-    auto size = name.size();
-    auto result = (char *)malloc(size + 1);
-    memcpy(result, name.data(), size);
-    result[size] = 0;
+    static size_t getKeyHash(TypeNameCacheKey key) {
+      uintptr_t type = reinterpret_cast<uintptr_t>(key.Type);
+      size_t hash = (type >> 4) ^ (type >> 20) ^ size_t(key.Qualified);
+      return hash * 0x27d4eb2d;
+    }
 
-    cache.insert({key, {result, size}});
-    return Pair{result, size};
-  }
+    static size_t getExtraAllocationSize(TypeNameCacheKey key,
+                                         const std::string &name) {
+      return name.size() + 1;
+    }
+  };
+}
+
+/// Names of types. Lookups don't take a lock, so that threads which print
+/// types don't contend with each other.
+static Lazy<ConcurrentHashMap<TypeNameCacheEntry>> TypeNameCache;
+
+SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
+extern "C"
+TwoWordPair<const char *, uintptr_t>::Return
+swift_getTypeName(const Metadata *type, bool qualified) {
+  using Pair = TwoWordPair<const char *, uintptr_t>;
+
+  auto &cache = TypeNameCache.get();
+  TypeNameCacheKey key(type, qualified);
+
+  if (auto entry = cache.find(key))
+    return Pair{entry->getName(), entry->getLength()};
+
+  // Build the name outside of the cache's lock. If another thread inserts
+  // the same name first, its entry is used and ours is dropped.
+  auto name = nameForMetadata(type, qualified);
+  auto entry = cache.getOrInsert(key, name).first;
+  return Pair{entry->getName(), entry->getLength()};
 }
 
 /// Report a dynamic cast failure.
@@ -1024,6 +1049,181 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
   }
 }
 
+namespace {
+  struct DynamicCastCacheKey {
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+
+    DynamicCastCacheKey(const Metadata *srcType,
+                        const ExistentialTypeMetadata *targetType)
+      : SrcType(srcType), TargetType(targetType) {}
+  };
+
+  /// The resolved plan for casting values of one type to one opaque
+  /// existential type: either the witness tables to wrap the value with, or
+  /// a failure. The witness tables are allocated after the entry.
+  struct DynamicCastCacheEntry {
+  private:
+    const Metadata *SrcType;
+    const ExistentialTypeMetadata *TargetType;
+    bool Succeeded;
+    std::atomic<uintptr_t> FailureGeneration;
+
+    const WitnessTable **getTrailingWitnessTables() {
+      return reinterpret_cast<const WitnessTable **>(this + 1);
+    }
+
+  public:
+    DynamicCastCacheEntry(DynamicCastCacheKey key, bool succeeded,
+                          const WitnessTable * const *witnessTables,
+                          uintptr_t failureGeneration)
+      : SrcType(key.SrcType), TargetType(key.TargetType),
+        Succeeded(succeeded), FailureGeneration(failureGeneration) {
+      if (succeeded)
+        memcpy(getTrailingWitnessTables(), witnessTables,
+               getNumWitnessTables(key) * sizeof(const WitnessTable *));
+    }
+
+    static unsigned getNumWitnessTables(DynamicCastCacheKey key) {
+      return key.TargetType->Flags.getNumWitnessTables();
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(DynamicCastCacheKey key,
+                                         Args &&... ignored) {
+      return getNumWitnessTables(key) * sizeof(const WitnessTable *);
+    }
+
+    static size_t getKeyHash(DynamicCastCacheKey key) {
+      uintptr_t src = reinterpret_cast<uintptr_t>(key.SrcType);
+      uintptr_t target = reinterpret_cast<uintptr_t>(key.TargetType);
+      size_t hash = (src >> 4) ^ (src >> 20) ^ (target >> 3) ^ (target << 7);
+      return hash * 0x27d4eb2d;
+    }
+
+    int compareWithKey(DynamicCastCacheKey key) const {
+      if (key.SrcType != SrcType) {
+        return (uintptr_t(key.SrcType) < uintptr_t(SrcType) ? -1 : 1);
+      } else if (key.TargetType != TargetType) {
+        return (uintptr_t(key.TargetType) < uintptr_t(TargetType) ? -1 : 1);
+      } else {
+        return 0;
+      }
+    }
+
+    bool isSuccessful() const { return Succeeded; }
+
+    /// Copy the cached witness tables into an existential container.
+    void copyWitnessTables(const WitnessTable **dest) {
+      assert(isSuccessful());
+      memcpy(dest, getTrailingWitnessTables(),
+             TargetType->Flags.getNumWitnessTables() *
+               sizeof(const WitnessTable *));
+    }
+
+    /// Get the conformance generation under which this cast failed.
+    uintptr_t getFailureGeneration() const {
+      assert(!isSuccessful());
+      return FailureGeneration.load(std::memory_order_relaxed);
+    }
+
+    void updateFailureGeneration(uintptr_t failureGeneration) {
+      assert(!isSuccessful());
+      FailureGeneration.store(failureGeneration, std::memory_order_relaxed);
+    }
+  };
+}
+
+/// Resolved casts from value types to opaque existentials. Successes are
+/// valid forever; failures only until new conformances are registered.
+static Lazy<ConcurrentHashMap<DynamicCastCacheEntry>> DynamicCastCache;
+
+/// Whether casts from \p srcType to \p targetType can go through the cast
+/// cache. The result of the cast must depend only on the two types, and
+/// not on the value being cast, so class and existential sources (whose
+/// dynamic type varies) are excluded.
+static bool canUseDynamicCastCache(const Metadata *srcType,
+                                   const ExistentialTypeMetadata *targetType) {
+  if (targetType->getRepresentation() != ExistentialTypeRepresentation::Opaque)
+    return false;
+
+  switch (srcType->getKind()) {
+  case MetadataKind::Struct:
+  case MetadataKind::Enum:
+  case MetadataKind::Tuple:
+    return true;
+
+  case MetadataKind::Optional:
+  case MetadataKind::Class:
+  case MetadataKind::ObjCClassWrapper:
+  case MetadataKind::ForeignClass:
+  case MetadataKind::Existential:
+  case MetadataKind::ExistentialMetatype:
+  case MetadataKind::Metatype:
+  case MetadataKind::Function:
+  case MetadataKind::HeapLocalVariable:
+  case MetadataKind::HeapGenericLocalVariable:
+  case MetadataKind::ErrorObject:
+  case MetadataKind::Opaque:
+    return false;
+  }
+  _failCorruptType(srcType);
+}
+
+/// Perform a dynamic cast of a value type to an opaque existential type,
+/// checking the protocol conformances only the first time a given pair of
+/// types is seen.
+static bool
+_dynamicCastValueToOpaqueExistentialCached(OpaqueValue *dest,
+                                     OpaqueValue *src,
+                                     const Metadata *srcType,
+                                     const ExistentialTypeMetadata *targetType,
+                                     DynamicCastFlags flags) {
+  auto destExistential = reinterpret_cast<OpaqueExistentialContainer*>(dest);
+  auto &cache = DynamicCastCache.get();
+  DynamicCastCacheKey key(srcType, targetType);
+
+  // Read the generation before checking the conformances, so that a failure
+  // computed while new conformances are being registered is never
+  // considered up to date.
+  uintptr_t generation = _swift_getProtocolConformanceGeneration();
+
+  bool succeeded;
+  auto entry = cache.find(key);
+  if (entry && entry->isSuccessful()) {
+    entry->copyWitnessTables(destExistential->getWitnessTables());
+    succeeded = true;
+  } else if (entry && entry->getFailureGeneration() == generation) {
+    succeeded = false;
+  } else {
+    // Resolve the cast, using the destination's witness table slots as
+    // scratch space.
+    runtime_stats::countEvent(runtime_stats::Event::DynamicCastCacheMisses);
+    succeeded = _conformsToProtocols(nullptr, srcType, targetType->Protocols,
+                                     destExistential->getWitnessTables());
+    if (!entry) {
+      cache.getOrInsert(key, succeeded, destExistential->getWitnessTables(),
+                        generation);
+    } else if (!succeeded) {
+      entry->updateFailureGeneration(generation);
+    }
+    // A cast that used to fail but now succeeds keeps its stale entry, and
+    // is resolved again each time. This only happens after new
+    // conformances are loaded.
+  }
+
+  if (!succeeded)
+    return _fail(src, srcType, targetType, flags);
+
+  destExistential->Type = srcType;
+  if (flags & DynamicCastFlags::TakeOnSuccess) {
+    srcType->vw_initializeBufferWithTake(&destExistential->Buffer, src);
+  } else {
+    srcType->vw_initializeBufferWithCopy(&destExistential->Buffer, src);
+  }
+  return true;
+}
+
 static const void *
 _dynamicCastUnknownClassToExistential(const void *object,
                                     const ExistentialTypeMetadata *targetType) {
@@ -2049,6 +2249,8 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  runtime_stats::EntryPointScope stats(
+    runtime_stats::EntryPoint::swift_dynamicCast);
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
@@ -2143,10 +2345,15 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
     }
     break;
 
-  case MetadataKind::Existential:
+  case MetadataKind::Existential: {
+    auto targetExistentialType = cast<ExistentialTypeMetadata>(targetType);
+    if (canUseDynamicCastCache(srcType, targetExistentialType))
+      return _dynamicCastValueToOpaqueExistentialCached(dest, src, srcType,
+                                                        targetExistentialType,
+                                                        flags);
     return _dynamicCastToExistential(dest, src, srcType,
-                                     cast<ExistentialTypeMetadata>(targetType),
-                                     flags);
+                                     targetExistentialType, flags);
+  }
 
   case MetadataKind::Metatype:
     return _dynamicCastToMetatype(dest, src, srcType,
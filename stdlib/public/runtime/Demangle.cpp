@@ -11,54 +11,61 @@
 static Demangle::NodePointer
 _buildDemanglingForNominalType(Demangle::Node::Kind boundGenericKind,
                                const Metadata *type,
-                               const NominalTypeDescriptor *description) {
+                               const NominalTypeDescriptor *description,
+                               Demangle::NodeFactory &Factory) {
   using namespace Demangle;
   
   // Demangle the base name.
   auto node = demangleTypeAsNode(description->Name,
-                                     strlen(description->Name));
+                                 strlen(description->Name), Factory);
   // If generic, demangle the type parameters.
   if (description->GenericParams.NumPrimaryParams > 0) {
-    auto typeParams = NodeFactory::create(Node::Kind::TypeList);
+    auto typeParams = Factory.createNode(Node::Kind::TypeList);
     auto typeBytes = reinterpret_cast<const char *>(type);
     auto genericParam = reinterpret_cast<const Metadata * const *>(
                  typeBytes + sizeof(void*) * description->GenericParams.Offset);
     for (unsigned i = 0, e = description->GenericParams.NumPrimaryParams;
          i < e; ++i, ++genericParam) {
-      auto demangling = _swift_buildDemanglingForMetadata(*genericParam);
+      auto demangling = _swift_buildDemanglingForMetadata(*genericParam,
+                                                          Factory);
       if (demangling == nullptr)
         return nullptr;
-      typeParams->addChild(demangling);
+      typeParams->addChild(demangling, Factory);
     }
 
-    auto genericNode = NodeFactory::create(boundGenericKind);
-    genericNode->addChild(node);
-    genericNode->addChild(typeParams);
+    auto genericNode = Factory.createNode(boundGenericKind);
+    genericNode->addChild(node, Factory);
+    genericNode->addChild(typeParams, Factory);
     return genericNode;
   }
   return node;
 }
 
 // Build a demangled type tree for a type.
-Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *type) {
+Demangle::NodePointer
+swift::_swift_buildDemanglingForMetadata(const Metadata *type,
+                                         Demangle::NodeFactory &Factory) {
   using namespace Demangle;
 
   switch (type->getKind()) {
   case MetadataKind::Class: {
     auto classType = static_cast<const ClassMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericClass,
-                                          type, classType->getDescription());
+                                          type, classType->getDescription(),
+                                          Factory);
   }
   case MetadataKind::Enum:
   case MetadataKind::Optional: {
     auto structType = static_cast<const EnumMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericEnum,
-                                          type, structType->Description);
+                                          type, structType->Description,
+                                          Factory);
   }
   case MetadataKind::Struct: {
     auto structType = static_cast<const StructMetadata *>(type);
     return _buildDemanglingForNominalType(Node::Kind::BoundGenericStructure,
-                                          type, structType->Description);
+                                          type, structType->Description,
+                                          Factory);
   }
   case MetadataKind::ObjCClassWrapper: {
 #if SWIFT_OBJC_INTEROP
@@ -66,12 +73,12 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     const char *className = class_getName((Class)objcWrapper->Class);
     
     // ObjC classes mangle as being in the magic "__ObjC" module.
-    auto module = NodeFactory::create(Node::Kind::Module, "__ObjC");
+    auto module = Factory.createNode(Node::Kind::Module, "__ObjC");
     
-    auto node = NodeFactory::create(Node::Kind::Class);
-    node->addChild(module);
-    node->addChild(NodeFactory::create(Node::Kind::Identifier,
-                                       llvm::StringRef(className)));
+    auto node = Factory.createNode(Node::Kind::Class);
+    node->addChild(module, Factory);
+    node->addChild(Factory.createNode(Node::Kind::Identifier,
+                                      llvm::StringRef(className)), Factory);
     
     return node;
 #else
@@ -82,14 +89,14 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
   case MetadataKind::ForeignClass: {
     auto foreign = static_cast<const ForeignClassMetadata *>(type);
     return Demangle::demangleTypeAsNode(foreign->getName(),
-                                        strlen(foreign->getName()));
+                                        strlen(foreign->getName()), Factory);
   }
   case MetadataKind::Existential: {
     auto exis = static_cast<const ExistentialTypeMetadata *>(type);
-    NodePointer proto_list = NodeFactory::create(Node::Kind::ProtocolList);
-    NodePointer type_list = NodeFactory::create(Node::Kind::TypeList);
+    NodePointer proto_list = Factory.createNode(Node::Kind::ProtocolList);
+    NodePointer type_list = Factory.createNode(Node::Kind::TypeList);
 
-    proto_list->addChild(type_list);
+    proto_list->addChild(type_list, Factory);
     
     std::vector<const ProtocolDescriptor *> protocols;
     protocols.reserve(exis->Protocols.NumProtocols);
@@ -107,19 +114,21 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     for (auto *protocol : protocols) {
       // The protocol name is mangled as a type symbol, with the _Tt prefix.
       auto protocolNode = demangleSymbolAsNode(protocol->Name,
-                                               strlen(protocol->Name));
+                                               strlen(protocol->Name),
+                                               Factory);
       
       // ObjC protocol names aren't mangled.
       if (!protocolNode) {
-        auto module = NodeFactory::create(Node::Kind::Module,
-                                          MANGLING_MODULE_OBJC);
-        auto node = NodeFactory::create(Node::Kind::Protocol);
-        node->addChild(module);
-        node->addChild(NodeFactory::create(Node::Kind::Identifier,
-                                           llvm::StringRef(protocol->Name)));
-        auto typeNode = NodeFactory::create(Node::Kind::Type);
-        typeNode->addChild(node);
-        type_list->addChild(typeNode);
+        auto module = Factory.createNode(Node::Kind::Module,
+                                         MANGLING_MODULE_OBJC);
+        auto node = Factory.createNode(Node::Kind::Protocol);
+        node->addChild(module, Factory);
+        node->addChild(Factory.createNode(Node::Kind::Identifier,
+                                          llvm::StringRef(protocol->Name)),
+                       Factory);
+        auto typeNode = Factory.createNode(Node::Kind::Type);
+        typeNode->addChild(node, Factory);
+        type_list->addChild(typeNode, Factory);
         continue;
       }
 
@@ -133,16 +142,17 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
       
       assert(protocolNode->getKind() == Node::Kind::Type);
       assert(protocolNode->getChild(0)->getKind() == Node::Kind::Protocol);
-      type_list->addChild(protocolNode);
+      type_list->addChild(protocolNode, Factory);
     }
     
     return proto_list;
   }
   case MetadataKind::ExistentialMetatype: {
     auto metatype = static_cast<const ExistentialMetatypeMetadata *>(type);
-    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType);
-    auto node = NodeFactory::create(Node::Kind::ExistentialMetatype);
-    node->addChild(instance);
+    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType,
+                                                      Factory);
+    auto node = Factory.createNode(Node::Kind::ExistentialMetatype);
+    node->addChild(instance, Factory);
     return node;
   }
   case MetadataKind::Function: {
@@ -167,10 +177,10 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
     std::vector<NodePointer> inputs;
     for (unsigned i = 0, e = func->getNumArguments(); i < e; ++i) {
       auto arg = func->getArguments()[i];
-      auto input = _swift_buildDemanglingForMetadata(arg.getPointer());
+      auto input = _swift_buildDemanglingForMetadata(arg.getPointer(), Factory);
       if (arg.getFlag()) {
-        NodePointer inout = NodeFactory::create(Node::Kind::InOut);
-        inout->addChild(input);
+        NodePointer inout = Factory.createNode(Node::Kind::InOut);
+        inout->addChild(input, Factory);
         input = inout;
       }
       inputs.push_back(input);
@@ -178,41 +188,45 @@ Demangle::NodePointer swift::_swift_buildDemanglingForMetadata(const Metadata *t
 
     NodePointer totalInput;
     if (inputs.size() > 1) {
-      auto tuple = NodeFactory::create(Node::Kind::NonVariadicTuple);
+      auto tuple = Factory.createNode(Node::Kind::NonVariadicTuple);
       for (auto &input : inputs)
-        tuple->addChild(input);
+        tuple->addChild(input, Factory);
       totalInput = tuple;
     } else {
       totalInput = inputs.front();
     }
     
-    NodePointer args = NodeFactory::create(Node::Kind::ArgumentTuple);
-    args->addChild(totalInput);
+    NodePointer args = Factory.createNode(Node::Kind::ArgumentTuple);
+    args->addChild(totalInput, Factory);
     
-    NodePointer resultTy = _swift_buildDemanglingForMetadata(func->ResultType);
-    NodePointer result = NodeFactory::create(Node::Kind::ReturnType);
-    result->addChild(resultTy);
+    NodePointer resultTy = _swift_buildDemanglingForMetadata(func->ResultType,
+                                                             Factory);
+    NodePointer result = Factory.createNode(Node::Kind::ReturnType);
+    result->addChild(resultTy, Factory);
     
-    auto funcNode = NodeFactory::create(kind);
+    auto funcNode = Factory.createNode(kind);
     if (func->throws())
-      funcNode->addChild(NodeFactory::create(Node::Kind::ThrowsAnnotation));
-    funcNode->addChild(args);
-    funcNode->addChild(result);
+      funcNode->addChild(Factory.createNode(Node::Kind::ThrowsAnnotation),
+                         Factory);
+    funcNode->addChild(args, Factory);
+    funcNode->addChild(result, Factory);
     return funcNode;
   }
   case MetadataKind::Metatype: {
     auto metatype = static_cast<const MetatypeMetadata *>(type);
-    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType);
-    auto node = NodeFactory::create(Node::Kind::Metatype);
-    node->addChild(instance);
+    auto instance = _swift_buildDemanglingForMetadata(metatype->InstanceType,
+                                                      Factory);
+    auto node = Factory.createNode(Node::Kind::Metatype);
+    node->addChild(instance, Factory);
     return node;
   }
   case MetadataKind::Tuple: {
     auto tuple = static_cast<const TupleTypeMetadata *>(type);
-    auto tupleNode = NodeFactory::create(Node::Kind::NonVariadicTuple);
+    auto tupleNode = Factory.createNode(Node::Kind::NonVariadicTuple);
     for (unsigned i = 0, e = tuple->NumElements; i < e; ++i) {
-      auto elt = _swift_buildDemanglingForMetadata(tuple->getElement(i).Type);
-      tupleNode->addChild(elt);
+      auto elt = _swift_buildDemanglingForMetadata(tuple->getElement(i).Type,
+                                                   Factory);
+      tupleNode->addChild(elt, Factory);
     }
     return tupleNode;
   }
@@ -18,6 +18,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <stdio.h>
+#include <cstring>
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "Private.h"
@@ -62,13 +65,10 @@ static const FullMetadata<HeapMetadata> ErrorProtocolMetadata{
   Metadata{MetadataKind::ErrorObject},
 };
 
-SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
-extern "C"
-BoxPair::Return
-swift::swift_allocError(const swift::Metadata *type,
-                        const swift::WitnessTable *errorConformance,
-                        OpaqueValue *initialValue,
-                        bool isTake) {
+static BoxPair::Return _allocErrorBox(const Metadata *type,
+                                     const WitnessTable *errorConformance,
+                                     OpaqueValue *initialValue,
+                                     bool isTake) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   
   auto allocated = swift_allocObject(&ErrorProtocolMetadata,
@@ -91,8 +91,99 @@ swift::swift_allocError(const swift::Metadata *type,
   return BoxPair{allocated, valuePtr};
 }
 
+namespace {
+
+/// Identifies a shared box: the type and conformance of the error, and its
+/// value if it has one.
+struct SharedErrorBoxKey {
+  const Metadata *Type;
+  const WitnessTable *ErrorConformance;
+  uint8_t Value;
+};
+
+/// A box which is shared by every error with the same key. The map holds a
+/// reference to it, so it's never destroyed.
+struct SharedErrorBoxEntry {
+  SharedErrorBoxKey Key;
+  BoxPair Box;
+
+  SharedErrorBoxEntry(SharedErrorBoxKey key)
+    : Key(key),
+      Box(_allocErrorBox(key.Type, key.ErrorConformance,
+                         reinterpret_cast<OpaqueValue *>(&key.Value),
+                         /*isTake*/ true)) {}
+
+  ~SharedErrorBoxEntry() {
+    // Only reached for an entry which lost a race to be inserted.
+    swift_release(Box.first);
+  }
+
+  long getKeyValueForDump() const {
+    return reinterpret_cast<long>(Key.Type);
+  }
+
+  int compareWithKey(const SharedErrorBoxKey &key) const {
+    if (key.Type != Key.Type)
+      return key.Type < Key.Type ? -1 : 1;
+    if (key.ErrorConformance != Key.ErrorConformance)
+      return key.ErrorConformance < Key.ErrorConformance ? -1 : 1;
+    if (key.Value != Key.Value)
+      return key.Value < Key.Value ? -1 : 1;
+    return 0;
+  }
+
+  template <class... T>
+  static size_t getExtraAllocationSize(T &&... ignored) {
+    return 0;
+  }
+};
+
+} // end anonymous namespace
+
+static Lazy<ConcurrentMap<SharedErrorBoxEntry>> SharedErrorBoxes;
+
+/// Returns whether errors of type \p type can share a box, because boxes
+/// are never mutated after they are initialized and a value of the type has
+/// at most 256 bit patterns and nothing to destroy.
+///
+/// An empty value needs no initialization, so its box can be shared even
+/// when the caller stores the value itself afterwards. A one-byte box can
+/// only be found when the value is passed in.
+static bool _canShareErrorBox(const Metadata *type, OpaqueValue *initialValue) {
+  auto vw = type->getValueWitnesses();
+  if (!vw->isPOD())
+    return false;
+  return vw->getSize() == 0 || (vw->getSize() == 1 && initialValue);
+}
+
+SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
+extern "C"
+BoxPair::Return
+swift::swift_allocError(const swift::Metadata *type,
+                        const swift::WitnessTable *errorConformance,
+                        OpaqueValue *initialValue,
+                        bool isTake) {
+  // Throwing a payload-less error, as most errors are, shouldn't allocate.
+  if (_canShareErrorBox(type, initialValue)) {
+    SharedErrorBoxKey key{type, errorConformance, 0};
+    if (type->getValueWitnesses()->getSize() == 1)
+      memcpy(&key.Value, initialValue, 1);
+    auto entry = SharedErrorBoxes.get().getOrInsert(key).first;
+    swift_retain(entry->Box.first);
+    return entry->Box;
+  }
+
+  return _allocErrorBox(type, errorConformance, initialValue, isTake);
+}
+
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
+  // A box which was never initialized may still be shared, if it's empty.
+  if (_canShareErrorBox(type, nullptr)) {
+    swift_release(error);
+    return;
+  }
+
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
 }
@@ -16,15 +16,384 @@
 
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Once.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
 using namespace swift;
 
+//===----------------------------------------------------------------------===//
+//                      Thread-caching size-class allocator
+//===----------------------------------------------------------------------===//
+//
+// An opt-in allocator for small heap allocations, enabled by setting
+// SWIFT_THREAD_CACHING_ALLOCATOR=1 in the environment. Setting
+// SWIFT_THREAD_CACHING_ALLOCATOR_STATS=1 as well prints per-size-class
+// statistics when the process exits.
+//
+// Allocations of up to MaxSizeClassSize bytes with at most
+// SizeClassGranularity alignment are rounded up to a size class. Each thread
+// keeps a magazine of free blocks per size class and serves allocations and
+// deallocations from it without synchronization. Magazines exchange batches
+// of blocks with a shared, locked depot when they run empty or grow too
+// large.
+//
+// Blocks are carved from slabs in a single reserved address range, so a
+// pointer can be attributed to this allocator by a range check without
+// trusting the size passed to swift_slowDealloc (which, for objects with
+// tail allocations, is not the allocated size). Memory is never returned to
+// the system.
+//
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Size classes are multiples of this granularity, which is also the
+/// largest alignment that the allocator guarantees.
+constexpr size_t SizeClassGranularity = 16;
+constexpr size_t NumSizeClasses = 32;
+constexpr size_t MaxSizeClassSize = NumSizeClasses * SizeClassGranularity;
+
+} // end anonymous namespace
+
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+
+namespace {
+
+/// Blocks are carved out of slabs of this size, each dedicated to a single
+/// size class. Slabs are aligned to their size, so the header of the slab
+/// containing a block can be found by masking the block's address.
+constexpr size_t SlabSize = 64 * 1024;
+
+/// The number of blocks moved between a magazine and the depot at once.
+/// A magazine that grows to twice this many blocks returns a batch.
+constexpr unsigned MagazineBatchSize = 32;
+
+/// The amount of address space reserved for slabs.
+#ifdef __LP64__
+constexpr size_t RegionSize = size_t(1) << 34;
+#else
+constexpr size_t RegionSize = size_t(1) << 28;
+#endif
+
+/// A free block. Blocks in a batch are chained through Next; batches in
+/// the depot are chained through NextBatch of their first block.
+struct FreeBlock {
+  FreeBlock *Next;
+  FreeBlock *NextBatch;
+};
+
+static_assert(sizeof(FreeBlock) <= SizeClassGranularity,
+              "smallest size class cannot hold a free block");
+
+/// The header at the start of every slab. It occupies the first granule.
+struct SlabHeader {
+  size_t SizeClass;
+};
+
+static_assert(sizeof(SlabHeader) <= SizeClassGranularity,
+              "slab header does not fit in the first granule");
+
+/// The shared pool of free blocks for one size class.
+struct SizeClassDepot {
+  StaticMutex Lock;
+
+  /// Batches of free blocks returned by magazines.
+  FreeBlock *Batches = nullptr;
+
+  /// The unused part of the slab currently being carved.
+  uintptr_t CarveNext = 0, CarveEnd = 0;
+
+  /// Statistics. Hits are accumulated per thread and folded in when a
+  /// magazine refills, flushes or is torn down.
+  std::atomic<uint64_t> Hits{0};
+  std::atomic<uint64_t> Misses{0};
+  std::atomic<uint64_t> Flushes{0};
+  std::atomic<uint64_t> Slabs{0};
+};
+
+/// A thread's cache of free blocks. This must be trivially constructible
+/// since it lives in thread-local storage.
+struct ThreadMagazine {
+  FreeBlock *Head[NumSizeClasses];
+  unsigned Count[NumSizeClasses];
+  uint64_t Hits[NumSizeClasses];
+  bool IsRegistered;
+};
+
+} // end anonymous namespace
+
+/// Whether the allocator has been initialized, and if so, whether it is
+/// enabled. This is checked on every allocation, so it short-circuits
+/// swift_once after initialization.
+enum class AllocatorState : uint8_t { Uninitialized, Disabled, Enabled };
+
+static swift_once_t AllocatorOnce;
+static std::atomic<AllocatorState> State{AllocatorState::Uninitialized};
+static uintptr_t RegionBegin = 0, RegionEnd = 0;
+static std::atomic<uintptr_t> NextSlab{0};
+static pthread_key_t MagazineKey;
+static SizeClassDepot Depots[NumSizeClasses];
+static SWIFT_THREAD_LOCAL ThreadMagazine Magazine;
+
+static bool isEnvironmentFlagSet(const char *name) {
+  const char *value = getenv(name);
+  return value && value[0] && strcmp(value, "0") != 0;
+}
+
+static void dumpAllocatorStatisticsAtExit() {
+  swift_dumpAllocatorStatistics();
+}
+
+/// Fold the current thread's hit counts into the shared statistics.
+static void foldMagazineHits(ThreadMagazine &mag, size_t sizeClass) {
+  if (mag.Hits[sizeClass]) {
+    Depots[sizeClass].Hits.fetch_add(mag.Hits[sizeClass],
+                                     std::memory_order_relaxed);
+    mag.Hits[sizeClass] = 0;
+  }
+}
+
+/// Return a magazine's blocks to the depot when its thread exits.
+static void destroyMagazine(void *value) {
+  auto &mag = *static_cast<ThreadMagazine *>(value);
+  for (size_t sizeClass = 0; sizeClass != NumSizeClasses; ++sizeClass) {
+    foldMagazineHits(mag, sizeClass);
+    if (FreeBlock *blocks = mag.Head[sizeClass]) {
+      auto &depot = Depots[sizeClass];
+      StaticScopedLock guard(depot.Lock);
+      blocks->NextBatch = depot.Batches;
+      depot.Batches = blocks;
+    }
+    mag.Head[sizeClass] = nullptr;
+    mag.Count[sizeClass] = 0;
+  }
+  // A later allocation on this thread re-registers the magazine, which
+  // causes the destructor to run again.
+  mag.IsRegistered = false;
+}
+
+static bool reserveRegion() {
+  // Reserve the region without committing memory. Over-allocate by one slab
+  // so that the region can be aligned to the slab size.
+  void *reserved = mmap(nullptr, RegionSize + SlabSize, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (reserved == MAP_FAILED)
+    return false;
+  if (pthread_key_create(&MagazineKey, destroyMagazine) != 0) {
+    munmap(reserved, RegionSize + SlabSize);
+    return false;
+  }
+
+  uintptr_t begin = (uintptr_t(reserved) + SlabSize - 1) & ~(SlabSize - 1);
+  NextSlab.store(begin, std::memory_order_relaxed);
+  RegionBegin = begin;
+  RegionEnd = begin + RegionSize;
+  return true;
+}
+
+static void initializeAllocator(void *) {
+  if (!isEnvironmentFlagSet("SWIFT_THREAD_CACHING_ALLOCATOR") ||
+      !reserveRegion()) {
+    State.store(AllocatorState::Disabled, std::memory_order_release);
+    return;
+  }
+
+  if (isEnvironmentFlagSet("SWIFT_THREAD_CACHING_ALLOCATOR_STATS"))
+    atexit(dumpAllocatorStatisticsAtExit);
+  State.store(AllocatorState::Enabled, std::memory_order_release);
+}
+
+static bool isAllocatorEnabled() {
+  auto state = State.load(std::memory_order_acquire);
+  if (LLVM_UNLIKELY(state == AllocatorState::Uninitialized)) {
+    swift_once(&AllocatorOnce, initializeAllocator);
+    state = State.load(std::memory_order_acquire);
+  }
+  return state == AllocatorState::Enabled;
+}
+
+/// Does the given pointer belong to the size-class allocator?
+static bool isSizeClassBlock(const void *ptr) {
+  return uintptr_t(ptr) - RegionBegin < RegionEnd - RegionBegin;
+}
+
+static size_t getSizeClassOfBlock(const void *ptr) {
+  auto slab = reinterpret_cast<const SlabHeader *>(
+      uintptr_t(ptr) & ~(SlabSize - 1));
+  return slab->SizeClass;
+}
+
+/// Start carving a new slab for the given depot. Must be called with the
+/// depot's lock held. \returns false if the region is exhausted.
+static bool allocateSlab(SizeClassDepot &depot, size_t sizeClass) {
+  uintptr_t slab = NextSlab.fetch_add(SlabSize, std::memory_order_relaxed);
+  if (slab >= RegionEnd)
+    return false;
+  if (mprotect(reinterpret_cast<void *>(slab), SlabSize,
+               PROT_READ | PROT_WRITE) != 0)
+    return false;
+
+  reinterpret_cast<SlabHeader *>(slab)->SizeClass = sizeClass;
+  depot.CarveNext = slab + SizeClassGranularity;
+  depot.CarveEnd = slab + SlabSize;
+  depot.Slabs.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+/// Refill an empty magazine from the depot and allocate a block from it.
+/// \returns null if no more slabs can be allocated.
+LLVM_ATTRIBUTE_NOINLINE
+static void *refillMagazineAndAlloc(size_t sizeClass) {
+  auto &mag = Magazine;
+  if (!mag.IsRegistered) {
+    pthread_setspecific(MagazineKey, &mag);
+    mag.IsRegistered = true;
+  }
+  foldMagazineHits(mag, sizeClass);
+
+  auto &depot = Depots[sizeClass];
+  depot.Misses.fetch_add(1, std::memory_order_relaxed);
+  size_t blockSize = (sizeClass + 1) * SizeClassGranularity;
+
+  FreeBlock *head = nullptr;
+  unsigned count = 0;
+  {
+    StaticScopedLock guard(depot.Lock);
+    if (FreeBlock *batch = depot.Batches) {
+      depot.Batches = batch->NextBatch;
+      head = batch;
+      for (FreeBlock *block = batch; block; block = block->Next)
+        ++count;
+    } else {
+      FreeBlock **tail = &head;
+      while (count != MagazineBatchSize) {
+        if (depot.CarveNext + blockSize > depot.CarveEnd &&
+            !allocateSlab(depot, sizeClass))
+          break;
+        auto block = reinterpret_cast<FreeBlock *>(depot.CarveNext);
+        depot.CarveNext += blockSize;
+        *tail = block;
+        tail = &block->Next;
+        ++count;
+      }
+      *tail = nullptr;
+    }
+  }
+
+  if (!head)
+    return nullptr;
+
+  mag.Head[sizeClass] = head->Next;
+  mag.Count[sizeClass] = count - 1;
+  return head;
+}
+
+/// Return a batch of blocks from an overfull magazine to the depot.
+LLVM_ATTRIBUTE_NOINLINE
+static void flushMagazine(ThreadMagazine &mag, size_t sizeClass) {
+  FreeBlock *batch = mag.Head[sizeClass];
+  FreeBlock *last = batch;
+  for (unsigned i = 1; i != MagazineBatchSize; ++i)
+    last = last->Next;
+  mag.Head[sizeClass] = last->Next;
+  mag.Count[sizeClass] -= MagazineBatchSize;
+  last->Next = nullptr;
+  foldMagazineHits(mag, sizeClass);
+
+  auto &depot = Depots[sizeClass];
+  depot.Flushes.fetch_add(1, std::memory_order_relaxed);
+  StaticScopedLock guard(depot.Lock);
+  batch->NextBatch = depot.Batches;
+  depot.Batches = batch;
+}
+
+static void *sizeClassAlloc(size_t size) {
+  size_t sizeClass = size ? (size - 1) / SizeClassGranularity : 0;
+  auto &mag = Magazine;
+  if (FreeBlock *block = mag.Head[sizeClass]) {
+    mag.Head[sizeClass] = block->Next;
+    mag.Count[sizeClass]--;
+    mag.Hits[sizeClass]++;
+    return block;
+  }
+  return refillMagazineAndAlloc(sizeClass);
+}
+
+static void sizeClassDealloc(void *ptr) {
+  size_t sizeClass = getSizeClassOfBlock(ptr);
+  auto &mag = Magazine;
+  auto block = static_cast<FreeBlock *>(ptr);
+  block->Next = mag.Head[sizeClass];
+  mag.Head[sizeClass] = block;
+  if (++mag.Count[sizeClass] >= 2 * MagazineBatchSize)
+    flushMagazine(mag, sizeClass);
+}
+
+size_t swift::_swift_slowAllocUsableSize(const void *ptr) {
+  if (!isSizeClassBlock(ptr))
+    return 0;
+  return (getSizeClassOfBlock(ptr) + 1) * SizeClassGranularity;
+}
+
+void swift::swift_dumpAllocatorStatistics() {
+  if (!isAllocatorEnabled()) {
+    fprintf(stderr, "swift thread-caching allocator is disabled\n");
+    return;
+  }
+
+  fprintf(stderr, "swift thread-caching allocator statistics:\n");
+  fprintf(stderr, "%8s %14s %14s %9s %10s %8s\n",
+          "size", "hits", "misses", "hit rate", "flushes", "slabs");
+  for (size_t sizeClass = 0; sizeClass != NumSizeClasses; ++sizeClass) {
+    auto &depot = Depots[sizeClass];
+    uint64_t hits = depot.Hits.load(std::memory_order_relaxed)
+                  + Magazine.Hits[sizeClass];
+    uint64_t misses = depot.Misses.load(std::memory_order_relaxed);
+    if (hits + misses == 0)
+      continue;
+    fprintf(stderr, "%8zu %14llu %14llu %8.2f%% %10llu %8llu\n",
+            (sizeClass + 1) * SizeClassGranularity,
+            (unsigned long long) hits, (unsigned long long) misses,
+            100.0 * double(hits) / double(hits + misses),
+            (unsigned long long) depot.Flushes.load(std::memory_order_relaxed),
+            (unsigned long long) depot.Slabs.load(std::memory_order_relaxed));
+  }
+}
+
+#else
+
+static bool isAllocatorEnabled() { return false; }
+static bool isSizeClassBlock(const void *ptr) { return false; }
+static void *sizeClassAlloc(size_t size) { return nullptr; }
+static void sizeClassDealloc(void *ptr) {}
+
+size_t swift::_swift_slowAllocUsableSize(const void *ptr) {
+  return 0;
+}
+
+void swift::swift_dumpAllocatorStatistics() {
+  fprintf(stderr, "swift thread-caching allocator is not supported\n");
+}
+
+#endif
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (size <= MaxSizeClassSize && alignMask < SizeClassGranularity &&
+      isAllocatorEnabled()) {
+    if (void *p = sizeClassAlloc(size))
+      return p;
+  }
+
   // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
   void *p = malloc(size);
   if (!p) swift::crash("Could not allocate memory.");
@@ -34,5 +403,9 @@ void *swift::swift_slowAlloc(size_t size, size_t alignMask)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (isSizeClassBlock(ptr)) {
+    sizeClassDealloc(ptr);
+    return;
+  }
   free(ptr);
 }
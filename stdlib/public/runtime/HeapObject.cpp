@@ -18,16 +18,23 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Once.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
+#include "HeapProfiler.h"
 #include "Private.h"
+#include "RuntimeStats.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <pthread.h>
 #include <unistd.h>
 #include "../SwiftShims/RuntimeShims.h"
 #if SWIFT_OBJC_INTEROP
@@ -59,6 +66,8 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
                                        size_t requiredSize,
                                        size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  runtime_stats::EntryPointScope stats(
+    runtime_stats::EntryPoint::swift_allocObject);
   assert(isAlignmentMask(requiredAlignmentMask));
   auto object = reinterpret_cast<HeapObject *>(
       SWIFT_RT_ENTRY_CALL(swift_slowAlloc)(requiredSize,
@@ -71,6 +80,9 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
   // If leak tracking is enabled, start tracking this object.
   SWIFT_LEAKS_START_TRACKING_OBJECT(object);
 
+  if (LLVM_UNLIKELY(heap_profiler::isEnabled()))
+    heap_profiler::noteAllocation(object, metadata, requiredSize);
+
   return object;
 }
 
@@ -334,6 +346,11 @@ void SWIFT_RT_ENTRY_IMPL(swift_release_n)(HeapObject *object, uint32_t n)
   }
 }
 
+void swift::swift_releaseToZero(HeapObject *object) {
+  if (object->refCount.setDeallocatingAfterDecrementToZero())
+    _swift_release_dealloc(object);
+}
+
 void swift::swift_setDeallocating(HeapObject *object) {
   object->refCount.decrementFromOneAndDeallocateNonAtomic();
 }
@@ -534,10 +551,107 @@ void swift::swift_unownedCheck(HeapObject *object) {
     _swift_abortRetainUnowned(object);
 }
 
+namespace {
+
+/// The objects waiting to be destroyed by a thread. This must be trivially
+/// constructible since it lives in thread-local storage.
+struct DeferredDeallocQueue {
+  HeapObject **Objects;
+  size_t Count, Capacity;
+
+  /// Whether the thread is destroying an object, in which case objects which
+  /// are released to zero are queued instead of being destroyed.
+  bool IsDraining;
+  bool IsRegistered;
+};
+
+/// Whether deferred deallocation has been checked for, and if so, whether it
+/// is enabled.
+enum class DeferredDeallocState : uint8_t { Uninitialized, Disabled, Enabled };
+
+} // end anonymous namespace
+
+static swift_once_t DeferredDeallocOnce;
+static std::atomic<DeferredDeallocState>
+  DeferredDeallocMode{DeferredDeallocState::Uninitialized};
+static pthread_key_t DeferredDeallocKey;
+static SWIFT_THREAD_LOCAL DeferredDeallocQueue DeferredDeallocs;
+
+/// Free a queue's storage when its thread exits. The queue is always empty
+/// by then, since it is only filled while it is being drained.
+static void destroyDeferredDeallocQueue(void *value) {
+  auto &queue = *static_cast<DeferredDeallocQueue *>(value);
+  free(queue.Objects);
+  queue.Objects = nullptr;
+  queue.Capacity = 0;
+  queue.IsRegistered = false;
+}
+
+static void initializeDeferredDealloc(void *) {
+  const char *value = getenv("SWIFT_DEFERRED_DEALLOC");
+  bool enabled = value && value[0] && strcmp(value, "0") != 0 &&
+    pthread_key_create(&DeferredDeallocKey, destroyDeferredDeallocQueue) == 0;
+  DeferredDeallocMode.store(enabled ? DeferredDeallocState::Enabled
+                                    : DeferredDeallocState::Disabled,
+                            std::memory_order_release);
+}
+
+static bool isDeferredDeallocEnabled() {
+  auto state = DeferredDeallocMode.load(std::memory_order_acquire);
+  if (LLVM_UNLIKELY(state == DeferredDeallocState::Uninitialized)) {
+    swift_once(&DeferredDeallocOnce, initializeDeferredDealloc);
+    state = DeferredDeallocMode.load(std::memory_order_acquire);
+  }
+  return state == DeferredDeallocState::Enabled;
+}
+
+/// Add \p object to the thread's queue.
+///
+/// \returns false if there is no memory for it, in which case the caller
+/// destroys it right away.
+static bool pushDeferredDealloc(DeferredDeallocQueue &queue,
+                                HeapObject *object) {
+  if (queue.Count == queue.Capacity) {
+    size_t capacity = std::max(queue.Capacity * 2, size_t(64));
+    auto objects = static_cast<HeapObject **>(
+        realloc(queue.Objects, capacity * sizeof(HeapObject *)));
+    if (!objects)
+      return false;
+    if (!queue.IsRegistered) {
+      pthread_setspecific(DeferredDeallocKey, &queue);
+      queue.IsRegistered = true;
+    }
+    queue.Objects = objects;
+    queue.Capacity = capacity;
+  }
+  queue.Objects[queue.Count++] = object;
+  return true;
+}
+
 // Declared extern "C" LLVM_LIBRARY_VISIBILITY above.
 void _swift_release_dealloc(HeapObject *object)
   SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_LIKELY(!isDeferredDeallocEnabled())) {
+    asFullMetadata(object->metadata)->destroy(object);
+    return;
+  }
+
+  // Releases made by the destructors below come back here, and are queued
+  // rather than recursing, so that the whole teardown runs in this frame.
+  auto &queue = DeferredDeallocs;
+  if (queue.IsDraining && pushDeferredDealloc(queue, object))
+    return;
+
+  bool wasDraining = queue.IsDraining;
+  queue.IsDraining = true;
   asFullMetadata(object->metadata)->destroy(object);
+  if (wasDraining)
+    return;
+  while (queue.Count) {
+    HeapObject *next = queue.Objects[--queue.Count];
+    asFullMetadata(next->metadata)->destroy(next);
+  }
+  queue.IsDraining = false;
 }
 
 #if SWIFT_OBJC_INTEROP
@@ -636,6 +750,126 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+//===----------------------------------------------------------------------===//
+// Weak reference side tables
+//===----------------------------------------------------------------------===//
+
+namespace {
+  /// The out-of-line target of native weak references to an object.
+  ///
+  /// Weak references point at the side table instead of the object, so
+  /// they don't keep the object's memory allocated: the side table is
+  /// cleared when the object is deallocated, and freed once the last weak
+  /// reference to it goes away.
+  struct WeakReferenceSideTable {
+    /// The object, or null once it has been deallocated. The low bit is a
+    /// lock, held while a reader retains the object and while the object
+    /// is being deallocated.
+    std::atomic<uintptr_t> Object;
+
+    /// One for each weak reference, plus one for the object until it is
+    /// deallocated.
+    std::atomic<uint32_t> RefCount;
+
+    explicit WeakReferenceSideTable(HeapObject *object)
+      : Object(reinterpret_cast<uintptr_t>(object)), RefCount(1) {}
+  };
+
+  /// The side tables of live objects that have been weakly referenced.
+  struct WeakReferenceSideTableState {
+    Mutex Lock;
+    llvm::DenseMap<HeapObject *, WeakReferenceSideTable *> Tables;
+  };
+}
+
+static Lazy<WeakReferenceSideTableState> WeakReferenceSideTables;
+
+enum: uintptr_t {
+  WST_LOCKED = 1,
+};
+
+static_assert(WST_LOCKED < alignof(HeapObject),
+              "side table lock bit mustn't interfere with object pointers");
+
+enum: short {
+  WR_SPINLIMIT = 64,
+};
+
+/// Returns the side table of \p object, creating it if necessary, with an
+/// additional reference held by the caller.
+static WeakReferenceSideTable *
+retainWeakReferenceSideTableFor(HeapObject *object) {
+  auto &state = WeakReferenceSideTables.get();
+  ScopedLock guard(state.Lock);
+  auto &table = state.Tables[object];
+  if (!table) {
+    table = new WeakReferenceSideTable(object);
+    object->weakRefCount.setHasSideTable();
+  }
+  table->RefCount.fetch_add(1, std::memory_order_relaxed);
+  return table;
+}
+
+static void retainWeakReferenceSideTable(WeakReferenceSideTable *table) {
+  table->RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void releaseWeakReferenceSideTable(WeakReferenceSideTable *table) {
+  if (table->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete table;
+}
+
+/// Lock the object pointer of \p table, returning its unlocked value.
+static uintptr_t lockWeakReferenceSideTable(WeakReferenceSideTable *table) {
+  auto value = table->Object.fetch_or(WST_LOCKED, std::memory_order_acquire);
+  while (value & WST_LOCKED) {
+    short c = 0;
+    while (table->Object.load(std::memory_order_relaxed) & WST_LOCKED) {
+      if (++c == WR_SPINLIMIT) {
+        sched_yield();
+        c -= 1;
+      }
+    }
+    value = table->Object.fetch_or(WST_LOCKED, std::memory_order_acquire);
+  }
+  return value;
+}
+
+/// Try to retain the object that \p table refers to. Only the side table
+/// is touched if the object has already been deallocated.
+static HeapObject *loadStrongFromSideTable(WeakReferenceSideTable *table) {
+  if (table->Object.load(std::memory_order_acquire) == 0)
+    return nullptr;
+
+  // The deallocating thread takes the lock before freeing the object, so
+  // the object stays allocated while we hold it.
+  auto value = lockWeakReferenceSideTable(table);
+  auto object = reinterpret_cast<HeapObject *>(value);
+  auto result = object ? swift_tryRetain(object) : nullptr;
+  table->Object.store(value, std::memory_order_release);
+  return result;
+}
+
+/// Disconnect \p object from its side table before its memory is freed.
+/// Weak references to it will read null from then on.
+static void detachWeakReferenceSideTable(HeapObject *object) {
+  WeakReferenceSideTable *table;
+  {
+    auto &state = WeakReferenceSideTables.get();
+    ScopedLock guard(state.Lock);
+    auto found = state.Tables.find(object);
+    assert(found != state.Tables.end() && "object has no side table");
+    table = found->second;
+    state.Tables.erase(found);
+  }
+
+  // Wait for any reader that is still retaining the object, then clear the
+  // pointer, which also releases the lock.
+  lockWeakReferenceSideTable(table);
+  table->Object.store(0, std::memory_order_release);
+  releaseWeakReferenceSideTable(table);
+}
+
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_deallocObject(HeapObject *object,
                                 size_t allocatedSize,
@@ -652,6 +886,13 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  if (LLVM_UNLIKELY(heap_profiler::isEnabled()))
+    heap_profiler::noteDeallocation(object);
+
+  // Weak references to the object stay valid without its memory.
+  if (object->weakRefCount.hasSideTable())
+    detachWeakReferenceSideTable(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -728,142 +969,84 @@ void swift::swift_deallocObject(HeapObject *object,
 
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
-
-enum: short {
-  WR_SPINLIMIT = 64,
-};
+static_assert(WR_NATIVE < alignof(WeakReferenceSideTable),
+              "weakref native bit mustn't interfere with side table pointers");
 
 bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
+static WeakReferenceSideTable *getSideTable(WeakReference *ref) {
+  return reinterpret_cast<WeakReferenceSideTable *>(ref->Value & ~WR_NATIVE);
+}
+
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  auto table = value ? retainWeakReferenceSideTableFor(value) : nullptr;
+  ref->Value = (uintptr_t)table | WR_NATIVE;
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto newTable =
+    newValue ? retainWeakReferenceSideTableFor(newValue) : nullptr;
+  auto oldTable = getSideTable(ref);
+  ref->Value = (uintptr_t)newTable | WR_NATIVE;
+  if (oldTable)
+    releaseWeakReferenceSideTable(oldTable);
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
-    return nullptr;
-  }
-
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    return nullptr;
-  }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
+  auto table = getSideTable(ref);
+  if (table == nullptr)
     return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  return loadStrongFromSideTable(table);
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
+  auto table = getSideTable(ref);
+  if (table == nullptr) return nullptr;
+  auto result = loadStrongFromSideTable(table);
   ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  releaseWeakReferenceSideTable(table);
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  auto table = getSideTable(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (table)
+    releaseWeakReferenceSideTable(table);
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
+  auto table = getSideTable(src);
+  if (table == nullptr) {
     dest->Value = (uintptr_t)nullptr;
     return;
   }
 
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  retainWeakReferenceSideTable(table);
+  dest->Value = (uintptr_t)table | WR_NATIVE;
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  auto table = getSideTable(src);
+  dest->Value = table ? (uintptr_t)table | WR_NATIVE : (uintptr_t)nullptr;
   src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getSideTable(dest))
+    releaseWeakReferenceSideTable(table);
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (auto table = getSideTable(dest))
+    releaseWeakReferenceSideTable(table);
   swift_weakTakeInit(dest, src);
 }
 
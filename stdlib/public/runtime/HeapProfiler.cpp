@@ -0,0 +1,325 @@
+//===--- HeapProfiler.cpp - Sampling heap profiler ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A sampling profiler of the objects allocated by swift_allocObject, enabled
+// by setting SWIFT_HEAP_PROFILE=<path> in the environment.
+//
+// On average, one object is sampled every SWIFT_HEAP_PROFILE_RATE bytes
+// (512 KiB by default). The intervals between samples are drawn from an
+// exponential distribution, so that pprof can estimate the unsampled totals.
+// A sampled object's type and backtrace are recorded, and the sample counts
+// as live until the object is deallocated.
+//
+// When the process exits, or when swift_heapProfileWrite is called, the
+// samples are written in the legacy pprof heap profile format. The leaf
+// frame of each sample is the address of the object's metadata, so that
+// objects are attributed to their type; <path>.types maps those addresses to
+// type names.
+//
+//===----------------------------------------------------------------------===//
+
+#include "HeapProfiler.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Config.h"
+#include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Once.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__APPLE__) || (defined(__linux__) && defined(__GLIBC__))
+#include <execinfo.h>
+#define SWIFT_HEAP_PROFILER_HAS_BACKTRACE 1
+#else
+#define SWIFT_HEAP_PROFILER_HAS_BACKTRACE 0
+#endif
+
+using namespace swift;
+using namespace swift::heap_profiler;
+
+std::atomic<State> swift::heap_profiler::CurrentState{State::Uninitialized};
+
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+
+namespace {
+
+enum : unsigned {
+  /// The deepest backtrace recorded for a sample.
+  MaxBacktraceDepth = 32,
+
+  /// The number of frames inside the runtime at the top of each backtrace:
+  /// recordSample and noteAllocation.
+  ProfilerFrames = 2,
+};
+
+struct HeapSample {
+  const HeapMetadata *Type;
+  size_t Size;
+  unsigned Depth;
+  bool IsLive;
+  void *Frames[MaxBacktraceDepth];
+};
+
+struct HeapProfilerState {
+  Mutex Lock;
+  std::vector<HeapSample> Samples;
+
+  /// Maps the sampled objects that are still alive to their samples.
+  llvm::DenseMap<HeapObject *, size_t> LiveSamples;
+};
+
+} // end anonymous namespace
+
+static Lazy<HeapProfilerState> Profiler;
+static swift_once_t InitializeOnce;
+static char *OutputPath;
+static uint64_t SamplingRate = 512 * 1024;
+
+/// A filter of the addresses of sampled objects, checked before taking the
+/// lock when an object is deallocated. Bits are never cleared, so it can
+/// only report false positives.
+enum : unsigned { SampledObjectFilterWords = 1024 };
+static std::atomic<uint64_t> SampledObjectFilter[SampledObjectFilterWords];
+
+static SWIFT_THREAD_LOCAL int64_t BytesUntilSample;
+static SWIFT_THREAD_LOCAL bool HasSampleInterval;
+static SWIFT_THREAD_LOCAL uint64_t RandomState;
+static SWIFT_THREAD_LOCAL bool IsRecordingSample;
+
+static void writeHeapProfileAtExit() {
+  swift_heapProfileWrite(OutputPath);
+}
+
+static void initializeHeapProfiler(void *) {
+  const char *path = getenv("SWIFT_HEAP_PROFILE");
+  if (!path || !path[0]) {
+    CurrentState.store(State::Disabled, std::memory_order_relaxed);
+    return;
+  }
+
+  if (const char *rate = getenv("SWIFT_HEAP_PROFILE_RATE")) {
+    uint64_t value = strtoull(rate, nullptr, 10);
+    if (value != 0)
+      SamplingRate = value;
+  }
+
+  OutputPath = strdup(path);
+  atexit(writeHeapProfileAtExit);
+  CurrentState.store(State::Enabled, std::memory_order_relaxed);
+}
+
+State swift::heap_profiler::initialize() {
+  swift_once(&InitializeOnce, initializeHeapProfiler);
+  return CurrentState.load(std::memory_order_relaxed);
+}
+
+/// Draw the number of bytes until the next sample from an exponential
+/// distribution with a mean of SamplingRate.
+static int64_t getNextSampleInterval() {
+  uint64_t x = RandomState;
+  if (x == 0)
+    x = (uint64_t(uintptr_t(&RandomState)) * 0x9E3779B97F4A7C15ULL) | 1;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  RandomState = x;
+
+  // A uniform value in (0, 1].
+  double u = double((x >> 11) + 1) / double(uint64_t(1) << 53);
+  return int64_t(-std::log(u) * double(SamplingRate)) + 1;
+}
+
+static std::atomic<uint64_t> &getFilterWord(HeapObject *object,
+                                            uint64_t &bit) {
+  uintptr_t hash = reinterpret_cast<uintptr_t>(object) >> 4;
+  bit = uint64_t(1) << (hash & 63);
+  return SampledObjectFilter[(hash >> 6) & (SampledObjectFilterWords - 1)];
+}
+
+LLVM_ATTRIBUTE_NOINLINE
+static void recordSample(HeapObject *object, const HeapMetadata *metadata,
+                         size_t size) {
+  HeapSample sample;
+  sample.Type = metadata;
+  sample.Size = size;
+  sample.IsLive = true;
+#if SWIFT_HEAP_PROFILER_HAS_BACKTRACE
+  int depth = backtrace(sample.Frames, MaxBacktraceDepth);
+  sample.Depth = depth > 0 ? unsigned(depth) : 0;
+#else
+  sample.Depth = 0;
+#endif
+
+  uint64_t bit;
+  getFilterWord(object, bit).fetch_or(bit, std::memory_order_relaxed);
+
+  auto &profiler = Profiler.get();
+  ScopedLock guard(profiler.Lock);
+  profiler.LiveSamples[object] = profiler.Samples.size();
+  profiler.Samples.push_back(sample);
+}
+
+LLVM_ATTRIBUTE_NOINLINE
+void swift::heap_profiler::noteAllocation(HeapObject *object,
+                                          const HeapMetadata *metadata,
+                                          size_t size) {
+  if (LLVM_UNLIKELY(!HasSampleInterval)) {
+    BytesUntilSample = getNextSampleInterval();
+    HasSampleInterval = true;
+  }
+
+  BytesUntilSample -= int64_t(size);
+  if (LLVM_LIKELY(BytesUntilSample > 0))
+    return;
+  BytesUntilSample = getNextSampleInterval();
+
+  // Don't sample objects that are allocated while recording a sample.
+  if (IsRecordingSample)
+    return;
+  IsRecordingSample = true;
+  recordSample(object, metadata, size);
+  IsRecordingSample = false;
+}
+
+void swift::heap_profiler::noteDeallocation(HeapObject *object) {
+  uint64_t bit;
+  if (!(getFilterWord(object, bit).load(std::memory_order_relaxed) & bit))
+    return;
+
+  auto &profiler = Profiler.get();
+  ScopedLock guard(profiler.Lock);
+  auto found = profiler.LiveSamples.find(object);
+  if (found == profiler.LiveSamples.end())
+    return;
+  profiler.Samples[found->second].IsLive = false;
+  profiler.LiveSamples.erase(found);
+}
+
+static std::string getHeapTypeName(const HeapMetadata *type) {
+  switch (type->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+    return "<<<box>>>";
+  case MetadataKind::HeapGenericLocalVariable: {
+    auto box = static_cast<const GenericBoxHeapMetadata *>(type);
+    return "<<<box>>> " + nameForMetadata(box->BoxedType);
+  }
+  case MetadataKind::ErrorObject:
+    return "<<<error box>>>";
+  default:
+    return nameForMetadata(type);
+  }
+}
+
+/// Copy the address space layout into the profile, so that pprof can
+/// symbolize frames in shared libraries.
+static void writeMappedLibraries(FILE *out) {
+  fprintf(out, "\nMAPPED_LIBRARIES:\n");
+#if defined(__linux__)
+  if (FILE *maps = fopen("/proc/self/maps", "r")) {
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), maps)) != 0)
+      fwrite(buffer, 1, count, out);
+    fclose(maps);
+  }
+#endif
+}
+
+bool swift::swift_heapProfileWrite(const char *path) {
+  if (!isEnabled()) {
+    fprintf(stderr, "swift heap profiler is disabled; "
+                    "set SWIFT_HEAP_PROFILE=<path> to enable it\n");
+    return false;
+  }
+  if (!path)
+    path = OutputPath;
+
+  // Copy the samples so that the files are written without holding the
+  // lock, and don't record samples of our own allocations.
+  IsRecordingSample = true;
+  std::vector<HeapSample> samples;
+  {
+    auto &profiler = Profiler.get();
+    ScopedLock guard(profiler.Lock);
+    samples = profiler.Samples;
+  }
+
+  FILE *out = fopen(path, "w");
+  if (!out) {
+    fprintf(stderr, "swift heap profiler: cannot open '%s'\n", path);
+    IsRecordingSample = false;
+    return false;
+  }
+
+  size_t liveCount = 0, liveBytes = 0, allocBytes = 0;
+  for (auto &sample : samples) {
+    allocBytes += sample.Size;
+    if (sample.IsLive) {
+      ++liveCount;
+      liveBytes += sample.Size;
+    }
+  }
+  fprintf(out, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%llu\n",
+          liveCount, liveBytes, samples.size(), allocBytes,
+          (unsigned long long) SamplingRate);
+
+  llvm::DenseSet<const HeapMetadata *> types;
+  for (auto &sample : samples) {
+    fprintf(out, "%d: %zu [1: %zu] @ %p", sample.IsLive ? 1 : 0,
+            sample.IsLive ? sample.Size : 0, sample.Size,
+            (const void *) sample.Type);
+    for (unsigned i = ProfilerFrames; i < sample.Depth; ++i)
+      fprintf(out, " %p", sample.Frames[i]);
+    fprintf(out, "\n");
+    types.insert(sample.Type);
+  }
+  writeMappedLibraries(out);
+  fclose(out);
+
+  std::string typesPath = std::string(path) + ".types";
+  if (FILE *typesOut = fopen(typesPath.c_str(), "w")) {
+    for (auto type : types)
+      fprintf(typesOut, "%p %s\n", (const void *) type,
+              getHeapTypeName(type).c_str());
+    fclose(typesOut);
+  }
+
+  IsRecordingSample = false;
+  return true;
+}
+
+#else
+
+State swift::heap_profiler::initialize() {
+  CurrentState.store(State::Disabled, std::memory_order_relaxed);
+  return State::Disabled;
+}
+
+void swift::heap_profiler::noteAllocation(HeapObject *object,
+                                          const HeapMetadata *metadata,
+                                          size_t size) {}
+
+void swift::heap_profiler::noteDeallocation(HeapObject *object) {}
+
+bool swift::swift_heapProfileWrite(const char *path) {
+  fprintf(stderr, "swift heap profiler is not supported\n");
+  return false;
+}
+
+#endif
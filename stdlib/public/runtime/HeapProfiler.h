@@ -0,0 +1,59 @@
+//===--- HeapProfiler.h - Sampling heap profiler ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A sampling profiler of swift_allocObject, enabled by setting
+// SWIFT_HEAP_PROFILE=<path> in the environment. See HeapProfiler.cpp.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_HEAPPROFILER_H
+#define SWIFT_RUNTIME_HEAPPROFILER_H
+
+#include "swift/Runtime/HeapObject.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace swift {
+namespace heap_profiler {
+
+enum class State : uint8_t { Uninitialized, Disabled, Enabled };
+
+LLVM_LIBRARY_VISIBILITY
+extern std::atomic<State> CurrentState;
+
+/// Read SWIFT_HEAP_PROFILE from the environment.
+LLVM_LIBRARY_VISIBILITY
+State initialize();
+
+static inline bool isEnabled() {
+  auto state = CurrentState.load(std::memory_order_relaxed);
+  if (LLVM_UNLIKELY(state == State::Uninitialized))
+    state = initialize();
+  return state == State::Enabled;
+}
+
+/// Account for a new object of \p size bytes, and sample it if the
+/// sampling interval has elapsed.
+LLVM_LIBRARY_VISIBILITY
+void noteAllocation(HeapObject *object, const HeapMetadata *metadata,
+                    size_t size);
+
+/// Forget \p object if it was sampled.
+LLVM_LIBRARY_VISIBILITY
+void noteDeallocation(HeapObject *object);
+
+} // end namespace heap_profiler
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_HEAPPROFILER_H
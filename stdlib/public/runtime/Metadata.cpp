@@ -36,6 +36,7 @@
 #include "ExistentialMetadataImpl.h"
 #include "swift/Runtime/Debug.h"
 #include "Private.h"
+#include "RuntimeStats.h"
 
 #if defined(__APPLE__)
 #include <mach/vm_page_size.h>
@@ -56,6 +57,15 @@
 using namespace swift;
 using namespace metadataimpl;
 
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+/// The unused remainder of the current thread's metadata page. Metadata is
+/// never deallocated, so every MetadataAllocator can carve from the same
+/// per-thread page, and allocation needs neither a lock nor an atomic
+/// operation. The remainder of the page is abandoned when the thread exits.
+static SWIFT_THREAD_LOCAL uintptr_t ThreadMetadataPageNext = 0;
+static SWIFT_THREAD_LOCAL uintptr_t ThreadMetadataPageEnd = 0;
+#endif
+
 void *MetadataAllocator::alloc(size_t size) {
 #if defined(__APPLE__)
   const uintptr_t PageSizeMask = vm_page_mask;
@@ -73,6 +83,28 @@ void *MetadataAllocator::alloc(size_t size) {
     return mem;
   }
 
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+  // Keep every allocation pointer-aligned.
+  size = (size + alignof(void*) - 1) & ~(alignof(void*) - 1);
+
+  uintptr_t next = ThreadMetadataPageNext;
+  if (LLVM_UNLIKELY(!next || ThreadMetadataPageEnd - next < size)) {
+    // Start a new page for this thread.
+    auto page = mmap(nullptr, PageSizeMask + 1,
+                     PROT_READ|PROT_WRITE,
+                     MAP_ANON|MAP_PRIVATE,
+                     VM_TAG_FOR_SWIFT_METADATA,
+                     /*offset*/ 0);
+    if (page == MAP_FAILED)
+      crash("unable to allocate memory for metadata cache");
+
+    next = reinterpret_cast<uintptr_t>(page);
+    ThreadMetadataPageEnd = next + PageSizeMask + 1;
+  }
+
+  ThreadMetadataPageNext = next + size;
+  return reinterpret_cast<void*>(next);
+#else
   uintptr_t curValue = NextValue.load(std::memory_order_relaxed);
   while (true) {
     char *next = reinterpret_cast<char*>(curValue);
@@ -110,6 +142,7 @@ void *MetadataAllocator::alloc(size_t size) {
       munmap(allocation, PageSizeMask + 1);
     }
   }
+#endif
 }
 
 namespace {
@@ -274,11 +307,16 @@ const Metadata *
 swift::swift_getGenericMetadata(GenericMetadata *pattern,
                                 const void *arguments)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  runtime_stats::EntryPointScope stats(
+    runtime_stats::EntryPoint::swift_getGenericMetadata);
   auto genericArgs = (const void * const *) arguments;
   size_t numGenericArgs = pattern->NumKeyArguments;
 
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
+      runtime_stats::countEvent(
+        runtime_stats::Event::GenericMetadataInstantiations);
+
       // Create new metadata to cache.
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
@@ -289,6 +327,29 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   return entry->Value;
 }
 
+/// Seed a generic type's cache with statically-emitted metadata.
+void
+swift::swift_registerGenericMetadataPrespecialization(GenericMetadata *pattern,
+                                                      const void *arguments,
+                                                      const Metadata *metadata) {
+  auto genericArgs = (const void * const *) arguments;
+  size_t numGenericArgs = pattern->NumKeyArguments;
+  auto &cache = getCache(pattern);
+
+  // The prespecialized metadata lives outside the cache's allocations, so
+  // the entry is allocated on its own with no trailing payload.  If the
+  // instantiation was already formed at runtime, keep that one: metadata
+  // identity must not change once it has been handed out.
+  cache.findOrAdd(genericArgs, numGenericArgs,
+    [&]() -> GenericCacheEntry* {
+      auto entry = GenericCacheEntry::allocate(cache.getAllocator(),
+                                               genericArgs, numGenericArgs,
+                                               /*payloadSize*/ 0);
+      entry->Value = metadata;
+      return entry;
+    });
+}
+
 namespace {
   class ObjCClassCacheEntry : public CacheEntry<ObjCClassCacheEntry> {
     FullMetadata<ObjCClassWrapperMetadata> Metadata;
@@ -675,7 +736,7 @@ static OpaqueValue *tuple_memmove_array(OpaqueValue *dest,
                                         OpaqueValue *src,
                                         size_t n,
                                         const Metadata *metatype) {
-  assert(metatype->getValueWitnesses()->isPOD());
+  assert(metatype->getValueWitnesses()->isBitwiseTakable());
   return (OpaqueValue*)
     memmove(dest, src, metatype->getValueWitnesses()->stride * n);
 }
@@ -726,7 +787,9 @@ static OpaqueValue *tuple_initializeWithTake(OpaqueValue *dest,
   assert(IsPOD == tuple_getValueWitnesses(metatype)->isPOD());
   assert(IsInline == tuple_getValueWitnesses(metatype)->isValueInline());
 
-  if (IsPOD) return tuple_memcpy(dest, src, metatype);
+  if (IsPOD || tuple_getValueWitnesses(metatype)->isBitwiseTakable())
+    return (OpaqueValue*)
+      memcpy(dest, src, tuple_getValueWitnesses(metatype)->getSize());
   return tuple_forEachField(dest, src, metatype,
                             &ValueWitnessTable::initializeWithTake);
 }
@@ -741,7 +804,8 @@ static OpaqueValue *tuple_initializeArrayWithTakeFrontToBack(
   assert(IsPOD == tuple_getValueWitnesses(metatype)->isPOD());
   assert(IsInline == tuple_getValueWitnesses(metatype)->isValueInline());
 
-  if (IsPOD) return tuple_memmove_array(dest, src, n, metatype);
+  if (IsPOD || tuple_getValueWitnesses(metatype)->isBitwiseTakable())
+    return tuple_memmove_array(dest, src, n, metatype);
 
   char *destBytes = (char*)dest;
   char *srcBytes = (char*)src;
@@ -767,7 +831,8 @@ static OpaqueValue *tuple_initializeArrayWithTakeBackToFront(
   assert(IsPOD == tuple_getValueWitnesses(metatype)->isPOD());
   assert(IsInline == tuple_getValueWitnesses(metatype)->isValueInline());
 
-  if (IsPOD) return tuple_memmove_array(dest, src, n, metatype);
+  if (IsPOD || tuple_getValueWitnesses(metatype)->isBitwiseTakable())
+    return tuple_memmove_array(dest, src, n, metatype);
 
   size_t stride = tuple_getValueWitnesses(metatype)->stride;
   char *destBytes = (char*)dest + n * stride;
@@ -1454,15 +1519,14 @@ static inline ClassROData *getROData(ClassMetadata *theClass) {
 
 static void _swift_initGenericClassObjCName(ClassMetadata *theClass) {
   // Use the remangler to generate a mangled name from the type metadata.
-  auto demangling = _swift_buildDemanglingForMetadata(theClass);
+  Demangle::NodeFactory Factory;
+  auto demangling = _swift_buildDemanglingForMetadata(theClass, Factory);
 
   // Remangle that into a new type mangling string.
-  auto typeNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::TypeMangling);
-  typeNode->addChild(demangling);
-  auto globalNode
-    = Demangle::NodeFactory::create(Demangle::Node::Kind::Global);
-  globalNode->addChild(typeNode);
+  auto typeNode = Factory.createNode(Demangle::Node::Kind::TypeMangling);
+  typeNode->addChild(demangling, Factory);
+  auto globalNode = Factory.createNode(Demangle::Node::Kind::Global);
+  globalNode->addChild(typeNode, Factory);
   
   auto string = Demangle::mangleNode(globalNode);
   
@@ -1861,10 +1925,41 @@ namespace {
   };
 }
 
+namespace {
+  /// A value witness table instantiated for existential containers with a
+  /// given number of witness table pointers. The table is created by the
+  /// thread which inserts the entry.
+  template <class WitnessTableTy>
+  struct ExistentialValueWitnessTableCacheEntry {
+    using Creator = const WitnessTableTy *(unsigned numWitnessTables);
+
+    const unsigned NumWitnessTables;
+    const WitnessTableTy * const Table;
+
+    ExistentialValueWitnessTableCacheEntry(unsigned numWitnessTables,
+                                           Creator *create)
+      : NumWitnessTables(numWitnessTables), Table(create(numWitnessTables)) {}
+
+    int compareWithKey(unsigned key) const {
+      if (key != NumWitnessTables)
+        return (key < NumWitnessTables ? -1 : 1);
+      return 0;
+    }
+
+    static size_t getKeyHash(unsigned key) {
+      return key;
+    }
+
+    static size_t getExtraAllocationSize(unsigned key, Creator *create) {
+      return 0;
+    }
+  };
+}
+
 struct ExistentialMetatypeState {
   MetadataCache<ExistentialMetatypeCacheEntry> Types;
-  llvm::DenseMap<unsigned, const ExtraInhabitantsValueWitnessTable*>
-    ValueWitnessTables;
+  ConcurrentHashMap<ExistentialValueWitnessTableCacheEntry<
+    ExtraInhabitantsValueWitnessTable>> ValueWitnessTables;
 };
 
 /// The uniquing structure for existential metatype type metadata.
@@ -1877,25 +1972,10 @@ static const ExtraInhabitantsValueWitnessTable
 ExistentialMetatypeValueWitnesses_2 =
   ValueWitnessTableForBox<ExistentialMetatypeBox<2>>::table;
 
-/// Instantiate a value witness table for an existential metatype
-/// container with the given number of witness table pointers.
+/// Create a value witness table for an existential metatype container with
+/// the given number of witness table pointers.
 static const ExtraInhabitantsValueWitnessTable *
-getExistentialMetatypeValueWitnesses(ExistentialMetatypeState &EM,
-                                     unsigned numWitnessTables) {
-  if (numWitnessTables == 0)
-    return &getUnmanagedPointerPointerValueWitnesses();
-  if (numWitnessTables == 1)
-    return &ExistentialMetatypeValueWitnesses_1;
-  if (numWitnessTables == 2)
-    return &ExistentialMetatypeValueWitnesses_2;
-
-  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
-                "not handling all possible inline-storage class existentials!");
-
-  auto found = EM.ValueWitnessTables.find(numWitnessTables);
-  if (found != EM.ValueWitnessTables.end())
-    return found->second;
-
+createExistentialMetatypeValueWitnesses(unsigned numWitnessTables) {
   using Box = NonFixedExistentialMetatypeBox;
   using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ true>;
 
@@ -1918,11 +1998,29 @@ getExistentialMetatypeValueWitnesses(ExistentialMetatypeState &EM,
   vwt->extraInhabitantFlags = ExtraInhabitantFlags()
     .withNumExtraInhabitants(Witnesses::numExtraInhabitants);
 
-  EM.ValueWitnessTables.insert({numWitnessTables, vwt});
-
   return vwt;
 }
 
+/// Instantiate a value witness table for an existential metatype
+/// container with the given number of witness table pointers.
+static const ExtraInhabitantsValueWitnessTable *
+getExistentialMetatypeValueWitnesses(ExistentialMetatypeState &EM,
+                                     unsigned numWitnessTables) {
+  if (numWitnessTables == 0)
+    return &getUnmanagedPointerPointerValueWitnesses();
+  if (numWitnessTables == 1)
+    return &ExistentialMetatypeValueWitnesses_1;
+  if (numWitnessTables == 2)
+    return &ExistentialMetatypeValueWitnesses_2;
+
+  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
+                "not handling all possible inline-storage class existentials!");
+
+  return EM.ValueWitnessTables
+    .getOrInsert(numWitnessTables, createExistentialMetatypeValueWitnesses)
+    .first->Table;
+}
+
 /// \brief Fetch a uniqued metadata for a metatype type.
 SWIFT_RUNTIME_EXPORT
 extern "C" const ExistentialMetatypeMetadata *
@@ -1987,9 +2085,10 @@ namespace {
 
 struct ExistentialTypeState {
   MetadataCache<ExistentialCacheEntry> Types;
-  llvm::DenseMap<unsigned, const ValueWitnessTable*> OpaqueValueWitnessTables;
-  llvm::DenseMap<unsigned, const ExtraInhabitantsValueWitnessTable*>
-    ClassValueWitnessTables;
+  ConcurrentHashMap<ExistentialValueWitnessTableCacheEntry<ValueWitnessTable>>
+    OpaqueValueWitnessTables;
+  ConcurrentHashMap<ExistentialValueWitnessTableCacheEntry<
+    ExtraInhabitantsValueWitnessTable>> ClassValueWitnessTables;
 };
 
 /// The uniquing structure for existential type metadata.
@@ -2000,23 +2099,10 @@ static const ValueWitnessTable OpaqueExistentialValueWitnesses_0 =
 static const ValueWitnessTable OpaqueExistentialValueWitnesses_1 =
   ValueWitnessTableForBox<OpaqueExistentialBox<1>>::table;
 
-/// Instantiate a value witness table for an opaque existential container with
-/// the given number of witness table pointers.
+/// Create a value witness table for an opaque existential container with the
+/// given number of witness table pointers.
 static const ValueWitnessTable *
-getOpaqueExistentialValueWitnesses(ExistentialTypeState &E,
-                                   unsigned numWitnessTables) {
-  // We pre-allocate a couple of important cases.
-  if (numWitnessTables == 0)
-    return &OpaqueExistentialValueWitnesses_0;
-  if (numWitnessTables == 1)
-    return &OpaqueExistentialValueWitnesses_1;
-
-  // FIXME: make thread-safe
-
-  auto found = E.OpaqueValueWitnessTables.find(numWitnessTables);
-  if (found != E.OpaqueValueWitnessTables.end())
-    return found->second;
-
+createOpaqueExistentialValueWitnesses(unsigned numWitnessTables) {
   using Box = NonFixedOpaqueExistentialBox;
   using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ true>;
   static_assert(!Witnesses::hasExtraInhabitants, "no extra inhabitants");
@@ -2036,40 +2122,34 @@ getOpaqueExistentialValueWitnesses(ExistentialTypeState &E,
     .withExtraInhabitants(false);
   vwt->stride = Box::Container::getStride(numWitnessTables);
 
-  E.OpaqueValueWitnessTables.insert({numWitnessTables, vwt});
-
   return vwt;
 }
 
+/// Instantiate a value witness table for an opaque existential container with
+/// the given number of witness table pointers.
+static const ValueWitnessTable *
+getOpaqueExistentialValueWitnesses(ExistentialTypeState &E,
+                                   unsigned numWitnessTables) {
+  // We pre-allocate a couple of important cases.
+  if (numWitnessTables == 0)
+    return &OpaqueExistentialValueWitnesses_0;
+  if (numWitnessTables == 1)
+    return &OpaqueExistentialValueWitnesses_1;
+
+  return E.OpaqueValueWitnessTables
+    .getOrInsert(numWitnessTables, createOpaqueExistentialValueWitnesses)
+    .first->Table;
+}
+
 static const ExtraInhabitantsValueWitnessTable ClassExistentialValueWitnesses_1 =
   ValueWitnessTableForBox<ClassExistentialBox<1>>::table;
 static const ExtraInhabitantsValueWitnessTable ClassExistentialValueWitnesses_2 =
   ValueWitnessTableForBox<ClassExistentialBox<2>>::table;
 
-/// Instantiate a value witness table for a class-constrained existential
-/// container with the given number of witness table pointers.
+/// Create a value witness table for a class-constrained existential container
+/// with the given number of witness table pointers.
 static const ExtraInhabitantsValueWitnessTable *
-getClassExistentialValueWitnesses(ExistentialTypeState &E,
-                                  unsigned numWitnessTables) {
-  if (numWitnessTables == 0) {
-#if SWIFT_OBJC_INTEROP
-    return &_TWVBO;
-#else
-    return &_TWVBo;
-#endif
-  }
-  if (numWitnessTables == 1)
-    return &ClassExistentialValueWitnesses_1;
-  if (numWitnessTables == 2)
-    return &ClassExistentialValueWitnesses_2;
-
-  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
-                "not handling all possible inline-storage class existentials!");
-
-  auto found = E.ClassValueWitnessTables.find(numWitnessTables);
-  if (found != E.ClassValueWitnessTables.end())
-    return found->second;
-
+createClassExistentialValueWitnesses(unsigned numWitnessTables) {
   using Box = NonFixedClassExistentialBox;
   using Witnesses = NonFixedValueWitnesses<Box, /*known allocated*/ true>;
 
@@ -2092,11 +2172,34 @@ getClassExistentialValueWitnesses(ExistentialTypeState &E,
   vwt->extraInhabitantFlags = ExtraInhabitantFlags()
     .withNumExtraInhabitants(Witnesses::numExtraInhabitants);
 
-  E.ClassValueWitnessTables.insert({numWitnessTables, vwt});
-
   return vwt;
 }
 
+/// Instantiate a value witness table for a class-constrained existential
+/// container with the given number of witness table pointers.
+static const ExtraInhabitantsValueWitnessTable *
+getClassExistentialValueWitnesses(ExistentialTypeState &E,
+                                  unsigned numWitnessTables) {
+  if (numWitnessTables == 0) {
+#if SWIFT_OBJC_INTEROP
+    return &_TWVBO;
+#else
+    return &_TWVBo;
+#endif
+  }
+  if (numWitnessTables == 1)
+    return &ClassExistentialValueWitnesses_1;
+  if (numWitnessTables == 2)
+    return &ClassExistentialValueWitnesses_2;
+
+  static_assert(3 * sizeof(void*) >= sizeof(ValueBuffer),
+                "not handling all possible inline-storage class existentials!");
+
+  return E.ClassValueWitnessTables
+    .getOrInsert(numWitnessTables, createClassExistentialValueWitnesses)
+    .first->Table;
+}
+
 /// Get the value witness table for an existential type, first trying to use a
 /// shared specialized table for common cases.
 static const ValueWitnessTable *
@@ -2643,6 +2746,8 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
                                     const Metadata *type,
                                     void * const *instantiationArgs)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  runtime_stats::EntryPointScope stats(
+    runtime_stats::EntryPoint::swift_getGenericWitnessTable);
   if (doesNotRequireInstantiation(genericTable)) {
     return genericTable->Pattern;
   }
@@ -2655,6 +2760,9 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
   auto &cache = getCache(genericTable);
   auto entry = cache.findOrAdd(args, numGenericArgs,
     [&]() -> WitnessTableCacheEntry* {
+      runtime_stats::countEvent(
+        runtime_stats::Event::GenericWitnessTableInstantiations);
+
       // Allocate the witness table and fill it in.
       auto entry = allocateWitnessTable(genericTable,
                                         cache.getAllocator(),
@@ -27,13 +27,17 @@
 namespace swift {
 
 /// A bump pointer for metadata allocations. Since metadata is (currently)
-/// never released, it does not support deallocation. This allocator by itself
-/// is not thread-safe; in concurrent uses, allocations must be guarded by
-/// a lock, such as the per-metadata-cache lock used to guard metadata
-/// instantiations. All allocations are pointer-aligned.
+/// never released, it does not support deallocation. The allocator is
+/// thread-safe and needs no external lock, so different threads can
+/// instantiate metadata in parallel. Where the platform supports it, each
+/// thread bumps through its own page, shared by all allocators since nothing
+/// is ever freed; otherwise allocations are made with an atomic
+/// compare-and-swap on the allocator's own page. All allocations are
+/// pointer-aligned.
 class MetadataAllocator {
-  /// Address of the next available space. The allocator grabs a page at a time,
-  /// so the need for a new page can be determined by page alignment.
+  /// Address of the next available space, when thread-local pages are not
+  /// available. The allocator grabs a page at a time, so the need for a new
+  /// page can be determined by page alignment.
   ///
   /// Initializing to -1 instead of nullptr ensures that the first allocation
   /// triggers a page allocation since it will always span a "page" boundary.
@@ -244,6 +248,10 @@ template <class ValueTy> class MetadataCache {
       return key.KeyData.size() * sizeof(void*);
     }
 
+    static size_t getKeyHash(const Key &key) {
+      return key.Hash;
+    }
+
     int compareWithKey(const Key &key) const {
       // Order by hash first, then by the actual key data.
       if (key.Hash != Hash) {
@@ -267,10 +275,7 @@ template <class ValueTy> class MetadataCache {
   };
 
   /// The concurrent map.
-  ConcurrentMap<Entry> Map;
-
-  static_assert(sizeof(Map) == 2 * sizeof(void*),
-                "offset of Head is not at proper offset");
+  ConcurrentHashMap<Entry> Map;
 
   /// The head of a linked list connecting all the metadata cache entries.
   /// TODO: Remove this when LLDB is able to understand the final data
@@ -295,8 +300,6 @@ public:
   MetadataCache &operator=(const MetadataCache &other) = delete;
 
   /// Get the allocator for metadata in this cache.
-  /// The allocator can only be safely used while the cache is locked during
-  /// an addMetadataEntry call.
   MetadataAllocator &getAllocator() { return Allocator; }
 
   /// Look up a cached metadata entry. If a cache match exists, return it.
@@ -359,22 +362,25 @@ public:
     }
 
     // Otherwise, we created the entry and are responsible for
-    // creating the metadata.
+    // creating the metadata. This happens without holding the lock, so
+    // different entries can be built in parallel.
     auto value = builder();
 
-    // Update the linked list.
-    value->Next = Head;
-    Head = value;
-
 #if SWIFT_DEBUG_RUNTIME
         printf("%s(%p): created %p\n",
                ValueTy::getName(), (void*) this, value);
 #endif
 
-    // Acquire the lock, set the value, and notify any waiters.
+    // Acquire the lock, update the linked list, set the value, and notify
+    // any waiters. The list must be updated under the lock now that
+    // entries are built concurrently.
     auto concurrency = Concurrency.get();
     concurrency->Lock.withLockThenNotifyAll(
-        concurrency->Queue, [&entry, &value] { entry->setValue(value); });
+        concurrency->Queue, [&, this] {
+          value->Next = Head;
+          Head = value;
+          entry->setValue(value);
+        });
 
     return value;
   }
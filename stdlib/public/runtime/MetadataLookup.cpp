@@ -109,6 +109,12 @@ struct TypeMetadataState {
   std::vector<TypeMetadataSection> SectionsToScan;
   Mutex SectionsToScanLock;
 
+  /// The types in the first IndexedSections of SectionsToScan, by mangled
+  /// name. Sections are indexed by the first lookup that misses the cache
+  /// after they are registered. Guarded by SectionsToScanLock.
+  MangledTypeNameIndex NameIndex;
+  unsigned IndexedSections = 0;
+
   TypeMetadataState() {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
@@ -230,26 +236,15 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
 
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
   unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
+  for (; T.IndexedSections < endSectionIdx; ++T.IndexedSections) {
+    _addSectionToMangledTypeNameIndex(T.NameIndex,
+                                      T.SectionsToScan[T.IndexedSections]);
   }
 
-  return nullptr;
+  return _lookUpMangledTypeNameIndex(T.NameIndex, typeName);
 }
 
 static const Metadata *
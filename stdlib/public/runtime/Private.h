@@ -20,6 +20,7 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Compiler.h"
 
 // Opaque ISAs need to use object_getClass which is in runtime.h
@@ -156,8 +157,61 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  /// The type that a type metadata or conformance record refers to, as
+  /// accepted by _matchMetadataByMangledTypeName: either its canonical
+  /// metadata, or the nominal type descriptor of a generic or resilient type.
+  struct MangledTypeNameIndexEntry {
+    const Metadata *Type;
+    const NominalTypeDescriptor *Descriptor;
+  };
+
+  using MangledTypeNameIndex = llvm::StringMap<MangledTypeNameIndexEntry>;
+
+  /// Add the types referenced by the records in \p section to \p index,
+  /// keyed by mangled name. Names that are already in the index keep their
+  /// original entry, so that lookups find the same record as a linear scan.
+  template <typename Section>
+  void _addSectionToMangledTypeNameIndex(MangledTypeNameIndex &index,
+                                         const Section &section) {
+    for (const auto &record : section) {
+      const Metadata *type = record.getCanonicalTypeMetadata();
+      const NominalTypeDescriptor *ntd = nullptr;
+      if (type)
+        ntd = type->getNominalTypeDescriptor();
+      else if (record.getTypeKind() ==
+                 TypeMetadataRecordKind::UniqueNominalTypeDescriptor)
+        ntd = record.getNominalTypeDescriptor();
+      if (!ntd)
+        continue;
+
+      index.insert({ntd->Name.get(),
+                    MangledTypeNameIndexEntry{type, type ? nullptr : ntd}});
+    }
+  }
+
+  /// Look up \p typeName in \p index, returning its metadata if the type
+  /// can be instantiated without generic arguments.
+  static inline const Metadata *
+  _lookUpMangledTypeNameIndex(const MangledTypeNameIndex &index,
+                              llvm::StringRef typeName) {
+    auto found = index.find(typeName);
+    if (found == index.end())
+      return nullptr;
+    return _matchMetadataByMangledTypeName(typeName, found->second.Type,
+                                           found->second.Descriptor);
+  }
+
+  /// Returns a number that changes whenever new protocol conformances are
+  /// registered, so that cached negative conformance results can be
+  /// revalidated.
+  uintptr_t _swift_getProtocolConformanceGeneration();
+
 #if SWIFT_OBJC_INTEROP
-  Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
+  /// Build a demangle tree for the given type.  The nodes are owned by
+  /// \p factory.
+  Demangle::NodePointer
+  _swift_buildDemanglingForMetadata(const Metadata *type,
+                                    Demangle::NodeFactory &factory);
 #endif
 
   /// A helper function which avoids performing a store if the destination
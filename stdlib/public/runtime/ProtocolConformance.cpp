@@ -20,6 +20,9 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
 #include "Private.h"
+#include "RuntimeStats.h"
+#include <algorithm>
+#include <vector>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -149,14 +152,71 @@ const {
 #endif
 
 namespace {
+  /// A contiguous run of conformance records for a single protocol.
+  struct ConformanceRun {
+    const ProtocolDescriptor *Proto;
+    const ProtocolConformanceRecord *Begin, *End;
+
+    const ProtocolConformanceRecord *begin() const {
+      return Begin;
+    }
+    const ProtocolConformanceRecord *end() const {
+      return End;
+    }
+
+    bool operator<(const ConformanceRun &other) const {
+      return uintptr_t(Proto) < uintptr_t(other.Proto);
+    }
+  };
+
   struct ConformanceSection {
     const ProtocolConformanceRecord *Begin, *End;
+
+    /// The runs of records in this section, sorted by protocol. Built the
+    /// first time the section is scanned and guarded by the
+    /// SectionsToScan lock.
+    std::vector<ConformanceRun> Index;
+    bool IsIndexed;
+
+    ConformanceSection(const ProtocolConformanceRecord *begin,
+                       const ProtocolConformanceRecord *end)
+      : Begin(begin), End(end), IsIndexed(false) {}
+
     const ProtocolConformanceRecord *begin() const {
       return Begin;
     }
     const ProtocolConformanceRecord *end() const {
       return End;
     }
+
+    /// Return the runs of records in this section that conform to the given
+    /// protocol. IRGen emits an image's records grouped by protocol, so
+    /// there is usually at most one.
+    std::pair<const ConformanceRun *, const ConformanceRun *>
+    getRecordsForProtocol(const ProtocolDescriptor *protocol) {
+      if (!IsIndexed)
+        buildIndex();
+      ConformanceRun key{protocol, nullptr, nullptr};
+      auto range = std::equal_range(Index.begin(), Index.end(), key);
+      return {Index.data() + (range.first - Index.begin()),
+              Index.data() + (range.second - Index.begin())};
+    }
+
+  private:
+    void buildIndex() {
+      for (auto record = Begin; record != End; ++record) {
+        auto proto = record->getProtocol();
+        if (!Index.empty() && Index.back().Proto == proto &&
+            Index.back().End == record) {
+          Index.back().End = record + 1;
+          continue;
+        }
+        Index.push_back(ConformanceRun{proto, record, record + 1});
+      }
+      std::stable_sort(Index.begin(), Index.end());
+      Index.shrink_to_fit();
+      IsIndexed = true;
+    }
   };
 
   struct ConformanceCacheKey {
@@ -183,6 +243,15 @@ namespace {
         FailureGeneration(failureGeneration) {
     }
 
+    static size_t getKeyHash(const ConformanceCacheKey &key) {
+      uintptr_t type = reinterpret_cast<uintptr_t>(key.Type);
+      uintptr_t proto = reinterpret_cast<uintptr_t>(key.Proto);
+      // Metadata and descriptors are pointer-aligned, so mix in the high
+      // bits before they are masked off by the table.
+      size_t hash = (type >> 4) ^ (type >> 20) ^ (proto >> 3) ^ (proto << 7);
+      return hash * 0x27d4eb2d;
+    }
+
     int compareWithKey(const ConformanceCacheKey &key) const {
       if (key.Type != Type) {
         return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
@@ -240,11 +309,23 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
 #endif
 
 struct ConformanceState {
-  ConcurrentMap<ConformanceCacheEntry> Cache;
+  ConcurrentHashMap<ConformanceCacheEntry> Cache;
   std::vector<ConformanceSection> SectionsToScan;
   Mutex SectionsToScanLock;
+
+  /// The number of sections registered so far. This mirrors
+  /// SectionsToScan.size() but can be read without taking the lock; it is
+  /// used to invalidate the per-thread lookaside caches when new
+  /// conformances are loaded.
+  std::atomic<uintptr_t> SectionsGeneration;
+
+  /// The conforming types in the first IndexedSections of SectionsToScan,
+  /// by mangled name, for _searchConformancesByMangledTypeName. Guarded by
+  /// SectionsToScanLock.
+  MangledTypeNameIndex NameIndex;
+  unsigned IndexedSections = 0;
   
-  ConformanceState() {
+  ConformanceState() : SectionsGeneration(0) {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
@@ -290,8 +371,16 @@ static void
 _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *begin,
                               const ProtocolConformanceRecord *end) {
+  if (LLVM_UNLIKELY(runtime_stats::isEnabled())) {
+    runtime_stats::recordEvent(
+      runtime_stats::Event::ConformanceSectionsRegistered);
+    runtime_stats::recordEvent(
+      runtime_stats::Event::ConformanceRecordsRegistered, end - begin);
+  }
+
   ScopedLock guard(C.SectionsToScanLock);
-  C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.SectionsToScan.push_back(ConformanceSection(begin, end));
+  C.SectionsGeneration.fetch_add(1, std::memory_order_release);
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -543,16 +632,16 @@ bool isRelatedType(const Metadata *type, const void *candidate,
   return false;
 }
 
-const WitnessTable *
-swift::swift_conformsToProtocol(const Metadata *type,
-                                const ProtocolDescriptor *protocol) {
+static const WitnessTable *
+conformsToProtocolImpl(const Metadata *type,
+                       const ProtocolDescriptor *protocol) {
   auto &C = Conformances.get();
   auto origType = type;
   unsigned numSections = 0;
   ConformanceCacheEntry *foundEntry;
 
 recur:
-  // See if we have a cached conformance. The ConcurrentMap data structure
+  // See if we have a cached conformance. The ConcurrentHashMap data structure
   // allows us to insert and search the map concurrently without locking.
   // We do lock the slow path because the SectionsToScan data structure is not
   // concurrent.
@@ -567,6 +656,7 @@ recur:
   }
 
   // If we didn't have an up-to-date cache entry, scan the conformance records.
+  runtime_stats::countEvent(runtime_stats::Event::ConformanceCacheMisses);
   C.SectionsToScanLock.lock();
   unsigned failedGeneration = ConformanceCacheGeneration;
 
@@ -597,50 +687,47 @@ recur:
   unsigned endSectionIdx = C.SectionsToScan.size();
 
   for (; sectionIdx < endSectionIdx; ++sectionIdx) {
+    runtime_stats::countEvent(runtime_stats::Event::ConformanceSectionScans);
     auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
-      // If the record applies to a specific type, cache it.
-      if (auto metadata = record.getCanonicalTypeMetadata()) {
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, metadata, /*isMetadata=*/true))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        auto witness = record.getWitnessTable(metadata);
-        if (witness) {
-          C.cacheSuccess(metadata, P, witness);
-        } else {
-          C.cacheFailure(metadata, P);
+    auto runs = section.getRecordsForProtocol(protocol);
+    for (auto run = runs.first; run != runs.second; ++run) {
+      // Eagerly pull records for nondependent witnesses into our cache.
+      for (const auto &record : *run) {
+        // If the record applies to a specific type, cache it.
+        if (auto metadata = record.getCanonicalTypeMetadata()) {
+          auto P = record.getProtocol();
+          assert(protocol == P && "index returned a foreign record?!");
+
+          if (!isRelatedType(type, metadata, /*isMetadata=*/true))
+            continue;
+
+          // Store the type-protocol pair in the cache.
+          auto witness = record.getWitnessTable(metadata);
+          if (witness) {
+            C.cacheSuccess(metadata, P, witness);
+          } else {
+            C.cacheFailure(metadata, P);
+          }
+
+        // If the record provides a nondependent witness table for all
+        // instances of a generic type, cache it for the generic pattern.
+        // TODO: "Nondependent witness table" probably deserves its own flag.
+        // An accessor function might still be necessary even if the witness
+        // table can be shared.
+        } else if (record.getTypeKind()
+                     == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
+                   && record.getConformanceKind()
+                     == ProtocolConformanceReferenceKind::WitnessTable) {
+
+          auto R = record.getNominalTypeDescriptor();
+          auto P = record.getProtocol();
+
+          if (!isRelatedType(type, R, /*isMetadata=*/false))
+            continue;
+
+          // Store the type-protocol pair in the cache.
+          C.cacheSuccess(R, P, record.getStaticWitnessTable());
         }
-
-      // If the record provides a nondependent witness table for all instances
-      // of a generic type, cache it for the generic pattern.
-      // TODO: "Nondependent witness table" probably deserves its own flag.
-      // An accessor function might still be necessary even if the witness table
-      // can be shared.
-      } else if (record.getTypeKind()
-                   == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
-                 && record.getConformanceKind()
-                   == ProtocolConformanceReferenceKind::WitnessTable) {
-
-        auto R = record.getNominalTypeDescriptor();
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, R, /*isMetadata=*/false))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        C.cacheSuccess(R, P, record.getStaticWitnessTable());
       }
     }
   }
@@ -652,30 +739,80 @@ recur:
   goto recur;
 }
 
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+namespace {
+  /// An entry in the per-thread conformance lookaside cache. A successful
+  /// lookup stays valid forever; a failed lookup is only valid as long as
+  /// no new conformance sections have been registered.
+  struct ConformanceLookasideEntry {
+    const Metadata *Type;
+    const ProtocolDescriptor *Proto;
+    const WitnessTable *Witness;
+    uintptr_t Generation;
+  };
+
+  /// The number of entries in the lookaside cache. Must be a power of two.
+  enum : uintptr_t { ConformanceLookasideSize = 64 };
+}
+
+/// A small direct-mapped cache of swift_conformsToProtocol results,
+/// private to each thread, so that repeatedly casting the same type to the
+/// same protocol never touches the shared cache or takes a lock.
+static SWIFT_THREAD_LOCAL
+ConformanceLookasideEntry ConformanceLookaside[ConformanceLookasideSize];
+
+static ConformanceLookasideEntry &
+getConformanceLookasideEntry(const Metadata *type,
+                             const ProtocolDescriptor *protocol) {
+  // Metadata and protocol descriptors are at least pointer-aligned.
+  uintptr_t hash = (reinterpret_cast<uintptr_t>(type) >> 4)
+                 ^ (reinterpret_cast<uintptr_t>(protocol) >> 3);
+  return ConformanceLookaside[hash & (ConformanceLookasideSize - 1)];
+}
+#endif
+
+const WitnessTable *
+swift::swift_conformsToProtocol(const Metadata *type,
+                                const ProtocolDescriptor *protocol) {
+  runtime_stats::EntryPointScope stats(
+    runtime_stats::EntryPoint::swift_conformsToProtocol);
+#if SWIFT_RUNTIME_HAS_THREAD_LOCAL
+  auto &C = Conformances.get();
+
+  // Read the generation before doing the real lookup, so that a failure
+  // computed while new sections are being registered is never considered
+  // up to date.
+  uintptr_t generation =
+    C.SectionsGeneration.load(std::memory_order_acquire);
+
+  auto &entry = getConformanceLookasideEntry(type, protocol);
+  if (entry.Type == type && entry.Proto == protocol &&
+      (entry.Witness || entry.Generation == generation))
+    return entry.Witness;
+
+  auto witness = conformsToProtocolImpl(type, protocol);
+  entry = ConformanceLookasideEntry{type, protocol, witness, generation};
+  return witness;
+#else
+  return conformsToProtocolImpl(type, protocol);
+#endif
+}
+
+uintptr_t swift::_swift_getProtocolConformanceGeneration() {
+  return Conformances.get().SectionsGeneration.load(std::memory_order_acquire);
+}
+
 const Metadata *
 swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
   auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
 
   ScopedLock guard(C.SectionsToScanLock);
 
-  unsigned sectionIdx = 0;
   unsigned endSectionIdx = C.SectionsToScan.size();
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        break;
-    }
-    if (foundMetadata != nullptr)
-      break;
+  for (; C.IndexedSections < endSectionIdx; ++C.IndexedSections) {
+    _addSectionToMangledTypeNameIndex(C.NameIndex,
+                                      C.SectionsToScan[C.IndexedSections]);
   }
 
-  return foundMetadata;
+  return _lookUpMangledTypeNameIndex(C.NameIndex, typeName);
 }
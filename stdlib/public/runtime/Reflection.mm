@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Reflection.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
@@ -451,16 +453,83 @@ void swift_TupleMirror_subscript(String *outString,
   new (outMirror) Mirror(reflect(owner, eltData, elt.Type));
 }
   
-// Get a field name from a doubly-null-terminated list.
-static const char *getFieldName(const char *fieldNames, size_t i) {
-  const char *fieldName = fieldNames;
-  for (size_t j = 0; j < i; ++j) {
-    size_t len = strlen(fieldName);
-    assert(len != 0);
-    fieldName += len + 1;
-  }
+namespace {
+  /// The names in one nominal type descriptor's doubly-null-terminated list
+  /// of field or case names, split up so that the nth name can be found
+  /// without rescanning the n-1 names before it. The names are allocated
+  /// after the entry.
+  struct FieldNameTableEntry {
+    struct Name {
+      const char *Start;
+      size_t Length;
+    };
+
+  private:
+    const char *FieldNames;
+    size_t NumNames;
+
+    Name *getTrailingNames() {
+      return reinterpret_cast<Name *>(this + 1);
+    }
+    const Name *getTrailingNames() const {
+      return reinterpret_cast<const Name *>(this + 1);
+    }
+
+    static size_t countNames(const char *fieldNames) {
+      size_t count = 0;
+      for (const char *name = fieldNames; *name; name += strlen(name) + 1)
+        ++count;
+      return count;
+    }
 
-  return fieldName;
+  public:
+    FieldNameTableEntry(const char *fieldNames)
+      : FieldNames(fieldNames), NumNames(0) {
+      Name *names = getTrailingNames();
+      for (const char *name = fieldNames; *name; ++NumNames) {
+        size_t len = strlen(name);
+        names[NumNames] = {name, len};
+        name += len + 1;
+      }
+    }
+
+    static size_t getExtraAllocationSize(const char *fieldNames) {
+      return countNames(fieldNames) * sizeof(Name);
+    }
+
+    static size_t getKeyHash(const char *fieldNames) {
+      uintptr_t key = reinterpret_cast<uintptr_t>(fieldNames);
+      return ((key >> 4) ^ (key >> 20)) * 0x27d4eb2d;
+    }
+
+    int compareWithKey(const char *fieldNames) const {
+      if (fieldNames == FieldNames)
+        return 0;
+      return uintptr_t(fieldNames) < uintptr_t(FieldNames) ? -1 : 1;
+    }
+
+    const Name &getName(size_t i) const {
+      assert(i < NumNames && "field name index out of range");
+      return getTrailingNames()[i];
+    }
+  };
+} // end anonymous namespace
+
+static Lazy<ConcurrentHashMap<FieldNameTableEntry>> FieldNameTables;
+
+// Get a field name from a doubly-null-terminated list. The list is split up
+// the first time it is used, so enumerating a type's children is linear in
+// the number of children rather than quadratic.
+static const FieldNameTableEntry::Name &
+getFieldName(const char *fieldNames, size_t i) {
+  auto table = FieldNameTables.get().getOrInsert(fieldNames).first;
+  return table->getName(i);
+}
+
+static void initFieldNameString(String *outString, const char *fieldNames,
+                                size_t i) {
+  auto &name = getFieldName(fieldNames, i);
+  new (outString) String(name.Start, name.Length);
 }
 
 // -- Struct destructuring.
@@ -495,7 +564,7 @@ void swift_StructMirror_subscript(String *outString,
   auto bytes = reinterpret_cast<const char*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
 
-  new (outString) String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  initFieldNameString(outString, Struct->Description->Struct.FieldNames, i);
 
   // 'owner' is consumed by this call.
   assert(!fieldType.isIndirect() && "indirect struct fields not implemented");
@@ -566,7 +635,7 @@ const char *swift_EnumMirror_caseName(HeapObject *owner,
 
   swift_release(owner);
 
-  return getFieldName(Description.CaseNames, tag);
+  return getFieldName(Description.CaseNames, tag).Start;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -649,11 +718,77 @@ void swift_EnumMirror_subscript(String *outString,
     swift_release(pair.first);
   }
 
-  new (outString) String(getFieldName(Description.CaseNames, tag));
+  initFieldNameString(outString, Description.CaseNames, tag);
   new (outMirror) Mirror(reflect(owner, value, payloadType));
 }
   
 // -- Class destructuring.
+
+#if SWIFT_OBJC_INTEROP
+namespace {
+  /// The ivar offsets of a class with ObjC heritage, read once from the ObjC
+  /// runtime rather than copying the class's ivar list for every child. The
+  /// offsets are allocated after the entry.
+  struct ObjCIvarOffsetsEntry {
+  private:
+    const ClassMetadata *Clas;
+    unsigned NumIvars;
+
+    uintptr_t *getTrailingOffsets() {
+      return reinterpret_cast<uintptr_t *>(this + 1);
+    }
+    const uintptr_t *getTrailingOffsets() const {
+      return reinterpret_cast<const uintptr_t *>(this + 1);
+    }
+
+  public:
+    ObjCIvarOffsetsEntry(const ClassMetadata *clas, Ivar *ivars,
+                         unsigned numIvars)
+      : Clas(clas), NumIvars(numIvars) {
+      for (unsigned i = 0; i < numIvars; ++i)
+        getTrailingOffsets()[i] = ivar_getOffset(ivars[i]);
+    }
+
+    static size_t getExtraAllocationSize(const ClassMetadata *clas,
+                                         Ivar *ivars, unsigned numIvars) {
+      return numIvars * sizeof(uintptr_t);
+    }
+
+    static size_t getKeyHash(const ClassMetadata *clas) {
+      uintptr_t key = reinterpret_cast<uintptr_t>(clas);
+      return ((key >> 4) ^ (key >> 20)) * 0x27d4eb2d;
+    }
+
+    int compareWithKey(const ClassMetadata *clas) const {
+      if (clas == Clas)
+        return 0;
+      return uintptr_t(clas) < uintptr_t(Clas) ? -1 : 1;
+    }
+
+    uintptr_t getOffset(size_t i) const {
+      assert(i < NumIvars && "ivar index out of range");
+      return getTrailingOffsets()[i];
+    }
+  };
+} // end anonymous namespace
+
+static Lazy<ConcurrentHashMap<ObjCIvarOffsetsEntry>> ObjCIvarOffsets;
+
+// The ObjC runtime has already slid the ivars of a class by the time a value
+// of it exists, so the offsets can be cached per class.
+static uintptr_t getObjCIvarOffset(const ClassMetadata *clas, size_t i) {
+  auto &offsets = ObjCIvarOffsets.get();
+  if (auto entry = offsets.find(clas))
+    return entry->getOffset(i);
+
+  unsigned numIvars = 0;
+  Ivar *ivars = class_copyIvarList((Class)clas, &numIvars);
+  auto entry = offsets.getOrInsert(clas, ivars, numIvars).first;
+  free(ivars);
+  return entry->getOffset(i);
+}
+#endif
+
 static Mirror getMirrorForSuperclass(const ClassMetadata *sup,
                                      HeapObject *owner,
                                      const OpaqueValue *value,
@@ -717,9 +852,7 @@ void swift_ClassMirror_subscript(String *outString,
     fieldOffset = Clas->getFieldOffsets()[i];
   } else {
 #if SWIFT_OBJC_INTEROP
-    Ivar *ivars = class_copyIvarList((Class)Clas, nullptr);
-    fieldOffset = ivar_getOffset(ivars[i]);
-    free(ivars);
+    fieldOffset = getObjCIvarOffset(Clas, i);
 #else
     swift::crash("Object appears to be Objective-C, but no runtime.");
 #endif
@@ -728,7 +861,7 @@ void swift_ClassMirror_subscript(String *outString,
   auto bytes = *reinterpret_cast<const char * const*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
   
-  new (outString) String(getFieldName(Clas->getDescription()->Class.FieldNames, i));
+  initFieldNameString(outString, Clas->getDescription()->Class.FieldNames, i);
   // 'owner' is consumed by this call.
   new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
 }
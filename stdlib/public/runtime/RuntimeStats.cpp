@@ -0,0 +1,261 @@
+//===--- RuntimeStats.cpp - Runtime statistics ----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Collects the counters and latency histograms declared in RuntimeStats.def
+// when SWIFT_RUNTIME_STATS=1 is set in the environment, and prints them to
+// stderr when the process exits or when swift_runtimeStatsDump is called.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RuntimeStats.h"
+#include "swift/Runtime/Debug.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Once.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace swift;
+using namespace swift::runtime_stats;
+
+namespace {
+
+enum : unsigned {
+  NumEntryPoints = 0
+#define RUNTIME_STATS_ENTRY_POINT(NAME) + 1
+#include "RuntimeStats.def"
+};
+
+enum class CountedEntryPoint : unsigned {
+#define RUNTIME_STATS_COUNTED_ENTRY_POINT(NAME) NAME,
+#include "RuntimeStats.def"
+};
+
+enum : unsigned {
+  NumCountedEntryPoints = 0
+#define RUNTIME_STATS_COUNTED_ENTRY_POINT(NAME) + 1
+#include "RuntimeStats.def"
+};
+
+enum : unsigned {
+  NumEvents = 0
+#define RUNTIME_STATS_EVENT(NAME, DESCRIPTION) + 1
+#include "RuntimeStats.def"
+};
+
+/// Latencies are bucketed by the position of their highest set bit, so
+/// bucket N holds calls that took [2^N, 2^(N+1)) nanoseconds.
+enum : unsigned { NumLatencyBuckets = 40 };
+
+/// The statistics of one entry point. This must be trivially constructible,
+/// so that it is zero-initialized before any static constructors run.
+struct EntryPointStats {
+  std::atomic<uint64_t> TotalNanoseconds;
+  std::atomic<uint64_t> Latencies[NumLatencyBuckets];
+};
+
+} // end anonymous namespace
+
+static const char * const EntryPointNames[] = {
+#define RUNTIME_STATS_ENTRY_POINT(NAME) #NAME,
+#include "RuntimeStats.def"
+};
+
+static const char * const CountedEntryPointNames[] = {
+#define RUNTIME_STATS_COUNTED_ENTRY_POINT(NAME) #NAME,
+#include "RuntimeStats.def"
+};
+
+static const char * const EventDescriptions[] = {
+#define RUNTIME_STATS_EVENT(NAME, DESCRIPTION) DESCRIPTION,
+#include "RuntimeStats.def"
+};
+
+static EntryPointStats EntryPoints[NumEntryPoints];
+static std::atomic<uint64_t> CountedCalls[NumCountedEntryPoints];
+static std::atomic<uint64_t> Events[NumEvents];
+
+static void countCall(CountedEntryPoint entryPoint) {
+  CountedCalls[unsigned(entryPoint)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// The implementations of the counted entry points, which the counting
+// implementations below forward to.
+static void (*SWIFT_CC(RegisterPreservingCC) OriginalRetain)(HeapObject *);
+static void (*SWIFT_CC(RegisterPreservingCC) OriginalRetainN)(HeapObject *,
+                                                              uint32_t);
+static void (*SWIFT_CC(RegisterPreservingCC) OriginalRelease)(HeapObject *);
+static void (*SWIFT_CC(RegisterPreservingCC) OriginalReleaseN)(HeapObject *,
+                                                               uint32_t);
+
+static void SWIFT_CC(RegisterPreservingCC) countingRetain(HeapObject *object) {
+  countCall(CountedEntryPoint::swift_retain);
+  OriginalRetain(object);
+}
+
+static void SWIFT_CC(RegisterPreservingCC) countingRetainN(HeapObject *object,
+                                                           uint32_t n) {
+  countCall(CountedEntryPoint::swift_retain_n);
+  OriginalRetainN(object, n);
+}
+
+static void SWIFT_CC(RegisterPreservingCC) countingRelease(HeapObject *object) {
+  countCall(CountedEntryPoint::swift_release);
+  OriginalRelease(object);
+}
+
+static void SWIFT_CC(RegisterPreservingCC) countingReleaseN(HeapObject *object,
+                                                            uint32_t n) {
+  countCall(CountedEntryPoint::swift_release_n);
+  OriginalReleaseN(object, n);
+}
+
+/// Route the counted entry points through the counting implementations.
+static void installCountingEntryPoints() {
+  OriginalRetain = _swift_retain;
+  _swift_retain = countingRetain;
+  OriginalRetainN = _swift_retain_n;
+  _swift_retain_n = countingRetainN;
+  OriginalRelease = _swift_release;
+  _swift_release = countingRelease;
+  OriginalReleaseN = _swift_release_n;
+  _swift_release_n = countingReleaseN;
+}
+
+std::atomic<State> swift::runtime_stats::CurrentState{State::Uninitialized};
+static swift_once_t InitializeOnce;
+
+static void dumpRuntimeStatsAtExit() {
+  swift_runtimeStatsDump();
+}
+
+static void initializeRuntimeStats(void *) {
+  const char *value = getenv("SWIFT_RUNTIME_STATS");
+  if (!value || !value[0] || strcmp(value, "0") == 0) {
+    CurrentState.store(State::Disabled, std::memory_order_relaxed);
+    return;
+  }
+
+  installCountingEntryPoints();
+  atexit(dumpRuntimeStatsAtExit);
+  CurrentState.store(State::Enabled, std::memory_order_relaxed);
+}
+
+State swift::runtime_stats::initialize() {
+  swift_once(&InitializeOnce, initializeRuntimeStats);
+  return CurrentState.load(std::memory_order_relaxed);
+}
+
+uint64_t swift::runtime_stats::getTime() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(
+           steady_clock::now().time_since_epoch()).count();
+}
+
+static unsigned getLatencyBucket(uint64_t nanoseconds) {
+  unsigned bucket = 0;
+  while (nanoseconds >>= 1)
+    ++bucket;
+  return bucket < NumLatencyBuckets ? bucket : NumLatencyBuckets - 1;
+}
+
+void swift::runtime_stats::recordCall(EntryPoint entryPoint,
+                                      uint64_t nanoseconds) {
+  auto &stats = EntryPoints[unsigned(entryPoint)];
+  stats.TotalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  stats.Latencies[getLatencyBucket(nanoseconds)]
+    .fetch_add(1, std::memory_order_relaxed);
+}
+
+void swift::runtime_stats::recordEvent(Event event, uint64_t count) {
+  Events[unsigned(event)].fetch_add(count, std::memory_order_relaxed);
+}
+
+/// Returns the upper bound, in nanoseconds, of the bucket that contains the
+/// call at \p fraction of the way through the sorted latencies.
+static uint64_t getLatencyPercentile(const uint64_t *latencies, uint64_t calls,
+                                     double fraction) {
+  uint64_t rank = uint64_t(fraction * double(calls));
+  uint64_t seen = 0;
+  for (unsigned bucket = 0; bucket != NumLatencyBuckets; ++bucket) {
+    seen += latencies[bucket];
+    if (seen > rank)
+      return uint64_t(2) << bucket;
+  }
+  return uint64_t(2) << (NumLatencyBuckets - 1);
+}
+
+/// Returns the number of calls recorded for \p stats. This is the sum of its
+/// histogram, so that it is consistent with the percentiles.
+static uint64_t getCallCount(const EntryPointStats &stats,
+                             uint64_t *latencies = nullptr) {
+  uint64_t calls = 0;
+  for (unsigned bucket = 0; bucket != NumLatencyBuckets; ++bucket) {
+    uint64_t count = stats.Latencies[bucket].load(std::memory_order_relaxed);
+    if (latencies)
+      latencies[bucket] = count;
+    calls += count;
+  }
+  return calls;
+}
+
+uint64_t swift::swift_runtimeStatsGetCallCount(const char *entryPoint) {
+  if (!isEnabled())
+    return 0;
+  for (unsigned i = 0; i != NumEntryPoints; ++i)
+    if (strcmp(EntryPointNames[i], entryPoint) == 0)
+      return getCallCount(EntryPoints[i]);
+  for (unsigned i = 0; i != NumCountedEntryPoints; ++i)
+    if (strcmp(CountedEntryPointNames[i], entryPoint) == 0)
+      return CountedCalls[i].load(std::memory_order_relaxed);
+  return 0;
+}
+
+void swift::swift_runtimeStatsDump() {
+  if (!isEnabled()) {
+    fprintf(stderr, "swift runtime statistics are disabled; "
+                    "set SWIFT_RUNTIME_STATS=1 to enable them\n");
+    return;
+  }
+
+  fprintf(stderr, "swift runtime statistics:\n");
+  fprintf(stderr, "%-30s %14s %12s %12s %12s\n",
+          "entry point", "calls", "mean ns", "p50 ns <", "p99 ns <");
+  for (unsigned i = 0; i != NumEntryPoints; ++i) {
+    auto &stats = EntryPoints[i];
+    uint64_t latencies[NumLatencyBuckets];
+    uint64_t calls = getCallCount(stats, latencies);
+    if (calls == 0)
+      continue;
+    uint64_t total = stats.TotalNanoseconds.load(std::memory_order_relaxed);
+    fprintf(stderr, "%-30s %14llu %12llu %12llu %12llu\n",
+            EntryPointNames[i], (unsigned long long) calls,
+            (unsigned long long) (total / calls),
+            (unsigned long long) getLatencyPercentile(latencies, calls, 0.5),
+            (unsigned long long) getLatencyPercentile(latencies, calls, 0.99));
+  }
+
+  for (unsigned i = 0; i != NumCountedEntryPoints; ++i) {
+    uint64_t calls = CountedCalls[i].load(std::memory_order_relaxed);
+    if (calls == 0)
+      continue;
+    fprintf(stderr, "%-30s %14llu\n", CountedEntryPointNames[i],
+            (unsigned long long) calls);
+  }
+
+  for (unsigned i = 0; i != NumEvents; ++i) {
+    fprintf(stderr, "%14llu %s\n",
+            (unsigned long long) Events[i].load(std::memory_order_relaxed),
+            EventDescriptions[i]);
+  }
+}
@@ -0,0 +1,95 @@
+//===--- RuntimeStats.h - Runtime statistics --------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters and latency histograms for runtime entry points. They are always
+// compiled in, and enabled by setting SWIFT_RUNTIME_STATS=1 in the
+// environment. While disabled, each instrumented call costs one relaxed
+// load and a branch.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_RUNTIMESTATS_H
+#define SWIFT_RUNTIME_RUNTIMESTATS_H
+
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <cstdint>
+
+namespace swift {
+namespace runtime_stats {
+
+enum class EntryPoint : unsigned {
+#define RUNTIME_STATS_ENTRY_POINT(NAME) NAME,
+#include "RuntimeStats.def"
+};
+
+enum class Event : unsigned {
+#define RUNTIME_STATS_EVENT(NAME, DESCRIPTION) NAME,
+#include "RuntimeStats.def"
+};
+
+enum class State : uint8_t { Uninitialized, Disabled, Enabled };
+
+LLVM_LIBRARY_VISIBILITY
+extern std::atomic<State> CurrentState;
+
+/// Read SWIFT_RUNTIME_STATS from the environment.
+LLVM_LIBRARY_VISIBILITY
+State initialize();
+
+static inline bool isEnabled() {
+  auto state = CurrentState.load(std::memory_order_relaxed);
+  if (LLVM_UNLIKELY(state == State::Uninitialized))
+    state = initialize();
+  return state == State::Enabled;
+}
+
+/// Returns a monotonic time in nanoseconds.
+LLVM_LIBRARY_VISIBILITY
+uint64_t getTime();
+
+LLVM_LIBRARY_VISIBILITY
+void recordCall(EntryPoint entryPoint, uint64_t nanoseconds);
+
+LLVM_LIBRARY_VISIBILITY
+void recordEvent(Event event, uint64_t count = 1);
+
+static inline void countEvent(Event event) {
+  if (LLVM_UNLIKELY(isEnabled()))
+    recordEvent(event);
+}
+
+/// Counts and times a call to a runtime entry point for the lifetime of the
+/// object.
+class EntryPointScope {
+  EntryPoint Point;
+  uint64_t Start;
+
+public:
+  explicit EntryPointScope(EntryPoint point) : Point(point), Start(0) {
+    if (LLVM_UNLIKELY(isEnabled()))
+      Start = getTime();
+  }
+
+  ~EntryPointScope() {
+    if (LLVM_UNLIKELY(Start != 0))
+      recordCall(Point, getTime() - Start);
+  }
+
+  EntryPointScope(const EntryPointScope &) = delete;
+  EntryPointScope &operator=(const EntryPointScope &) = delete;
+};
+
+} // end namespace runtime_stats
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_RUNTIMESTATS_H
@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "../SwiftShims/LibcShims.h"
+#include "swift/Runtime/Heap.h"
 
 using namespace swift;
 
@@ -37,6 +38,19 @@ __swift_size_t swift::_swift_stdlib_fwrite_stdout(const void *ptr,
   return fwrite(ptr, size, nitems, stdout);
 }
 
+__swift_size_t
+swift::_swift_stdlib_fwrite_unlocked_stdout(const void *ptr,
+                                            __swift_size_t size,
+                                            __swift_size_t nitems) {
+#if defined(__GLIBC__)
+  return fwrite_unlocked(ptr, size, nitems, stdout);
+#else
+  // The stream lock is recursive, so taking it again is correct, just not
+  // free.
+  return fwrite(ptr, size, nitems, stdout);
+#endif
+}
+
 __swift_size_t swift::_swift_stdlib_strlen(const char *s) {
   return strlen(s);
 }
@@ -63,16 +77,22 @@ int swift::_swift_stdlib_close(int fd) {
 #if defined(__APPLE__)
 #include <malloc/malloc.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_slowAllocUsableSize(ptr))
+    return size;
   return malloc_size(ptr);
 }
 #elif defined(__GNU_LIBRARY__) || defined(__CYGWIN__) || defined(__ANDROID__)
 #include <malloc.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_slowAllocUsableSize(ptr))
+    return size;
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #elif defined(__FreeBSD__)
 #include <malloc_np.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = _swift_slowAllocUsableSize(ptr))
+    return size;
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #else
@@ -23,7 +23,9 @@
 #include <sys/resource.h>
 #include <sys/errno.h>
 #include <unistd.h>
+#include <cassert>
 #include <climits>
+#include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
@@ -31,7 +33,6 @@
 #include <cstring>
 #if defined(__CYGWIN__)
 #include <sstream>
-#include <cmath>
 #define fmodl(lhs, rhs) std::fmod(lhs, rhs)
 #elif defined(__ANDROID__)
 // Android's libc implementation Bionic currently only supports the "C" locale
@@ -57,7 +58,16 @@ static long double swift_strtold_l(const char *nptr,
 #include <xlocale.h>
 #endif
 #include <limits>
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#endif
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Basic/Lazy.h"
 
@@ -174,6 +184,310 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+//===----------------------------------------------------------------------===//
+// Shortest round-trip formatting of Float and Double
+//===----------------------------------------------------------------------===//
+
+// This is the Grisu2 algorithm from Florian Loitsch, "Printing Floating-Point
+// Numbers Quickly and Accurately with Integers" (PLDI 2010). It produces the
+// digits of a decimal number in the rounding interval of the input, so the
+// result always reads back as the same value. In rare cases it is one digit
+// longer than the shortest such number.
+
+namespace {
+
+/// A floating-point number with a 64-bit significand and a binary exponent.
+struct DiyFp {
+  uint64_t F;
+  int E;
+
+  DiyFp() : F(0), E(0) {}
+  DiyFp(uint64_t F, int E) : F(F), E(E) {}
+
+  DiyFp operator-(const DiyFp &RHS) const {
+    assert(E == RHS.E && F >= RHS.F);
+    return DiyFp(F - RHS.F, E);
+  }
+
+  /// Returns the product, with the significand rounded to 64 bits.
+  DiyFp operator*(const DiyFp &RHS) const {
+    const uint64_t M32 = 0xFFFFFFFF;
+    uint64_t A = F >> 32, B = F & M32, C = RHS.F >> 32, D = RHS.F & M32;
+    uint64_t AC = A * C, BC = B * C, AD = A * D, BD = B * D;
+    uint64_t Mid = (BD >> 32) + (AD & M32) + (BC & M32) + (uint64_t(1) << 31);
+    return DiyFp(AC + (AD >> 32) + (BC >> 32) + (Mid >> 32),
+                 E + RHS.E + 64);
+  }
+
+  DiyFp normalize() const {
+    assert(F != 0);
+    unsigned Shift = llvm::countLeadingZeros(F);
+    return DiyFp(F << Shift, E - int(Shift));
+  }
+};
+
+template <typename T> struct FloatFormatTraits;
+
+template <> struct FloatFormatTraits<float> {
+  typedef uint32_t Bits;
+  static const int SignificandSize = 23;
+  static const int ExponentMask = 0xFF;
+  static const int ExponentBias = 0x7F + SignificandSize;
+};
+
+template <> struct FloatFormatTraits<double> {
+  typedef uint64_t Bits;
+  static const int SignificandSize = 52;
+  static const int ExponentMask = 0x7FF;
+  static const int ExponentBias = 0x3FF + SignificandSize;
+};
+
+/// Normalized 64-bit approximations of 10^-348, 10^-340, ..., 10^340.
+const uint64_t CachedPowersF[] = {
+    0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76,
+    0xcf42894a5dce35ea, 0x9a6bb0aa55653b2d, 0xe61acf033d1a45df,
+    0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f, 0xbe5691ef416bd60c,
+    0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+    0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57,
+    0xc21094364dfb5637, 0x9096ea6f3848984f, 0xd77485cb25823ac7,
+    0xa086cfcd97bf97f4, 0xef340a98172aace5, 0xb23867fb2a35b28e,
+    0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+    0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126,
+    0xb5b5ada8aaff80b8, 0x87625f056c7c4a8b, 0xc9bcff6034c13053,
+    0x964e858c91ba2655, 0xdff9772470297ebd, 0xa6dfbd9fb8e5b88f,
+    0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+    0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06,
+    0xaa242499697392d3, 0xfd87b5f28300ca0e, 0xbce5086492111aeb,
+    0x8cbccc096f5088cc, 0xd1b71758e219652c, 0x9c40000000000000,
+    0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+    0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068,
+    0x9f4f2726179a2245, 0xed63a231d4c4fb27, 0xb0de65388cc8ada8,
+    0x83c7088e1aab65db, 0xc45d1df942711d9a, 0x924d692ca61be758,
+    0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+    0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d,
+    0x952ab45cfa97a0b3, 0xde469fbd99a05fe3, 0xa59bc234db398c25,
+    0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece, 0x88fcf317f22241e2,
+    0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+    0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410,
+    0x8bab8eefb6409c1a, 0xd01fef10a657842c, 0x9b10a4e5e9913129,
+    0xe7109bfba19c0c9d, 0xac2820d9623bf429, 0x80444b5e7aa7cf85,
+    0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+    0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+
+/// The binary exponents of `CachedPowersF`.
+const int16_t CachedPowersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635,
+    -608, -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316,
+    -289, -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30, 56,
+    83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348, 375, 402, 428, 455,
+    481, 508, 534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800, 827, 853,
+    880, 907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+const uint64_t PowersOf10[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/// Returns a cached power of ten, 10^-K, that brings a number with binary
+/// exponent \p E into the range where the digits can be generated with
+/// 64-bit arithmetic.
+DiyFp getCachedPower(int E, int &K) {
+  double DK = (-61 - E) * 0.30102999566398114 + 347;
+  int IK = static_cast<int>(DK);
+  if (DK - IK > 0.0)
+    ++IK;
+  unsigned Index = static_cast<unsigned>((IK >> 3) + 1);
+  K = -(-348 + static_cast<int>(Index << 3));
+  return DiyFp(CachedPowersF[Index], CachedPowersE[Index]);
+}
+
+unsigned countDecimalDigits(uint32_t N) {
+  unsigned Count = 1;
+  while (Count < 10 && N >= PowersOf10[Count])
+    ++Count;
+  return Count;
+}
+
+/// Moves the last digit towards the value while the result stays inside the
+/// rounding interval.
+void grisuRound(char *Buffer, int Length, uint64_t Delta, uint64_t Rest,
+                uint64_t TenKappa, uint64_t WpW) {
+  while (Rest < WpW && Delta - Rest >= TenKappa &&
+         (Rest + TenKappa < WpW || WpW - Rest > Rest + TenKappa - WpW)) {
+    Buffer[Length - 1]--;
+    Rest += TenKappa;
+  }
+}
+
+/// Generates the digits of a number between `Mp - Delta` and `Mp`, as close
+/// to `W` as possible.
+void generateDigits(const DiyFp &W, const DiyFp &Mp, uint64_t Delta,
+                    char *Buffer, int &Length, int &K) {
+  const DiyFp One(uint64_t(1) << -Mp.E, Mp.E);
+  const DiyFp WpW = Mp - W;
+  uint32_t P1 = static_cast<uint32_t>(Mp.F >> -One.E);
+  uint64_t P2 = Mp.F & (One.F - 1);
+  int Kappa = countDecimalDigits(P1);
+  Length = 0;
+
+  while (Kappa > 0) {
+    uint32_t D = P1 / static_cast<uint32_t>(PowersOf10[Kappa - 1]);
+    P1 %= static_cast<uint32_t>(PowersOf10[Kappa - 1]);
+    if (D || Length)
+      Buffer[Length++] = static_cast<char>('0' + D);
+    --Kappa;
+    uint64_t Rest = (static_cast<uint64_t>(P1) << -One.E) + P2;
+    if (Rest <= Delta) {
+      K += Kappa;
+      grisuRound(Buffer, Length, Delta, Rest, PowersOf10[Kappa] << -One.E,
+                 WpW.F);
+      return;
+    }
+  }
+
+  while (true) {
+    P2 *= 10;
+    Delta *= 10;
+    char D = static_cast<char>(P2 >> -One.E);
+    if (D || Length)
+      Buffer[Length++] = static_cast<char>('0' + D);
+    P2 &= One.F - 1;
+    --Kappa;
+    if (P2 < Delta) {
+      K += Kappa;
+      grisuRound(Buffer, Length, Delta, P2, One.F,
+                 -Kappa < 20 ? WpW.F * PowersOf10[-Kappa] : 0);
+      return;
+    }
+  }
+}
+
+/// Writes the digits of a positive, finite \p Value to \p Digits, so that
+/// the value reads back from Digits × 10^K. Returns the number of digits,
+/// which is at most 17, and has no trailing zeros.
+template <typename T>
+int shortestDigits(T Value, char *Digits, int &K) {
+  typedef FloatFormatTraits<T> Traits;
+  typename Traits::Bits Bits;
+  memcpy(&Bits, &Value, sizeof(Bits));
+
+  const uint64_t HiddenBit = uint64_t(1) << Traits::SignificandSize;
+  uint64_t Significand = Bits & (HiddenBit - 1);
+  int BiasedExponent = int(Bits >> Traits::SignificandSize) &
+                       Traits::ExponentMask;
+  DiyFp V = BiasedExponent != 0
+    ? DiyFp(Significand + HiddenBit, BiasedExponent - Traits::ExponentBias)
+    : DiyFp(Significand, 1 - Traits::ExponentBias);
+
+  // The boundaries halfway to the neighbouring values. The lower one is
+  // closer when the significand is a power of two.
+  DiyFp Plus = DiyFp((V.F << 1) + 1, V.E - 1).normalize();
+  DiyFp Minus = V.F == HiddenBit ? DiyFp((V.F << 2) - 1, V.E - 2)
+                                 : DiyFp((V.F << 1) - 1, V.E - 1);
+  Minus.F <<= Minus.E - Plus.E;
+  Minus.E = Plus.E;
+
+  DiyFp CachedPower = getCachedPower(Plus.E, K);
+  DiyFp W = V.normalize() * CachedPower;
+  DiyFp Wp = Plus * CachedPower;
+  DiyFp Wm = Minus * CachedPower;
+  // Stay strictly inside the interval, to absorb the rounding errors above.
+  ++Wm.F;
+  --Wp.F;
+
+  int Length;
+  generateDigits(W, Wp, Wp.F - Wm.F, Digits, Length, K);
+  while (Length > 1 && Digits[Length - 1] == '0') {
+    --Length;
+    ++K;
+  }
+  return Length;
+}
+
+/// Writes Digits × 10^K to Buffer the way `%.*g` would with the given
+/// precision, which must be at least \p Length, and adds ".0" to a number
+/// written without a fractional part or an exponent. Returns the number of
+/// characters written; at most 26 are needed.
+uint64_t formatDecimal(char *Buffer, bool Negative, const char *Digits,
+                       int Length, int K, int Precision) {
+  char *P = Buffer;
+  if (Negative)
+    *P++ = '-';
+
+  int Exponent = Length + K - 1;
+  if (Exponent < -4 || Exponent >= Precision) {
+    *P++ = Digits[0];
+    if (Length > 1) {
+      *P++ = '.';
+      memcpy(P, Digits + 1, Length - 1);
+      P += Length - 1;
+    }
+    *P++ = 'e';
+    *P++ = Exponent < 0 ? '-' : '+';
+    unsigned AbsExponent = Exponent < 0 ? -Exponent : Exponent;
+    if (AbsExponent >= 100)
+      *P++ = static_cast<char>('0' + AbsExponent / 100);
+    *P++ = static_cast<char>('0' + AbsExponent / 10 % 10);
+    *P++ = static_cast<char>('0' + AbsExponent % 10);
+  } else if (Exponent < 0) {
+    *P++ = '0';
+    *P++ = '.';
+    for (int i = -1; i > Exponent; --i)
+      *P++ = '0';
+    memcpy(P, Digits, Length);
+    P += Length;
+  } else if (Length <= Exponent + 1) {
+    memcpy(P, Digits, Length);
+    P += Length;
+    for (int i = Length; i <= Exponent; ++i)
+      *P++ = '0';
+    *P++ = '.';
+    *P++ = '0';
+  } else {
+    memcpy(P, Digits, Exponent + 1);
+    P += Exponent + 1;
+    *P++ = '.';
+    memcpy(P, Digits + Exponent + 1, Length - Exponent - 1);
+    P += Length - Exponent - 1;
+  }
+  return uint64_t(P - Buffer);
+}
+
+} // end anonymous namespace
+
+/// Writes the `description` of a normal Float or Double whose shortest
+/// round-trip digits fit in `digits10` digits. Those are exactly the digits
+/// that `%.*g` prints at that precision, so this matches the `snprintf` path
+/// below. Returns false, and writes nothing, for other values.
+template <typename T>
+static bool formatDescriptionFromShortestDigits(char *Buffer, T Value,
+                                                uint64_t &Length) {
+  // Subnormals have fewer significant digits than `digits10`.
+  if (!std::isnormal(Value))
+    return false;
+  char Digits[20];
+  int K;
+  int NumDigits = shortestDigits(std::fabs(Value), Digits, K);
+  const int Precision = std::numeric_limits<T>::digits10;
+  if (NumDigits > Precision)
+    return false;
+  Length = formatDecimal(Buffer, std::signbit(Value), Digits, NumDigits, K,
+                         Precision);
+  return true;
+}
+
+static bool formatDescriptionFromShortestDigits(char *Buffer,
+                                                long double Value,
+                                                uint64_t &Length) {
+  return false;
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -181,6 +495,10 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   if (BufferLength < 32)
     swift::crash("swift_floatingPointToString: insufficient buffer size");
 
+  uint64_t Length;
+  if (!Debug && formatDescriptionFromShortestDigits(Buffer, Value, Length))
+    return Length;
+
   int Precision = std::numeric_limits<T>::digits10;
   if (Debug) {
     Precision = std::numeric_limits<T>::max_digits10;
@@ -241,6 +559,49 @@ extern "C" uint64_t swift_float64ToString(char *Buffer, size_t BufferLength,
                                              "%0.*g", Debug);
 }
 
+/// Writes the shortest text that reads back as the same finite \p Value, in
+/// the notation that `debugDescription` uses.
+template <typename T>
+static uint64_t swift_floatingPointToShortestString(char *Buffer,
+                                                    size_t BufferLength,
+                                                    T Value) {
+  if (BufferLength < 32)
+    swift::crash(
+      "swift_floatingPointToShortestString: insufficient buffer size");
+  if (!std::isfinite(Value))
+    swift::crash("swift_floatingPointToShortestString: value is not finite");
+
+  if (Value == 0) {
+    char *P = Buffer;
+    if (std::signbit(Value))
+      *P++ = '-';
+    memcpy(P, "0.0", 3);
+    return uint64_t(P + 3 - Buffer);
+  }
+
+  char Digits[20];
+  int K;
+  int NumDigits = shortestDigits(std::fabs(Value), Digits, K);
+  return formatDecimal(Buffer, std::signbit(Value), Digits, NumDigits, K,
+                       std::numeric_limits<T>::max_digits10);
+}
+
+SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
+extern "C" uint64_t swift_float32ToShortestString(char *Buffer,
+                                                  size_t BufferLength,
+                                                  float Value) {
+  return swift_floatingPointToShortestString<float>(Buffer, BufferLength,
+                                                    Value);
+}
+
+SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
+extern "C" uint64_t swift_float64ToShortestString(char *Buffer,
+                                                  size_t BufferLength,
+                                                  double Value) {
+  return swift_floatingPointToShortestString<double>(Buffer, BufferLength,
+                                                     Value);
+}
+
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
 extern "C" uint64_t swift_float80ToString(char *Buffer, size_t BufferLength,
                                           long double Value, bool Debug) {
@@ -467,3 +828,33 @@ int swift::_swift_stdlib_putc_stderr(int C) {
 size_t swift::_swift_stdlib_getHardwareConcurrency() {
   return sysconf(_SC_NPROCESSORS_ONLN);
 }
+
+void swift::_swift_stdlib_concurrentPerform(
+    size_t iterations, void *context,
+    void (*work)(void *context, size_t index)) {
+  if (iterations == 0)
+    return;
+#if defined(__APPLE__)
+  dispatch_apply_f(iterations,
+                   dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                   context, work);
+#else
+  // Without libdispatch, start a thread per hardware thread for the duration
+  // of the call; each one claims the next unclaimed index until none are
+  // left.
+  std::atomic<size_t> nextIndex(0);
+  auto runWorker = [&] {
+    for (size_t i = nextIndex++; i < iterations; i = nextIndex++)
+      work(context, i);
+  };
+  size_t threadCount = std::min(
+      iterations, std::max<size_t>(1, _swift_stdlib_getHardwareConcurrency()));
+  std::vector<std::thread> helpers;
+  helpers.reserve(threadCount - 1);
+  for (size_t i = 1; i < threadCount; ++i)
+    helpers.emplace_back(runWorker);
+  runWorker();
+  for (auto &helper : helpers)
+    helper.join();
+#endif
+}
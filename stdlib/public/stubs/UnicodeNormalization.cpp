@@ -18,6 +18,7 @@
 #include "swift/Runtime/Debug.h"
 
 #include <algorithm>
+#include <cstring>
 #include <mutex>
 #include <assert.h>
 
@@ -25,6 +26,8 @@
 #include <unicode/ucol.h>
 #include <unicode/ucoleitr.h>
 #include <unicode/uiter.h>
+#include <unicode/uset.h>
+#include <unicode/utf16.h>
 
 #include "../SwiftShims/UnicodeShims.h"
 
@@ -67,10 +70,35 @@ static const UCollator *GetRootCollator() {
   return RootCollator;
 }
 
+// These functions use murmurhash2 in its 32 and 64bit forms, which are
+// differentiated by the constants defined below. This seems like a good choice
+// for now because it operates efficiently in blocks rather than bytes, and 
+// the data returned from the collation iterator comes in 4byte chunks.
+#if __arm__ || __i386__
+#define HASH_SEED 0x88ddcc21
+#define HASH_M 0x5bd1e995
+#define HASH_R 24
+#else
+#define HASH_SEED 0x429b126688ddcc21
+#define HASH_M 0xc6a4a7935bd1e995
+#define HASH_R 47
+#endif
+
 /// This class caches the collation element results for the ASCII subset of
 /// unicode.
 class ASCIICollation {
   int32_t CollationTable[128];
+
+  /// The collation elements of the non-ignorable ASCII characters, sorted,
+  /// and the characters they belong to.
+  std::pair<int32_t, unsigned char> SortedElements[128];
+  unsigned NumSortedElements = 0;
+
+  /// True if no two ASCII characters have the same collation element and
+  /// every non-ignorable one has a primary weight, which the fast paths
+  /// below rely on.
+  bool HasFastPaths = true;
+
 public:
 
   static const ASCIICollation *getTable() {
@@ -86,6 +114,26 @@ public:
     return CollationTable[c];
   }
 
+  /// Maps an ASCII character to its primary collation weight.
+  uint32_t mapPrimary(unsigned char c) const {
+    return ucol_primaryOrder(CollationTable[c]);
+  }
+
+  bool hasFastPaths() const {
+    return HasFastPaths;
+  }
+
+  /// Maps a non-zero collation element back to the ASCII character it
+  /// belongs to, or returns 0 if it is not the element of an ASCII character.
+  unsigned char unmap(int32_t Elem) const {
+    auto End = SortedElements + NumSortedElements;
+    auto I = std::lower_bound(SortedElements, End,
+                              std::make_pair(Elem, (unsigned char)0));
+    if (I == End || I->first != Elem)
+      return 0;
+    return I->second;
+  }
+
 private:
   /// Construct the ASCII collation table.
   ASCIICollation() {
@@ -117,13 +165,312 @@ private:
       if (U_FAILURE(ErrorCode) || NumCollationElts != 1) {
         swift::crash("Error setting up the ASCII collation table");
       }
+
+      if (CollationTable[c] != 0) {
+        SortedElements[NumSortedElements++] = {CollationTable[c], c};
+        if (ucol_primaryOrder(CollationTable[c]) == 0)
+          HasFastPaths = false;
+      }
     }
+
+    std::sort(SortedElements, SortedElements + NumSortedElements);
+    for (unsigned i = 1; i < NumSortedElements; ++i)
+      if (SortedElements[i - 1].first == SortedElements[i].first)
+        HasFastPaths = false;
   }
 
   ASCIICollation &operator=(const ASCIICollation &) = delete;
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// This class caches the collation elements of the code points below U+0300,
+/// which covers Latin-1 and the Latin Extended blocks, so that text made of
+/// them can be compared and hashed without calling into ICU.
+///
+/// Every such code point is an NFC-stable starter: its canonical combining
+/// class is 0 and its NFC quick check property is Yes. A run of them is
+/// therefore never reordered or recomposed by the normalization that ICU
+/// performs before collating, and each one collates to the same elements as
+/// it does on its own, unless it continues a contraction. Code points that
+/// appear after the first position of a contraction or a prefix rule, or that
+/// map to more elements than are cached, are left out of the table.
+class LatinCollation {
+public:
+  /// The first code point that is not covered by the table.
+  static const uint16_t Limit = 0x300;
+
+private:
+  static const unsigned MaxElements = 3;
+  static const uint8_t NotCached = 0xff;
+
+  /// The non-zero collation elements of each code point, and their primary
+  /// weights.
+  int32_t Elements[Limit][MaxElements];
+  uint16_t Primaries[Limit][MaxElements];
+  uint8_t NumElements[Limit];
+
+public:
+
+  static const LatinCollation *getTable() {
+    // We are relying on C++11's guarantee of thread safe static variable
+    // initialization.
+    static LatinCollation collation;
+    return &collation;
+  }
+
+  /// Returns true if \p c is a code point whose collation elements are
+  /// cached.
+  bool isCached(uint16_t c) const {
+    return c < Limit && NumElements[c] != NotCached;
+  }
+
+  /// Returns true if every code unit of the string is cached.
+  template <typename CodeUnit>
+  bool isCached(const CodeUnit *Str, int32_t Length) const {
+    for (int32_t i = 0; i < Length; ++i)
+      if (!isCached(static_cast<uint16_t>(Str[i])))
+        return false;
+    return true;
+  }
+
+  unsigned numElements(uint16_t c) const {
+    assert(isCached(c));
+    return NumElements[c];
+  }
+
+  int32_t element(uint16_t c, unsigned i) const {
+    assert(i < numElements(c));
+    return Elements[c][i];
+  }
+
+  uint16_t primary(uint16_t c, unsigned i) const {
+    assert(i < numElements(c));
+    return Primaries[c][i];
+  }
+
+private:
+  /// Construct the table from the root collator.
+  LatinCollation() {
+    const UCollator *Collator = GetRootCollator();
+    for (uint16_t c = 0; c < Limit; ++c) {
+      UErrorCode ErrorCode = U_ZERO_ERROR;
+#if defined(__CYGWIN__)
+      UChar Buffer[1];
+#else
+      uint16_t Buffer[1];
+#endif
+      Buffer[0] = c;
+
+      UCollationElements *CollationIterator =
+          ucol_openElements(Collator, Buffer, 1, &ErrorCode);
+
+      unsigned Count = 0;
+      bool Cacheable = true;
+      while (U_SUCCESS(ErrorCode)) {
+        int32_t Elem = ucol_next(CollationIterator, &ErrorCode);
+        if (Elem == UCOL_NULLORDER)
+          break;
+        if (Elem == 0)
+          continue;
+        // Primaries split across continuation elements are not compared
+        // correctly by the primary-weight fast path below.
+        if (Count == MaxElements || (Elem & 0xC0) == 0xC0) {
+          Cacheable = false;
+          break;
+        }
+        Elements[c][Count] = Elem;
+        Primaries[c][Count] = ucol_primaryOrder(Elem);
+        ++Count;
+      }
+
+      ucol_closeElements(CollationIterator);
+      if (U_FAILURE(ErrorCode)) {
+        swift::crash("Error setting up the Latin collation table");
+      }
+      NumElements[c] = Cacheable ? Count : NotCached;
+    }
+
+    // A code point collates differently after the start of a contraction, so
+    // text containing it has to go through ICU from the code point before.
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    USet *Contractions = uset_openEmpty();
+    ucol_getContractionsAndExpansions(Collator, Contractions, nullptr,
+                                      /*addPrefixes=*/true, &ErrorCode);
+    int32_t NumItems = uset_getItemCount(Contractions);
+    for (int32_t Item = 0; U_SUCCESS(ErrorCode) && Item < NumItems; ++Item) {
+      UChar32 Start, End;
+      UChar String[64];
+      int32_t Length = uset_getItem(Contractions, Item, &Start, &End,
+                                    String, 64, &ErrorCode);
+      if (U_FAILURE(ErrorCode))
+        break;
+      if (Length == 0)
+        continue;
+      int32_t Pos = 0;
+      U16_FWD_1(String, Pos, Length);
+      while (Pos < Length) {
+        UChar32 Next;
+        U16_NEXT(String, Pos, Length, Next);
+        if (Next < Limit)
+          NumElements[Next] = NotCached;
+      }
+    }
+    uset_close(Contractions);
+    if (U_FAILURE(ErrorCode)) {
+      swift::crash("Error setting up the Latin collation table");
+    }
+  }
+
+  LatinCollation &operator=(const LatinCollation &) = delete;
+  LatinCollation(const LatinCollation &) = delete;
+};
+
+/// Walks the non-zero primary weights of a string whose code units are all in
+/// the Latin collation table.
+template <typename CodeUnit>
+class LatinPrimaryIterator {
+  const LatinCollation *Table;
+  const CodeUnit *Str;
+  int32_t Length;
+  int32_t Pos = 0;
+  unsigned Elem = 0;
+
+public:
+  LatinPrimaryIterator(const LatinCollation *Table, const CodeUnit *Str,
+                       int32_t Length)
+    : Table(Table), Str(Str), Length(Length) {}
+
+  /// Returns the next non-zero primary weight, or 0 at the end of the string.
+  uint32_t next() {
+    while (Pos < Length) {
+      uint16_t c = static_cast<uint16_t>(Str[Pos]);
+      if (Elem < Table->numElements(c)) {
+        if (uint32_t Primary = Table->primary(c, Elem++))
+          return Primary;
+        continue;
+      }
+      ++Pos;
+      Elem = 0;
+    }
+    return 0;
+  }
+};
+
+/// Compares the primary weights of two strings that are in the Latin
+/// collation table. Returns 0 if the strings only differ at the secondary or
+/// tertiary level, which is left to ICU.
+///
+/// The code points in the table collate the same in any context, so the
+/// code units before the first difference are skipped.
+template <typename LeftCodeUnit, typename RightCodeUnit>
+static int32_t compareLatinPrimaries(const LatinCollation *Table,
+                                     const LeftCodeUnit *LeftString,
+                                     int32_t LeftLength,
+                                     const RightCodeUnit *RightString,
+                                     int32_t RightLength) {
+  int32_t MinLength = std::min(LeftLength, RightLength);
+  int32_t Prefix = 0;
+  while (Prefix < MinLength &&
+         static_cast<uint16_t>(LeftString[Prefix]) ==
+           static_cast<uint16_t>(RightString[Prefix]))
+    ++Prefix;
+
+  LatinPrimaryIterator<LeftCodeUnit> Left(Table, LeftString + Prefix,
+                                          LeftLength - Prefix);
+  LatinPrimaryIterator<RightCodeUnit> Right(Table, RightString + Prefix,
+                                            RightLength - Prefix);
+  while (true) {
+    uint32_t LeftPrimary = Left.next();
+    uint32_t RightPrimary = Right.next();
+    // The string that runs out of primary weights first sorts first, which
+    // falls out of the end being reported as 0.
+    if (LeftPrimary != RightPrimary)
+      return LeftPrimary < RightPrimary ? -1 : 1;
+    if (LeftPrimary == 0)
+      return 0;
+  }
+}
+
+/// Hashes a string that collates the same as an ASCII string by the bytes of
+/// that ASCII string, with the ignorable characters left out, a word at a
+/// time.
+///
+/// Two such strings are equal exactly when they have the same non-ignorable
+/// characters, because no two ASCII characters have the same collation
+/// element, so this is consistent with String's ==.
+class ASCIIHasher {
+  uintptr_t HashState = HASH_SEED;
+  uintptr_t Pending = 0;
+  unsigned NumPending = 0;
+
+  void mix(uintptr_t Word) {
+    Word *= HASH_M;
+    Word ^= Word >> HASH_R;
+    Word *= HASH_M;
+
+    HashState *= HASH_M;
+    HashState ^= Word;
+  }
+
+public:
+  static constexpr unsigned BytesPerWord = sizeof(uintptr_t);
+
+  /// Adds a word of eight (or four) non-ignorable characters, the first in
+  /// the low bits. Only valid at a word boundary.
+  void addWord(uintptr_t Word) {
+    assert(NumPending == 0 && "not at a word boundary");
+    mix(Word);
+  }
+
+  /// Adds a non-ignorable character.
+  void addByte(unsigned char c) {
+    assert(c != 0);
+    Pending |= uintptr_t(c) << (8 * NumPending);
+    if (++NumPending == BytesPerWord) {
+      mix(Pending);
+      Pending = 0;
+      NumPending = 0;
+    }
+  }
+
+  bool isAtWordBoundary() const {
+    return NumPending == 0;
+  }
+
+  intptr_t finish() {
+    // The pending characters are all non-zero, so the partial word also
+    // encodes how many there are.
+    if (NumPending != 0)
+      mix(Pending);
+    intptr_t Result = HashState;
+    Result ^= Result >> HASH_R;
+    Result *= HASH_M;
+    Result ^= Result >> HASH_R;
+    return Result;
+  }
+};
+
+/// Loads a word of characters, the first in the low bits.
+static uintptr_t loadASCIIWord(const char *Str) {
+  uintptr_t Word;
+  memcpy(&Word, Str, sizeof(Word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  Word = sizeof(Word) == 8 ? __builtin_bswap64(Word) : __builtin_bswap32(Word);
+#endif
+  return Word;
+}
+
+/// Returns true if \p Word may contain an ignorable ASCII character, or one
+/// that the fast paths do not handle: anything below a space (including the
+/// tab and newline characters, which are not ignorable), and DEL.
+static bool mayHaveControlCharacters(uintptr_t Word) {
+  const uintptr_t LowBits = ~uintptr_t(0) / 0xff;
+  const uintptr_t HighBits = LowBits << 7;
+  uintptr_t Del = Word ^ (LowBits * 0x7f);
+  return (((Word - LowBits * 0x20) & ~Word) | ((Del - LowBits) & ~Del))
+         & HighBits;
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -158,6 +505,17 @@ swift::_swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
                                                 int32_t LeftLength,
                                                 const uint16_t *RightString,
                                                 int32_t RightLength) {
+  // The left string is ASCII when called from the standard library. Bytes
+  // of a multi-byte UTF-8 sequence are negative as a `char`, so they are
+  // never found in the table and such strings go through ICU.
+  const LatinCollation *Latin = LatinCollation::getTable();
+  if (Latin->isCached(LeftString, LeftLength) &&
+      Latin->isCached(RightString, RightLength)) {
+    if (int32_t Diff = compareLatinPrimaries(Latin, LeftString, LeftLength,
+                                             RightString, RightLength))
+      return Diff;
+  }
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -203,23 +561,89 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
   return Diff;
 }
 
-// These functions use murmurhash2 in its 32 and 64bit forms, which are
-// differentiated by the constants defined below. This seems like a good choice
-// for now because it operates efficiently in blocks rather than bytes, and 
-// the data returned from the collation iterator comes in 4byte chunks.
-#if __arm__ || __i386__
-#define HASH_SEED 0x88ddcc21
-#define HASH_M 0x5bd1e995
-#define HASH_R 24
-#else
-#define HASH_SEED 0x429b126688ddcc21
-#define HASH_M 0xc6a4a7935bd1e995
-#define HASH_R 47
-#endif
+/// Compares two ASCII strings like _swift_stdlib_unicode_compare_utf8_utf8.
+///
+/// The characters before the first difference contribute the same weights to
+/// both strings at every level, so they are skipped with a word-wise
+/// comparison. If the rest of the strings differ in their primary weights,
+/// that decides the result without calling into ICU.
+int32_t
+swift::_swift_stdlib_unicode_compare_ascii_ascii(const char *LeftString,
+                                                 int32_t LeftLength,
+                                                 const char *RightString,
+                                                 int32_t RightLength) {
+  const ASCIICollation *Table = ASCIICollation::getTable();
+  if (!Table->hasFastPaths())
+    return _swift_stdlib_unicode_compare_utf8_utf8(LeftString, LeftLength,
+                                                   RightString, RightLength);
+
+  int32_t MinLength = std::min(LeftLength, RightLength);
+  int32_t Prefix = 0;
+  const int32_t BytesPerWord = sizeof(uintptr_t);
+  while (Prefix + BytesPerWord <= MinLength &&
+         loadASCIIWord(LeftString + Prefix) ==
+           loadASCIIWord(RightString + Prefix))
+    Prefix += BytesPerWord;
+  while (Prefix < MinLength && LeftString[Prefix] == RightString[Prefix])
+    ++Prefix;
+  if (Prefix == LeftLength && Prefix == RightLength)
+    return 0;
+
+  // Compare the primary weights of the rest, skipping ignorable characters.
+  int32_t L = Prefix, R = Prefix;
+  while (true) {
+    uint32_t LeftPrimary = 0, RightPrimary = 0;
+    while (L < LeftLength &&
+           (LeftPrimary = Table->mapPrimary(LeftString[L])) == 0)
+      ++L;
+    while (R < RightLength &&
+           (RightPrimary = Table->mapPrimary(RightString[R])) == 0)
+      ++R;
+    if (L == LeftLength || R == RightLength) {
+      if (L == LeftLength && R == RightLength)
+        break;
+      // The string that ran out of primary weights first sorts first.
+      return L == LeftLength ? -1 : 1;
+    }
+    if (LeftPrimary != RightPrimary)
+      return LeftPrimary < RightPrimary ? -1 : 1;
+    ++L;
+    ++R;
+  }
+
+  // The strings differ only at the secondary or tertiary level (for example
+  // in case), which is rare enough to leave to ICU.
+  return _swift_stdlib_unicode_compare_utf8_utf8(LeftString, LeftLength,
+                                                 RightString, RightLength);
+}
+
+/// Mixes a non-zero collation element into the hash of a string.
+static intptr_t hashElement(intptr_t HashState, intptr_t Elem,
+                            const ASCIICollation *Table,
+                            ASCIIHasher &AsciiHash, bool &IsAsciiHashValid) {
+  // As long as the string collates like an ASCII string, hash it the way
+  // that ASCII string would be hashed.
+  if (IsAsciiHashValid) {
+    if (unsigned char c = Table->unmap(Elem))
+      AsciiHash.addByte(c);
+    else
+      IsAsciiHashValid = false;
+  }
+
+  Elem *= HASH_M;
+  Elem ^= Elem >> HASH_R;
+  Elem *= HASH_M;
+
+  HashState *= HASH_M;
+  HashState ^= Elem;
+  return HashState;
+}
 
 static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
                           const uint16_t *Str, uint32_t Length,
-                          UErrorCode *ErrorCode) {
+                          UErrorCode *ErrorCode,
+                          const ASCIICollation *Table,
+                          ASCIIHasher &AsciiHash, bool &IsAsciiHashValid) {
 #if defined(__CYGWIN__)
   UCollationElements *CollationIterator = ucol_openElements(
     Collator, reinterpret_cast<const UChar *>(Str), Length, ErrorCode);
@@ -234,12 +658,8 @@ static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
     if (Elem == 0)
       continue;
     if (Elem != UCOL_NULLORDER) {
-      Elem *= HASH_M;
-      Elem ^= Elem >> HASH_R;
-      Elem *= HASH_M;
-
-      HashState *= HASH_M;
-      HashState ^= Elem;
+      HashState = hashElement(HashState, Elem, Table, AsciiHash,
+                              IsAsciiHashValid);
     } else {
       break;
     }
@@ -257,19 +677,66 @@ static intptr_t hashFinish(intptr_t HashState) {
 
 intptr_t
 swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  const ASCIICollation *Table = ASCIICollation::getTable();
   UErrorCode ErrorCode = U_ZERO_ERROR;
   intptr_t HashState = HASH_SEED;
-  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
+  ASCIIHasher AsciiHash;
+  bool IsAsciiHashValid = Table->hasFastPaths();
+
+  // Hash the leading code points that are in the Latin collation table from
+  // the table. The last of them is left to ICU if anything follows, since a
+  // combining mark or the rest of a contraction after it changes how it
+  // collates.
+  const LatinCollation *Latin = LatinCollation::getTable();
+  int32_t Pos = 0;
+  while (Pos < Length && Latin->isCached(Str[Pos]))
+    ++Pos;
+  int32_t FastLength = Pos == Length ? Length : std::max(Pos - 1, 0);
+  for (int32_t i = 0; i < FastLength; ++i) {
+    uint16_t c = Str[i];
+    for (unsigned Elem = 0, e = Latin->numElements(c); Elem != e; ++Elem)
+      HashState = hashElement(HashState, Latin->element(c, Elem), Table,
+                              AsciiHash, IsAsciiHashValid);
+  }
+
+  if (FastLength != Length)
+    HashState = hashChunk(GetRootCollator(), HashState, Str + FastLength,
+                          Length - FastLength, &ErrorCode, Table, AsciiHash,
+                          IsAsciiHashValid);
 
   if (U_FAILURE(ErrorCode)) {
     swift::crash("hashChunk: Unexpected error hashing unicode string.");
   }
+  if (IsAsciiHashValid)
+    return AsciiHash.finish();
   return hashFinish(HashState);
 }
 
 intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
                                                  int32_t Length) {
   const ASCIICollation *Table = ASCIICollation::getTable();
+  if (Table->hasFastPaths()) {
+    ASCIIHasher Hash;
+    int32_t Pos = 0;
+    const int32_t BytesPerWord = ASCIIHasher::BytesPerWord;
+    while (Pos < Length) {
+      // Hash whole words of printable characters directly.
+      if (Hash.isAtWordBoundary() && Pos + BytesPerWord <= Length) {
+        uintptr_t Word = loadASCIIWord(Str + Pos);
+        if (!mayHaveControlCharacters(Word)) {
+          Hash.addWord(Word);
+          Pos += BytesPerWord;
+          continue;
+        }
+      }
+      const char c = Str[Pos++];
+      assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
+      if (Table->map(c) != 0)
+        Hash.addByte(c);
+    }
+    return Hash.finish();
+  }
+
   intptr_t HashState = HASH_SEED;
   int32_t Pos = 0;
   while (Pos < Length) {
@@ -268,6 +268,12 @@ tests.test("_isPOD") {
   expectFalse(_isPOD(P.self))
 }
 
+tests.test("_isBitwiseTakable") {
+  expectTrue(_isBitwiseTakable(Int.self))
+  expectTrue(_isBitwiseTakable(X.self))
+  expectFalse(_isBitwiseTakable(P.self))
+}
+
 tests.test("_isOptional") {
   expectTrue(_isOptional(Optional<Int>.self))
   expectTrue(_isOptional(Optional<X>.self))
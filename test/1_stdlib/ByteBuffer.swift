@@ -0,0 +1,111 @@
+//===--- ByteBuffer.swift - Tests -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+import StdlibCollectionUnittest
+#if os(Linux) || os(FreeBSD) || os(Android)
+  import Glibc
+#else
+  import Darwin
+#endif
+
+var ByteBufferTests = TestSuite("ByteBuffer")
+
+ByteBufferTests.test("init") {
+  expectEqual(0, ByteBuffer().count)
+  expectEqual(0, ByteBuffer().capacity)
+  expectEqual([5, 5, 5], Array(ByteBuffer(repeating: 5, count: 3)))
+  expectEqual([1, 2, 3], Array(ByteBuffer([1, 2, 3] as [UInt8])))
+  expectEqual([1, 2, 3], Array(ByteBuffer(AnySequence([1, 2, 3] as [UInt8]))))
+}
+
+ByteBufferTests.test("RandomAccessCollection") {
+  let bytes: [UInt8] = [0, 1, 2, 3, 4, 5, 6, 7]
+  checkRandomAccessCollection(bytes, ByteBuffer(bytes))
+}
+
+ByteBufferTests.test("slice shares storage") {
+  let buffer = ByteBuffer([0, 1, 2, 3, 4, 5] as [UInt8])
+  let slice = buffer[2..<5]
+  expectEqual(2, slice.startIndex)
+  expectEqual(5, slice.endIndex)
+  expectEqual([2, 3, 4], Array(slice))
+  expectTrue(buffer._storage === slice._storage)
+  expectEqual([3, 4], Array(slice[3..<5]))
+}
+
+ByteBufferTests.test("copy-on-write") {
+  var buffer = ByteBuffer([0, 1, 2, 3] as [UInt8])
+  let copy = buffer
+  var slice = buffer[1..<3]
+  buffer[0] = 10
+  slice[1] = 11
+  expectEqual([10, 1, 2, 3], Array(buffer))
+  expectEqual([0, 1, 2, 3], Array(copy))
+  expectEqual([11, 2], Array(slice))
+  expectFalse(buffer._storage === copy._storage)
+  expectFalse(slice._storage === copy._storage)
+
+  // Mutating a uniquely referenced buffer doesn't copy.
+  let storage = buffer._storage
+  buffer[1] = 12
+  expectTrue(buffer._storage === storage)
+}
+
+ByteBufferTests.test("replaceSubrange") {
+  var buffer = ByteBuffer([0, 1, 2, 3, 4] as [UInt8])
+  buffer.replaceSubrange(1..<3, with: [9, 9, 9] as [UInt8])
+  expectEqual([0, 9, 9, 9, 3, 4], Array(buffer))
+  buffer.replaceSubrange(0..<4, with: [7] as [UInt8])
+  expectEqual([7, 3, 4], Array(buffer))
+  buffer[1..<2] = buffer[0..<3]
+  expectEqual([7, 7, 3, 4, 4], Array(buffer))
+  buffer.removeAll()
+  expectEqual(0, buffer.count)
+}
+
+ByteBufferTests.test("append") {
+  var buffer = ByteBuffer()
+  for i in 0..<100 {
+    buffer.append(UInt8(i))
+  }
+  buffer.append(contentsOf: [100, 101] as [UInt8])
+  buffer.append(contentsOf: buffer[0..<2])
+  expectEqual(Array(0..<102).map { UInt8($0) } + [0, 1], Array(buffer))
+}
+
+ByteBufferTests.test("==") {
+  let buffer = ByteBuffer([1, 2, 1, 2] as [UInt8])
+  expectTrue(buffer[0..<2] == buffer[2..<4])
+  expectTrue(buffer[0..<2] != buffer[1..<3])
+  expectTrue(ByteBuffer() == buffer[1..<1])
+}
+
+ByteBufferTests.test("read(from:maxCount:)/write(to:)") {
+  var fds: [CInt] = [0, 0]
+  expectEqual(0, pipe(&fds))
+  let message = ByteBuffer(Array("hello, world".utf8))
+  expectEqual(message.count, message[0..<5].write(to: fds[1]) +
+    message[5..<message.endIndex].write(to: fds[1]))
+  close(fds[1])
+
+  var received = ByteBuffer()
+  expectEqual(4, received.read(from: fds[0], maxCount: 4))
+  while received.read(from: fds[0], maxCount: 4) > 0 {}
+  expectEqual(0, received.read(from: fds[0], maxCount: 4))
+  close(fds[0])
+  expectTrue(received == message)
+}
+
+runAllTests()
@@ -46,4 +46,29 @@ CastsTests.test("No overrelease of existential boxes in failed casts") {
     bar(err)
 }
 
+CastsTests.test("Repeated casts of value types to existentials") {
+    struct Conforming : P {
+        var tracked = LifetimeTracked(0)
+    }
+    struct NonConforming {
+        var tracked = LifetimeTracked(1)
+    }
+    // Cast the same pairs of types several times, so that the later casts
+    // are resolved from the runtime's cast cache.
+    for _ in 0..<10 {
+        let c: Any = Conforming()
+        expectTrue(c is P)
+        if let p = c as? P {
+            expectTrue(p is Conforming)
+        } else {
+            expectUnreachable()
+        }
+        let n: Any = NonConforming()
+        expectFalse(n is P)
+        expectEmpty(n as? P)
+        let tuple: Any = (Conforming(), 1)
+        expectFalse(tuple is P)
+    }
+}
+
 runAllTests()
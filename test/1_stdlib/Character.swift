@@ -164,6 +164,32 @@ CharacterTests.test("Hashable") {
   }
 }
 
+CharacterTests.test("Comparable/consistent with String") {
+  // Canonically equivalent pairs, which have different code units.
+  let equivalentCharacters = [
+    // U+00E9 LATIN SMALL LETTER E WITH ACUTE
+    // U+0065 LATIN SMALL LETTER E, U+0301 COMBINING ACUTE ACCENT
+    "\u{00e9}", "\u{0065}\u{0301}",
+
+    // U+212B ANGSTROM SIGN
+    // U+00C5 LATIN CAPITAL LETTER A WITH RING ABOVE
+    "\u{212b}", "\u{00c5}",
+  ]
+  let characters = baseScalars + testCharacters + equivalentCharacters
+  for lhs in characters {
+    for rhs in characters {
+      let lc = Character(lhs)
+      let rc = Character(rhs)
+      let message = "lhs=\(lhs.debugDescription), rhs=\(rhs.debugDescription)"
+      expectEqual(lhs == rhs, lc == rc, message)
+      expectEqual(lhs < rhs, lc < rc, message)
+      if lhs == rhs {
+        expectEqual(lc.hashValue, rc.hashValue, message)
+      }
+    }
+  }
+}
+
 /// Test that a given `String` can be transformed into a `Character` and back
 /// without loss of information.
 func checkRoundTripThroughCharacter(_ s: String) {
@@ -143,5 +143,31 @@ ErrorProtocolTests.test("existential in lvalue") {
   expectEqual(0, LifetimeTracked.instances)
 }
 
+enum EmptyError : ErrorProtocol {
+  case failed
+}
+
+enum CodeError : ErrorProtocol {
+  case first, second, third
+}
+
+// Boxes of payload-less errors are shared, so they must keep their values.
+ErrorProtocolTests.test("shared boxes") {
+  var errors: [ErrorProtocol] = []
+  for _ in 0..<2 {
+    do { throw EmptyError.failed } catch { errors.append(error) }
+    do { throw CodeError.second } catch { errors.append(error) }
+    errors.append(CodeError.first)
+    errors.append(CodeError.third)
+  }
+  for i in 0..<2 {
+    expectTrue(errors[4 * i] is EmptyError)
+    expectEqual(CodeError.second, errors[4 * i + 1] as? CodeError)
+    expectEqual(CodeError.first, errors[4 * i + 2] as? CodeError)
+    expectEqual(CodeError.third, errors[4 * i + 3] as? CodeError)
+  }
+  expectEqual(0, errors[1]._code - errors[5]._code)
+}
+
 runAllTests()
 
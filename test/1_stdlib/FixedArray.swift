@@ -0,0 +1,79 @@
+//===--- FixedArray.swift - Tests -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+import StdlibCollectionUnittest
+
+var FixedArrayTests = TestSuite("FixedArray")
+
+FixedArrayTests.test("init(repeating:)") {
+  let a = FixedArray4<Int>(repeating: 7)
+  expectEqual(4, a.count)
+  expectEqual([7, 7, 7, 7], Array(a))
+}
+
+FixedArrayTests.test("init(_:)") {
+  expectEmpty(FixedArray4<Int>([1, 2, 3]))
+  expectEmpty(FixedArray4<Int>([1, 2, 3, 4, 5]))
+  let a = FixedArray4<Int>([1, 2, 3, 4])!
+  expectEqual([1, 2, 3, 4], Array(a))
+}
+
+FixedArrayTests.test("RandomAccessCollection") {
+  let elements = (0..<16).map { OpaqueValue($0) }
+  let a = FixedArray16(elements)!
+  checkRandomAccessCollection(elements, a) { $0.value == $1.value }
+}
+
+FixedArrayTests.test("subscript/set") {
+  var a = FixedArray8<LifetimeTracked>(repeating: LifetimeTracked(0))
+  for i in a.indices {
+    a[i] = LifetimeTracked(i * 10)
+  }
+  expectEqual((0..<8).map { $0 * 10 }, a.map { $0.value })
+
+  a[2..<4] = a[5..<7]
+  expectEqual([0, 10, 50, 60, 40, 50, 60, 70], a.map { $0.value })
+}
+
+FixedArrayTests.test("subscript/OutOfRange")
+  .skip(.custom(
+    { _isFastAssertConfiguration() },
+    reason: "this trap is not guaranteed to happen in -Ounchecked"))
+  .code {
+  var a = FixedArray4<Int>(repeating: 0)
+  expectCrashLater()
+  a[4] = 1
+}
+
+FixedArrayTests.test("withUnsafeMutableBufferPointer") {
+  var a = FixedArray16<UInt8>(repeating: 0)
+  a.withUnsafeMutableBufferPointer {
+    for i in $0.indices {
+      $0[i] = UInt8(i)
+    }
+  }
+  expectEqual((0..<16).map { UInt8($0) }, Array(a))
+  let sum = a.withUnsafeBufferPointer { $0.reduce(0, combine: { $0 + Int($1) }) }
+  expectEqual(120, sum)
+  expectEqual(16, sizeof(FixedArray16<UInt8>.self))
+}
+
+FixedArrayTests.test("Equatable") {
+  let a = FixedArray2([1, 2])!
+  expectTrue(a == FixedArray2([1, 2])!)
+  expectTrue(a != FixedArray2([2, 1])!)
+}
+
+runAllTests()
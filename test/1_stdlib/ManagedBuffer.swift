@@ -245,6 +245,33 @@ tests.test("ManagedBufferPointer") {
   }
 }
 
+tests.test("subscript(elementAt:)") {
+  do {
+    let s = TestManagedBuffer<LifetimeTracked>.create(12)
+    for i in 1..<6 {
+      s.append(LifetimeTracked(i))
+    }
+    for i in 1..<6 {
+      expectEqual(LifetimeTracked(i), s[elementAt: (i - 1) * 2])
+    }
+    s[elementAt: 4] = LifetimeTracked(30)
+    expectEqual(LifetimeTracked(30), s[elementAt: 4])
+
+    s.initializeElement(at: 10, to: LifetimeTracked(40))
+    expectEqual(
+      LifetimeTracked(40),
+      s.withUnsafeMutablePointerToElements { $0[10] })
+    s.count = 12
+
+    var mgr = ManagedBufferPointer<CountAndCapacity, LifetimeTracked>(
+      unsafeBufferObject: s)
+    expectEqual(LifetimeTracked(40), mgr[elementAt: 10])
+    mgr[elementAt: 10] = LifetimeTracked(50)
+    expectEqual(LifetimeTracked(50), s[elementAt: 10])
+  }
+  expectEqual(0, LifetimeTracked.instances)
+}
+
 tests.test("isUniquelyReferenced") {
   var s = TestManagedBuffer<LifetimeTracked>.create(0)
   expectTrue(isUniquelyReferenced(&s))
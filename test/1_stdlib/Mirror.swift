@@ -220,6 +220,31 @@ mirrors.test("Legacy") {
   }
 }
 
+mirrors.test("Legacy/FieldNames") {
+  struct S {
+    var a = 0
+    var bb = 1
+    var ccc = 2
+    var a_long_field_name_to_make_sure_lengths_are_kept = 3
+  }
+
+  enum E { case first, second(Int), third }
+
+  // Field names are split up the first time a type is reflected; reflecting
+  // it again must produce the same labels.
+  for _ in 0..<2 {
+    let m = Mirror(reflecting: S())
+    expectEqualSequence(
+      ["a", "bb", "ccc", "a_long_field_name_to_make_sure_lengths_are_kept"],
+      m.children.map { $0.label! })
+    expectEqualSequence([0, 1, 2, 3], m.children.map { $0.value as! Int })
+
+    expectEqual("first", "\(E.first)")
+    expectEqual("second", Mirror(reflecting: E.second(4)).children.first?.label)
+    expectEqual("third", "\(E.third)")
+  }
+}
+
 //===----------------------------------------------------------------------===//
 //===--- Class Support ----------------------------------------------------===//
 
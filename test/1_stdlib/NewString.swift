@@ -228,6 +228,14 @@ print("<\(zz.0), \(zz.1), \(zz.2), \(zz.3)>")
 s = "interpolated: \(asciiLiteral) \(nonASCIILiteral) \(42) \(3.14) \(true)"
 print("\(repr(s))")
 
+// CHECK-NEXT: {{.*}}"foobar🏂☃❅❆❄︎⛄️❄️foobar"
+s = "\(asciiLiteral)\(nonASCIILiteral)\(asciiLiteral)"
+print("\(repr(s))")
+
+// CHECK-NEXT: {{.*}}""
+s = "\("")\("")"
+print("\(repr(s))")
+
 // ===---------- Done --------===
 // CHECK-NEXT: Done.
 print("Done.")
@@ -0,0 +1,107 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+
+var NumericFormattingTests = TestSuite("NumericFormatting")
+
+func written(
+  _ write: (UnsafeMutableBufferPointer<UInt8>) -> Int?,
+  capacity: Int = 32
+) -> String? {
+  var bytes = [UInt8](repeating: 0, count: capacity)
+  let count = bytes.withUnsafeMutableBufferPointer(write)
+  return count.map {
+    String(bytes[0..<$0].map { Character(UnicodeScalar($0)) })
+  }
+}
+
+func shortest(_ value: Double) -> String? {
+  return shortest(value)
+}
+
+func shortest(_ value: Float) -> String? {
+  return shortest(value)
+}
+
+NumericFormattingTests.test("Integers/Buffer") {
+  expectOptionalEqual("0", written { (0 as Int).writeDecimal(into: $0) })
+  expectOptionalEqual(
+    "-1234", written { (-1234 as Int).writeDecimal(into: $0) })
+  expectOptionalEqual(
+    "-9223372036854775808", written { Int64.min.writeDecimal(into: $0) })
+  expectOptionalEqual(
+    "18446744073709551615", written { UInt64.max.writeDecimal(into: $0) })
+  expectOptionalEqual("255", written { UInt8.max.writeDecimal(into: $0) })
+  expectOptionalEqual("-128", written { Int8.min.writeDecimal(into: $0) })
+
+  // Too short a buffer writes nothing.
+  expectEmpty(written({ (12345 as Int).writeDecimal(into: $0) }, capacity: 4))
+  expectOptionalEqual(
+    "12345", written({ (12345 as Int).writeDecimal(into: $0) }, capacity: 5))
+}
+
+NumericFormattingTests.test("Integers/String") {
+  for value in [0, 1, -1, 42, Int.max, Int.min] {
+    var s = "x="
+    value.writeDecimal(to: &s)
+    expectEqual("x=" + value.description, s)
+  }
+
+  // Appending to a string with UTF-16 storage.
+  var s = "\u{3b1}="
+  (-7 as Int32).writeDecimal(to: &s)
+  expectEqual("\u{3b1}=-7", s)
+}
+
+NumericFormattingTests.test("Floats/Buffer") {
+  expectOptionalEqual("0.1", shortest(0.1 as Double))
+  expectOptionalEqual("0.30000000000000004", shortest(0.1 + 0.2 as Double))
+  expectOptionalEqual("100.0", shortest(100 as Double))
+  expectOptionalEqual("1e-05", shortest(1e-5 as Double))
+  expectOptionalEqual("1e+17", shortest(1e17 as Double))
+  expectOptionalEqual("-0.0", shortest(-0.0 as Double))
+  expectOptionalEqual("5e-324", shortest(5e-324 as Double))
+  expectOptionalEqual(
+    "1.7976931348623157e+308", shortest(Double.greatestFiniteMagnitude))
+  expectOptionalEqual("inf", shortest(Double.infinity))
+  expectOptionalEqual("-inf", shortest(-Double.infinity))
+  expectOptionalEqual("nan", shortest(Double.nan))
+
+  expectOptionalEqual("1.1", shortest(1.1 as Float))
+  expectOptionalEqual("3.4028235e+38", shortest(Float.greatestFiniteMagnitude))
+  expectOptionalEqual("1e-45", shortest(1e-45 as Float))
+
+  expectEmpty(written({ (0.25 as Double).writeShortestDecimal(into: $0) }, capacity: 3))
+}
+
+NumericFormattingTests.test("Floats/RoundTrip") {
+  var state: UInt64 = 0x9e3779b97f4a7c15
+  for _ in 0..<10000 {
+    state = state &* 6364136223846793005 &+ 1442695040888963407
+    let value = Double(bitPattern: state)
+    if !value.isFinite { continue }
+    var s = ""
+    value.writeShortestDecimal(to: &s)
+    expectOptionalEqual(value, Double(s), s)
+  }
+}
+
+NumericFormattingTests.test("Floats/DescriptionUnchanged") {
+  // `description` takes a shortcut through the shortest digits when they fit
+  // in `digits10`; it must still match the `%.*g` notation.
+  expectEqual("0.1", (0.1 as Double).description)
+  expectEqual("0.3", (0.1 + 0.2 as Double).description)
+  expectEqual("100.0", (100 as Double).description)
+  expectEqual("1e+16", (1e16 as Double).description)
+  expectEqual("123456789012345.0", (123456789012345 as Double).description)
+  expectEqual("1e-05", (1e-5 as Double).description)
+  expectEqual("0.0001", (1e-4 as Double).description)
+  expectEqual("-2.5", (-2.5 as Double).description)
+  expectEqual("1.1", (1.1 as Float).description)
+  expectEqual("1e+06", (1e6 as Float).description)
+  expectEqual("100000.0", (1e5 as Float).description)
+}
+
+runAllTests()
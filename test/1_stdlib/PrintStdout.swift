@@ -0,0 +1,25 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+// Non-ASCII strings are written to stdout a chunk at a time. Check strings
+// that end exactly at, and just past, a chunk boundary, and multi-byte
+// characters that straddle one.
+
+// CHECK: µ
+print("\u{00B5}")
+
+// CHECK-NEXT: {{^}}αααααααααααααααααααααααααααααααααααα{{$}}
+print(String(repeating: "α", count: 36))
+
+// CHECK-NEXT: {{^}}ααααααααααααααααααααααααααααααααααααa{{$}}
+print(String(repeating: "α", count: 36) + "a")
+
+// CHECK-NEXT: {{^}}aαααααααααααααααααααααααααααααααααααα{{$}}
+print("a" + String(repeating: "α", count: 36))
+
+// CHECK-NEXT: {{^}}ab あ 𝄞 -> x{{$}}
+print("a" + "b", "あ", "𝄞", separator: " ", terminator: " -> ")
+print("x")
+
+// CHECK-NEXT: done
+print("done")
@@ -346,6 +346,12 @@ Runtime.test("typeByName") {
   // FIXME: NonObjectiveCBase is slated to die, but I can't think of another
   // nongeneric public class in the stdlib...
   expectTrue(_typeByName("Swift.NonObjectiveCBase") == NonObjectiveCBase.self)
+
+  // Misses don't add anything to the name index, and later lookups of the
+  // same names still succeed.
+  expectTrue(_typeByName("a.NoSuchClass") == nil)
+  expectTrue(_typeByName("a.SomeClass") == SomeClass.self)
+  expectTrue(_typeByName("a.SomeConformingClass") == SomeConformingClass.self)
 }
 
 Runtime.test("demangleName") {
@@ -20,5 +20,80 @@ StringOrderRelationTestSuite.test("StringOrderRelation/ASCII/NullByte")
   expectTrue(baseString != nullbyteString)
 }
 
+/// Returns a string with the same contents as `s`, but stored as UTF-16.
+func utf16Backed(_ s: String) -> String {
+  let result = String(("\u{3b1}" + s).characters.dropFirst())
+  expectFalse(result._core.isASCII)
+  return result
+}
+
+let asciiStrings = [
+  "a", "A", "b", "ab", "aB", "Ab", "abc", "a b", "a-b", "a_b", "a\tb",
+  "content-length", "Content-Length", "content-type", "Content-Type",
+  "x-forwarded-for", "X-Forwarded-For", "0", "10", "9", "~", "a\u{7f}",
+  "a\u{01}b",
+]
+
+StringOrderRelationTestSuite.test("StringOrderRelation/ASCII/MatchesUnicode")
+  .skip(.objCRuntime("ASCII strings are compared by code unit with ObjC"))
+  .code {
+  for lhs in asciiStrings {
+    expectTrue(lhs._core.isASCII)
+    let lhs16 = utf16Backed(lhs)
+    for rhs in asciiStrings {
+      expectEqual(lhs16 < rhs, lhs < rhs,
+        "\(lhs.debugDescription) < \(rhs.debugDescription)")
+      expectEqual(rhs < lhs16, rhs < lhs,
+        "\(rhs.debugDescription) < \(lhs.debugDescription)")
+    }
+  }
+}
+
+StringOrderRelationTestSuite.test("StringOrderRelation/ASCII/Hash") {
+  for s in asciiStrings {
+    expectEqual(s.hashValue, utf16Backed(s).hashValue, s.debugDescription)
+  }
+  // Strings that only differ in ignorable characters are equal, and hash the
+  // same.
+  let zeroWidthSpace = utf16Backed("ab\u{200b}")
+  if zeroWidthSpace == "ab" {
+    expectEqual("ab".hashValue, zeroWidthSpace.hashValue)
+  }
+}
+
+let latinStrings = [
+  "caf\u{e9}", "cafe\u{301}", "cafe", "Caf\u{c9}", "caf\u{e9}s", "stra\u{df}e",
+  "strasse", "l\u{b7}l", "L\u{b7}", "\u{13f}", "\u{132}", "na\u{ef}ve",
+  "nai\u{308}ve", "\u{e9}\u{316}", "e\u{316}\u{301}",
+]
+
+StringOrderRelationTestSuite.test("StringOrderRelation/Latin/MatchesUnicode") {
+  // Canonically equivalent strings are equal however they are stored, and
+  // hash the same.
+  for lhs in latinStrings {
+    for rhs in latinStrings {
+      let lhs16 = utf16Backed(lhs)
+      let rhs16 = utf16Backed(rhs)
+      expectEqual(lhs < rhs, lhs16 < rhs16,
+        "\(lhs.debugDescription) < \(rhs.debugDescription)")
+      expectEqual(lhs == rhs, lhs16 == rhs16,
+        "\(lhs.debugDescription) == \(rhs.debugDescription)")
+      if lhs16 == rhs16 {
+        expectEqual(lhs16.hashValue, rhs16.hashValue,
+          "\(lhs.debugDescription) == \(rhs.debugDescription)")
+      }
+    }
+  }
+  expectEqual("caf\u{e9}", "cafe\u{301}")
+  expectEqual("\u{e9}\u{316}", "e\u{316}\u{301}")
+  expectTrue("caf\u{e9}" < "cafes")
+  for ascii in asciiStrings {
+    for latin in latinStrings {
+      expectEqual(ascii < latin, utf16Backed(ascii) < latin,
+        "\(ascii.debugDescription) < \(latin.debugDescription)")
+    }
+  }
+}
+
 runAllTests()
 
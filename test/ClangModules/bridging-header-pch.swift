@@ -0,0 +1,19 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-pch -o %t/sdk-bridging-header.pch %S/Inputs/sdk-bridging-header.h
+// RUN: %target-swift-frontend -parse -verify %s -import-objc-header %S/Inputs/sdk-bridging-header.h -import-objc-header-pch %t/sdk-bridging-header.pch
+
+// A PCH which is still valid is left alone.
+// RUN: cp %t/sdk-bridging-header.pch %t/original.pch
+// RUN: %target-swift-frontend -emit-pch -o %t/sdk-bridging-header.pch %S/Inputs/sdk-bridging-header.h
+// RUN: cmp %t/sdk-bridging-header.pch %t/original.pch
+
+// REQUIRES: objc_interop
+
+import Foundation
+
+let `true` = Predicate.`true`()
+let not = Predicate.not()
+let and = Predicate.and([])
+let or = Predicate.or([not, and])
+
+_ = Predicate.foobar() // expected-error{{type 'Predicate' has no member 'foobar'}}
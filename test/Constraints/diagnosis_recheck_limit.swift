@@ -0,0 +1,12 @@
+// RUN: not %target-swift-frontend -parse %s -diagnosis-recheck-limit 0 2>&1 | FileCheck %s
+// RUN: not %target-swift-frontend -parse %s -diagnosis-recheck-limit 1 2>&1 | FileCheck %s
+
+// Running out of the budget for re-type-checking subexpressions must still
+// produce an error for the failing expression.
+
+func takesInt(_ x: Int) {}
+
+func test(_ s: String) {
+  // CHECK: diagnosis_recheck_limit.swift:[[@LINE+1]]:{{[0-9]+}}: error:
+  takesInt(s.characters.count + s)
+}
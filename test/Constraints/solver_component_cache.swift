@@ -0,0 +1,27 @@
+// RUN: %target-parse-verify-swift -enable-solver-component-cache
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -primary-file %s -enable-solver-component-cache -stats-output-dir %t/stats
+// RUN: cat %t/stats/*.json | FileCheck %s
+// CHECK: "Sema.NumComponentsReused": {{[0-9]+}}
+
+// Reusing a component's solutions must produce the same types as solving it
+// again.
+func acceptDouble(_ : inout Double) {}
+func acceptInt(_ : inout Int) {}
+
+let a = 1.5, b = 2.5, c = 3.5
+var d: Double = a * 2 + b * 3 - c / 4
+acceptDouble(&d)
+
+var i = 1 + 2 * 3 - 4 / 5
+acceptInt(&i)
+
+let pair = (1 + 2, 3.5 * 2)
+let _: (Int, Double) = pair
+
+let mixed = [1 + 2, 3 * 4] + [5 - 6]
+let _: [Int] = mixed
+
+// Errors are still diagnosed.
+let _: String = d // expected-error {{cannot convert value of type 'Double' to specified type 'String'}}
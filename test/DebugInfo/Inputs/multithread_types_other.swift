@@ -0,0 +1,9 @@
+public struct Point {
+  public var x: Int
+  public var y: Int
+}
+
+public func makePoint() -> Point {
+  let p = Point(x: 1, y: 2)
+  return p
+}
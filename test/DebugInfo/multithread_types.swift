@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend %s %S/Inputs/multithread_types_other.swift -emit-ir -g -num-threads 2 -module-name test -o %t/main.ll -o %t/other.ll
+// RUN: FileCheck --check-prefix=CHECK-MAIN %s < %t/main.ll
+// RUN: FileCheck --check-prefix=CHECK-OTHER %s < %t/other.ll
+
+// The definition of the debug type of Point is only emitted in the compile
+// unit of the file which declares it. The other compile unit refers to it.
+
+// CHECK-MAIN: !DICompositeType(tag: DW_TAG_structure_type, name: "Point",{{.*}} flags: DIFlagFwdDecl{{.*}} identifier: "_TtV4test5Point")
+// CHECK-MAIN-NOT: !DICompositeType(tag: DW_TAG_structure_type, name: "Point",{{.*}} elements:
+
+// CHECK-OTHER: !DICompileUnit({{.*}}retainedTypes: !{{[0-9]+}}
+// CHECK-OTHER: !DICompositeType(tag: DW_TAG_structure_type, name: "Point",{{.*}} elements: {{.*}} identifier: "_TtV4test5Point")
+
+public func sum(_ p: Point) -> Int {
+  let q = p
+  return q.x + q.y
+}
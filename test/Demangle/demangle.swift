@@ -9,6 +9,10 @@ RUN: sed -ne '/--->/s/^.*---> *//p' < %S/Inputs/manglings.txt > %t.check
 RUN: swift-demangle < %t.input > %t.output
 RUN: diff %t.check %t.output
 
+Demangling with several threads must not change the output.
+RUN: swift-demangle -j 4 < %t.input > %t.output-j4
+RUN: diff %t.check %t.output-j4
+
 ; RUN: swift-demangle __TtSi | FileCheck %s -check-prefix=DOUBLE
 ; DOUBLE: _TtSi ---> Swift.Int
 
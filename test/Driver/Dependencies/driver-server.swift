@@ -0,0 +1,38 @@
+/// other ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: printf 'build\nswiftc\n-c\n-driver-use-frontend-path\n%S/Inputs/update-dependencies.py\n-output-file-map\n%t/output.json\n-incremental\n-driver-always-rebuild-dependents\n./main.swift\n./other.swift\n-module-name\nmain\n-j1\n-v\n\n' > %t/build.txt
+
+// Several builds in the same server only rebuild what changed.
+// RUN: cat %t/build.txt %t/build.txt > %t/requests.txt
+// RUN: cd %t && %swift_driver_plain -driver-server < %t/requests.txt 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+// CHECK-FIRST: exit: 0
+// CHECK-FIRST-NOT: Handled
+// CHECK-FIRST: exit: 0
+
+// RUN: touch -t 201401240006 %t/other.swift
+// RUN: echo 'changed ./other.swift' > %t/requests.txt
+// RUN: cat %t/build.txt >> %t/requests.txt
+// RUN: cat %t/build.txt >> %t/requests.txt
+// RUN: cd %t && %swift_driver_plain -driver-server -trust-notifications < %t/requests.txt 2>&1 | FileCheck -check-prefix=CHECK-SECOND %s
+
+// CHECK-SECOND: Handled other.swift
+// CHECK-SECOND: Handled main.swift
+// CHECK-SECOND: exit: 0
+// CHECK-SECOND-NOT: Handled
+// CHECK-SECOND: exit: 0
+
+// RUN: echo 'invalidate' > %t/requests.txt
+// RUN: echo 'build' >> %t/requests.txt
+// RUN: echo 'swift' >> %t/requests.txt
+// RUN: echo '' >> %t/requests.txt
+// RUN: cd %t && %swift_driver_plain -driver-server < %t/requests.txt 2>&1 | FileCheck -check-prefix=CHECK-INTERACTIVE %s
+
+// CHECK-INTERACTIVE: error: only 'swiftc' builds can be run by the driver server
+// CHECK-INTERACTIVE: exit: 1
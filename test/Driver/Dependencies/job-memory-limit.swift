@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/chained/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift ./yet-another.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: FileCheck -check-prefix=CHECK-MEMORY %s < %t/main~buildrecord.swiftdeps.memory
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+// CHECK-FIRST: Handled yet-another.swift
+
+// CHECK-MEMORY: "compile": {{[0-9]+$}}
+
+// When each job is expected to use more memory than the limit, the jobs run
+// one at a time however many are allowed to run in parallel.
+
+// RUN: rm %t/main~buildrecord.swiftdeps
+// RUN: echo '"compile": 1073741824' > %t/main~buildrecord.swiftdeps.memory
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift ./yet-another.swift -module-name main -j3 -job-memory-limit 1 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-LIMITED %s
+
+// CHECK-LIMITED: "kind": "began"
+// CHECK-LIMITED-NOT: "kind": "began"
+// CHECK-LIMITED: "kind": "finished"
+// CHECK-LIMITED-NOT: "kind": "finished"
+// CHECK-LIMITED: "kind": "began"
+// CHECK-LIMITED-NOT: "kind": "began"
+// CHECK-LIMITED: "kind": "finished"
+// CHECK-LIMITED-NOT: "kind": "finished"
+// CHECK-LIMITED: "kind": "began"
+// CHECK-LIMITED: "kind": "finished"
+
+// RUN: not %swiftc_driver -c ./main.swift -job-memory-limit lots 2>&1 | FileCheck -check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: error: invalid value 'lots' in '-job-memory-limit lots'
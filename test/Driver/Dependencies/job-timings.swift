@@ -0,0 +1,30 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/chained/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift ./yet-another.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: FileCheck -check-prefix=CHECK-TIMINGS %s < %t/main~buildrecord.swiftdeps.timings
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+// CHECK-FIRST: Handled yet-another.swift
+
+// CHECK-TIMINGS: "./main.swift": {{[0-9]+$}}
+// CHECK-TIMINGS-NEXT: "./other.swift": {{[0-9]+$}}
+// CHECK-TIMINGS-NEXT: "./yet-another.swift": {{[0-9]+$}}
+
+// With more jobs than can run at once, the slowest job from the previous
+// build starts first.
+
+// RUN: rm %t/main~buildrecord.swiftdeps
+// RUN: echo '"./main.swift": 1' > %t/main~buildrecord.swiftdeps.timings
+// RUN: echo '"./other.swift": 1' >> %t/main~buildrecord.swiftdeps.timings
+// RUN: echo '"./yet-another.swift": 5000' >> %t/main~buildrecord.swiftdeps.timings
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift ./yet-another.swift -module-name main -j2 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-SECOND %s
+
+// CHECK-SECOND: "kind": "began"
+// CHECK-SECOND: ".\/yet-another.swift"
+// CHECK-SECOND: "kind": "began"
+// CHECK-SECOND: ".\/main.swift"
+// CHECK-SECOND: "kind": "began"
+// CHECK-SECOND: ".\/other.swift"
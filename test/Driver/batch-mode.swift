@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: touch %t/file-01.swift %t/file-02.swift %t/file-03.swift %t/file-04.swift
+// RUN: cd %t && %swiftc_driver -enable-batch-mode -driver-skip-execution -v -c ./file-01.swift ./file-02.swift ./file-03.swift ./file-04.swift -module-name main -j2 2>&1 | FileCheck %s
+
+// CHECK: -frontend -c -primary-file ./file-01.swift -primary-file ./file-02.swift ./file-03.swift ./file-04.swift {{.*}}-module-name main -o {{[^ ]*}}file-01.o -o {{[^ ]*}}file-02.o
+// CHECK: -frontend -c ./file-01.swift ./file-02.swift -primary-file ./file-03.swift -primary-file ./file-04.swift {{.*}}-module-name main -o {{[^ ]*}}file-03.o -o {{[^ ]*}}file-04.o
+
+// RUN: cd %t && %swiftc_driver -enable-batch-mode -disable-batch-mode -driver-skip-execution -v -c ./file-01.swift ./file-02.swift ./file-03.swift ./file-04.swift -module-name main -j2 2>&1 | FileCheck -check-prefix=DISABLED %s
+// RUN: cd %t && %swiftc_driver -enable-batch-mode -driver-skip-execution -v -c ./file-01.swift ./file-02.swift ./file-03.swift ./file-04.swift -module-name main -j2 -serialize-diagnostics 2>&1 | FileCheck -check-prefix=DISABLED %s
+// RUN: cd %t && %swiftc_driver -enable-batch-mode -driver-skip-execution -v -c ./file-01.swift ./file-02.swift ./file-03.swift ./file-04.swift -module-name main -j2 -wmo -num-threads 2 2>&1 | FileCheck -check-prefix=WMO %s
+
+// DISABLED: -frontend -c -primary-file ./file-01.swift ./file-02.swift ./file-03.swift ./file-04.swift
+// DISABLED: -frontend -c ./file-01.swift -primary-file ./file-02.swift ./file-03.swift ./file-04.swift
+// DISABLED: -frontend -c ./file-01.swift ./file-02.swift -primary-file ./file-03.swift ./file-04.swift
+// DISABLED: -frontend -c ./file-01.swift ./file-02.swift ./file-03.swift -primary-file ./file-04.swift
+
+// WMO-NOT: -primary-file
+
+// Per-file supplementary outputs are passed once per primary file, in order.
+// RUN: echo '{"./file-01.swift": {"object": "1.o", "swiftmodule": "1.swiftmodule", "swift-dependencies": "1.swiftdeps"}, "./file-02.swift": {"object": "2.o", "swiftmodule": "2.swiftmodule", "swift-dependencies": "2.swiftdeps"}, "": {"swift-dependencies": "main~buildrecord.swiftdeps"}}' > %t/output.json
+// RUN: cd %t && %swiftc_driver -enable-batch-mode -driver-skip-execution -v -c ./file-01.swift ./file-02.swift -module-name main -emit-module -output-file-map %t/output.json -incremental -j1 2>&1 | FileCheck -check-prefix=OUTPUTS %s
+
+// OUTPUTS: -frontend -c -primary-file ./file-01.swift -primary-file ./file-02.swift {{.*}}-emit-module-path 1.swiftmodule -emit-module-path 2.swiftmodule {{.*}}-emit-reference-dependencies-path 1.swiftdeps -emit-reference-dependencies-path 2.swiftdeps -o 1.o -o 2.o
@@ -0,0 +1,20 @@
+// RUN: %swiftc_driver -driver-print-jobs -c -enable-bridging-pch -import-objc-header %S/Inputs/bridging-header.h %s %S/../Inputs/empty.swift -module-name main 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c -enable-bridging-pch -pch-output-dir %t/pch -import-objc-header %S/Inputs/bridging-header.h %s -module-name main 2>&1 | FileCheck -check-prefix PERSISTENT %s
+// RUN: %swiftc_driver -driver-print-jobs -c -import-objc-header %S/Inputs/bridging-header.h %s -module-name main 2>&1 | FileCheck -check-prefix NO-PCH %s
+// RUN: %swiftc_driver -driver-print-jobs -c -enable-bridging-pch %s -module-name main 2>&1 | FileCheck -check-prefix NO-PCH %s
+
+// The header is precompiled once, and every compile job loads the PCH.
+// CHECK: bin/swift{{c?}} -frontend {{.*}}bridging-header.h -emit-pch -o [[PCH:[^ ]+]].pch
+// CHECK-NEXT: bin/swift{{c?}} -frontend -c
+// CHECK-SAME: -primary-file {{.*}}bridging-pch.swift
+// CHECK-SAME: -import-objc-header-pch [[PCH]].pch
+// CHECK-NEXT: bin/swift{{c?}} -frontend -c
+// CHECK-SAME: -primary-file {{.*}}empty.swift
+// CHECK-SAME: -import-objc-header-pch [[PCH]].pch
+// CHECK-NOT: -emit-pch
+
+// PERSISTENT: bin/swift{{c?}} -frontend {{.*}} -emit-pch -o {{.*}}/pch/bridging-header-{{[0-9a-f]+}}.pch
+// PERSISTENT-NEXT: bin/swift{{c?}} -frontend -c {{.*}} -import-objc-header-pch {{.*}}/pch/bridging-header-{{[0-9a-f]+}}.pch
+
+// NO-PCH-NOT: -emit-pch
+// NO-PCH-NOT: -import-objc-header-pch
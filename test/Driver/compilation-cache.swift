@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir -p %t/fail
+// RUN: cp -r %S/Dependencies/Inputs/one-way/ %t/a
+// RUN: cp -r %S/Dependencies/Inputs/one-way/ %t/b
+// RUN: printf '#!/bin/sh\nexit 1\n' > %t/fail/update-dependencies.py
+// RUN: chmod +x %t/fail/update-dependencies.py
+
+// RUN: cd %t/a && %swiftc_driver -c -driver-use-frontend-path %S/Dependencies/Inputs/update-dependencies.py -compilation-cache-path %t/cache -output-file-map %t/a/output.json -incremental ./main.swift ./other.swift -module-name main -j1 2>&1 | FileCheck %s
+
+// CHECK-DAG: Handled main.swift
+// CHECK-DAG: Handled other.swift
+
+// The same jobs in another directory are restored from the cache without
+// running the frontend, and print what it printed.
+// RUN: cd %t/b && %swiftc_driver -c -driver-use-frontend-path %t/fail/update-dependencies.py -compilation-cache-path %t/cache -output-file-map %t/b/output.json -incremental ./main.swift ./other.swift -module-name main -j1 2>&1 | FileCheck %s
+// RUN: diff %t/a/main.swiftdeps %t/b/main.swiftdeps
+// RUN: diff %t/a/other.swiftdeps %t/b/other.swiftdeps
+// RUN: ls %t/b/main.o %t/b/other.o
+
+// Once a source changes, its job runs again.
+// RUN: cp -r %S/Dependencies/Inputs/one-way/ %t/c
+// RUN: echo "# change" >> %t/c/other.swift
+// RUN: cd %t/c && not %swiftc_driver -c -driver-use-frontend-path %t/fail/update-dependencies.py -compilation-cache-path %t/cache -output-file-map %t/c/output.json -incremental ./main.swift ./other.swift -module-name main -j1 2>&1 | FileCheck -check-prefix=CHECK-CHANGED %s
+
+// CHECK-CHANGED: Handled main.swift
+// CHECK-CHANGED-NOT: Handled other.swift
@@ -0,0 +1,30 @@
+// RUN: %swiftc_driver -driver-print-jobs -c -emit-module -emit-module-separately %s %S/../Inputs/empty.swift -module-name main 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c -emit-module -emit-module-separately -driver-use-filelists %s %S/../Inputs/empty.swift -module-name main 2>&1 | FileCheck -check-prefix FILELISTS %s
+// RUN: %swiftc_driver -driver-print-jobs -emit-module -emit-module-separately %s %S/../Inputs/empty.swift -module-name main 2>&1 | FileCheck -check-prefix MODULE-ONLY %s
+
+// The module is emitted from the sources, so its job comes first and doesn't
+// depend on the compile jobs, which no longer emit partial modules.
+// CHECK: bin/swift{{c?}} -frontend -emit-module {{.*}}emit-module-separately.swift {{.*}}empty.swift -suppress-warnings
+// CHECK-NOT: -primary-file
+// CHECK-NOT: -parse-as-library
+// CHECK: -module-name main
+// CHECK-SAME: -o main.swiftmodule
+// CHECK-NEXT: bin/swift{{c?}} -frontend -c
+// CHECK-NOT: -emit-module-path
+// CHECK: -primary-file {{.*}}emit-module-separately.swift
+// CHECK-NOT: -emit-module-path
+// CHECK: -o {{[^ ]*}}emit-module-separately.o
+// CHECK-NEXT: bin/swift{{c?}} -frontend -c
+// CHECK-NOT: -emit-module-path
+// CHECK: -primary-file {{.*}}empty.swift
+// CHECK-NOT: -emit-module-path
+// CHECK-NOT: bin/swift{{c?}} -frontend -emit-module
+
+// FILELISTS: bin/swift{{c?}} -frontend -emit-module -filelist {{[^ ]+}}sources{{[^ ]*}} -suppress-warnings
+// FILELISTS: -o main.swiftmodule
+
+// Without any other output the compile jobs emit the partial modules as
+// before.
+// MODULE-ONLY: bin/swift{{c?}} -frontend -emit-module -primary-file
+// MODULE-ONLY: bin/swift{{c?}} -frontend -emit-module -primary-file
+// MODULE-ONLY: bin/swift{{c?}} -frontend -emit-module {{[^ ]+}}.swiftmodule {{[^ ]+}}.swiftmodule -parse-as-library
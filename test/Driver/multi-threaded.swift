@@ -5,6 +5,7 @@
 // RUN: echo "{\"%s\": {\"assembly\": \"/build/multi-threaded.s\"}, \"%S/Inputs/main.swift\": {\"assembly\": \"/build/main.s\"}}" > %t/ofms.json
 // RUN: %target-swiftc_driver -driver-print-jobs -module-name=ThisModule -wmo -num-threads 4 %S/Inputs/main.swift %s -output-file-map %t/ofms.json -S | FileCheck -check-prefix=ASSEMBLY %s
 // RUN: %target-swiftc_driver -driver-print-jobs -module-name=ThisModule -wmo -num-threads 4 %S/Inputs/main.swift %s -c | FileCheck -check-prefix=OBJECT %s
+// RUN: %target-swiftc_driver -driver-print-jobs -module-name=ThisModule -wmo -num-threads 4 %S/Inputs/main.swift %s -c -o %t/ThisModule.o | FileCheck -check-prefix=SINGLE-OBJECT %s
 // RUN: %target-swiftc_driver -parseable-output -module-name=ThisModule -wmo -num-threads 4 %S/Inputs/main.swift %s -c 2> %t/parseable-output
 // RUN: cat %t/parseable-output | FileCheck -check-prefix=PARSEABLE %s
 // RUN: env TMPDIR=/tmp %swiftc_driver -driver-print-jobs -module-name=ThisModule -wmo -num-threads 4 %S/Inputs/main.swift %s -o a.out | FileCheck -check-prefix=EXEC %s
@@ -41,6 +42,13 @@
 // OBJECT-DAG: -o main.o -o multi-threaded.o 
 // OBJECT-NOT: ld
 
+// SINGLE-OBJECT: -frontend
+// SINGLE-OBJECT-DAG: -num-threads 4
+// SINGLE-OBJECT-DAG: {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/multi-threaded.swift 
+// SINGLE-OBJECT-DAG: -o {{[^ ]*}}/ThisModule.o
+// SINGLE-OBJECT-NOT: -o main.o
+// SINGLE-OBJECT-NOT: ld
+
 // BITCODE: -frontend
 // BITCODE-DAG: -num-threads 4
 // BITCODE-DAG: {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/multi-threaded.swift 
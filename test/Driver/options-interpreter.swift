@@ -9,6 +9,11 @@
 // RUN: %swift_driver -### %s a b c | FileCheck -check-prefix ARGS %s
 // ARGS: -- a b c
 
+// RUN: %swift_driver -### -script-cache-path /tmp/cache %s a | FileCheck -check-prefix SCRIPT_CACHE %s
+// SCRIPT_CACHE: -interpret
+// SCRIPT_CACHE-SAME: -script-cache-path /tmp/cache
+// SCRIPT_CACHE-SAME: -- a
+
 // RUN: %swift_driver -### -parse-stdlib %s | FileCheck -check-prefix PARSE_STDLIB %s
 // RUN: %swift_driver -### -parse-stdlib | FileCheck -check-prefix PARSE_STDLIB %s
 // PARSE_STDLIB: -parse-stdlib
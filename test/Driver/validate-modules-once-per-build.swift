@@ -0,0 +1,10 @@
+// RUN: %swiftc_driver -driver-print-jobs -c -validate-modules-once-per-build -I %S/Inputs %s %S/../Inputs/empty.swift -module-name main 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -c -I %S/Inputs %s -module-name main 2>&1 | FileCheck -check-prefix NO-LISTING %s
+
+// Every compile job shares the same listing.
+// CHECK: bin/swift{{c?}} -frontend -c
+// CHECK-SAME: -search-path-listing [[LISTING:[^ ]+search-paths[^ ]*]]
+// CHECK-NEXT: bin/swift{{c?}} -frontend -c
+// CHECK-SAME: -search-path-listing [[LISTING]]
+
+// NO-LISTING-NOT: -search-path-listing
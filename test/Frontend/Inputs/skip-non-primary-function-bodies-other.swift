@@ -0,0 +1,9 @@
+func ordinary() -> Int {
+  let = 1
+  return 0
+}
+
+@_transparent func transparent() -> Int {
+  var = 2
+  return 0
+}
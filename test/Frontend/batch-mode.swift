@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -emit-bc -primary-file %s -primary-file %S/Inputs/filelist-other.swift -o %t/batch-mode.bc -o %t/filelist-other.bc -emit-reference-dependencies-path %t/batch-mode.swiftdeps -emit-reference-dependencies-path %t/filelist-other.swiftdeps -module-name main
+// RUN: ls %t/batch-mode.bc %t/filelist-other.bc
+// RUN: FileCheck -check-prefix=CHECK-DEPS %s < %t/batch-mode.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-OTHER-DEPS %s < %t/filelist-other.swiftdeps
+
+// CHECK-DEPS: - "batchModeTest"
+// CHECK-DEPS-NOT: - "Foo"
+// CHECK-OTHER-DEPS: - "Foo"
+// CHECK-OTHER-DEPS-NOT: - "batchModeTest"
+
+// The primary files in a file list are matched up with the outputs in the
+// order of the -primary-file options, not the order of the list.
+// RUN: echo '%S/Inputs/filelist-other.swift' > %t/input.txt
+// RUN: echo '%s' >> %t/input.txt
+// RUN: rm %t/*.bc
+// RUN: %target-swift-frontend -emit-bc -filelist %t/input.txt -primary-file %s -primary-file %S/Inputs/filelist-other.swift -o %t/batch-mode.bc -o %t/filelist-other.bc -module-name main
+// RUN: ls %t/batch-mode.bc %t/filelist-other.bc
+
+// RUN: not %target-swift-frontend -emit-bc -primary-file %s -primary-file %S/Inputs/filelist-other.swift -o %t/batch-mode.bc -module-name main 2>&1 | FileCheck -check-prefix=CHECK-COUNT %s
+// CHECK-COUNT: error: option '-o' must be given once per primary file (2 times, not 1)
+
+// RUN: not %target-swift-frontend -emit-bc -primary-file %s -primary-file %S/Inputs/filelist-other.swift -o %t/batch-mode.bc -o %t/filelist-other.bc -serialize-diagnostics-path %t/batch-mode.dia -module-name main 2>&1 | FileCheck -check-prefix=CHECK-UNSUPPORTED %s
+// CHECK-UNSUPPORTED: error: option '-serialize-diagnostics-path' is not supported with more than one primary file
+
+// RUN: not %target-swift-frontend -parse -primary-file %s -primary-file %S/Inputs/filelist-other.swift -module-name main 2>&1 | FileCheck -check-prefix=CHECK-MODE %s
+// CHECK-MODE: error: this mode does not support more than one primary file
+
+func batchModeTest() {}
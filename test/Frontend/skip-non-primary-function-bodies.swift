@@ -0,0 +1,16 @@
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-function-bodies-other.swift 2>&1 | FileCheck %s
+// RUN: not %target-swift-frontend -parse %s %S/Inputs/skip-non-primary-function-bodies-other.swift 2>&1 | FileCheck -check-prefix=WHOLE-MODULE %s
+
+// Bodies of functions in non-primary files are skipped, except for
+// transparent ones, which are still parsed.
+
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:2:
+// CHECK: skip-non-primary-function-bodies-other.swift:7:{{[0-9]+}}: error: expected pattern
+// CHECK-NOT: skip-non-primary-function-bodies-other.swift:2:
+
+// WHOLE-MODULE: skip-non-primary-function-bodies-other.swift:2:{{[0-9]+}}: error: expected pattern
+// WHOLE-MODULE: skip-non-primary-function-bodies-other.swift:7:{{[0-9]+}}: error: expected pattern
+
+func use() -> Int {
+  return ordinary() + transparent()
+}
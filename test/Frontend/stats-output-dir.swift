@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -primary-file %s -module-name main -o %t/main.o -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-swift-frontend-main-stats-output-dir.swift-*-o-*.json | FileCheck %s
+
+// CHECK: {
+// CHECK-DAG: "AST.NumSourceBuffers": {{[1-9]}}
+// CHECK-DAG: "AST.NumASTBytesAllocated": {{[1-9][0-9]*}}
+// CHECK-DAG: "AST.MaxASTBytesAllocatedPerFile": {{[1-9][0-9]*}}
+// CHECK-DAG: "AST.NumArchetypeBuildersCreated": {{[0-9]+}}
+// CHECK-DAG: "Serialization.NumDeclsDeserialized": {{[1-9]}}
+// CHECK-DAG: "ClangImporter.NumImportedEntities": {{[0-9]+}}
+// CHECK-DAG: "Sema.NumSolutionAttempts": {{[1-9]}}
+// CHECK-DAG: "Sema.NumValidateDeclCalls": {{[1-9]}}
+// CHECK-DAG: "Sema.ResolveTypeDeclRequestsProcessed": {{[0-9]+}}
+// CHECK-DAG: "SILModule.NumSILGenFunctions": {{[1-9]}}
+// CHECK-DAG: "SILModule.NumSILOptInstructions": {{[1-9]}}
+// CHECK-DAG: "SILModule.NumSILInstBytesAllocated": {{[1-9][0-9]*}}
+// CHECK-DAG: "SILModule.MaxLiveSILInstructions": {{[1-9][0-9]*}}
+// CHECK-DAG: "IRModule.NumIRFunctions": {{[1-9]}}
+// CHECK-DAG: "time.swift.Parsing.wall": {{[0-9]+\.[0-9]+}}
+// CHECK-DAG: "time.swift.Type checking / Semantic analysis.cpu": {{[0-9]+\.[0-9]+}}
+// CHECK-DAG: "time.swift.SILGen.wall"
+// CHECK-DAG: "time.swift.IRGen.wall"
+// CHECK-DAG: "time.swift.LLVM optimization.wall"
+// CHECK-DAG: "time.swift.Frontend.wall"
+// CHECK: }
+
+func add(_ x: Int, _ y: Int) -> Int {
+  return x + y
+}
+
+let total = add(1, 2) + [3, 4].count
@@ -0,0 +1,19 @@
+// RUN: %target-swift-ide-test -syntax-coloring -syntax-coloring-lines=11:12 -source-filename %s | FileCheck %s
+// RUN: %target-swift-ide-test -syntax-coloring -syntax-coloring-lines=11:12 -typecheck -source-filename %s | FileCheck %s
+// XFAIL: broken_std_regex
+
+// Only the top-level declarations overlapping the lines are colored.
+
+func before() {}
+// CHECK: {{^}}func before() {}
+
+func inRange(x: Int) -> Int {
+  let y = x
+  return y + 1
+}
+// CHECK: {{^}}<kw>func</kw> inRange(x: <type>Int</type>) -> <type>Int</type> {
+// CHECK: {{^}}  <kw>let</kw> y = x
+// CHECK: {{^}}  <kw>return</kw> y + <int>1</int>
+
+func after() {}
+// CHECK: {{^}}func after() {}
@@ -0,0 +1,6 @@
+// RUN: %swift-ide-test -lex-benchmark -lex-iterations=3 -source-filename %s | FileCheck %s
+
+// CHECK: tokens: 7
+// CHECK: iterations: 3
+
+func foo() {}
@@ -369,16 +369,17 @@ func testCondFail(_ b: Bool, c: Bool) {
 
 // CHECK-LABEL: define hidden void @_TF8builtins8testOnce{{.*}}(i8*, i8*) {{.*}} {
 // CHECK:         [[PRED_PTR:%.*]] = bitcast i8* %0 to [[WORD:i64|i32]]*
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
-// CHECK-objc:  [[NOT_DONE]]:
+// CHECK-objc:    [[PRED:%.*]] = load [[WORD]], [[WORD]]* [[PRED_PTR]], align
+// CHECK-native:  [[PRED:%.*]] = load atomic [[WORD]], [[WORD]]* [[PRED_PTR]] acquire, align
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
+// CHECK:       [[NOT_DONE]]:
 // CHECK:         call void @swift_once([[WORD]]* [[PRED_PTR]], i8* %1)
-// CHECK-objc:    br label %[[DONE]]
-// CHECK-objc:  [[DONE]]:
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    call void @llvm.assume(i1 [[IS_DONE]])
+// CHECK:         br label %[[DONE]]
+// CHECK:       [[DONE]]:
+// CHECK:         [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         call void @llvm.assume(i1 [[IS_DONE]])
 
 func testOnce(_ p: Builtin.RawPointer, f: @convention(thin) () -> ()) {
   Builtin.once(p, f)
@@ -499,6 +500,22 @@ func copyGenArray<T>(_ dest: Builtin.RawPointer, src: Builtin.RawPointer, count:
   Builtin.takeArrayBackToFront(T.self, dest, src, count)
 }
 
+struct GenPair<T> { var first: T; var second: T }
+
+// Arrays of non-fixed-layout aggregates go through the aggregate's own array
+// witnesses, which the runtime replaces with memcpy for POD instantiations.
+// CHECK-LABEL: define hidden void @_TF8builtins16copyGenPairArray{{.*}}(i8*, i8*, i64, %swift.opaque* noalias nocapture, %swift.type* %T)
+// CHECK-NOT:   loop:
+// CHECK:         call %swift.opaque* %initializeArrayWithCopy
+// CHECK-NOT:   loop:
+// CHECK:         call void %destroyArray
+// CHECK-NOT:   loop:
+// CHECK:         ret void
+func copyGenPairArray<T>(_ dest: Builtin.RawPointer, src: Builtin.RawPointer, count: Builtin.Word, _: T) {
+  Builtin.copyArray(GenPair<T>.self, dest, src, count)
+  Builtin.destroyArray(GenPair<T>.self, src, count)
+}
+
 // CHECK-LABEL: define hidden void @_TF8builtins24conditionallyUnreachableFT_T_
 // CHECK-NEXT:  entry
 // CHECK-NEXT:    unreachable
@@ -702,6 +719,25 @@ func ispod_test() {
   var f = Builtin.ispod(Builtin.NativeObject)
 }
 
+// CHECK-LABEL: define {{.*}} @{{.*}}generic_isbitwisetakable_test
+func generic_isbitwisetakable_test<T>(_: T) {
+  // CHECK:      [[T0:%.*]] = getelementptr inbounds i8*, i8** [[T:%.*]], i32 18
+  // CHECK-NEXT: [[T1:%.*]] = load i8*, i8** [[T0]]
+  // CHECK-NEXT: [[FLAGS:%.*]] = ptrtoint i8* [[T1]] to i64
+  // CHECK-NEXT: [[ISNOTBITWISETAKABLE:%.*]] = and i64 [[FLAGS]], 1048576
+  // CHECK-NEXT: [[ISBITWISETAKABLE:%.*]] = icmp eq i64 [[ISNOTBITWISETAKABLE]], 0
+  // CHECK-NEXT: store i1 [[ISBITWISETAKABLE]], i1* [[S:%.*]]
+  var s = Builtin.isbitwisetakable(T.self)
+}
+
+// CHECK-LABEL: define {{.*}} @{{.*}}isbitwisetakable_test
+func isbitwisetakable_test() {
+  // CHECK: store i1 true, i1*
+  // CHECK: store i1 true, i1*
+  var t1 = Builtin.isbitwisetakable(Int.self)
+  var t2 = Builtin.isbitwisetakable(Builtin.NativeObject)
+}
+
 // CHECK-LABEL: define {{.*}} @{{.*}}generic_unsafeGuaranteed_test
 // CHECK:  call void @{{.*}}swift_{{.*}}etain({{.*}}* %0)
 // CHECK:  call void @{{.*}}swift_{{.*}}elease({{.*}}* %0)
@@ -0,0 +1,31 @@
+// RUN: %swift -target arm64-apple-ios7.1 %s -module-name main -emit-ir -o - | FileCheck -check-prefix=CHECK-ARM64 %s
+// RUN: %swift -target x86_64-apple-macosx10.9 %s -module-name main -emit-ir -o - | FileCheck -check-prefix=CHECK-X86_64 %s
+
+// REQUIRES: X86
+// REQUIRES: ARM
+
+struct Rect {
+  var x, y, width, height: Int
+}
+
+struct Cube {
+  var x, y, z, width, height, depth: Int
+}
+
+// arm64 returns four scalars directly; x86-64 only has room for three.
+// CHECK-ARM64-LABEL: define hidden { i64, i64, i64, i64 } @_TF4main8makeRectFT_VS_4Rect()
+// CHECK-X86_64-LABEL: define hidden void @_TF4main8makeRectFT_VS_4Rect(%V4main4Rect* noalias nocapture sret)
+func makeRect() -> Rect {
+  return Rect(x: 0, y: 0, width: 1, height: 1)
+}
+
+// CHECK-ARM64-LABEL: define hidden i64 @_TF4main4areaFVS_4RectSi(i64, i64, i64, i64)
+func area(_ r: Rect) -> Int {
+  return r.width * r.height
+}
+
+// Anything bigger is still returned indirectly.
+// CHECK-ARM64-LABEL: define hidden void @_TF4main8makeCubeFT_VS_4Cube(%V4main4Cube* noalias nocapture sret)
+func makeCube() -> Cube {
+  return Cube(x: 0, y: 0, z: 0, width: 1, height: 1, depth: 1)
+}
@@ -0,0 +1,32 @@
+// RUN: %target-swift-frontend -O -emit-ir -primary-file %s | FileCheck %s
+// RUN: %target-swift-frontend -emit-ir -primary-file %s | FileCheck %s -check-prefix=CHECK-ONONE
+
+struct MyStruct {}
+
+struct Box<T> {
+  var value: T
+}
+
+@inline(never)
+func consume(_ type: Any.Type) {}
+
+// When optimizing, uses of fully-substituted generic metadata check the
+// accessor's cache variable themselves, and only call the accessor the first
+// time.
+
+// CHECK-LABEL: define{{( protected)?}} {{.*}}void @_TF29generic_metadata_inline_cache3useFT_T_()
+// CHECK: [[CACHE:%.*]] = load %swift.type*, %swift.type** @_TMLGV29generic_metadata_inline_cache3BoxVS_8MyStruct_
+// CHECK: [[ISNULL:%.*]] = icmp eq %swift.type* [[CACHE]], null
+// CHECK: br i1 [[ISNULL]], label %[[NULL:.*]], label %[[CONT:.*]]
+// CHECK: [[NULL]]:
+// CHECK: call %swift.type* @_TMaGV29generic_metadata_inline_cache3BoxVS_8MyStruct_()
+// CHECK: [[CONT]]:
+// CHECK: phi %swift.type*
+
+// CHECK-ONONE-LABEL: define{{( protected)?}} {{.*}}void @_TF29generic_metadata_inline_cache3useFT_T_()
+// CHECK-ONONE-NOT: @_TMLGV29generic_metadata_inline_cache3BoxVS_8MyStruct_
+// CHECK-ONONE: call %swift.type* @_TMaGV29generic_metadata_inline_cache3BoxVS_8MyStruct_()
+// CHECK-ONONE: ret void
+public func use() {
+  consume(Box<MyStruct>.self)
+}
@@ -11,7 +11,7 @@ import Swift
 // CHECK: [[D:%C13generic_types1D]] = type
 
 // CHECK-LABEL: @_TMPC13generic_types1A = hidden global
-// CHECK:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_A,
+// CHECK:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_A to i64
 // CHECK-native-SAME: i32 160,
 // CHECK-objc-SAME:   i32 344,
 // CHECK-SAME:   i16 1,
@@ -37,7 +37,7 @@ import Swift
 // CHECK-SAME:   %C13generic_types1A* (i64, %C13generic_types1A*)* @_TFC13generic_types1AcfT1ySi_GS0_x_
 // CHECK-SAME: }
 // CHECK-LABEL: @_TMPC13generic_types1B = hidden global
-// CHECK-SAME:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_B,
+// CHECK-SAME:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_B to i64
 // CHECK-native-SAME: i32 152,
 // CHECK-objc-SAME:   i32 336,
 // CHECK-SAME:   i16 1,
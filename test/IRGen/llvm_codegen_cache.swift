@@ -0,0 +1,39 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// The cache is independent of the existing object files, so disable the
+// incremental llvm codegen, which reuses them.
+
+// RUN: echo "initial" >%t/log
+// RUN: %target-swift-frontend -O -wmo -num-threads 2 %s %S/Inputs/simple.swift -module-name=test -c -o %t/test.o -o %t/simple.o -disable-incremental-llvm-codegen -llvm-codegen-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: initial
+// CHECK-DAG: test.o: MD5=[[TEST_MD5:[0-9a-f]+]]
+// CHECK-DAG: test.o: added to cache as {{.*}}cache{{/|\\}}[[TEST_MD5]].o
+// CHECK-DAG: simple.o: MD5=[[SIMPLE_MD5:[0-9a-f]+]]
+// CHECK-DAG: simple.o: added to cache as {{.*}}cache{{/|\\}}[[SIMPLE_MD5]].o
+
+// RUN: echo "one file changed" >>%t/log
+// RUN: %target-swift-frontend -O -wmo -num-threads 2 %s %S/Inputs/simple2.swift -module-name=test -c -o %t/test.o -o %t/simple.o -disable-incremental-llvm-codegen -llvm-codegen-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: one file changed
+// CHECK-DAG: test.o: using cached {{.*}}cache{{/|\\}}[[TEST_MD5]].o
+// CHECK-DAG: simple.o: MD5=[[SIMPLE2_MD5:[0-9a-f]+]]
+// CHECK-DAG: simple.o: added to cache as {{.*}}cache{{/|\\}}[[SIMPLE2_MD5]].o
+
+// Changing the file back reuses its first object file, even though the
+// output file was overwritten in between.
+
+// RUN: echo "file changed back" >>%t/log
+// RUN: %target-swift-frontend -O -wmo -num-threads 2 %s %S/Inputs/simple.swift -module-name=test -c -o %t/test.o -o %t/simple.o -disable-incremental-llvm-codegen -llvm-codegen-cache-path %t/cache -Xllvm -debug-only=irgen 2>>%t/log
+
+// CHECK-LABEL: file changed back
+// CHECK-DAG: test.o: using cached {{.*}}cache{{/|\\}}[[TEST_MD5]].o
+// CHECK-DAG: simple.o: using cached {{.*}}cache{{/|\\}}[[SIMPLE_MD5]].o
+
+// RUN: FileCheck %s < %t/log
+
+// REQUIRES: asserts
+
+public func test_func1() {
+  print("Hello")
+}
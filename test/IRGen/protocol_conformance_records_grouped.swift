@@ -0,0 +1,23 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck %s
+
+// Conformance records are emitted grouped by protocol, so that the runtime
+// can index each section with one entry per protocol.
+
+protocol Beta {}
+protocol Alpha {}
+
+struct First: Beta {}
+struct Second: Alpha {}
+struct Third: Beta {}
+
+// CHECK-LABEL: @"\01l_protocol_conformances" = private constant [
+// CHECK:         %swift.protocol_conformance {
+// CHECK:           @_TMp37protocol_conformance_records_grouped5Alpha
+// CHECK:           @_TMfV37protocol_conformance_records_grouped6Second
+// CHECK:         %swift.protocol_conformance {
+// CHECK:           @_TMp37protocol_conformance_records_grouped4Beta
+// CHECK:           @_TMfV37protocol_conformance_records_grouped5First
+// CHECK:         %swift.protocol_conformance {
+// CHECK:           @_TMp37protocol_conformance_records_grouped4Beta
+// CHECK:           @_TMfV37protocol_conformance_records_grouped5Third
+// CHECK:       ]
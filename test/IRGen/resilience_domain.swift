@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -emit-module -enable-resilience -resilience-domain Bundle -emit-module-path=%t/resilient_struct.swiftmodule -module-name=resilient_struct %S/../Inputs/resilient_struct.swift
+// RUN: %target-swift-frontend -I %t -emit-ir -enable-resilience -resilience-domain Bundle %s | FileCheck %s
+// RUN: %target-swift-frontend -I %t -emit-ir -enable-resilience -resilience-domain Other %s | FileCheck %s -check-prefix=OTHER
+
+import resilient_struct
+
+// Resilient structs from a module in the same resilience domain have a fixed
+// layout, so they are passed and copied directly rather than through value
+// witnesses.
+
+// CHECK-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain12getSizeWidthFV16resilient_struct4SizeSi(
+// CHECK-NOT: @_TMaV16resilient_struct4Size
+// CHECK: ret
+
+// OTHER-LABEL: define{{( protected)?}} {{.*}} @_TF17resilience_domain12getSizeWidthFV16resilient_struct4SizeSi(%V16resilient_struct4Size* noalias nocapture)
+// OTHER: call %swift.type* @_TMaV16resilient_struct4Size()
+// OTHER: ret
+
+public func getSizeWidth(_ s: Size) -> Int {
+  return s.w
+}
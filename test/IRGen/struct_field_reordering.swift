@@ -0,0 +1,36 @@
+// RUN: %target-swift-frontend -enable-struct-field-reordering -primary-file %s -emit-ir | FileCheck %s
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck --check-prefix=NOREORDER %s
+
+// REQUIRES: CPU=x86_64
+
+// CHECK: %V23struct_field_reordering6Packet = type <{ %Si, %Si, %Sb, %Sb }>
+// NOREORDER: %V23struct_field_reordering6Packet = type <{ %Sb, [7 x i8], %Si, %Sb, [7 x i8], %Si }>
+struct Packet {
+  var a: Bool
+  var b: Int
+  var c: Bool
+  var d: Int
+}
+
+// Public structs are laid out in declaration order.
+// CHECK: %V23struct_field_reordering12PublicPacket = type <{ %Sb, [7 x i8], %Si, %Sb, [7 x i8], %Si }>
+public struct PublicPacket {
+  var a: Bool
+  var b: Int
+  var c: Bool
+  var d: Int
+}
+
+// The runtime lays out generic structs in declaration order.
+// CHECK: %GV23struct_field_reordering13GenericPacketSi_ = type <{ %Sb, [7 x i8], %Si, %Sb, [7 x i8], %Si }>
+struct GenericPacket<T> {
+  var a: Bool
+  var b: T
+  var c: Bool
+  var d: Int
+}
+
+func use(_ p: Packet, _ q: PublicPacket, _ r: GenericPacket<Int>) {}
+
+var packets: [Packet] = []
+var genericPacket: GenericPacket<Int>? = nil
@@ -0,0 +1,41 @@
+// RUN: %target-swift-frontend -O -emit-ir -primary-file %s | FileCheck %s
+// RUN: %target-swift-frontend -emit-ir -primary-file %s | FileCheck %s -check-prefix=CHECK-ONONE
+
+struct MyStruct {}
+
+@inline(never)
+func consume(_ type: Any.Type) {}
+
+// When optimizing, uses of concrete tuple and function metadata check the
+// accessor's cache variable themselves, and only call the accessor (and
+// through it swift_getTupleTypeMetadata or swift_getFunctionTypeMetadata)
+// the first time.
+
+// CHECK-LABEL: define{{( protected)?}} {{.*}}void @_TF33structural_metadata_inline_cache8useTupleFT_T_()
+// CHECK: [[CACHE:%.*]] = load %swift.type*, %swift.type** @_TMLT
+// CHECK: [[ISNULL:%.*]] = icmp eq %swift.type* [[CACHE]], null
+// CHECK: br i1 [[ISNULL]], label %[[NULL:.*]], label %[[CONT:.*]]
+// CHECK: [[NULL]]:
+// CHECK: call %swift.type* @_TMaT
+// CHECK: [[CONT]]:
+// CHECK: phi %swift.type*
+
+// CHECK-ONONE-LABEL: define{{( protected)?}} {{.*}}void @_TF33structural_metadata_inline_cache8useTupleFT_T_()
+// CHECK-ONONE-NOT: load %swift.type*, %swift.type** @_TMLT
+// CHECK-ONONE: call %swift.type* @_TMaT
+// CHECK-ONONE: ret void
+public func useTuple() {
+  consume((MyStruct, Int).self)
+}
+
+// CHECK-LABEL: define{{( protected)?}} {{.*}}void @_TF33structural_metadata_inline_cache11useFunctionFT_T_()
+// CHECK: [[CACHE:%.*]] = load %swift.type*, %swift.type** @_TMLF
+// CHECK: [[ISNULL:%.*]] = icmp eq %swift.type* [[CACHE]], null
+// CHECK: br i1 [[ISNULL]], label %[[NULL:.*]], label %[[CONT:.*]]
+// CHECK: [[NULL]]:
+// CHECK: call %swift.type* @_TMaF
+// CHECK: [[CONT]]:
+// CHECK: phi %swift.type*
+public func useFunction() {
+  consume(((MyStruct) -> Int).self)
+}
@@ -0,0 +1,32 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_DEFERRED_DEALLOC=1 %target-run %t/a.out | FileCheck %s
+// REQUIRES: executable_test
+
+var deinitCount = 0
+
+final class Node {
+  var next: Node?
+  init(next: Node?) { self.next = next }
+  deinit { deinitCount += 1 }
+}
+
+// Without deferred deallocation, releasing the head of a list this long
+// overflows the stack.
+var head: Node? = nil
+for _ in 0..<1_000_000 {
+  head = Node(next: head)
+}
+head = nil
+
+// CHECK: 1000000
+print(deinitCount)
+
+// Objects released by a deinit are still destroyed before the release that
+// started the teardown returns.
+deinitCount = 0
+var objects: [Node]? = (0..<100).map { _ in Node(next: Node(next: nil)) }
+objects = nil
+
+// CHECK-NEXT: 200
+print(deinitCount)
@@ -0,0 +1,49 @@
+// RUN: %target-run-simple-swift | FileCheck %s
+// REQUIRES: executable_test
+
+struct Point : Hashable {
+  var x: Int
+  var y: Int
+}
+
+struct Labeled : Hashable {
+  var label: String
+  var point: Point
+}
+
+enum Shape : Hashable {
+  case circle(center: Point, radius: Double)
+  case polygon(sides: Int, String)
+  case empty
+}
+
+// CHECK: true
+print(Point(x: 1, y: 2) == Point(x: 1, y: 2))
+// CHECK-NEXT: false
+print(Point(x: 1, y: 2) == Point(x: 2, y: 1))
+// CHECK-NEXT: true
+print(Point(x: 1, y: 2).hashValue == Point(x: 1, y: 2).hashValue)
+// CHECK-NEXT: false
+print(Point(x: 1, y: 2).hashValue == Point(x: 2, y: 1).hashValue)
+
+let a = Labeled(label: "a", point: Point(x: 0, y: 0))
+let b = Labeled(label: "b", point: Point(x: 0, y: 0))
+// CHECK-NEXT: true
+print(a == a)
+// CHECK-NEXT: false
+print(a == b)
+// CHECK-NEXT: true
+print(a.hashValue == Labeled(label: "a", point: Point(x: 0, y: 0)).hashValue)
+
+let circle = Shape.circle(center: Point(x: 0, y: 0), radius: 1)
+// CHECK-NEXT: true
+print(circle == .circle(center: Point(x: 0, y: 0), radius: 1))
+// CHECK-NEXT: false
+print(circle == .circle(center: Point(x: 0, y: 0), radius: 2))
+// CHECK-NEXT: false
+print(circle == .empty)
+// CHECK-NEXT: true
+print(Shape.empty == .empty)
+// CHECK-NEXT: true
+print(circle.hashValue ==
+      Shape.circle(center: Point(x: 0, y: 0), radius: 1).hashValue)
@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_HEAP_PROFILE=%t/heap.prof SWIFT_HEAP_PROFILE_RATE=1 %target-run %t/a.out | FileCheck %s
+// RUN: FileCheck -check-prefix=PROFILE %s < %t/heap.prof
+// RUN: FileCheck -check-prefix=TYPES %s < %t/heap.prof.types
+// REQUIRES: executable_test
+
+class ProfiledClass {
+  var value = 0
+}
+
+var objects: [ProfiledClass] = []
+for _ in 0..<100 {
+  objects.append(ProfiledClass())
+}
+print(objects.count)
+
+// CHECK: 100
+
+// PROFILE: heap profile: {{[0-9]+}}: {{[0-9]+}} [{{[0-9]+}}: {{[0-9]+}}] @ heap_v2/1
+// PROFILE: 1: {{[0-9]+}} [1: {{[0-9]+}}] @ 0x
+// PROFILE: MAPPED_LIBRARIES:
+
+// TYPES: 0x{{[0-9a-f]+}} {{.*}}ProfiledClass
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %swift -interpret %s -llvm-codegen-cache-path %t/cache | FileCheck %s
+// RUN: ls %t/cache | FileCheck %s -check-prefix=CACHE
+// RUN: %swift -interpret %s -llvm-codegen-cache-path %t/cache | FileCheck %s
+// RUN: ls %t/cache | FileCheck %s -check-prefix=CACHE
+
+// REQUIRES: swift_interpreter
+
+// The second run loads the object compiled by the first one.
+
+// CHECK: Hello from the cache
+print("Hello from the cache")
+
+// CACHE: {{^[0-9a-f]+\.o$}}
+// CACHE-NOT: .o
@@ -0,0 +1,30 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_RUNTIME_STATS=1 %target-run %t/a.out 2>&1 | FileCheck %s
+// RUN: %target-run %t/a.out 2>&1 | FileCheck -check-prefix=DISABLED %s
+// REQUIRES: executable_test
+
+protocol P {}
+struct S<T> : P {}
+class C {}
+
+@inline(never)
+func isP(_ x: Any) -> Bool {
+  return x is P
+}
+
+for _ in 0..<100 {
+  _ = C()
+  _ = isP(S<Int>())
+}
+print("done")
+
+// CHECK: done
+// CHECK: swift runtime statistics:
+// CHECK: swift_allocObject
+// CHECK: swift_dynamicCast
+// CHECK: generic metadata instantiated
+// CHECK: conformance sections scanned
+
+// DISABLED: done
+// DISABLED-NOT: swift runtime statistics
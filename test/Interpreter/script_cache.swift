@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %swift -interpret %s -script-cache-path %t/cache -- first | FileCheck %s -check-prefix=FIRST
+// RUN: ls %t/cache | FileCheck %s -check-prefix=CACHE
+// RUN: %swift -interpret %s -script-cache-path %t/cache -- second | FileCheck %s -check-prefix=SECOND
+
+// A changed cache entry is not used.
+// RUN: echo "init _unknown_function" >> %t/cache/*.manifest
+// RUN: %swift -interpret %s -script-cache-path %t/cache -- third | FileCheck %s -check-prefix=THIRD
+
+// REQUIRES: swift_interpreter
+
+// The script arguments don't affect the cache entry, so the second run
+// reuses the entry of the first one.
+print("Arguments: \(Process.arguments.dropFirst())")
+
+// FIRST: Arguments: ["first"]
+// SECOND: Arguments: ["second"]
+// THIRD: Arguments: ["third"]
+
+// CACHE-DAG: {{^[0-9a-f]+\.bc$}}
+// CACHE-DAG: {{^[0-9a-f]+\.manifest$}}
+// CACHE-DAG: {{^[0-9a-f]+\.o$}}
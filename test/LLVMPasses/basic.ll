@@ -370,6 +370,100 @@ bb1:
 }
 
 
+; CHECK-LABEL: @retain_release_across_diamond(
+; CHECK-NOT: swift_retain
+; CHECK-NOT: swift_release
+; CHECK: ret void
+define void @retain_release_across_diamond(%swift.refcounted* %A, i1 %c, i64* %p) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  store i64 1, i64* %p
+  br label %bb3
+bb2:
+  store i64 2, i64* %p
+  br label %bb3
+bb3:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; CHECK-LABEL: @retain_release_in_each_successor(
+; CHECK: entry:
+; CHECK-NOT: swift_retain
+; CHECK: bb1:
+; CHECK-NOT: swift_release
+; CHECK: bb2:
+; CHECK-NOT: swift_release
+; CHECK: ret void
+define void @retain_release_in_each_successor(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb3
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb3
+bb3:
+  ret void
+}
+
+; A call in one of the paths might release the object.
+; CHECK-LABEL: @retain_release_across_diamond_with_call(
+; CHECK: swift_retain
+; CHECK: unknown_func
+; CHECK: swift_release
+; CHECK: ret void
+define void @retain_release_across_diamond_with_call(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  call void @unknown_func()
+  br label %bb3
+bb2:
+  br label %bb3
+bb3:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; The release is also reached without passing the retain.
+; CHECK-LABEL: @retain_release_side_entry(
+; CHECK: swift_retain
+; CHECK: swift_release
+; CHECK: ret void
+define void @retain_release_side_entry(%swift.refcounted* %A, i1 %c) {
+entry:
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br label %bb2
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; Only one path releases the object.
+; CHECK-LABEL: @retain_release_one_path(
+; CHECK: swift_retain
+; CHECK: swift_release
+; CHECK: ret void
+define void @retain_release_one_path(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+bb2:
+  ret void
+}
+
+
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
 
@@ -0,0 +1,76 @@
+; RUN: %swift-llvm-opt -swift-inline-refcounting %s | FileCheck %s
+
+target datalayout = "e-p:64:64:64-S128-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f128:128:128-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-macosx10.9"
+
+%swift.refcounted = type { %swift.heapmetadata*, i64 }
+%swift.heapmetadata = type { i64 (%swift.refcounted*)*, i64 (%swift.refcounted*)* }
+
+declare void @swift_release(%swift.refcounted* nocapture)
+declare void @swift_retain(%swift.refcounted* ) nounwind
+declare void @swift_release_n(%swift.refcounted* nocapture, i32)
+declare void @swift_retain_n(%swift.refcounted* , i32) nounwind
+declare void @swift_nonatomic_retain(%swift.refcounted* ) nounwind
+declare void @user(%swift.refcounted*)
+
+; CHECK-LABEL: define{{( protected)?}} void @inline_retain(%swift.refcounted*) {
+; CHECK: [[NONNULL:%.*]] = icmp ne %swift.refcounted* %0, null
+; CHECK: br i1 [[NONNULL]]
+; CHECK: [[BYTES:%.*]] = bitcast %swift.refcounted* %0 to i8*
+; CHECK: [[FIELD:%.*]] = getelementptr inbounds i8, i8* [[BYTES]], i32 8
+; CHECK: [[RC:%.*]] = bitcast i8* [[FIELD]] to i32*
+; CHECK: atomicrmw add i32* [[RC]], i32 4 monotonic
+; CHECK-NOT: call void @swift_retain
+; CHECK: call void @user(%swift.refcounted* %0)
+; CHECK: ret void
+define void @inline_retain(%swift.refcounted*) {
+entry:
+  call void @swift_retain(%swift.refcounted* %0)
+  call void @user(%swift.refcounted* %0)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @inline_release(%swift.refcounted*) {
+; CHECK: [[NONNULL:%.*]] = icmp ne %swift.refcounted* %0, null
+; CHECK: br i1 [[NONNULL]]
+; CHECK: [[OLD:%.*]] = atomicrmw sub i32* {{%.*}}, i32 4 release
+; CHECK: [[ISZERO:%.*]] = icmp eq i32 [[OLD]], 4
+; CHECK: br i1 [[ISZERO]]
+; CHECK: call void @swift_releaseToZero(%swift.refcounted* %0)
+; CHECK-NOT: call void @swift_release(
+; CHECK: ret void
+define void @inline_release(%swift.refcounted*) {
+entry:
+  call void @swift_release(%swift.refcounted* %0)
+  ret void
+}
+
+; CHECK-LABEL: define{{( protected)?}} void @inline_retain_release_n(%swift.refcounted*) {
+; CHECK: atomicrmw add i32* {{%.*}}, i32 12 monotonic
+; CHECK: [[OLD:%.*]] = atomicrmw sub i32* {{%.*}}, i32 8 release
+; CHECK: icmp eq i32 [[OLD]], 8
+; CHECK: call void @swift_releaseToZero(%swift.refcounted* %0)
+; CHECK: ret void
+define void @inline_retain_release_n(%swift.refcounted*) {
+entry:
+  call void @swift_retain_n(%swift.refcounted* %0, i32 3)
+  call void @user(%swift.refcounted* %0)
+  call void @swift_release_n(%swift.refcounted* %0, i32 2)
+  ret void
+}
+
+; Calls with a variable count, and non-atomic calls, are left alone.
+; CHECK-LABEL: define{{( protected)?}} void @not_inlined(%swift.refcounted*, i32) {
+; CHECK-NOT: atomicrmw
+; CHECK: call void @swift_retain_n(%swift.refcounted* %0, i32 %1)
+; CHECK: call void @swift_nonatomic_retain(%swift.refcounted* %0)
+; CHECK-NOT: atomicrmw
+; CHECK: ret void
+define void @not_inlined(%swift.refcounted*, i32) {
+entry:
+  call void @swift_retain_n(%swift.refcounted* %0, i32 %1)
+  call void @swift_nonatomic_retain(%swift.refcounted* %0)
+  ret void
+}
+
+; CHECK: declare void @swift_releaseToZero(%swift.refcounted*)
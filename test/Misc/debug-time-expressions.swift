@@ -0,0 +1,15 @@
+// RUN: %target-swift-frontend -parse -debug-time-expression-type-checking %s 2>&1 | FileCheck %s
+// RUN: %target-swift-frontend -parse -warn-long-expression-type-checking=1000000 %s 2>&1 | FileCheck -check-prefix=WARN %s
+
+// The report is sorted by time, so only check that every expression appears.
+// CHECK-DAG: {{[0-9]+}}.{{[0-9]}}ms{{[[:space:]]+}}{{.*}}debug-time-expressions.swift:[[@LINE+3]]:{{[0-9]+}}
+// CHECK-DAG: {{[0-9]+}}.{{[0-9]}}ms{{[[:space:]]+}}{{.*}}debug-time-expressions.swift:[[@LINE+3]]:{{[0-9]+}}
+// CHECK-DAG: {{[0-9]+}}.{{[0-9]}}ms{{[[:space:]]+}}{{.*}}debug-time-expressions.swift:[[@LINE+5]]:{{[0-9]+}}
+let x = 1 + 2 * 3
+let xs = [1, 2, 3].map { $0 + 1 }
+
+func f(_ y: Int) -> Int {
+  return y + x
+}
+
+// WARN-NOT: warning: expression took
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -parse -primary-file %s -emit-reference-dependencies-path %t/yaml.swiftdeps
+// RUN: %target-swift-frontend -parse -primary-file %s -emit-reference-dependencies-path %t/binary.swiftdeps -enable-binary-dependencies
+// RUN: FileCheck -check-prefix=YAML %s < %t/yaml.swiftdeps
+// RUN: head -c 4 %t/binary.swiftdeps | FileCheck -check-prefix=BINARY %s
+
+// The binary format is smaller, since every name is only stored once.
+// RUN: test `wc -c < %t/binary.swiftdeps` -lt `wc -c < %t/yaml.swiftdeps`
+
+// YAML: ### Swift dependencies file v0 ###
+// BINARY: SWDB
+
+// RUN: %swiftc_driver -driver-print-jobs -c %s -module-name main -enable-binary-dependencies 2>&1 | FileCheck -check-prefix=DRIVER %s
+// DRIVER: -frontend -c {{.*}}-enable-binary-dependencies
+
+struct Wrapper {
+  var value: Int
+}
+
+func useWrapper(_ w: Wrapper) -> Int {
+  return w.value
+}
@@ -0,0 +1,45 @@
+// RUN: rm -rf %t && mkdir -p %t/orig %t/body %t/signature
+// RUN: cp %s %t/orig/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/orig/main.swift -emit-reference-dependencies-path - > %t/orig.swiftdeps
+// RUN: FileCheck %s < %t/orig.swiftdeps
+
+// Changing a function body doesn't change any fingerprints.
+// RUN: sed -e 's/return 1/return 2/' %s > %t/body/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/body/main.swift -emit-reference-dependencies-path - > %t/body.swiftdeps
+// RUN: grep '"[0-9a-f]\{32\}"\]$' %t/orig.swiftdeps > %t/orig.fingerprints
+// RUN: grep '"[0-9a-f]\{32\}"\]$' %t/body.swiftdeps > %t/body.fingerprints
+// RUN: diff %t/orig.fingerprints %t/body.fingerprints
+
+// Changing a signature only changes the fingerprint of that declaration.
+// RUN: sed -e 's/x: Int)/x: Double)/' %s > %t/signature/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/signature/main.swift -emit-reference-dependencies-path - > %t/signature.swiftdeps
+// RUN: diff <(grep '\["returnsOne"' %t/orig.swiftdeps) <(grep '\["returnsOne"' %t/signature.swiftdeps)
+// RUN: not diff <(grep '\["takesX"' %t/orig.swiftdeps) <(grep '\["takesX"' %t/signature.swiftdeps)
+
+// CHECK-LABEL: {{^fingerprints-top-level:$}}
+// CHECK-DAG: - ["returnsOne", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["takesX", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["Wrapper", "{{[0-9a-f]+}}"]
+
+// CHECK-LABEL: {{^fingerprints-nominal:$}}
+// CHECK-DAG: - ["V4main7Wrapper", "{{[0-9a-f]+}}"]
+
+// CHECK-LABEL: {{^fingerprints-member:$}}
+// CHECK-DAG: - ["V4main7Wrapper", "", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["Si", "extensionMember", "{{[0-9a-f]+}}"]
+
+// CHECK-LABEL: {{^depends-top-level:$}}
+
+func returnsOne() -> Int {
+  return 1
+}
+
+func takesX(x: Int) {}
+
+struct Wrapper {
+  var value: Int
+}
+
+extension Int {
+  func extensionMember() {}
+}
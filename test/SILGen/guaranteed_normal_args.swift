@@ -0,0 +1,23 @@
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -enable-guaranteed-normal-arguments %s | FileCheck %s
+
+class C {}
+protocol P {}
+
+struct S {
+  var c: C
+
+  // Initializers still take their arguments at +1.
+  // CHECK-LABEL: sil hidden @{{.*}}1SC{{.*}} : $@convention(method) (@owned C, @thin S.Type) -> @owned S
+  init(c: C) {
+    self.c = c
+  }
+
+  // CHECK-LABEL: sil hidden @{{.*}}1S6method{{.*}} : $@convention(method) (@guaranteed C, @guaranteed S) -> ()
+  func method(_ c: C) {}
+}
+
+// CHECK-LABEL: sil hidden @{{.*}}10takesClass{{.*}} : $@convention(thin) (@guaranteed C) -> ()
+func takesClass(_ c: C) {}
+
+// CHECK-LABEL: sil hidden @{{.*}}16takesAddressOnly{{.*}} : $@convention(thin) (@in_guaranteed P) -> ()
+func takesAddressOnly(_ p: P) {}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %llvm-profdata merge %S/Inputs/profile_use.proftext -o %t/profile_use.profdata
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -module-name main -profile-use=%t/profile_use.profdata %s | FileCheck %s
+// RUN: not %target-swift-frontend -parse-as-library -emit-silgen -module-name main -profile-use=%t/missing.profdata %s 2>&1 | FileCheck -check-prefix=MISSING %s
+
+// MISSING: error: cannot read profile data '{{.*}}missing.profdata'
+
+// With -profile-use, no counters are incremented. Instead, the counts are
+// attached to the blocks that would have incremented them.
+// CHECK-NOT: int_instrprof_increment
+
+// CHECK-LABEL: sil @_TF4main4testFSbSi
+// CHECK: bb0({{.*}}):{{ +}}// Execution count: 100
+// CHECK: bb{{[0-9]+}}:{{ +}}// Preds: bb0 // Execution count: 0
+public func test(_ b: Bool) -> Int {
+  if b {
+    return 1
+  }
+  return 2
+}
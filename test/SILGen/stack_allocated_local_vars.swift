@@ -0,0 +1,27 @@
+// RUN: %target-swift-frontend -emit-silgen -enable-stack-allocated-local-vars %s | FileCheck %s
+
+func use(_ x: Int) {}
+
+// CHECK-LABEL: sil hidden @_TF26stack_allocated_local_vars10uncaptured
+// CHECK-NOT: alloc_box
+// CHECK: [[X:%.*]] = alloc_stack $Int, var, name "x"
+// CHECK-NOT: alloc_box
+// CHECK: dealloc_stack [[X]]
+// CHECK: return
+func uncaptured() {
+  var x = 0
+  x += 1
+  use(x)
+}
+
+// CHECK-LABEL: sil hidden @_TF26stack_allocated_local_vars8captured
+// CHECK: alloc_box $Int, var, name "x"
+// CHECK: alloc_stack $Int, var, name "y"
+// CHECK: return
+func captured() -> () -> Int {
+  var x = 0
+  var y = 1
+  y += x
+  x = y
+  return { x }
+}
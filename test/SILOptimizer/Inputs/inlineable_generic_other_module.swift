@@ -0,0 +1,22 @@
+public struct OrderedBox<T> {
+  public var elements: [T]
+
+  @_inlineable
+  public init() {
+    elements = []
+  }
+
+  @_inlineable
+  public mutating func append(_ x: T) {
+    elements.append(x)
+  }
+}
+
+@_inlineable
+public func firstElement<T>(_ box: OrderedBox<T>) -> T? {
+  return box.elements.first
+}
+
+public func opaqueFirstElement<T>(_ box: OrderedBox<T>) -> T? {
+  return box.elements.first
+}
@@ -0,0 +1,19 @@
+// RUN: %target-swift-frontend -parse-as-library -O -assume-single-threaded -emit-sil %s | FileCheck %s
+// RUN: %target-swift-frontend -parse-as-library -Onone -assume-single-threaded -emit-sil %s | FileCheck %s
+// RUN: %target-swift-frontend -parse-as-library -O -assume-single-threaded -emit-ir %s | FileCheck -check-prefix=CHECK-IR %s
+
+public class C {
+  public init() {}
+}
+
+public var global: C? = nil
+
+// CHECK-LABEL: sil {{.*}}@_TF22assume_single_threaded5storeFCS_1CT_
+// CHECK: strong_retain [nonatomic]
+// CHECK: return
+// CHECK-IR-LABEL: define{{.*}}@_TF22assume_single_threaded5storeFCS_1CT_
+// CHECK-IR: call {{.*}}@swift_nonatomic_retain
+// CHECK-IR: ret void
+public func store(_ c: C) {
+  global = c
+}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -module-name optimization_record -emit-sil %s -save-optimization-record-path %t/record.yaml -o /dev/null
+// RUN: FileCheck %s < %t/record.yaml
+
+// RUN: not %target-swift-frontend -O -emit-sil %s -save-optimization-record-path %t/nonexistent/record.yaml -o /dev/null 2>&1 | FileCheck -check-prefix=CHECK-ERROR %s
+// CHECK-ERROR: error: error opening '{{.*}}record.yaml' for output
+
+@inline(never)
+func identity<T>(_ x: T) -> T {
+  return x
+}
+
+// CHECK: --- !Passed
+// CHECK-NEXT: Pass: sil-generic-specializer
+// CHECK-NEXT: Name: Specialized
+// CHECK-NEXT: DebugLoc: { File: '{{.*}}optimization_record.swift', Line: [[@LINE+6]], Column: {{[0-9]+}} }
+// CHECK-NEXT: Function: '{{.*}}useIdentity{{.*}}'
+// CHECK-NEXT: Args:
+// CHECK-NEXT:   - String: 'specialized {{.*}}identity{{.*}}'
+// CHECK-NEXT: ...
+public func useIdentity(_ x: Int) -> Int {
+  return identity(x)
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -c -primary-file %s -module-name main -o %t/main.o -stats-output-dir %t/stats
+// RUN: cat %t/stats/stats-swift-frontend-main-sil_combine_stats.swift-*-o-*.json | FileCheck %s
+
+// With -stats-output-dir, SILCombine records how often each kind of
+// instruction was visited and combined, and the time spent doing it.
+
+// CHECK: {
+// CHECK-DAG: "count.swift.SILCombine.{{[A-Za-z]+}}Inst.Visits": {{[1-9][0-9]*}}
+// CHECK-DAG: "count.swift.SILCombine.{{[A-Za-z]+}}Inst.Combines": {{[0-9]+}}
+// CHECK-DAG: "time.swift.SILCombine.{{[A-Za-z]+}}Inst.wall": {{[0-9]+\.[0-9]+}}
+// CHECK: }
+
+public func sum(_ values: [Int]) -> Int {
+  var total = 0
+  for value in values {
+    total = total &+ value
+  }
+  return total
+}
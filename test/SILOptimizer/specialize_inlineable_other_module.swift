@@ -0,0 +1,26 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -O -o %t %S/Inputs/inlineable_generic_other_module.swift
+// RUN: %target-swift-frontend -O -I %t -emit-sil -sil-verify-all %s | FileCheck %s
+
+// Generic @_inlineable functions from another module are specialized for the
+// client's types. Functions without the attribute are only called.
+
+import inlineable_generic_other_module
+
+// CHECK-LABEL: sil {{.*}}@{{.*}}8useFirst
+// CHECK-NOT: function_ref @_TF{{.*}}12firstElementu
+// CHECK: return
+public func useFirst() -> Int? {
+  var box = OrderedBox<Int>()
+  box.append(1)
+  return firstElement(box)
+}
+
+// CHECK-LABEL: sil {{.*}}@{{.*}}14useOpaqueFirst
+// CHECK: function_ref @_TF{{.*}}18opaqueFirstElementu
+// CHECK: return
+public func useOpaqueFirst() -> Int? {
+  var box = OrderedBox<Int>()
+  box.append(1)
+  return opaqueFirstElement(box)
+}
@@ -241,16 +241,12 @@ func testSwitchEnumBoolTuple(_ b1: Bool, b2: Bool, xi: Int) -> Int {
   switch Cond {
   case (true, true):
     x += 1
-    // FIXME: Two expect statements are written, because unreachable diagnostics produces N errors
-    // for non-exhaustive switches on tuples of N elements
-  } // expected-error{{switch must be exhaustive}} expected-error{{switch must be exhaustive}}
+  } // expected-error{{switch must be exhaustive}}
 
   switch Cond {
   case (false, true):
     x += 1
-    // FIXME: Two expect statements are written, because unreachable diagnostics produces N errors
-    // for non-exhaustive switches on tuples of N elements
-  } // expected-error{{switch must be exhaustive}} expected-error{{switch must be exhaustive}}
+  } // expected-error{{switch must be exhaustive}}
 
   switch Cond { // no warning
   case (true, true):
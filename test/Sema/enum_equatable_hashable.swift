@@ -122,5 +122,24 @@ public func ==(lhs: Medicine, rhs: Medicine) -> Bool { // expected-note{{non-mat
   return true
 }
 
+// Explicit conformance is derived if all of the associated values conform.
+enum Payload {
+  case A(Int, String)
+  case B(x: Double)
+  case C
+}
+
+extension Payload : Hashable {}
+
+if Payload.A(1, "") == .C { }
+var payloadHash: Int = Payload.B(x: 0).hashValue
+
+struct NotEquatable {}
+
+enum NotEquatablePayload {
+  case A(Int)
+  case B(NotEquatable) // expected-note 2 {{associated value of type 'NotEquatable' does not conform to protocol}}
+}
+
 // No explicit conformance and cannot be derived
-extension Complex : Hashable {} // expected-error 2 {{does not conform}}
+extension NotEquatablePayload : Hashable {} // expected-error {{type 'NotEquatablePayload' does not conform to protocol 'Hashable'}} expected-error {{type 'NotEquatablePayload' does not conform to protocol 'Equatable'}}
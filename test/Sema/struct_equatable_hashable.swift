@@ -0,0 +1,61 @@
+// RUN: %target-parse-verify-swift
+
+struct Point : Hashable {
+  var x: Int
+  var y: Int
+}
+
+if Point(x: 1, y: 2) == Point(x: 1, y: 2) { }
+var pointHash: Int = Point(x: 1, y: 2).hashValue
+
+struct Named : Hashable {
+  let name: String
+  private var point: Point
+  static var count = 0
+
+  var description: String { return name }
+}
+
+func namedEqual(_ a: Named, _ b: Named) -> Bool { return a == b }
+
+struct Generic<T : Hashable> : Hashable {
+  var value: T
+}
+
+if Generic(value: 1) == Generic(value: 2) { }
+var genericHash: Int = Generic(value: "").hashValue
+
+// Conformance can be declared by an extension.
+struct Extended {
+  var value: Double
+}
+
+extension Extended : Equatable {}
+
+if Extended(value: 0) == Extended(value: 1) { }
+
+// Explicit definitions take precedence.
+struct CustomHashable : Hashable {
+  var value: Int
+  var hashValue: Int { return 0 }
+}
+func ==(a: CustomHashable, b: CustomHashable) -> Bool { return true }
+
+// Structs aren't implicitly Equatable.
+struct Undeclared {
+  var value: Int
+}
+
+if Undeclared(value: 0) == Undeclared(value: 0) { } // expected-error{{binary operator '==' cannot be applied to two 'Undeclared' operands}}
+// expected-note @-1 {{overloads for '==' exist with these partially matching parameter lists: }}
+
+struct NotEquatable {}
+
+struct NotEquatableField : Equatable { // expected-error{{type 'NotEquatableField' does not conform to protocol 'Equatable'}}
+  var value: Int
+  var field: NotEquatable // expected-note{{stored property of type 'NotEquatable' does not conform to protocol 'Equatable'}}
+}
+
+struct UnconstrainedGeneric<T> : Equatable { // expected-error{{type 'UnconstrainedGeneric<T>' does not conform to protocol 'Equatable'}}
+  var value: T // expected-note{{stored property of type 'T' does not conform to protocol 'Equatable'}}
+}
@@ -0,0 +1,35 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'public func foo() -> Int { return 1 }' > %t/original.swift
+// RUN: echo 'public func foo() -> Int { return 2 }' > %t/body.swift
+// RUN: echo 'public func foo() -> Int8 { return 1 }' > %t/signature.swift
+// RUN: echo '@_transparent public func foo() -> Int { return 1 }' > %t/transparent.swift
+// RUN: echo '@_transparent public func foo() -> Int { return 2 }' > %t/transparent-body.swift
+
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/original.swiftmodule %t/original.swift
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/body.swiftmodule %t/body.swift
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/signature.swiftmodule %t/signature.swift
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/transparent.swiftmodule %t/transparent.swift
+// RUN: %target-swift-frontend -emit-module -module-name Lib -o %t/transparent-body.swiftmodule %t/transparent-body.swift
+
+// RUN: llvm-bcanalyzer -dump %t/original.swiftmodule | FileCheck %s
+// CHECK: <CONTROL_BLOCK
+// CHECK: <INTERFACE_HASH {{.*}}/> blob = '{{[0-9a-f]+}}'
+// CHECK: </CONTROL_BLOCK>
+
+// RUN: llvm-bcanalyzer -dump %t/original.swiftmodule | grep INTERFACE_HASH > %t/original.hash
+// RUN: llvm-bcanalyzer -dump %t/body.swiftmodule | grep INTERFACE_HASH > %t/body.hash
+// RUN: llvm-bcanalyzer -dump %t/signature.swiftmodule | grep INTERFACE_HASH > %t/signature.hash
+// RUN: llvm-bcanalyzer -dump %t/transparent.swiftmodule | grep INTERFACE_HASH > %t/transparent.hash
+// RUN: llvm-bcanalyzer -dump %t/transparent-body.swiftmodule | grep INTERFACE_HASH > %t/transparent-body.hash
+
+// Function bodies aren't part of the interface...
+// RUN: diff %t/original.hash %t/body.hash
+// ...but signatures are.
+// RUN: not diff %t/original.hash %t/signature.hash
+// Clients inline the bodies of transparent functions.
+// RUN: not diff %t/transparent.hash %t/transparent-body.hash
+
+// The merged module has a hash, computed from the partial modules'.
+// RUN: %target-swift-frontend -emit-module -module-name Lib -primary-file %t/original.swift -o %t/partial.swiftmodule
+// RUN: %target-swift-frontend -emit-module -module-name Lib -parse-as-library %t/partial.swiftmodule -o %t/merged.swiftmodule
+// RUN: llvm-bcanalyzer -dump %t/merged.swiftmodule | FileCheck %s
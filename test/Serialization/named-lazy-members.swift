@@ -0,0 +1,32 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_struct.swift
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_class.swift
+// RUN: llvm-bcanalyzer %t/def_struct.swiftmodule | FileCheck %s
+// RUN: %target-swift-frontend -parse -I %t %s -enable-named-lazy-member-loading
+// RUN: %target-swift-frontend -emit-silgen -I %t %s -enable-named-lazy-member-loading -o /dev/null
+
+// CHECK-NOT: UnknownCode
+// CHECK: DECL_MEMBER_NAMES
+
+import def_struct
+import def_class
+
+var b = TwoInts(x: 1, y: 2)
+var sum = b.x + b.y
+
+var p = Pair(a: 1, b: 2.5)
+p.first = 2
+var revP = p.swap()
+
+var simpleSub = ReadonlySimpleSubscript()
+var subVal = simpleSub[4]
+
+extension Burger {
+  init(triple pattyCount: Int) {
+    self.pattyCount = pattyCount * 3
+  }
+}
+
+var c = ComputedProperty()
+var value = c.value
@@ -1,7 +1,7 @@
 // RUN: rm -rf %t && mkdir %t
 
 // This test checks that we serialize the -enable-resilience and -sil-serialize-all
-// flags correctly.
+// flags correctly, along with -resilience-domain.
 
 // RUN: %target-swift-frontend -emit-module -o %t %s
 // RUN: llvm-bcanalyzer -dump %t/resilience.swiftmodule > %t/resilience.dump.txt
@@ -15,12 +15,18 @@
 // RUN: llvm-bcanalyzer -dump %t/resilience.swiftmodule > %t/resilience3.dump.txt
 // RUN: FileCheck -check-prefix=CHECK -check-prefix=FRAGILE %s < %t/resilience3.dump.txt
 
+// RUN: %target-swift-frontend -emit-module -o %t -enable-resilience -resilience-domain Bundle %s
+// RUN: llvm-bcanalyzer -dump %t/resilience.swiftmodule > %t/resilience4.dump.txt
+// RUN: FileCheck -check-prefix=CHECK -check-prefix=DOMAIN %s < %t/resilience4.dump.txt
+
 // RUN: FileCheck -check-prefix=NEGATIVE %s < %t/resilience2.dump.txt
 
 // CHECK: <MODULE_BLOCK {{.*}}>
 // RESILIENCE: <RESILIENCE_STRATEGY abbrevid={{[0-9]+}} op0=1/>
 // FRAGILE: <RESILIENCE_STRATEGY abbrevid={{[0-9]+}} op0=2/>
 // DEFAULT-NOT: RESILIENCE_STRATEGY
+// DEFAULT-NOT: RESILIENCE_DOMAIN
+// DOMAIN: <RESILIENCE_DOMAIN abbrevid={{[0-9]+}}/> blob data = 'Bundle'
 
 // CHECK: </MODULE_BLOCK>
 // CHECK-NOT: <MODULE_BLOCK {{.*}}>
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir -p %t/listed %t/unlisted
+// RUN: %target-swift-frontend -emit-module -o %t/listed %S/Inputs/struct_with_operators.swift
+// RUN: cp %t/listed/struct_with_operators.swiftmodule %t/unlisted/
+
+// A listed directory is only searched for the modules it lists.
+// RUN: printf '%t/listed\n\tstruct_with_operators.swiftmodule\n%t/unlisted\n\tother.swiftmodule\n' > %t/listing
+// RUN: %target-swift-frontend %s -parse -I %t/unlisted -I %t/listed -search-path-listing %t/listing
+// RUN: not %target-swift-frontend %s -parse -I %t/unlisted -search-path-listing %t/listing 2>&1 | FileCheck -check-prefix MISSING %s
+
+// Directories which aren't listed are searched as usual.
+// RUN: printf '%t/listed\n' > %t/listing-other
+// RUN: %target-swift-frontend %s -parse -I %t/unlisted -search-path-listing %t/listing-other
+
+// MISSING: error: no such module 'struct_with_operators'
+
+import struct_with_operators
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t %t.icp
+// RUN: mkdir -p %t
+// RUN: %swift -emit-module -o %t/test_module.swiftmodule %S/Inputs/test_module.swift
+
+// The first request indexes the module and stores the results, the second
+// one replays them.
+// RUN: %sourcekitd-test -req=index.cache.ondisk -cache-path=%t.icp == -req=index %t/test_module.swiftmodule | %sed_clean > %t.response1
+// RUN: ls %t.icp | FileCheck %s -check-prefix=CACHE
+// RUN: %sourcekitd-test -req=index.cache.ondisk -cache-path=%t.icp == -req=index %t/test_module.swiftmodule | %sed_clean > %t.response2
+// RUN: diff -u %t.response1 %t.response2
+// RUN: FileCheck %s < %t.response2
+
+// CACHE: test_module.swiftmodule-{{[0-9a-f]+}}.index
+
+// CHECK:      key.kind: source.lang.swift.decl.class,
+// CHECK-NEXT: key.name: "TwoInts",
+// CHECK-NEXT: key.usr: "s:C11test_module7TwoInts",
@@ -0,0 +1,18 @@
+// RUN: %sourcekitd-test -req=statistics | FileCheck %s -check-prefix=EMPTY
+
+// EMPTY: key.ast_count: 0
+// EMPTY: key.memory_cost: 0
+// EMPTY: key.cache_hits: 0
+// EMPTY: key.cache_misses: 0
+// EMPTY: key.cache_evictions: 0
+
+// RUN: %sourcekitd-test -req=sema %s -- %s == -req=statistics | FileCheck %s -check-prefix=AFTER-SEMA
+
+// AFTER-SEMA: key.ast_count: 1
+// AFTER-SEMA: key.cache_misses: 1
+// AFTER-SEMA: key.operations: [
+// AFTER-SEMA: key.name: "PerformSema"
+// AFTER-SEMA: key.name: "InvocationSetup"
+// AFTER-SEMA: key.name: "ASTBuild"
+
+func foo() {}
@@ -0,0 +1,26 @@
+// RUN: %target-parse-verify-swift
+
+@_inlineable public func publicInlineable() {}
+
+@_inlineable @_versioned func versionedInlineable() {}
+
+@_inlineable func internalInlineable() {}
+// expected-error@-1 {{@_inlineable can only be applied to public declarations}}
+
+@_inlineable private func privateInlineable() {}
+// expected-error@-1 {{@_inlineable can only be applied to public declarations}}
+
+public protocol P {
+  @_inlineable func requirement()
+  // expected-error@-1 {{@_inlineable is not supported on declarations within protocols}}
+}
+
+public class C {
+  @_inlineable public init() {}
+
+  @_inlineable public dynamic func dynamicMethod() {}
+  // expected-error@-1 {{@_inlineable cannot be applied to 'dynamic' declarations}}
+}
+
+@_inlineable public struct S {}
+// expected-error@-1 {{cannot be applied to this declaration}}
@@ -359,6 +359,21 @@ public:
   virtual bool handleDiagnostic(const DiagnosticEntryInfo &Info) = 0;
 };
 
+struct ASTCacheStatistics {
+  /// The number of ASTs currently cached.
+  unsigned NumASTs = 0;
+  /// The measured memory cost of the cached ASTs, in bytes.
+  uint64_t MemoryCost = 0;
+  /// The memory budget for cached ASTs in bytes, or 0 if there is none.
+  uint64_t MemoryBudget = 0;
+  /// The number of AST requests served by an existing AST.
+  uint64_t Hits = 0;
+  /// The number of AST requests that had to build or rebuild the AST.
+  uint64_t Misses = 0;
+  /// The number of ASTs dropped to stay within the memory budget.
+  uint64_t Evictions = 0;
+};
+
 class LangSupport {
   virtual void anchor();
 
@@ -373,6 +388,10 @@ public:
                            ArrayRef<const char *> Args,
                            StringRef Hash) = 0;
 
+  /// Stores the results of indexing module files in \p path, so that a
+  /// module is only indexed again when it or the arguments change.
+  virtual void indexCacheOnDisk(StringRef path) = 0;
+
   virtual void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                             CodeCompletionConsumer &Consumer,
                             ArrayRef<const char *> Args) = 0;
@@ -473,6 +492,8 @@ public:
                           ArrayRef<const char *> Args,
                           DocInfoConsumer &Consumer) = 0;
 
+  virtual ASTCacheStatistics getASTCacheStatistics() = 0;
+
   static std::unique_ptr<LangSupport> createSwiftLangSupport(
                                                      SourceKit::Context &SKCtx);
 };
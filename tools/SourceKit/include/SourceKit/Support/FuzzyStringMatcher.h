@@ -32,6 +32,8 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The \c getCharacterMask of the pattern.
+  uint64_t patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -39,6 +41,19 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Returns a mask of the character classes that occur in \p str, ignoring
+  /// case.
+  ///
+  /// Compute this once per candidate and check it with
+  /// \c mayMatchCharacterMask before calling \c matchesCandidate.
+  static uint64_t getCharacterMask(StringRef str);
+
+  /// Whether a candidate with character mask \p candidateMask could match
+  /// the pattern.  If this returns false, \c matchesCandidate would too.
+  bool mayMatchCharacterMask(uint64_t candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
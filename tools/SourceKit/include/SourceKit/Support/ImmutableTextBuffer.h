@@ -21,12 +21,17 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -72,6 +77,10 @@ private:
 class ImmutableTextBuffer : public ImmutableTextUpdate {
   std::unique_ptr<llvm::SourceMgr> SrcMgr;
   unsigned BufId;
+  /// Byte offsets of the start of each line, built on first use by
+  /// \c getLineAndColumn.
+  mutable std::vector<unsigned> LineStarts;
+  mutable llvm::sys::Mutex LineStartsMtx;
 
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
@@ -157,9 +166,16 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   ImmutableTextBufferRef Root;
   ImmutableTextUpdateRef CurrUpd;
   std::string Filename;
+  /// The text after the latest edit, kept up to date as edits come in so
+  /// that getting a buffer for the latest snapshot doesn't need to replay
+  /// them. Created on the first edit.
+  std::unique_ptr<clang::RewriteRope> LatestText;
+  /// The edit that \c LatestText reflects.
+  ImmutableTextUpdateRef LatestTextUpd;
 
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
@@ -175,9 +191,12 @@ public:
                                    StringRef Text);
 
 private:
-  ImmutableTextSnapshotRef addAtomicUpdate(ImmutableTextUpdateRef NewUpd);
+  ImmutableTextSnapshotRef
+  addAtomicUpdate(ReplaceImmutableTextUpdateRef NewUpd);
   ImmutableTextBufferRef getBufferForSnapshot(
       const ImmutableTextSnapshot &Snap);
+  std::unique_ptr<llvm::MemoryBuffer>
+  replayUpdates(const ImmutableTextSnapshot &Snap);
   void refresh();
   friend class ImmutableTextSnapshot;
 };
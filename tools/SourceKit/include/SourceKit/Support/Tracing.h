@@ -16,6 +16,7 @@
 #include "SourceKit/Support/UIdent.h"
 #include "llvm/ADT/Optional.h"
 
+#include <chrono>
 #include <vector>
 
 namespace SourceKit {
@@ -49,6 +50,13 @@ enum class OperationKind : uint64_t {
   OpenHeaderInterface,
 
   CodeCompletionInit,
+
+  // Phases of handling a request, which are only timed (see TimedOperation).
+  RequestQueueWait,
+  Request,
+  InvocationSetup,
+  ASTBuild,
+  ResponseSerialization,
 };
   
 typedef std::vector<std::pair<std::string, std::string>> StringPairs;
@@ -95,6 +103,44 @@ void operationFinished(uint64_t OpId);
 // Register trace consumer.
 void registerConsumer(TraceConsumer *Consumer);
 
+// Name of the operation kind, for reports
+llvm::StringRef getOperationKindName(OperationKind OpKind);
+
+// Wall-clock time spent in one kind of operation since startup
+struct OperationStatistics {
+  OperationKind Kind;
+  uint64_t Count = 0;
+  uint64_t TotalMicroseconds = 0;
+  uint64_t MaxMicroseconds = 0;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Record that an operation ran from Start to End. This is independent of
+// enabled(); if the SOURCEKIT_CHROME_TRACE_FILE environment variable is set,
+// the operation is also written to that file as a Chrome trace event.
+void recordOperationTime(OperationKind OpKind, Clock::time_point Start,
+                         Clock::time_point End);
+
+// Statistics for every kind of operation recorded so far
+std::vector<OperationStatistics> getOperationStatistics();
+
+// Records the time spent in a scope with recordOperationTime
+class TimedOperation final {
+  OperationKind OpKind;
+  Clock::time_point Start;
+
+public:
+  explicit TimedOperation(OperationKind OpKind)
+    : OpKind(OpKind), Start(Clock::now()) {}
+  ~TimedOperation() {
+    recordOperationTime(OpKind, Start, Clock::now());
+  }
+
+  TimedOperation(const TimedOperation &) = delete;
+  TimedOperation &operator=(const TimedOperation &) = delete;
+};
+
 // Class that utilizes the RAII idiom for the operations being traced
 class TracedOperation final {
   llvm::Optional<uint64_t> OpId;
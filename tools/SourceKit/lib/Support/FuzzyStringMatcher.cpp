@@ -22,7 +22,8 @@ using clang::isUppercase;
 using clang::isLowercase;
 
 FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
-    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)) {
+    : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)),
+      patternMask(getCharacterMask(pattern_)) {
   lowercasePattern.reserve(pattern.size());
   unsigned upperCharCount = 0;
   for (char c : pattern) {
@@ -50,6 +51,26 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  // One bit for each letter (ignoring case), digit and '_'; every other byte
+  // shares the top bit.  A pattern character only matches the same character
+  // in the candidate, modulo case, so the pattern's classes must be a subset
+  // of the candidate's.
+  uint64_t mask = 0;
+  for (char c : str) {
+    char lower = toLowercase(c);
+    if (lower >= 'a' && lower <= 'z')
+      mask |= uint64_t(1) << (lower - 'a');
+    else if (c >= '0' && c <= '9')
+      mask |= uint64_t(1) << (26 + c - '0');
+    else if (c == '_')
+      mask |= uint64_t(1) << 36;
+    else
+      mask |= uint64_t(1) << 63;
+  }
+  return mask;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
@@ -14,6 +14,7 @@
 #include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -51,12 +52,31 @@ const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  StringRef Text = getText();
+  if (ByteOffset > Text.size())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  // Diagnostics ask for offsets in no particular order, so look the line up
+  // in a table rather than have SourceMgr scan for it.
+  llvm::sys::ScopedLock L(LineStartsMtx);
+  if (LineStarts.empty()) {
+    LineStarts.push_back(0);
+    for (size_t Pos = Text.find('\n'); Pos != StringRef::npos;
+         Pos = Text.find('\n', Pos + 1))
+      LineStarts.push_back(Pos + 1);
+  }
+
+  auto LineI =
+      std::upper_bound(LineStarts.begin(), LineStarts.end(), ByteOffset) - 1;
+  unsigned Line = LineI - LineStarts.begin() + 1;
+
+  // Match SourceMgr, which also starts a new column after a lone '\r'.
+  StringRef LinePrefix = Text.slice(*LineI, ByteOffset);
+  size_t LastNewline = LinePrefix.find_last_of("\n\r");
+  unsigned Column = LastNewline == StringRef::npos
+                        ? LinePrefix.size() + 1
+                        : LinePrefix.size() - LastNewline;
+  return std::make_pair(Line, Column);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -125,6 +145,8 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   CurrUpd = Root;
 }
 
+EditableTextBuffer::~EditableTextBuffer() {}
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -132,7 +154,7 @@ ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
 
 ImmutableTextSnapshotRef EditableTextBuffer::insert(unsigned ByteOffset,
     StringRef Text) {
-  ImmutableTextUpdateRef NewUpd =
+  ReplaceImmutableTextUpdateRef NewUpd =
       new ReplaceImmutableTextUpdate(ByteOffset, /*Length=*/0, Text,
                                      ++Generation);
   return addAtomicUpdate(std::move(NewUpd));
@@ -140,7 +162,7 @@ ImmutableTextSnapshotRef EditableTextBuffer::insert(unsigned ByteOffset,
 
 ImmutableTextSnapshotRef EditableTextBuffer::erase(unsigned ByteOffset,
                                                    unsigned Length) {
-  ImmutableTextUpdateRef NewUpd =
+  ReplaceImmutableTextUpdateRef NewUpd =
       new ReplaceImmutableTextUpdate(ByteOffset, Length, StringRef(),
                                      ++Generation);
   return addAtomicUpdate(std::move(NewUpd));
@@ -149,18 +171,30 @@ ImmutableTextSnapshotRef EditableTextBuffer::erase(unsigned ByteOffset,
 ImmutableTextSnapshotRef EditableTextBuffer::replace(unsigned ByteOffset,
                                                      unsigned Length,
                                                      StringRef Text) {
-  ImmutableTextUpdateRef NewUpd =
+  ReplaceImmutableTextUpdateRef NewUpd =
       new ReplaceImmutableTextUpdate(ByteOffset, Length, Text, ++Generation);
   return addAtomicUpdate(std::move(NewUpd));
 }
 
 ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
-    ImmutableTextUpdateRef NewUpd) {
+    ReplaceImmutableTextUpdateRef NewUpd) {
 
   llvm::sys::ScopedLock L(EditMtx);
 
   refresh();
 
+  // Nothing has been applied since the last buffer when this is the first
+  // edit, so the latest text is still the root's.
+  if (!LatestText) {
+    StringRef RootText = Root->getText();
+    LatestText.reset(new RewriteRope());
+    LatestText->assign(RootText.begin(), RootText.end());
+  }
+  LatestText->erase(NewUpd->getByteOffset(), NewUpd->getLength());
+  StringRef Text = NewUpd->getText();
+  LatestText->insert(NewUpd->getByteOffset(), Text.begin(), Text.end());
+  LatestTextUpd = NewUpd;
+
   assert(CurrUpd->Next == nullptr);
   CurrUpd->Next = NewUpd;
   CurrUpd = NewUpd;
@@ -198,6 +232,29 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
+  std::unique_ptr<llvm::MemoryBuffer> MemBuf;
+  {
+    llvm::sys::ScopedLock L(EditMtx);
+    if (LatestTextUpd == Snap.DiffEnd)
+      MemBuf = getMemBufferFromRope(getFilename(), *LatestText);
+  }
+  if (!MemBuf)
+    MemBuf = replayUpdates(Snap);
+
+  ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
+                                                          Snap.getStamp());
+
+  {
+    llvm::sys::ScopedLock L(EditMtx);
+    ImmBuf->Next = Snap.DiffEnd->Next;
+    Snap.DiffEnd->Next = ImmBuf;
+    refresh();
+  }
+  return ImmBuf;
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+EditableTextBuffer::replayUpdates(const ImmutableTextSnapshot &Snap) {
   // Check if a buffer was created in the middle of the snapshot updates.
   ImmutableTextBufferRef StartBuf = Snap.BufferStart;
   ImmutableTextUpdateRef Upd = StartBuf;  
@@ -224,17 +281,7 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     applyUpdate(Upd);
   }
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
-  ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
-                                                          Snap.getStamp());
-
-  {
-    llvm::sys::ScopedLock L(EditMtx);
-    ImmBuf->Next = Snap.DiffEnd->Next;
-    Snap.DiffEnd->Next = ImmBuf;
-    refresh();
-  }
-  return ImmBuf;
+  return getMemBufferFromRope(getFilename(), Rope);
 }
 
 // This should always be called under the mutex lock.
@@ -14,8 +14,16 @@
 
 #include "swift/Frontend/Frontend.h"
 
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/YAMLTraits.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -91,3 +99,117 @@ void trace::registerConsumer(trace::TraceConsumer *Consumer) {
                                             std::memory_order_release,
                                             std::memory_order_relaxed));
 }
+
+//===----------------------------------------------------------------------===//
+// Operation statistics
+//===----------------------------------------------------------------------===//
+
+StringRef trace::getOperationKindName(trace::OperationKind OpKind) {
+  switch (OpKind) {
+  case OperationKind::SimpleParse: return "SimpleParse";
+  case OperationKind::PerformSema: return "PerformSema";
+  case OperationKind::AnnotAndDiag: return "AnnotAndDiag";
+  case OperationKind::ReadSyntaxInfo: return "ReadSyntaxInfo";
+  case OperationKind::ReadDiagnostics: return "ReadDiagnostics";
+  case OperationKind::ReadSemanticInfo: return "ReadSemanticInfo";
+  case OperationKind::IndexModule: return "IndexModule";
+  case OperationKind::IndexSource: return "IndexSource";
+  case OperationKind::CursorInfoForIFaceGen: return "CursorInfoForIFaceGen";
+  case OperationKind::CursorInfoForSource: return "CursorInfoForSource";
+  case OperationKind::ExpandPlaceholder: return "ExpandPlaceholder";
+  case OperationKind::FormatText: return "FormatText";
+  case OperationKind::RelatedIdents: return "RelatedIdents";
+  case OperationKind::CodeCompletion: return "CodeCompletion";
+  case OperationKind::OpenInterface: return "OpenInterface";
+  case OperationKind::OpenHeaderInterface: return "OpenHeaderInterface";
+  case OperationKind::CodeCompletionInit: return "CodeCompletionInit";
+  case OperationKind::RequestQueueWait: return "RequestQueueWait";
+  case OperationKind::Request: return "Request";
+  case OperationKind::InvocationSetup: return "InvocationSetup";
+  case OperationKind::ASTBuild: return "ASTBuild";
+  case OperationKind::ResponseSerialization: return "ResponseSerialization";
+  }
+  llvm_unreachable("unhandled operation kind");
+}
+
+static const unsigned NumOperationKinds =
+    unsigned(trace::OperationKind::ResponseSerialization) + 1;
+
+namespace {
+struct OperationTimes {
+  std::mutex Mtx;
+  trace::OperationStatistics Stats[NumOperationKinds];
+
+  std::once_flag ChromeTraceOnce;
+  std::unique_ptr<raw_fd_ostream> ChromeTrace;
+  trace::Clock::time_point ChromeTraceStart;
+
+  void openChromeTrace();
+};
+}
+
+static OperationTimes &getOperationTimes() {
+  static OperationTimes Times;
+  return Times;
+}
+
+void OperationTimes::openChromeTrace() {
+  const char *Path = ::getenv("SOURCEKIT_CHROME_TRACE_FILE");
+  if (!Path || !*Path)
+    return;
+
+  std::error_code EC;
+  ChromeTrace.reset(new raw_fd_ostream(Path, EC, sys::fs::F_Text));
+  if (EC) {
+    ChromeTrace.reset();
+    return;
+  }
+  ChromeTraceStart = trace::Clock::now();
+  // The trailing ']' is optional in the Chrome trace format, so the file
+  // stays valid without having to be closed.
+  *ChromeTrace << "[\n";
+  ChromeTrace->flush();
+}
+
+void trace::recordOperationTime(trace::OperationKind OpKind,
+                                trace::Clock::time_point Start,
+                                trace::Clock::time_point End) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  uint64_t Duration = duration_cast<microseconds>(End - Start).count();
+
+  OperationTimes &Times = getOperationTimes();
+  std::call_once(Times.ChromeTraceOnce, [&] { Times.openChromeTrace(); });
+
+  std::lock_guard<std::mutex> L(Times.Mtx);
+  OperationStatistics &Stats = Times.Stats[unsigned(OpKind)];
+  ++Stats.Count;
+  Stats.TotalMicroseconds += Duration;
+  Stats.MaxMicroseconds = std::max(Stats.MaxMicroseconds, Duration);
+
+  if (Times.ChromeTrace) {
+    auto Timestamp = Start - Times.ChromeTraceStart;
+    // Start may precede the trace itself for the first operation.
+    int64_t TimestampUS = duration_cast<microseconds>(Timestamp).count();
+    uint32_t ThreadID = std::hash<std::thread::id>()(std::this_thread::get_id());
+    *Times.ChromeTrace << "{\"name\":\"" << getOperationKindName(OpKind)
+                       << "\",\"cat\":\"sourcekit\",\"ph\":\"X\",\"ts\":"
+                       << std::max<int64_t>(TimestampUS, 0)
+                       << ",\"dur\":" << Duration
+                       << ",\"pid\":1,\"tid\":" << ThreadID << "},\n";
+    Times.ChromeTrace->flush();
+  }
+}
+
+std::vector<trace::OperationStatistics> trace::getOperationStatistics() {
+  OperationTimes &Times = getOperationTimes();
+  std::vector<OperationStatistics> Result;
+  std::lock_guard<std::mutex> L(Times.Mtx);
+  for (unsigned I = 0; I != NumOperationKinds; ++I) {
+    if (!Times.Stats[I].Count)
+      continue;
+    Result.push_back(Times.Stats[I]);
+    Result.back().Kind = OperationKind(I);
+  }
+  return Result;
+}
@@ -79,6 +79,7 @@ class Completion : public SwiftResult {
   PopularityFactor popularityFactor;
   StringRef name;
   StringRef description;
+  uint64_t nameCharacterMask = 0;
   friend class CompletionBuilder;
 
 public:
@@ -95,6 +96,8 @@ public:
   void *getCustomKind() const { return opaqueCustomKind; }
   StringRef getName() const { return name; }
   StringRef getDescription() const { return description; }
+  /// The \c FuzzyStringMatcher::getCharacterMask of the name.
+  uint64_t getNameCharacterMask() const { return nameCharacterMask; }
   Optional<uint8_t> getModuleImportDepth() const { return moduleImportDepth; }
 
   /// A popularity factory in the range [-1, 1]. The higher the value, the more
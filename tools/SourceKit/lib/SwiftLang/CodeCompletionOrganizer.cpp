@@ -591,7 +591,9 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
     bool match = false;
     if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
-      match = pattern.matchesCandidate(completion->getName());
+      match =
+          pattern.mayMatchCharacterMask(completion->getNameCharacterMask()) &&
+          pattern.matchesCandidate(completion->getName());
     } else {
       match = completion->getName().startswith_lower(filterText);
     }
@@ -1320,6 +1322,8 @@ Completion *CompletionBuilder::finish() {
   result->moduleImportDepth = moduleImportDepth;
   result->popularityFactor = popularityFactor;
   result->opaqueCustomKind = customKind;
+  result->nameCharacterMask =
+      FuzzyStringMatcher::getCharacterMask(result->getName());
   return result;
 }
 
@@ -20,6 +20,7 @@
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
 
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/Basic/Cache.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -29,10 +30,12 @@
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 
+#include "clang/AST/ASTContext.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SourceMgr.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -155,8 +158,11 @@ void InvocationOptions::profile(llvm::FoldingSetNodeID &ID) const {
 
 namespace SourceKit {
   struct ASTUnit::Implementation {
-    const uint64_t Generation;
+    uint64_t Generation;
     SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+    /// Guards Generation and Snapshots, which are updated when the AST is
+    /// reused for snapshots with unchanged text.
+    mutable llvm::sys::Mutex SnapshotsMtx;
     EditorDiagConsumer CollectDiagConsumer;
     CompilerInstance CompInst;
     OwnedResolver TypeResolver{ nullptr, nullptr };
@@ -194,11 +200,13 @@ namespace SourceKit {
     return Impl.CompInst;
   }
 
-   uint64_t ASTUnit::getGeneration() const {
+  uint64_t ASTUnit::getGeneration() const {
+    llvm::sys::ScopedLock L(Impl.SnapshotsMtx);
     return Impl.Generation;
   }
 
-  ArrayRef<ImmutableTextSnapshotRef> ASTUnit::getSnapshots() const {
+  SmallVector<ImmutableTextSnapshotRef, 4> ASTUnit::getSnapshots() const {
+    llvm::sys::ScopedLock L(Impl.SnapshotsMtx);
     return Impl.Snapshots;
   }
 
@@ -209,6 +217,27 @@ namespace SourceKit {
   EditorDiagConsumer &ASTUnit::getEditorDiagConsumer() const {
     return Impl.CollectDiagConsumer;
   }
+
+  size_t ASTUnit::getMemoryCost() const {
+    size_t Cost = sizeof(*this) + sizeof(Impl);
+    CompilerInstance &CompInst = Impl.CompInst;
+    if (!CompInst.hasASTContext())
+      return Cost;
+
+    ASTContext &Ctx = CompInst.getASTContext();
+    Cost += Ctx.getTotalMemory();
+    if (auto ClangLoader = Ctx.getClangModuleLoader()) {
+      clang::ASTContext &ClangCtx = ClangLoader->getClangASTContext();
+      Cost += ClangCtx.getASTAllocatedMemory() +
+              ClangCtx.getSideTableAllocatedMemory();
+    }
+
+    const llvm::SourceMgr &LLVMSrcMgr =
+        CompInst.getSourceMgr().getLLVMSourceMgr();
+    for (unsigned ID = 1, E = LLVMSrcMgr.getNumBuffers(); ID <= E; ++ID)
+      Cost += LLVMSrcMgr.getMemoryBuffer(ID)->getBufferSize();
+    return Cost;
+  }
 }
 
 namespace {
@@ -236,6 +265,11 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
   llvm::sys::Mutex Mtx;
 
+  /// Builds of this AST are serialized on its own queue, so that a slow
+  /// build of one file doesn't hold up building the AST for another.
+  WorkQueue BuildQueue{ WorkQueue::Dequeuing::Serial,
+                        "sourcekit.swift.ASTBuilding" };
+
 public:
   explicit ASTProducer(SwiftInvocationRef InvokRef)
     : InvokRef(std::move(InvokRef)) {}
@@ -256,10 +290,10 @@ public:
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
 
   size_t getMemoryCost() const {
-    // FIXME: Report the memory cost of the overall CompilerInstance.
-    if (AST && AST->getCompilerInstance().hasASTContext())
-      return AST->Impl.CompInst.getASTContext().getTotalMemory();
-    return sizeof(*this) + sizeof(*AST);
+    // FIXME: ThreadSafeRefCntPtr is racy.
+    if (AST)
+      return sizeof(*this) + AST->getMemoryCost();
+    return sizeof(*this);
   }
 
 private:
@@ -270,6 +304,10 @@ private:
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                            std::string &Error);
+
+  bool adoptUnchangedInputs(SwiftASTManager::Implementation &MgrImpl,
+                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                            ArrayRef<BufferStamp> InputStamps);
 };
 
 typedef IntrusiveRefCntPtr<ASTProducer> ASTProducerRef;
@@ -299,10 +337,25 @@ struct CacheKeyHashInfo<ASTKey> {
 } // namespace sys
 } // namespace swift.
 
+/// Returns the memory budget for cached ASTs that the
+/// SOURCEKIT_AST_CACHE_BUDGET_MB environment variable sets, in bytes, or 0 if
+/// it isn't set.
+static size_t getMemoryBudgetFromEnvironment() {
+  const char *EnvOpt = ::getenv("SOURCEKIT_AST_CACHE_BUDGET_MB");
+  if (!EnvOpt)
+    return 0;
+
+  unsigned Megabytes;
+  if (StringRef(EnvOpt).getAsInteger(10, Megabytes))
+    return 0;
+  return size_t(Megabytes) << 20;
+}
+
 struct SwiftASTManager::Implementation {
   explicit Implementation(SwiftLangSupport &LangSupport)
     : EditorDocs(LangSupport.getEditorDocuments()),
-      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()) { }
+      RuntimeResourcePath(LangSupport.getRuntimeResourcePath()),
+      MemoryBudget(getMemoryBudgetFromEnvironment()) { }
 
   SwiftEditorDocumentFileMap &EditorDocs;
   std::string RuntimeResourcePath;
@@ -310,8 +363,24 @@ struct SwiftASTManager::Implementation {
   Cache<ASTKey, ASTProducerRef> ASTCache{ "sourcekit.swift.ASTCache" };
   llvm::sys::Mutex CacheMtx;
 
-  WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Serial,
-                           "sourcekit.swift.ASTBuilding" };
+  /// The keys of the ASTs in ASTCache, least recently used first. Guarded by
+  /// CacheMtx.
+  ///
+  /// The cache may also evict ASTs on its own under memory pressure; their
+  /// keys are dropped from here the next time the cost is measured.
+  std::vector<ASTKey> KeysByUse;
+  /// The total memory cost the cached ASTs may have, in bytes, or 0 for no
+  /// limit.
+  const size_t MemoryBudget;
+
+  std::atomic<uint64_t> NumHits{ 0 };
+  std::atomic<uint64_t> NumMisses{ 0 };
+  std::atomic<uint64_t> NumEvictions{ 0 };
+
+  void markUsed(const ASTKey &Key);
+  void forget(const ASTKey &Key);
+  size_t measureCachedCost();
+  void enforceMemoryBudget(const ASTKey &KeepKey);
 
   ASTProducerRef getASTProducer(SwiftInvocationRef InvokRef);
   FileContent getFileContent(StringRef FilePath, std::string &Error);
@@ -455,6 +524,7 @@ SwiftInvocationRef
 SwiftASTManager::getInvocation(ArrayRef<const char *> OrigArgs,
                                StringRef PrimaryFile,
                                std::string &Error) {
+  trace::TimedOperation TimedOp(trace::OperationKind::InvocationSetup);
   CompilerInvocation CompInvok;
   if (initCompilerInvocation(CompInvok, OrigArgs, PrimaryFile, Error)) {
     return nullptr;
@@ -473,6 +543,7 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
 
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
     if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
+      ++Impl.NumHits;
       Unit->Impl.consumeAsync(std::move(ASTConsumer), Unit);
       return;
     }
@@ -494,12 +565,29 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
 }
 
 void SwiftASTManager::removeCachedAST(SwiftInvocationRef Invok) {
+  llvm::sys::ScopedLock L(Impl.CacheMtx);
   Impl.ASTCache.remove(Invok->Impl.Key);
+  Impl.forget(Invok->Impl.Key);
+}
+
+ASTCacheStatistics SwiftASTManager::getStatistics() {
+  ASTCacheStatistics Stats;
+  {
+    llvm::sys::ScopedLock L(Impl.CacheMtx);
+    Stats.MemoryCost = Impl.measureCachedCost();
+    Stats.NumASTs = Impl.KeysByUse.size();
+  }
+  Stats.MemoryBudget = Impl.MemoryBudget;
+  Stats.Hits = Impl.NumHits;
+  Stats.Misses = Impl.NumMisses;
+  Stats.Evictions = Impl.NumEvictions;
+  return Stats;
 }
 
 ASTProducerRef
 SwiftASTManager::Implementation::getASTProducer(SwiftInvocationRef InvokRef) {
   llvm::sys::ScopedLock L(CacheMtx);
+  markUsed(InvokRef->Impl.Key);
   llvm::Optional<ASTProducerRef> OptProducer = ASTCache.get(InvokRef->Impl.Key);
   if (OptProducer.hasValue())
     return OptProducer.getValue();
@@ -508,6 +596,56 @@ SwiftASTManager::Implementation::getASTProducer(SwiftInvocationRef InvokRef) {
   return Producer;
 }
 
+void SwiftASTManager::Implementation::markUsed(const ASTKey &Key) {
+  forget(Key);
+  KeysByUse.push_back(Key);
+}
+
+void SwiftASTManager::Implementation::forget(const ASTKey &Key) {
+  auto I = std::find_if(KeysByUse.begin(), KeysByUse.end(),
+                        [&](const ASTKey &Other) {
+                          return Other.FSID == Key.FSID;
+                        });
+  if (I != KeysByUse.end())
+    KeysByUse.erase(I);
+}
+
+size_t SwiftASTManager::Implementation::measureCachedCost() {
+  size_t Cost = 0;
+  for (auto I = KeysByUse.begin(); I != KeysByUse.end();) {
+    llvm::Optional<ASTProducerRef> Producer = ASTCache.get(*I);
+    if (!Producer.hasValue()) {
+      I = KeysByUse.erase(I);
+      continue;
+    }
+    Cost += Producer.getValue()->getMemoryCost();
+    ++I;
+  }
+  return Cost;
+}
+
+/// Drops the least recently used ASTs, other than the one for \p KeepKey,
+/// until the cached ASTs fit in the memory budget.
+void SwiftASTManager::Implementation::enforceMemoryBudget(
+    const ASTKey &KeepKey) {
+  if (MemoryBudget == 0)
+    return;
+
+  size_t Cost = measureCachedCost();
+  for (auto I = KeysByUse.begin();
+       Cost > MemoryBudget && I != KeysByUse.end();) {
+    if (I->FSID == KeepKey.FSID) {
+      ++I;
+      continue;
+    }
+    if (auto Producer = ASTCache.get(*I))
+      Cost -= Producer.getValue()->getMemoryCost();
+    ASTCache.remove(*I);
+    I = KeysByUse.erase(I);
+    ++NumEvictions;
+  }
+}
+
 static FileContent getFileContentFromSnap(ImmutableTextSnapshotRef Snap,
                                           StringRef FilePath) {
   auto Buf = llvm::MemoryBuffer::getMemBufferCopy(
@@ -564,7 +702,7 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
   SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
   Snapshots.append(Snaps.begin(), Snaps.end());
 
-  MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
+  BuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
     std::string Error;
     ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
     Receiver(Unit, Error);
@@ -600,7 +738,12 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       // Re-register the object with the cache to update its memory cost.
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
+      MgrImpl.markUsed(InvokRef->Impl.Key);
+      MgrImpl.enforceMemoryBudget(InvokRef->Impl.Key);
     }
+    ++MgrImpl.NumMisses;
+  } else {
+    ++MgrImpl.NumHits;
   }
 
   return AST;
@@ -652,14 +795,15 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
       InputStamps.push_back(MgrImpl.getBufferStamp(File));
   }
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
-  if (Stamps != InputStamps)
-    return true;
 
   for (auto &Dependency : DependencyStamps) {
     if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
       return true;
   }
 
+  if (Stamps != InputStamps)
+    return !adoptUnchangedInputs(MgrImpl, Snapshots, InputStamps);
+
   return false;
 }
 
@@ -717,6 +861,7 @@ static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                       std::string &Error) {
+  trace::TimedOperation TimedOp(trace::OperationKind::ASTBuild);
   Stamps.clear();
   DependencyStamps.clear();
 
@@ -793,7 +938,10 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
-  CompIns.performSema();
+  {
+    trace::TimedOperation TimedSema(trace::OperationKind::PerformSema);
+    CompIns.performSema();
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -838,3 +986,64 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
 
   return ASTRef;
 }
+
+/// If every input whose stamp changed since the AST was built is an editor
+/// document whose text is the same as the snapshot the AST was built from,
+/// as happens when an edit is undone or a document's text is replaced with
+/// itself, move the AST over to the new snapshots instead of rebuilding it.
+///
+/// The AST gets a new generation, so consumers that track the generation
+/// they last processed treat it as a new AST for the new snapshots.
+///
+/// 
+eturns true if the AST was adopted for the new inputs.
+bool ASTProducer::adoptUnchangedInputs(
+    SwiftASTManager::Implementation &MgrImpl,
+    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+    ArrayRef<BufferStamp> InputStamps) {
+  const InvocationOptions &Opts = InvokRef->Impl.Opts;
+  auto &Inputs = Opts.Invok.getInputFilenames();
+  assert(Stamps.size() == Inputs.size() && InputStamps.size() == Inputs.size());
+
+  SmallVector<ImmutableTextSnapshotRef, 4> NewSnapshots = AST->getSnapshots();
+  for (unsigned I = 0, E = Inputs.size(); I != E; ++I) {
+    if (Stamps[I] == InputStamps[I])
+      continue;
+
+    ImmutableTextSnapshotRef NewSnap;
+    for (auto &Snap : Snapshots) {
+      if (Snap->getFilename() == Inputs[I]) {
+        NewSnap = Snap;
+        break;
+      }
+    }
+    if (!NewSnap) {
+      std::string FilePath = SwiftLangSupport::resolvePathSymlinks(Inputs[I]);
+      if (auto EditorDoc = MgrImpl.EditorDocs.findByPath(FilePath))
+        NewSnap = EditorDoc->getLatestSnapshot();
+    }
+    // We don't keep the text of files that were read from disk.
+    if (!NewSnap)
+      return false;
+
+    auto OldSnap = std::find_if(NewSnapshots.begin(), NewSnapshots.end(),
+        [&](const ImmutableTextSnapshotRef &Snap) {
+          return Snap->isFromSameBuffer(NewSnap);
+        });
+    if (OldSnap == NewSnapshots.end() ||
+        (*OldSnap)->getBuffer()->getText() != NewSnap->getBuffer()->getText())
+      return false;
+    *OldSnap = NewSnap;
+  }
+
+  LOG_INFO_FUNC(High, "AST reused for unchanged text: "
+                << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile);
+
+  Stamps.assign(InputStamps.begin(), InputStamps.end());
+  {
+    llvm::sys::ScopedLock L(AST->Impl.SnapshotsMtx);
+    AST->Impl.Generation = ++ASTUnitGeneration;
+    AST->Impl.Snapshots = std::move(NewSnapshots);
+  }
+  return true;
+}
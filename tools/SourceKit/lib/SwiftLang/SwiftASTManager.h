@@ -16,6 +16,7 @@
 #include "SwiftInvocation.h"
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include <string>
 
@@ -32,6 +33,7 @@ namespace swift {
 }
 
 namespace SourceKit {
+  struct ASTCacheStatistics;
   class Context;
   struct DiagnosticEntryInfo;
   class ImmutableTextSnapshot;
@@ -52,9 +54,16 @@ public:
 
   swift::CompilerInstance &getCompilerInstance() const;
   uint64_t getGeneration() const;
-  ArrayRef<ImmutableTextSnapshotRef> getSnapshots() const;
+  /// The snapshots the AST was built from. These move forward to newer
+  /// snapshots of the same text when an AST is reused, so they are returned
+  /// by value.
+  SmallVector<ImmutableTextSnapshotRef, 4> getSnapshots() const;
   EditorDiagConsumer &getEditorDiagConsumer() const;
   swift::SourceFile &getPrimarySourceFile() const;
+
+  /// The memory used by the AST's compiler instance in bytes, counting its
+  /// ASTContext, the Clang AST it imported and its source buffers.
+  size_t getMemoryCost() const;
 };
 
 typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
@@ -114,6 +123,13 @@ public:
 
   void removeCachedAST(SwiftInvocationRef Invok);
 
+  /// Returns the size of the AST cache and how well it is being used.
+  ///
+  /// The cache's total memory cost is kept under the budget given in
+  /// megabytes by the SOURCEKIT_AST_CACHE_BUDGET_MB environment variable, if
+  /// it is set, by dropping the least recently used ASTs.
+  ASTCacheStatistics getStatistics();
+
   struct Implementation;
 
 private:
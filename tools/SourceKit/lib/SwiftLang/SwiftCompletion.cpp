@@ -109,6 +109,7 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                                   SwiftCodeCompletionConsumer &SwiftConsumer,
                                   ArrayRef<const char *> Args,
                                   std::string &Error) {
+  auto InitStart = trace::Clock::now();
 
   trace::TracedOperation TracedOp;
   if (trace::enabled()) {
@@ -185,6 +186,8 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
   }
 
   TracedOp.finish();
+  trace::recordOperationTime(trace::OperationKind::CodeCompletionInit,
+                             InitStart, trace::Clock::now());
 
   if (trace::enabled()) {
     trace::SwiftInvocation SwiftArgs;
@@ -209,7 +212,10 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
       *CI.getASTContext().getClangModuleLoader());
   SwiftConsumer.setContext(&CI.getASTContext(), &Invocation,
                            &CompletionContext);
-  CI.performSema();
+  {
+    trace::TimedOperation TimedOp(trace::OperationKind::CodeCompletion);
+    CI.performSema();
+  }
   SwiftConsumer.clearContext();
   return true;
 }
@@ -220,7 +226,7 @@ void SwiftLangSupport::codeComplete(llvm::MemoryBuffer *UnresolvedInputFile,
                                     ArrayRef<const char *> Args) {
   SwiftCodeCompletionConsumer SwiftConsumer([&](
       MutableArrayRef<CodeCompletionResult *> Results, SwiftCompletionInfo &) {
-    CodeCompletionContext::sortCompletionResults(Results);
+    // SwiftCodeCompletionConsumer has already sorted the results.
     for (auto *Result : Results) {
       if (!SwiftToSourceKitCompletionAdapter::handleResult(SKConsumer, Result))
         break;
@@ -714,6 +720,25 @@ CodeCompletion::SessionCache::getFilterRules() {
   llvm::sys::ScopedLock L(mtx);
   return filterRules;
 }
+bool CodeCompletion::SessionCache::getInnerResults(
+    Completion *exactMatch, bool addInnerResults, bool addInnerOperators,
+    InnerResults &results) {
+  llvm::sys::ScopedLock L(mtx);
+  auto I = innerResults.find(
+      std::make_tuple(exactMatch, addInnerResults, addInnerOperators));
+  if (I == innerResults.end())
+    return false;
+  results = I->second;
+  return true;
+}
+void CodeCompletion::SessionCache::setInnerResults(
+    Completion *exactMatch, bool addInnerResults, bool addInnerOperators,
+    InnerResults results, std::unique_ptr<CompletionSink> resultSink) {
+  llvm::sys::ScopedLock L(mtx);
+  innerSinks.push_back(std::move(resultSink));
+  innerResults[std::make_tuple(exactMatch, addInnerResults,
+                               addInnerOperators)] = std::move(results);
+}
 
 //===----------------------------------------------------------------------===//
 // CodeCompletion::SessionCacheMap
@@ -1036,44 +1061,56 @@ static void transformAndForwardResults(
 
   if ((options.addInnerResults || options.addInnerOperators) &&
       exactMatch && exactMatch->getKind() == Completion::Declaration) {
-    std::vector<Completion *> innerResults;
-    bool hasDot = false;
-    bool hasQDot = false;
-    bool hasInit = false;
-    SwiftCodeCompletionConsumer swiftConsumer([&](
-        MutableArrayRef<CodeCompletionResult *> results,
-        SwiftCompletionInfo &info) {
-      auto topResults = filterInnerResults(results, options.addInnerResults,
-                                           options.addInnerOperators, hasDot,
-                                           hasQDot, hasInit, rules);
-      // FIXME: Overriding the default to context "None" is a hack so that they
-      // won't overwhelm other results that also match the filter text.
-      innerResults = extendCompletions(
-          topResults, innerSink, info, nameToPopularity, options, exactMatch,
-          SemanticContextKind::None, SemanticContextKind::None);
-    });
-
-    auto *inputBuf = session->getBuffer();
-    std::string str = inputBuf->getBuffer().slice(0, offset);
-    {
-      llvm::raw_string_ostream OSS(str);
-      SwiftToSourceKitCompletionAdapter::getResultSourceText(
-          exactMatch->getCompletionString(), OSS);
-    }
+    CodeCompletion::SessionCache::InnerResults inner;
+    if (!session->getInnerResults(exactMatch, options.addInnerResults,
+                                  options.addInnerOperators, inner)) {
+      // The results outlive this request in the session, so give them a sink
+      // of their own.
+      auto resultSink = llvm::make_unique<CodeCompletion::CompletionSink>();
+      SwiftCodeCompletionConsumer swiftConsumer([&](
+          MutableArrayRef<CodeCompletionResult *> results,
+          SwiftCompletionInfo &info) {
+        auto topResults = filterInnerResults(
+            results, options.addInnerResults, options.addInnerOperators,
+            inner.hasDot, inner.hasQDot, inner.hasInit, rules);
+        // FIXME: Overriding the default to context "None" is a hack so that
+        // they won't overwhelm other results that also match the filter text.
+        inner.completions = extendCompletions(
+            topResults, *resultSink, info, nameToPopularity, options,
+            exactMatch, SemanticContextKind::None, SemanticContextKind::None);
+      });
 
-    auto buffer =
-        llvm::MemoryBuffer::getMemBuffer(str, inputBuf->getBufferIdentifier());
-    auto args = session->getCompilerArgs();
-    std::vector<const char *> cargs;
-    for (auto &arg : args)
-      cargs.push_back(arg.c_str());
-    std::string error;
-    if (!swiftCodeCompleteImpl(lang, buffer.get(), str.size(), swiftConsumer,
-                               cargs, error)) {
-      consumer.failed(error);
-      return;
+      auto *inputBuf = session->getBuffer();
+      std::string str = inputBuf->getBuffer().slice(0, offset);
+      {
+        llvm::raw_string_ostream OSS(str);
+        SwiftToSourceKitCompletionAdapter::getResultSourceText(
+            exactMatch->getCompletionString(), OSS);
+      }
+
+      auto buffer = llvm::MemoryBuffer::getMemBuffer(
+          str, inputBuf->getBufferIdentifier());
+      auto args = session->getCompilerArgs();
+      std::vector<const char *> cargs;
+      for (auto &arg : args)
+        cargs.push_back(arg.c_str());
+      std::string error;
+      if (!swiftCodeCompleteImpl(lang, buffer.get(), str.size(), swiftConsumer,
+                                 cargs, error)) {
+        consumer.failed(error);
+        return;
+      }
+
+      session->setInnerResults(exactMatch, options.addInnerResults,
+                               options.addInnerOperators, inner,
+                               std::move(resultSink));
     }
 
+    std::vector<Completion *> innerResults = std::move(inner.completions);
+    bool hasDot = inner.hasDot;
+    bool hasQDot = inner.hasQDot;
+    bool hasInit = inner.hasInit;
+
     if (options.addInnerOperators) {
       if (hasInit && !rules.hideName("("))
         innerResults.insert(innerResults.begin(), buildParen());
@@ -924,6 +924,12 @@ struct SwiftEditorDocument::Implementation {
 
   std::shared_ptr<SwiftDocumentSyntaxInfo> SyntaxInfo;
 
+  /// The compiler invocation that the last parse was set up from, kept so
+  /// that reparsing after each edit doesn't rebuild it from the arguments.
+  SwiftInvocationRef ParseInvok;
+  std::unique_ptr<CompilerInvocation> ParseCompInv;
+  std::vector<std::string> ParseArgs;
+
   std::shared_ptr<SwiftDocumentSyntaxInfo> getSyntaxInfo() {
     llvm::sys::ScopedLock L(AccessMtx);
     return SyntaxInfo;
@@ -1233,13 +1239,21 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+    if (EditedLineRange.isValid() &&
+        Offset > AffectedRange.first + AffectedRange.second) {
+      // We're past the affected range and already synced up, just return.
+      // Checking this before the line lookups below keeps the rest of the
+      // walk cheap after an edit near the top of a large file.
+      return true;
+    }
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
     // Note that the length can span multiple lines.
     unsigned Length = Node.Range.getByteLength();
 
@@ -1265,10 +1279,6 @@ public:
         AffectedRange.first -= AdjCharCount;
         AffectedRange.second += AdjCharCount;
       }
-      else if (Offset > AffectedRange.first + AffectedRange.second) {
-        // We're passed the affected range and already synced up, just return.
-        return true;
-      }
       else if (StartLine > EditedLineRange.endLine()) {
         // We're after the edited line range, let's test if we're synced up.
         if (SyntaxMap.matchesFirstTokenOnLine(StartLine, Token)) {
@@ -1661,24 +1671,29 @@ void SwiftEditorDocument::parse(ImmutableTextSnapshotRef Snapshot,
 
   assert(Impl.SemanticInfo && "Impl.SemanticInfo must be set");
 
-  std::vector<std::string> Args;
-  std::string PrimaryFile; // Ignored, Impl.FilePath will be used
+  SwiftInvocationRef Invok = Impl.SemanticInfo->getInvocation();
+  if (!Impl.ParseCompInv || Impl.ParseInvok != Invok) {
+    Impl.ParseCompInv.reset(new CompilerInvocation());
+    Impl.ParseArgs.clear();
+    std::string PrimaryFile; // Ignored, Impl.FilePath will be used
 
-  CompilerInvocation CompInv;
-  if (Impl.SemanticInfo->getInvocation()) {
-    Impl.SemanticInfo->getInvocation()->applyTo(CompInv);
-    Impl.SemanticInfo->getInvocation()->raw(Args, PrimaryFile);
-  } else {
-    ArrayRef<const char *> Args;
-    std::string Error;
-    // Ignore possible error(s)
-    Lang.getASTManager().
-      initCompilerInvocation(CompInv, Args, StringRef(), Error);
+    if (Invok) {
+      Invok->applyTo(*Impl.ParseCompInv);
+      Invok->raw(Impl.ParseArgs, PrimaryFile);
+    } else {
+      ArrayRef<const char *> Args;
+      std::string Error;
+      // Ignore possible error(s)
+      Lang.getASTManager().
+        initCompilerInvocation(*Impl.ParseCompInv, Args, StringRef(), Error);
+    }
+    Impl.ParseInvok = Invok;
   }
 
   // Access to Impl.SyntaxInfo is guarded by Impl.AccessMtx
   Impl.SyntaxInfo.reset(
-    new SwiftDocumentSyntaxInfo(CompInv, Snapshot, Args, Impl.FilePath));
+    new SwiftDocumentSyntaxInfo(*Impl.ParseCompInv, Snapshot, Impl.ParseArgs,
+                                Impl.FilePath));
 
   Impl.SyntaxInfo->parse();
 }
@@ -23,6 +23,7 @@
 #include "swift/IDE/Utils.h"
 #include "swift/Strings.h"
 
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
 
@@ -77,6 +78,13 @@ public:
   CompilerInstance Instance;
   Module *Mod = nullptr;
   SourceTextInfo Info;
+  // The options of the request the interface was generated for.
+  Optional<std::string> Group;
+  bool SynthesizedExtensions = false;
+  Optional<std::string> InterestedUSR;
+  // The files of the module, with their modification times when the interface
+  // was printed.
+  std::vector<std::pair<std::string, llvm::sys::TimeValue>> ModuleFiles;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
 };
@@ -327,6 +335,16 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
                           Group.hasValue() && SynthesizedExtensions);
 
   Info.Text = OS.str();
+
+  for (auto *File : Mod->getFiles()) {
+    auto *LF = dyn_cast<LoadedFile>(File);
+    if (!LF || LF->getFilename().empty())
+      continue;
+    llvm::sys::fs::file_status Status;
+    if (!llvm::sys::fs::status(LF->getFilename(), Status))
+      Impl.ModuleFiles.emplace_back(LF->getFilename(),
+                                    Status.getLastModificationTime());
+  }
   return false;
 }
 
@@ -388,6 +406,11 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   IFaceGenCtx->Impl.IsModule = IsModule;
   IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
   IFaceGenCtx->Impl.Invocation = Invocation;
+  if (Group)
+    IFaceGenCtx->Impl.Group = Group->str();
+  IFaceGenCtx->Impl.SynthesizedExtensions = SynthesizedExtensions;
+  if (InterestedUSR)
+    IFaceGenCtx->Impl.InterestedUSR = InterestedUSR->str();
   CompilerInstance &CI = IFaceGenCtx->Impl.Instance;
 
   // Display diagnostics to stderr.
@@ -490,6 +513,38 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::isUpToDateFor(
+    StringRef ModuleName, const swift::CompilerInvocation &Invok,
+    Optional<StringRef> Group, bool SynthesizedExtensions,
+    Optional<StringRef> InterestedUSR) {
+  if (!matches(ModuleName, Invok))
+    return false;
+
+  auto sameOption = [](const Optional<std::string> &Stored,
+                       Optional<StringRef> Requested) {
+    if (!Stored || !Requested)
+      return !Stored && !Requested;
+    return *Stored == *Requested;
+  };
+  if (!sameOption(Impl.Group, Group) ||
+      Impl.SynthesizedExtensions != SynthesizedExtensions ||
+      !sameOption(Impl.InterestedUSR, InterestedUSR))
+    return false;
+
+  // Without any module file to check, there is no way to tell whether the
+  // module changed.
+  if (Impl.ModuleFiles.empty())
+    return false;
+
+  for (auto &File : Impl.ModuleFiles) {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(File.first, Status) ||
+        Status.getLastModificationTime() != File.second)
+      return false;
+  }
+  return true;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -619,6 +674,17 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
+  // Opening the same interface again, e.g. when jumping to another definition
+  // in a framework, reuses the generated interface as long as the module
+  // didn't change, instead of printing and annotating it again.
+  if (auto IFaceGenRef = IFaceGenContexts.get(Name)) {
+    if (IFaceGenRef->isUpToDateFor(ModuleName, Invocation, Group,
+                                   SynthesizedExtensions, InterestedUSR)) {
+      IFaceGenRef->reportEditorInfo(Consumer);
+      return;
+    }
+  }
+
   std::string ErrMsg;
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
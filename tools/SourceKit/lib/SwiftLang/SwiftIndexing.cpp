@@ -16,13 +16,18 @@
 #include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
+#include "swift/Basic/Version.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Index/Index.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace SourceKit;
 using namespace swift;
@@ -117,6 +122,356 @@ private:
   IndexingConsumer &impl;
 };
 
+//===----------------------------------------------------------------------===//
+// Index cache
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// One call made on an IndexingConsumer, with its arguments flattened into
+/// strings and integers so that it can be written to disk and replayed.
+struct IndexEvent {
+  enum EventKind : uint8_t {
+    RecordHash,
+    StartDependency,
+    FinishDependency,
+    StartSourceEntity,
+    RecordRelatedEntity,
+    FinishSourceEntity,
+  };
+
+  EventKind Kind;
+  std::vector<std::string> Strings;
+  std::vector<uint32_t> Ints;
+};
+
+/// The results of indexing a module, as a list of events.
+///
+/// The on-disk form is, for each event, its kind, the number of strings
+/// followed by each string's length and bytes, and the number of integers
+/// followed by the integers, all in host byte order.
+class IndexEventList {
+  std::vector<IndexEvent> Events;
+
+  static StringRef getName(UIdent UID) {
+    return UID.isValid() ? UID.getName() : StringRef();
+  }
+  static UIdent getUID(StringRef Name) {
+    return Name.empty() ? UIdent() : UIdent(Name);
+  }
+
+  void addEntity(IndexEvent::EventKind Kind, const EntityInfo &Info) {
+    IndexEvent Event{Kind, {}, {}};
+    Event.Strings = { getName(Info.Kind), Info.Name, Info.USR, Info.Group,
+                      Info.ReceiverUSR };
+    for (UIdent Attr : Info.Attrs)
+      Event.Strings.push_back(getName(Attr));
+    Event.Ints = { Info.IsDynamic, Info.IsTestCandidate, Info.Line,
+                   Info.Column };
+    Events.push_back(std::move(Event));
+  }
+
+  static bool replayEntity(const IndexEvent &Event, IndexingConsumer &C) {
+    if (Event.Strings.size() < 5 || Event.Ints.size() != 4)
+      return false;
+    std::vector<UIdent> Attrs;
+    for (size_t i = 5, e = Event.Strings.size(); i != e; ++i)
+      Attrs.push_back(getUID(Event.Strings[i]));
+
+    EntityInfo Info;
+    Info.Kind = getUID(Event.Strings[0]);
+    Info.Name = Event.Strings[1];
+    Info.USR = Event.Strings[2];
+    Info.Group = Event.Strings[3];
+    Info.ReceiverUSR = Event.Strings[4];
+    Info.Attrs = Attrs;
+    Info.IsDynamic = Event.Ints[0];
+    Info.IsTestCandidate = Event.Ints[1];
+    Info.Line = Event.Ints[2];
+    Info.Column = Event.Ints[3];
+    if (Event.Kind == IndexEvent::StartSourceEntity)
+      return C.startSourceEntity(Info);
+    return C.recordRelatedEntity(Info);
+  }
+
+public:
+  void addHash(StringRef Hash, bool IsKnown) {
+    Events.push_back({IndexEvent::RecordHash, {Hash}, {IsKnown}});
+  }
+  void addStartDependency(UIdent Kind, StringRef Name, StringRef Path,
+                          bool IsSystem, StringRef Hash) {
+    Events.push_back({IndexEvent::StartDependency,
+                      {getName(Kind), Name, Path, Hash}, {IsSystem}});
+  }
+  void addFinishDependency(UIdent Kind) {
+    Events.push_back({IndexEvent::FinishDependency, {getName(Kind)}, {}});
+  }
+  void addStartSourceEntity(const EntityInfo &Info) {
+    addEntity(IndexEvent::StartSourceEntity, Info);
+  }
+  void addRelatedEntity(const EntityInfo &Info) {
+    addEntity(IndexEvent::RecordRelatedEntity, Info);
+  }
+  void addFinishSourceEntity(UIdent Kind) {
+    Events.push_back({IndexEvent::FinishSourceEntity, {getName(Kind)}, {}});
+  }
+
+  /// Makes the calls recorded in this list on \p C, stopping early if it
+  /// asks to.
+  void replay(IndexingConsumer &C) const {
+    for (auto &Event : Events) {
+      bool Continue = false;
+      switch (Event.Kind) {
+      case IndexEvent::RecordHash:
+        Continue = C.recordHash(Event.Strings[0], Event.Ints[0]);
+        break;
+      case IndexEvent::StartDependency:
+        Continue = C.startDependency(getUID(Event.Strings[0]),
+                                     Event.Strings[1], Event.Strings[2],
+                                     Event.Ints[0], Event.Strings[3]);
+        break;
+      case IndexEvent::FinishDependency:
+        Continue = C.finishDependency(getUID(Event.Strings[0]));
+        break;
+      case IndexEvent::StartSourceEntity:
+      case IndexEvent::RecordRelatedEntity:
+        Continue = replayEntity(Event, C);
+        break;
+      case IndexEvent::FinishSourceEntity:
+        Continue = C.finishSourceEntity(getUID(Event.Strings[0]));
+        break;
+      }
+      if (!Continue)
+        return;
+    }
+  }
+
+  void write(llvm::raw_ostream &OS) const {
+    auto writeInt = [&](uint32_t Value) {
+      OS.write(reinterpret_cast<const char *>(&Value), sizeof(Value));
+    };
+    for (auto &Event : Events) {
+      OS << char(Event.Kind);
+      writeInt(Event.Strings.size());
+      for (auto &Str : Event.Strings) {
+        writeInt(Str.size());
+        OS << Str;
+      }
+      writeInt(Event.Ints.size());
+      for (uint32_t Value : Event.Ints)
+        writeInt(Value);
+    }
+  }
+
+  /// Reads a list written by write().
+  ///
+  /// \returns false if \p Data is malformed.
+  bool read(StringRef Data) {
+    auto readInt = [&](uint32_t &Value) {
+      if (Data.size() < sizeof(Value))
+        return false;
+      memcpy(&Value, Data.data(), sizeof(Value));
+      Data = Data.drop_front(sizeof(Value));
+      return true;
+    };
+    while (!Data.empty()) {
+      IndexEvent Event;
+      Event.Kind = IndexEvent::EventKind(Data.front());
+      if (Event.Kind > IndexEvent::FinishSourceEntity)
+        return false;
+      Data = Data.drop_front();
+
+      uint32_t Count;
+      if (!readInt(Count))
+        return false;
+      for (uint32_t i = 0; i != Count; ++i) {
+        uint32_t Size;
+        if (!readInt(Size) || Data.size() < Size)
+          return false;
+        Event.Strings.push_back(Data.substr(0, Size));
+        Data = Data.drop_front(Size);
+      }
+      if (!readInt(Count))
+        return false;
+      for (uint32_t i = 0; i != Count; ++i) {
+        uint32_t Value;
+        if (!readInt(Value))
+          return false;
+        Event.Ints.push_back(Value);
+      }
+      Events.push_back(std::move(Event));
+    }
+    return isWellFormed();
+  }
+
+  /// Returns true if every event has the arguments replay() expects.
+  bool isWellFormed() const {
+    for (auto &Event : Events) {
+      size_t NumStrings = Event.Strings.size(), NumInts = Event.Ints.size();
+      switch (Event.Kind) {
+      case IndexEvent::RecordHash:
+        if (NumStrings != 1 || NumInts != 1)
+          return false;
+        break;
+      case IndexEvent::StartDependency:
+        if (NumStrings != 4 || NumInts != 1)
+          return false;
+        break;
+      case IndexEvent::FinishDependency:
+      case IndexEvent::FinishSourceEntity:
+        if (NumStrings != 1)
+          return false;
+        break;
+      case IndexEvent::StartSourceEntity:
+      case IndexEvent::RecordRelatedEntity:
+        if (NumStrings < 5 || NumInts != 4)
+          return false;
+        break;
+      }
+    }
+    return true;
+  }
+};
+
+/// Forwards the results of indexing to another consumer, and records them.
+class RecordingIndexingConsumer : public IndexingConsumer {
+  IndexingConsumer &Impl;
+  IndexEventList &Events;
+
+  /// Whether indexing finished without failing or being stopped by Impl,
+  /// which is when the recorded events may be replayed later.
+  bool Complete = true;
+
+  bool record(bool Continue) {
+    if (!Continue)
+      Complete = false;
+    return Continue;
+  }
+
+public:
+  RecordingIndexingConsumer(IndexingConsumer &Impl, IndexEventList &Events)
+    : Impl(Impl), Events(Events) {}
+
+  bool isComplete() const { return Complete; }
+
+  void failed(StringRef ErrDescription) override {
+    Complete = false;
+    Impl.failed(ErrDescription);
+  }
+
+  bool recordHash(StringRef Hash, bool isKnown) override {
+    Events.addHash(Hash, isKnown);
+    return record(Impl.recordHash(Hash, isKnown));
+  }
+
+  bool startDependency(UIdent Kind, StringRef Name, StringRef Path,
+                       bool IsSystem, StringRef Hash) override {
+    Events.addStartDependency(Kind, Name, Path, IsSystem, Hash);
+    return record(Impl.startDependency(Kind, Name, Path, IsSystem, Hash));
+  }
+
+  bool finishDependency(UIdent Kind) override {
+    Events.addFinishDependency(Kind);
+    return record(Impl.finishDependency(Kind));
+  }
+
+  bool startSourceEntity(const EntityInfo &Info) override {
+    Events.addStartSourceEntity(Info);
+    return record(Impl.startSourceEntity(Info));
+  }
+
+  bool recordRelatedEntity(const EntityInfo &Info) override {
+    Events.addRelatedEntity(Info);
+    return record(Impl.recordRelatedEntity(Info));
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    Events.addFinishSourceEntity(Kind);
+    return record(Impl.finishSourceEntity(Kind));
+  }
+};
+} // end anonymous namespace
+
+/// The version of the on-disk format, which is part of every key.
+static const char IndexCacheFormatVersion[] = "1";
+
+/// Returns the path of the cache entry for indexing \p Input with \p Args.
+static std::string getIndexCacheEntryPath(StringRef Directory,
+                                          llvm::MemoryBuffer *Input,
+                                          ArrayRef<const char *> Args,
+                                          StringRef Hash) {
+  llvm::MD5 MD5;
+  auto addString = [&](StringRef Str) {
+    MD5.update(Str);
+    MD5.update(StringRef("\0", 1));
+  };
+  addString(IndexCacheFormatVersion);
+  addString(version::getSwiftFullVersion());
+  for (const char *Arg : Args)
+    addString(Arg);
+  addString(Hash);
+  addString(Input->getBuffer());
+
+  llvm::MD5::MD5Result Result;
+  MD5.final(Result);
+  SmallString<32> ResultStr;
+  llvm::MD5::stringifyResult(Result, ResultStr);
+
+  SmallString<128> Path(Directory);
+  StringRef Name = llvm::sys::path::filename(Input->getBufferIdentifier());
+  llvm::sys::path::append(Path, Name + "-" + ResultStr + ".index");
+  return Path.str();
+}
+
+/// Replays the results stored at \p EntryPath on \p Consumer.
+///
+/// \returns false if there are none.
+static bool replayCachedIndex(StringRef EntryPath,
+                              IndexingConsumer &Consumer) {
+  auto Buffer = llvm::MemoryBuffer::getFile(EntryPath);
+  if (!Buffer)
+    return false;
+  IndexEventList Events;
+  if (!Events.read(Buffer.get()->getBuffer())) {
+    LOG_WARN_FUNC("ignoring malformed index cache entry " << EntryPath);
+    return false;
+  }
+  Events.replay(Consumer);
+  return true;
+}
+
+static void storeCachedIndex(StringRef Directory, StringRef EntryPath,
+                             const IndexEventList &Events) {
+  // Errors are ignored: the results are just not cached.
+  if (llvm::sys::fs::create_directories(Directory))
+    return;
+
+  // Write to a temporary file first, so that readers never see a partially
+  // written entry.
+  int FD;
+  SmallString<128> TmpPath;
+  if (llvm::sys::fs::createUniqueFile(EntryPath + "-%%%%%%%%.tmp", FD,
+                                      TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    Events.write(OS);
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, EntryPath))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+void SwiftLangSupport::indexCacheOnDisk(StringRef Path) {
+  ThreadSafeRefCntPtr<SwiftIndexCache> NewCache(new SwiftIndexCache);
+  NewCache->Path = Path;
+  IndexCache = NewCache; // replace the old cache.
+}
+
 static void indexModule(llvm::MemoryBuffer *Input,
                         StringRef ModuleName,
                         StringRef Hash,
@@ -233,8 +588,26 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
       return;
     }
 
+    // The results of indexing a module only depend on its contents and the
+    // arguments, so they can be cached.
+    ThreadSafeRefCntPtr<SwiftIndexCache> Cache = IndexCache;
+    if (!Cache) {
+      indexModule(InputBuf.get(), llvm::sys::path::stem(Filename),
+                  Hash, IdxConsumer, CI, Args);
+      return;
+    }
+
+    std::string EntryPath = getIndexCacheEntryPath(Cache->Path, InputBuf.get(),
+                                                   Args, Hash);
+    if (replayCachedIndex(EntryPath, IdxConsumer))
+      return;
+
+    IndexEventList Events;
+    RecordingIndexingConsumer Recorder(IdxConsumer, Events);
     indexModule(InputBuf.get(), llvm::sys::path::stem(Filename),
-                Hash, IdxConsumer, CI, Args);
+                Hash, Recorder, CI, Args);
+    if (Recorder.isComplete())
+      storeCachedIndex(Cache->Path, EntryPath, Events);
     return;
   }
 
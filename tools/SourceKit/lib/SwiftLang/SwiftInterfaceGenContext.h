@@ -55,6 +55,13 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Returns true if this interface was generated for the same request, and
+  /// none of the module files it was printed from changed since.
+  bool isUpToDateFor(StringRef ModuleName,
+                     const swift::CompilerInvocation &Invok,
+                     Optional<StringRef> Group, bool SynthesizedExtensions,
+                     Optional<StringRef> InterestedUSR);
+
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
   struct ResolvedEntity {
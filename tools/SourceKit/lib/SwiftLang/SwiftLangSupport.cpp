@@ -697,6 +697,10 @@ bool SwiftLangSupport::printAccessorUSR(const AbstractStorageDecl *D,
   return ide::printAccessorUSR(D, AccKind, OS);
 }
 
+ASTCacheStatistics SwiftLangSupport::getASTCacheStatistics() {
+  return ASTMgr->getStatistics();
+}
+
 std::string SwiftLangSupport::resolvePathSymlinks(StringRef FilePath) {
   std::string InputPath = FilePath;
   char full_path[MAXPATHLEN];
@@ -27,6 +27,7 @@
 #include "llvm/Support/Mutex.h"
 #include <map>
 #include <string>
+#include <tuple>
 
 namespace swift {
   class ASTContext;
@@ -127,6 +128,17 @@ namespace CodeCompletion {
 /// The contents of the cache can be modified asynchronously during the session,
 /// but the contained objects are immutable.
 class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
+public:
+  /// The results of completing after an exact match, along with the inner
+  /// operators they imply.
+  struct InnerResults {
+    std::vector<Completion *> completions;
+    bool hasDot = false;
+    bool hasQDot = false;
+    bool hasInit = false;
+  };
+
+private:
   std::unique_ptr<llvm::MemoryBuffer> buffer;
   std::vector<std::string> args;
   CompletionSink sink;
@@ -134,6 +146,11 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionKind completionKind;
   bool completionHasExpectedTypes;
   FilterRules filterRules;
+  /// Inner results need another type-check of the whole file, so keep them
+  /// for later updates that land on the same exact match. Keyed by the exact
+  /// match and the addInnerResults/addInnerOperators options.
+  std::map<std::tuple<Completion *, bool, bool>, InnerResults> innerResults;
+  std::vector<std::unique_ptr<CompletionSink>> innerSinks;
   llvm::sys::Mutex mtx;
 
 public:
@@ -152,6 +169,12 @@ public:
   const FilterRules &getFilterRules();
   CompletionKind getCompletionKind();
   bool getCompletionHasExpectedTypes();
+  bool getInnerResults(Completion *exactMatch, bool addInnerResults,
+                       bool addInnerOperators, InnerResults &results);
+  /// Caches \p results, which must be allocated in \p resultSink.
+  void setInnerResults(Completion *exactMatch, bool addInnerResults,
+                       bool addInnerOperators, InnerResults results,
+                       std::unique_ptr<CompletionSink> resultSink);
 };
 typedef RefPtr<SessionCache> SessionCacheRef;
 
@@ -198,6 +221,11 @@ struct SwiftPopularAPI : public ThreadSafeRefCountedBase<SwiftPopularAPI> {
   llvm::StringMap<CodeCompletion::PopularityFactor> nameToFactor;
 };
 
+/// Where the results of indexing modules are stored.
+struct SwiftIndexCache : public ThreadSafeRefCountedBase<SwiftIndexCache> {
+  std::string Path;
+};
+
 struct SwiftCustomCompletions
     : public ThreadSafeRefCountedBase<SwiftCustomCompletions> {
   std::vector<CustomCompletionInfo> customCompletions;
@@ -213,6 +241,7 @@ class SwiftLangSupport : public LangSupport {
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
   ThreadSafeRefCntPtr<SwiftCustomCompletions> CustomCompletions;
+  ThreadSafeRefCntPtr<SwiftIndexCache> IndexCache;
 
 public:
   explicit SwiftLangSupport(SourceKit::Context &SKCtx);
@@ -293,6 +322,8 @@ public:
   void indexSource(StringRef Filename, IndexingConsumer &Consumer,
                    ArrayRef<const char *> Args, StringRef Hash) override;
 
+  void indexCacheOnDisk(StringRef path) override;
+
   void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                     SourceKit::CodeCompletionConsumer &Consumer,
                     ArrayRef<const char *> Args) override;
@@ -384,6 +415,8 @@ public:
 
   void findModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args,
                std::function<void(ArrayRef<StringRef>, StringRef Error)> Receiver) override;
+
+  ASTCacheStatistics getASTCacheStatistics() override;
 };
 
 namespace trace {
@@ -22,9 +22,11 @@ namespace sourcekitd_test {
 enum class SourceKitRequest {
   None,
   ProtocolVersion,
+  Statistics,
   DemangleNames,
   MangleSimpleClasses,
   Index,
+  IndexCacheOnDisk,
   CodeComplete,
   CodeCompleteOpen,
   CodeCompleteClose,
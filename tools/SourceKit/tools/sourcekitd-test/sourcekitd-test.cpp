@@ -121,9 +121,11 @@ static sourcekitd_uid_t KeyModuleGroups;
 static sourcekitd_uid_t KeySimplified;
 
 static sourcekitd_uid_t RequestProtocolVersion;
+static sourcekitd_uid_t RequestStatistics;
 static sourcekitd_uid_t RequestDemangle;
 static sourcekitd_uid_t RequestMangleSimpleClass;
 static sourcekitd_uid_t RequestIndex;
+static sourcekitd_uid_t RequestIndexCacheOnDisk;
 static sourcekitd_uid_t RequestCodeComplete;
 static sourcekitd_uid_t RequestCodeCompleteOpen;
 static sourcekitd_uid_t RequestCodeCompleteClose;
@@ -225,9 +227,12 @@ static int skt_main(int argc, const char **argv) {
   semaSemaphore = dispatch_semaphore_create(0);
 
   RequestProtocolVersion = sourcekitd_uid_get_from_cstr("source.request.protocol_version");
+  RequestStatistics = sourcekitd_uid_get_from_cstr("source.request.statistics");
   RequestDemangle = sourcekitd_uid_get_from_cstr("source.request.demangle");
   RequestMangleSimpleClass = sourcekitd_uid_get_from_cstr("source.request.mangle_simple_class");
   RequestIndex = sourcekitd_uid_get_from_cstr("source.request.indexsource");
+  RequestIndexCacheOnDisk =
+    sourcekitd_uid_get_from_cstr("source.request.indexsource.cache.ondisk");
   RequestCodeComplete = sourcekitd_uid_get_from_cstr("source.request.codecomplete");
   RequestCodeCompleteOpen = sourcekitd_uid_get_from_cstr("source.request.codecomplete.open");
   RequestCodeCompleteClose = sourcekitd_uid_get_from_cstr("source.request.codecomplete.close");
@@ -411,6 +416,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestProtocolVersion);
     break;
 
+  case SourceKitRequest::Statistics:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestStatistics);
+    break;
+
   case SourceKitRequest::DemangleNames:
     prepareDemangleRequest(Req, Opts);
     break;
@@ -451,6 +460,13 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     addCodeCompleteOptions(Req, Opts);
     break;
 
+  case SourceKitRequest::IndexCacheOnDisk:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest,
+                                          RequestIndexCacheOnDisk);
+    sourcekitd_request_dictionary_set_string(Req, KeyName,
+                                             Opts.CachePath.c_str());
+    break;
+
   case SourceKitRequest::CodeCompleteCacheOnDisk:
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest,
                                           RequestCodeCompleteCacheOnDisk);
@@ -702,7 +718,9 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
       break;
 
     case SourceKitRequest::ProtocolVersion:
+    case SourceKitRequest::Statistics:
     case SourceKitRequest::Index:
+    case SourceKitRequest::IndexCacheOnDisk:
     case SourceKitRequest::CodeComplete:
     case SourceKitRequest::CodeCompleteOpen:
     case SourceKitRequest::CodeCompleteClose:
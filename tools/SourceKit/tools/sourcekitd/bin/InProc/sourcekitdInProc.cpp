@@ -13,6 +13,7 @@
 #include "sourcekitd/Internal.h"
 
 #include "SourceKit/Support/Concurrency.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "llvm/Support/Mutex.h"
@@ -122,7 +123,10 @@ void sourcekitd_send_request(sourcekitd_object_t req,
 
   sourcekitd_request_retain(req);
   receiver = Block_copy(receiver);
+  auto Received = trace::Clock::now();
   WorkQueue::dispatchConcurrent([=]{
+    trace::recordOperationTime(trace::OperationKind::RequestQueueWait,
+                               Received, trace::Clock::now());
     sourcekitd::handleRequest(req, [&](sourcekitd_response_t resp) {
       // The receiver accepts ownership of the response.
       receiver(resp);
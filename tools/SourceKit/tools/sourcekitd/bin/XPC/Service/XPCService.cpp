@@ -18,6 +18,7 @@
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/UIdent.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -177,6 +178,8 @@ public:
       return;
     }
 
+    SourceKit::trace::TimedOperation TimedOp(
+        SourceKit::trace::OperationKind::ResponseSerialization);
     xpc_object_t reply = xpc_dictionary_create_reply(Event);
     xpc_dictionary_set_value(reply, xpc::KeyMsgResponse, response);
     xpc_release(response);
@@ -231,8 +234,12 @@ static void sourcekitdServer_peer_event_handler(xpc_connection_t peer,
     assert(type == XPC_TYPE_DICTIONARY);
     // Handle the message
     xpc_retain(event);
+    auto Received = SourceKit::trace::Clock::now();
     dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT,0),
     ^{
+      SourceKit::trace::recordOperationTime(
+          SourceKit::trace::OperationKind::RequestQueueWait, Received,
+          SourceKit::trace::Clock::now());
       xpc_object_t contents = xpc_dictionary_get_value(event, "msg");
 
       if (!contents) {
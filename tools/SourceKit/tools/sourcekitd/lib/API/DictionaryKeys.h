@@ -118,6 +118,17 @@ extern SourceKit::UIdent KeyObsoleted;
 extern SourceKit::UIdent KeyRemoveCache;
 extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyASTCount;
+extern SourceKit::UIdent KeyMemoryCost;
+extern SourceKit::UIdent KeyMemoryBudget;
+extern SourceKit::UIdent KeyCacheHits;
+extern SourceKit::UIdent KeyCacheMisses;
+extern SourceKit::UIdent KeyCacheEvictions;
+extern SourceKit::UIdent KeyEntitiesChunkSize;
+extern SourceKit::UIdent KeyOperations;
+extern SourceKit::UIdent KeyOperationCount;
+extern SourceKit::UIdent KeyTotalTime;
+extern SourceKit::UIdent KeyMaxTime;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
@@ -20,6 +20,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "swift/Basic/DemangleWrappers.h"
@@ -62,10 +63,14 @@ static LazySKDUID RequestProtocolVersion("source.request.protocol_version");
 
 static LazySKDUID RequestCrashWithExit("source.request.crash_exit");
 
+static LazySKDUID RequestStatistics("source.request.statistics");
+
 static LazySKDUID RequestDemangle("source.request.demangle");
 static LazySKDUID RequestMangleSimpleClass("source.request.mangle_simple_class");
 
 static LazySKDUID RequestIndex("source.request.indexsource");
+static LazySKDUID
+    RequestIndexCacheOnDisk("source.request.indexsource.cache.ondisk");
 static LazySKDUID RequestDocInfo("source.request.docinfo");
 static LazySKDUID RequestCodeComplete("source.request.codecomplete");
 static LazySKDUID RequestCodeCompleteOpen("source.request.codecomplete.open");
@@ -154,7 +159,8 @@ mangleSimpleClassNames(ArrayRef<std::pair<StringRef, StringRef>> ModuleClassPair
 
 static sourcekitd_response_t indexSource(StringRef Filename,
                                          ArrayRef<const char *> Args,
-                                         StringRef KnownHash);
+                                         StringRef KnownHash,
+                                         unsigned ChunkSize);
 
 static sourcekitd_response_t reportDocInfo(llvm::MemoryBuffer *InputBuf,
                                            StringRef ModuleName,
@@ -246,7 +252,11 @@ void sourcekitd::handleRequest(sourcekitd_object_t Req,
     sourcekitd::printRequestObject(Req, Log->getOS());
   }
 
-  handleRequestImpl(Req, [Receiver](sourcekitd_response_t Resp) {
+  auto Start = trace::Clock::now();
+  handleRequestImpl(Req, [Receiver, Start](sourcekitd_response_t Resp) {
+    trace::recordOperationTime(trace::OperationKind::Request, Start,
+                               trace::Clock::now());
+
     LOG_SECTION("handleRequest-after", InfoHighPrio) {
       // Responses are big, print them out with info medium priority.
       if (Logger::isLoggingEnabledForLevel(Logger::Level::InfoMediumPrio))
@@ -357,6 +367,28 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(mangleSimpleClassNames(ModuleClassPairs));
   }
 
+  if (ReqUID == RequestStatistics) {
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    ASTCacheStatistics Stats = Lang.getASTCacheStatistics();
+    ResponseBuilder RB;
+    auto Dict = RB.getDictionary();
+    Dict.set(KeyASTCount, int64_t(Stats.NumASTs));
+    Dict.set(KeyMemoryCost, int64_t(Stats.MemoryCost));
+    Dict.set(KeyMemoryBudget, int64_t(Stats.MemoryBudget));
+    Dict.set(KeyCacheHits, int64_t(Stats.Hits));
+    Dict.set(KeyCacheMisses, int64_t(Stats.Misses));
+    Dict.set(KeyCacheEvictions, int64_t(Stats.Evictions));
+    auto Operations = Dict.setArray(KeyOperations);
+    for (auto &OpStats : trace::getOperationStatistics()) {
+      auto Elem = Operations.appendDictionary();
+      Elem.set(KeyName, trace::getOperationKindName(OpStats.Kind));
+      Elem.set(KeyOperationCount, int64_t(OpStats.Count));
+      Elem.set(KeyTotalTime, int64_t(OpStats.TotalMicroseconds));
+      Elem.set(KeyMaxTime, int64_t(OpStats.MaxMicroseconds));
+    }
+    return Rec(RB.createResponse());
+  }
+
   // Just accept 'source.request.buildsettings.register' for now, don't do
   // anything else.
   // FIXME: Heavy WIP here.
@@ -546,6 +578,16 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(codeCompleteClose(*Name, Offset));
   }
 
+  if (ReqUID == RequestIndexCacheOnDisk) {
+    Optional<StringRef> Name = Req.getString(KeyName);
+    if (!Name.hasValue())
+      return Rec(createErrorRequestInvalid("missing 'key.name'"));
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    Lang.indexCacheOnDisk(*Name);
+    ResponseBuilder b;
+    return Rec(b.createResponse());
+  }
+
   if (ReqUID == RequestCodeCompleteCacheOnDisk) {
     Optional<StringRef> Name = Req.getString(KeyName);
     if (!Name.hasValue())
@@ -696,7 +738,26 @@ handleSemanticRequest(RequestDict Req,
     StringRef Hash;
     Optional<StringRef> HashOpt = Req.getString(KeyHash);
     if (HashOpt.hasValue()) Hash = *HashOpt;
-    return Rec(indexSource(*SourceFile, Args, Hash));
+    int64_t ChunkSize = 0;
+    Req.getInt64(KeyEntitiesChunkSize, ChunkSize, /*isOptional=*/true);
+    if (ChunkSize < 0)
+      return Rec(createErrorRequestInvalid(
+          "'key.entities_chunk_size' must not be negative"));
+
+    // Indexing is batch work; run it at background priority so it doesn't
+    // compete with interactive requests for the CPU. The request dictionary
+    // is only valid for the duration of this call, so copy what we need.
+    std::string Filename = *SourceFile;
+    std::string KnownHash = Hash;
+    std::vector<std::string> ArgStorage(Args.begin(), Args.end());
+    WorkQueue::dispatchConcurrent([Filename, KnownHash, ChunkSize, ArgStorage,
+                                   Rec] {
+      SmallVector<const char *, 16> IndexArgs;
+      for (auto &Arg : ArgStorage)
+        IndexArgs.push_back(Arg.c_str());
+      Rec(indexSource(Filename, IndexArgs, KnownHash, ChunkSize));
+    }, WorkQueue::Priority::Background, /*isStackDeep=*/true);
+    return;
   }
 
   if (isSemanticEditorDisabled())
@@ -759,10 +820,23 @@ class SKIndexingConsumer : public IndexingConsumer {
   ResponseBuilder::Dictionary TopDict;
   bool Cancelled = false;
 
+  /// When non-zero, top-level entities are sent to the client in
+  /// notifications of at most this many entities each, instead of being
+  /// accumulated in the response.
+  unsigned ChunkSize;
+  std::string Filename;
+  std::unique_ptr<ResponseBuilder> Chunk;
+  ResponseBuilder::Array ChunkEntities;
+  unsigned NumChunkEntities = 0;
+
+  ResponseBuilder::Array &getTopLevelEntities();
+
 public:
   std::string ErrorDescription;
 
-  explicit SKIndexingConsumer(ResponseBuilder &RespBuilder) {
+  SKIndexingConsumer(ResponseBuilder &RespBuilder, StringRef Filename,
+                     unsigned ChunkSize)
+      : ChunkSize(ChunkSize), Filename(Filename) {
     TopDict = RespBuilder.getDictionary();
 
     // First in stack is the top-level "key.entities" container.
@@ -780,6 +854,9 @@ public:
     (void) Cancelled;
   }
 
+  /// Sends any top-level entities that haven't been sent yet.
+  void flushChunk();
+
   void failed(StringRef ErrDescription) override;
 
   bool recordHash(StringRef Hash, bool isKnown) override;
@@ -802,18 +879,49 @@ public:
 
 static sourcekitd_response_t indexSource(StringRef Filename,
                                          ArrayRef<const char *> Args,
-                                         StringRef KnownHash) {
+                                         StringRef KnownHash,
+                                         unsigned ChunkSize) {
   ResponseBuilder RespBuilder;
-  SKIndexingConsumer IdxConsumer(RespBuilder);
+  SKIndexingConsumer IdxConsumer(RespBuilder, Filename, ChunkSize);
   LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
   Lang.indexSource(Filename, IdxConsumer, Args, KnownHash);
 
   if (!IdxConsumer.ErrorDescription.empty())
     return createErrorRequestFailed(IdxConsumer.ErrorDescription.c_str());
 
+  IdxConsumer.flushChunk();
   return RespBuilder.createResponse();
 }
 
+ResponseBuilder::Array &SKIndexingConsumer::getTopLevelEntities() {
+  if (!ChunkSize) {
+    Entity &Top = EntitiesStack.front();
+    if (Top.Entities.isNull())
+      Top.Entities = Top.Data.setArray(KeyEntities);
+    return Top.Entities;
+  }
+
+  if (!Chunk) {
+    static UIdent IndexEntitiesNotificationUID(
+        "source.notification.index.entities");
+    Chunk.reset(new ResponseBuilder());
+    auto Dict = Chunk->getDictionary();
+    Dict.set(KeyNotification, IndexEntitiesNotificationUID);
+    Dict.set(KeyName, Filename);
+    ChunkEntities = Dict.setArray(KeyEntities);
+  }
+  return ChunkEntities;
+}
+
+void SKIndexingConsumer::flushChunk() {
+  if (!Chunk)
+    return;
+  sourcekitd::postNotification(Chunk->createResponse());
+  Chunk.reset();
+  ChunkEntities = ResponseBuilder::Array();
+  NumChunkEntities = 0;
+}
+
 void SKIndexingConsumer::failed(StringRef ErrDescription) {
   ErrorDescription = ErrDescription;
 }
@@ -864,7 +972,8 @@ bool SKIndexingConsumer::finishDependency(UIdent Kind) {
 
 bool SKIndexingConsumer::startSourceEntity(const EntityInfo &Info) {
   Entity &Parent = EntitiesStack.back();
-  ResponseBuilder::Array &Arr = Parent.Entities;
+  ResponseBuilder::Array &Arr =
+      EntitiesStack.size() == 1 ? getTopLevelEntities() : Parent.Entities;
   if (Arr.isNull())
     Arr = Parent.Data.setArray(KeyEntities);
 
@@ -929,6 +1038,9 @@ bool SKIndexingConsumer::finishSourceEntity(UIdent Kind) {
   assert(CurrEnt.Kind == Kind);
   (void) CurrEnt;
   EntitiesStack.pop_back();
+  if (ChunkSize && EntitiesStack.size() == 1 &&
+      ++NumChunkEntities >= ChunkSize)
+    flushChunk();
   return true;
 }
 
@@ -1050,17 +1162,18 @@ static std::string mangleSimpleClass(StringRef moduleName,
                                      StringRef className) {
   using namespace swift::Demangle;
 
-  auto moduleNode = NodeFactory::create(Node::Kind::Module, moduleName);
-  auto IdNode = NodeFactory::create(Node::Kind::Identifier, className);
-  auto classNode = NodeFactory::create(Node::Kind::Class);
-  auto typeNode = NodeFactory::create(Node::Kind::Type);
-  auto typeManglingNode = NodeFactory::create(Node::Kind::TypeMangling);
-  auto globalNode = NodeFactory::create(Node::Kind::Global);
-
-  classNode->addChildren(moduleNode, IdNode);
-  typeNode->addChild(classNode);
-  typeManglingNode->addChild(typeNode);
-  globalNode->addChild(typeManglingNode);
+  NodeFactory Factory;
+  auto moduleNode = Factory.createNode(Node::Kind::Module, moduleName);
+  auto IdNode = Factory.createNode(Node::Kind::Identifier, className);
+  auto classNode = Factory.createNode(Node::Kind::Class);
+  auto typeNode = Factory.createNode(Node::Kind::Type);
+  auto typeManglingNode = Factory.createNode(Node::Kind::TypeMangling);
+  auto globalNode = Factory.createNode(Node::Kind::Global);
+
+  classNode->addChildren(moduleNode, IdNode, Factory);
+  typeNode->addChild(classNode, Factory);
+  typeManglingNode->addChild(typeNode, Factory);
+  globalNode->addChild(typeManglingNode, Factory);
   return mangleNode(globalNode);
 }
 
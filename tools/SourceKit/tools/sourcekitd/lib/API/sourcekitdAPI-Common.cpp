@@ -131,6 +131,17 @@ UIdent sourcekitd::KeyObsoleted("key.obsoleted");
 UIdent sourcekitd::KeyRemoveCache("key.removecache");
 UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyASTCount("key.ast_count");
+UIdent sourcekitd::KeyMemoryCost("key.memory_cost");
+UIdent sourcekitd::KeyMemoryBudget("key.memory_budget");
+UIdent sourcekitd::KeyCacheHits("key.cache_hits");
+UIdent sourcekitd::KeyCacheMisses("key.cache_misses");
+UIdent sourcekitd::KeyCacheEvictions("key.cache_evictions");
+UIdent sourcekitd::KeyEntitiesChunkSize("key.entities_chunk_size");
+UIdent sourcekitd::KeyOperations("key.operations");
+UIdent sourcekitd::KeyOperationCount("key.operation_count");
+UIdent sourcekitd::KeyTotalTime("key.total_time_us");
+UIdent sourcekitd::KeyMaxTime("key.max_time_us");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -219,7 +230,19 @@ static UIdent *OrderedKeys[] = {
   &KeyIntroduced,
   &KeyDeprecated,
   &KeyObsoleted,
-  &KeyRemoveCache
+  &KeyRemoveCache,
+
+  &KeyASTCount,
+  &KeyMemoryCost,
+  &KeyMemoryBudget,
+  &KeyCacheHits,
+  &KeyCacheMisses,
+  &KeyCacheEvictions,
+  &KeyEntitiesChunkSize,
+  &KeyOperations,
+  &KeyOperationCount,
+  &KeyTotalTime,
+  &KeyMaxTime
 };
 
 static unsigned findPrintOrderForDictKey(UIdent Key) {
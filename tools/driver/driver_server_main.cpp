@@ -0,0 +1,137 @@
+//===--- driver_server_main.cpp - Long-lived compiler driver --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs driver invocations on request, keeping the file system state they read
+// (file statuses, output file maps, dependencies files) in memory between
+// builds. Requests are read from stdin, one per line:
+//
+//   build          Followed by the driver's arguments one per line, starting
+//                  with the program name (e.g. "swiftc"), and then an empty
+//                  line. When the build finishes, "exit: <code>" is printed
+//                  on stdout.
+//   changed <path> Reports that <path> was modified, created or removed.
+//   invalidate     Forgets all cached state.
+//
+// The server exits at the end of its input.
+//
+// With -trust-notifications, file statuses are kept until they are reported
+// changed, so the client must report every change (e.g. from a file system
+// watcher). Otherwise, cached contents are revalidated on each build.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/AST/DiagnosticEngine.h"
+#include "swift/Basic/SourceManager.h"
+#include "swift/Driver/BuildStateCache.h"
+#include "swift/Driver/Compilation.h"
+#include "swift/Driver/Driver.h"
+#include "swift/Frontend/PrintingDiagnosticConsumer.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace swift;
+using namespace swift::driver;
+
+static int runBuild(ArrayRef<std::string> Args, const char *Argv0,
+                    void *MainAddr, BuildStateCache &Cache) {
+  if (Args.empty()) {
+    llvm::errs() << "error: build request has no arguments\n";
+    return 1;
+  }
+
+  SmallVector<const char *, 256> Argv;
+  for (const std::string &Arg : Args)
+    Argv.push_back(Arg.c_str());
+
+  std::string Path = llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  StringRef ExecName = llvm::sys::path::stem(Argv[0]);
+
+  PrintingDiagnosticConsumer PDC;
+  SourceManager SM;
+  DiagnosticEngine Diags(SM);
+  Diags.addConsumer(PDC);
+
+  Driver TheDriver(Path, ExecName, Argv, Diags);
+  if (TheDriver.getDriverKind() != Driver::DriverKind::Batch) {
+    llvm::errs() << "error: only 'swiftc' builds can be run by the driver "
+                    "server\n";
+    return 1;
+  }
+  TheDriver.setBuildStateCache(&Cache);
+
+  Cache.beginBuild();
+  std::unique_ptr<Compilation> C = TheDriver.buildCompilation(Argv);
+
+  if (Diags.hadAnyError())
+    return 1;
+
+  if (C)
+    return C->performJobs();
+
+  return 0;
+}
+
+int driver_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                       void *MainAddr) {
+  bool TrustNotifications = false;
+  for (StringRef Arg : Args) {
+    if (Arg == "-trust-notifications") {
+      TrustNotifications = true;
+      continue;
+    }
+    llvm::errs() << "error: unknown argument: '" << Arg << "'\n";
+    return 1;
+  }
+
+  BuildStateCache Cache(TrustNotifications);
+
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    StringRef Request(Line);
+    if (Request.empty())
+      continue;
+
+    if (Request == "build") {
+      std::vector<std::string> BuildArgs;
+      while (std::getline(std::cin, Line) && !Line.empty())
+        BuildArgs.push_back(Line);
+
+      int ExitCode = runBuild(BuildArgs, Argv0, MainAddr, Cache);
+      llvm::errs().flush();
+      llvm::outs() << "exit: " << ExitCode << "\n";
+      llvm::outs().flush();
+      continue;
+    }
+
+    StringRef ChangedPrefix = "changed ";
+    if (Request.startswith(ChangedPrefix)) {
+      Cache.fileChanged(Request.drop_front(ChangedPrefix.size()));
+      continue;
+    }
+
+    if (Request == "invalidate") {
+      Cache.clear();
+      continue;
+    }
+
+    llvm::errs() << "error: unknown request: '" << Request << "'\n";
+  }
+
+  return 0;
+}
@@ -16,14 +16,18 @@
 
 #include "swift/Basic/DemangleWrappers.h"
 #include "llvm/Support/CommandLine.h"
-#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cstdio>
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 static llvm::cl::opt<bool>
 ExpandMode("expand",
@@ -49,51 +53,186 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<unsigned>
+NumThreads("j",
+           llvm::cl::desc("Number of threads used to demangle standard input"),
+           llvm::cl::init(1));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
 
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
+                     swift::Demangle::NodeFactory &factory,
                      const swift::Demangle::DemangleOptions &options) {
+  // Nothing from the previous symbol is needed anymore; recycle its nodes.
+  factory.clear();
+
+
   bool hadLeadingUnderscore = false;
   if (name.startswith("__")) {
     hadLeadingUnderscore = true;
     name = name.substr(1);
   }
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(name, factory);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
+static bool isSymbolChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+/// Find the next substring of \p text which looks like a mangled name, i.e.
+/// matches "_T[_a-zA-Z0-9$]+". This doesn't handle Unicode symbols, but maybe
+/// that's okay.
+static llvm::StringRef findMaybeSymbol(llvm::StringRef text) {
+  for (size_t pos = text.find("_T"); pos != llvm::StringRef::npos;
+       pos = text.find("_T", pos + 1)) {
+    size_t end = pos + 2;
+    while (end < text.size() && isSymbolChar(text[end]))
+      ++end;
+    if (end > pos + 2)
+      return text.slice(pos, end);
+  }
+  return llvm::StringRef();
+}
+
+namespace {
+/// Demangles the symbols found in chunks of standard input. Every worker
+/// thread owns one of these, so nothing here needs to be synchronized.
+class ChunkDemangler {
+  const swift::Demangle::DemangleOptions &Options;
+  swift::Demangle::NodeFactory Factory;
+
+  /// Real-world input (crash logs, symbol dumps) mentions the same few
+  /// symbols over and over, so remember what they demangled to.
+  std::unordered_map<std::string, std::string> Cache;
+  static const size_t MaxCacheEntries = 1 << 16;
+
+public:
+  explicit ChunkDemangler(const swift::Demangle::DemangleOptions &options)
+    : Options(options) {}
+
+  /// Copy \p input to \p output, replacing every mangled name by its
+  /// demangling.
+  void process(llvm::StringRef input, std::string &output) {
+    llvm::raw_string_ostream os(output);
+    llvm::StringRef symbol;
+    while (!(symbol = findMaybeSymbol(input)).empty()) {
+      size_t start = symbol.data() - input.data();
+      os << input.substr(0, start);
+      os << demangleCached(symbol);
+      input = input.substr(start + symbol.size());
+    }
+    os << input;
+  }
+
+private:
+  const std::string &demangleCached(llvm::StringRef symbol) {
+    auto found = Cache.find(symbol.str());
+    if (found != Cache.end())
+      return found->second;
+
+    if (Cache.size() >= MaxCacheEntries)
+      Cache.clear();
+    std::string &result = Cache[symbol.str()];
+    llvm::raw_string_ostream os(result);
+    demangle(os, symbol, Factory, Options);
+    os.flush();
+    return result;
+  }
+};
+} // end anonymous namespace
+
+/// Read up to about \p size bytes from standard input into \p chunk, ending
+/// at a line boundary so that no symbol is torn apart. \p carry holds the
+/// partial line left over from the previous call. Returns false at the end of
+/// the input.
+static bool readChunk(std::string &chunk, std::string &carry, size_t size) {
+  chunk.swap(carry);
+  carry.clear();
+  size_t lineEnd = std::string::npos;
+  while (true) {
+    size_t oldSize = chunk.size();
+    size_t wanted = oldSize < size ? size - oldSize : size;
+    chunk.resize(oldSize + wanted);
+    size_t got = std::fread(&chunk[oldSize], 1, wanted, stdin);
+    chunk.resize(oldSize + got);
+    if (got == 0)
+      return !chunk.empty();
+    lineEnd = chunk.rfind('\n');
+    if (lineEnd != std::string::npos && lineEnd >= oldSize)
+      break;
+  }
+  carry.assign(chunk, lineEnd + 1, std::string::npos);
+  chunk.resize(lineEnd + 1);
+  return true;
 }
 
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
+/// Demangle everything on standard input, splitting it into chunks which are
+/// processed by \p numThreads threads. The output keeps the input order.
+static bool demangleSTDIN(const swift::Demangle::DemangleOptions &options,
+                          unsigned numThreads) {
+  const size_t ChunkSize = 1 << 20;
+
+  if (numThreads == 0)
+    numThreads = 1;
+  if (llvm::sys::ChangeStdinToBinary())
+    return false;
+
+  std::vector<std::unique_ptr<ChunkDemangler>> workers;
+  for (unsigned i = 0; i < numThreads; ++i)
+    workers.emplace_back(new ChunkDemangler(options));
+  std::vector<std::string> inputs(numThreads), outputs(numThreads);
+  std::string carry;
+  bool moreInput = true;
+  while (moreInput) {
+    // Read one chunk per thread, demangle them all, then write the results
+    // out in order before starting the next round.
+    unsigned numChunks = 0;
+    while (numChunks < numThreads &&
+           (moreInput = readChunk(inputs[numChunks], carry, ChunkSize)))
+      ++numChunks;
+
+    auto work = [&](unsigned i) {
+      outputs[i].clear();
+      workers[i]->process(inputs[i], outputs[i]);
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numChunks; ++i)
+      threads.emplace_back(work, i);
+    if (numChunks > 0)
+      work(0);
+    for (auto &thread : threads)
+      thread.join();
+
+    for (unsigned i = 0; i < numChunks; ++i)
+      llvm::outs() << outputs[i];
+  }
+  return !std::ferror(stdin);
 }
 
 int main(int argc, char **argv) {
@@ -109,28 +248,17 @@ int main(int argc, char **argv) {
   if (Simplified)
     options = swift::Demangle::DemangleOptions::SimplifiedUIDemangleOptions();
 
+  swift::Demangle::NodeFactory factory;
+
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
-    if (!input) {
-      llvm::errs() << input.getError().message() << '\n';
+    if (!demangleSTDIN(options, NumThreads)) {
+      llvm::errs() << "error reading standard input\n";
       return EXIT_FAILURE;
     }
-    llvm::StringRef inputContents = input.get()->getBuffer();
-
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-    llvm::outs() << inputContents;
-
   } else {
     for (llvm::StringRef name : InputNames) {
-      demangle(llvm::outs(), name, options);
+      demangle(llvm::outs(), name, factory, options);
       llvm::outs() << '\n';
     }
   }
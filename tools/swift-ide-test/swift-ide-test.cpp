@@ -34,10 +34,12 @@
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/CodeCompletion.h"
 #include "swift/IDE/CommentConversion.h"
+#include "swift/IDE/Formatting.h"
 #include "swift/IDE/ModuleInterfacePrinting.h"
 #include "swift/IDE/REPLCodeCompletion.h"
 #include "swift/IDE/SyntaxModel.h"
 #include "swift/IDE/Utils.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/Sema/IDETypeChecking.h"
 #include "swift/Markup/Markup.h"
 #include "swift/Config.h"
@@ -48,6 +50,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -72,6 +75,7 @@ enum class ActionType {
   DumpCompletionCache,
   DumpImporterLookupTable,
   SyntaxColoring,
+  LexBenchmark,
   DumpComments,
   Structure,
   Annotation,
@@ -151,6 +155,8 @@ Action(llvm::cl::desc("Mode:"), llvm::cl::init(ActionType::None),
                       "dump-importer-lookup-table", "Dump the Clang importer's lookup tables"),
            clEnumValN(ActionType::SyntaxColoring,
                       "syntax-coloring", "Perform syntax coloring"),
+           clEnumValN(ActionType::LexBenchmark,
+                      "lex-benchmark", "Measure how fast the source file is lexed"),
            clEnumValN(ActionType::DumpComments,
                      "dump-comments", "Dump documentation comments attached to decls"),
            clEnumValN(ActionType::Structure,
@@ -210,6 +216,11 @@ Action(llvm::cl::desc("Mode:"), llvm::cl::init(ActionType::None),
 static llvm::cl::opt<std::string>
 SourceFilename("source-filename", llvm::cl::desc("Name of the source file"));
 
+static llvm::cl::opt<unsigned>
+LexIterations("lex-iterations",
+              llvm::cl::desc("Number of times to lex the source file"),
+              llvm::cl::init(10));
+
 static llvm::cl::opt<std::string>
 SecondSourceFilename("second-source-filename", llvm::cl::desc("Name of the second source file"));
 
@@ -363,6 +374,11 @@ Playground("playground",
            llvm::cl::desc("Whether coloring in playground"),
            llvm::cl::init(false));
 
+static llvm::cl::opt<std::string>
+SyntaxColoringLines("syntax-coloring-lines",
+                    llvm::cl::desc("<first>:<last> lines to color, as after "
+                                   "an edit of them"));
+
 // AST printing options.
 
 static llvm::cl::opt<bool>
@@ -823,7 +839,8 @@ static int doSyntaxColoring(const CompilerInvocation &InitInvok,
                             StringRef SourceFilename,
                             bool TerminalOutput,
                             bool RunTypeChecker,
-                            bool Playground) {
+                            bool Playground,
+                            StringRef Lines) {
   CompilerInvocation Invocation(InitInvok);
   Invocation.addInputFilename(SourceFilename);
   Invocation.getLangOptions().DisableAvailabilityChecking = false;
@@ -852,12 +869,66 @@ static int doSyntaxColoring(const CompilerInvocation &InitInvok,
   ide::SyntaxModelContext ColorContext(*SF);
   PrintSyntaxColorWalker ColorWalker(CI.getSourceMgr(), BufID, llvm::outs(),
                                      TerminalOutput);
-  ColorContext.walk(ColorWalker);
+  if (Lines.empty()) {
+    ColorContext.walk(ColorWalker);
+  } else {
+    // Parse the range like a line:column pair.
+    auto Range = ide::parseLineCol(Lines);
+    if (!Range || Range->second < Range->first)
+      return 1;
+    StringRef Text = CI.getSourceMgr().getLLVMSourceMgr()
+                       .getMemoryBuffer(BufID)->getBuffer();
+    unsigned Offset = ide::getOffsetOfLine(Range->first, Text);
+    unsigned EndOffset = ide::getOffsetOfLine(Range->second + 1, Text);
+    if (EndOffset < Offset)
+      EndOffset = Text.size();
+    ColorContext.walk(ColorWalker, Offset, EndOffset - Offset);
+  }
   ColorWalker.finished();
 
   return 0;
 }
 
+static int doLexBenchmark(StringRef SourceFilename, unsigned Iterations) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
+    llvm::MemoryBuffer::getFile(SourceFilename);
+  if (!FileBufOrErr) {
+    llvm::errs() << "error opening input file: "
+                 << FileBufOrErr.getError().message() << '\n';
+    return 1;
+  }
+
+  LangOptions LangOpts;
+  SourceManager SourceMgr;
+  size_t BufferSize = FileBufOrErr.get()->getBufferSize();
+  unsigned BufferID = SourceMgr.addNewSourceBuffer(std::move(FileBufOrErr.get()));
+
+  uint64_t NumTokens = 0;
+  auto Start = std::chrono::steady_clock::now();
+  for (unsigned I = 0; I != Iterations; ++I) {
+    Lexer L(LangOpts, SourceMgr, BufferID, /*Diags=*/nullptr,
+            /*InSILMode=*/false, CommentRetentionMode::None);
+    Token Tok;
+    do {
+      L.lex(Tok);
+      ++NumTokens;
+    } while (Tok.isNot(tok::eof));
+  }
+  std::chrono::duration<double> Elapsed =
+    std::chrono::steady_clock::now() - Start;
+
+  double Seconds = Elapsed.count();
+  double MegaBytes = double(BufferSize) * Iterations / (1024 * 1024);
+  llvm::outs() << "tokens: " << NumTokens / std::max(Iterations, 1U) << '\n';
+  llvm::outs() << "bytes: " << BufferSize << '\n';
+  llvm::outs() << "iterations: " << Iterations << '\n';
+  llvm::outs() << "seconds: " << llvm::format("%.3f", Seconds) << '\n';
+  if (Seconds > 0)
+    llvm::outs() << "MB/s: " << llvm::format("%.1f", MegaBytes / Seconds)
+                 << '\n';
+  return 0;
+}
+
 static int doDumpImporterLookupTables(const CompilerInvocation &InitInvok,
                                       StringRef SourceFilename) {
   if (options::ImportObjCHeader.empty()) {
@@ -1376,8 +1447,9 @@ static int doPrintAST(const CompilerInvocation &InitInvok,
 
   // If we were given a mangled name, do a very simple form of LLDB's logic to
   // look up a type based on that name.
+  Demangle::NodeFactory factory;
   Demangle::NodePointer node =
-    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind);
+    demangle_wrappers::demangleSymbolAsNode(MangledNameToFind, factory);
   using NodeKind = Demangle::Node::Kind;
 
   if (!node) {
@@ -1527,10 +1599,13 @@ static int doPrintLocalTypes(const CompilerInvocation &InitInvok,
     }
 
     // Simulate the demangling / parsing process
+    Demangle::NodeFactory factory;
     for (auto MangledName : MangledNames) {
 
       // Global
-      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName);
+      factory.clear();
+      auto node = demangle_wrappers::demangleSymbolAsNode(MangledName,
+                                                          factory);
 
       // TypeMangling
       node = node->getFirstChild();
@@ -2792,7 +2867,12 @@ int main(int argc, char *argv[]) {
                                 options::SourceFilename,
                                 options::TerminalOutput,
                                 options::Typecheck,
-                                options::Playground);
+                                options::Playground,
+                                options::SyntaxColoringLines);
+    break;
+
+  case ActionType::LexBenchmark:
+    ExitCode = doLexBenchmark(options::SourceFilename, options::LexIterations);
     break;
 
   case ActionType::DumpImporterLookupTable:
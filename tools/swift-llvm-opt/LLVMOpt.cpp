@@ -236,6 +236,7 @@ int main(int argc, char **argv) {
   initializeSwiftStackPromotionPass(Registry);
   initializeInlineTreePrinterPass(Registry);
   initializeSwiftMergeFunctionsPass(Registry);
+  initializeSwiftInlineRefCountingPass(Registry);
 
   llvm::cl::ParseCommandLineOptions(argc, argv, "Swift LLVM optimizer\n");
 
@@ -181,7 +181,8 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
       if (StringRef(line).startswith("//"))
         continue;
 
-      auto demangled = Demangle::demangleTypeAsNode(line);
+      Demangle::NodeFactory factory;
+      auto demangled = Demangle::demangleTypeAsNode(line, factory);
       auto *typeRef = swift::remote::decodeMangledType(builder, demangled);
       if (typeRef == nullptr) {
         OS << "Invalid typeref: " << line << "\n";
@@ -17,6 +17,7 @@ static const char *REQUEST_READ_BYTES = "b\n";
 static const char *REQUEST_SYMBOL_ADDRESS = "s\n";
 static const char *REQUEST_STRING_LENGTH = "l\n";
 static const char *REQUEST_POINTER_SIZE = "p\n";
+static const char *REQUEST_HEAP_BLOCKS = "h\n";
 static const char *REQUEST_DONE = "d\n";
 
 typedef enum InstanceKind {
@@ -24,5 +25,6 @@ typedef enum InstanceKind {
   Object,
   Existential,
   ErrorExistential,
-  Closure
+  Closure,
+  HeapCensus
 } InstanceKind;
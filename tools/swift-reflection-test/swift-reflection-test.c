@@ -378,6 +378,76 @@ int reflectExistential(SwiftReflectionContextRef RC,
   return 1;
 }
 
+typedef struct CensusResults {
+  swift_census_entry_t *Entries;
+  size_t NumEntries;
+} CensusResults;
+
+static void addCensusEntry(void *Context, swift_census_entry_t Entry) {
+  CensusResults *Census = (CensusResults *)Context;
+  Census->Entries[Census->NumEntries++] = Entry;
+}
+
+/// Order census entries by decreasing size, which is how a memory census is
+/// usually read.
+static int compareCensusEntries(const void *A, const void *B) {
+  const swift_census_entry_t *EntryA = (const swift_census_entry_t *)A;
+  const swift_census_entry_t *EntryB = (const swift_census_entry_t *)B;
+  if (EntryA->Bytes != EntryB->Bytes)
+    return EntryA->Bytes < EntryB->Bytes ? 1 : -1;
+  if (EntryA->Count != EntryB->Count)
+    return EntryA->Count < EntryB->Count ? 1 : -1;
+  return 0;
+}
+
+int reflectHeapCensus(SwiftReflectionContextRef RC,
+                      const PipeMemoryReader Pipe) {
+  int WriteFD = PipeMemoryReader_getParentWriteFD(&Pipe);
+  write(WriteFD, REQUEST_HEAP_BLOCKS, 2);
+  uintptr_t NumBlocks = 0;
+  PipeMemoryReader_collectBytesFromPipe(&Pipe, &NumBlocks, sizeof(NumBlocks));
+
+  swift_heap_block_t *Blocks = calloc(NumBlocks + 1,
+                                      sizeof(swift_heap_block_t));
+  if (Blocks == NULL)
+    errorAndExit("malloc failed");
+  for (uintptr_t i = 0; i < NumBlocks; ++i) {
+    uintptr_t Address, Size;
+    PipeMemoryReader_collectBytesFromPipe(&Pipe, &Address, sizeof(Address));
+    PipeMemoryReader_collectBytesFromPipe(&Pipe, &Size, sizeof(Size));
+    Blocks[i].Address = Address;
+    Blocks[i].Size = Size;
+  }
+  printf("Heap blocks in child address space: %lu\n", NumBlocks);
+
+  // There is at most one entry per block.
+  CensusResults Census = {
+    calloc(NumBlocks + 1, sizeof(swift_census_entry_t)),
+    0
+  };
+  if (Census.Entries == NULL)
+    errorAndExit("malloc failed");
+  swift_reflection_takeHeapCensus(RC, Blocks, NumBlocks, addCensusEntry,
+                                  &Census);
+  qsort(Census.Entries, Census.NumEntries, sizeof(swift_census_entry_t),
+        compareCensusEntries);
+
+  for (size_t i = 0; i < Census.NumEntries; ++i) {
+    swift_census_entry_t Entry = Census.Entries[i];
+    printf("%llu objects, %llu bytes:\n",
+           (unsigned long long) Entry.Count,
+           (unsigned long long) Entry.Bytes);
+    swift_reflection_dumpTypeRef(
+      swift_reflection_typeRefForMetadata(RC, Entry.Metadata));
+  }
+  printf("\n");
+
+  free(Census.Entries);
+  free(Blocks);
+  PipeMemoryReader_sendDoneMessage(&Pipe);
+  return 1;
+}
+
 int doDumpHeapInstance(const char *BinaryFilename) {
   PipeMemoryReader Pipe = createPipeMemoryReader();
 
@@ -442,6 +512,11 @@ int doDumpHeapInstance(const char *BinaryFilename) {
           if (!reflectHeapObject(RC, Pipe))
             return EXIT_SUCCESS;
           break;
+        case HeapCensus:
+          printf("Taking a heap census.\n");
+          if (!reflectHeapCensus(RC, Pipe))
+            return EXIT_SUCCESS;
+          break;
         case None:
           swift_reflection_destroyReflectionContext(RC);
           printf("Done.\n");
@@ -11,3 +11,34 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+
+TEST(Demangle, NodeFactory) {
+  NodeFactory Factory;
+
+  // Growing past the inline child storage keeps every child in order.
+  NodePointer List = Factory.createNode(Node::Kind::TypeList);
+  for (unsigned i = 0; i < 100; ++i)
+    List->addChild(Factory.createNode(Node::Kind::Index, i), Factory);
+  ASSERT_EQ(100u, List->getNumChildren());
+  unsigned Expected = 0;
+  for (NodePointer Child : *List)
+    EXPECT_EQ(Expected++, Child->getIndex());
+
+  // Text payloads are copied into the arena.
+  std::string Text = "Swift";
+  NodePointer Module = Factory.createNode(Node::Kind::Module, Text);
+  Text = "Other";
+  EXPECT_EQ("Swift", Module->getText());
+
+  // Trees from one factory can be freely combined.
+  NodePointer Root = swift::Demangle::demangleSymbolAsNode("_TtSi", Factory);
+  ASSERT_NE(nullptr, Root);
+  Root->addChild(Module, Factory);
+  EXPECT_EQ(Node::Kind::Global, Root->getKind());
+
+  // A cleared factory can be reused for further demanglings.
+  Factory.clear();
+  NodePointer Again = swift::Demangle::demangleSymbolAsNode("_TtSi", Factory);
+  ASSERT_NE(nullptr, Again);
+  EXPECT_EQ("Swift.Int", swift::Demangle::nodeToString(Again));
+}
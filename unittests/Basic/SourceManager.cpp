@@ -85,3 +85,33 @@ TEST(SourceManager, RangeContains) {
   EXPECT_TRUE(SM.rangeContains(R_ad, R_bc));
 }
 
+
+TEST(SourceManager, LineAndColumn) {
+  SourceManager SM;
+  unsigned ID = SM.addMemBufferCopy("aaa\nbb\r\n\nc");
+  auto loc = [&](unsigned Offset) { return SM.getLocForOffset(ID, Offset); };
+
+  EXPECT_EQ(std::make_pair(1U, 1U), SM.getLineAndColumn(loc(0)));
+  EXPECT_EQ(std::make_pair(1U, 4U), SM.getLineAndColumn(loc(3)));
+  EXPECT_EQ(std::make_pair(2U, 1U), SM.getLineAndColumn(loc(4)));
+  EXPECT_EQ(std::make_pair(2U, 3U), SM.getLineAndColumn(loc(6), ID));
+  EXPECT_EQ(std::make_pair(3U, 1U), SM.getLineAndColumn(loc(8)));
+  EXPECT_EQ(std::make_pair(4U, 1U), SM.getLineAndColumn(loc(9)));
+  EXPECT_EQ(std::make_pair(4U, 2U), SM.getLineAndColumn(loc(10)));
+
+  EXPECT_EQ(1U, SM.getLineNumber(loc(2)));
+  EXPECT_EQ(3U, SM.getLineNumber(loc(8), ID));
+}
+
+TEST(SourceManager, ResolveFromLineCol) {
+  SourceManager SM;
+  unsigned ID = SM.addMemBufferCopy("aaa\nbb\nc");
+
+  EXPECT_EQ(0U, SM.resolveFromLineCol(ID, 1, 1).getValue());
+  EXPECT_EQ(3U, SM.resolveFromLineCol(ID, 1, 4).getValue());
+  EXPECT_EQ(5U, SM.resolveFromLineCol(ID, 2, 2).getValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 1, 5).hasValue());
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 0, 1).hasValue());
+  // The last line has no newline.
+  EXPECT_FALSE(SM.resolveFromLineCol(ID, 3, 1).hasValue());
+}
@@ -0,0 +1,88 @@
+#include "swift/Driver/BuildStateCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::driver;
+using namespace llvm::sys;
+
+namespace {
+class BuildStateCacheTest : public ::testing::Test {
+protected:
+  llvm::SmallString<128> dirPath;
+  llvm::SmallString<128> filePath;
+
+  void SetUp() override {
+    ASSERT_FALSE(fs::createUniqueDirectory("BuildStateCache-test", dirPath));
+    filePath = dirPath;
+    path::append(filePath, "main.swiftdeps");
+  }
+
+  void TearDown() override {
+    fs::remove(filePath);
+    fs::remove(dirPath);
+  }
+
+  void writeFile(StringRef contents) {
+    std::error_code error;
+    llvm::raw_fd_ostream out(filePath, error, fs::F_None);
+    ASSERT_FALSE(error);
+    out << contents;
+  }
+
+  StringRef getContents(BuildStateCache &cache) {
+    llvm::MemoryBuffer *buffer = cache.getBuffer(filePath);
+    return buffer ? buffer->getBuffer() : "<missing>";
+  }
+};
+} // end anonymous namespace
+
+TEST_F(BuildStateCacheTest, MissingFile) {
+  BuildStateCache cache;
+  fs::file_status status;
+  EXPECT_TRUE(bool(cache.getStatus(filePath, status)));
+  EXPECT_EQ(nullptr, cache.getBuffer(filePath));
+  EXPECT_EQ(nullptr, cache.getOutputFileMap(filePath));
+}
+
+TEST_F(BuildStateCacheTest, RevalidatesEachBuild) {
+  BuildStateCache cache;
+  writeFile("a");
+  cache.beginBuild();
+  EXPECT_EQ("a", getContents(cache));
+
+  // Within a build, statuses are reused.
+  writeFile("bb");
+  EXPECT_EQ("a", getContents(cache));
+
+  // The next build notices the change.
+  cache.beginBuild();
+  EXPECT_EQ("bb", getContents(cache));
+
+  fs::remove(filePath);
+  cache.beginBuild();
+  EXPECT_EQ("<missing>", getContents(cache));
+}
+
+TEST_F(BuildStateCacheTest, TrustNotifications) {
+  BuildStateCache cache(/*trustNotifications=*/true);
+  writeFile("a");
+  cache.beginBuild();
+  EXPECT_EQ("a", getContents(cache));
+
+  // Unreported changes are not noticed...
+  writeFile("bb");
+  cache.beginBuild();
+  EXPECT_EQ("a", getContents(cache));
+
+  // ...but reported ones are.
+  cache.fileChanged(filePath);
+  EXPECT_EQ("bb", getContents(cache));
+
+  writeFile("ccc");
+  cache.clear();
+  EXPECT_EQ("ccc", getContents(cache));
+}
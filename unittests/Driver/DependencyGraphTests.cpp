@@ -1,4 +1,6 @@
 #include "swift/Driver/DependencyGraph.h"
+#include "swift/Basic/ReferenceDependencies.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -790,3 +792,173 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, LoadFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+  uintptr_t i = 0;
+
+  EXPECT_EQ(graph.loadFromString(i++,
+                                 "provides-top-level: [a]\n"
+                                 "fingerprints-top-level: [[a, '1']]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(i++,
+                                 "provides-nominal: [b]\n"
+                                 "fingerprints-nominal: [[b, '1']]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(i++,
+                                 "provides-member: [[c, cc]]\n"
+                                 "fingerprints-member: [[c, cc, '1']]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(i++, "fingerprints-top-level: [a]"),
+            LoadResult::HadError);
+  EXPECT_EQ(graph.loadFromString(i++, "fingerprints-member: [[c, '1']]"),
+            LoadResult::HadError);
+  EXPECT_EQ(graph.loadFromString(i++, "fingerprints-dynamic-lookup: []"),
+            LoadResult::HadError);
+}
+
+TEST(DependencyGraph, ChangedFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "fingerprints-top-level: [[a, '1'], [b, '1']]\n"
+                                 "interface-hash: 'first'"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [c]"),
+            LoadResult::UpToDate);
+
+  // Only 'b' changed; 'c' has no fingerprint and so is assumed to change.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "fingerprints-top-level: [[a, '1'], [b, '2']]\n"
+                                 "interface-hash: 'second'"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_TRUE(contains(marked, 3));
+  EXPECT_TRUE(graph.isMarked(0));
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_TRUE(graph.isMarked(3));
+
+  // The narrowing only applies once.
+  marked.clear();
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(1u, marked.front());
+  EXPECT_TRUE(graph.isMarked(1));
+}
+
+TEST(DependencyGraph, ChangedFingerprintsMembers) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-member: [[x, a], [x, b]]\n"
+                                 "fingerprints-member: [[x, a, '1'], "
+                                                       "[x, b, '1']]\n"
+                                 "interface-hash: 'first'"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[x, a]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[x, b]]"),
+            LoadResult::UpToDate);
+
+  // Removing the fingerprint for a member counts as a change.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-member: [[x, a], [x, b]]\n"
+                                 "fingerprints-member: [[x, a, '1']]\n"
+                                 "interface-hash: 'second'"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, ChangedFingerprintsWithoutPrevious) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: 'first'"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // There's nothing to compare against, so everything is considered changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "fingerprints-top-level: [[a, '1'], [b, '1']]\n"
+                                 "interface-hash: 'second'"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, BinaryFormat) {
+  using namespace reference_dependencies;
+
+  std::string binaryProvider;
+  {
+    llvm::raw_string_ostream out(binaryProvider);
+    auto writer = Writer::createBinary(out);
+    writer->beginSection(Section::ProvidesTopLevel);
+    writer->addEntry(StringRef("a"));
+    writer->addEntry(StringRef("b"));
+    writer->beginSection(Section::ProvidesMember);
+    writer->addEntry({ "x", "a" });
+    writer->beginSection(Section::FingerprintsTopLevel);
+    writer->addEntry({ "a", "1" });
+    writer->addEntry({ "b", "1" });
+    writer->addInterfaceHash("first");
+    writer->finish();
+  }
+  EXPECT_TRUE(isBinaryFile(binaryProvider));
+
+  std::string binaryDependent;
+  {
+    llvm::raw_string_ostream out(binaryDependent);
+    auto writer = Writer::createBinary(out);
+    writer->beginSection(Section::DependsTopLevel);
+    writer->addEntry(StringRef("b"), /*isCascading=*/false);
+    writer->finish();
+  }
+
+  DependencyGraph<uintptr_t> graph;
+  EXPECT_EQ(graph.loadFromString(0, binaryProvider), LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, binaryDependent), LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[x, a]]"),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+
+  // Truncated files are rejected.
+  EXPECT_EQ(graph.loadFromString(3, StringRef(binaryProvider).drop_back()),
+            LoadResult::HadError);
+  EXPECT_EQ(graph.loadFromString(4, StringRef(binaryProvider).substr(0, 8)),
+            LoadResult::HadError);
+}
@@ -352,3 +352,45 @@ TEST_F(LexerTest, NestedPlaceholder) {
   std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
+
+TEST_F(LexerTest, LongComments) {
+  // Long enough that the interesting characters fall in different chunks
+  // of a vectorized scan.
+  const char *Source =
+      "x /* a comment that goes on for more than sixteen bytes\n"
+      " * /* with a nested comment, and * and / on their own */ é */ a\n"
+      "// a line comment that also goes on for more than sixteen bytes\n"
+      "b /* and one that stays on the same line as the tokens around it */ c";
+  std::vector<tok> ExpectedTokens{
+    tok::identifier, tok::identifier, tok::identifier, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("a", Toks[1].getText());
+  EXPECT_TRUE(Toks[1].isAtStartOfLine());
+  EXPECT_EQ("b", Toks[2].getText());
+  EXPECT_TRUE(Toks[2].isAtStartOfLine());
+  EXPECT_EQ("c", Toks[3].getText());
+  EXPECT_FALSE(Toks[3].isAtStartOfLine());
+
+  ExpectedTokens = {
+    tok::identifier, tok::comment, tok::identifier, tok::comment,
+    tok::identifier, tok::comment, tok::identifier
+  };
+  Toks = checkLex(Source, ExpectedTokens, /*KeepComments=*/true);
+  EXPECT_EQ(Toks[3].getLength(), 64U);
+}
+
+TEST_F(LexerTest, LongStringLiterals) {
+  const char *Source =
+      "\"a string literal that is longer than sixteen bytes \\\" é\" "
+      "\"another one with an \\(interpolation) in the middle of it\" "
+      "\"and one that is not terminated before the end of the line\n"
+      "abcdefghijklmnopqrstuvwxyz_0123456789$";
+  std::vector<tok> ExpectedTokens{
+    tok::string_literal, tok::string_literal, tok::unknown, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ(Toks[0].getLength(), 58U);
+  EXPECT_EQ(Toks[1].getLength(), 58U);
+  EXPECT_EQ("abcdefghijklmnopqrstuvwxyz_0123456789$", Toks[3].getText());
+}
@@ -0,0 +1,94 @@
+//===--- CachingMemoryReader.cpp - CachingMemoryReader tests --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Remote/CachingMemoryReader.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace swift;
+using namespace remote;
+
+namespace {
+
+/// A MemoryReader over a buffer starting at address 0, which counts the reads
+/// made through it.
+class BufferMemoryReader final : public MemoryReader {
+public:
+  std::vector<uint8_t> Memory;
+  unsigned Reads = 0;
+
+  explicit BufferMemoryReader(size_t size) : Memory(size) {
+    for (size_t i = 0; i != size; ++i)
+      Memory[i] = uint8_t(i * 7);
+  }
+
+  uint8_t getPointerSize() override { return 8; }
+  uint8_t getSizeSize() override { return 8; }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return RemoteAddress(uint64_t(0));
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    return false;
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++Reads;
+    if (address.getAddressData() + size > Memory.size())
+      return false;
+    std::memcpy(dest, &Memory[address.getAddressData()], size);
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+TEST(CachingMemoryReaderTest, ReadsAcrossPages) {
+  auto Underlying = std::make_shared<BufferMemoryReader>(3 * 4096);
+  CachingMemoryReader Reader(Underlying);
+
+  uint8_t Buffer[200];
+  ASSERT_TRUE(Reader.readBytes(RemoteAddress(uint64_t(4000)), Buffer, 200));
+  for (unsigned i = 0; i != 200; ++i)
+    EXPECT_EQ(uint8_t((4000 + i) * 7), Buffer[i]);
+  EXPECT_EQ(2u, Underlying->Reads);
+}
+
+TEST(CachingMemoryReaderTest, CachesPages) {
+  auto Underlying = std::make_shared<BufferMemoryReader>(2 * 4096);
+  CachingMemoryReader Reader(Underlying);
+
+  uint32_t First, Second;
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(16)), &First));
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(64)), &Second));
+  EXPECT_EQ(1u, Underlying->Reads);
+
+  Reader.clear();
+  ASSERT_TRUE(Reader.readInteger(RemoteAddress(uint64_t(16)), &First));
+  EXPECT_EQ(2u, Underlying->Reads);
+}
+
+TEST(CachingMemoryReaderTest, ReadsPartialPages) {
+  // The last page is only partly readable, so reads from it go to the
+  // underlying reader.
+  auto Underlying = std::make_shared<BufferMemoryReader>(4096 + 100);
+  CachingMemoryReader Reader(Underlying);
+
+  uint8_t Buffer[50];
+  EXPECT_TRUE(Reader.readBytes(RemoteAddress(uint64_t(4096 + 10)), Buffer, 50));
+  EXPECT_EQ(uint8_t((4096 + 10) * 7), Buffer[0]);
+  EXPECT_FALSE(Reader.readBytes(RemoteAddress(uint64_t(4096 + 90)), Buffer,
+                                50));
+}
@@ -159,6 +159,7 @@ T RaceTest_ExpectEqual(std::function<T()> code)
 uint32_t Global1 = 0;
 uint32_t Global2 = 0;
 uint32_t Global3 = 0;
+uint32_t Global4 = 0;
 
 /// The general structure of a generic metadata.
 template <typename Instance>
@@ -249,6 +250,51 @@ TEST(Concurrent, ConcurrentMap) {
 }
 
 
+TEST(Concurrent, ConcurrentHashMap) {
+  const int numElem = 1000;
+
+  struct Entry {
+    size_t Key;
+    Entry(size_t key) : Key(key) {}
+    int compareWithKey(size_t key) const {
+      return (key == Key ? 0 : (key < Key ? -1 : 1));
+    }
+    static size_t getKeyHash(size_t key) { return key; }
+    static size_t getExtraAllocationSize(size_t key) { return 0; }
+  };
+
+  ConcurrentHashMap<Entry> Map;
+
+  // Add a bunch of numbers to the map concurrently, forcing several resizes
+  // while other threads are searching.
+  auto results = RaceTest<int*>(
+    [&]() -> int* {
+      for (int i = 0; i < numElem; i++) {
+        size_t hash = (i * 123512) % 0xFFFF ;
+        auto result = Map.getOrInsert(hash);
+        EXPECT_EQ(hash, result.first->Key);
+        EXPECT_EQ(result.first, Map.find(hash));
+      }
+      return nullptr;
+    }
+  );
+
+  // Check that all of the values that we inserted are in the map, and that
+  // inserting them again finds the existing entries.
+  for (int i=0; i < numElem; i++) {
+    size_t hash = (i * 123512) % 0xFFFF ;
+    Entry *found = Map.find(hash);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(hash, found->Key);
+    auto result = Map.getOrInsert(hash);
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(found, result.first);
+  }
+
+  EXPECT_FALSE(Map.find(size_t(0x10000)));
+}
+
+
 TEST(MetadataTest, getGenericMetadata) {
   auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
 
@@ -289,6 +335,35 @@ TEST(MetadataTest, getGenericMetadata) {
     });
 }
 
+StructMetadata MetadataTest1_Prespecialized = {
+  MetadataKind::Struct,
+  reinterpret_cast<const NominalTypeDescriptor*>(&Global1),
+  nullptr
+};
+
+TEST(MetadataTest, registerGenericMetadataPrespecialization) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
+
+  // A registered instantiation is returned as-is.
+  void *args[] = { &Global4 };
+  swift_registerGenericMetadataPrespecialization(metadataTemplate, args,
+                                               &MetadataTest1_Prespecialized);
+
+  RaceTest_ExpectEqual<const Metadata *>(
+    [&]() -> const Metadata * {
+      auto inst = swift_getGenericMetadata(metadataTemplate, args);
+      EXPECT_EQ(&MetadataTest1_Prespecialized, inst);
+      return inst;
+    });
+
+  // Registering over an existing instantiation keeps the existing one.
+  args[0] = &Global2;
+  auto existing = swift_getGenericMetadata(metadataTemplate, args);
+  swift_registerGenericMetadataPrespecialization(metadataTemplate, args,
+                                               &MetadataTest1_Prespecialized);
+  EXPECT_EQ(existing, swift_getGenericMetadata(metadataTemplate, args));
+}
+
 FullMetadata<ClassMetadata> MetadataTest2 = {
   { { nullptr }, { &_TWVBo } },
   { { { MetadataKind::Class } }, nullptr, 0, ClassFlags(), nullptr, 0, 0, 0, 0, 0 }
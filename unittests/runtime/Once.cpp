@@ -0,0 +1,57 @@
+//===--- Once.cpp - swift_once Tests --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Once.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static std::atomic<int> InitializationCount(0);
+static int InitializedValue = 0;
+
+static void initializeValue(void *) {
+  // Give the other threads a chance to race with the initializer.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  InitializedValue = 42;
+  ++InitializationCount;
+}
+
+TEST(OnceTest, once_runs_exactly_once) {
+  static swift_once_t predicate;
+  std::atomic<int> wrongValues(0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread([&] {
+      swift_once(&predicate, initializeValue);
+      if (InitializedValue != 42)
+        ++wrongValues;
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // Later calls take the fast path.
+  swift_once(&predicate, initializeValue);
+
+  EXPECT_EQ(1, InitializationCount.load());
+  EXPECT_EQ(0, wrongValues.load());
+
+#if !defined(__CYGWIN__)
+  // IRGen relies on this value to check for initialization inline.
+  EXPECT_EQ(~swift_once_t(0), predicate);
+#endif
+}
@@ -153,6 +153,27 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   EXPECT_EQ(1u, value);
 }
 
+TEST(RefcountingTest, weak_side_table) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, object);
+  swift_weakCopyInit(&ref2, &ref1);
+  // Weak references don't keep the object's memory alive.
+  EXPECT_EQ(1u, swift_unownedRetainCount(object));
+
+  auto loaded = swift_weakLoadStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  swift_release(loaded);
+  EXPECT_EQ(0u, value);
+
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  EXPECT_EQ(nullptr, swift_weakTakeStrong(&ref2));
+  swift_weakDestroy(&ref1);
+}
+
 /////////////////////////////////////////
 // Non-atomic reference counting tests //
 /////////////////////////////////////////
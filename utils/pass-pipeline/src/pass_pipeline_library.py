@@ -84,11 +84,13 @@ def ssapass_passlist(optlevel):
 
 def lower_passlist():
     return ppipe.PassList([
+        p.ClassHierarchyDevirtualizer,
         p.DeadFunctionElimination,
         p.DeadObjectElimination,
         p.GlobalOpt,
         p.CapturePropagation,
         p.ClosureSpecializer,
+        p.ExistentialSpecializer,
         p.SpeculativeDevirtualizer,
         p.FunctionSignatureOpts,
     ])
@@ -11,6 +11,7 @@ COWArrayOpts = Pass('COWArrayOpts')
 CSE = Pass('CSE')
 CapturePromotion = Pass('CapturePromotion')
 CapturePropagation = Pass('CapturePropagation')
+ClassHierarchyDevirtualizer = Pass('ClassHierarchyDevirtualizer')
 ClosureSpecializer = Pass('ClosureSpecializer')
 CodeMotion = Pass('CodeMotion')
 CopyForwarding = Pass('CopyForwarding')
@@ -22,6 +23,7 @@ DiagnoseUnreachable = Pass('DiagnoseUnreachable')
 DiagnosticConstantPropagation = Pass('DiagnosticConstantPropagation')
 EarlyInliner = Pass('EarlyInliner')
 EmitDFDiagnostics = Pass('EmitDFDiagnostics')
+ExistentialSpecializer = Pass('ExistentialSpecializer')
 FunctionSignatureOpts = Pass('FunctionSignatureOpts')
 GlobalARCOpts = Pass('GlobalARCOpts')
 GlobalLoadStoreOpts = Pass('GlobalLoadStoreOpts')
@@ -60,6 +62,7 @@ PASSES = [
     CSE,
     CapturePromotion,
     CapturePropagation,
+    ClassHierarchyDevirtualizer,
     ClosureSpecializer,
     CodeMotion,
     CopyForwarding,
@@ -71,6 +74,7 @@ PASSES = [
     DiagnosticConstantPropagation,
     EarlyInliner,
     EmitDFDiagnostics,
+    ExistentialSpecializer,
     FunctionSignatureOpts,
     GlobalARCOpts,
     GlobalLoadStoreOpts,
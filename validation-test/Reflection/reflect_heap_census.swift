@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift -lswiftSwiftReflectionTest %s -o %t/reflect_heap_census
+// RUN: %target-run %target-swift-reflection-test %t/reflect_heap_census 2>&1 | FileCheck %s
+// REQUIRES: objc_interop
+
+import SwiftReflectionTest
+import Darwin
+
+class Node {
+  var value = 0
+}
+
+class Leaf {}
+
+let nodes = [Node(), Node(), Node()]
+let leaves = [Leaf(), Leaf()]
+let buffer = malloc(64)!
+
+var blocks = nodes.map { unsafeAddress(of: $0) }
+blocks += leaves.map { unsafeAddress(of: $0) }
+blocks.append(UnsafePointer<Void>(buffer))
+
+reflectHeapCensus(blocks: blocks)
+
+// CHECK: Taking a heap census.
+// CHECK: Heap blocks in child address space: 6
+// CHECK: 3 objects, {{[0-9]+}} bytes:
+// CHECK: (class reflect_heap_census.Node)
+// CHECK: 2 objects, {{[0-9]+}} bytes:
+// CHECK: (class reflect_heap_census.Leaf)
+// CHECK-NOT: objects,
+
+free(buffer)
+
+doneReflecting()
+
+// CHECK: Done.
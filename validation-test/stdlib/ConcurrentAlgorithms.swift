@@ -0,0 +1,92 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+import SwiftPrivate
+
+var ConcurrentAlgorithmsTests = TestSuite("ConcurrentAlgorithms")
+
+// Sizes around the smallest collection that is split into several chunks.
+let counts = [0, 1, 2, 4095, 4096, 8191, 8192, 8193, 100_000, 1_000_003]
+
+func randomArray(count: Int) -> [Int] {
+  return (0..<count).map { _ in rand32(exclusiveUpperBound: 1000) }
+    .map { Int($0) }
+}
+
+ConcurrentAlgorithmsTests.test("_concurrentPerform") {
+  for iterations in [0, 1, 2, 7, 100] {
+    let calls = UnsafeMutablePointer<Int>(allocatingCapacity: iterations)
+    calls.initialize(with: 0, count: iterations)
+    defer { calls.deallocateCapacity(iterations) }
+    _concurrentPerform(iterations: iterations) {
+      calls[$0] += 1
+    }
+    for i in 0..<iterations {
+      expectEqual(1, calls[i], "iterations=\(iterations), i=\(i)")
+    }
+  }
+}
+
+ConcurrentAlgorithmsTests.test("concurrentMap").forEach(in: counts) {
+  count in
+  let input = randomArray(count: count)
+  expectEqual(input.map { $0 * 3 + 1 }, input.concurrentMap { $0 * 3 + 1 })
+
+  let ranged = 0..<count
+  expectEqual(ranged.map { String($0) }, ranged.concurrentMap { String($0) })
+}
+
+ConcurrentAlgorithmsTests.test("concurrentMap/Lifetime") {
+  let input = (0..<50_000).map { LifetimeTracked($0) }
+  let result = input.concurrentMap { LifetimeTracked($0.value * 2) }
+  expectEqual(input.map { $0.value * 2 }, result.map { $0.value })
+}
+
+ConcurrentAlgorithmsTests.test("concurrentReduce").forEach(in: counts) {
+  count in
+  let input = randomArray(count: count)
+  expectEqual(
+    input.reduce(0, combine: +), input.concurrentReduce(0, +))
+  expectEqual(
+    input.reduce(Int.min, combine: max), input.concurrentReduce(Int.min, max))
+}
+
+ConcurrentAlgorithmsTests.test("concurrentSort").forEach(in: counts) {
+  count in
+  let input = randomArray(count: count)
+
+  var ascending = input
+  ascending.concurrentSort()
+  expectEqual(input.sorted(), ascending)
+
+  var descending = ContiguousArray(input)
+  descending.concurrentSort(isOrderedBefore: >)
+  expectEqual(ContiguousArray(input.sorted(isOrderedBefore: >)), descending)
+
+  // An array slice that does not start at the beginning of its storage.
+  var slice = input[(count / 3)..<count]
+  slice.concurrentSort()
+  expectEqual(ArraySlice(input[(count / 3)..<count].sorted()), slice)
+}
+
+ConcurrentAlgorithmsTests.test("concurrentSort/Lifetime") {
+  let input = randomArray(count: 50_000)
+  var tracked = input.map { LifetimeTracked($0) }
+  tracked.concurrentSort()
+  expectEqual(input.sorted(), tracked.map { $0.value })
+  tracked.concurrentSort(isOrderedBefore: >)
+  expectEqual(input.sorted(isOrderedBefore: >), tracked.map { $0.value })
+}
+
+ConcurrentAlgorithmsTests.test("concurrentSort/Stress") {
+  // Every run count from a single run up to a ragged binary tree of merges.
+  for chunkedCount in [4096 * 3, 4096 * 5 + 17, 4096 * 9 + 1] {
+    let input = randomArray(count: chunkedCount)
+    var sorted = input
+    sorted.concurrentSort()
+    expectEqual(input.sorted(), sorted, "count=\(chunkedCount)")
+  }
+}
+
+runAllTests()
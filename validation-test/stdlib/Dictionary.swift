@@ -84,6 +84,50 @@ DictionaryTestSuite.test("valueDestruction") {
   }
 }
 
+/// A non-POD key that counts how many times it was hashed.
+struct HashCountingKey : Hashable {
+  static var timesHashValueWasCalled = 0
+
+  var value: Int
+  var name: String
+
+  init(_ value: Int) {
+    self.value = value
+    self.name = "key\(value)"
+  }
+
+  var hashValue: Int {
+    HashCountingKey.timesHashValueWasCalled += 1
+    return value.hashValue
+  }
+}
+
+func == (lhs: HashCountingKey, rhs: HashCountingKey) -> Bool {
+  return lhs.value == rhs.value && lhs.name == rhs.name
+}
+
+DictionaryTestSuite.test("Growth.DoesNotRehashNonPODKeys") {
+  HashCountingKey.timesHashValueWasCalled = 0
+  var d = Dictionary<HashCountingKey, Int>()
+  for i in 0..<1000 {
+    d[HashCountingKey(i)] = i
+  }
+  // Each key is hashed once when it is inserted. The hash values are kept
+  // in the storage, so growing it does not hash the keys again.
+  expectEqual(1000, HashCountingKey.timesHashValueWasCalled)
+
+  // Removing keys moves other keys without hashing them again either.
+  HashCountingKey.timesHashValueWasCalled = 0
+  for i in 0..<500 {
+    d[HashCountingKey(i)] = nil
+  }
+  expectEqual(500, HashCountingKey.timesHashValueWasCalled)
+
+  for i in 500..<1000 {
+    expectOptionalEqual(i, d[HashCountingKey(i)])
+  }
+}
+
 DictionaryTestSuite.test("COW.Smoke") {
   var d1 = Dictionary<TestKeyTy, TestValueTy>(minimumCapacity: 10)
   var identity1 = unsafeBitCast(d1, to: Int.self)
@@ -133,6 +177,25 @@ func getCOWSlowEquatableDictionary()
 }
 
 
+DictionaryTestSuite.test("reserveCapacity") {
+  var d = getCOWFastDictionary()
+  let identity1 = unsafeBitCast(d, to: Int.self)
+  d.reserveCapacity(1000)
+  expectNotEqual(identity1, unsafeBitCast(d, to: Int.self))
+  expectEqual(3, d.count)
+  expectOptionalEqual(1020, d[20])
+
+  let identity2 = unsafeBitCast(d, to: Int.self)
+  for i in 0..<997 {
+    d[i + 100] = i
+  }
+  expectEqual(identity2, unsafeBitCast(d, to: Int.self))
+
+  // Reserving less than the current capacity keeps the storage.
+  d.reserveCapacity(1)
+  expectEqual(identity2, unsafeBitCast(d, to: Int.self))
+}
+
 DictionaryTestSuite.test("COW.Fast.IndexesDontAffectUniquenessCheck") {
   var d = getCOWFastDictionary()
   var identity1 = unsafeBitCast(d, to: Int.self)
@@ -264,6 +327,49 @@ DictionaryTestSuite.test("COW.Fast.SubscriptWithKeyDoesNotReallocate") {
   }
 }
 
+DictionaryTestSuite.test("SubscriptWithKeyAndDefault") {
+  var d: [Int : Int] = [10: 1010]
+  expectEqual(1010, d[10, default: 0])
+  expectEqual(0, d[20, default: 0])
+  // Reading does not insert the default value.
+  expectEqual(1, d.count)
+  expectEmpty(d[20])
+
+  d[10, default: 0] += 1
+  d[20, default: 0] += 5
+  expectEqual(2, d.count)
+  expectOptionalEqual(1011, d[10])
+  expectOptionalEqual(5, d[20])
+
+  // Mutating a copy does not affect the original.
+  var d2 = d
+  d2[30, default: 0] = 2030
+  d2[10, default: 0] = 0
+  expectEqual(2, d.count)
+  expectOptionalEqual(1011, d[10])
+  expectEmpty(d[30])
+  expectEqual(3, d2.count)
+  expectOptionalEqual(0, d2[10])
+}
+
+DictionaryTestSuite.test("SubscriptWithKeyAndDefault/MutatesValueInPlace") {
+  var d: [Int : [Int]] = [:]
+  d[1, default: []].reserveCapacity(16)
+  let address = d[1]!.withUnsafeBufferPointer { $0.baseAddress }
+  for i in 0..<16 {
+    d[1, default: []].append(i)
+  }
+  expectEqual(Array(0..<16), d[1]!)
+  // The array was never copied.
+  expectTrue(address == d[1]!.withUnsafeBufferPointer { $0.baseAddress })
+
+  // A copy of the dictionary shares the array until either is mutated.
+  var d2 = d
+  d2[1, default: []].append(16)
+  expectEqual(Array(0..<16), d[1]!)
+  expectEqual(Array(0...16), d2[1]!)
+}
+
 DictionaryTestSuite.test("COW.Slow.SubscriptWithKeyDoesNotReallocate") {
   var d = getCOWSlowDictionary()
   var identity1 = unsafeBitCast(d, to: Int.self)
@@ -1694,6 +1800,23 @@ DictionaryTestSuite.test("BridgedFromObjC.Verbatim.SubscriptWithKey") {
   assert(v.value == 2040)
 }
 
+DictionaryTestSuite.test("BridgedFromObjC.Verbatim.SubscriptWithKeyAndDefault") {
+  var d = getBridgedVerbatimDictionary()
+  assert(isCocoaDictionary(d))
+
+  let defaultValue = TestObjCValueTy(0)
+  assert((d[TestObjCKeyTy(10), default: defaultValue] as! TestObjCValueTy)
+    .value == 1010)
+  assert(isCocoaDictionary(d))
+
+  // Mutating through the subscript moves the elements to native storage.
+  d[TestObjCKeyTy(40), default: defaultValue] = TestObjCValueTy(2040)
+  assert(isNativeDictionary(d))
+  assert(d.count == 4)
+  assert((d[TestObjCKeyTy(10)] as! TestObjCValueTy).value == 1010)
+  assert((d[TestObjCKeyTy(40)] as! TestObjCValueTy).value == 2040)
+}
+
 DictionaryTestSuite.test("BridgedFromObjC.Nonverbatim.SubscriptWithKey") {
   var d = getBridgedNonverbatimDictionary()
   var identity1 = unsafeBitCast(d, to: Int.self)
@@ -3420,6 +3543,35 @@ DictionaryTestSuite.test("DictionaryBridgeFromObjectiveCConditional") {
     assert(false)
   }
 }
+
+DictionaryTestSuite.test("DictionaryBridgeFromObjectiveCConditional/CocoaStorage") {
+  var expected = Dictionary<Int, Int>()
+  for i in 0..<200 {
+    expected[i * 10] = i * 10 + 1000
+  }
+  let d = getBridgedVerbatimDictionary(expected)
+
+  if let dVV = d as? Dictionary<TestBridgedKeyTy, TestBridgedValueTy> {
+    expectEqual(expected.count, dVV.count)
+    for (key, value) in expected {
+      expectOptionalEqual(value, dVV[TestBridgedKeyTy(key)]?.value)
+    }
+  } else {
+    expectUnreachable()
+  }
+
+  if let dCV = d as? Dictionary<TestObjCKeyTy, TestBridgedValueTy> {
+    expectEqual(expected.count, dCV.count)
+    for (key, value) in expected {
+      expectOptionalEqual(value, dCV[TestObjCKeyTy(key)]?.value)
+    }
+  } else {
+    expectUnreachable()
+  }
+
+  // The values do not bridge to String.
+  expectEmpty(d as? Dictionary<TestBridgedKeyTy, String>)
+}
 #endif // _runtime(_ObjC)
 
 //===---
@@ -147,5 +147,43 @@ HashingTestSuite.test("overridePerExecutionHashSeed/overflow") {
   _HashingDetail.fixedSeedOverride = 0
 }
 
+HashingTestSuite.test("_Hasher/order") {
+  var ab = _Hasher()
+  ab.append(1)
+  ab.append(2)
+  var ba = _Hasher()
+  ba.append(2)
+  ba.append(1)
+  expectNotEqual(ab.finalize(), ba.finalize())
+}
+
+HashingTestSuite.test("_Hasher/bytes") {
+  func hashBytes(_ bytes: [UInt8]) -> Int {
+    var hasher = _Hasher()
+    bytes.withUnsafeBufferPointer {
+      hasher.append(bytes: $0.baseAddress!, count: $0.count)
+    }
+    return hasher.finalize()
+  }
+
+  // The same bytes hash the same, however they are aligned.
+  let bytes: [UInt8] = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11]
+  let padded: [UInt8] = [0] + bytes
+  var hasher = _Hasher()
+  padded.withUnsafeBufferPointer {
+    hasher.append(bytes: $0.baseAddress! + 1, count: bytes.count)
+  }
+  expectEqual(hashBytes(bytes), hasher.finalize())
+
+  // Trailing zeros change the hash.
+  expectNotEqual(hashBytes([1, 2]), hashBytes([1, 2, 0]))
+  expectNotEqual(hashBytes([]), hashBytes([0]))
+}
+
+HashingTestSuite.test("_isBitwiseEqual") {
+  expectTrue(_isBitwiseEqual((1, 2), (1, 2)))
+  expectFalse(_isBitwiseEqual((1, 2), (1, 3)))
+}
+
 runAllTests()
 
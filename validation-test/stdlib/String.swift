@@ -990,6 +990,63 @@ StringTests.test("Conversions") {
   }
 }
 
+StringTests.test("Conversions/ASCIICharacter") {
+  func checkStatic(_ x: String, _ codeUnit: Int) {
+    // One-character ASCII strings point at static storage.
+    expectEqual(1, x._core.count)
+    expectTrue(x._core.isASCII)
+    expectTrue(x._core.nativeBuffer == nil)
+    expectEqual([UInt8(codeUnit)], Array(x.utf8))
+  }
+
+  for i in 0..<128 {
+    let scalar = UnicodeScalar(UInt8(i))
+    let fromScalar = String(scalar)
+    let fromCharacter = String(Character(scalar))
+    checkStatic(fromScalar, i)
+    checkStatic(fromCharacter, i)
+    expectEqual(fromScalar, fromCharacter)
+
+    // Appending to one copies it out.
+    var y = fromScalar
+    y += "x"
+    expectEqual(2, y.utf16.count)
+    expectEqual(fromCharacter, y[y.startIndex..<y.index(after: y.startIndex)])
+    expectEqual(fromScalar, String(scalar))
+  }
+  for i in 0..<10 {
+    checkStatic(String(i), 0x30 + i)
+    checkStatic(String(UInt(i)), 0x30 + i)
+  }
+}
+
+StringTests.test("CharacterView/ASCIIClusters") {
+  // Runs of ASCII next to CR-LF and to scalars that extend clusters.
+  let tests: [(String, [String])] = [
+    ("", []),
+    ("a", ["a"]),
+    ("abc", ["a", "b", "c"]),
+    ("\r\n", ["\r\n"]),
+    ("\n\r", ["\n", "\r"]),
+    ("a\r\n\r\nb", ["a", "\r\n", "\r\n", "b"]),
+    ("\r\r\n\n", ["\r", "\r\n", "\n"]),
+    ("e\u{301}", ["e\u{301}"]),
+    ("ae\u{301}b", ["a", "e\u{301}", "b"]),
+    ("a\u{200D}b", ["a\u{200D}", "b"]),
+    ("\r\u{301}\n", ["\r", "\u{301}", "\n"]),
+    ("x\u{1F1FA}\u{1F1F8}y", ["x", "\u{1F1FA}\u{1F1F8}", "y"]),
+  ]
+  for (string, expected) in tests {
+    let characters = string.characters
+    expectEqual(
+      expected.count, characters.count,
+      "string=\(string.debugDescription)")
+    expectEqualSequence(expected, characters.map { String($0) })
+    expectEqualSequence(
+      expected.reversed(), characters.reversed().map { String($0) })
+  }
+}
+
 // Check the internal functions are correct for ASCII values
 StringTests.test(
   "forall x: Int8, y: Int8 . x < 128 ==> x <ascii y == x <unicode y")
@@ -0,0 +1,103 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+var UnsafeHashControlBytesTests = TestSuite("UnsafeHashControlBytes")
+
+typealias ControlBytes = _UnsafeHashControlBytes
+
+UnsafeHashControlBytesTests.test("groupIndex(_:), byteIndex(_:)") {
+  let bytesPerGroup = ControlBytes.bytesPerGroup
+  expectEqual(strideof(UInt.self), bytesPerGroup)
+  for i in 0..<(4 * bytesPerGroup) {
+    expectEqual(i / bytesPerGroup, ControlBytes.groupIndex(i), "i=\(i)")
+    expectEqual(i % bytesPerGroup, ControlBytes.byteIndex(i), "i=\(i)")
+  }
+}
+
+UnsafeHashControlBytesTests.test("sizeInWords(forCapacity:)") {
+  let bytesPerGroup = ControlBytes.bytesPerGroup
+  expectEqual(0, ControlBytes.sizeInWords(forCapacity: 0))
+  expectEqual(1, ControlBytes.sizeInWords(forCapacity: 1))
+  expectEqual(1, ControlBytes.sizeInWords(forCapacity: bytesPerGroup))
+  expectEqual(2, ControlBytes.sizeInWords(forCapacity: bytesPerGroup + 1))
+  expectEqual(4, ControlBytes.sizeInWords(forCapacity: 4 * bytesPerGroup))
+}
+
+UnsafeHashControlBytesTests.test("occupiedByte(forMixedHashValue:)") {
+  for h: UInt in [0, 1, 0xff, ~0, ~0 >> 1, 1 << UInt(UInt._sizeInBits - 1)] {
+    let byte = ControlBytes.occupiedByte(forMixedHashValue: h)
+    expectTrue(ControlBytes.isOccupied(byte), "h=\(h)")
+    expectEqual(
+      UInt8(truncatingBitPattern: h >> UInt(UInt._sizeInBits - 7)),
+      byte & 0x7f, "h=\(h)")
+  }
+  expectFalse(ControlBytes.isOccupied(ControlBytes.emptyByte))
+  expectFalse(ControlBytes.isOccupied(ControlBytes.paddingByte))
+}
+
+UnsafeHashControlBytesTests.test("matches(_:in:), lowestByteIndex(_:)") {
+  let bytesPerGroup = ControlBytes.bytesPerGroup
+  for matchingByte in 0..<bytesPerGroup {
+    var group: UInt = 0
+    for i in 0..<bytesPerGroup {
+      let byte: UInt = i == matchingByte ? 0x85 : 0x90 | UInt(i)
+      group |= byte << UInt(i * 8)
+    }
+    let matches = ControlBytes.matches(0x85, in: group)
+    expectNotEqual(0, matches)
+    expectEqual(matchingByte, ControlBytes.lowestByteIndex(matches))
+    expectEqual(0, ControlBytes.matches(0, in: group))
+  }
+}
+
+let capacities = [0, 1, 2, 4, 8, 16, 64, 1024]
+
+func make(capacity: Int) -> ControlBytes {
+  let sizeInWords = ControlBytes.sizeInWords(forCapacity: capacity)
+  let storage = UnsafeMutablePointer<UInt>(allocatingCapacity: sizeInWords)
+  let controlBytes = ControlBytes(storage: storage, capacity: capacity)
+  expectEqual(sizeInWords, controlBytes.numberOfGroups)
+  return controlBytes
+}
+
+UnsafeHashControlBytesTests.test("initializeToEmpty()")
+  .forEach(in: capacities) {
+  capacity in
+  let controlBytes = make(capacity: capacity)
+  defer { controlBytes.values.deallocateCapacity(controlBytes.numberOfGroups) }
+
+  controlBytes.initializeToEmpty()
+  for i in 0..<capacity {
+    expectEqual(ControlBytes.emptyByte, controlBytes[i])
+  }
+
+  // The bytes past the end of a small table are neither empty nor occupied.
+  let bytes = UnsafeMutablePointer<UInt8>(controlBytes.values)
+  let numberOfBytes = controlBytes.numberOfGroups * ControlBytes.bytesPerGroup
+  for i in capacity..<numberOfBytes {
+    expectEqual(ControlBytes.paddingByte, bytes[i])
+  }
+}
+
+UnsafeHashControlBytesTests.test("subscript, group(at:)")
+  .forEach(in: capacities) {
+  capacity in
+  let controlBytes = make(capacity: capacity)
+  defer { controlBytes.values.deallocateCapacity(controlBytes.numberOfGroups) }
+
+  for i in 0..<capacity {
+    controlBytes.initializeToEmpty()
+    controlBytes[i] = 0xab
+    for j in 0..<capacity {
+      expectEqual(i == j ? 0xab : ControlBytes.emptyByte, controlBytes[j])
+    }
+    let group = controlBytes.group(at: ControlBytes.groupIndex(i))
+    let matches = ControlBytes.matches(0xab, in: group)
+    expectEqual(
+      ControlBytes.byteIndex(i), ControlBytes.lowestByteIndex(matches))
+  }
+}
+
+runAllTests()